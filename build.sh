@@ -91,6 +91,8 @@ build_board() {
         # NOTE: Keep this allowlist tight; only export values needed by libraries.
         numeric_allowlist=(
             CONFIG_ASYNC_TCP_STACK_SIZE
+            CONFIG_ASYNC_TCP_RUNNING_CORE
+            CONFIG_ASYNC_TCP_PRIORITY
 
             # TFT_eSPI pinout and SPI frequencies
             TFT_MISO
@@ -226,6 +228,31 @@ build_board() {
     echo -e "${GREEN}✓ Build complete for $board_name${NC}"
     ls -lh "$board_build_path"/*.bin 2>/dev/null || echo "Binary files generated"
     echo ""
+
+    # Per-subsystem flash/IRAM/DRAM report vs the release baseline (tools/size_baselines.json).
+    # Fails the build on a budget overrun (tools/size_budgets.json) unless SIZE_BUDGET_ENFORCE=0.
+    # SIZE_UPDATE_BASELINE=1 records this build as the board's baseline (release time).
+    local map_file
+    map_file=$(find "$board_build_path" -maxdepth 1 -name '*.map' -print -quit)
+    if [[ -z "$map_file" ]]; then
+        echo -e "${YELLOW}Size report skipped: no linker map in $board_build_path${NC}"
+        echo ""
+        return 0
+    fi
+    SIZE_ARGS=(--board "$board_name" --map "$map_file" --out "$board_build_path/size-report.json")
+    if [[ "${SIZE_UPDATE_BASELINE:-0}" == "1" ]]; then
+        SIZE_ARGS+=(--update-baseline)
+    elif [[ "${SIZE_BUDGET_ENFORCE:-1}" == "0" ]]; then
+        SIZE_ARGS+=(--no-fail)
+    fi
+    if [[ -n "${GITHUB_STEP_SUMMARY:-}" ]]; then
+        SIZE_ARGS+=(--markdown "$GITHUB_STEP_SUMMARY")
+    fi
+    if ! python3 "$SCRIPT_DIR/tools/size_report.py" "${SIZE_ARGS[@]}"; then
+        echo -e "${RED}✗ Size budget exceeded for $board_name${NC}"
+        return 1
+    fi
+    echo ""
 }
 
 # Generate LVGL PNG assets (only when building for a display-enabled board)
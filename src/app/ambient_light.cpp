@@ -0,0 +1,167 @@
+#include "ambient_light.h"
+
+#if AMBIENT_LIGHT_SUPPORTED
+
+#include "config_manager.h"
+#include "log_manager.h"
+#include "screen_saver_manager.h"
+
+namespace {
+
+struct AutoBrightnessSettings {
+    uint32_t magic;
+    uint8_t enabled;
+    uint8_t min_pct;
+    uint8_t max_pct;
+    uint8_t reserved;
+};
+
+constexpr uint32_t kSettingsMagic = 0x41424C31; // "ABL1"
+const char* kSettingsKey = "auto_bl";
+
+// Brightness targets move in steps of this size (fewer, larger changes).
+constexpr uint8_t kTargetStepPct = 5;
+
+AutoBrightnessSettings g_settings = {kSettingsMagic, 0, AUTO_BRIGHTNESS_MIN_PCT, 100, 0};
+
+uint32_t g_last_sample_ms = 0;
+int32_t g_level_q8 = -1;  // IIR state, 0..100 << 8 (-1 = no sample yet)
+uint16_t g_raw = 0;
+uint8_t g_target = 0;
+uint32_t g_changes = 0;
+
+// Guards g_settings, g_target, g_changes and the published level/raw: the loop
+// runs on the main task, configure() on async_tcp (PUT /api/display/brightness).
+// The target is pushed to the screen saver inside it, so a stale loop result can
+// never land after a newer configure().
+portMUX_TYPE g_mux = portMUX_INITIALIZER_UNLOCKED;
+
+uint16_t sample_adc() {
+    uint32_t sum = 0;
+    for (uint8_t i = 0; i < AUTO_BRIGHTNESS_OVERSAMPLE; i++) {
+        sum += (uint32_t)analogRead(LDR_PIN);
+    }
+    return (uint16_t)(sum / AUTO_BRIGHTNESS_OVERSAMPLE);
+}
+
+// 0 (dark) .. 100 (bright); works for either divider polarity.
+int32_t raw_to_level(uint16_t raw) {
+    const int32_t dark = AUTO_BRIGHTNESS_ADC_DARK;
+    const int32_t bright = AUTO_BRIGHTNESS_ADC_BRIGHT;
+    if (dark == bright) return 100;
+    int32_t level = ((int32_t)raw - dark) * 100 / (bright - dark);
+    if (level < 0) level = 0;
+    if (level > 100) level = 100;
+    return level;
+}
+
+uint8_t level_to_target(int32_t level) {
+    const int32_t lo = g_settings.min_pct;
+    const int32_t hi = g_settings.max_pct;
+    int32_t target = lo + (hi - lo) * level / 100;
+    target = ((target + kTargetStepPct / 2) / kTargetStepPct) * kTargetStepPct;
+    if (target < lo) target = lo;
+    if (target > hi) target = hi;
+    return (uint8_t)target;
+}
+
+void sanitize(AutoBrightnessSettings* s) {
+    if (s->max_pct > 100) s->max_pct = 100;
+    if (s->max_pct < 1) s->max_pct = 1;
+    if (s->min_pct > s->max_pct) s->min_pct = s->max_pct;
+}
+
+} // namespace
+
+void ambient_light_init() {
+    AutoBrightnessSettings stored;
+    if (config_manager_get_blob(kSettingsKey, &stored, sizeof(stored)) && stored.magic == kSettingsMagic) {
+        sanitize(&stored);
+        g_settings = stored;
+    }
+
+    analogReadResolution(12);
+    analogSetPinAttenuation(LDR_PIN, ADC_11db);
+    pinMode(LDR_PIN, INPUT);
+
+    LOGI("Ambient", "LDR on GPIO %d, auto-brightness %s (%u-%u%%)", LDR_PIN,
+        g_settings.enabled ? "on" : "off", (unsigned)g_settings.min_pct, (unsigned)g_settings.max_pct);
+}
+
+void ambient_light_loop(uint32_t now_ms) {
+    if (g_level_q8 >= 0 && (uint32_t)(now_ms - g_last_sample_ms) < AUTO_BRIGHTNESS_SAMPLE_MS) return;
+    g_last_sample_ms = now_ms;
+
+    // Keep the filter warm even when disabled, so enabling it applies a settled level.
+    const uint16_t raw = sample_adc();
+    const int32_t level_q8 = raw_to_level(raw) << 8;
+    int32_t filtered = g_level_q8;
+    if (filtered < 0) {
+        filtered = level_q8;
+    } else {
+        filtered += (level_q8 - filtered) >> AUTO_BRIGHTNESS_IIR_SHIFT;
+    }
+
+    uint8_t target = 0;
+    bool changed = false;
+    portENTER_CRITICAL(&g_mux);
+    g_level_q8 = filtered;
+    g_raw = raw;
+    if (g_settings.enabled) {
+        target = level_to_target((filtered + 128) >> 8);
+        const bool within_hysteresis = g_target != 0 &&
+            abs((int)target - (int)g_target) < AUTO_BRIGHTNESS_HYSTERESIS_PCT &&
+            target != g_settings.min_pct && target != g_settings.max_pct;
+        if (!within_hysteresis && target != g_target) {
+            g_target = target;
+            g_changes++;
+            screen_saver_manager_set_auto_brightness(true, target);
+            changed = true;
+        }
+    }
+    portEXIT_CRITICAL(&g_mux);
+
+    if (changed) {
+        LOGI("Ambient", "Auto-brightness -> %u%% (raw %u)", (unsigned)target, (unsigned)raw);
+    }
+}
+
+void ambient_light_configure(bool enabled, uint8_t min_pct, uint8_t max_pct) {
+    AutoBrightnessSettings next = {kSettingsMagic, (uint8_t)(enabled ? 1 : 0), min_pct, max_pct, 0};
+    sanitize(&next);
+
+    portENTER_CRITICAL(&g_mux);
+    g_settings = next;
+    g_target = 0;
+    if (enabled) {
+        // Apply the current filtered level right away.
+        if (g_level_q8 >= 0) {
+            g_target = level_to_target((g_level_q8 + 128) >> 8);
+            g_changes++;
+            screen_saver_manager_set_auto_brightness(true, g_target);
+        }
+    } else {
+        screen_saver_manager_set_auto_brightness(false, 0);
+    }
+    portEXIT_CRITICAL(&g_mux);
+
+    config_manager_put_blob(kSettingsKey, &next, sizeof(next));
+    LOGI("Ambient", "Auto-brightness %s (%u-%u%%)", enabled ? "on" : "off", (unsigned)next.min_pct, (unsigned)next.max_pct);
+}
+
+AmbientLightStatus ambient_light_get_status() {
+    AmbientLightStatus s;
+    portENTER_CRITICAL(&g_mux);
+    const int32_t level_q8 = g_level_q8;
+    s.raw = g_raw;
+    s.enabled = g_settings.enabled != 0;
+    s.min_pct = g_settings.min_pct;
+    s.max_pct = g_settings.max_pct;
+    s.target_pct = g_target;
+    s.changes = g_changes;
+    portEXIT_CRITICAL(&g_mux);
+    s.level_pct = (level_q8 < 0) ? 0 : (uint8_t)((level_q8 + 128) >> 8);
+    return s;
+}
+
+#endif // AMBIENT_LIGHT_SUPPORTED
@@ -0,0 +1,50 @@
+/*
+ * Ambient Light / Auto-Brightness
+ *
+ * Samples the board's light sensor (HAS_LDR, LDR_PIN) at a low rate and
+ * drives the backlight target of screen_saver_manager:
+ * - AUTO_BRIGHTNESS_OVERSAMPLE ADC reads per sample, averaged
+ * - slow fixed-point IIR on top, so a passing shadow does not move the level
+ * - hysteresis (AUTO_BRIGHTNESS_HYSTERESIS_PCT) + step quantization, so the
+ *   backlight changes only a few times per day
+ * - changes use the hardware fade (BACKLIGHT_HW_FADE) when available
+ *
+ * Runtime on/off and the min..max range are set with PUT /api/display/brightness
+ * ("auto", "auto_min", "auto_max") and kept in a small config_manager blob.
+ */
+
+#ifndef AMBIENT_LIGHT_H
+#define AMBIENT_LIGHT_H
+
+#include "board_config.h"
+
+#if HAS_DISPLAY && HAS_LDR
+#define AMBIENT_LIGHT_SUPPORTED 1
+#else
+#define AMBIENT_LIGHT_SUPPORTED 0
+#endif
+
+#if AMBIENT_LIGHT_SUPPORTED
+
+#include <Arduino.h>
+
+struct AmbientLightStatus {
+    bool enabled;
+    uint8_t min_pct;
+    uint8_t max_pct;
+    uint8_t level_pct;     // filtered light level (0 = dark, 100 = bright)
+    uint8_t target_pct;    // brightness handed to the screen saver
+    uint16_t raw;          // last averaged ADC reading
+    uint32_t changes;      // backlight target changes since boot
+};
+
+void ambient_light_init();
+void ambient_light_loop(uint32_t now_ms);
+
+// Enable/disable auto-brightness and set its range (persisted).
+void ambient_light_configure(bool enabled, uint8_t min_pct, uint8_t max_pct);
+AmbientLightStatus ambient_light_get_status();
+
+#endif // AMBIENT_LIGHT_SUPPORTED
+
+#endif // AMBIENT_LIGHT_H
@@ -1,27 +1,49 @@
 #include "../version.h"
 #include "board_config.h"
+#include "board_profile.h"
 #include "config_manager.h"
 #include "web_portal.h"
 #include "log_manager.h"
 #include "mqtt_manager.h"
 #include "device_telemetry.h"
 #include "energy_monitor.h"
+#include "energy_history.h"
+#include "energy_thresholds.h"
+#include "energy_alarm.h"
+#include "energy_metrics.h"
+#include "energy_totals.h"
+#include "task_placement.h"
+#include "trace_ring.h"
+#include "boot_timeline.h"
+#include "wifi_fast_connect.h"
 #if HEALTH_HISTORY_ENABLED
 #include "health_history.h"
 #endif
+#include "p1_meter.h"
+#include "energy_fastpath.h"
+#include "wifi_power.h"
+#include "loop_scheduler.h"
+#include "crash_record.h"
 #include <WiFi.h>
 #include <ESPmDNS.h>
 #include <lwip/netif.h>
+#include <freertos/FreeRTOS.h>
+#include <freertos/semphr.h>
 
 #if HAS_DISPLAY
 #include "display_manager.h"
 #include "screen_saver_manager.h"
+#include "ambient_light.h"
 #endif
 
 #if HAS_TOUCH
 #include "touch_manager.h"
 #endif
 
+#if HAS_IMAGE_API && RGB565_CONVERT_BENCH_AT_BOOT
+#include "rgb565_convert.h"
+#endif
+
 // Configuration
 DeviceConfig device_config;
 bool config_loaded = false;
@@ -35,11 +57,9 @@ const unsigned long WIFI_BACKOFF_BASE = 3000; // 3 seconds base (DHCP typically
 
 // Heartbeat interval
 const unsigned long HEARTBEAT_INTERVAL = 60000; // 60 seconds
-unsigned long lastHeartbeat = 0;
 
 // WiFi watchdog for connection monitoring
 const unsigned long WIFI_CHECK_INTERVAL = 10000; // 10 seconds
-unsigned long lastWiFiCheck = 0;
 
 // WiFi event handlers for connection lifecycle monitoring
 void onWiFiConnected(WiFiEvent_t event, WiFiEventInfo_t info) {
@@ -48,11 +68,18 @@ void onWiFiConnected(WiFiEvent_t event, WiFiEventInfo_t info) {
 
 void onWiFiGotIP(WiFiEvent_t event, WiFiEventInfo_t info) {
   LOGI("WiFi", "Got IP: %s", WiFi.localIP().toString().c_str());
+  #if HAS_DISPLAY
+  display_manager_notify_info_changed();
+  #endif
 }
 
 void onWiFiDisconnected(WiFiEvent_t event, WiFiEventInfo_t info) {
   uint8_t reason = info.wifi_sta_disconnected.reason;
   LOGI("WiFi", "Disconnected - reason: %d", reason);
+  wifi_power_note_disconnect();
+  #if HAS_DISPLAY
+  display_manager_notify_info_changed();
+  #endif
 
   // Common disconnect reasons:
   // 2 = AUTH_EXPIRE, 3 = AUTH_LEAVE, 4 = ASSOC_EXPIRE
@@ -60,6 +87,70 @@ void onWiFiDisconnected(WiFiEvent_t event, WiFiEventInfo_t info) {
   // 201 = NO_AP_FOUND, 202 = AUTH_FAIL, 205 = HANDSHAKE_TIMEOUT
 }
 
+bool connect_wifi();
+void start_mdns();
+static void register_loop_jobs();
+
+// Boot-time connect: one retry after a WiFi hardware reset; starts mDNS on success.
+static bool boot_connect_wifi() {
+  BOOT_PHASE("wifi");
+  if (connect_wifi()) {
+    start_mdns();
+    return true;
+  }
+
+  // Hard reset retry - WiFi hardware may be in bad state
+  LOGW("Main", "WiFi failed - attempting hard reset");
+  LOGI("WiFi", "Hard reset start");
+  WiFi.mode(WIFI_OFF);
+  delay(1000);  // Longer delay to fully reset hardware
+  WiFi.mode(WIFI_STA);
+  delay(500);
+  LOGI("WiFi", "Hard reset complete");
+
+  // One more attempt after hard reset
+  if (connect_wifi()) {
+    start_mdns();
+    return true;
+  }
+  return false;
+}
+
+#if BOOT_PARALLEL_WIFI
+// Runs boot_connect_wifi() on the boot_wifi task so the scan/DHCP wait overlaps
+// display + LVGL init. setup() joins before starting the web portal.
+static SemaphoreHandle_t g_boot_wifi_done = nullptr;
+static volatile bool g_boot_wifi_ok = false;
+
+static void boot_wifi_task(void *) {
+  g_boot_wifi_ok = boot_connect_wifi();
+  xSemaphoreGive(g_boot_wifi_done);
+  vTaskDelete(nullptr);
+}
+
+static bool boot_wifi_start() {
+  g_boot_wifi_done = xSemaphoreCreateBinary();
+  if (!g_boot_wifi_done) return false;
+
+  TaskHandle_t handle = nullptr;
+  if (!task_placement_create(AppTask::BootWifi, boot_wifi_task, nullptr, &handle, nullptr)) {
+    LOGW("Main", "boot_wifi task failed - connecting inline");
+    vSemaphoreDelete(g_boot_wifi_done);
+    g_boot_wifi_done = nullptr;
+    return false;
+  }
+  return true;
+}
+
+static bool boot_wifi_join() {
+  const int phase = boot_phase_begin("wifi_join");
+  xSemaphoreTake(g_boot_wifi_done, portMAX_DELAY);
+  boot_phase_end(phase);
+  vSemaphoreDelete(g_boot_wifi_done);
+  g_boot_wifi_done = nullptr;
+  return g_boot_wifi_ok;
+}
+#endif
 
 void setup()
 {
@@ -70,8 +161,21 @@ void setup()
   #endif
 
   // Initialize logger (wraps Serial for web streaming)
+  int phase = boot_phase_begin("serial");
   log_init(115200);
   delay(1000);
+  boot_phase_end(phase);
+
+  phase = boot_phase_begin("early");
+
+  #if TRACE_RING_SUPPORTED
+  trace_ring_init();
+  #endif
+
+  #if CRASH_RECORD_SUPPORTED
+  // Persist the previous boot's crash breadcrumbs before loop() overwrites them.
+  crash_record_init();
+  #endif
 
   // Register WiFi event handlers for connection lifecycle
   WiFi.onEvent(onWiFiConnected, ARDUINO_EVENT_WIFI_STA_CONNECTED);
@@ -84,6 +188,10 @@ void setup()
   LOGI("SYS", "CPU: %d MHz", ESP.getCpuFreqMHz());
   LOGI("SYS", "Flash: %d MB", ESP.getFlashChipSize() / (1024 * 1024));
   LOGI("SYS", "MAC: %s", WiFi.macAddress().c_str());
+  if constexpr (kBoardProfile.psram == BoardPsram::Fitted) {
+    // PSRAM paths are compiled in unconditionally; allocations fall back to internal RAM.
+    if (!psramFound()) LOGE("SYS", "BOARD_PSRAM is 1 but no PSRAM was found (check the PSRAM build option)");
+  }
   #if HAS_BUILTIN_LED
   LOGI("SYS", "LED: GPIO%d (active %s)", LED_PIN, LED_ACTIVE_HIGH ? "HIGH" : "LOW");
   #endif
@@ -110,6 +218,9 @@ void setup()
   // Energy monitor state (updated by MQTT, read by LVGL task)
   energy_monitor_init();
 
+  // Device-side solar/grid history (/api/energy/history)
+  energy_history_start();
+
   #if HAS_DISPLAY
   // Screen saver defaults (v1)
   device_config.screen_saver_enabled = false;
@@ -128,27 +239,30 @@ void setup()
   pinMode(LED_PIN, OUTPUT);
   digitalWrite(LED_PIN, LED_ACTIVE_HIGH ? LOW : HIGH); // LED off initially
   #endif
+  boot_phase_end(phase);
 
-  #if HAS_DISPLAY
-  display_manager_init(&device_config);
-  display_manager_set_splash_status("Loading config...");
-  #endif
-
-  #if HAS_TOUCH
-  // Initialize touch after display is ready
-  touch_manager_init();
-  #endif
+  // Config is loaded before the display so WiFi can start connecting while the
+  // panel and LVGL initialize (and the display comes up with the saved brightness).
+  phase = boot_phase_begin("config");
 
   // Initialize configuration manager
-  #if HAS_DISPLAY
-  display_manager_set_splash_status("Init NVS...");
-  #endif
   config_manager_init();
 
+  // Restore kWh counters from their last NVS checkpoint
+  energy_totals_init();
+
   // Cache flash/sketch metadata early to avoid concurrent access from different tasks later
   // (e.g., MQTT publish + web API calls).
   device_telemetry_init();
 
+  // Log task core/priority placement (board_config.h TASK_* defines)
+  task_placement_log();
+
+  #if HAS_IMAGE_API && RGB565_CONVERT_BENCH_AT_BOOT
+  // One-off pixel-conversion throughput report (Mpx/s per kernel on this target)
+  rgb565_convert_benchmark_log();
+  #endif
+
   // Start CPU monitoring background task
   device_telemetry_start_cpu_monitoring();
 
@@ -156,9 +270,6 @@ void setup()
   device_telemetry_start_health_window_sampling();
 
   // Try to load saved configuration
-  #if HAS_DISPLAY
-  display_manager_set_splash_status("Reading config...");
-  #endif
   config_loaded = config_manager_load(&device_config);
 
   if (!config_loaded) {
@@ -168,18 +279,38 @@ void setup()
     device_config.magic = CONFIG_MAGIC;
   }
 
-  // Re-apply brightness from loaded config (display was initialized before config load)
-  #if HAS_DISPLAY && HAS_BACKLIGHT
-  LOGI("Main", "Applying loaded brightness: %d%%", device_config.backlight_brightness);
-  display_manager_set_backlight_brightness(device_config.backlight_brightness);
+  // Precompute energy tier colors/thresholds (shared by screen + warning checks)
+  energy_thresholds_compile(&device_config);
+  boot_phase_end(phase);
+
+  #if BOOT_PARALLEL_WIFI
+  // Start WiFi BEFORE initializing web server (critical for ESP32-C3); the boot
+  // task connects while the display initializes below.
+  bool wifi_started = false;
+  if (config_loaded) {
+    LOGI("Main", "Config loaded - connecting to WiFi (background)");
+    wifi_started = boot_wifi_start();
+  }
   #endif
 
   #if HAS_DISPLAY
+  phase = boot_phase_begin("display");
+  display_manager_init(&device_config);
+  const unsigned long splash_start_ms = millis();
+
+  #if HAS_TOUCH
+  // Initialize touch after display is ready
+  touch_manager_init();
+  #endif
+
   // Initialize screen saver manager after config is loaded.
   screen_saver_manager_init(&device_config);
+  #if AMBIENT_LIGHT_SUPPORTED
+  ambient_light_init();
+  #endif
+  boot_phase_end(phase);
   #endif
 
-  // Start WiFi BEFORE initializing web server (critical for ESP32-C3)
   #if HAS_DISPLAY
   display_manager_set_splash_status("Connecting WiFi...");
   #endif
@@ -188,52 +319,67 @@ void setup()
     LOGI("Main", "No config - starting AP mode");
     web_portal_start_ap();
   } else {
-    LOGI("Main", "Config loaded - connecting to WiFi");
-    if (connect_wifi()) {
-      start_mdns();
+    bool wifi_ok;
+    #if BOOT_PARALLEL_WIFI
+    if (wifi_started) {
+      wifi_ok = boot_wifi_join();
     } else {
-      // Hard reset retry - WiFi hardware may be in bad state
-      LOGW("Main", "WiFi failed - attempting hard reset");
-      LOGI("WiFi", "Hard reset start");
-      WiFi.mode(WIFI_OFF);
-      delay(1000);  // Longer delay to fully reset hardware
-      WiFi.mode(WIFI_STA);
-      delay(500);
-      LOGI("WiFi", "Hard reset complete");
-
-      // One more attempt after hard reset
-      if (connect_wifi()) {
-        start_mdns();
-      } else {
-        LOGW("Main", "WiFi failed after reset - fallback to AP");
-        web_portal_start_ap();
-      }
+      LOGI("Main", "Config loaded - connecting to WiFi");
+      wifi_ok = boot_connect_wifi();
+    }
+    #else
+    LOGI("Main", "Config loaded - connecting to WiFi");
+    wifi_ok = boot_connect_wifi();
+    #endif
+
+    if (!wifi_ok) {
+      LOGW("Main", "WiFi failed after reset - fallback to AP");
+      web_portal_start_ap();
     }
   }
 
   // Initialize web portal AFTER WiFi is started
+  phase = boot_phase_begin("web_portal");
   web_portal_init(&device_config);
+  boot_phase_end(phase);
 
   #if HAS_MQTT
   // Initialize MQTT manager (will only connect/publish when configured)
+  phase = boot_phase_begin("mqtt");
   char sanitized[CONFIG_DEVICE_NAME_MAX_LEN];
   config_manager_sanitize_device_name(device_config.device_name, sanitized, sizeof(sanitized));
   mqtt_manager.begin(&device_config, device_config.device_name, sanitized);
+  // Broker connects/timeouts run on their own task instead of stalling loop().
+  mqtt_manager.startTask();
+  boot_phase_end(phase);
+  #endif
+
+  #if P1_METER_SUPPORTED
+  // Local P1 meter polling (task starts once p1_meter_url is configured).
+  p1_meter_init(&device_config);
   #endif
 
-  lastHeartbeat = millis();
+  register_loop_jobs();
   LOGI("Main", "Setup complete");
+  boot_milestone("setup_done");
 
   // Snapshot after all subsystems are initialized.
   device_telemetry_log_memory_snapshot("setup");
 
   #if HAS_DISPLAY
-  // Show splash for minimum duration to ensure visibility
+  // Keep the splash up for a minimum duration to ensure visibility. Boot work
+  // since display init already counts towards it.
   display_manager_set_splash_status("Ready!");
-  delay(2000);  // 2 seconds to see splash + status updates
+  const unsigned long splash_elapsed = millis() - splash_start_ms;
+  if (splash_elapsed < (unsigned long)BOOT_SPLASH_MIN_MS) {
+    phase = boot_phase_begin("splash_hold");
+    delay(BOOT_SPLASH_MIN_MS - splash_elapsed);
+    boot_phase_end(phase);
+  }
 
   // Navigate to energy monitor screen
   display_manager_show_energy_monitor();
+  boot_milestone("first_frame");
 
   // Start the screen saver inactivity timer after the first runtime screen is visible.
   // This avoids counting boot + splash time as "inactivity".
@@ -243,70 +389,151 @@ void setup()
 
 void loop()
 {
+  // Periodic work is registered in register_loop_jobs(); sleep until the next deadline.
+  loop_scheduler_idle(loop_scheduler_run());
+}
+
+// Loop jobs: each runs from loop_scheduler_run() at its period (see register_loop_jobs()).
+static void job_ui(uint32_t now) {
   #if HAS_DISPLAY
+  #if AMBIENT_LIGHT_SUPPORTED
+  ambient_light_loop(now);
+  #endif
   screen_saver_manager_loop();
   #endif
 
   #if HAS_TOUCH
   touch_manager_loop();
   #endif
+  (void)now;
+}
 
+static void job_web_portal(uint32_t) {
   // Handle web portal (DNS for captive portal)
   web_portal_handle();
+}
 
-  #if HAS_IMAGE_API
+#if HAS_IMAGE_API
+static void job_pending_images(uint32_t) {
   // Process pending image uploads (deferred decoding)
   web_portal_process_pending_images();
-  #endif
+}
+#endif
 
-  #if HAS_MQTT
-  mqtt_manager.loop();
-  #endif
+#if HAS_MQTT
+static void job_mqtt_fallback(uint32_t) {
+  // Fallback only: normally MQTT runs on its own task (see startTask()).
+  if (!mqtt_manager.taskRunning()) {
+    mqtt_manager.loop();
+  }
+}
+#endif
 
+#if ENERGY_METRICS_SUPPORTED
+static void job_energy_metrics(uint32_t now) {
+  // Derived metrics to MQTT (deadbands + min interval; queued, never blocks).
+  energy_metrics_loop(now);
+}
+#endif
+
+#if CRASH_RECORD_SUPPORTED
+static void job_crash_record(uint32_t now) {
+  // RTC breadcrumbs for /api/diagnostics/last_crash after a panic or WDT reset.
+  crash_record_snapshot(now);
+}
+#endif
+
+static void job_energy_render(uint32_t now) {
+  // Trailing render request for energy updates coalesced by ENERGY_INGEST_MIN_RENDER_MS.
+  energy_monitor_loop(now);
+
+  // Alarm clear delay expiring without a new value, or a thresholds recompile.
+  energy_alarm_loop(now);
+}
+
+static void job_housekeeping(uint32_t now) {
   // Lightweight telemetry tripwires (runs from main loop only).
   device_telemetry_check_tripwires();
 
-  unsigned long currentMillis = millis();
+  // Write-behind config saves (live tuning from the portal/API).
+  config_manager_persist_loop(now);
+}
+
+static void job_network(uint32_t now) {
+  // Rate-limited kWh counter checkpoints (NVS writes stay on the main loop).
+  energy_totals_loop(now);
+
+  #if P1_METER_SUPPORTED
+  p1_meter_loop();
+  #endif
+
+  #if ENERGY_FASTPATH_SUPPORTED
+  // Multicast/ESP-NOW energy frames are received in callbacks; this only (re)joins.
+  energy_fastpath_loop();
+  #endif
+
+  // WiFi power-save profile follows the screen saver (plus per-profile RSSI samples).
+  wifi_power_loop();
+}
 
-  // WiFi watchdog - monitor connection and reconnect if needed
+// WiFi watchdog - monitor connection and reconnect if needed
+static void job_wifi_watchdog(uint32_t) {
   // Only run if we're not in AP mode (AP mode is the fallback, should stay active)
-  if (config_loaded && !web_portal_is_ap_mode() && currentMillis - lastWiFiCheck >= WIFI_CHECK_INTERVAL) {
-    if (WiFi.status() != WL_CONNECTED && strlen(device_config.wifi_ssid) > 0) {
-      LOGW("WIFI", "Watchdog: connection lost - attempting reconnect");
-      if (connect_wifi()) {
-        start_mdns();
-      }
+  if (!config_loaded || web_portal_is_ap_mode()) return;
+  if (WiFi.status() != WL_CONNECTED && strlen(device_config.wifi_ssid) > 0) {
+    LOGW("WIFI", "Watchdog: connection lost - attempting reconnect");
+    if (connect_wifi()) {
+      start_mdns();
     }
-    lastWiFiCheck = currentMillis;
   }
+}
 
-  // Check if it's time for heartbeat
-  if (currentMillis - lastHeartbeat >= HEARTBEAT_INTERVAL) {
-    const DeviceMemorySnapshot mem = device_telemetry_get_memory_snapshot();
-    if (WiFi.status() == WL_CONNECTED) {
-      LOGI("Heartbeat", "Up:%ds heap=%u min=%u int=%u min=%u psram=%u | WiFi:%s (%s)",
-        currentMillis / 1000,
-        (unsigned)mem.heap_free_bytes,
-        (unsigned)mem.heap_min_free_bytes,
-        (unsigned)mem.heap_internal_free_bytes,
-        (unsigned)mem.heap_internal_min_free_bytes,
-        (unsigned)mem.psram_free_bytes,
-        WiFi.localIP().toString().c_str(),
-        WiFi.getHostname());
-    } else {
-      LOGI("Heartbeat", "Up:%ds heap=%u min=%u int=%u min=%u psram=%u | WiFi: Disconnected",
-        currentMillis / 1000,
-        (unsigned)mem.heap_free_bytes,
-        (unsigned)mem.heap_min_free_bytes,
-        (unsigned)mem.heap_internal_free_bytes,
-        (unsigned)mem.heap_internal_min_free_bytes,
-        (unsigned)mem.psram_free_bytes);
-    }
-
-    lastHeartbeat = currentMillis;
+static void job_heartbeat(uint32_t now) {
+  const DeviceMemorySnapshot mem = device_telemetry_get_memory_snapshot();
+  if (WiFi.status() == WL_CONNECTED) {
+    LOGI("Heartbeat", "Up:%ds heap=%u min=%u int=%u min=%u psram=%u | WiFi:%s (%s)",
+      now / 1000,
+      (unsigned)mem.heap_free_bytes,
+      (unsigned)mem.heap_min_free_bytes,
+      (unsigned)mem.heap_internal_free_bytes,
+      (unsigned)mem.heap_internal_min_free_bytes,
+      (unsigned)mem.psram_free_bytes,
+      WiFi.localIP().toString().c_str(),
+      WiFi.getHostname());
+  } else {
+    LOGI("Heartbeat", "Up:%ds heap=%u min=%u int=%u min=%u psram=%u | WiFi: Disconnected",
+      now / 1000,
+      (unsigned)mem.heap_free_bytes,
+      (unsigned)mem.heap_min_free_bytes,
+      (unsigned)mem.heap_internal_free_bytes,
+      (unsigned)mem.heap_internal_min_free_bytes,
+      (unsigned)mem.psram_free_bytes);
   }
+}
 
-  delay(10);
+// Periods replace the old per-check millis() comparisons; budgets only feed the
+// overrun counters in /api/health/tasks.
+static void register_loop_jobs() {
+  loop_scheduler_add("ui", job_ui, 10, 2000);
+  loop_scheduler_add("web_portal", job_web_portal, 10, 2000);
+  #if HAS_IMAGE_API
+  // Decoding a queued upload legitimately takes a while; the budget catches outliers.
+  loop_scheduler_add("images", job_pending_images, 10, 200000);
+  #endif
+  #if HAS_MQTT
+  loop_scheduler_add("mqtt_fallback", job_mqtt_fallback, 10, 20000);
+  #endif
+  loop_scheduler_add("energy_render", job_energy_render, 10, 1000);
+  #if ENERGY_METRICS_SUPPORTED
+  loop_scheduler_add("energy_metrics", job_energy_metrics, 250, 1000);
+  #endif
+  loop_scheduler_add("housekeeping", job_housekeeping, 100, 50000);
+  #if CRASH_RECORD_SUPPORTED
+  loop_scheduler_add("crash_record", job_crash_record, CRASH_RECORD_SNAPSHOT_MS, 5000);
+  #endif
+  loop_scheduler_add("network", job_network, 1000, 20000);
+  loop_scheduler_add("wifi_watchdog", job_wifi_watchdog, WIFI_CHECK_INTERVAL, 0);
+  loop_scheduler_add("heartbeat", job_heartbeat, HEARTBEAT_INTERVAL, 5000);
 }
 
 // Connect to WiFi with exponential backoff
@@ -314,6 +541,47 @@ bool connect_wifi() {
   LOGI("WiFi", "Connection start");
   LOGI("WiFi", "SSID: %s", device_config.wifi_ssid);
 
+  const unsigned long connect_start_ms = millis();
+  WifiConnectTiming timing = {};
+
+  // Common success path: log, remember the AP/lease, report phase timings.
+  auto finish = [&](bool ok, unsigned long begin_ms) -> bool {
+    const unsigned long now = millis();
+    timing.ok = ok;
+    timing.total_ms = (uint32_t)(now - connect_start_ms);
+    if (begin_ms) timing.assoc_ms = (uint32_t)(now - begin_ms);
+    wifi_fast_connect_record(timing);
+    LOGI("WiFi", "Connect timing: total=%lums reset=%lums scan=%lums assoc=%lums (%s%s)",
+      (unsigned long)timing.total_ms, (unsigned long)timing.reset_ms,
+      (unsigned long)timing.scan_ms, (unsigned long)timing.assoc_ms,
+      timing.fast ? "cached AP" : "scan", ok ? "" : ", failed");
+    if (!ok) return false;
+
+    LOGI("WiFi", "IP: %s", WiFi.localIP().toString().c_str());
+    LOGI("WiFi", "Hostname: %s", WiFi.getHostname());
+    LOGI("WiFi", "MAC: %s", WiFi.macAddress().c_str());
+    LOGI("WiFi", "Signal: %d dBm", WiFi.RSSI());
+    LOGI("WiFi", "Access: http://%s", WiFi.localIP().toString().c_str());
+    LOGI("WiFi", "Access: http://%s.local", WiFi.getHostname());
+    LOGI("WiFi", "Connected");
+
+    #if WIFI_FAST_CONNECT_ENABLED
+    WifiFastConnectEntry entry = {};
+    const uint8_t *bssid = WiFi.BSSID();
+    if (bssid) {
+      memcpy(entry.bssid, bssid, 6);
+      entry.channel = (uint8_t)WiFi.channel();
+      entry.ip = (uint32_t)WiFi.localIP();
+      entry.gateway = (uint32_t)WiFi.gatewayIP();
+      entry.subnet = (uint32_t)WiFi.subnetMask();
+      entry.dns1 = (uint32_t)WiFi.dnsIP(0);
+      entry.dns2 = (uint32_t)WiFi.dnsIP(1);
+      wifi_fast_connect_store(device_config.wifi_ssid, entry);
+    }
+    #endif
+    return true;
+  };
+
   // Helper: format BSSID as string
   auto format_bssid = [](const uint8_t *bssid, char *out, size_t out_len) {
     if (!out || out_len < 18) return;
@@ -396,9 +664,9 @@ bool connect_wifi() {
   WiFi.mode(WIFI_STA);    // Back to station mode
   delay(100);
 
-  // Disable WiFi sleep (power-save). Improves latency and often stability,
-  // at the cost of higher power consumption.
-  WiFi.setSleep(false);
+  // Modem power-save per profile (WIFI_POWER_*): no sleep while the display is
+  // awake by default; switched with the screen saver state in wifi_power_loop().
+  wifi_power_begin();
 
   // Enable auto-reconnect at WiFi stack level
   WiFi.setAutoReconnect(true);
@@ -469,12 +737,56 @@ bool connect_wifi() {
 
     LOGI("WiFi", "IP: %s", device_config.fixed_ip);
   }
+  timing.reset_ms = (uint32_t)(millis() - connect_start_ms);
+
+  #if WIFI_FAST_CONNECT_ENABLED
+  // Direct connect to the last good AP: no scan, and optionally no DHCP round trip.
+  WifiFastConnectEntry cached;
+  if (wifi_fast_connect_load(device_config.wifi_ssid, &cached)) {
+    timing.fast_tried = true;
+    char bssid_str[18];
+    format_bssid(cached.bssid, bssid_str, sizeof(bssid_str));
+    LOGI("WiFi", "Fast connect: %s | Ch %u", bssid_str, (unsigned)cached.channel);
+
+    bool lease_applied = false;
+    #if WIFI_FAST_CONNECT_REUSE_IP
+    if (strlen(device_config.fixed_ip) == 0 && cached.ip != 0 && cached.gateway != 0 && cached.subnet != 0) {
+      lease_applied = WiFi.config(IPAddress(cached.ip), IPAddress(cached.gateway), IPAddress(cached.subnet),
+        IPAddress(cached.dns1), IPAddress(cached.dns2));
+    }
+    #endif
+
+    const unsigned long begin_ms = millis();
+    WiFi.begin(device_config.wifi_ssid, device_config.wifi_password, cached.channel, cached.bssid);
+    while (millis() - begin_ms < (unsigned long)WIFI_FAST_CONNECT_TIMEOUT_MS) {
+      const wl_status_t status = WiFi.status();
+      if (status == WL_CONNECTED) {
+        timing.fast = true;
+        return finish(true, begin_ms);
+      }
+      if (status == WL_CONNECT_FAILED || status == WL_NO_SSID_AVAIL) break;
+      delay(50);
+    }
+
+    LOGW("WiFi", "Fast connect failed (%d) - scanning", (int)WiFi.status());
+    wifi_fast_connect_invalidate();
+    WiFi.disconnect();
+    if (lease_applied) {
+      // Back to DHCP for the regular path.
+      WiFi.config(INADDR_NONE, INADDR_NONE, INADDR_NONE);
+    }
+    delay(100);
+  }
+  #endif
 
   // Prefer the strongest AP when multiple BSSIDs exist for the same SSID.
   uint8_t best_bssid[6];
   int best_channel = 0;
   int best_rssi = 0;
+  const unsigned long scan_start_ms = millis();
   const bool has_best_ap = select_strongest_ap(device_config.wifi_ssid, best_bssid, &best_channel, &best_rssi);
+  timing.scan_ms = (uint32_t)(millis() - scan_start_ms);
+  const unsigned long begin_ms = millis();
   if (has_best_ap) {
     WiFi.begin(device_config.wifi_ssid, device_config.wifi_password, best_channel, best_bssid);
   } else {
@@ -491,15 +803,7 @@ bool connect_wifi() {
     while (millis() - start < backoff) {
       wl_status_t status = WiFi.status();
       if (status == WL_CONNECTED) {
-        LOGI("WiFi", "IP: %s", WiFi.localIP().toString().c_str());
-        LOGI("WiFi", "Hostname: %s", WiFi.getHostname());
-        LOGI("WiFi", "MAC: %s", WiFi.macAddress().c_str());
-        LOGI("WiFi", "Signal: %d dBm", WiFi.RSSI());
-        LOGI("WiFi", "Access: http://%s", WiFi.localIP().toString().c_str());
-        LOGI("WiFi", "Access: http://%s.local", WiFi.getHostname());
-        LOGI("WiFi", "Connected");
-
-        return true;
+        return finish(true, begin_ms);
       }
       delay(100);
     }
@@ -518,7 +822,7 @@ bool connect_wifi() {
   }
 
   LOGE("WiFi", "All attempts failed");
-  return false;
+  return finish(false, begin_ms);
 }
 
 // Start mDNS service with enhanced TXT records
@@ -0,0 +1,181 @@
+#include "app_alloc.h"
+
+#include "board_profile.h"
+
+#include <Arduino.h>
+#include <esp_heap_caps.h>
+#if ESP_ARDUINO_VERSION_MAJOR >= 3
+#include <esp_memory_utils.h>
+#else
+#include <soc/soc_memory_layout.h>
+#endif
+#include <freertos/FreeRTOS.h>
+#include <freertos/portmacro.h>
+#include <soc/soc_caps.h>
+#include <string.h>
+
+namespace {
+
+static constexpr size_t kTagCount = (size_t)AllocTag::Count;
+
+static const char* const kTagNames[kTagCount] = {
+    "lvgl", "json", "image", "decode", "history", "mqtt", "log", "stack", "other",
+};
+
+#if APP_ALLOC_ACCOUNTING
+static portMUX_TYPE s_mux = portMUX_INITIALIZER_UNLOCKED;
+static AllocTagStats s_stats[kTagCount] = {};
+
+// heap_caps_get_allocated_size() needs IDF 5.x (Arduino core 3.x). On older cores the
+// byte counters stay at zero and only allocs/failed are meaningful.
+static inline size_t block_size(void* p) {
+#if ESP_ARDUINO_VERSION_MAJOR >= 3
+    return heap_caps_get_allocated_size(p);
+#else
+    (void)p;
+    return 0;
+#endif
+}
+
+static inline bool in_psram(const void* p) {
+#if SOC_SPIRAM_SUPPORTED
+    return esp_ptr_external_ram(p);
+#else
+    (void)p;
+    return false;
+#endif
+}
+
+static void note_alloc(AllocTag tag, void* p) {
+    const size_t n = block_size(p);
+    const bool ext = in_psram(p);
+    AllocTagStats& s = s_stats[(size_t)tag];
+    portENTER_CRITICAL(&s_mux);
+    s.allocs++;
+    s.live_bytes += (uint32_t)n;
+    if (ext) s.live_psram_bytes += (uint32_t)n;
+    if (s.live_bytes > s.peak_bytes) s.peak_bytes = s.live_bytes;
+    portEXIT_CRITICAL(&s_mux);
+}
+
+static void note_free(AllocTag tag, size_t n, bool ext) {
+    AllocTagStats& s = s_stats[(size_t)tag];
+    portENTER_CRITICAL(&s_mux);
+    s.live_bytes = (s.live_bytes > n) ? (uint32_t)(s.live_bytes - n) : 0;
+    if (ext) s.live_psram_bytes = (s.live_psram_bytes > n) ? (uint32_t)(s.live_psram_bytes - n) : 0;
+    portEXIT_CRITICAL(&s_mux);
+}
+
+static void note_failed(AllocTag tag) {
+    portENTER_CRITICAL(&s_mux);
+    s_stats[(size_t)tag].failed++;
+    portEXIT_CRITICAL(&s_mux);
+}
+#endif
+
+// Fallback chain of heap_caps flags for a policy; returns its length.
+static size_t policy_caps(AllocPolicy policy, uint32_t out[3]) {
+    size_t n = 0;
+    switch (policy) {
+        case AllocPolicy::PreferPsram:
+            if (board_psram_available()) out[n++] = MALLOC_CAP_SPIRAM | MALLOC_CAP_8BIT;
+            out[n++] = MALLOC_CAP_INTERNAL | MALLOC_CAP_8BIT;
+            break;
+        case AllocPolicy::Any8bit:
+            if (board_psram_available()) out[n++] = MALLOC_CAP_SPIRAM | MALLOC_CAP_8BIT;
+            out[n++] = MALLOC_CAP_INTERNAL | MALLOC_CAP_8BIT;
+            // Some no-PSRAM boards have 8-bit regions that INTERNAL|8BIT excludes.
+            out[n++] = MALLOC_CAP_8BIT;
+            break;
+        case AllocPolicy::PsramOnly:
+            if (board_psram_available()) out[n++] = MALLOC_CAP_SPIRAM | MALLOC_CAP_8BIT;
+            break;
+        case AllocPolicy::Internal:
+            out[n++] = MALLOC_CAP_INTERNAL | MALLOC_CAP_8BIT;
+            break;
+        case AllocPolicy::Dma:
+            out[n++] = MALLOC_CAP_DMA | MALLOC_CAP_INTERNAL;
+            break;
+    }
+    return n;
+}
+
+} // namespace
+
+void* app_alloc(AllocTag tag, size_t size, AllocPolicy policy) {
+    if (size == 0 || tag >= AllocTag::Count) return nullptr;
+
+    uint32_t caps[3];
+    const size_t n = policy_caps(policy, caps);
+    void* p = nullptr;
+    for (size_t i = 0; i < n && !p; i++) {
+        p = heap_caps_malloc(size, caps[i]);
+    }
+
+#if APP_ALLOC_ACCOUNTING
+    if (p) note_alloc(tag, p);
+    else note_failed(tag);
+#endif
+    return p;
+}
+
+void* app_realloc(AllocTag tag, void* ptr, size_t size, AllocPolicy policy) {
+    if (!ptr) return app_alloc(tag, size, policy);
+    if (size == 0) {
+        app_free(tag, ptr);
+        return nullptr;
+    }
+    if (tag >= AllocTag::Count) return nullptr;
+
+#if APP_ALLOC_ACCOUNTING
+    const size_t old_n = block_size(ptr);
+    const bool old_ext = in_psram(ptr);
+#endif
+
+    uint32_t caps[3];
+    const size_t n = policy_caps(policy, caps);
+    void* p = nullptr;
+    for (size_t i = 0; i < n && !p; i++) {
+        p = heap_caps_realloc(ptr, size, caps[i]);
+    }
+
+#if APP_ALLOC_ACCOUNTING
+    if (p) {
+        note_free(tag, old_n, old_ext);
+        note_alloc(tag, p);
+    } else {
+        note_failed(tag);
+    }
+#endif
+    return p;
+}
+
+void app_free(AllocTag tag, void* ptr) {
+    if (!ptr) return;
+#if APP_ALLOC_ACCOUNTING
+    if (tag < AllocTag::Count) {
+        note_free(tag, block_size(ptr), in_psram(ptr));
+    }
+#else
+    (void)tag;
+#endif
+    heap_caps_free(ptr);
+}
+
+const char* app_alloc_tag_name(AllocTag tag) {
+    if (tag >= AllocTag::Count) return "unknown";
+    return kTagNames[(size_t)tag];
+}
+
+void app_alloc_get_stats(AllocTag tag, AllocTagStats* out) {
+    if (!out) return;
+    memset(out, 0, sizeof(*out));
+#if APP_ALLOC_ACCOUNTING
+    if (tag >= AllocTag::Count) return;
+    portENTER_CRITICAL(&s_mux);
+    *out = s_stats[(size_t)tag];
+    portEXIT_CRITICAL(&s_mux);
+#else
+    (void)tag;
+#endif
+}
@@ -0,0 +1,64 @@
+#pragma once
+
+#include "board_config.h"
+
+#include <stddef.h>
+#include <stdint.h>
+
+// Tagged heap facade for the firmware's large, long-lived buffers.
+//
+// Every subsystem that used to pick heap_caps flags on its own (LVGL's heap, JSON
+// documents, image/decode buffers, history rings, the MQTT outbox, the log stream)
+// now allocates here with a tag and a placement policy. The facade owns the fallback
+// chain per policy, so "PSRAM first, then internal" is written once, and keeps per-tag
+// counters (live bytes, peak, failed requests) that /api/health reports. An OOM can
+// then be pinned on a subsystem instead of on "the heap".
+//
+// Sizes are taken from heap_caps_get_allocated_size(), so no header is added to the
+// blocks and pointers stay interchangeable with heap_caps_free(). The counters are a
+// spinlock-guarded handful of integers; with APP_ALLOC_ACCOUNTING false only the
+// policy chain remains.
+
+enum class AllocTag : uint8_t {
+    Lvgl = 0,
+    Json,
+    Image,
+    Decode,
+    History,
+    Mqtt,
+    Log,
+    Stack,
+    Other,
+    Count
+};
+
+enum class AllocPolicy : uint8_t {
+    PreferPsram = 0,   // PSRAM, then internal 8-bit
+    Any8bit,           // PSRAM, then internal 8-bit, then any 8-bit capable region
+    PsramOnly,         // PSRAM or nothing
+    Internal,          // internal 8-bit only (latency-sensitive or ISR-adjacent data)
+    Dma,               // internal DMA-capable memory
+};
+
+struct AllocTagStats {
+    uint32_t live_bytes;
+    uint32_t peak_bytes;
+    uint32_t live_psram_bytes;   // part of live_bytes that sits in PSRAM
+    uint32_t allocs;
+    uint32_t failed;
+};
+
+// nullptr for size 0 or when every region of the policy is exhausted (counted as failed).
+void* app_alloc(AllocTag tag, size_t size, AllocPolicy policy = AllocPolicy::PreferPsram);
+
+// Same contract as realloc(): nullptr/0 behave like alloc/free; on failure the old block
+// is left intact and owned by the caller.
+void* app_realloc(AllocTag tag, void* ptr, size_t size, AllocPolicy policy = AllocPolicy::PreferPsram);
+
+// Release a block from app_alloc()/app_realloc() with the same tag (nullptr is a no-op).
+void app_free(AllocTag tag, void* ptr);
+
+// Short lowercase name used as the JSON key ("lvgl", "json", ...).
+const char* app_alloc_tag_name(AllocTag tag);
+
+void app_alloc_get_stats(AllocTag tag, AllocTagStats* out);
@@ -0,0 +1,59 @@
+#include "backlight_pwm.h"
+
+#if HAS_DISPLAY
+
+#include <math.h>
+
+#if ESP_ARDUINO_VERSION_MAJOR >= 3
+#include <driver/ledc.h>
+#include <esp32-hal-periman.h>
+#endif
+
+// Pins with a hardware fade in flight (GPIO < 64).
+static uint64_t g_fading_pins = 0;
+
+uint32_t backlight_pwm_duty(uint8_t percent, bool active_low) {
+    if (percent > 100) percent = 100;
+
+    uint32_t duty;
+    #if BACKLIGHT_GAMMA_CORRECTION
+    duty = (uint32_t)lroundf(255.0f * powf((float)percent / 100.0f, BACKLIGHT_GAMMA));
+    // Keep the lowest settings visibly on rather than rounding to off.
+    if (percent > 0 && duty == 0) duty = 1;
+    #else
+    duty = ((uint32_t)percent * 255) / 100;
+    #endif
+
+    return active_low ? 255 - duty : duty;
+}
+
+void backlight_pwm_stop_fade(uint8_t pin) {
+    #if ESP_ARDUINO_VERSION_MAJOR >= 3
+    if (pin >= 64 || !(g_fading_pins & (1ULL << pin))) return;
+    g_fading_pins &= ~(1ULL << pin);
+
+    // ledcWrite/ledcFade would otherwise block until the running fade completes.
+    ledc_channel_handle_t* bus = (ledc_channel_handle_t*)perimanGetPinBus(pin, ESP32_BUS_TYPE_LEDC);
+    if (!bus) return;
+    ledc_fade_stop((ledc_mode_t)(bus->channel / SOC_LEDC_CHANNEL_NUM), (ledc_channel_t)(bus->channel % SOC_LEDC_CHANNEL_NUM));
+    #else
+    (void)pin;
+    #endif
+}
+
+bool backlight_pwm_fade(uint8_t pin, uint32_t target_duty, uint16_t duration_ms) {
+    #if ESP_ARDUINO_VERSION_MAJOR >= 3 && BACKLIGHT_HW_FADE
+    backlight_pwm_stop_fade(pin);
+    const uint32_t from = ledcRead(pin);
+    if (!ledcFade(pin, from, target_duty, duration_ms)) return false;
+    if (pin < 64) g_fading_pins |= (1ULL << pin);
+    return true;
+    #else
+    (void)pin;
+    (void)target_duty;
+    (void)duration_ms;
+    return false;
+    #endif
+}
+
+#endif // HAS_DISPLAY
@@ -0,0 +1,42 @@
+/*
+ * Backlight PWM helpers (LEDC)
+ *
+ * Shared by the LEDC-based display drivers:
+ * - backlight_pwm_duty(): 0-100% -> 8-bit duty on a gamma curve
+ *   (BACKLIGHT_GAMMA), so equal brightness steps look equal
+ * - backlight_pwm_fade(): hands a fade to the LEDC fade engine; it runs in
+ *   hardware and stays smooth no matter how busy loop() is
+ *
+ * Hardware fades need the Arduino core 3.x LEDC API (ledcFade); on 2.x
+ * backlight_pwm_fade() returns false and callers fall back to software steps.
+ */
+
+#ifndef BACKLIGHT_PWM_H
+#define BACKLIGHT_PWM_H
+
+#include "board_config.h"
+
+#if HAS_DISPLAY
+
+#include <Arduino.h>
+
+// TFT_BACKLIGHT_ON (board override) gives the "on" level; LOW means active-low PWM.
+#if defined(TFT_BACKLIGHT_ON)
+#define BACKLIGHT_PWM_ACTIVE_LOW (!TFT_BACKLIGHT_ON)
+#else
+#define BACKLIGHT_PWM_ACTIVE_LOW false
+#endif
+
+// Gamma-corrected duty for `percent` (clamped to 100); inverted when `active_low`.
+uint32_t backlight_pwm_duty(uint8_t percent, bool active_low);
+
+// Start a hardware fade from the pin's current duty to `target_duty`.
+// Any fade still running on the pin is stopped first. False when unsupported.
+bool backlight_pwm_fade(uint8_t pin, uint32_t target_duty, uint16_t duration_ms);
+
+// Stop a running fade (hold the current duty) before a direct duty write.
+void backlight_pwm_stop_fade(uint8_t pin);
+
+#endif // HAS_DISPLAY
+
+#endif // BACKLIGHT_PWM_H
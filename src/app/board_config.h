@@ -60,6 +60,11 @@
 #define LED_ACTIVE_HIGH true  // true = HIGH turns LED on, false = LOW turns LED on
 #endif
 
+// PSRAM fitted on this board: -1 = detect at boot, 0 = none (PSRAM paths compile out), 1 = fitted (see board_profile.h).
+#ifndef BOARD_PSRAM
+#define BOARD_PSRAM -1
+#endif
+
 // ============================================================================
 // Default WiFi Configuration
 // ============================================================================
@@ -69,6 +74,41 @@
 #define WIFI_MAX_ATTEMPTS 3
 #endif
 
+// Try the last good BSSID/channel (cached in RTC memory + NVS) before scanning for the strongest AP.
+#ifndef WIFI_FAST_CONNECT_ENABLED
+#define WIFI_FAST_CONNECT_ENABLED true
+#endif
+
+// Give up on the cached AP after this long and fall back to the scan (ms).
+#ifndef WIFI_FAST_CONNECT_TIMEOUT_MS
+#define WIFI_FAST_CONNECT_TIMEOUT_MS 4000
+#endif
+
+// Also reuse the last DHCP lease as a static IP on the fast path (skips DHCP; risks a conflict if the router reassigned it).
+#ifndef WIFI_FAST_CONNECT_REUSE_IP
+#define WIFI_FAST_CONNECT_REUSE_IP false
+#endif
+
+// WiFi modem power-save profile while the display is awake: 0 = performance (no sleep), 1 = balanced (min modem), 2 = low power (max modem).
+#ifndef WIFI_POWER_AWAKE_PROFILE
+#define WIFI_POWER_AWAKE_PROFILE 0
+#endif
+
+// WiFi power-save profile while the screen saver has the display asleep (same values; boards without display stay on the awake profile).
+#ifndef WIFI_POWER_ASLEEP_PROFILE
+#define WIFI_POWER_ASLEEP_PROFILE 2
+#endif
+
+// Beacon intervals between wakeups in the low-power profile (announced to the AP at association).
+#ifndef WIFI_POWER_LISTEN_INTERVAL
+#define WIFI_POWER_LISTEN_INTERVAL 3
+#endif
+
+// Period of the MQTT round-trip probe (publish to an own topic and time the echo; 0 = off), ms.
+#ifndef WIFI_POWER_RTT_PROBE_MS
+#define WIFI_POWER_RTT_PROBE_MS 30000
+#endif
+
 // ============================================================================
 // Additional Default Configuration Settings
 // ============================================================================
@@ -117,11 +157,56 @@
 #define HEALTH_POLL_INTERVAL_MS 5000
 #endif
 
+// Sampling period of the /api/health *_min_window / *_max_window bands (ms).
+#ifndef HEALTH_WINDOW_SAMPLE_MS
+#define HEALTH_WINDOW_SAMPLE_MS 100
+#endif
+
 // How much client-side history (sparklines) to keep.
 #ifndef HEALTH_HISTORY_SECONDS
 #define HEALTH_HISTORY_SECONDS 300
 #endif
 
+// Serve /api/health and MQTT health publishes from a pre-serialized snapshot rebuilt ~1 Hz by the CPU monitoring task.
+#ifndef HEALTH_SNAPSHOT_ENABLED
+#define HEALTH_SNAPSHOT_ENABLED true
+#endif
+
+// Push health snapshots and energy changes to the portal over SSE (/api/events, requires HEALTH_SNAPSHOT_ENABLED).
+#ifndef PORTAL_EVENTS_ENABLED
+#define PORTAL_EVENTS_ENABLED true
+#endif
+
+// Concurrent /api/events clients (more get 429 and fall back to polling).
+#ifndef PORTAL_EVENTS_MAX_CLIENTS
+#define PORTAL_EVENTS_MAX_CLIENTS 3
+#endif
+
+// Minimum spacing of health events per client (ms).
+#ifndef PORTAL_EVENTS_HEALTH_MIN_MS
+#define PORTAL_EVENTS_HEALTH_MIN_MS 2000
+#endif
+
+// Minimum spacing of energy events per client (ms); changes inside the window are coalesced.
+#ifndef PORTAL_EVENTS_ENERGY_MIN_MS
+#define PORTAL_EVENTS_ENERGY_MIN_MS 250
+#endif
+
+// Per-subsystem heap counters of app_alloc (live/peak/failed per tag, reported in /api/health).
+#ifndef APP_ALLOC_ACCOUNTING
+#define APP_ALLOC_ACCOUNTING true
+#endif
+
+// GET /api/display/screenshot: stream the current LVGL screen as a BMP (HAS_DISPLAY only).
+#ifndef SCREENSHOT_ENABLED
+#define SCREENSHOT_ENABLED true
+#endif
+
+// Rows re-rendered per screenshot band (band buffer = width x rows pixels).
+#ifndef SCREENSHOT_BAND_ROWS
+#define SCREENSHOT_BAND_ROWS 16
+#endif
+
 // ============================================================================
 // Optional: Device-side Health History (/api/health/history)
 // ============================================================================
@@ -137,6 +222,11 @@
 #define HEALTH_HISTORY_PERIOD_MS 5000
 #endif
 
+// Memory cap of the device-side history ring (bytes, 16 B per packed sample: 26400 = 1650 samples).
+#ifndef HEALTH_HISTORY_MAX_BYTES
+#define HEALTH_HISTORY_MAX_BYTES 26400
+#endif
+
 #if HEALTH_HISTORY_ENABLED
 // Derived number of samples.
 #ifndef HEALTH_HISTORY_SAMPLES
@@ -156,9 +246,364 @@
 #error HEALTH_HISTORY_SAMPLES too small
 #endif
 
-#if (HEALTH_HISTORY_SAMPLES > 600)
-#error HEALTH_HISTORY_SAMPLES too large
+#if ((HEALTH_HISTORY_SAMPLES * 16UL) > HEALTH_HISTORY_MAX_BYTES)
+#error HEALTH_HISTORY_SAMPLES too large for HEALTH_HISTORY_MAX_BYTES (16 B per sample)
+#endif
+#endif
+
+// Newest health history samples mirrored to RTC slow memory and restored after a crash/WDT/software reset (0 = off; 16 B each).
+#ifndef HEALTH_HISTORY_RTC_SAMPLES
+#define HEALTH_HISTORY_RTC_SAMPLES 64
+#endif
+
+// ============================================================================
+// Optional: Device-side Energy History (/api/energy/history)
+// ============================================================================
+// Keep solar/grid history on-device in 1 s / 1 min / 15 min tiers (downsampled incrementally).
+#ifndef ENERGY_HISTORY_ENABLED
+#define ENERGY_HISTORY_ENABLED 1
+#endif
+
+// Samples in the 1 s tier (600 = 10 minutes).
+#ifndef ENERGY_HISTORY_FINE_SAMPLES
+#define ENERGY_HISTORY_FINE_SAMPLES 600
+#endif
+
+// Samples in the 1 min tier (1440 = 24 hours).
+#ifndef ENERGY_HISTORY_MINUTE_SAMPLES
+#define ENERGY_HISTORY_MINUTE_SAMPLES 1440
+#endif
+
+// Samples in the 15 min tier (2880 = 30 days).
+#ifndef ENERGY_HISTORY_QUARTER_SAMPLES
+#define ENERGY_HISTORY_QUARTER_SAMPLES 2880
+#endif
+
+// Allow energy history in internal RAM when PSRAM is unavailable (4 bytes/sample, ~20 KB by default).
+#ifndef ENERGY_HISTORY_ALLOW_INTERNAL
+#define ENERGY_HISTORY_ALLOW_INTERNAL false
+#endif
+
+// ============================================================================
+// Energy Channels
+// ============================================================================
+// Extra MQTT energy sources beyond solar/grid (battery, EV charger, heat pump, ...). 0..8.
+#ifndef ENERGY_AUX_CHANNEL_COUNT
+#define ENERGY_AUX_CHANNEL_COUNT 4
+#endif
+
+// Outbound MQTT queue slots for publishes from other tasks (power of two).
+#ifndef MQTT_OUTBOUND_QUEUE_DEPTH
+#define MQTT_OUTBOUND_QUEUE_DEPTH 8
+#endif
+
+// Largest queued outbound payload in bytes (bigger publishes are dropped and counted).
+#ifndef MQTT_OUTBOUND_PAYLOAD_MAX
+#define MQTT_OUTBOUND_PAYLOAD_MAX 768
+#endif
+
+// MQTT task poll period in ms while connected.
+#ifndef MQTT_TASK_POLL_MS
+#define MQTT_TASK_POLL_MS 10
+#endif
+
+// Upper bound for the exponential broker reconnect backoff (ms).
+#ifndef MQTT_RECONNECT_BACKOFF_MAX_MS
+#define MQTT_RECONNECT_BACKOFF_MAX_MS 60000
+#endif
+
+// Render the MQTT health payload from a fixed JSON skeleton (json_template.h) instead of a JsonDocument.
+#ifndef MQTT_HEALTH_TEMPLATE
+#define MQTT_HEALTH_TEMPLATE true
+#endif
+
+// Publish MQTT health only when a field moves past its deadband (plus a keepalive).
+#ifndef MQTT_HEALTH_DELTA_PUBLISH
+#define MQTT_HEALTH_DELTA_PUBLISH false
+#endif
+
+// Delta mode: always republish health after this many seconds, even when unchanged.
+#ifndef MQTT_HEALTH_MAX_INTERVAL_S
+#define MQTT_HEALTH_MAX_INTERVAL_S 300
+#endif
+
+// Delta mode deadband for percentage fields (cpu_usage, *_fragmentation).
+#ifndef MQTT_HEALTH_DEADBAND_PCT
+#define MQTT_HEALTH_DEADBAND_PCT 1
+#endif
+
+// Delta mode deadband for byte counters (heap/psram/fs), in bytes.
+#ifndef MQTT_HEALTH_DEADBAND_BYTES
+#define MQTT_HEALTH_DEADBAND_BYTES 4096
+#endif
+
+// Delta mode deadband for cpu_temperature, in degrees C.
+#ifndef MQTT_HEALTH_DEADBAND_TEMP_C
+#define MQTT_HEALTH_DEADBAND_TEMP_C 2
+#endif
+
+// Delta mode deadband for wifi_rssi, in dBm.
+#ifndef MQTT_HEALTH_DEADBAND_RSSI_DBM
+#define MQTT_HEALTH_DEADBAND_RSSI_DBM 3
+#endif
+
+// Delta mode deadband for display_* perf fields, as a relative change in percent.
+#ifndef MQTT_HEALTH_DEADBAND_PERF_PCT
+#define MQTT_HEALTH_DEADBAND_PERF_PCT 20
+#endif
+
+// Also publish the per-task CPU breakdown to <base>/health/tasks with each health sample.
+#ifndef MQTT_TASK_STATS_PUBLISH
+#define MQTT_TASK_STATS_PUBLISH false
+#endif
+
+// Busiest tasks included in the MQTT task breakdown (keeps it within MQTT_MAX_PACKET_SIZE).
+#ifndef MQTT_TASK_STATS_TOP
+#define MQTT_TASK_STATS_TOP 8
+#endif
+
+// Publish derived energy metrics (home power, self-consumption, tiers, alarm) to <base>/energy/derived.
+#ifndef ENERGY_METRICS_PUBLISH
+#define ENERGY_METRICS_PUBLISH true
+#endif
+
+// Minimum time between two derived-metrics publishes (ms); changes inside the window are merged.
+#ifndef ENERGY_METRICS_MIN_INTERVAL_MS
+#define ENERGY_METRICS_MIN_INTERVAL_MS 5000
+#endif
+
+// Republish derived metrics after this many seconds even when nothing moved past a deadband.
+#ifndef ENERGY_METRICS_MAX_INTERVAL_S
+#define ENERGY_METRICS_MAX_INTERVAL_S 300
+#endif
+
+// Deadband for home power in the derived metrics (W).
+#ifndef ENERGY_METRICS_DEADBAND_W
+#define ENERGY_METRICS_DEADBAND_W 50
+#endif
+
+// Deadband for self-consumption in the derived metrics (percentage points).
+#ifndef ENERGY_METRICS_DEADBAND_PCT
+#define ENERGY_METRICS_DEADBAND_PCT 2
+#endif
+
+// Build the MQTT TLS transport (enabled per device with the "MQTT TLS" setting).
+#ifndef MQTT_TLS_ENABLED
+#define MQTT_TLS_ENABLED true
+#endif
+
+// PEM CA certificate used to verify the MQTT broker (required unless MQTT_TLS_INSECURE).
+#ifndef MQTT_TLS_CA_PEM
+#define MQTT_TLS_CA_PEM ""
+#endif
+
+// Allow MQTT TLS without a CA (encrypted, broker NOT authenticated; credentials go to any peer).
+#ifndef MQTT_TLS_INSECURE
+#define MQTT_TLS_INSECURE false
+#endif
+
+// Timeout for the MQTT TLS TCP connect, handshake and blocked writes, in ms.
+#ifndef MQTT_TLS_TIMEOUT_MS
+#define MQTT_TLS_TIMEOUT_MS 8000
+#endif
+
+// HA discovery entities published per MQTT task iteration (spreads the connect burst).
+#ifndef HA_DISCOVERY_ENTITIES_PER_TICK
+#define HA_DISCOVERY_ENTITIES_PER_TICK 2
+#endif
+
+// Minimum gap between HA discovery batches, in ms.
+#ifndef HA_DISCOVERY_TICK_MS
+#define HA_DISCOVERY_TICK_MS 50
+#endif
+
+// Random delay (0..N ms) before HA discovery starts, so a fleet reconnect does not align.
+#ifndef HA_DISCOVERY_START_JITTER_MS
+#define HA_DISCOVERY_START_JITTER_MS 2000
+#endif
+
+// Delay before retrying a failed HA discovery entity, in ms.
+#ifndef HA_DISCOVERY_RETRY_MS
+#define HA_DISCOVERY_RETRY_MS 2000
+#endif
+
+// Attempts per HA discovery entity before it is skipped until next boot.
+#ifndef HA_DISCOVERY_MAX_ATTEMPTS
+#define HA_DISCOVERY_MAX_ATTEMPTS 3
+#endif
+
+// MQTT receive buffer in bytes (payloads larger than this are dropped by PubSubClient).
+#ifndef MQTT_RX_BUFFER_SIZE
+#define MQTT_RX_BUFFER_SIZE 2048
+#endif
+
+// QoS of the energy topic subscriptions (0 or 1; retained values are delivered either way).
+#ifndef MQTT_ENERGY_SUBSCRIBE_QOS
+#define MQTT_ENERGY_SUBSCRIBE_QOS 1
+#endif
+
+// Failed energy subscribes after connect retried on the next loop iterations before the 5 s retry.
+#ifndef MQTT_ENERGY_SUBSCRIBE_FAST_RETRIES
+#define MQTT_ENERGY_SUBSCRIBE_FAST_RETRIES 3
+#endif
+
+// Ask <base>/energy/refresh for channels that got no retained value after subscribing.
+#ifndef MQTT_ENERGY_REFRESH_REQUEST
+#define MQTT_ENERGY_REFRESH_REQUEST true
+#endif
+
+// Wait for retained energy values this many ms after subscribing before the refresh request.
+#ifndef MQTT_ENERGY_RETAINED_WAIT_MS
+#define MQTT_ENERGY_RETAINED_WAIT_MS 1500
+#endif
+
+// Minimum interval between display wakeups caused by energy updates (0 = every message).
+#ifndef ENERGY_INGEST_MIN_RENDER_MS
+#define ENERGY_INGEST_MIN_RENDER_MS 250
 #endif
+
+// Per-channel moving-average window over incoming values (1 = last value wins).
+#ifndef ENERGY_INGEST_SMOOTHING_SAMPLES
+#define ENERGY_INGEST_SMOOTHING_SAMPLES 1
+#endif
+
+// Per-topic ingest log summary interval in ms (0 = log every message).
+#ifndef ENERGY_INGEST_LOG_INTERVAL_MS
+#define ENERGY_INGEST_LOG_INTERVAL_MS 10000
+#endif
+
+// Keep the last energy values in RTC memory so a warm reboot renders them before the first message.
+#ifndef ENERGY_RTC_CACHE
+#define ENERGY_RTC_CACHE true
+#endif
+
+// Energy screen dims a value not updated for this many ms (restored values start here).
+#ifndef ENERGY_STALE_AGING_MS
+#define ENERGY_STALE_AGING_MS 30000
+#endif
+
+// Energy screen marks a value as stale after this many ms without an update.
+#ifndef ENERGY_STALE_MS
+#define ENERGY_STALE_MS 120000
+#endif
+
+// Poll a local P1 meter JSON API (p1_meter_url in config) as a direct grid/solar source.
+#ifndef P1_METER_ENABLED
+#define P1_METER_ENABLED true
+#endif
+
+// P1 meter poll period in ms (one request per period over a keep-alive connection).
+#ifndef P1_METER_POLL_MS
+#define P1_METER_POLL_MS 1000
+#endif
+
+// Connect/response timeout for one P1 meter poll in ms.
+#ifndef P1_METER_TIMEOUT_MS
+#define P1_METER_TIMEOUT_MS 800
+#endif
+
+// Largest P1 meter response body in bytes (larger bodies are skipped).
+#ifndef P1_METER_BODY_MAX_BYTES
+#define P1_METER_BODY_MAX_BYTES 2048
+#endif
+
+// Factor from meter values to kW (HomeWizard reports W: 0.001).
+#ifndef P1_METER_VALUE_SCALE
+#define P1_METER_VALUE_SCALE 0.001
+#endif
+
+// Accept binary energy frames on a UDP multicast group (fast path next to MQTT; unauthenticated, trusted LANs only).
+#ifndef ENERGY_FASTPATH_UDP_ENABLED
+#define ENERGY_FASTPATH_UDP_ENABLED false
+#endif
+
+// Multicast group of the UDP energy fast path.
+#ifndef ENERGY_FASTPATH_UDP_GROUP
+#define ENERGY_FASTPATH_UDP_GROUP "239.255.42.42"
+#endif
+
+// UDP port of the energy fast path.
+#ifndef ENERGY_FASTPATH_UDP_PORT
+#define ENERGY_FASTPATH_UDP_PORT 42420
+#endif
+
+// Accept the same energy frames over ESP-NOW (sender must use the AP's WiFi channel).
+#ifndef ENERGY_FASTPATH_ESPNOW_ENABLED
+#define ENERGY_FASTPATH_ESPNOW_ENABLED false
+#endif
+
+// A channel silent for this long accepts any sequence number again (publisher restart).
+#ifndef ENERGY_FASTPATH_SEQ_RESET_MS
+#define ENERGY_FASTPATH_SEQ_RESET_MS 5000
+#endif
+
+// Trace MQTT-to-pixel latency of energy values (per-stage histograms in /api/health).
+#ifndef ENERGY_LATENCY_TRACE_ENABLED
+#define ENERGY_LATENCY_TRACE_ENABLED true
+#endif
+
+// Window for the energy latency histograms (ms).
+#ifndef ENERGY_LATENCY_WINDOW_MS
+#define ENERGY_LATENCY_WINDOW_MS 60000
+#endif
+
+// Drop a latency trace that has not reached the panel after this many ms.
+#ifndef ENERGY_LATENCY_STALE_MS
+#define ENERGY_LATENCY_STALE_MS 2000
+#endif
+
+// ============================================================================
+// Energy Alarm Rendering
+// ============================================================================
+// Draw the kW values from a pre-rasterized A8 digit atlas, redrawing only changed digits (false = lv_label).
+#ifndef ENERGY_DIGIT_ATLAS
+#define ENERGY_DIGIT_ATLAS true
+#endif
+
+// Sweeping sparkline of the recent history under each category's bar (needs ENERGY_HISTORY_ENABLED; shortens the bars).
+#ifndef ENERGY_SPARKLINE
+#define ENERGY_SPARKLINE false
+#endif
+
+// Seconds of 1 s history averaged into one sparkline point (one pixel column).
+#ifndef ENERGY_SPARKLINE_SECONDS_PER_POINT
+#define ENERGY_SPARKLINE_SECONDS_PER_POINT 2
+#endif
+
+// Pulse a halo behind the alarming categories instead of the full-screen background (less flushing).
+#ifndef ENERGY_ALARM_HALO_MODE
+#define ENERGY_ALARM_HALO_MODE false
+#endif
+
+// Alarm animation step period in ms (lower = smoother, more bus traffic).
+#ifndef ENERGY_ALARM_STEP_MS
+#define ENERGY_ALARM_STEP_MS 40
+#endif
+
+// ============================================================================
+// Energy Totals (kWh counters, /api/energy/totals)
+// ============================================================================
+// Minimum interval between NVS checkpoints of the kWh counters (flash wear vs. loss on power cut).
+#ifndef ENERGY_TOTALS_PERSIST_INTERVAL_MS
+#define ENERGY_TOTALS_PERSIST_INTERVAL_MS (15UL * 60UL * 1000UL)
+#endif
+
+// Updates further apart than this are not integrated (source offline).
+#ifndef ENERGY_TOTALS_MAX_GAP_MS
+#define ENERGY_TOTALS_MAX_GAP_MS (5UL * 60UL * 1000UL)
+#endif
+
+// ============================================================================
+// Config Storage (see config_manager.cpp)
+// ============================================================================
+// Store DeviceConfig as one versioned, CRC-checked NVS blob (boot is a single read); per-key configs are migrated on first load.
+#ifndef CONFIG_STORAGE_BLOB
+#define CONFIG_STORAGE_BLOB true
+#endif
+
+// Deferred config saves (brightness persist, POST /api/config?no_reboot) hit NVS this long after the last change (ms).
+#ifndef CONFIG_PERSIST_DEBOUNCE_MS
+#define CONFIG_PERSIST_DEBOUNCE_MS 2000
 #endif
 
 // ============================================================================
@@ -186,6 +631,88 @@
 #define DISPLAY_DRIVER DISPLAY_DRIVER_TFT_ESPI  // Default to TFT_eSPI
 #endif
 
+// Circular panel: screen layouts keep their content inside the inscribed circle.
+#ifndef DISPLAY_ROUND
+#define DISPLAY_ROUND false
+#endif
+
+// ============================================================================
+// Secondary Status Panel (optional)
+// ============================================================================
+// Driver of a second, small panel rendered by the same LVGL task (0 = none; DISPLAY_DRIVER_ST7789V2 only).
+#ifndef SECONDARY_DISPLAY_DRIVER
+#define SECONDARY_DISPLAY_DRIVER 0
+#endif
+
+// Secondary panel width in pixels (native orientation).
+#ifndef SECONDARY_DISPLAY_WIDTH
+#define SECONDARY_DISPLAY_WIDTH 240
+#endif
+
+// Secondary panel height in pixels (native orientation).
+#ifndef SECONDARY_DISPLAY_HEIGHT
+#define SECONDARY_DISPLAY_HEIGHT 280
+#endif
+
+// First controller GRAM row the secondary panel shows (20 for 240x280 ST7789 modules, 0 for 240x320).
+#ifndef SECONDARY_DISPLAY_Y_OFFSET
+#define SECONDARY_DISPLAY_Y_OFFSET 20
+#endif
+
+// Secondary panel UI rotation (LVGL software rotation).
+#ifndef SECONDARY_DISPLAY_ROTATION
+#define SECONDARY_DISPLAY_ROTATION 0
+#endif
+
+// SPI bus of the secondary panel; keep it off the main panel's bus so image writes never contend with it.
+#ifndef SECONDARY_DISPLAY_SPI_BUS
+#define SECONDARY_DISPLAY_SPI_BUS HSPI
+#endif
+
+// Secondary panel SPI clock pin.
+#ifndef SECONDARY_LCD_SCK_PIN
+#define SECONDARY_LCD_SCK_PIN -1
+#endif
+
+// Secondary panel SPI MOSI pin.
+#ifndef SECONDARY_LCD_MOSI_PIN
+#define SECONDARY_LCD_MOSI_PIN -1
+#endif
+
+// Secondary panel chip select pin.
+#ifndef SECONDARY_LCD_CS_PIN
+#define SECONDARY_LCD_CS_PIN -1
+#endif
+
+// Secondary panel data/command pin.
+#ifndef SECONDARY_LCD_DC_PIN
+#define SECONDARY_LCD_DC_PIN -1
+#endif
+
+// Secondary panel reset pin.
+#ifndef SECONDARY_LCD_RST_PIN
+#define SECONDARY_LCD_RST_PIN -1
+#endif
+
+// Secondary panel backlight pin (-1 = always on / not wired).
+#ifndef SECONDARY_LCD_BL_PIN
+#define SECONDARY_LCD_BL_PIN -1
+#endif
+
+// Secondary panel LVGL draw buffer, in lines of its width.
+#ifndef SECONDARY_LVGL_BUFFER_LINES
+#define SECONDARY_LVGL_BUFFER_LINES 10
+#endif
+
+// Secondary panel LVGL refresh period in ms (independent of the main panel's governor).
+#ifndef SECONDARY_DISPLAY_REFRESH_MS
+#define SECONDARY_DISPLAY_REFRESH_MS 200
+#endif
+
+#if SECONDARY_DISPLAY_DRIVER && (SECONDARY_DISPLAY_DRIVER != DISPLAY_DRIVER_ST7789V2)
+#error SECONDARY_DISPLAY_DRIVER supports DISPLAY_DRIVER_ST7789V2 only
+#endif
+
 // ============================================================================
 // LVGL Configuration
 // ============================================================================
@@ -194,11 +721,228 @@
 #define LVGL_BUFFER_SIZE (DISPLAY_WIDTH * 10)  // 10 lines buffer
 #endif
 
+// Allocate a second LVGL draw buffer and flush asynchronously (DMA) when the driver supports it.
+#ifndef LVGL_DOUBLE_BUFFER
+#define LVGL_DOUBLE_BUFFER false
+#endif
+
+// Size internal-RAM draw buffers at boot: grow past LVGL_BUFFER_SIZE to the tallest band
+// that still leaves LVGL_BUFFER_INTERNAL_HEADROOM free (PSRAM buffers keep LVGL_BUFFER_SIZE).
+#ifndef LVGL_BUFFER_ADAPTIVE
+#define LVGL_BUFFER_ADAPTIVE false
+#endif
+
+// Tallest band (lines) LVGL_BUFFER_ADAPTIVE may pick.
+#ifndef LVGL_BUFFER_MAX_LINES
+#define LVGL_BUFFER_MAX_LINES 40
+#endif
+
+// Internal RAM (bytes) that must stay free after adaptive draw buffers (WiFi, TLS, tasks).
+#ifndef LVGL_BUFFER_INTERNAL_HEADROOM
+#define LVGL_BUFFER_INTERNAL_HEADROOM (96 * 1024)
+#endif
+
+// Dedicated TLSF pool for LVGL objects in bytes (0 = LVGL allocates from the shared heap).
+#ifndef LVGL_MEM_POOL_BYTES
+#define LVGL_MEM_POOL_BYTES 0
+#endif
+
+// Place the LVGL pool in PSRAM when present (internal RAM otherwise).
+#ifndef LVGL_MEM_POOL_PSRAM
+#define LVGL_MEM_POOL_PSRAM true
+#endif
+
+#if (LVGL_MEM_POOL_BYTES > 0) && (LVGL_MEM_POOL_BYTES < 8192)
+#error LVGL_MEM_POOL_BYTES must be 0 or at least 8192
+#endif
+
+// Build screen widget trees on first show instead of all at boot.
+#ifndef SCREEN_LAZY_CREATE
+#define SCREEN_LAZY_CREATE true
+#endif
+
+// Destroy the splash, info and test screens' widget trees while they are hidden.
+#ifndef SCREEN_RECLAIM_EPHEMERAL
+#define SCREEN_RECLAIM_EPHEMERAL true
+#endif
+
+// LVGL bytes hidden keep-warm screens may hold; least recently shown are destroyed past it (0 = no cap).
+#ifndef SCREEN_LVGL_BUDGET_BYTES
+#define SCREEN_LVGL_BUDGET_BYTES 0
+#endif
+
+// Render LVGL pixels byte-swapped (LV_COLOR_16_SWAP) so flushes hand LVGL's buffer to wire-order drivers without a swap copy.
+#ifndef LVGL_COLOR_16_SWAP
+#define LVGL_COLOR_16_SWAP false
+#endif
+
+// Window for display perf histograms (p50/p95/max in /api/health + MQTT health).
+#ifndef DISPLAY_PERF_HIST_WINDOW_MS
+#define DISPLAY_PERF_HIST_WINDOW_MS 5000
+#endif
+
+// Cross-task display commands (screen switches, splash status) queued for the LVGL task.
+#ifndef DISPLAY_CMD_QUEUE_DEPTH
+#define DISPLAY_CMD_QUEUE_DEPTH 8
+#endif
+
+// Extra queue slots only warning and direct-image transitions may fill, so a burst of switches or splash updates cannot drop them.
+#ifndef DISPLAY_CMD_RESERVED_SLOTS
+#define DISPLAY_CMD_RESERVED_SLOTS 4
+#endif
+
+// Per-caller wait/hold stats for the LVGL mutex (/api/health "lvgl_lock").
+#ifndef LVGL_LOCK_STATS
+#define LVGL_LOCK_STATS true
+#endif
+
+// LVGL mutex hold (ms) counted and logged as a long hold.
+#ifndef LVGL_LOCK_LONG_HOLD_MS
+#define LVGL_LOCK_LONG_HOLD_MS 200
+#endif
+
+// Max time the LVGL task sleeps between iterations when nothing wakes it (ms).
+#ifndef LVGL_TASK_MAX_IDLE_MS
+#define LVGL_TASK_MAX_IDLE_MS 250
+#endif
+
 // LVGL tick period in milliseconds.
 #ifndef LVGL_TICK_PERIOD_MS
 #define LVGL_TICK_PERIOD_MS 5
 #endif
 
+// Burn-in mitigation: move the whole UI by a few pixels every N seconds (0 = off).
+#ifndef PIXEL_SHIFT_INTERVAL_S
+#define PIXEL_SHIFT_INTERVAL_S 600
+#endif
+
+// Largest pixel-shift offset from the home position, per axis (px).
+#ifndef PIXEL_SHIFT_MAX_PX
+#define PIXEL_SHIFT_MAX_PX 2
+#endif
+
+// ============================================================================
+// Boot (see boot_timeline.h)
+// ============================================================================
+// Record setup() phase timings and report them as "boot_timeline" in /api/info.
+#ifndef BOOT_TIMELINE_ENABLED
+#define BOOT_TIMELINE_ENABLED true
+#endif
+
+// Max phases + milestones kept by the boot timeline.
+#ifndef BOOT_TIMELINE_MAX_PHASES
+#define BOOT_TIMELINE_MAX_PHASES 24
+#endif
+
+// Connect WiFi on a boot task while the display and LVGL initialize (false = sequential, as before).
+#ifndef BOOT_PARALLEL_WIFI
+#define BOOT_PARALLEL_WIFI true
+#endif
+
+// Minimum time the splash stays up (ms, counted from display init; boot work overlapping it is not added on top).
+#ifndef BOOT_SPLASH_MIN_MS
+#define BOOT_SPLASH_MIN_MS 2000
+#endif
+
+// ============================================================================
+// Task Placement (see task_placement.h)
+// ============================================================================
+// Core for the LVGL render task (dual-core only; -1 = no affinity).
+#ifndef TASK_RENDER_CORE
+#define TASK_RENDER_CORE 0
+#endif
+
+// Core for network/decode work (fw_update task; loop() runs on ARDUINO_RUNNING_CORE).
+#ifndef TASK_NETWORK_CORE
+#define TASK_NETWORK_CORE 1
+#endif
+
+// Core for low-priority background tasks like cpu_monitor (-1 = no affinity).
+#ifndef TASK_BACKGROUND_CORE
+#define TASK_BACKGROUND_CORE -1
+#endif
+
+// FreeRTOS priority of the LVGL render task.
+#ifndef TASK_RENDER_PRIORITY
+#define TASK_RENDER_PRIORITY 1
+#endif
+
+// FreeRTOS priority of network/decode tasks (fw_update).
+#ifndef TASK_NETWORK_PRIORITY
+#define TASK_NETWORK_PRIORITY 1
+#endif
+
+// FreeRTOS priority of background tasks (cpu_monitor).
+#ifndef TASK_BACKGROUND_PRIORITY
+#define TASK_BACKGROUND_PRIORITY 1
+#endif
+
+// ============================================================================
+// Loop Scheduler (see loop_scheduler.h)
+// ============================================================================
+// Maximum number of periodic jobs registered on the loop() scheduler.
+#ifndef LOOP_SCHEDULER_MAX_JOBS
+#define LOOP_SCHEDULER_MAX_JOBS 16
+#endif
+
+// Upper bound for one loop() sleep (ms); also the worst-case latency for work queued by other tasks.
+#ifndef LOOP_SCHEDULER_MAX_SLEEP_MS
+#define LOOP_SCHEDULER_MAX_SLEEP_MS 10
+#endif
+
+// Minimum interval between overrun summary log lines (ms; the first overrun of a job is always logged).
+#ifndef LOOP_SCHEDULER_OVERRUN_LOG_MS
+#define LOOP_SCHEDULER_OVERRUN_LOG_MS 60000
+#endif
+
+// ============================================================================
+// Logging (see log_manager.h)
+// ============================================================================
+// Queue log lines in a lock-free ring and write them to Serial from a drain task (callers never wait on the UART).
+#ifndef LOG_ASYNC_ENABLED
+#define LOG_ASYNC_ENABLED true
+#endif
+
+// Async log ring slots (power of two); one formatted line each, in internal RAM.
+#ifndef LOG_ASYNC_SLOTS
+#define LOG_ASYNC_SLOTS 32
+#endif
+
+// Bytes per async log slot (longer lines are truncated).
+#ifndef LOG_ASYNC_LINE_BYTES
+#define LOG_ASYNC_LINE_BYTES 160
+#endif
+
+// Live log streaming (/api/logs/stream, SSE) from a copy of the drained lines.
+#ifndef LOG_STREAM_ENABLED
+#define LOG_STREAM_ENABLED true
+#endif
+
+// Log stream backlog in bytes (power of two) when PSRAM is present.
+#ifndef LOG_STREAM_BUFFER_BYTES
+#define LOG_STREAM_BUFFER_BYTES 16384
+#endif
+
+// Log stream backlog without PSRAM (power of two; 0 disables streaming on those boards).
+#ifndef LOG_STREAM_BUFFER_BYTES_INTERNAL
+#define LOG_STREAM_BUFFER_BYTES_INTERNAL 2048
+#endif
+
+// Concurrent /api/logs/stream clients (each holds a small batch buffer).
+#ifndef LOG_STREAM_MAX_CLIENTS
+#define LOG_STREAM_MAX_CLIENTS 2
+#endif
+
+// Deferred formatting: LOG* store the format pointer and raw arguments; the drain task runs printf.
+#ifndef LOG_BINARY_ENABLED
+#define LOG_BINARY_ENABLED false
+#endif
+
+// Encoded argument bytes per deferred log line (strings are copied and truncated to fit).
+#ifndef LOG_BINARY_ARGS_BYTES
+#define LOG_BINARY_ARGS_BYTES 96
+#endif
+
 // ============================================================================
 // Backlight Configuration
 // ============================================================================
@@ -207,6 +951,76 @@
 #define HAS_BACKLIGHT false
 #endif
 
+// Map backlight percent to PWM duty on a gamma curve (see backlight_pwm.h).
+#ifndef BACKLIGHT_GAMMA_CORRECTION
+#define BACKLIGHT_GAMMA_CORRECTION true
+#endif
+
+// Exponent of the backlight gamma curve.
+#ifndef BACKLIGHT_GAMMA
+#define BACKLIGHT_GAMMA 2.2f
+#endif
+
+// Run screen saver fades on the LEDC fade engine (Arduino core 3.x) instead of loop() steps.
+#ifndef BACKLIGHT_HW_FADE
+#define BACKLIGHT_HW_FADE true
+#endif
+
+// Park the LVGL render task while the screen saver has the backlight off.
+#ifndef SCREEN_SAVER_SUSPEND_RENDER
+#define SCREEN_SAVER_SUSPEND_RENDER true
+#endif
+
+// Touch wake polling interval while asleep (ms).
+#ifndef SCREEN_SAVER_ASLEEP_TOUCH_POLL_MS
+#define SCREEN_SAVER_ASLEEP_TOUCH_POLL_MS 50
+#endif
+
+// Ambient light sensor (LDR) for auto-brightness (see ambient_light.h). Requires LDR_PIN.
+#ifndef HAS_LDR
+#define HAS_LDR false
+#endif
+
+// Auto-brightness: one (oversampled) LDR sample every N ms.
+#ifndef AUTO_BRIGHTNESS_SAMPLE_MS
+#define AUTO_BRIGHTNESS_SAMPLE_MS 1000
+#endif
+
+// Auto-brightness: ADC reads averaged per sample.
+#ifndef AUTO_BRIGHTNESS_OVERSAMPLE
+#define AUTO_BRIGHTNESS_OVERSAMPLE 16
+#endif
+
+// Auto-brightness: IIR smoothing of the light level (weight 1/2^N per sample).
+#ifndef AUTO_BRIGHTNESS_IIR_SHIFT
+#define AUTO_BRIGHTNESS_IIR_SHIFT 3
+#endif
+
+// Auto-brightness: minimum target change before the backlight is adjusted (%).
+#ifndef AUTO_BRIGHTNESS_HYSTERESIS_PCT
+#define AUTO_BRIGHTNESS_HYSTERESIS_PCT 10
+#endif
+
+// Auto-brightness: default lower end of the brightness range (%).
+#ifndef AUTO_BRIGHTNESS_MIN_PCT
+#define AUTO_BRIGHTNESS_MIN_PCT 10
+#endif
+
+// Auto-brightness: averaged ADC reading in a dark room (12-bit).
+#ifndef AUTO_BRIGHTNESS_ADC_DARK
+#define AUTO_BRIGHTNESS_ADC_DARK 4095
+#endif
+
+// Auto-brightness: averaged ADC reading in bright light (12-bit; may be below or above DARK).
+#ifndef AUTO_BRIGHTNESS_ADC_BRIGHT
+#define AUTO_BRIGHTNESS_ADC_BRIGHT 0
+#endif
+
+// Fade duration for auto-brightness adjustments while awake (ms).
+#ifndef SCREEN_SAVER_AUTO_BRIGHTNESS_FADE_MS
+#define SCREEN_SAVER_AUTO_BRIGHTNESS_FADE_MS 1500
+#endif
+
 // LEDC channel used for backlight PWM.
 #ifndef TFT_BACKLIGHT_PWM_CHANNEL
 #define TFT_BACKLIGHT_PWM_CHANNEL 0  // LEDC channel for PWM control
@@ -230,6 +1044,56 @@
 #define TOUCH_DRIVER_AXS15231B 3
 #define TOUCH_DRIVER_CST816S_ESP_PANEL 4
 
+// LVGL touch read period while the panel is untouched (ms). The default LVGL period is used while pressed.
+#ifndef TOUCH_IDLE_READ_PERIOD_MS
+#define TOUCH_IDLE_READ_PERIOD_MS 100
+#endif
+
+// XPT2046: gate sampling on the pen-down IRQ (TOUCH_IRQ) so idle reads skip the SPI bus.
+#ifndef TOUCH_IRQ_GATED
+#define TOUCH_IRQ_GATED true
+#endif
+
+// Median-of-3 + IIR filter on touch coordinates before LVGL (see touch_filter.h).
+#ifndef TOUCH_FILTER_ENABLED
+#define TOUCH_FILTER_ENABLED true
+#endif
+
+// Touch IIR weight of each new sample, Q8 (256 = no smoothing).
+#ifndef TOUCH_FILTER_IIR_ALPHA_Q8
+#define TOUCH_FILTER_IIR_ALPHA_Q8 128
+#endif
+
+// Ignore filtered touch movement up to this many pixels (resting-finger jitter).
+#ifndef TOUCH_FILTER_DEADBAND_PX
+#define TOUCH_FILTER_DEADBAND_PX 2
+#endif
+
+// Minimum driver-reported pressure for a press (0 = rely on the driver's own threshold).
+#ifndef TOUCH_FILTER_MIN_PRESSURE
+#define TOUCH_FILTER_MIN_PRESSURE 0
+#endif
+
+// Swipe left/right = next/previous screen, long-press = first screen.
+#ifndef TOUCH_GESTURES_ENABLED
+#define TOUCH_GESTURES_ENABLED true
+#endif
+
+// Horizontal travel that makes a stroke a swipe (px).
+#ifndef TOUCH_GESTURE_SWIPE_MIN_PX
+#define TOUCH_GESTURE_SWIPE_MIN_PX 60
+#endif
+
+// Strokes slower than this are not swipes (ms).
+#ifndef TOUCH_GESTURE_SWIPE_MAX_MS
+#define TOUCH_GESTURE_SWIPE_MAX_MS 600
+#endif
+
+// Hold time for a long-press (ms).
+#ifndef TOUCH_GESTURE_LONG_PRESS_MS
+#define TOUCH_GESTURE_LONG_PRESS_MS 800
+#endif
+
 // Prefer allocating LVGL draw buffer in internal RAM before PSRAM.
 // Default: false (keeps historical PSRAM-first behavior; boards can override).
 // Prefer internal RAM over PSRAM for LVGL draw buffer allocation.
@@ -243,6 +1107,12 @@
 #define ESP_PANEL_SWAPBUF_PREFER_INTERNAL true
 #endif
 
+// Arduino_GFX (Buffered) display driver: present only the dirty framebuffer rows.
+// Default: true. Set false for panels that need full-frame transfers.
+#ifndef ARDUINO_GFX_PARTIAL_PRESENT
+#define ARDUINO_GFX_PARTIAL_PRESENT true
+#endif
+
 // ============================================================================
 // Diagnostics / Telemetry
 // ============================================================================
@@ -261,9 +1131,29 @@
 // ============================================================================
 // Web Portal
 // ============================================================================
-// Max JSON body size accepted by /api/config.
+// Max JSON body size accepted by /api/config (sanity limit; the body is parsed as it streams in, not buffered).
 #ifndef WEB_PORTAL_CONFIG_MAX_JSON_BYTES
-#define WEB_PORTAL_CONFIG_MAX_JSON_BYTES 4096
+#define WEB_PORTAL_CONFIG_MAX_JSON_BYTES 16384
+#endif
+
+// Reusable JSON document arenas for the API handlers (json_arena.h): slot counts and sizes (bytes).
+#ifndef JSON_ARENA_SMALL_SLOTS
+#define JSON_ARENA_SMALL_SLOTS 4
+#endif
+
+// Small arena slot size (bytes; config/OTA/energy documents).
+#ifndef JSON_ARENA_SMALL_BYTES
+#define JSON_ARENA_SMALL_BYTES 1536
+#endif
+
+// Large arena slots (health and task documents).
+#ifndef JSON_ARENA_LARGE_SLOTS
+#define JSON_ARENA_LARGE_SLOTS 2
+#endif
+
+// Large arena slot size (bytes).
+#ifndef JSON_ARENA_LARGE_BYTES
+#define JSON_ARENA_LARGE_BYTES 7168
 #endif
 
 // Timeout for an incomplete /api/config upload (ms) before freeing the buffer.
@@ -271,6 +1161,99 @@
 #define WEB_PORTAL_CONFIG_BODY_TIMEOUT_MS 5000
 #endif
 
+// Accept an HMAC session token (cookie or Bearer) before parsing Basic Auth on every request.
+#ifndef WEB_PORTAL_AUTH_SESSION
+#define WEB_PORTAL_AUTH_SESSION true
+#endif
+
+// Max operations in one POST /api/display/batch body.
+#ifndef WEB_PORTAL_DISPLAY_BATCH_MAX_OPS
+#define WEB_PORTAL_DISPLAY_BATCH_MAX_OPS 8
+#endif
+
+// JSON document capacity (bytes) for a /api/display/batch body (one small JSON arena slot).
+#ifndef WEB_PORTAL_DISPLAY_BATCH_DOC_BYTES
+#define WEB_PORTAL_DISPLAY_BATCH_DOC_BYTES 1536
+#endif
+
+// Admission control for /api routes: over-limit or low-heap requests get 503 + Retry-After at once.
+#ifndef WEB_PORTAL_ADMISSION_ENABLED
+#define WEB_PORTAL_ADMISSION_ENABLED true
+#endif
+
+// In-flight responses allowed for small status routes (/api/health, /api/info, /api/energy/state, ...).
+#ifndef WEB_PORTAL_ADMIT_STATUS_MAX
+#define WEB_PORTAL_ADMIT_STATUS_MAX 4
+#endif
+
+// In-flight responses allowed for large-document routes (/api/config, history endpoints).
+#ifndef WEB_PORTAL_ADMIT_HEAVY_MAX
+#define WEB_PORTAL_ADMIT_HEAVY_MAX 1
+#endif
+
+// Minimum free internal heap (bytes) to admit a status request.
+#ifndef WEB_PORTAL_ADMIT_STATUS_MIN_HEAP
+#define WEB_PORTAL_ADMIT_STATUS_MIN_HEAP 8192
+#endif
+
+// Minimum free internal heap (bytes) to admit a heavy request.
+#ifndef WEB_PORTAL_ADMIT_HEAVY_MIN_HEAP
+#define WEB_PORTAL_ADMIT_HEAVY_MIN_HEAP 16384
+#endif
+
+// Retry-After (seconds) sent with admission rejections.
+#ifndef WEB_PORTAL_ADMIT_RETRY_AFTER_S
+#define WEB_PORTAL_ADMIT_RETRY_AFTER_S 1
+#endif
+
+// 4 KB flash-sector buffers between the /api/update receiver and the ota_writer task (internal RAM).
+#ifndef OTA_STREAM_BLOCKS
+#define OTA_STREAM_BLOCKS 3
+#endif
+
+// Let the ota_writer task pre-erase upcoming sectors while it waits for data.
+#ifndef OTA_STREAM_ERASE_AHEAD
+#define OTA_STREAM_ERASE_AHEAD true
+#endif
+
+// How far erase-ahead may run past the last written byte.
+#ifndef OTA_STREAM_ERASE_AHEAD_BYTES
+#define OTA_STREAM_ERASE_AHEAD_BYTES (64 * 1024)
+#endif
+
+// Fail the upload when no block frees up for this long (ms; flash writer stuck).
+#ifndef OTA_STREAM_STALL_TIMEOUT_MS
+#define OTA_STREAM_STALL_TIMEOUT_MS 10000
+#endif
+
+// Optional: define OTA_SIGNING_PUBLIC_KEY_PEM (PEM string) in board_overrides.h to
+// require a signature over each firmware image's SHA-256 (see ota_stream.h).
+
+// Pull update (/api/firmware/update): attempts without progress before giving up.
+#ifndef FIRMWARE_PULL_MAX_RETRIES
+#define FIRMWARE_PULL_MAX_RETRIES 8
+#endif
+
+// Pull update: upper bound of the linear backoff between attempts (ms).
+#ifndef FIRMWARE_PULL_MAX_BACKOFF_MS
+#define FIRMWARE_PULL_MAX_BACKOFF_MS 10000
+#endif
+
+// Pull update: how long one attempt waits for WiFi to rejoin (ms).
+#ifndef FIRMWARE_PULL_WIFI_WAIT_MS
+#define FIRMWARE_PULL_WIFI_WAIT_MS 30000
+#endif
+
+// Pull update: treat the connection as dropped after this long without data (ms).
+#ifndef FIRMWARE_PULL_IDLE_TIMEOUT_MS
+#define FIRMWARE_PULL_IDLE_TIMEOUT_MS 15000
+#endif
+
+// Pull update: persist the resume offset every N bytes written (NVS wear vs. lost work).
+#ifndef FIRMWARE_PULL_CHECKPOINT_BYTES
+#define FIRMWARE_PULL_CHECKPOINT_BYTES (128 * 1024)
+#endif
+
 // Select the touch HAL backend (one of the TOUCH_DRIVER_* constants).
 #ifndef TOUCH_DRIVER
 #define TOUCH_DRIVER TOUCH_DRIVER_XPT2046  // Default to XPT2046
@@ -319,6 +1302,104 @@
 #define IMAGE_API_MAX_TIMEOUT_MS (86400UL * 1000UL)  // 24 hours max timeout
 #endif
 
+// Decode image_url downloads straight off the socket (no full-image buffer; size limit no longer applies).
+#ifndef IMAGE_API_URL_STREAMING
+#define IMAGE_API_URL_STREAMING true
+#endif
+
+// Refill buffer between the HTTP client and the JPEG decoder in streaming mode (bytes).
+#ifndef IMAGE_API_STREAM_BUFFER_BYTES
+#define IMAGE_API_STREAM_BUFFER_BYTES 4096
+#endif
+
+// Decode POST /api/display/image bodies on an image_stream task while they arrive
+// (bounded ring instead of a buffer the size of the upload).
+#ifndef IMAGE_UPLOAD_STREAMING
+#define IMAGE_UPLOAD_STREAMING true
+#endif
+
+// Ring between the upload handler and the streaming decoder (bytes, kept once used).
+#ifndef IMAGE_UPLOAD_STREAM_RING_BYTES
+#define IMAGE_UPLOAD_STREAM_RING_BYTES 16384
+#endif
+
+// Fail a streamed upload when its ring stays empty this long (ms); a full ring pauses the sender's TCP window instead.
+#ifndef IMAGE_UPLOAD_STREAM_STALL_MS
+#define IMAGE_UPLOAD_STREAM_STALL_MS 3000
+#endif
+
+// Cache image_url downloads on the FFat partition and revalidate them with conditional GETs.
+#ifndef IMAGE_URL_CACHE_ENABLED
+#define IMAGE_URL_CACHE_ENABLED true
+#endif
+
+// Max cached images (LRU eviction beyond this).
+#ifndef IMAGE_URL_CACHE_MAX_ENTRIES
+#define IMAGE_URL_CACHE_MAX_ENTRIES 16
+#endif
+
+// Max total bytes of cached image bodies on FFat (single images above this are not cached).
+#ifndef IMAGE_URL_CACHE_MAX_BYTES
+#define IMAGE_URL_CACHE_MAX_BYTES (512 * 1024)
+#endif
+
+// Keep-alive connections kept open between image_url fetches (keyed by host:port; 0 = close after each fetch).
+#ifndef IMAGE_HTTP_POOL_SIZE
+#define IMAGE_HTTP_POOL_SIZE 2
+#endif
+
+// Close a parked image_url connection after this long without a request (ms).
+#ifndef IMAGE_HTTP_POOL_IDLE_MS
+#define IMAGE_HTTP_POOL_IDLE_MS 20000
+#endif
+
+// Only park TLS connections while free internal heap stays above this (bytes; each pins ~40 KB).
+#ifndef IMAGE_HTTP_POOL_MIN_INTERNAL_FREE
+#define IMAGE_HTTP_POOL_MIN_INTERNAL_FREE (96 * 1024)
+#endif
+
+// Scheduled image refresh: +/- spread applied to every interval (percent of the interval).
+#ifndef IMAGE_REFRESH_JITTER_PCT
+#define IMAGE_REFRESH_JITTER_PCT 10
+#endif
+
+// Scheduled image refresh: shortest interval honoured (seconds; smaller configured values are raised).
+#ifndef IMAGE_REFRESH_MIN_INTERVAL_S
+#define IMAGE_REFRESH_MIN_INTERVAL_S 5
+#endif
+
+// Scheduled image refresh: display timeout of a refreshed image (seconds; 0 = until replaced).
+#ifndef IMAGE_REFRESH_DISPLAY_TIMEOUT_S
+#define IMAGE_REFRESH_DISPLAY_TIMEOUT_S 0
+#endif
+
+// Boot-time image buffer arena (uploads, strips, downloads, decode outputs) reserved in PSRAM.
+// Keeps long-running devices from fragmenting the heap; 0 = always use the heap.
+#ifndef IMAGE_ARENA_PSRAM_BYTES
+#define IMAGE_ARENA_PSRAM_BYTES (1024 * 1024)
+#endif
+
+// Internal-RAM image arena for boards without PSRAM (0 = disabled). Opt-in per board: on a CYD it
+// would take a sixth of the free heap for good, so those boards use the heap unless they set it.
+#ifndef IMAGE_ARENA_INTERNAL_BYTES
+#define IMAGE_ARENA_INTERNAL_BYTES 0
+#endif
+
+// PSRAM budget for decoded lvgl_image pixels kept for reuse (0 = no cache; PSRAM boards only).
+#ifndef LVGL_IMAGE_CACHE_BYTES
+#define LVGL_IMAGE_CACHE_BYTES (512 * 1024)
+#endif
+
+// Max images in the lvgl_image decode cache.
+#ifndef LVGL_IMAGE_CACHE_MAX_ENTRIES
+#define LVGL_IMAGE_CACHE_MAX_ENTRIES 6
+#endif
+
+// Received strips that may wait for decode (>= 2 lets strip N+1 upload while strip N decodes).
+#ifndef IMAGE_STRIP_QUEUE_DEPTH
+#define IMAGE_STRIP_QUEUE_DEPTH 2
+#endif
+
 // Image API performance tuning
 // Controls how many rows the strip decoder batches into one LCD transaction.
 // Higher = fewer LCD transactions (faster) but more temporary RAM.
@@ -328,5 +1409,140 @@
 #define IMAGE_STRIP_BATCH_MAX_ROWS 16
 #endif
 
+// Double-buffer strip batches and push them via async DMA when the driver supports it
+// (decode of the next MCU row overlaps the transfer; costs a second DMA-capable batch buffer).
+#ifndef IMAGE_STRIP_DMA_PINGPONG
+#define IMAGE_STRIP_DMA_PINGPONG true
+#endif
+
+// On dual-core targets, decode two queued JPEG strips at once (the second on a helper
+// task on TASK_RENDER_CORE). Costs ~8KB for the helper plus one decode band.
+#ifndef IMAGE_STRIP_PARALLEL_DECODE
+#define IMAGE_STRIP_PARALLEL_DECODE true
+#endif
+
+// Tallest strip the helper core can decode (rows of the width x rows RGB565 band);
+// taller strips are decoded sequentially.
+#ifndef IMAGE_STRIP_PARALLEL_MAX_ROWS
+#define IMAGE_STRIP_PARALLEL_MAX_ROWS 32
+#endif
+
+// CPU time (us) a JPEG decode runs before yielding to other tasks (a one-tick delay on
+// single-core targets, so IDLE and the network stack get the CPU mid-image).
+#ifndef IMAGE_DECODE_SLICE_US
+#define IMAGE_DECODE_SLICE_US 5000
+#endif
+
+// Decode in-memory JPEGs with the hardware codec on targets that have one (ESP32-P4);
+// TJpgDec remains the fallback and the only path for streamed image_url decodes.
+#ifndef IMAGE_JPEG_HW_DECODE
+#define IMAGE_JPEG_HW_DECODE true
+#endif
+
+// Per-image timeout for the hardware JPEG engine (ms).
+#ifndef IMAGE_JPEG_HW_TIMEOUT_MS
+#define IMAGE_JPEG_HW_TIMEOUT_MS 100
+#endif
+
+// Log RGB888->RGB565 conversion throughput (Mpx/s per kernel variant) once at boot.
+#ifndef RGB565_CONVERT_BENCH_AT_BOOT
+#define RGB565_CONVERT_BENCH_AT_BOOT false
+#endif
+
+// On-device benchmark suite (/api/bench): memcpy, RGB565, JSON, NVS, display fill, JPEG decode.
+#ifndef DEVICE_BENCH_ENABLED
+#define DEVICE_BENCH_ENABLED true
+#endif
+
+// Event trace ring (/api/trace): begin/end spans exported as Chrome trace_event JSON.
+#ifndef TRACE_RING_ENABLED
+#define TRACE_RING_ENABLED true
+#endif
+
+// Trace ring capacity in events (power of two, 16 bytes each) when PSRAM is present.
+#ifndef TRACE_RING_EVENTS
+#define TRACE_RING_EVENTS 4096
+#endif
+
+// Trace ring capacity without PSRAM (power of two; 0 disables tracing on those boards).
+#ifndef TRACE_RING_EVENTS_INTERNAL
+#define TRACE_RING_EVENTS_INTERNAL 256
+#endif
+
+// Crash record (/api/diagnostics/last_crash): RTC breadcrumbs + core dump summary saved to FFat after a panic/WDT/brownout.
+#ifndef CRASH_RECORD_ENABLED
+#define CRASH_RECORD_ENABLED true
+#endif
+
+// How often loop() refreshes the crash breadcrumbs (heap, per-tag allocations, perf counters, trace tail) in RTC memory.
+#ifndef CRASH_RECORD_SNAPSHOT_MS
+#define CRASH_RECORD_SNAPSHOT_MS 2000
+#endif
+
+// Newest trace ring events kept in each breadcrumb snapshot (20 B each in RTC slow memory).
+#ifndef CRASH_RECORD_TRACE_EVENTS
+#define CRASH_RECORD_TRACE_EVENTS 16
+#endif
+
+// Erase the flash core dump once its summary is in the crash record (so the next crash is never confused with this one).
+#ifndef CRASH_RECORD_ERASE_COREDUMP
+#define CRASH_RECORD_ERASE_COREDUMP true
+#endif
+
+// Image slideshow (/api/display/slideshow): device-side playlist with next-slide prefetch.
+#ifndef IMAGE_SLIDESHOW_ENABLED
+#define IMAGE_SLIDESHOW_ENABLED true
+#endif
+
+// Max URLs in one slideshow playlist.
+#ifndef IMAGE_SLIDESHOW_MAX_ITEMS
+#define IMAGE_SLIDESHOW_MAX_ITEMS 8
+#endif
+
+// Default per-slide dwell time (seconds) when the playlist does not set one.
+#ifndef IMAGE_SLIDESHOW_DEFAULT_DWELL_S
+#define IMAGE_SLIDESHOW_DEFAULT_DWELL_S 10
+#endif
+
+// Number of bands a "wipe" transition reveals the next slide in.
+#ifndef IMAGE_SLIDESHOW_WIPE_STEPS
+#define IMAGE_SLIDESHOW_WIPE_STEPS 12
+#endif
+
+// Delay between wipe bands (ms).
+#ifndef IMAGE_SLIDESHOW_WIPE_STEP_MS
+#define IMAGE_SLIDESHOW_WIPE_STEP_MS 16
+#endif
+
+// Back-off (ms) after every playlist item failed to download/decode in a row.
+#ifndef IMAGE_SLIDESHOW_RETRY_MS
+#define IMAGE_SLIDESHOW_RETRY_MS 30000
+#endif
+
+// Max POST /api/display/slideshow body size (bytes).
+#ifndef IMAGE_SLIDESHOW_BODY_MAX
+#define IMAGE_SLIDESHOW_BODY_MAX 4096
+#endif
+
+// MJPEG stream display (/api/display/mjpeg): multipart/x-mixed-replace camera streams.
+#ifndef IMAGE_MJPEG_ENABLED
+#define IMAGE_MJPEG_ENABLED true
+#endif
+
+// Max size of one MJPEG frame (bytes). Two buffers of this size are allocated while streaming.
+#ifndef IMAGE_MJPEG_MAX_FRAME_BYTES
+#define IMAGE_MJPEG_MAX_FRAME_BYTES (48 * 1024)
+#endif
+
+// Delay before reconnecting after the MJPEG stream dropped or failed to open (ms).
+#ifndef IMAGE_MJPEG_RECONNECT_MS
+#define IMAGE_MJPEG_RECONNECT_MS 3000
+#endif
+
+// Max time one main-loop pass spends reading the MJPEG socket (ms).
+#ifndef IMAGE_MJPEG_PUMP_BUDGET_MS
+#define IMAGE_MJPEG_PUMP_BUDGET_MS 20
+#endif
+
 #endif // BOARD_CONFIG_H
 
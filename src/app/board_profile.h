@@ -0,0 +1,89 @@
+/*
+ * Board Profile
+ *
+ * One constexpr description of the board this image is built for, collected from
+ * board_config.h / board_overrides.h: panel size and pixel order, LVGL buffer
+ * sizing, PSRAM policy and task layout. Code branches on it with `if constexpr`
+ * (or plain `if` on a constant) instead of macros spread through the file or a
+ * heap probe on every allocation, so each board compiles to straight-line code:
+ *
+ *   if (board_psram_available()) { ... PSRAM path ... }   // gone on CYD / C3
+ *
+ * PSRAM policy (BOARD_PSRAM):
+ *   None   - the SoC has no SPIRAM (C3/C6) or the board declares none (0)
+ *   Fitted - the board declares PSRAM (1); no runtime probe
+ *   Detect - default (-1): probed once on first use, then cached
+ */
+
+#pragma once
+
+#include "board_config.h"
+
+#include <esp_heap_caps.h>
+#include <sdkconfig.h>
+#include <soc/soc_caps.h>
+#include <stdint.h>
+
+enum class BoardPsram : uint8_t {
+    None,
+    Detect,
+    Fitted,
+};
+
+struct BoardProfile {
+    bool has_display;
+    uint16_t panel_width;          // DISPLAY_WIDTH / DISPLAY_HEIGHT (0 without display)
+    uint16_t panel_height;
+    bool panel_round;              // DISPLAY_ROUND
+    bool lvgl_wire_order;          // LVGL_COLOR_16_SWAP: LVGL renders MSB-first pixels
+    uint32_t lvgl_buffer_px;       // LVGL_BUFFER_SIZE
+    bool lvgl_buffer_prefer_internal;
+    bool lvgl_double_buffer;
+    BoardPsram psram;
+    uint8_t cores;
+    int8_t render_core;            // TASK_*_CORE (-1 = no affinity)
+    int8_t network_core;
+    int8_t background_core;
+};
+
+inline constexpr BoardProfile kBoardProfile = {
+#if HAS_DISPLAY
+    /* has_display */ true,
+    /* panel_width */ (uint16_t)DISPLAY_WIDTH,
+    /* panel_height */ (uint16_t)DISPLAY_HEIGHT,
+    /* panel_round */ (bool)DISPLAY_ROUND,
+    /* lvgl_wire_order */ (bool)LVGL_COLOR_16_SWAP,
+    /* lvgl_buffer_px */ (uint32_t)(LVGL_BUFFER_SIZE),
+    /* lvgl_buffer_prefer_internal */ (bool)LVGL_BUFFER_PREFER_INTERNAL,
+    /* lvgl_double_buffer */ (bool)LVGL_DOUBLE_BUFFER,
+#else
+    false, 0, 0, false, false, 0, false, false,
+#endif
+#if !SOC_SPIRAM_SUPPORTED || (BOARD_PSRAM == 0)
+    /* psram */ BoardPsram::None,
+#elif BOARD_PSRAM > 0
+    /* psram */ BoardPsram::Fitted,
+#else
+    /* psram */ BoardPsram::Detect,
+#endif
+#if CONFIG_FREERTOS_UNICORE
+    /* cores */ 1,
+#else
+    /* cores */ 2,
+#endif
+    /* render_core */ (int8_t)TASK_RENDER_CORE,
+    /* network_core */ (int8_t)TASK_NETWORK_CORE,
+    /* background_core */ (int8_t)TASK_BACKGROUND_CORE,
+};
+
+// True when PSRAM can be allocated from. Constant unless the policy is Detect.
+inline bool board_psram_available() {
+    if constexpr (kBoardProfile.psram == BoardPsram::None) {
+        return false;
+    } else if constexpr (kBoardProfile.psram == BoardPsram::Fitted) {
+        return true;
+    } else {
+        static const bool present = heap_caps_get_total_size(MALLOC_CAP_SPIRAM) > 0;
+        return present;
+    }
+}
@@ -0,0 +1,79 @@
+#include "boot_timeline.h"
+
+#if BOOT_TIMELINE_SUPPORTED
+
+#include <Print.h>
+#include <esp_timer.h>
+#include <freertos/FreeRTOS.h>
+#include <string.h>
+
+namespace {
+
+struct BootPhaseEntry {
+    const char* name;
+    int64_t start_us;
+    int64_t end_us;  // -1 while running
+};
+
+// Written during boot from setup() and the boot WiFi task; read by /api/info.
+static portMUX_TYPE g_boot_mux = portMUX_INITIALIZER_UNLOCKED;
+static BootPhaseEntry g_phases[BOOT_TIMELINE_MAX_PHASES];
+static uint8_t g_phase_count = 0;
+
+static int add_entry(const char* name, bool instant) {
+    const int64_t now = esp_timer_get_time();
+    int slot = -1;
+    portENTER_CRITICAL(&g_boot_mux);
+    if (g_phase_count < BOOT_TIMELINE_MAX_PHASES) {
+        slot = g_phase_count++;
+        g_phases[slot] = {name, now, instant ? now : -1};
+    }
+    portEXIT_CRITICAL(&g_boot_mux);
+    return slot;
+}
+
+} // namespace
+
+int boot_phase_begin(const char* name) {
+    return add_entry(name, false);
+}
+
+void boot_phase_end(int slot) {
+    if (slot < 0 || slot >= BOOT_TIMELINE_MAX_PHASES) return;
+    const int64_t now = esp_timer_get_time();
+    portENTER_CRITICAL(&g_boot_mux);
+    g_phases[slot].end_us = now;
+    portEXIT_CRITICAL(&g_boot_mux);
+}
+
+void boot_milestone(const char* name) {
+    add_entry(name, true);
+}
+
+void boot_timeline_write_json(Print& out) {
+    BootPhaseEntry copy[BOOT_TIMELINE_MAX_PHASES];
+    portENTER_CRITICAL(&g_boot_mux);
+    const uint8_t n = g_phase_count;
+    memcpy(copy, g_phases, n * sizeof(BootPhaseEntry));
+    portEXIT_CRITICAL(&g_boot_mux);
+
+    out.print('[');
+    for (uint8_t i = 0; i < n; i++) {
+        const BootPhaseEntry& e = copy[i];
+        if (i) out.print(',');
+        out.print("{\"phase\":\"");
+        out.print(e.name);
+        out.print("\",\"start_ms\":");
+        out.print((unsigned long)(e.start_us / 1000));
+        out.print(",\"ms\":");
+        if (e.end_us < 0) {
+            out.print("null");
+        } else {
+            out.print((unsigned long)((e.end_us - e.start_us) / 1000));
+        }
+        out.print('}');
+    }
+    out.print(']');
+}
+
+#endif
@@ -0,0 +1,65 @@
+/*
+ * Boot Timeline
+ *
+ * Records when each setup() phase started and how long it ran, so slow
+ * power-cut recoveries can be broken down. Times come from esp_timer (µs since
+ * reset), so the ROM/bootloader time before setup() shows up as the start offset
+ * of the first phase. Phases may overlap (WiFi connects on its own task while the
+ * display initializes). Milestones are zero-length marks such as the first
+ * frame and the first live energy value.
+ *
+ * Exposed as "boot_timeline" in GET /api/info:
+ *   [{"phase":"config","start_ms":1320,"ms":42}, ...]
+ * A phase still running has "ms":null.
+ */
+
+#pragma once
+
+#include "board_config.h"
+
+#include <stdint.h>
+
+class Print;
+
+#if BOOT_TIMELINE_ENABLED
+
+#define BOOT_TIMELINE_SUPPORTED 1
+
+// `name` must be a string literal (only the pointer is kept).
+// Returns the slot for boot_phase_end(), or -1 once the table is full.
+int boot_phase_begin(const char* name);
+void boot_phase_end(int slot);
+
+// Zero-length mark. Callers guard repeats themselves (hot paths call this once).
+void boot_milestone(const char* name);
+
+// JSON array of all recorded phases and milestones, in start order.
+void boot_timeline_write_json(Print& out);
+
+// Scoped phase.
+class BootPhase {
+public:
+    explicit BootPhase(const char* name) : slot_(boot_phase_begin(name)) {}
+    ~BootPhase() { boot_phase_end(slot_); }
+    BootPhase(const BootPhase&) = delete;
+    BootPhase& operator=(const BootPhase&) = delete;
+
+private:
+    int slot_;
+};
+
+#define BOOT_CONCAT_INNER(a, b) a##b
+#define BOOT_CONCAT(a, b) BOOT_CONCAT_INNER(a, b)
+#define BOOT_PHASE(name) BootPhase BOOT_CONCAT(boot_phase_, __LINE__)(name)
+
+#else
+
+#define BOOT_TIMELINE_SUPPORTED 0
+
+inline int boot_phase_begin(const char*) { return -1; }
+inline void boot_phase_end(int) {}
+inline void boot_milestone(const char*) {}
+
+#define BOOT_PHASE(name) do {} while (0)
+
+#endif
@@ -9,8 +9,16 @@
 #include "board_config.h"
 #include "web_assets.h"
 #include "log_manager.h"
+#include "trace_ring.h"
 #include <Preferences.h>
 #include <nvs_flash.h>
+#include <nvs.h>
+#include <esp_rom_crc.h>
+#include <esp_system.h>
+#include <stddef.h>
+#include <freertos/FreeRTOS.h>
+#include <freertos/semphr.h>
+#include <esp_heap_caps.h>
 
 // NVS namespace
 #define CONFIG_NAMESPACE "device_cfg"
@@ -27,6 +35,7 @@
 #define KEY_DUMMY          "dummy"
 #define KEY_MQTT_HOST      "mqtt_host"
 #define KEY_MQTT_PORT      "mqtt_port"
+#define KEY_MQTT_TLS       "mqtt_tls"
 #define KEY_MQTT_USER      "mqtt_user"
 #define KEY_MQTT_PASS      "mqtt_pass"
 #define KEY_MQTT_INTERVAL  "mqtt_int"
@@ -34,6 +43,8 @@
 #define KEY_MQTT_GRID_TOPIC  "mqtt_grd_t"
 #define KEY_MQTT_SOLAR_PATH  "mqtt_sol_p"
 #define KEY_MQTT_GRID_PATH   "mqtt_grd_p"
+// Extra energy channels: "ex<i>_n" / "ex<i>_t" / "ex<i>_p" (name/topic/path)
+#define KEY_ENERGY_AUX_FMT   "ex%u_%c"
 #define KEY_ENERGY_SOLAR_BAR_MAX_KW "en_sol_m"
 #define KEY_ENERGY_HOME_BAR_MAX_KW  "en_hom_m"
 #define KEY_ENERGY_GRID_BAR_MAX_KW  "en_grd_m"
@@ -81,10 +92,62 @@
 #define KEY_SCREEN_SAVER_FADE_IN "ss_fi"
 #define KEY_SCREEN_SAVER_WAKE_TOUCH "ss_wt"
 #endif
+#if HAS_IMAGE_API
+#define KEY_IMAGE_REFRESH_URL "ir_url"
+#define KEY_IMAGE_REFRESH_INTERVAL "ir_int"
+#endif
+#if P1_METER_ENABLED
+#define KEY_P1_METER_URL "p1_url"
+#define KEY_P1_METER_GRID_PATH "p1_grd_p"
+#define KEY_P1_METER_SOLAR_PATH "p1_sol_p"
+#endif
 #define KEY_MAGIC          "magic"
 
+#if CONFIG_STORAGE_BLOB
+#define KEY_CONFIG_BLOB    "cfg_blob"
+
+// Bump when DeviceConfig changes layout, and add a step to upgrade_config_blob().
+// v1: everything up to the image refresh settings. v2: + p1_meter_* (before magic).
+#define CONFIG_BLOB_VERSION 2
+
+// Build flags that add or size DeviceConfig fields. Blobs record the set they
+// were written with (v2+); one written under another set is not read as this layout.
+static constexpr uint16_t kConfigBlobLayout =
+    (HAS_DISPLAY ? 0x0001 : 0) |
+    (HAS_IMAGE_API ? 0x0002 : 0) |
+    (uint16_t)((ENERGY_AUX_CHANNEL_COUNT & 0xFF) << 8);
+
+// Stored in front of the DeviceConfig bytes in the same blob.
+struct ConfigBlobHeader {
+    uint32_t magic;    // CONFIG_MAGIC
+    uint16_t version;  // CONFIG_BLOB_VERSION of the writer
+    uint16_t layout;   // kConfigBlobLayout of the writer (0 in v1 blobs)
+    uint32_t size;     // payload bytes
+    uint32_t crc;      // CRC32 (esp_rom_crc32_le) of the payload
+};
+#endif
+
 static Preferences preferences;
 
+// Last config loaded from / written to NVS: saves only write keys that differ from it.
+static DeviceConfig g_persisted;
+static bool g_persisted_valid = false;
+static uint16_t g_last_save_keys = 0;
+
+// Saves can come from the web task (POST /api/config) and the main loop
+// (write-behind flush); this keeps them from interleaving on the baseline.
+static SemaphoreHandle_t g_save_mutex = nullptr;
+
+// Edits of the live config (ConfigEditLock) vs. the write-behind snapshot.
+// Recursive: a restart from inside an edit runs the shutdown flush on that task.
+static SemaphoreHandle_t g_edit_mutex = nullptr;
+
+// Write-behind state (config_manager_save_deferred).
+static portMUX_TYPE g_pending_mux = portMUX_INITIALIZER_UNLOCKED;
+static const DeviceConfig *g_pending_config = nullptr;
+static uint32_t g_pending_change_ms = 0;
+static bool g_pending_dirty = false;
+
 static void set_energy_defaults(EnergyCategoryColorConfig* cfg) {
     if (!cfg) return;
     cfg->color_good_rgb = 0x00FF00;      // green
@@ -108,6 +171,10 @@ static void normalize_energy_thresholds(EnergyCategoryColorConfig* cfg) {
     }
 }
 
+static void config_manager_shutdown_handler() {
+    config_manager_flush_pending();
+}
+
 // Initialize NVS
 void config_manager_init() {
     LOGI("Config", "NVS init start");
@@ -123,6 +190,17 @@ void config_manager_init() {
         return;
     }
 
+    if (!g_save_mutex) {
+        g_save_mutex = xSemaphoreCreateMutex();
+    }
+    if (!g_edit_mutex) {
+        g_edit_mutex = xSemaphoreCreateRecursiveMutex();
+    }
+    // Deferred changes still in RAM are written before OTA / reboot restarts.
+    if (esp_register_shutdown_handler(config_manager_shutdown_handler) != ESP_OK) {
+        LOGW("Config", "Failed to register shutdown handler");
+    }
+
     LOGI("Config", "NVS init OK");
 }
 
@@ -169,15 +247,77 @@ void config_manager_sanitize_device_name(const char *input, char *output, size_t
     output[j] = '\0';
 }
 
-// Load configuration from NVS
-bool config_manager_load(DeviceConfig *config) {
-    if (!config) {
-        LOGE("Config", "Load failed: NULL pointer");
-        return false;
+// Defaults for fields that need sensible values even when no config exists
+static void set_config_defaults(DeviceConfig *config) {
+    config->backlight_brightness = 100;  // Default to full brightness
+    config->mqtt_port = 0;
+    config->mqtt_tls = false;
+    config->mqtt_interval_seconds = 0;
+
+    config->mqtt_topic_solar[0] = '\0';
+    config->mqtt_topic_grid[0] = '\0';
+
+    strlcpy(config->mqtt_solar_value_path, ".", CONFIG_MQTT_VALUE_PATH_MAX_LEN);
+    strlcpy(config->mqtt_grid_value_path, ".", CONFIG_MQTT_VALUE_PATH_MAX_LEN);
+
+    #if ENERGY_AUX_CHANNEL_COUNT > 0
+    for (unsigned i = 0; i < ENERGY_AUX_CHANNEL_COUNT; i++) {
+        EnergyChannelConfig* ch = &config->energy_aux_channels[i];
+        ch->name[0] = '\0';
+        ch->topic[0] = '\0';
+        strlcpy(ch->value_path, ".", CONFIG_MQTT_VALUE_PATH_MAX_LEN);
     }
+    #endif
 
-    LOGI("Config", "Load start");
+    // Energy monitor UI defaults (kW)
+    config->energy_solar_bar_max_kw = 3.0f;
+    config->energy_home_bar_max_kw = 3.0f;
+    config->energy_grid_bar_max_kw = 3.0f;
+
+    // Energy monitor warning defaults
+    config->energy_alarm_pulse_cycle_ms = 2000;
+    config->energy_alarm_pulse_peak_pct = 100;
+    config->energy_alarm_clear_delay_ms = 800;
+    config->energy_alarm_clear_hysteresis_mkw = 100;
 
+    // Energy monitor colors/thresholds defaults
+    set_energy_defaults(&config->energy_solar_colors);
+    set_energy_defaults(&config->energy_home_colors);
+    set_energy_defaults(&config->energy_grid_colors);
+
+    // Basic Auth defaults
+    config->basic_auth_enabled = false;
+    config->basic_auth_username[0] = '\0';
+    config->basic_auth_password[0] = '\0';
+
+    #if HAS_DISPLAY
+    // Screen saver defaults
+    config->screen_saver_enabled = false;
+    config->screen_saver_timeout_seconds = 300;
+    config->screen_saver_fade_out_ms = 800;
+    config->screen_saver_fade_in_ms = 400;
+    #if HAS_TOUCH
+    config->screen_saver_wake_on_touch = true;
+    #else
+    config->screen_saver_wake_on_touch = false;
+    #endif
+    #endif
+
+    #if HAS_IMAGE_API
+    // Scheduled image refresh defaults (off)
+    config->image_refresh_url[0] = '\0';
+    config->image_refresh_interval_seconds = 0;
+    #endif
+
+    // Local P1 meter defaults (off; HomeWizard grid power field)
+    config->p1_meter_url[0] = '\0';
+    strlcpy(config->p1_meter_grid_path, "active_power_w", CONFIG_MQTT_VALUE_PATH_MAX_LEN);
+    config->p1_meter_solar_path[0] = '\0';
+}
+
+// Per-key layout (one NVS entry per setting). Without CONFIG_STORAGE_BLOB this is
+// the storage format; with it, only the migration source.
+static bool load_from_keys(DeviceConfig *config) {
     if (!preferences.begin(CONFIG_NAMESPACE, true)) { // Read-only mode
         LOGE("Config", "Preferences begin failed");
         return false;
@@ -189,51 +329,7 @@ bool config_manager_load(DeviceConfig *config) {
         preferences.end();
         LOGW("Config", "No config found");
         
-        // Initialize defaults for fields that need sensible values even when no config exists
-        config->backlight_brightness = 100;  // Default to full brightness
-        config->mqtt_port = 0;
-        config->mqtt_interval_seconds = 0;
-
-        config->mqtt_topic_solar[0] = '\0';
-        config->mqtt_topic_grid[0] = '\0';
-
-        strlcpy(config->mqtt_solar_value_path, ".", CONFIG_MQTT_VALUE_PATH_MAX_LEN);
-        strlcpy(config->mqtt_grid_value_path, ".", CONFIG_MQTT_VALUE_PATH_MAX_LEN);
-
-        // Energy monitor UI defaults (kW)
-        config->energy_solar_bar_max_kw = 3.0f;
-        config->energy_home_bar_max_kw = 3.0f;
-        config->energy_grid_bar_max_kw = 3.0f;
-
-        // Energy monitor warning defaults
-        config->energy_alarm_pulse_cycle_ms = 2000;
-        config->energy_alarm_pulse_peak_pct = 100;
-        config->energy_alarm_clear_delay_ms = 800;
-        config->energy_alarm_clear_hysteresis_mkw = 100;
-
-        // Energy monitor colors/thresholds defaults
-        set_energy_defaults(&config->energy_solar_colors);
-        set_energy_defaults(&config->energy_home_colors);
-        set_energy_defaults(&config->energy_grid_colors);
-
-        // Basic Auth defaults
-        config->basic_auth_enabled = false;
-        config->basic_auth_username[0] = '\0';
-        config->basic_auth_password[0] = '\0';
-
-        #if HAS_DISPLAY
-        // Screen saver defaults
-        config->screen_saver_enabled = false;
-        config->screen_saver_timeout_seconds = 300;
-        config->screen_saver_fade_out_ms = 800;
-        config->screen_saver_fade_in_ms = 400;
-        #if HAS_TOUCH
-        config->screen_saver_wake_on_touch = true;
-        #else
-        config->screen_saver_wake_on_touch = false;
-        #endif
-        #endif
-        
+        set_config_defaults(config);
         return false;
     }
     
@@ -261,6 +357,7 @@ bool config_manager_load(DeviceConfig *config) {
     // Load MQTT settings (all optional)
     preferences.getString(KEY_MQTT_HOST, config->mqtt_host, CONFIG_MQTT_HOST_MAX_LEN);
     config->mqtt_port = preferences.getUShort(KEY_MQTT_PORT, 0);
+    config->mqtt_tls = preferences.getBool(KEY_MQTT_TLS, false);
     preferences.getString(KEY_MQTT_USER, config->mqtt_username, CONFIG_MQTT_USERNAME_MAX_LEN);
     preferences.getString(KEY_MQTT_PASS, config->mqtt_password, CONFIG_MQTT_PASSWORD_MAX_LEN);
     config->mqtt_interval_seconds = preferences.getUShort(KEY_MQTT_INTERVAL, 0);
@@ -273,6 +370,20 @@ bool config_manager_load(DeviceConfig *config) {
     if (strlen(config->mqtt_solar_value_path) == 0) strlcpy(config->mqtt_solar_value_path, ".", CONFIG_MQTT_VALUE_PATH_MAX_LEN);
     if (strlen(config->mqtt_grid_value_path) == 0) strlcpy(config->mqtt_grid_value_path, ".", CONFIG_MQTT_VALUE_PATH_MAX_LEN);
 
+    #if ENERGY_AUX_CHANNEL_COUNT > 0
+    for (unsigned i = 0; i < ENERGY_AUX_CHANNEL_COUNT; i++) {
+        EnergyChannelConfig* ch = &config->energy_aux_channels[i];
+        char key[12];
+        snprintf(key, sizeof(key), KEY_ENERGY_AUX_FMT, i, 'n');
+        preferences.getString(key, ch->name, CONFIG_ENERGY_CHANNEL_NAME_MAX_LEN);
+        snprintf(key, sizeof(key), KEY_ENERGY_AUX_FMT, i, 't');
+        preferences.getString(key, ch->topic, CONFIG_MQTT_TOPIC_MAX_LEN);
+        snprintf(key, sizeof(key), KEY_ENERGY_AUX_FMT, i, 'p');
+        preferences.getString(key, ch->value_path, CONFIG_MQTT_VALUE_PATH_MAX_LEN);
+        if (strlen(ch->value_path) == 0) strlcpy(ch->value_path, ".", CONFIG_MQTT_VALUE_PATH_MAX_LEN);
+    }
+    #endif
+
     // Energy Monitor UI scaling (kW)
     config->energy_solar_bar_max_kw = preferences.getFloat(KEY_ENERGY_SOLAR_BAR_MAX_KW, 3.0f);
     config->energy_home_bar_max_kw = preferences.getFloat(KEY_ENERGY_HOME_BAR_MAX_KW, 3.0f);
@@ -346,153 +457,582 @@ bool config_manager_load(DeviceConfig *config) {
     config->screen_saver_wake_on_touch = preferences.getBool(KEY_SCREEN_SAVER_WAKE_TOUCH, false);
     #endif
     #endif
+
+    #if HAS_IMAGE_API
+    // Load scheduled image refresh settings
+    preferences.getString(KEY_IMAGE_REFRESH_URL, config->image_refresh_url, CONFIG_IMAGE_REFRESH_URL_MAX_LEN);
+    config->image_refresh_interval_seconds = preferences.getUShort(KEY_IMAGE_REFRESH_INTERVAL, 0);
+    #endif
+
+    #if P1_METER_ENABLED
+    // Load local P1 meter settings
+    preferences.getString(KEY_P1_METER_URL, config->p1_meter_url, CONFIG_P1_METER_URL_MAX_LEN);
+    preferences.getString(KEY_P1_METER_GRID_PATH, config->p1_meter_grid_path, CONFIG_MQTT_VALUE_PATH_MAX_LEN);
+    if (strlen(config->p1_meter_grid_path) == 0) strlcpy(config->p1_meter_grid_path, "active_power_w", CONFIG_MQTT_VALUE_PATH_MAX_LEN);
+    preferences.getString(KEY_P1_METER_SOLAR_PATH, config->p1_meter_solar_path, CONFIG_MQTT_VALUE_PATH_MAX_LEN);
+    #endif
     
     config->magic = magic;
     
     preferences.end();
     
+    return true;
+}
+
+#if CONFIG_STORAGE_BLOB
+// Schema upgrades: bring a blob written by older firmware up to the current
+// DeviceConfig. `config` already holds defaults; copy what the old layout had and
+// return true. Returning false falls back to the per-key layout.
+static bool upgrade_config_blob(uint16_t from_version, const uint8_t *payload, size_t size, DeviceConfig *config) {
+    switch (from_version) {
+        case 1: {
+            // v1 = the v2 layout without the p1_meter_* fields, under the same build
+            // flags (v1 did not record them). Firmware that added the fields before
+            // the bump wrote them with version 1 too; those blobs are already full size.
+            static constexpr size_t kV1Prefix = offsetof(DeviceConfig, p1_meter_url);
+            static constexpr size_t kV1MagicOffset = (kV1Prefix + alignof(uint32_t) - 1) & ~(alignof(uint32_t) - 1);
+            static constexpr size_t kAlign = alignof(DeviceConfig);
+            static constexpr size_t kV1Size = (kV1MagicOffset + sizeof(uint32_t) + kAlign - 1) / kAlign * kAlign;
+            if (size == sizeof(DeviceConfig)) {
+                memcpy(config, payload, sizeof(DeviceConfig));
+                return true;
+            }
+            if (size != kV1Size) break;
+            memcpy(config, payload, kV1Prefix);
+            config->magic = CONFIG_MAGIC;
+            return true;
+        }
+        default:
+            break;
+    }
+    LOGW("Config", "No upgrade from blob v%u (%u bytes)", (unsigned)from_version, (unsigned)size);
+    return false;
+}
+
+// `present` reports whether a blob was stored at all, usable or not.
+static bool load_from_blob(DeviceConfig *config, bool *present) {
+    *present = false;
+    nvs_handle_t handle;
+    if (nvs_open(CONFIG_NAMESPACE, NVS_READONLY, &handle) != ESP_OK) {
+        return false;
+    }
+
+    // Sized for the current layout, so the common case is a single read. A blob of
+    // another length (older schema) is re-read at its stored size.
+    size_t len = sizeof(ConfigBlobHeader) + sizeof(DeviceConfig);
+    uint8_t *buf = (uint8_t *)malloc(len);
+    esp_err_t err = buf ? nvs_get_blob(handle, KEY_CONFIG_BLOB, buf, &len) : ESP_ERR_NO_MEM;
+    if (err == ESP_ERR_NVS_INVALID_LENGTH) {
+        free(buf);
+        buf = nullptr;
+        err = nvs_get_blob(handle, KEY_CONFIG_BLOB, nullptr, &len);
+        if (err == ESP_OK) {
+            buf = (uint8_t *)malloc(len);
+            err = buf ? nvs_get_blob(handle, KEY_CONFIG_BLOB, buf, &len) : ESP_ERR_NO_MEM;
+        }
+    }
+    nvs_close(handle);
+    *present = (err != ESP_ERR_NVS_NOT_FOUND);
+
+    bool ok = false;
+    ConfigBlobHeader hdr;
+    if (err != ESP_OK) {
+        if (err != ESP_ERR_NVS_NOT_FOUND) {
+            LOGW("Config", "Blob read failed (%d)", (int)err);
+        }
+    } else if (len < sizeof(hdr)) {
+        LOGW("Config", "Blob truncated (%u bytes)", (unsigned)len);
+    } else {
+        memcpy(&hdr, buf, sizeof(hdr));
+        const uint8_t *payload = buf + sizeof(hdr);
+        const size_t payload_len = len - sizeof(hdr);
+        if (hdr.magic != CONFIG_MAGIC || hdr.size != payload_len) {
+            LOGW("Config", "Blob header invalid");
+        } else if (esp_rom_crc32_le(0, payload, payload_len) != hdr.crc) {
+            LOGW("Config", "Blob CRC mismatch");
+        } else if (hdr.version >= 2 && hdr.layout != kConfigBlobLayout) {
+            LOGW("Config", "Blob layout 0x%04x != build 0x%04x", (unsigned)hdr.layout, (unsigned)kConfigBlobLayout);
+        } else if (hdr.version == CONFIG_BLOB_VERSION && payload_len == sizeof(DeviceConfig)) {
+            memcpy(config, payload, sizeof(DeviceConfig));
+            ok = true;
+        } else if (hdr.version < CONFIG_BLOB_VERSION) {
+            set_config_defaults(config);
+            ok = upgrade_config_blob(hdr.version, payload, payload_len, config);
+            if (ok) LOGI("Config", "Blob upgraded v%u -> v%u", (unsigned)hdr.version, (unsigned)CONFIG_BLOB_VERSION);
+        } else {
+            LOGW("Config", "Blob v%u (%u bytes) not supported", (unsigned)hdr.version, (unsigned)payload_len);
+        }
+    }
+
+    free(buf);
+    return ok;
+}
+
+// Writes `config` as one header + payload blob and commits.
+static bool write_blob(const DeviceConfig *config) {
+    const size_t len = sizeof(ConfigBlobHeader) + sizeof(DeviceConfig);
+    uint8_t *buf = (uint8_t *)malloc(len);
+    if (!buf) {
+        LOGE("Config", "Blob buffer alloc failed");
+        return false;
+    }
+
+    ConfigBlobHeader hdr = {};
+    hdr.magic = CONFIG_MAGIC;
+    hdr.version = CONFIG_BLOB_VERSION;
+    hdr.layout = kConfigBlobLayout;
+    hdr.size = sizeof(DeviceConfig);
+    hdr.crc = esp_rom_crc32_le(0, (const uint8_t *)config, sizeof(DeviceConfig));
+    memcpy(buf, &hdr, sizeof(hdr));
+    memcpy(buf + sizeof(hdr), config, sizeof(DeviceConfig));
+
+    nvs_handle_t handle;
+    esp_err_t err = nvs_open(CONFIG_NAMESPACE, NVS_READWRITE, &handle);
+    if (err == ESP_OK) {
+        err = nvs_set_blob(handle, KEY_CONFIG_BLOB, buf, len);
+        if (err == ESP_OK) err = nvs_commit(handle);
+        nvs_close(handle);
+    }
+    free(buf);
+
+    if (err != ESP_OK) {
+        LOGE("Config", "Blob write failed (%d)", (int)err);
+        return false;
+    }
+    return true;
+}
+#endif
+
+// Load configuration from NVS
+bool config_manager_load(DeviceConfig *config) {
+    if (!config) {
+        LOGE("Config", "Load failed: NULL pointer");
+        return false;
+    }
+
+    LOGI("Config", "Load start");
+
+    bool loaded = false;
+    #if CONFIG_STORAGE_BLOB
+    bool blob_present = false;
+    loaded = load_from_blob(config, &blob_present);
+    if (!loaded && !blob_present) {
+        // First boot on blob storage: read the per-key layout and migrate it.
+        // The old keys stay so a downgrade still finds its settings.
+        loaded = load_from_keys(config);
+        if (loaded && config_manager_is_valid(config) && write_blob(config)) {
+            LOGI("Config", "Migrated per-key config to blob v%u", (unsigned)CONFIG_BLOB_VERSION);
+        }
+    } else if (!loaded) {
+        // The per-key keys stopped being written when the blob was created, so
+        // loading them now would quietly bring back settings changed since then.
+        // Boot on defaults instead; the next save replaces the unusable blob.
+        LOGE("Config", "Config blob unusable: booting with defaults, not the older per-key settings");
+    }
+    #else
+    loaded = load_from_keys(config);
+    #endif
+    if (!loaded) {
+        return false;
+    }
+    
     // Validate loaded config
     if (!config_manager_is_valid(config)) {
         LOGE("Config", "Invalid config");
         return false;
     }
     
+    memcpy(&g_persisted, config, sizeof(g_persisted));
+    g_persisted_valid = true;
+
     config_manager_print(config);
     LOGI("Config", "Load complete");
     return true;
 }
 
-// Save configuration to NVS
-bool config_manager_save(const DeviceConfig *config) {
-    if (!config) {
-        LOGE("Config", "Save failed: NULL pointer");
-        return false;
+static uint16_t clamp_pulse_cycle(uint16_t v) {
+    if (v < 200) return 200;
+    if (v > 10000) return 10000;
+    return v;
+}
+
+static uint8_t clamp_peak_pct(uint8_t v) {
+    return v > 100 ? 100 : v;
+}
+
+static uint16_t clamp_clear_delay(uint16_t v) {
+    return v > 60000 ? 60000 : v;
+}
+
+static int32_t clamp_clear_hyst(int32_t v) {
+    if (v < 0) return 0;
+    if (v > 100000) return 100000;
+    return v;
+}
+
+#if CONFIG_STORAGE_BLOB
+// Stores the same values the per-key layout would (clamped alarm settings, 24-bit
+// colors), so both formats load back identical configs.
+static void normalize_for_storage(DeviceConfig *config) {
+    config->energy_alarm_pulse_cycle_ms = clamp_pulse_cycle(config->energy_alarm_pulse_cycle_ms);
+    config->energy_alarm_pulse_peak_pct = clamp_peak_pct(config->energy_alarm_pulse_peak_pct);
+    config->energy_alarm_clear_delay_ms = clamp_clear_delay(config->energy_alarm_clear_delay_ms);
+    config->energy_alarm_clear_hysteresis_mkw = clamp_clear_hyst(config->energy_alarm_clear_hysteresis_mkw);
+    EnergyCategoryColorConfig *cats[3] = {&config->energy_solar_colors, &config->energy_home_colors, &config->energy_grid_colors};
+    for (EnergyCategoryColorConfig *c : cats) {
+        c->color_good_rgb &= 0xFFFFFF;
+        c->color_ok_rgb &= 0xFFFFFF;
+        c->color_attention_rgb &= 0xFFFFFF;
+        c->color_warning_rgb &= 0xFFFFFF;
     }
-    
-    if (!config_manager_is_valid(config)) {
-        LOGE("Config", "Save failed: Invalid config");
+}
+
+// Rewrites the blob only when the stored bytes would change.
+static bool save_to_blob(const DeviceConfig *config, uint16_t *written) {
+    DeviceConfig *next = (DeviceConfig *)malloc(sizeof(DeviceConfig));
+    if (!next) {
+        LOGE("Config", "Save failed: out of memory");
         return false;
     }
+    memcpy(next, config, sizeof(DeviceConfig));
+    normalize_for_storage(next);
 
-    LOGI("Config", "Save start");
-    
-    preferences.begin(CONFIG_NAMESPACE, false); // Read-write mode
+    bool ok = true;
+    *written = 0;
+    if (!g_persisted_valid || memcmp(next, &g_persisted, sizeof(DeviceConfig)) != 0) {
+        ok = write_blob(next);
+        if (ok) *written = 1;
+    }
+    free(next);
+    return ok;
+}
+#else
+// Writes one key when its value changed (or unconditionally without a baseline).
+// Types match what Preferences uses, so config_manager_load() reads them back as before.
+struct NvsDiffWriter {
+    nvs_handle_t handle;
+    bool full;
+    uint16_t written;
+    esp_err_t err;
+
+    void track(esp_err_t e) {
+        written++;
+        if (e != ESP_OK && err == ESP_OK) err = e;
+    }
+
+    void str(const char *key, const char *v, const char *prev) {
+        if (!full && strcmp(v, prev) == 0) return;
+        track(nvs_set_str(handle, key, v));
+    }
+    void u8(const char *key, uint8_t v, uint8_t prev) {
+        if (!full && v == prev) return;
+        track(nvs_set_u8(handle, key, v));
+    }
+    void u16(const char *key, uint16_t v, uint16_t prev) {
+        if (!full && v == prev) return;
+        track(nvs_set_u16(handle, key, v));
+    }
+    void u32(const char *key, uint32_t v, uint32_t prev) {
+        if (!full && v == prev) return;
+        track(nvs_set_u32(handle, key, v));
+    }
+    void i32(const char *key, int32_t v, int32_t prev) {
+        if (!full && v == prev) return;
+        track(nvs_set_i32(handle, key, v));
+    }
+    void f32(const char *key, float v, float prev) {
+        // Preferences stores floats as 4-byte blobs.
+        if (!full && memcmp(&v, &prev, sizeof(v)) == 0) return;
+        track(nvs_set_blob(handle, key, &v, sizeof(v)));
+    }
+};
+
+// Key order: good, ok, attention, warning colors; then thresholds 0..2.
+static const char *const kSolarColorKeys[7] = {KEY_EN_SOL_CG, KEY_EN_SOL_CO, KEY_EN_SOL_CA, KEY_EN_SOL_CW, KEY_EN_SOL_T0, KEY_EN_SOL_T1, KEY_EN_SOL_T2};
+static const char *const kHomeColorKeys[7] = {KEY_EN_HOM_CG, KEY_EN_HOM_CO, KEY_EN_HOM_CA, KEY_EN_HOM_CW, KEY_EN_HOM_T0, KEY_EN_HOM_T1, KEY_EN_HOM_T2};
+static const char *const kGridColorKeys[7] = {KEY_EN_GRD_CG, KEY_EN_GRD_CO, KEY_EN_GRD_CA, KEY_EN_GRD_CW, KEY_EN_GRD_T0, KEY_EN_GRD_T1, KEY_EN_GRD_T2};
+
+static void save_energy_category(NvsDiffWriter &w, const char *const keys[7], const EnergyCategoryColorConfig &c, const EnergyCategoryColorConfig &p) {
+    w.u32(keys[0], c.color_good_rgb & 0xFFFFFF, p.color_good_rgb & 0xFFFFFF);
+    w.u32(keys[1], c.color_ok_rgb & 0xFFFFFF, p.color_ok_rgb & 0xFFFFFF);
+    w.u32(keys[2], c.color_attention_rgb & 0xFFFFFF, p.color_attention_rgb & 0xFFFFFF);
+    w.u32(keys[3], c.color_warning_rgb & 0xFFFFFF, p.color_warning_rgb & 0xFFFFFF);
+    for (unsigned t = 0; t < 3; t++) {
+        w.i32(keys[4 + t], c.threshold_mkw[t], p.threshold_mkw[t]);
+    }
+}
+
+// Writes only the keys that differ from the baseline, in one commit.
+static bool save_to_keys(const DeviceConfig *config, uint16_t *written) {
+    NvsDiffWriter w = {};
+    if (nvs_open(CONFIG_NAMESPACE, NVS_READWRITE, &w.handle) != ESP_OK) {
+        LOGE("Config", "NVS open failed");
+        return false;
+    }
+    w.full = !g_persisted_valid;
+    w.err = ESP_OK;
+    const DeviceConfig *prev = g_persisted_valid ? &g_persisted : config;
     
     // Save WiFi settings
-    preferences.putString(KEY_WIFI_SSID, config->wifi_ssid);
-    preferences.putString(KEY_WIFI_PASS, config->wifi_password);
+    w.str(KEY_WIFI_SSID, config->wifi_ssid, prev->wifi_ssid);
+    w.str(KEY_WIFI_PASS, config->wifi_password, prev->wifi_password);
     
     // Save device settings
-    preferences.putString(KEY_DEVICE_NAME, config->device_name);
+    w.str(KEY_DEVICE_NAME, config->device_name, prev->device_name);
     
     // Save fixed IP settings
-    preferences.putString(KEY_FIXED_IP, config->fixed_ip);
-    preferences.putString(KEY_SUBNET_MASK, config->subnet_mask);
-    preferences.putString(KEY_GATEWAY, config->gateway);
-    preferences.putString(KEY_DNS1, config->dns1);
-    preferences.putString(KEY_DNS2, config->dns2);
+    w.str(KEY_FIXED_IP, config->fixed_ip, prev->fixed_ip);
+    w.str(KEY_SUBNET_MASK, config->subnet_mask, prev->subnet_mask);
+    w.str(KEY_GATEWAY, config->gateway, prev->gateway);
+    w.str(KEY_DNS1, config->dns1, prev->dns1);
+    w.str(KEY_DNS2, config->dns2, prev->dns2);
     
     // Save dummy setting
-    preferences.putString(KEY_DUMMY, config->dummy_setting);
+    w.str(KEY_DUMMY, config->dummy_setting, prev->dummy_setting);
 
     // Save MQTT settings
-    preferences.putString(KEY_MQTT_HOST, config->mqtt_host);
-    preferences.putUShort(KEY_MQTT_PORT, config->mqtt_port);
-    preferences.putString(KEY_MQTT_USER, config->mqtt_username);
-    preferences.putString(KEY_MQTT_PASS, config->mqtt_password);
-    preferences.putUShort(KEY_MQTT_INTERVAL, config->mqtt_interval_seconds);
+    w.str(KEY_MQTT_HOST, config->mqtt_host, prev->mqtt_host);
+    w.u16(KEY_MQTT_PORT, config->mqtt_port, prev->mqtt_port);
+    w.u8(KEY_MQTT_TLS, config->mqtt_tls, prev->mqtt_tls);
+    w.str(KEY_MQTT_USER, config->mqtt_username, prev->mqtt_username);
+    w.str(KEY_MQTT_PASS, config->mqtt_password, prev->mqtt_password);
+    w.u16(KEY_MQTT_INTERVAL, config->mqtt_interval_seconds, prev->mqtt_interval_seconds);
 
     // Save Energy Monitor MQTT settings
-    preferences.putString(KEY_MQTT_SOLAR_TOPIC, config->mqtt_topic_solar);
-    preferences.putString(KEY_MQTT_GRID_TOPIC, config->mqtt_topic_grid);
-    preferences.putString(KEY_MQTT_SOLAR_PATH, config->mqtt_solar_value_path);
-    preferences.putString(KEY_MQTT_GRID_PATH, config->mqtt_grid_value_path);
+    w.str(KEY_MQTT_SOLAR_TOPIC, config->mqtt_topic_solar, prev->mqtt_topic_solar);
+    w.str(KEY_MQTT_GRID_TOPIC, config->mqtt_topic_grid, prev->mqtt_topic_grid);
+    w.str(KEY_MQTT_SOLAR_PATH, config->mqtt_solar_value_path, prev->mqtt_solar_value_path);
+    w.str(KEY_MQTT_GRID_PATH, config->mqtt_grid_value_path, prev->mqtt_grid_value_path);
+
+    #if ENERGY_AUX_CHANNEL_COUNT > 0
+    for (unsigned i = 0; i < ENERGY_AUX_CHANNEL_COUNT; i++) {
+        const EnergyChannelConfig* ch = &config->energy_aux_channels[i];
+        const EnergyChannelConfig* pch = &prev->energy_aux_channels[i];
+        char key[12];
+        snprintf(key, sizeof(key), KEY_ENERGY_AUX_FMT, i, 'n');
+        w.str(key, ch->name, pch->name);
+        snprintf(key, sizeof(key), KEY_ENERGY_AUX_FMT, i, 't');
+        w.str(key, ch->topic, pch->topic);
+        snprintf(key, sizeof(key), KEY_ENERGY_AUX_FMT, i, 'p');
+        w.str(key, ch->value_path, pch->value_path);
+    }
+    #endif
 
     // Save Energy Monitor UI scaling (kW)
-    float solar_max = config->energy_solar_bar_max_kw;
-    float home_max = config->energy_home_bar_max_kw;
-    float grid_max = config->energy_grid_bar_max_kw;
-    preferences.putFloat(KEY_ENERGY_SOLAR_BAR_MAX_KW, solar_max);
-    preferences.putFloat(KEY_ENERGY_HOME_BAR_MAX_KW, home_max);
-    preferences.putFloat(KEY_ENERGY_GRID_BAR_MAX_KW, grid_max);
+    w.f32(KEY_ENERGY_SOLAR_BAR_MAX_KW, config->energy_solar_bar_max_kw, prev->energy_solar_bar_max_kw);
+    w.f32(KEY_ENERGY_HOME_BAR_MAX_KW, config->energy_home_bar_max_kw, prev->energy_home_bar_max_kw);
+    w.f32(KEY_ENERGY_GRID_BAR_MAX_KW, config->energy_grid_bar_max_kw, prev->energy_grid_bar_max_kw);
 
     // Save Energy Monitor warning behavior
-    uint16_t pulse_cycle = config->energy_alarm_pulse_cycle_ms;
-    if (pulse_cycle < 200) pulse_cycle = 200;
-    if (pulse_cycle > 10000) pulse_cycle = 10000;
-    uint8_t peak_pct = config->energy_alarm_pulse_peak_pct;
-    if (peak_pct > 100) peak_pct = 100;
-    uint16_t clear_delay = config->energy_alarm_clear_delay_ms;
-    if (clear_delay > 60000) clear_delay = 60000;
-    int32_t clear_hyst = config->energy_alarm_clear_hysteresis_mkw;
-    if (clear_hyst < 0) clear_hyst = 0;
-    if (clear_hyst > 100000) clear_hyst = 100000;
-
-    preferences.putUShort(KEY_ENERGY_ALARM_PULSE_CYCLE_MS, pulse_cycle);
-    preferences.putUChar(KEY_ENERGY_ALARM_PULSE_PEAK_PCT, peak_pct);
-    preferences.putUShort(KEY_ENERGY_ALARM_CLEAR_DELAY_MS, clear_delay);
-    preferences.putInt(KEY_ENERGY_ALARM_CLEAR_HYST_MKW, clear_hyst);
+    w.u16(KEY_ENERGY_ALARM_PULSE_CYCLE_MS, clamp_pulse_cycle(config->energy_alarm_pulse_cycle_ms), clamp_pulse_cycle(prev->energy_alarm_pulse_cycle_ms));
+    w.u8(KEY_ENERGY_ALARM_PULSE_PEAK_PCT, clamp_peak_pct(config->energy_alarm_pulse_peak_pct), clamp_peak_pct(prev->energy_alarm_pulse_peak_pct));
+    w.u16(KEY_ENERGY_ALARM_CLEAR_DELAY_MS, clamp_clear_delay(config->energy_alarm_clear_delay_ms), clamp_clear_delay(prev->energy_alarm_clear_delay_ms));
+    w.i32(KEY_ENERGY_ALARM_CLEAR_HYST_MKW, clamp_clear_hyst(config->energy_alarm_clear_hysteresis_mkw), clamp_clear_hyst(prev->energy_alarm_clear_hysteresis_mkw));
 
     // Save Energy Monitor colors/thresholds
-    preferences.putUInt(KEY_EN_SOL_CG, config->energy_solar_colors.color_good_rgb & 0xFFFFFF);
-    preferences.putUInt(KEY_EN_SOL_CO, config->energy_solar_colors.color_ok_rgb & 0xFFFFFF);
-    preferences.putUInt(KEY_EN_SOL_CA, config->energy_solar_colors.color_attention_rgb & 0xFFFFFF);
-    preferences.putUInt(KEY_EN_SOL_CW, config->energy_solar_colors.color_warning_rgb & 0xFFFFFF);
-    preferences.putInt(KEY_EN_SOL_T0, config->energy_solar_colors.threshold_mkw[0]);
-    preferences.putInt(KEY_EN_SOL_T1, config->energy_solar_colors.threshold_mkw[1]);
-    preferences.putInt(KEY_EN_SOL_T2, config->energy_solar_colors.threshold_mkw[2]);
-
-    preferences.putUInt(KEY_EN_HOM_CG, config->energy_home_colors.color_good_rgb & 0xFFFFFF);
-    preferences.putUInt(KEY_EN_HOM_CO, config->energy_home_colors.color_ok_rgb & 0xFFFFFF);
-    preferences.putUInt(KEY_EN_HOM_CA, config->energy_home_colors.color_attention_rgb & 0xFFFFFF);
-    preferences.putUInt(KEY_EN_HOM_CW, config->energy_home_colors.color_warning_rgb & 0xFFFFFF);
-    preferences.putInt(KEY_EN_HOM_T0, config->energy_home_colors.threshold_mkw[0]);
-    preferences.putInt(KEY_EN_HOM_T1, config->energy_home_colors.threshold_mkw[1]);
-    preferences.putInt(KEY_EN_HOM_T2, config->energy_home_colors.threshold_mkw[2]);
-
-    preferences.putUInt(KEY_EN_GRD_CG, config->energy_grid_colors.color_good_rgb & 0xFFFFFF);
-    preferences.putUInt(KEY_EN_GRD_CO, config->energy_grid_colors.color_ok_rgb & 0xFFFFFF);
-    preferences.putUInt(KEY_EN_GRD_CA, config->energy_grid_colors.color_attention_rgb & 0xFFFFFF);
-    preferences.putUInt(KEY_EN_GRD_CW, config->energy_grid_colors.color_warning_rgb & 0xFFFFFF);
-    preferences.putInt(KEY_EN_GRD_T0, config->energy_grid_colors.threshold_mkw[0]);
-    preferences.putInt(KEY_EN_GRD_T1, config->energy_grid_colors.threshold_mkw[1]);
-    preferences.putInt(KEY_EN_GRD_T2, config->energy_grid_colors.threshold_mkw[2]);
+    save_energy_category(w, kSolarColorKeys, config->energy_solar_colors, prev->energy_solar_colors);
+    save_energy_category(w, kHomeColorKeys, config->energy_home_colors, prev->energy_home_colors);
+    save_energy_category(w, kGridColorKeys, config->energy_grid_colors, prev->energy_grid_colors);
     
     // Save display settings
-    LOGI("Config", "Saving brightness: %d%%", config->backlight_brightness);
-    preferences.putUChar(KEY_BACKLIGHT_BRIGHTNESS, config->backlight_brightness);
+    if (config->backlight_brightness != prev->backlight_brightness || w.full) {
+        LOGI("Config", "Saving brightness: %d%%", config->backlight_brightness);
+    }
+    w.u8(KEY_BACKLIGHT_BRIGHTNESS, config->backlight_brightness, prev->backlight_brightness);
 
     // Save Basic Auth settings
-    preferences.putBool(KEY_BASIC_AUTH_ENABLED, config->basic_auth_enabled);
-    preferences.putString(KEY_BASIC_AUTH_USER, config->basic_auth_username);
-    preferences.putString(KEY_BASIC_AUTH_PASS, config->basic_auth_password);
+    w.u8(KEY_BASIC_AUTH_ENABLED, config->basic_auth_enabled, prev->basic_auth_enabled);
+    w.str(KEY_BASIC_AUTH_USER, config->basic_auth_username, prev->basic_auth_username);
+    w.str(KEY_BASIC_AUTH_PASS, config->basic_auth_password, prev->basic_auth_password);
 
     #if HAS_DISPLAY
     // Save screen saver settings
-    preferences.putBool(KEY_SCREEN_SAVER_ENABLED, config->screen_saver_enabled);
-    preferences.putUShort(KEY_SCREEN_SAVER_TIMEOUT, config->screen_saver_timeout_seconds);
-    preferences.putUShort(KEY_SCREEN_SAVER_FADE_OUT, config->screen_saver_fade_out_ms);
-    preferences.putUShort(KEY_SCREEN_SAVER_FADE_IN, config->screen_saver_fade_in_ms);
-    preferences.putBool(KEY_SCREEN_SAVER_WAKE_TOUCH, config->screen_saver_wake_on_touch);
+    w.u8(KEY_SCREEN_SAVER_ENABLED, config->screen_saver_enabled, prev->screen_saver_enabled);
+    w.u16(KEY_SCREEN_SAVER_TIMEOUT, config->screen_saver_timeout_seconds, prev->screen_saver_timeout_seconds);
+    w.u16(KEY_SCREEN_SAVER_FADE_OUT, config->screen_saver_fade_out_ms, prev->screen_saver_fade_out_ms);
+    w.u16(KEY_SCREEN_SAVER_FADE_IN, config->screen_saver_fade_in_ms, prev->screen_saver_fade_in_ms);
+    w.u8(KEY_SCREEN_SAVER_WAKE_TOUCH, config->screen_saver_wake_on_touch, prev->screen_saver_wake_on_touch);
+    #endif
+
+    #if HAS_IMAGE_API
+    // Save scheduled image refresh settings
+    w.str(KEY_IMAGE_REFRESH_URL, config->image_refresh_url, prev->image_refresh_url);
+    w.u16(KEY_IMAGE_REFRESH_INTERVAL, config->image_refresh_interval_seconds, prev->image_refresh_interval_seconds);
+    #endif
+
+    #if P1_METER_ENABLED
+    // Save local P1 meter settings
+    w.str(KEY_P1_METER_URL, config->p1_meter_url, prev->p1_meter_url);
+    w.str(KEY_P1_METER_GRID_PATH, config->p1_meter_grid_path, prev->p1_meter_grid_path);
+    w.str(KEY_P1_METER_SOLAR_PATH, config->p1_meter_solar_path, prev->p1_meter_solar_path);
     #endif
     
-    // Save magic number last (indicates valid config)
-    preferences.putUInt(KEY_MAGIC, CONFIG_MAGIC);
+    // Magic number (indicates valid config); only needed on a full write.
+    if (w.full) {
+        w.track(nvs_set_u32(w.handle, KEY_MAGIC, CONFIG_MAGIC));
+    }
+
+    esp_err_t err = w.err;
+    if (err == ESP_OK && w.written > 0) {
+        err = nvs_commit(w.handle);
+    }
+    nvs_close(w.handle);
+
+    if (err != ESP_OK) {
+        LOGE("Config", "Save failed (%d)", (int)err);
+        return false;
+    }
+    *written = w.written;
+    return true;
+}
+#endif
+
+// Save configuration to NVS (only what changed, one commit)
+bool config_manager_save(const DeviceConfig *config) {
+    if (!config) {
+        LOGE("Config", "Save failed: NULL pointer");
+        return false;
+    }
     
-    preferences.end();
+    if (!config_manager_is_valid(config)) {
+        LOGE("Config", "Save failed: Invalid config");
+        return false;
+    }
+
+    if (g_save_mutex && xSemaphoreTake(g_save_mutex, pdMS_TO_TICKS(2000)) != pdTRUE) {
+        LOGE("Config", "Save failed: busy");
+        return false;
+    }
+    struct SaveLock {
+        ~SaveLock() { if (g_save_mutex) xSemaphoreGive(g_save_mutex); }
+    } lock;
+
+    LOGI("Config", "Save start");
+    TRACE_SCOPE(TraceEvent::NvsWrite);
+
+    // A direct save also covers a pending deferred one for the same config.
+    portENTER_CRITICAL(&g_pending_mux);
+    if (g_pending_config == config) g_pending_dirty = false;
+    portEXIT_CRITICAL(&g_pending_mux);
+
+    const bool full = !g_persisted_valid;
+    uint16_t written = 0;
+    #if CONFIG_STORAGE_BLOB
+    const bool ok = save_to_blob(config, &written);
+    #else
+    const bool ok = save_to_keys(config, &written);
+    #endif
+    if (!ok) {
+        // Unknown NVS state: the next save writes everything again.
+        g_persisted_valid = false;
+        return false;
+    }
+
+    memcpy(&g_persisted, config, sizeof(g_persisted));
+    g_persisted_valid = true;
+    g_last_save_keys = written;
     
     config_manager_print(config);
-    LOGI("Config", "Save complete");
+    LOGI("Config", "Save complete keys=%u%s", (unsigned)written, full ? " (full)" : "");
     return true;
 }
 
+uint16_t config_manager_last_save_key_count() {
+    return g_last_save_keys;
+}
+
+void config_manager_save_deferred(const DeviceConfig *config) {
+    if (!config) return;
+    portENTER_CRITICAL(&g_pending_mux);
+    g_pending_config = config;
+    g_pending_change_ms = millis();
+    g_pending_dirty = true;
+    portEXIT_CRITICAL(&g_pending_mux);
+}
+
+// Claims the pending config when it is dirty and (unless forced) has been quiet
+// for CONFIG_PERSIST_DEBOUNCE_MS. Clearing the flag first means a change that
+// lands while the save runs marks it dirty again instead of being lost.
+static const DeviceConfig *take_pending(uint32_t now_ms, bool force) {
+    const DeviceConfig *config = nullptr;
+    portENTER_CRITICAL(&g_pending_mux);
+    if (g_pending_dirty && (force || (uint32_t)(now_ms - g_pending_change_ms) >= (uint32_t)CONFIG_PERSIST_DEBOUNCE_MS)) {
+        g_pending_dirty = false;
+        config = g_pending_config;
+    }
+    portEXIT_CRITICAL(&g_pending_mux);
+    return config;
+}
+
+void config_manager_edit_lock() {
+    if (g_edit_mutex) xSemaphoreTakeRecursive(g_edit_mutex, portMAX_DELAY);
+}
+
+void config_manager_edit_unlock() {
+    if (g_edit_mutex) xSemaphoreGiveRecursive(g_edit_mutex);
+}
+
+static bool save_pending(const DeviceConfig *config) {
+    // Save a copy taken under the edit lock: the live config may be mid-edit on
+    // async_tcp, and the NVS write is too slow to hold the lock across.
+    void *mem = heap_caps_malloc(sizeof(DeviceConfig), MALLOC_CAP_SPIRAM | MALLOC_CAP_8BIT);
+    if (!mem) mem = heap_caps_malloc(sizeof(DeviceConfig), MALLOC_CAP_INTERNAL | MALLOC_CAP_8BIT);
+    bool ok = false;
+    if (!mem) {
+        LOGE("Config", "Write-behind save failed: out of memory");
+    } else if (g_edit_mutex && xSemaphoreTakeRecursive(g_edit_mutex, pdMS_TO_TICKS(2000)) != pdTRUE) {
+        LOGE("Config", "Write-behind save failed: config busy");
+    } else {
+        memcpy(mem, config, sizeof(DeviceConfig));
+        if (g_edit_mutex) xSemaphoreGiveRecursive(g_edit_mutex);
+        ok = config_manager_save((const DeviceConfig *)mem);
+    }
+    heap_caps_free(mem);
+    if (ok) return true;
+
+    // Retry after another debounce window (unless something newer is already pending).
+    portENTER_CRITICAL(&g_pending_mux);
+    if (!g_pending_dirty) {
+        g_pending_dirty = true;
+        g_pending_change_ms = millis();
+    }
+    portEXIT_CRITICAL(&g_pending_mux);
+    return false;
+}
+
+void config_manager_persist_loop(uint32_t now_ms) {
+    const DeviceConfig *config = take_pending(now_ms, false);
+    if (!config) return;
+    LOGI("Config", "Write-behind save");
+    save_pending(config);
+}
+
+bool config_manager_flush_pending() {
+    const DeviceConfig *config = take_pending(millis(), true);
+    if (!config) return true;
+    return save_pending(config);
+}
+
+bool config_manager_is_dirty() {
+    portENTER_CRITICAL(&g_pending_mux);
+    const bool dirty = g_pending_dirty;
+    portEXIT_CRITICAL(&g_pending_mux);
+    return dirty;
+}
+
 // Reset configuration (erase from NVS)
 bool config_manager_reset() {
     LOGI("Config", "Reset start");
     
+    // Drop deferred changes so the shutdown flush cannot write them back.
+    portENTER_CRITICAL(&g_pending_mux);
+    g_pending_dirty = false;
+    portEXIT_CRITICAL(&g_pending_mux);
+
     preferences.begin(CONFIG_NAMESPACE, false);
     bool success = preferences.clear();
     preferences.end();
+    g_persisted_valid = false;
     
     if (success) {
         LOGI("Config", "Reset complete");
@@ -503,6 +1043,37 @@ bool config_manager_reset() {
     return success;
 }
 
+// Binary records (e.g. energy totals checkpoints). Uses its own Preferences handle so
+// it can run concurrently with config load/save from other tasks (NVS is thread-safe).
+bool config_manager_put_blob(const char *key, const void *data, size_t len) {
+    if (!key || !data || len == 0) return false;
+    TRACE_SCOPE(TraceEvent::NvsWrite);
+
+    Preferences prefs;
+    if (!prefs.begin(CONFIG_NAMESPACE, false)) {
+        LOGE("Config", "Preferences begin failed (blob %s)", key);
+        return false;
+    }
+    const size_t written = prefs.putBytes(key, data, len);
+    prefs.end();
+    return written == len;
+}
+
+bool config_manager_get_blob(const char *key, void *data, size_t len) {
+    if (!key || !data || len == 0) return false;
+
+    Preferences prefs;
+    if (!prefs.begin(CONFIG_NAMESPACE, true)) {
+        return false;
+    }
+    bool ok = false;
+    if (prefs.isKey(key) && prefs.getBytesLength(key) == len) {
+        ok = prefs.getBytes(key, data, len) == len;
+    }
+    prefs.end();
+    return ok;
+}
+
 // Check if configuration is valid
 bool config_manager_is_valid(const DeviceConfig *config) {
     if (!config) return false;
@@ -542,11 +1113,11 @@ void config_manager_print(const DeviceConfig *config) {
 
 #if HAS_MQTT
     if (strlen(config->mqtt_host) > 0) {
-        uint16_t port = config->mqtt_port > 0 ? config->mqtt_port : 1883;
+        uint16_t port = config->mqtt_port > 0 ? config->mqtt_port : (config->mqtt_tls ? 8883 : 1883);
         if (config->mqtt_interval_seconds > 0) {
-            LOGI("Config", "MQTT: %s:%d (%ds)", config->mqtt_host, port, config->mqtt_interval_seconds);
+            LOGI("Config", "MQTT: %s:%d%s (%ds)", config->mqtt_host, port, config->mqtt_tls ? " TLS" : "", config->mqtt_interval_seconds);
         } else {
-            LOGI("Config", "MQTT: %s:%d (publish disabled)", config->mqtt_host, port);
+            LOGI("Config", "MQTT: %s:%d%s (publish disabled)", config->mqtt_host, port, config->mqtt_tls ? " TLS" : "");
         }
         LOGI("Config", "MQTT User: %s", strlen(config->mqtt_username) > 0 ? config->mqtt_username : "(none)");
         LOGI("Config", "MQTT Pass: %s", strlen(config->mqtt_password) > 0 ? "***" : "(none)");
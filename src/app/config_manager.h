@@ -35,10 +35,26 @@
 #define CONFIG_MQTT_TOPIC_MAX_LEN 128
 #define CONFIG_MQTT_VALUE_PATH_MAX_LEN 32
 
+// Additional energy channels (battery, EV charger, heat pump, ...)
+#define CONFIG_ENERGY_CHANNEL_NAME_MAX_LEN 16
+
 // Web portal Basic Auth (STA/full mode only)
 #define CONFIG_BASIC_AUTH_USERNAME_MAX_LEN 32
 #define CONFIG_BASIC_AUTH_PASSWORD_MAX_LEN 64
 
+// Scheduled image refresh (image API)
+#define CONFIG_IMAGE_REFRESH_URL_MAX_LEN 256
+
+// Local P1 meter energy source
+#define CONFIG_P1_METER_URL_MAX_LEN 96
+
+// Additional MQTT energy source (beyond the built-in solar/grid topics).
+struct EnergyChannelConfig {
+    char name[CONFIG_ENERGY_CHANNEL_NAME_MAX_LEN];   // display/log name (e.g. "battery")
+    char topic[CONFIG_MQTT_TOPIC_MAX_LEN];           // empty = channel unused
+    char value_path[CONFIG_MQTT_VALUE_PATH_MAX_LEN]; // "." or top-level JSON key
+};
+
 // Configuration structure
 struct EnergyCategoryColorConfig {
     // Colors stored as 0xRRGGBB
@@ -72,7 +88,8 @@ struct DeviceConfig {
 
     // MQTT / Home Assistant integration settings (all optional)
     char mqtt_host[CONFIG_MQTT_HOST_MAX_LEN];
-    uint16_t mqtt_port; // default to 1883 when mqtt_host set and mqtt_port is 0
+    uint16_t mqtt_port; // default to 1883 (8883 with TLS) when mqtt_host set and mqtt_port is 0
+    bool mqtt_tls;      // TLS transport (requires MQTT_TLS_ENABLED)
     char mqtt_username[CONFIG_MQTT_USERNAME_MAX_LEN];
     char mqtt_password[CONFIG_MQTT_PASSWORD_MAX_LEN];
     uint16_t mqtt_interval_seconds; // 0 disables periodic publish
@@ -84,6 +101,11 @@ struct DeviceConfig {
     char mqtt_solar_value_path[CONFIG_MQTT_VALUE_PATH_MAX_LEN];
     char mqtt_grid_value_path[CONFIG_MQTT_VALUE_PATH_MAX_LEN];
 
+#if ENERGY_AUX_CHANNEL_COUNT > 0
+    // Extra energy channels (energy_monitor channels 2..N).
+    EnergyChannelConfig energy_aux_channels[ENERGY_AUX_CHANNEL_COUNT];
+#endif
+
     // Energy monitor UI scaling (kW). Defaults to 3.0.
     float energy_solar_bar_max_kw;
     float energy_home_bar_max_kw;
@@ -120,6 +142,19 @@ struct DeviceConfig {
     uint16_t screen_saver_fade_in_ms;        // default 400
     bool screen_saver_wake_on_touch;         // default true (when HAS_TOUCH)
 #endif
+
+#if HAS_IMAGE_API
+    // Scheduled image refresh: conditional GET of a JPEG URL every N seconds (0 = off)
+    char image_refresh_url[CONFIG_IMAGE_REFRESH_URL_MAX_LEN];
+    uint16_t image_refresh_interval_seconds;
+#endif
+
+    // Local P1 meter polled over HTTP ("" = off); value paths as for MQTT ("" = channel not read).
+    // Present in every build (unused without P1_METER_ENABLED), so the config blob layout does not
+    // depend on the flag. New fields go here, after the last blob version's fields.
+    char p1_meter_url[CONFIG_P1_METER_URL_MAX_LEN];
+    char p1_meter_grid_path[CONFIG_MQTT_VALUE_PATH_MAX_LEN];
+    char p1_meter_solar_path[CONFIG_MQTT_VALUE_PATH_MAX_LEN];
     
     // Validation flag (magic number to detect valid config)
     uint32_t magic;
@@ -131,11 +166,35 @@ struct DeviceConfig {
 // API Functions
 void config_manager_init();                           // Initialize NVS
 bool config_manager_load(DeviceConfig *config);       // Load config from NVS
-bool config_manager_save(const DeviceConfig *config); // Save config to NVS
-bool config_manager_reset();                          // Erase config from NVS
+bool config_manager_save(const DeviceConfig *config); // Save config to NVS (changed keys only)
+uint16_t config_manager_last_save_key_count();        // NVS keys written by the last successful save
+bool config_manager_reset();                          // Erase config from NVS (drops deferred changes)
+
+// Write-behind persistence for live tuning: the caller's in-RAM config is already
+// in effect; it is saved CONFIG_PERSIST_DEBOUNCE_MS after the last change, or
+// before an OTA / reboot restart. `config` must stay valid (the device config).
+void config_manager_save_deferred(const DeviceConfig *config);
+// Held while a web handler edits the live config in place; the write-behind save
+// copies it under the same lock, so it never persists a half-applied edit.
+void config_manager_edit_lock();
+void config_manager_edit_unlock();
+struct ConfigEditLock {
+    ConfigEditLock() { config_manager_edit_lock(); }
+    ~ConfigEditLock() { config_manager_edit_unlock(); }
+    ConfigEditLock(const ConfigEditLock&) = delete;
+    ConfigEditLock& operator=(const ConfigEditLock&) = delete;
+};
+void config_manager_persist_loop(uint32_t now_ms);    // Main loop: save once the debounce window passed
+bool config_manager_flush_pending();                  // Save now if dirty (true when nothing failed)
+bool config_manager_is_dirty();                       // Deferred changes not yet in NVS
 bool config_manager_is_valid(const DeviceConfig *config); // Check if config is valid
 void config_manager_print(const DeviceConfig *config); // Debug print config
 void config_manager_sanitize_device_name(const char *input, char *output, size_t max_len); // Sanitize name for mDNS
 String config_manager_get_default_device_name();      // Get default device name with chip ID
 
+// Small binary records stored next to the config (same NVS namespace, erased by reset).
+// get_blob returns true only when the stored record is exactly `len` bytes.
+bool config_manager_put_blob(const char *key, const void *data, size_t len);
+bool config_manager_get_blob(const char *key, void *data, size_t len);
+
 #endif // CONFIG_MANAGER_H
@@ -0,0 +1,459 @@
+#include "crash_record.h"
+
+#if CRASH_RECORD_SUPPORTED
+
+#include "../version.h"
+#include "app_alloc.h"
+#include "device_telemetry.h"
+#include "fs_health.h"
+#include "log_manager.h"
+#include "trace_ring.h"
+#include "web_portal_json.h"
+
+#if HAS_DISPLAY
+#include "display_manager.h"
+#endif
+#if HAS_MQTT
+#include "mqtt_manager.h"
+#endif
+#if HAS_IMAGE_API
+#include "image_arena.h"
+#endif
+
+#include <Arduino.h>
+#include <ESPAsyncWebServer.h>
+#include <FFat.h>
+#include <esp_attr.h>
+#include <esp_idf_version.h>
+#include <esp_rom_crc.h>
+#include <esp_system.h>
+#include <sdkconfig.h>
+#include <string.h>
+
+// The summary API needs the core dump in flash and in ELF format.
+#if defined(CONFIG_ESP_COREDUMP_ENABLE_TO_FLASH) && defined(CONFIG_ESP_COREDUMP_DATA_FORMAT_ELF) && __has_include(<esp_core_dump.h>)
+#include <esp_core_dump.h>
+#define CRASH_RECORD_HAS_COREDUMP 1
+#else
+#define CRASH_RECORD_HAS_COREDUMP 0
+#endif
+
+namespace {
+
+static constexpr uint32_t kCrumbMagic = 0x43524231;   // "CRB1"
+static constexpr uint32_t kRecordMagic = 0x43525231;  // "CRR1"
+static constexpr uint16_t kRecordVersion = 1;
+static constexpr size_t kTagCount = (size_t)AllocTag::Count;
+static constexpr size_t kBacktraceMax = 16;
+static constexpr const char* kDir = "/diag";
+static constexpr const char* kPath = "/diag/last_crash.bin";
+static constexpr const char* kTmpPath = "/diag/last_crash.tmp";
+
+struct CrumbAlloc {
+    uint32_t live;
+    uint32_t peak;
+    uint32_t failed;
+};
+
+// Everything loop() knows about the running boot; rewritten every snapshot.
+struct Breadcrumb {
+    uint32_t magic;
+    uint32_t crc;                 // over the bytes after this field
+    uint32_t uptime_ms;           // millis() of the last snapshot
+    uint32_t snapshots;
+    char firmware[16];
+
+    uint32_t heap_internal_free;
+    uint32_t heap_internal_min;
+    uint32_t heap_largest;
+    uint32_t psram_free;
+    uint32_t psram_min;
+    uint32_t psram_largest;
+    CrumbAlloc alloc[kTagCount];
+
+    uint16_t display_fps;         // 0xFFFF = no display stats
+    uint16_t mqtt_outbound_depth;
+    uint32_t display_lv_timer_us;
+    uint32_t display_flush_p95_us;
+    uint32_t display_present_us;
+    uint16_t mqtt_outbound_high_water;
+    uint16_t reserved;
+    uint32_t mqtt_outbound_dropped;
+    uint32_t image_arena_used;
+    uint32_t image_arena_peak;
+
+    uint32_t tripwire_uptime_ms;  // 0 = not fired
+    uint32_t tripwire_internal_min;
+
+    uint32_t trace_count;
+    TraceRecentEvent trace[CRASH_RECORD_TRACE_EVENTS];
+};
+
+// What ends up on FFat: the breadcrumb as it was at the crash, plus what only the
+// next boot can know (reset reason, core dump summary).
+struct StoredRecord {
+    uint32_t magic;
+    uint16_t version;
+    uint16_t size;                // sizeof(StoredRecord); layout changes invalidate old files
+    int32_t reset_reason;         // esp_reset_reason_t
+    uint8_t crumb_valid;
+    uint8_t coredump_present;
+    uint8_t backtrace_depth;
+    uint8_t backtrace_corrupted;
+    char exc_task[16];
+    uint32_t exc_pc;
+    uint32_t backtrace[kBacktraceMax];
+    Breadcrumb crumb;
+};
+
+RTC_NOINIT_ATTR static Breadcrumb s_crumb;
+
+// Written in setup(); read and dropped by the async_tcp task.
+static StoredRecord* g_record = nullptr;
+static volatile bool g_remove_pending = false;
+static bool g_fs_mounted = false;
+static bool (*g_auth_gate)(AsyncWebServerRequest* request) = nullptr;
+
+static uint32_t crumb_crc() {
+    const size_t start = offsetof(Breadcrumb, crc) + sizeof(s_crumb.crc);
+    return esp_rom_crc32_le(0, (const uint8_t*)&s_crumb + start, sizeof(Breadcrumb) - start);
+}
+
+static bool crumb_valid() {
+    return s_crumb.magic == kCrumbMagic && s_crumb.trace_count <= CRASH_RECORD_TRACE_EVENTS && s_crumb.crc == crumb_crc();
+}
+
+static void crumb_reset() {
+    memset(&s_crumb, 0, sizeof(s_crumb));
+    s_crumb.magic = kCrumbMagic;
+    strlcpy(s_crumb.firmware, FIRMWARE_VERSION, sizeof(s_crumb.firmware));
+    s_crumb.display_fps = 0xFFFF;
+    s_crumb.crc = crumb_crc();
+}
+
+static bool is_crash(esp_reset_reason_t reason) {
+    switch (reason) {
+        case ESP_RST_PANIC:
+        case ESP_RST_INT_WDT:
+        case ESP_RST_TASK_WDT:
+        case ESP_RST_WDT:
+        case ESP_RST_BROWNOUT:
+            return true;
+        default:
+            return false;
+    }
+}
+
+// Same strings as /api/health reset_reason.
+static const char* reset_reason_name(int32_t reason) {
+    switch ((esp_reset_reason_t)reason) {
+        case ESP_RST_PANIC:     return "Panic";
+        case ESP_RST_INT_WDT:   return "Interrupt WDT";
+        case ESP_RST_TASK_WDT:  return "Task WDT";
+        case ESP_RST_WDT:       return "WDT";
+        case ESP_RST_BROWNOUT:  return "Brownout";
+        default:                return "Unknown";
+    }
+}
+
+static bool mount_fs() {
+    if (g_fs_mounted) return true;
+    FSHealthStats fs;
+    fs_health_get(&fs);
+    if (!fs.ffat_partition_present) return false;
+    // Never format implicitly: the partition may hold data from other features.
+    if (!FFat.begin(false)) {
+        LOGW("Crash", "FFat mount failed; crash record not persisted");
+        return false;
+    }
+    g_fs_mounted = true;
+    fs_health_set_ffat_usage((uint32_t)FFat.usedBytes(), (uint32_t)FFat.totalBytes());
+    return true;
+}
+
+static void harvest_coredump(StoredRecord* rec, esp_reset_reason_t reason) {
+    #if CRASH_RECORD_HAS_COREDUMP
+    // Brownouts do not write a core dump; an image found then belongs to an older crash.
+    if (reason == ESP_RST_BROWNOUT) return;
+
+    size_t addr = 0;
+    size_t size = 0;
+    if (esp_core_dump_image_get(&addr, &size) != ESP_OK) return;
+
+    esp_core_dump_summary_t summary;
+    if (esp_core_dump_get_summary(&summary) == ESP_OK) {
+        rec->coredump_present = 1;
+        strlcpy(rec->exc_task, summary.exc_task, sizeof(rec->exc_task));
+        rec->exc_pc = summary.exc_pc;
+        #if CONFIG_IDF_TARGET_ARCH_XTENSA
+        const uint32_t depth = summary.exc_bt_info.depth < kBacktraceMax ? summary.exc_bt_info.depth : kBacktraceMax;
+        for (uint32_t i = 0; i < depth; i++) rec->backtrace[i] = summary.exc_bt_info.bt[i];
+        rec->backtrace_depth = (uint8_t)depth;
+        rec->backtrace_corrupted = summary.exc_bt_info.corrupted ? 1 : 0;
+        #endif
+    }
+
+    #if CRASH_RECORD_ERASE_COREDUMP && ESP_IDF_VERSION >= ESP_IDF_VERSION_VAL(5, 0, 0)
+    esp_core_dump_image_erase();
+    #endif
+    #else
+    (void)rec;
+    (void)reason;
+    #endif
+}
+
+static void save_record(const StoredRecord* rec) {
+    if (!mount_fs()) return;
+    if (!FFat.exists(kDir)) FFat.mkdir(kDir);
+
+    File f = FFat.open(kTmpPath, FILE_WRITE);
+    if (!f) {
+        LOGW("Crash", "Cannot create %s", kTmpPath);
+        return;
+    }
+    const bool ok = f.write((const uint8_t*)rec, sizeof(*rec)) == sizeof(*rec);
+    f.close();
+    // Rename last, so a reset mid-write keeps the previous record intact.
+    if (!ok || (FFat.exists(kPath) && !FFat.remove(kPath)) || !FFat.rename(kTmpPath, kPath)) {
+        FFat.remove(kTmpPath);
+        LOGW("Crash", "Crash record write failed");
+    }
+}
+
+static StoredRecord* load_record() {
+    if (!mount_fs() || !FFat.exists(kPath)) return nullptr;
+
+    File f = FFat.open(kPath, FILE_READ);
+    if (!f) return nullptr;
+    StoredRecord* rec = nullptr;
+    if (f.size() == sizeof(StoredRecord)) {
+        rec = (StoredRecord*)app_alloc(AllocTag::Other, sizeof(StoredRecord), AllocPolicy::PreferPsram);
+        if (rec && (f.read((uint8_t*)rec, sizeof(*rec)) != sizeof(*rec) || rec->magic != kRecordMagic ||
+                    rec->version != kRecordVersion || rec->size != sizeof(StoredRecord))) {
+            app_free(AllocTag::Other, rec);
+            rec = nullptr;
+        }
+    }
+    f.close();
+    return rec;
+}
+
+static void take_snapshot(uint32_t now_ms) {
+    const DeviceMemorySnapshot mem = device_telemetry_get_memory_snapshot();
+    s_crumb.uptime_ms = now_ms;
+    s_crumb.snapshots++;
+    s_crumb.heap_internal_free = (uint32_t)mem.heap_internal_free_bytes;
+    s_crumb.heap_internal_min = (uint32_t)mem.heap_internal_min_free_bytes;
+    s_crumb.heap_largest = (uint32_t)mem.heap_largest_free_block_bytes;
+    s_crumb.psram_free = (uint32_t)mem.psram_free_bytes;
+    s_crumb.psram_min = (uint32_t)mem.psram_min_free_bytes;
+    s_crumb.psram_largest = (uint32_t)mem.psram_largest_free_block_bytes;
+
+    for (size_t t = 0; t < kTagCount; t++) {
+        AllocTagStats st;
+        app_alloc_get_stats((AllocTag)t, &st);
+        s_crumb.alloc[t].live = st.live_bytes;
+        s_crumb.alloc[t].peak = st.peak_bytes;
+        s_crumb.alloc[t].failed = st.failed;
+    }
+
+    #if HAS_DISPLAY
+    DisplayPerfStats perf;
+    if (displayManager && display_manager_get_perf_stats(&perf)) {
+        s_crumb.display_fps = perf.fps;
+        s_crumb.display_lv_timer_us = perf.lv_timer_us;
+        s_crumb.display_flush_p95_us = perf.flush_dist_us.p95;
+        s_crumb.display_present_us = perf.present_us;
+    }
+    #endif
+
+    #if HAS_MQTT
+    MqttOutboundStats out = {};
+    mqtt_manager.getOutboundStats(&out);
+    s_crumb.mqtt_outbound_depth = out.depth;
+    s_crumb.mqtt_outbound_high_water = out.high_water;
+    s_crumb.mqtt_outbound_dropped = out.dropped_full + out.dropped_oversize + out.send_failed;
+    #endif
+
+    #if HAS_IMAGE_API
+    ImageArenaStats ia;
+    image_arena_get_stats(&ia);
+    s_crumb.image_arena_used = ia.used;
+    s_crumb.image_arena_peak = ia.peak;
+    #endif
+
+    #if TRACE_RING_SUPPORTED
+    s_crumb.trace_count = (uint32_t)trace_ring_copy_recent(s_crumb.trace, CRASH_RECORD_TRACE_EVENTS);
+    #endif
+
+    s_crumb.crc = crumb_crc();
+}
+
+static void fill_json(JsonDocument& doc, const StoredRecord* rec) {
+    const Breadcrumb& c = rec->crumb;
+    doc["reset_reason"] = reset_reason_name(rec->reset_reason);
+
+    if (rec->coredump_present) {
+        JsonObject cd = doc.createNestedObject("coredump");
+        char hex[12];
+        cd["task"] = rec->exc_task;
+        snprintf(hex, sizeof(hex), "0x%08lx", (unsigned long)rec->exc_pc);
+        cd["pc"] = hex;
+        JsonArray bt = cd.createNestedArray("backtrace");
+        for (uint8_t i = 0; i < rec->backtrace_depth && i < kBacktraceMax; i++) {
+            snprintf(hex, sizeof(hex), "0x%08lx", (unsigned long)rec->backtrace[i]);
+            bt.add(hex);
+        }
+        cd["backtrace_corrupted"] = rec->backtrace_corrupted ? true : false;
+    } else {
+        doc["coredump"] = nullptr;
+    }
+
+    if (!rec->crumb_valid) {
+        doc["snapshot"] = nullptr;
+        return;
+    }
+
+    JsonObject snap = doc.createNestedObject("snapshot");
+    snap["firmware"] = c.firmware;
+    snap["uptime_ms"] = c.uptime_ms;
+    snap["snapshots"] = c.snapshots;
+
+    JsonObject heap = snap.createNestedObject("heap");
+    heap["internal_free"] = c.heap_internal_free;
+    heap["internal_min"] = c.heap_internal_min;
+    heap["largest"] = c.heap_largest;
+    heap["psram_free"] = c.psram_free;
+    heap["psram_min"] = c.psram_min;
+    heap["psram_largest"] = c.psram_largest;
+
+    JsonObject alloc = snap.createNestedObject("alloc");
+    for (size_t t = 0; t < kTagCount; t++) {
+        JsonObject a = alloc.createNestedObject(app_alloc_tag_name((AllocTag)t));
+        a["live"] = c.alloc[t].live;
+        a["peak"] = c.alloc[t].peak;
+        a["failed"] = c.alloc[t].failed;
+    }
+
+    JsonObject perf = snap.createNestedObject("perf");
+    if (c.display_fps != 0xFFFF) {
+        perf["display_fps"] = c.display_fps;
+        perf["display_lv_timer_us"] = c.display_lv_timer_us;
+        perf["display_flush_p95_us"] = c.display_flush_p95_us;
+        perf["display_present_us"] = c.display_present_us;
+    } else {
+        perf["display_fps"] = nullptr;
+    }
+    perf["mqtt_outbound_depth"] = c.mqtt_outbound_depth;
+    perf["mqtt_outbound_high_water"] = c.mqtt_outbound_high_water;
+    perf["mqtt_outbound_dropped"] = c.mqtt_outbound_dropped;
+    perf["image_arena_used"] = c.image_arena_used;
+    perf["image_arena_peak"] = c.image_arena_peak;
+
+    if (c.tripwire_uptime_ms != 0) {
+        JsonObject tw = snap.createNestedObject("tripwire");
+        tw["uptime_ms"] = c.tripwire_uptime_ms;
+        tw["internal_min"] = c.tripwire_internal_min;
+    } else {
+        snap["tripwire"] = nullptr;
+    }
+
+    #if TRACE_RING_SUPPORTED
+    // Timestamps relative to the newest event (negative = earlier).
+    JsonArray trace = snap.createNestedArray("trace");
+    const uint32_t n = c.trace_count <= CRASH_RECORD_TRACE_EVENTS ? c.trace_count : 0;
+    const uint32_t newest = n ? c.trace[n - 1].ts_us : 0;
+    for (uint32_t i = 0; i < n; i++) {
+        const TraceRecentEvent& e = c.trace[i];
+        JsonObject o = trace.createNestedObject();
+        o["t_us"] = -(int32_t)(uint32_t)(newest - e.ts_us);
+        o["event"] = trace_event_name(e.ev);
+        char ph[2] = {(char)e.phase, '\0'};
+        o["ph"] = ph;
+        o["task"] = e.task;
+        o["core"] = e.core;
+    }
+    #endif
+}
+
+static void handleLastCrashGet(AsyncWebServerRequest* request) {
+    if (g_auth_gate && !g_auth_gate(request)) return;
+    const StoredRecord* rec = g_record;
+    if (!rec) {
+        web_portal_send_json_error(request, 404, "No crash recorded");
+        return;
+    }
+
+    auto doc = make_psram_json_doc(4096);
+    if (doc && doc->capacity() > 0) fill_json(*doc, rec);
+    web_portal_send_json_chunked(request, doc);
+}
+
+static void handleLastCrashDelete(AsyncWebServerRequest* request) {
+    if (g_auth_gate && !g_auth_gate(request)) return;
+    StoredRecord* rec = g_record;
+    g_record = nullptr;
+    if (rec) app_free(AllocTag::Other, rec);
+    // The file is removed from loop(), which owns the FFat writes of this module.
+    g_remove_pending = true;
+    request->send(200, "application/json", "{\"success\":true}");
+}
+
+} // namespace
+
+void crash_record_init() {
+    const esp_reset_reason_t reason = esp_reset_reason();
+
+    if (is_crash(reason)) {
+        StoredRecord* rec = (StoredRecord*)app_alloc(AllocTag::Other, sizeof(StoredRecord), AllocPolicy::PreferPsram);
+        if (rec) {
+            memset(rec, 0, sizeof(*rec));
+            rec->magic = kRecordMagic;
+            rec->version = kRecordVersion;
+            rec->size = (uint16_t)sizeof(StoredRecord);
+            rec->reset_reason = (int32_t)reason;
+            if (crumb_valid()) {
+                rec->crumb_valid = 1;
+                rec->crumb = s_crumb;
+            }
+            harvest_coredump(rec, reason);
+            save_record(rec);
+            g_record = rec;
+            LOGW("Crash", "Previous boot ended with %s (task %s, last snapshot at %lus)",
+                reset_reason_name(rec->reset_reason), rec->coredump_present ? rec->exc_task : "?",
+                (unsigned long)(rec->crumb_valid ? rec->crumb.uptime_ms / 1000U : 0));
+        }
+    } else {
+        g_record = load_record();
+        if (g_record) LOGI("Crash", "Crash record on flash (%s)", reset_reason_name(g_record->reset_reason));
+    }
+
+    crumb_reset();
+}
+
+void crash_record_snapshot(uint32_t now_ms) {
+    if (g_remove_pending) {
+        g_remove_pending = false;
+        if (mount_fs()) FFat.remove(kPath);
+    }
+    take_snapshot(now_ms);
+}
+
+void crash_record_note_tripwire(uint32_t internal_min_bytes) {
+    const uint32_t now = millis();
+    s_crumb.tripwire_uptime_ms = now ? now : 1;
+    s_crumb.tripwire_internal_min = internal_min_bytes;
+    take_snapshot(now);
+}
+
+bool crash_record_available() {
+    return g_record != nullptr;
+}
+
+void crash_record_register_routes(AsyncWebServer* server, bool (*auth_gate)(AsyncWebServerRequest* request)) {
+    g_auth_gate = auth_gate;
+    server->on("/api/diagnostics/last_crash", HTTP_GET, handleLastCrashGet);
+    server->on("/api/diagnostics/last_crash", HTTP_DELETE, handleLastCrashDelete);
+}
+
+#endif // CRASH_RECORD_SUPPORTED
@@ -0,0 +1,55 @@
+/*
+ * Crash Record (/api/diagnostics/last_crash)
+ *
+ * reset_reason alone cannot tell a heap drain under image load from a logic bug.
+ * loop() periodically writes a breadcrumb to RTC slow memory (survives panics and
+ * watchdog resets): internal/PSRAM heap, app_alloc per-tag live/peak/failed, display
+ * fps and flush/lv_timer times, MQTT outbound queue depth, image arena use, the
+ * memory tripwire state and the newest trace ring events (strip decodes, LVGL lock
+ * waits, HTTP handlers ... with timestamps).
+ *
+ * On the boot after a panic, watchdog or brownout reset, crash_record_init() merges
+ * the breadcrumb with the flash core dump summary (crashed task, PC, backtrace;
+ * when the core dump is enabled in ELF format) and writes one binary record to
+ * FFat. Any later boot loads that file once, so requests only serialize a struct.
+ * The record is replaced by the next crash or removed with DELETE.
+ *
+ * Endpoints:
+ *   GET    /api/diagnostics/last_crash   - Last crash record as JSON (404 when none)
+ *   DELETE /api/diagnostics/last_crash   - Forget it
+ */
+
+#pragma once
+
+#include "board_config.h"
+
+#if CRASH_RECORD_ENABLED
+
+#define CRASH_RECORD_SUPPORTED 1
+
+#include <stdint.h>
+
+class AsyncWebServer;
+class AsyncWebServerRequest;
+
+// Harvest the previous boot's breadcrumb / core dump and load the stored record.
+// Call once from setup() after log_init() and before the first snapshot.
+void crash_record_init();
+
+// Refresh the RTC breadcrumb (call from the main loop every CRASH_RECORD_SNAPSHOT_MS).
+void crash_record_snapshot(uint32_t now_ms);
+
+// The low-memory tripwire fired: remember it and snapshot right away (main loop).
+void crash_record_note_tripwire(uint32_t internal_min_bytes);
+
+// True when a crash record is loaded (GET returns 200).
+bool crash_record_available();
+
+// auth_gate: same contract as image_api_register_routes().
+void crash_record_register_routes(AsyncWebServer* server, bool (*auth_gate)(AsyncWebServerRequest* request) = nullptr);
+
+#else
+
+#define CRASH_RECORD_SUPPORTED 0
+
+#endif
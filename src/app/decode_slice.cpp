@@ -0,0 +1,68 @@
+#include "decode_slice.h"
+
+#if HAS_IMAGE_API
+
+#include <freertos/FreeRTOS.h>
+#include <freertos/task.h>
+
+static DecodeSliceStats s_stats = {};
+static portMUX_TYPE s_stats_mux = portMUX_INITIALIZER_UNLOCKED;
+
+DecodeSlicer::DecodeSlicer() {
+    start_us = esp_timer_get_time();
+    slice_start_us = start_us;
+
+    portENTER_CRITICAL(&s_stats_mux);
+    s_stats.active = true;
+    s_stats.last_decode_us = 0;
+    s_stats.last_slices = 0;
+    s_stats.last_rows = 0;
+    portEXIT_CRITICAL(&s_stats_mux);
+}
+
+DecodeSlicer::~DecodeSlicer() {
+    const uint32_t total_us = (uint32_t)(esp_timer_get_time() - start_us);
+
+    portENTER_CRITICAL(&s_stats_mux);
+    s_stats.decodes++;
+    s_stats.active = false;
+    s_stats.last_decode_us = total_us;
+    s_stats.last_slices = slices;
+    s_stats.last_rows = rows;
+    portEXIT_CRITICAL(&s_stats_mux);
+}
+
+void DecodeSlicer::endSlice() {
+    const int64_t before = esp_timer_get_time();
+    const uint32_t slice_us = (uint32_t)(before - slice_start_us);
+
+    #if CONFIG_FREERTOS_UNICORE
+    vTaskDelay(1);
+    #else
+    taskYIELD();
+    #endif
+
+    const int64_t after = esp_timer_get_time();
+    const uint32_t away_us = (uint32_t)(after - before);
+    slice_start_us = after;
+    slices++;
+
+    portENTER_CRITICAL(&s_stats_mux);
+    s_stats.slices++;
+    if (slice_us >= 2u * (uint32_t)IMAGE_DECODE_SLICE_US) s_stats.starved++;
+    if (slice_us > s_stats.max_slice_us) s_stats.max_slice_us = slice_us;
+    s_stats.yield_us += away_us;
+    s_stats.last_decode_us = (uint32_t)(after - start_us);
+    s_stats.last_slices = slices;
+    s_stats.last_rows = rows;
+    portEXIT_CRITICAL(&s_stats_mux);
+}
+
+void decode_slice_get_stats(DecodeSliceStats* out) {
+    if (!out) return;
+    portENTER_CRITICAL(&s_stats_mux);
+    *out = s_stats;
+    portEXIT_CRITICAL(&s_stats_mux);
+}
+
+#endif // HAS_IMAGE_API
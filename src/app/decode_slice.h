@@ -0,0 +1,66 @@
+#pragma once
+
+#include "board_config.h"
+
+#if HAS_IMAGE_API
+
+#include <esp_timer.h>
+#include <stdint.h>
+
+// Time-budgeted yielding for long JPEG decodes.
+//
+// TJpgDec (ROM) decodes a whole JPEG in one jd_decomp() call, so the decoders cannot
+// return to the loop mid-image; what they can do is give the CPU away at their output
+// callbacks. Instead of a fixed row stride (every 4th or 8th row, regardless of how long
+// those rows took), a DecodeSlicer ends a slice once IMAGE_DECODE_SLICE_US of CPU time
+// has passed since the last yield. On single-core targets the slice ends with a one-tick
+// vTaskDelay(), so lower-priority tasks (IDLE feeding the watchdog, network stacks) get
+// to run; with a second core taskYIELD() is enough.
+//
+// A slice that overran the budget by 2x means one callback (an MCU row plus its panel
+// write) was longer than the budget itself; those are counted as starvation events.
+//
+// One DecodeSlicer per decode call, on the decoding task's stack. The stats are global
+// and safe to read from any task.
+
+struct DecodeSliceStats {
+    uint32_t decodes;         // decode calls completed
+    uint32_t slices;          // slices ended with a yield (all decodes)
+    uint32_t starved;         // slices longer than 2x the budget
+    uint32_t max_slice_us;    // longest slice since boot
+    uint32_t yield_us;        // time given to other tasks (all decodes)
+    // Newest decode (the current one while `active`).
+    bool active;
+    uint32_t last_decode_us;
+    uint32_t last_slices;
+    uint32_t last_rows;       // output rows reported so far (progress)
+};
+
+class DecodeSlicer {
+public:
+    DecodeSlicer();
+    ~DecodeSlicer();
+
+    // Call between units of decode work; yields once the slice budget is used up.
+    inline void checkpoint(uint32_t rows_done = 0) {
+        rows += rows_done;
+        if ((uint32_t)(esp_timer_get_time() - slice_start_us) >= (uint32_t)IMAGE_DECODE_SLICE_US) {
+            endSlice();
+        }
+    }
+
+    // Slices ended (yields) so far in this decode call.
+    uint32_t sliceCount() const { return slices; }
+
+private:
+    void endSlice();
+
+    int64_t start_us;
+    int64_t slice_start_us;
+    uint32_t slices = 0;
+    uint32_t rows = 0;
+};
+
+void decode_slice_get_stats(DecodeSliceStats* out);
+
+#endif // HAS_IMAGE_API
@@ -0,0 +1,538 @@
+#include "device_bench.h"
+
+#if DEVICE_BENCH_SUPPORTED
+
+#include "device_bench_jpeg.h"
+#include "device_telemetry.h"
+#include "energy_thresholds.h"
+#include "json_path_extract.h"
+#include "log_manager.h"
+#include "web_portal_json.h"
+#include "../version.h"
+
+#if HAS_DISPLAY
+#include "display_manager.h"
+#include "display_driver.h"
+#include <lvgl.h>
+#endif
+#if HAS_IMAGE_API
+#include "jpeg_preflight.h"
+#include "rgb565_convert.h"
+#endif
+#if HAS_DISPLAY && HAS_IMAGE_API
+#include "strip_decoder.h"
+#endif
+
+#include <Arduino.h>
+#include <ArduinoJson.h>
+#include <ESPAsyncWebServer.h>
+#include <Preferences.h>
+#include <esp_heap_caps.h>
+#include <esp_timer.h>
+#include <freertos/FreeRTOS.h>
+#include <freertos/portmacro.h>
+#include <string.h>
+
+namespace {
+
+enum class BenchStep : uint8_t {
+    Idle = 0,
+    Memcpy,
+    Rgb565,
+    Json,
+    Kernels,
+    Nvs,
+    Display,
+    Jpeg,
+    Done,
+};
+
+// 0 = not measured on this build/board (reported as null).
+struct BenchResults {
+    uint32_t memcpy_internal_kbps;
+    uint32_t memcpy_psram_kbps;
+    uint32_t memcpy_psram_to_internal_kbps;
+    uint32_t memcpy_internal_to_psram_kbps;
+
+    uint32_t rgb565_kpx_per_s;
+
+    uint32_t json_fill_us;
+    uint32_t json_serialize_us;
+    uint32_t json_bytes;
+
+    uint32_t mqtt_extract_ns;
+    uint32_t jpeg_preflight_ns;
+    uint32_t classify_ns;
+
+    uint32_t nvs_write_us;
+    uint32_t nvs_read_us;
+
+    uint32_t display_frame_us;
+    uint32_t display_kbps;
+    uint16_t display_width;
+    uint16_t display_height;
+
+    uint32_t jpeg_decode_us;
+    uint32_t jpeg_kpx_per_s;
+
+    uint32_t duration_ms;
+    uint32_t finished_uptime_ms;
+};
+
+static bool (*g_auth_gate)(AsyncWebServerRequest* request) = nullptr;
+
+static portMUX_TYPE s_mux = portMUX_INITIALIZER_UNLOCKED;
+static bool s_start_requested = false;
+static BenchStep s_step = BenchStep::Idle;   // under s_mux (read by GET)
+static uint32_t s_runs = 0;
+static BenchResults s_results = {};          // last completed run (under s_mux)
+static bool s_have_results = false;
+
+// Main-loop only.
+static BenchResults s_work = {};
+static uint32_t s_run_start_ms = 0;
+
+static constexpr size_t kMemcpyBytes = 16 * 1024;
+static constexpr int kMemcpyRounds = 32;
+static constexpr int kRgb565Pixels = 320 * 16;
+static constexpr int kRgb565Rounds = 32;
+static constexpr int kJsonRounds = 4;
+static constexpr size_t kJsonCapacity = kDeviceTelemetryApiDocCapacity;
+static constexpr int kKernelRounds = 1000;
+static constexpr int kNvsRounds = 8;
+static constexpr size_t kNvsBlobBytes = 64;
+static constexpr int kDisplayFrames = 4;
+static constexpr int kDisplayBandRows = 16;
+static constexpr int kJpegRounds = 8;
+
+static inline uint32_t elapsed_us(int64_t t0) {
+    return (uint32_t)(esp_timer_get_time() - t0);
+}
+
+static inline uint32_t kbps(uint64_t bytes, uint32_t us) {
+    return us ? (uint32_t)((bytes * 1000ULL) / us) : 0;  // bytes/us * 1000 = KB/s (1000-based)
+}
+
+static uint32_t time_memcpy(uint8_t* dst, const uint8_t* src) {
+    memcpy(dst, src, kMemcpyBytes);  // warm caches
+    const int64_t t0 = esp_timer_get_time();
+    for (int r = 0; r < kMemcpyRounds; r++) {
+        memcpy(dst, src, kMemcpyBytes);
+    }
+    return kbps((uint64_t)kMemcpyBytes * kMemcpyRounds, elapsed_us(t0));
+}
+
+static void bench_memcpy(BenchResults* out) {
+    const uint32_t internal_caps = MALLOC_CAP_INTERNAL | MALLOC_CAP_8BIT;
+    const uint32_t psram_caps = MALLOC_CAP_SPIRAM | MALLOC_CAP_8BIT;
+
+    uint8_t* in_a = (uint8_t*)heap_caps_malloc(kMemcpyBytes, internal_caps);
+    uint8_t* in_b = (uint8_t*)heap_caps_malloc(kMemcpyBytes, internal_caps);
+    uint8_t* ps_a = psramFound() ? (uint8_t*)heap_caps_malloc(kMemcpyBytes, psram_caps) : nullptr;
+    uint8_t* ps_b = psramFound() ? (uint8_t*)heap_caps_malloc(kMemcpyBytes, psram_caps) : nullptr;
+    if (in_a) memset(in_a, 0x5A, kMemcpyBytes);
+    if (ps_a) memset(ps_a, 0xA5, kMemcpyBytes);
+
+    if (in_a && in_b) out->memcpy_internal_kbps = time_memcpy(in_b, in_a);
+    if (ps_a && ps_b) out->memcpy_psram_kbps = time_memcpy(ps_b, ps_a);
+    if (ps_a && in_b) out->memcpy_psram_to_internal_kbps = time_memcpy(in_b, ps_a);
+    if (in_a && ps_b) out->memcpy_internal_to_psram_kbps = time_memcpy(ps_b, in_a);
+
+    heap_caps_free(in_a);
+    heap_caps_free(in_b);
+    heap_caps_free(ps_a);
+    heap_caps_free(ps_b);
+}
+
+static void bench_rgb565(BenchResults* out) {
+    #if HAS_IMAGE_API
+    // Same band shape as rgb565_convert_benchmark_log() (one TJpgDec output batch).
+    uint8_t* src = (uint8_t*)heap_caps_malloc((size_t)kRgb565Pixels * 3, MALLOC_CAP_INTERNAL | MALLOC_CAP_8BIT);
+    uint16_t* dst = (uint16_t*)heap_caps_malloc((size_t)kRgb565Pixels * sizeof(uint16_t), MALLOC_CAP_INTERNAL | MALLOC_CAP_8BIT);
+    if (src && dst) {
+        for (int i = 0; i < kRgb565Pixels * 3; i++) src[i] = (uint8_t)(i * 37);
+        const Rgb565ConvertFn fn = rgb565_select_convert(false, true);
+        fn(src, dst, kRgb565Pixels);
+        const int64_t t0 = esp_timer_get_time();
+        for (int r = 0; r < kRgb565Rounds; r++) {
+            fn(src, dst, kRgb565Pixels);
+        }
+        const uint32_t us = elapsed_us(t0);
+        out->rgb565_kpx_per_s = us ? (uint32_t)(((uint64_t)kRgb565Pixels * kRgb565Rounds * 1000ULL) / us) : 0;
+    }
+    heap_caps_free(src);
+    heap_caps_free(dst);
+    #else
+    (void)out;
+    #endif
+}
+
+static void bench_json(BenchResults* out) {
+    char* buf = nullptr;
+    if (psramFound()) buf = (char*)heap_caps_malloc(kJsonCapacity, MALLOC_CAP_SPIRAM | MALLOC_CAP_8BIT);
+    if (!buf) buf = (char*)heap_caps_malloc(kJsonCapacity, MALLOC_CAP_INTERNAL | MALLOC_CAP_8BIT);
+    if (!buf) return;
+
+    uint64_t fill_us = 0;
+    uint64_t ser_us = 0;
+    size_t bytes = 0;
+    int rounds = 0;
+    for (int r = 0; r < kJsonRounds; r++) {
+        std::shared_ptr<BasicJsonDocument<PsramJsonAllocator>> doc = make_psram_json_doc(kJsonCapacity);
+        if (!doc || doc->capacity() == 0) break;
+
+        int64_t t0 = esp_timer_get_time();
+        device_telemetry_fill_api(*doc);
+        fill_us += elapsed_us(t0);
+
+        t0 = esp_timer_get_time();
+        bytes = serializeJson(*doc, buf, kJsonCapacity);
+        ser_us += elapsed_us(t0);
+        rounds++;
+    }
+    heap_caps_free(buf);
+    if (rounds == 0) return;
+
+    out->json_fill_us = (uint32_t)(fill_us / rounds);
+    out->json_serialize_us = (uint32_t)(ser_us / rounds);
+    out->json_bytes = (uint32_t)bytes;
+}
+
+static inline uint32_t ns_per_call(uint32_t us, int calls) {
+    return calls ? (uint32_t)(((uint64_t)us * 1000ULL) / calls) : 0;
+}
+
+// Platform-light hot paths with no I/O: per-call cost in ns.
+static void bench_kernels(BenchResults* out) {
+    // Nested payload shaped like the energy topics, value near the end of the path.
+    static const char kPayload[] =
+        "{\"device\":\"inverter\",\"ts\":1718000000,\"data\":{\"power\":"
+        "[{\"id\":\"solar\",\"value\":2.345,\"unit\":\"kW\"},{\"id\":\"grid\",\"value\":-0.812,\"unit\":\"kW\"}]}}";
+    volatile double sink = 0.0;
+    double v = 0.0;
+    int64_t t0 = esp_timer_get_time();
+    for (int r = 0; r < kKernelRounds; r++) {
+        if (json_path_extract_number(kPayload, sizeof(kPayload) - 1, "data.power[1].value", &v)) sink = v;
+    }
+    out->mqtt_extract_ns = ns_per_call(elapsed_us(t0), kKernelRounds);
+
+    #if HAS_IMAGE_API
+    char err[96];
+    bool ok = true;
+    t0 = esp_timer_get_time();
+    for (int r = 0; r < kKernelRounds && ok; r++) {
+        ok = jpeg_preflight_tjpgd_supported(kDeviceBenchJpeg, sizeof(kDeviceBenchJpeg),
+                                            kDeviceBenchJpegWidth, kDeviceBenchJpegHeight, err, sizeof(err));
+    }
+    if (ok) out->jpeg_preflight_ns = ns_per_call(elapsed_us(t0), kKernelRounds);
+    #endif
+
+    // Sweep -5..+5 kW through every category so all tiers and the hysteresis path run.
+    const EnergyRuleSet* rules = energy_thresholds_get();
+    bool alarm = false;
+    int calls = 0;
+    t0 = esp_timer_get_time();
+    for (int r = 0; r < kKernelRounds; r++) {
+        const float kw = (float)((r % 101) - 50) * 0.1f;
+        for (size_t c = 0; c < (size_t)EnergyCategory::Count; c++) {
+            alarm = energy_thresholds_classify(rules->category[c], kw, alarm).alarm;
+            calls++;
+        }
+    }
+    out->classify_ns = ns_per_call(elapsed_us(t0), calls);
+    sink = sink + (alarm ? 1.0 : 0.0);
+}
+
+static void bench_nvs(BenchResults* out) {
+    Preferences prefs;
+    if (!prefs.begin("bench", false)) {
+        LOGW("Bench", "NVS namespace open failed");
+        return;
+    }
+
+    uint8_t blob[kNvsBlobBytes];
+    uint8_t back[kNvsBlobBytes];
+    uint64_t write_us = 0;
+    uint64_t read_us = 0;
+    for (int r = 0; r < kNvsRounds; r++) {
+        for (size_t i = 0; i < sizeof(blob); i++) blob[i] = (uint8_t)(i + r);  // force a real write
+
+        int64_t t0 = esp_timer_get_time();
+        prefs.putBytes("blob", blob, sizeof(blob));
+        write_us += elapsed_us(t0);
+
+        t0 = esp_timer_get_time();
+        prefs.getBytes("blob", back, sizeof(back));
+        read_us += elapsed_us(t0);
+    }
+    prefs.clear();
+    prefs.end();
+
+    out->nvs_write_us = (uint32_t)(write_us / kNvsRounds);
+    out->nvs_read_us = (uint32_t)(read_us / kNvsRounds);
+}
+
+#if HAS_DISPLAY
+// Redraw LVGL over the benchmark patterns (caller holds the display lock).
+static void invalidate_lvgl() {
+    lv_obj_t* scr = lv_scr_act();
+    if (scr) lv_obj_invalidate(scr);
+}
+#endif
+
+static void bench_display(BenchResults* out) {
+    #if HAS_DISPLAY
+    DisplayDriver* drv = displayManager ? displayManager->getDriver() : nullptr;
+    if (!drv) return;
+    const int w = drv->width();
+    const int h = drv->height();
+    if (w <= 0 || h <= 0) return;
+
+    uint16_t* band = (uint16_t*)heap_caps_malloc((size_t)w * kDisplayBandRows * sizeof(uint16_t), MALLOC_CAP_INTERNAL | MALLOC_CAP_8BIT);
+    if (!band) return;
+
+    // TestScreen palette as vertical bars; each frame shifts them so every frame
+    // really changes (buffered drivers cannot skip unchanged rows).
+    static const uint16_t kBars[] = {0xF800, 0x07E0, 0x001F, 0xFFE0, 0x07FF, 0xF81F, 0xFFFF, 0x0000};
+    static constexpr int kBarCount = sizeof(kBars) / sizeof(kBars[0]);
+
+    display_manager_lock(LvglLockSite::Bench);
+    const int64_t t0 = esp_timer_get_time();
+    for (int f = 0; f < kDisplayFrames; f++) {
+        for (int x = 0; x < w; x++) {
+            band[x] = kBars[((x * kBarCount) / w + f) % kBarCount];
+        }
+        for (int r = 1; r < kDisplayBandRows; r++) {
+            memcpy(band + (size_t)r * w, band, (size_t)w * sizeof(uint16_t));
+        }
+        for (int y = 0; y < h; y += kDisplayBandRows) {
+            const int rows = (h - y) < kDisplayBandRows ? (h - y) : kDisplayBandRows;
+            drv->startWrite();
+            drv->setAddrWindow(0, (int16_t)y, (uint16_t)w, (uint16_t)rows);
+            drv->pushColors(band, (uint32_t)w * rows, true);
+            drv->endWrite();
+        }
+        if (drv->renderMode() == DisplayDriver::RenderMode::Buffered) {
+            drv->present();
+        }
+    }
+    const uint32_t us = elapsed_us(t0);
+    invalidate_lvgl();
+    display_manager_unlock();
+    heap_caps_free(band);
+    display_manager_request_render();
+
+    out->display_frame_us = us / kDisplayFrames;
+    out->display_kbps = kbps((uint64_t)w * h * sizeof(uint16_t) * kDisplayFrames, us);
+    out->display_width = (uint16_t)w;
+    out->display_height = (uint16_t)h;
+    #else
+    (void)out;
+    #endif
+}
+
+static void bench_jpeg(BenchResults* out) {
+    #if HAS_DISPLAY && HAS_IMAGE_API
+    DisplayDriver* drv = displayManager ? displayManager->getDriver() : nullptr;
+    if (!drv) return;
+    const int w = drv->width();
+    const int h = drv->height();
+    if (w < kDeviceBenchJpegWidth || h < kDeviceBenchJpegHeight) return;
+    const int ox = (w - kDeviceBenchJpegWidth) / 2;
+    const int oy = (h - kDeviceBenchJpegHeight) / 2;
+
+    StripDecoder dec;
+    dec.setDisplayDriver(drv);
+
+    display_manager_lock(LvglLockSite::Bench);
+    // Warm-up decode (buffer allocation happens in the first begin()).
+    dec.begin(kDeviceBenchJpegWidth, kDeviceBenchJpegHeight, w, h, ox, oy);
+    bool ok = dec.decode_strip(kDeviceBenchJpeg, sizeof(kDeviceBenchJpeg), 0, false);
+    uint32_t us = 0;
+    if (ok) {
+        const int64_t t0 = esp_timer_get_time();
+        for (int r = 0; r < kJpegRounds && ok; r++) {
+            dec.begin(kDeviceBenchJpegWidth, kDeviceBenchJpegHeight, w, h, ox, oy);
+            ok = dec.decode_strip(kDeviceBenchJpeg, sizeof(kDeviceBenchJpeg), 0, false);
+        }
+        us = elapsed_us(t0);
+    }
+    if (drv->renderMode() == DisplayDriver::RenderMode::Buffered) {
+        drv->present();
+    }
+    dec.end();
+    invalidate_lvgl();
+    display_manager_unlock();
+    display_manager_request_render();
+
+    if (!ok) {
+        LOGW("Bench", "Test JPEG decode failed");
+        return;
+    }
+    out->jpeg_decode_us = us / kJpegRounds;
+    out->jpeg_kpx_per_s = us ? (uint32_t)(((uint64_t)kDeviceBenchJpegWidth * kDeviceBenchJpegHeight * kJpegRounds * 1000ULL) / us) : 0;
+    #else
+    (void)out;
+    #endif
+}
+
+static void set_step(BenchStep step) {
+    portENTER_CRITICAL(&s_mux);
+    s_step = step;
+    portEXIT_CRITICAL(&s_mux);
+}
+
+static void put_or_null(JsonDocument& doc, const char* key, uint32_t v) {
+    if (v) doc[key] = v;
+    else doc[key] = nullptr;
+}
+
+static void put_mb_s(JsonDocument& doc, const char* key, uint32_t kb_per_s) {
+    if (kb_per_s) doc[key] = (float)(kb_per_s / 10) / 100.0f;  // MB/s, 2 decimals
+    else doc[key] = nullptr;
+}
+
+static const char* step_name(BenchStep step) {
+    switch (step) {
+        case BenchStep::Idle: return "idle";
+        case BenchStep::Done: return "done";
+        default: return "running";
+    }
+}
+
+static void handleBenchGet(AsyncWebServerRequest* request) {
+    if (g_auth_gate && !g_auth_gate(request)) return;
+
+    BenchResults r;
+    bool have = false;
+    BenchStep step;
+    uint32_t runs = 0;
+    portENTER_CRITICAL(&s_mux);
+    r = s_results;
+    have = s_have_results;
+    step = s_step;
+    runs = s_runs;
+    portEXIT_CRITICAL(&s_mux);
+
+    std::shared_ptr<BasicJsonDocument<PsramJsonAllocator>> doc = make_psram_json_doc(1536);
+    if (doc && doc->capacity() > 0) {
+        JsonDocument& d = *doc;
+        d["status"] = step_name(step);
+        d["runs"] = runs;
+        d["version"] = FIRMWARE_VERSION;
+        #ifdef BUILD_BOARD_NAME
+        d["board_name"] = BUILD_BOARD_NAME;
+        #else
+        d["board_name"] = "unknown";
+        #endif
+        d["chip_model"] = ESP.getChipModel();
+        d["cpu_freq"] = ESP.getCpuFreqMHz();
+        d["psram"] = psramFound();
+
+        if (have) {
+            d["finished_uptime_ms"] = r.finished_uptime_ms;
+            d["duration_ms"] = r.duration_ms;
+            put_mb_s(d, "memcpy_internal_mb_s", r.memcpy_internal_kbps);
+            put_mb_s(d, "memcpy_psram_mb_s", r.memcpy_psram_kbps);
+            put_mb_s(d, "memcpy_psram_to_internal_mb_s", r.memcpy_psram_to_internal_kbps);
+            put_mb_s(d, "memcpy_internal_to_psram_mb_s", r.memcpy_internal_to_psram_kbps);
+            put_or_null(d, "rgb565_kpx_s", r.rgb565_kpx_per_s);
+            put_or_null(d, "json_fill_us", r.json_fill_us);
+            put_or_null(d, "json_serialize_us", r.json_serialize_us);
+            put_or_null(d, "json_bytes", r.json_bytes);
+            put_or_null(d, "mqtt_extract_ns", r.mqtt_extract_ns);
+            put_or_null(d, "jpeg_preflight_ns", r.jpeg_preflight_ns);
+            put_or_null(d, "classify_ns", r.classify_ns);
+            put_or_null(d, "nvs_write_us", r.nvs_write_us);
+            put_or_null(d, "nvs_read_us", r.nvs_read_us);
+            put_or_null(d, "display_frame_us", r.display_frame_us);
+            put_mb_s(d, "display_mb_s", r.display_kbps);
+            put_or_null(d, "display_width", r.display_width);
+            put_or_null(d, "display_height", r.display_height);
+            put_or_null(d, "jpeg_decode_us", r.jpeg_decode_us);
+            put_or_null(d, "jpeg_kpx_s", r.jpeg_kpx_per_s);
+        }
+    }
+    web_portal_send_json_chunked(request, doc);
+}
+
+static void handleBenchPost(AsyncWebServerRequest* request) {
+    if (g_auth_gate && !g_auth_gate(request)) return;
+
+    bool accepted = false;
+    portENTER_CRITICAL(&s_mux);
+    const bool running = s_start_requested || (s_step != BenchStep::Idle && s_step != BenchStep::Done);
+    if (!running) {
+        s_start_requested = true;
+        accepted = true;
+    }
+    portEXIT_CRITICAL(&s_mux);
+
+    if (!accepted) {
+        request->send(409, "application/json", "{\"success\":false,\"message\":\"Benchmark already running\"}");
+        return;
+    }
+    request->send(202, "application/json", "{\"success\":true,\"message\":\"Benchmark queued\"}");
+}
+
+} // namespace
+
+void device_bench_register_routes(AsyncWebServer* server, bool (*auth_gate)(AsyncWebServerRequest* request)) {
+    g_auth_gate = auth_gate;
+    server->on("/api/bench", HTTP_POST, handleBenchPost);
+    server->on("/api/bench", HTTP_GET, handleBenchGet);
+}
+
+void device_bench_loop(bool ota_in_progress) {
+    BenchStep step;
+    bool start = false;
+    portENTER_CRITICAL(&s_mux);
+    step = s_step;
+    if (s_start_requested && !ota_in_progress) {
+        start = true;
+        s_start_requested = false;
+    }
+    portEXIT_CRITICAL(&s_mux);
+
+    if (start) {
+        memset(&s_work, 0, sizeof(s_work));
+        s_run_start_ms = millis();
+        LOGI("Bench", "Benchmark started");
+        set_step(BenchStep::Memcpy);
+        return;
+    }
+    if (step == BenchStep::Idle || step == BenchStep::Done) return;
+
+    // OTA owns flash and the CPU; abandon the run (partial results are discarded).
+    if (ota_in_progress) {
+        LOGW("Bench", "Benchmark aborted (OTA)");
+        set_step(BenchStep::Idle);
+        return;
+    }
+
+    switch (step) {
+        case BenchStep::Memcpy:  bench_memcpy(&s_work);  set_step(BenchStep::Rgb565);  return;
+        case BenchStep::Rgb565:  bench_rgb565(&s_work);  set_step(BenchStep::Json);    return;
+        case BenchStep::Json:    bench_json(&s_work);    set_step(BenchStep::Kernels); return;
+        case BenchStep::Kernels: bench_kernels(&s_work); set_step(BenchStep::Nvs);     return;
+        case BenchStep::Nvs:     bench_nvs(&s_work);     set_step(BenchStep::Display); return;
+        case BenchStep::Display: bench_display(&s_work); set_step(BenchStep::Jpeg);    return;
+        case BenchStep::Jpeg:    bench_jpeg(&s_work);    break;
+        default: return;
+    }
+
+    const uint32_t now = millis();
+    s_work.duration_ms = now - s_run_start_ms;
+    s_work.finished_uptime_ms = now;
+    portENTER_CRITICAL(&s_mux);
+    s_results = s_work;
+    s_have_results = true;
+    s_runs++;
+    s_step = BenchStep::Done;
+    portEXIT_CRITICAL(&s_mux);
+
+    LOGI("Bench", "Benchmark done in %lu ms (display %lu us/frame, jpeg %lu us)",
+         (unsigned long)s_work.duration_ms, (unsigned long)s_work.display_frame_us, (unsigned long)s_work.jpeg_decode_us);
+}
+
+#endif // DEVICE_BENCH_SUPPORTED
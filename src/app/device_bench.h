@@ -0,0 +1,44 @@
+/*
+ * On-device Benchmark Suite
+ *
+ * Runs a fixed set of micro-benchmarks so firmware releases can be compared per
+ * board. Steps run one per main-loop pass (the loop stays responsive between them):
+ *
+ *   memcpy   internal/PSRAM copy bandwidth
+ *   rgb565   RGB888 -> RGB565 conversion kernel (HAS_IMAGE_API)
+ *   json     /api/health document fill + ArduinoJson serialization
+ *   kernels  MQTT JSON path extraction, JPEG preflight, threshold classification (ns/call)
+ *   nvs      Preferences blob write/read
+ *   display  full-screen fill + flush through the active DisplayDriver (HAS_DISPLAY)
+ *   jpeg     strip decode of a built-in test JPEG to the panel (HAS_DISPLAY && HAS_IMAGE_API)
+ *
+ * The display steps overwrite the panel with test patterns; LVGL screens are redrawn
+ * afterwards (a direct image has to be sent again).
+ *
+ * Endpoints:
+ *   POST /api/bench   - Start a run (409 while one is running or during OTA)
+ *   GET  /api/bench   - Status and the results of the last run
+ */
+
+#pragma once
+
+#include "board_config.h"
+
+#if DEVICE_BENCH_ENABLED
+
+#define DEVICE_BENCH_SUPPORTED 1
+
+class AsyncWebServer;
+class AsyncWebServerRequest;
+
+// auth_gate: same contract as image_api_register_routes().
+void device_bench_register_routes(AsyncWebServer* server, bool (*auth_gate)(AsyncWebServerRequest* request) = nullptr);
+
+// Run the next pending benchmark step (call from main loop).
+void device_bench_loop(bool ota_in_progress);
+
+#else
+
+#define DEVICE_BENCH_SUPPORTED 0
+
+#endif
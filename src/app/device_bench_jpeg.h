@@ -0,0 +1,84 @@
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+
+// Built-in benchmark image for /api/bench: 240x48 baseline JPEG (4:4:4, quality 80),
+// TestScreen-style color bars over a grey ramp. 240 px is the narrowest supported panel,
+// so every board decodes the same bytes.
+static const uint8_t kDeviceBenchJpeg[] = {
+    0xff, 0xd8, 0xff, 0xdb, 0x00, 0x43, 0x00, 0x06, 0x04, 0x04, 0x06, 0x0a, 0x10, 0x14, 0x18, 0x05,
+    0x05, 0x06, 0x08, 0x0a, 0x17, 0x18, 0x16, 0x06, 0x05, 0x06, 0x0a, 0x10, 0x17, 0x1c, 0x16, 0x06,
+    0x07, 0x09, 0x0c, 0x14, 0x23, 0x20, 0x19, 0x07, 0x09, 0x0f, 0x16, 0x1b, 0x2c, 0x29, 0x1f, 0x0a,
+    0x0e, 0x16, 0x1a, 0x20, 0x2a, 0x2d, 0x25, 0x14, 0x1a, 0x1f, 0x23, 0x29, 0x30, 0x30, 0x28, 0x1d,
+    0x25, 0x26, 0x27, 0x2d, 0x28, 0x29, 0x28, 0xff, 0xdb, 0x00, 0x43, 0x01, 0x07, 0x07, 0x0a, 0x13,
+    0x28, 0x28, 0x28, 0x28, 0x07, 0x08, 0x0a, 0x1a, 0x28, 0x28, 0x28, 0x28, 0x0a, 0x0a, 0x16, 0x28,
+    0x28, 0x28, 0x28, 0x28, 0x13, 0x1a, 0x28, 0x28, 0x28, 0x28, 0x28, 0x28, 0x28, 0x28, 0x28, 0x28,
+    0x28, 0x28, 0x28, 0x28, 0x28, 0x28, 0x28, 0x28, 0x28, 0x28, 0x28, 0x28, 0x28, 0x28, 0x28, 0x28,
+    0x28, 0x28, 0x28, 0x28, 0x28, 0x28, 0x28, 0x28, 0x28, 0x28, 0x28, 0x28, 0xff, 0xc0, 0x00, 0x11,
+    0x08, 0x00, 0x30, 0x00, 0xf0, 0x03, 0x01, 0x11, 0x00, 0x02, 0x11, 0x01, 0x03, 0x11, 0x01, 0xff,
+    0xc4, 0x00, 0x1f, 0x00, 0x00, 0x01, 0x05, 0x01, 0x01, 0x01, 0x01, 0x01, 0x01, 0x00, 0x00, 0x00,
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x01, 0x02, 0x03, 0x04, 0x05, 0x06, 0x07, 0x08, 0x09, 0x0a, 0x0b,
+    0xff, 0xc4, 0x00, 0xb5, 0x10, 0x00, 0x02, 0x01, 0x03, 0x03, 0x02, 0x04, 0x03, 0x05, 0x05, 0x04,
+    0x04, 0x00, 0x00, 0x01, 0x7d, 0x01, 0x02, 0x03, 0x00, 0x04, 0x11, 0x05, 0x12, 0x21, 0x31, 0x41,
+    0x06, 0x13, 0x51, 0x61, 0x07, 0x22, 0x71, 0x14, 0x32, 0x81, 0x91, 0xa1, 0x08, 0x23, 0x42, 0xb1,
+    0xc1, 0x15, 0x52, 0xd1, 0xf0, 0x24, 0x33, 0x62, 0x72, 0x82, 0x09, 0x0a, 0x16, 0x17, 0x18, 0x19,
+    0x1a, 0x25, 0x26, 0x27, 0x28, 0x29, 0x2a, 0x34, 0x35, 0x36, 0x37, 0x38, 0x39, 0x3a, 0x43, 0x44,
+    0x45, 0x46, 0x47, 0x48, 0x49, 0x4a, 0x53, 0x54, 0x55, 0x56, 0x57, 0x58, 0x59, 0x5a, 0x63, 0x64,
+    0x65, 0x66, 0x67, 0x68, 0x69, 0x6a, 0x73, 0x74, 0x75, 0x76, 0x77, 0x78, 0x79, 0x7a, 0x83, 0x84,
+    0x85, 0x86, 0x87, 0x88, 0x89, 0x8a, 0x92, 0x93, 0x94, 0x95, 0x96, 0x97, 0x98, 0x99, 0x9a, 0xa2,
+    0xa3, 0xa4, 0xa5, 0xa6, 0xa7, 0xa8, 0xa9, 0xaa, 0xb2, 0xb3, 0xb4, 0xb5, 0xb6, 0xb7, 0xb8, 0xb9,
+    0xba, 0xc2, 0xc3, 0xc4, 0xc5, 0xc6, 0xc7, 0xc8, 0xc9, 0xca, 0xd2, 0xd3, 0xd4, 0xd5, 0xd6, 0xd7,
+    0xd8, 0xd9, 0xda, 0xe1, 0xe2, 0xe3, 0xe4, 0xe5, 0xe6, 0xe7, 0xe8, 0xe9, 0xea, 0xf1, 0xf2, 0xf3,
+    0xf4, 0xf5, 0xf6, 0xf7, 0xf8, 0xf9, 0xfa, 0xff, 0xc4, 0x00, 0x1f, 0x01, 0x00, 0x03, 0x01, 0x01,
+    0x01, 0x01, 0x01, 0x01, 0x01, 0x01, 0x01, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x01, 0x02, 0x03,
+    0x04, 0x05, 0x06, 0x07, 0x08, 0x09, 0x0a, 0x0b, 0xff, 0xc4, 0x00, 0xb5, 0x11, 0x00, 0x02, 0x01,
+    0x02, 0x04, 0x04, 0x03, 0x04, 0x07, 0x05, 0x04, 0x04, 0x00, 0x01, 0x02, 0x77, 0x00, 0x01, 0x02,
+    0x03, 0x11, 0x04, 0x05, 0x21, 0x31, 0x06, 0x12, 0x41, 0x51, 0x07, 0x61, 0x71, 0x13, 0x22, 0x32,
+    0x81, 0x08, 0x14, 0x42, 0x91, 0xa1, 0xb1, 0xc1, 0x09, 0x23, 0x33, 0x52, 0xf0, 0x15, 0x62, 0x72,
+    0xd1, 0x0a, 0x16, 0x24, 0x34, 0xe1, 0x25, 0xf1, 0x17, 0x18, 0x19, 0x1a, 0x26, 0x27, 0x28, 0x29,
+    0x2a, 0x35, 0x36, 0x37, 0x38, 0x39, 0x3a, 0x43, 0x44, 0x45, 0x46, 0x47, 0x48, 0x49, 0x4a, 0x53,
+    0x54, 0x55, 0x56, 0x57, 0x58, 0x59, 0x5a, 0x63, 0x64, 0x65, 0x66, 0x67, 0x68, 0x69, 0x6a, 0x73,
+    0x74, 0x75, 0x76, 0x77, 0x78, 0x79, 0x7a, 0x82, 0x83, 0x84, 0x85, 0x86, 0x87, 0x88, 0x89, 0x8a,
+    0x92, 0x93, 0x94, 0x95, 0x96, 0x97, 0x98, 0x99, 0x9a, 0xa2, 0xa3, 0xa4, 0xa5, 0xa6, 0xa7, 0xa8,
+    0xa9, 0xaa, 0xb2, 0xb3, 0xb4, 0xb5, 0xb6, 0xb7, 0xb8, 0xb9, 0xba, 0xc2, 0xc3, 0xc4, 0xc5, 0xc6,
+    0xc7, 0xc8, 0xc9, 0xca, 0xd2, 0xd3, 0xd4, 0xd5, 0xd6, 0xd7, 0xd8, 0xd9, 0xda, 0xe2, 0xe3, 0xe4,
+    0xe5, 0xe6, 0xe7, 0xe8, 0xe9, 0xea, 0xf2, 0xf3, 0xf4, 0xf5, 0xf6, 0xf7, 0xf8, 0xf9, 0xfa, 0xff,
+    0xda, 0x00, 0x0c, 0x03, 0x01, 0x00, 0x02, 0x11, 0x03, 0x11, 0x00, 0x3f, 0x00, 0xf3, 0xaa, 0xf8,
+    0xe3, 0xfa, 0x48, 0x28, 0x00, 0xa0, 0x02, 0x80, 0x0a, 0x00, 0xf6, 0x2a, 0xf8, 0xf3, 0xfc, 0xf3,
+    0x0a, 0x00, 0x28, 0x00, 0xa0, 0x02, 0x80, 0x3e, 0x5e, 0xaf, 0xef, 0x33, 0xf6, 0x20, 0xa0, 0x02,
+    0x80, 0x0a, 0x00, 0x28, 0x03, 0xf4, 0x1e, 0xbf, 0xcd, 0xb3, 0xec, 0x02, 0x80, 0x0a, 0x00, 0x28,
+    0x00, 0xa0, 0x0e, 0x02, 0xbf, 0xb0, 0xcf, 0xe5, 0x50, 0xa0, 0x02, 0x80, 0x0a, 0x00, 0x28, 0x03,
+    0xc7, 0x6b, 0xec, 0x0f, 0xf4, 0x30, 0x28, 0x00, 0xa0, 0x02, 0x80, 0x0a, 0x00, 0xe6, 0x2b, 0xf9,
+    0xb4, 0xf6, 0x02, 0x80, 0x0a, 0x00, 0x28, 0x00, 0xa0, 0x0f, 0x62, 0xaf, 0x8f, 0x3f, 0xcf, 0x30,
+    0xa0, 0x02, 0x80, 0x0a, 0x00, 0x28, 0x03, 0xe5, 0xea, 0xfe, 0xf3, 0x3f, 0x62, 0x0a, 0x00, 0x28,
+    0x00, 0xa0, 0x02, 0x80, 0x3f, 0x41, 0xeb, 0xfc, 0xdb, 0x3e, 0xc0, 0x28, 0x00, 0xa0, 0x02, 0x80,
+    0x0a, 0x00, 0xe0, 0x2b, 0xfb, 0x0c, 0xfe, 0x55, 0x0a, 0x00, 0x28, 0x00, 0xa0, 0x02, 0x80, 0x3c,
+    0x76, 0xbe, 0xc0, 0xff, 0x00, 0x43, 0x02, 0x80, 0x0a, 0x00, 0x28, 0x00, 0xa0, 0x0e, 0x62, 0xbf,
+    0x9b, 0x4f, 0x60, 0x28, 0x00, 0xa0, 0x02, 0x80, 0x0a, 0x00, 0xf6, 0x2a, 0xf8, 0xf3, 0xfc, 0xf3,
+    0x0a, 0x00, 0x28, 0x00, 0xa0, 0x02, 0x80, 0x3e, 0x5e, 0xaf, 0xef, 0x33, 0xf6, 0x20, 0xa0, 0x02,
+    0x80, 0x0a, 0x00, 0x28, 0x03, 0xf4, 0x1e, 0xbf, 0xcd, 0xb3, 0xec, 0x02, 0x80, 0x0a, 0x00, 0x28,
+    0x00, 0xa0, 0x0e, 0x02, 0xbf, 0xb0, 0xcf, 0xe5, 0x50, 0xa0, 0x02, 0x80, 0x0a, 0x00, 0x28, 0x03,
+    0xc7, 0x6b, 0xec, 0x0f, 0xf4, 0x30, 0x28, 0x00, 0xa0, 0x02, 0x80, 0x0a, 0x00, 0xf9, 0xde, 0x2a,
+    0xfc, 0x78, 0xfc, 0x14, 0xb7, 0x15, 0x00, 0x5c, 0x8a, 0x80, 0x2d, 0xc5, 0x40, 0x16, 0xe2, 0xa0,
+    0x0b, 0x91, 0x50, 0x05, 0xb8, 0xa8, 0x02, 0xdc, 0x54, 0x01, 0x72, 0x2a, 0x00, 0xb7, 0x15, 0x00,
+    0x5b, 0x8a, 0x80, 0x2e, 0x45, 0x40, 0x16, 0xe2, 0xa0, 0x0b, 0x91, 0x50, 0x05, 0xb8, 0xa8, 0x02,
+    0xe4, 0x54, 0x01, 0x6a, 0x2a, 0x00, 0xb9, 0x15, 0x00, 0x5b, 0x8a, 0x80, 0x2e, 0x45, 0x40, 0x16,
+    0xe2, 0xa0, 0x0b, 0x91, 0x50, 0x05, 0xb8, 0xa8, 0x02, 0xdc, 0x54, 0x01, 0x72, 0x2a, 0x00, 0xb7,
+    0x15, 0x00, 0x5c, 0x8a, 0x80, 0x2d, 0xc5, 0x40, 0x16, 0xe2, 0xa0, 0x0b, 0x71, 0x50, 0x07, 0xe5,
+    0xb4, 0x54, 0x01, 0x6e, 0x2a, 0x00, 0xb9, 0x15, 0x00, 0x5b, 0x8a, 0x80, 0x2d, 0xc5, 0x40, 0x17,
+    0x22, 0xa0, 0x0b, 0x71, 0x50, 0x05, 0xb8, 0xa8, 0x02, 0xe4, 0x54, 0x01, 0x6e, 0x2a, 0x00, 0xb7,
+    0x15, 0x00, 0x5c, 0x8a, 0x80, 0x2d, 0xc5, 0x40, 0x17, 0x22, 0xa0, 0x0b, 0x71, 0x50, 0x05, 0xc8,
+    0xa8, 0x02, 0xd4, 0x54, 0x01, 0x72, 0x2a, 0x00, 0xb7, 0x15, 0x00, 0x5c, 0x8a, 0x80, 0x2d, 0xc5,
+    0x40, 0x17, 0x22, 0xa0, 0x0b, 0x71, 0x50, 0x05, 0xb8, 0xa8, 0x02, 0xe4, 0x54, 0x01, 0x6e, 0x2a,
+    0x00, 0xb9, 0x15, 0x00, 0x5b, 0x8a, 0x80, 0x2d, 0xc5, 0x40, 0x16, 0xe2, 0xa0, 0x0f, 0xcb, 0x68,
+    0xa8, 0x02, 0xdc, 0x54, 0x01, 0x72, 0x2a, 0x00, 0xb7, 0x15, 0x00, 0x5b, 0x8a, 0x80, 0x2e, 0x45,
+    0x40, 0x16, 0xe2, 0xa0, 0x0b, 0x71, 0x50, 0x05, 0xc8, 0xa8, 0x02, 0xdc, 0x54, 0x01, 0x6e, 0x2a,
+    0x00, 0xb9, 0x15, 0x00, 0x5b, 0x8a, 0x80, 0x2e, 0x45, 0x40, 0x16, 0xe2, 0xa0, 0x0b, 0x91, 0x50,
+    0x05, 0xa8, 0xa8, 0x02, 0xe4, 0x54, 0x01, 0x6e, 0x2a, 0x00, 0xb9, 0x15, 0x00, 0x5b, 0x8a, 0x80,
+    0x2e, 0x45, 0x40, 0x16, 0xe2, 0xa0, 0x0b, 0x71, 0x50, 0x05, 0xc8, 0xa8, 0x02, 0xdc, 0x54, 0x01,
+    0x72, 0x2a, 0x00, 0xb7, 0x15, 0x00, 0x5b, 0x8a, 0x80, 0x2d, 0xc5, 0x40, 0x1f, 0xff, 0xd9,
+};
+
+static constexpr int kDeviceBenchJpegWidth = 240;
+static constexpr int kDeviceBenchJpegHeight = 48;
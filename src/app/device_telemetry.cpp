@@ -2,8 +2,36 @@
 
 #include "log_manager.h"
 #include "board_config.h"
+#include "board_profile.h"
 #include "fs_health.h"
+#include "health_window.h"
+#if HAS_IMAGE_API && IMAGE_URL_CACHE_ENABLED
+#include "image_cache.h"
+#endif
+#if HAS_IMAGE_API
+#include "image_arena.h"
+#include "image_http_pool.h"
+#include "image_refresh.h"
+#include "strip_decoder.h"
+#include "p1_meter.h"
+#include "energy_fastpath.h"
+#include "wifi_power.h"
+#include "energy_alarm.h"
+#include "lvgl_image_cache.h"
+#endif
+#include "app_alloc.h"
+#include "energy_latency.h"
+#include "lvgl_heap.h"
+#include "lvgl_lock_stats.h"
+#include "json_arena.h"
+#include "json_template.h"
+#include "psram_json_allocator.h"
 #include "rtos_task_utils.h"
+#include "task_placement.h"
+#include "web_portal_admission.h"
+#include "config_manager.h"
+#include "wifi_fast_connect.h"
+#include "crash_record.h"
 
 #include <Arduino.h>
 #include <WiFi.h>
@@ -13,6 +41,8 @@
 #include <freertos/task.h>
 #include <freertos/semphr.h>
 #include <freertos/timers.h>
+#include <new>
+#include <string.h>
 
 #if HAS_MQTT
 #include "mqtt_manager.h"
@@ -38,6 +68,17 @@ static uint32_t last_idle_runtime = 0;
 static uint32_t last_total_runtime = 0;
 static bool first_calculation = true;
 
+// Per-task deltas: previous runtime counters keyed by task handle (monitor task only), and
+// the published breakdown (under cpu_mutex). Both are fixed-size.
+struct CpuTaskPrev {
+    TaskHandle_t handle;
+    uint32_t runtime;
+};
+static CpuTaskPrev cpu_task_prev[kDeviceTelemetryMaxTasks] = {};
+static size_t cpu_task_prev_count = 0;
+static unsigned long cpu_task_last_sample_ms = 0;
+static DeviceTaskStats cpu_task_stats = {};
+
 static bool log_every_ms(unsigned long now_ms, unsigned long *last_ms, unsigned long interval_ms) {
     if (!last_ms) return false;
     if (*last_ms == 0 || (now_ms - *last_ms) >= interval_ms) {
@@ -54,110 +95,50 @@ static bool log_every_ms(unsigned long now_ms, unsigned long *last_ms, unsigned
 // - We keep a small "last" window and a "current" window and report a merged
 //   snapshot, which is stable across multiple clients and makes a reasonable
 //   effort to not miss spikes around rollover boundaries.
-static portMUX_TYPE g_health_window_mux = portMUX_INITIALIZER_UNLOCKED;
+// - All aggregation happens in the sampler (timer task, the only writer): each
+//   sample folds into running min/max and republishes the merged bands. Readers
+//   copy the published bands without locks or heap scans (see health_window_read()).
 static TimerHandle_t g_health_window_timer = nullptr;
 
-static constexpr uint32_t kHealthWindowSamplePeriodMs = 200;
-
-struct HealthWindowStats {
-    bool initialized;
-
-    size_t internal_free_min;
-    size_t internal_free_max;
-    size_t internal_largest_min;
-    size_t internal_largest_max;
-    int internal_frag_max;
-
-    size_t psram_free_min;
-    size_t psram_free_max;
-    size_t psram_largest_min;
-    int psram_frag_max;
-};
-
-static HealthWindowStats g_health_window_current = {};
-static HealthWindowStats g_health_window_last = {};
-static bool g_health_window_last_valid = false;
-
-static unsigned long g_health_window_current_start_ms = 0;
-static unsigned long g_health_window_last_start_ms = 0;
-static unsigned long g_health_window_last_end_ms = 0;
-
-static void health_window_reset() {
-    portENTER_CRITICAL(&g_health_window_mux);
-    g_health_window_current = {};
-    g_health_window_last = {};
-    g_health_window_last_valid = false;
-    g_health_window_current_start_ms = millis();
-    g_health_window_last_start_ms = 0;
-    g_health_window_last_end_ms = 0;
-    portEXIT_CRITICAL(&g_health_window_mux);
-}
-
-static int compute_fragmentation_percent(size_t free_bytes, size_t largest_bytes) {
-    if (free_bytes == 0) return 0;
-    if (largest_bytes > free_bytes) return 0;
-    float frag = (1.0f - ((float)largest_bytes / (float)free_bytes)) * 100.0f;
-    if (frag < 0) frag = 0;
-    if (frag > 100) frag = 100;
-    return (int)frag;
+// Sampler-private window state.
+static HealthWindowState g_health_window = {};
+
+// Published bands behind a sequence lock: seq is odd while the sampler (the only
+// writer) rewrites them, and 0 until the first publish. A reader retries when the
+// sequence was odd or changed during its copy.
+static HealthWindowComputed g_health_window_bands = {};
+static uint32_t g_health_window_seq = 0;
+
+static void health_window_publish(const HealthWindowComputed& bands) {
+    const uint32_t seq = __atomic_load_n(&g_health_window_seq, __ATOMIC_RELAXED);
+    __atomic_store_n(&g_health_window_seq, seq + 1, __ATOMIC_RELAXED);
+    __atomic_thread_fence(__ATOMIC_RELEASE);
+    g_health_window_bands = bands;
+    __atomic_store_n(&g_health_window_seq, seq + 2, __ATOMIC_RELEASE);
 }
 
-static void health_window_update_sample(size_t internal_free, size_t internal_largest, size_t psram_free, size_t psram_largest) {
-    const int internal_frag = compute_fragmentation_percent(internal_free, internal_largest);
-    const int psram_frag = compute_fragmentation_percent(psram_free, psram_largest);
-
-    const unsigned long now_ms = millis();
-
-    portENTER_CRITICAL(&g_health_window_mux);
-
-    if (g_health_window_current_start_ms == 0) {
-        g_health_window_current_start_ms = now_ms;
-    }
-
-    // Time-based rollover (shared across all clients).
-    // Roll over BEFORE applying the sample so the boundary sample belongs to the new window.
-    if ((uint32_t)(now_ms - g_health_window_current_start_ms) >= (uint32_t)HEALTH_POLL_INTERVAL_MS) {
-        if (g_health_window_current.initialized) {
-            g_health_window_last = g_health_window_current;
-            g_health_window_last_valid = true;
-            g_health_window_last_start_ms = g_health_window_current_start_ms;
-            g_health_window_last_end_ms = now_ms;
+static bool health_window_read(HealthWindowComputed* out) {
+    for (int attempt = 0; attempt < 4; attempt++) {
+        const uint32_t seq = __atomic_load_n(&g_health_window_seq, __ATOMIC_ACQUIRE);
+        if (seq == 0) return false;
+        if (seq & 1u) continue;  // publish in progress
+        const HealthWindowComputed copy = g_health_window_bands;
+        __atomic_thread_fence(__ATOMIC_ACQUIRE);
+        if (__atomic_load_n(&g_health_window_seq, __ATOMIC_RELAXED) == seq) {
+            *out = copy;
+            return true;
         }
-
-        g_health_window_current = {};
-        g_health_window_current_start_ms = now_ms;
     }
+    return false;
+}
 
-    if (!g_health_window_current.initialized) {
-        g_health_window_current.initialized = true;
-
-        g_health_window_current.internal_free_min = internal_free;
-        g_health_window_current.internal_free_max = internal_free;
-        g_health_window_current.internal_largest_min = internal_largest;
-        g_health_window_current.internal_largest_max = internal_largest;
-        g_health_window_current.internal_frag_max = internal_frag;
-
-        g_health_window_current.psram_free_min = psram_free;
-        g_health_window_current.psram_free_max = psram_free;
-        g_health_window_current.psram_largest_min = psram_largest;
-        g_health_window_current.psram_frag_max = psram_frag;
-
-        portEXIT_CRITICAL(&g_health_window_mux);
-        return;
-    }
-
-    if (internal_free < g_health_window_current.internal_free_min) g_health_window_current.internal_free_min = internal_free;
-    if (internal_free > g_health_window_current.internal_free_max) g_health_window_current.internal_free_max = internal_free;
-    if (internal_largest < g_health_window_current.internal_largest_min) g_health_window_current.internal_largest_min = internal_largest;
-    if (internal_largest > g_health_window_current.internal_largest_max) g_health_window_current.internal_largest_max = internal_largest;
-    if (internal_frag > g_health_window_current.internal_frag_max) g_health_window_current.internal_frag_max = internal_frag;
-
-    if (psram_free < g_health_window_current.psram_free_min) g_health_window_current.psram_free_min = psram_free;
-    if (psram_free > g_health_window_current.psram_free_max) g_health_window_current.psram_free_max = psram_free;
-    if (psram_largest < g_health_window_current.psram_largest_min) g_health_window_current.psram_largest_min = psram_largest;
-    if (psram_frag > g_health_window_current.psram_frag_max) g_health_window_current.psram_frag_max = psram_frag;
+static void health_window_reset() {
+    health_window_state_reset(&g_health_window, millis());
+}
 
-    portEXIT_CRITICAL(&g_health_window_mux);
+static void health_window_update_sample(size_t internal_free, size_t internal_largest, size_t psram_free, size_t psram_largest) {
+    health_window_publish(health_window_apply_sample(&g_health_window, millis(), (uint32_t)HEALTH_POLL_INTERVAL_MS,
+                                                     internal_free, internal_largest, psram_free, psram_largest));
 }
 
 // Flash/sketch metadata caching (avoid re-entrant ESP-IDF image/mmap helpers)
@@ -167,32 +148,10 @@ static size_t cached_free_sketch_space = 0;
 
 static void fill_common(JsonDocument &doc, bool include_ip_and_channel, bool include_debug_fields, bool include_mqtt_self_report);
 
-static void fill_health_window_fields(JsonDocument &doc);
-
-struct HealthWindowComputed {
-    uint32_t heap_internal_free_min_window;
-    uint32_t heap_internal_free_max_window;
-
-    uint32_t heap_internal_largest_min_window;
-    uint32_t heap_internal_largest_max_window;
-    int heap_fragmentation_max_window;
-
-    uint32_t psram_free_min_window;
-    uint32_t psram_free_max_window;
-    uint32_t psram_largest_min_window;
-    int psram_fragmentation_max_window;
-};
-
-static bool compute_health_window_computed(HealthWindowComputed* out);
+static const char* reset_reason_string();
+static bool read_cpu_temperature(int* out_celsius);
 
-static void health_window_get_snapshot(
-    HealthWindowStats* out_last,
-    bool* out_has_last,
-    HealthWindowStats* out_current,
-    unsigned long* out_current_start_ms,
-    unsigned long* out_last_start_ms,
-    unsigned long* out_last_end_ms
-);
+static void fill_health_window_fields(JsonDocument &doc);
 
 static void get_memory_snapshot(
     size_t *out_heap_free,
@@ -205,12 +164,66 @@ static void get_memory_snapshot(
     size_t *out_psram_largest
 );
 
-static int calculate_cpu_usage() {
+// Idle task names are "IDLE0"/"IDLE1" (SMP) or "IDLE"; returns the core or -1.
+static int idle_task_core(const char* name) {
+    if (!name || strncmp(name, "IDLE", 4) != 0) return -1;
+    const char c = name[4];
+    if (c >= '0' && c <= '9') return c - '0';
+    return 0;
+}
+
+// Per-task deltas against the previous sample -> stats (sorted busiest first).
+// Tasks seen for the first time report 0 (no baseline yet).
+static void update_task_stats(const TaskStatus_t* tasks, UBaseType_t count, uint32_t total_delta, DeviceTaskStats* stats) {
+    stats->task_count = 0;
+    for (UBaseType_t i = 0; i < count && i < kDeviceTelemetryMaxTasks; i++) {
+        const TaskStatus_t& t = tasks[i];
+        uint32_t delta = 0;
+        for (size_t j = 0; j < cpu_task_prev_count; j++) {
+            if (cpu_task_prev[j].handle == t.xHandle) {
+                delta = t.ulRunTimeCounter - cpu_task_prev[j].runtime;
+                break;
+            }
+        }
+
+        DeviceTaskStat s = {};
+        strlcpy(s.name, t.pcTaskName ? t.pcTaskName : "?", sizeof(s.name));
+        uint32_t x10 = total_delta ? (uint32_t)(((uint64_t)delta * 1000ULL) / total_delta) : 0;
+        if (x10 > 1000) x10 = 1000;
+        s.cpu_x10 = (uint16_t)x10;
+        s.stack_free_min_bytes = (uint32_t)t.usStackHighWaterMark * (uint32_t)sizeof(StackType_t);
+        s.priority = (uint8_t)t.uxCurrentPriority;
+        s.core = -1;
+        #if defined(configTASKLIST_INCLUDE_COREID) && configTASKLIST_INCLUDE_COREID
+        if ((int)t.xCoreID >= 0 && (int)t.xCoreID < portNUM_PROCESSORS) s.core = (int8_t)t.xCoreID;
+        #endif
+
+        // Insertion sort (busiest first); at most kDeviceTelemetryMaxTasks entries.
+        size_t pos = stats->task_count;
+        while (pos > 0 && stats->tasks[pos - 1].cpu_x10 < s.cpu_x10) {
+            stats->tasks[pos] = stats->tasks[pos - 1];
+            pos--;
+        }
+        stats->tasks[pos] = s;
+        stats->task_count++;
+    }
+
+    cpu_task_prev_count = 0;
+    for (UBaseType_t i = 0; i < count && i < kDeviceTelemetryMaxTasks; i++) {
+        cpu_task_prev[cpu_task_prev_count].handle = tasks[i].xHandle;
+        cpu_task_prev[cpu_task_prev_count].runtime = tasks[i].ulRunTimeCounter;
+        cpu_task_prev_count++;
+    }
+}
+
+// Runs on the CPU monitor task only, without cpu_mutex: the baselines above are private to
+// that task, and the breakdown goes to *stats for the caller to publish.
+static int calculate_cpu_usage(DeviceTaskStats* stats) {
     // IMPORTANT:
     // - uxTaskGetSystemState returns 0 when the provided array is too small.
     // - TaskStatus_t is fairly large; keep this out of stack (CPU monitor task stack is small).
     // - If runtime stats aren't enabled, total_runtime and ulRunTimeCounter stay 0 -> treat as unknown.
-    constexpr UBaseType_t kMaxTasks = 24;
+    constexpr UBaseType_t kMaxTasks = kDeviceTelemetryMaxTasks;
     static TaskStatus_t task_stats[kMaxTasks];
 
     // Guard: if there are more tasks than we can sample, bail out and log.
@@ -227,6 +240,7 @@ static int calculate_cpu_usage() {
                 (unsigned)kMaxTasks
             );
         }
+        stats->valid = false;
         return -1;
     }
 
@@ -243,6 +257,7 @@ static int calculate_cpu_usage() {
                 (unsigned long)total_runtime
             );
         }
+        stats->valid = false;
         return -1;
     }
 
@@ -259,6 +274,34 @@ static int calculate_cpu_usage() {
 
     if (idle_task_count <= 0) return -1;
 
+    // Per-core utilization from each core's idle task delta (read before the
+    // per-task baseline is replaced below).
+    const uint32_t total_delta_for_tasks = total_runtime - last_total_runtime;
+    int16_t core_usage[2] = {-1, -1};
+    uint8_t core_count = 0;
+    for (UBaseType_t i = 0; i < task_count && !first_calculation; i++) {
+        const int core = idle_task_core(task_stats[i].pcTaskName);
+        if (core < 0 || core > 1 || total_delta_for_tasks == 0) continue;
+        for (size_t j = 0; j < cpu_task_prev_count; j++) {
+            if (cpu_task_prev[j].handle != task_stats[i].xHandle) continue;
+            const uint32_t idle = task_stats[i].ulRunTimeCounter - cpu_task_prev[j].runtime;
+            int usage = 100 - (int)(((uint64_t)idle * 100ULL) / total_delta_for_tasks);
+            if (usage < 0) usage = 0;
+            if (usage > 100) usage = 100;
+            core_usage[core] = (int16_t)usage;
+            if ((uint8_t)(core + 1) > core_count) core_count = (uint8_t)(core + 1);
+            break;
+        }
+    }
+
+    update_task_stats(task_stats, (UBaseType_t)task_count, first_calculation ? 0 : total_delta_for_tasks, stats);
+    stats->core_usage[0] = core_usage[0];
+    stats->core_usage[1] = core_usage[1];
+    stats->core_count = core_count;
+    stats->window_ms = cpu_task_last_sample_ms ? (uint32_t)(now_ms - cpu_task_last_sample_ms) : 0;
+    stats->valid = !first_calculation;
+    cpu_task_last_sample_ms = now_ms;
+
     // Skip first calculation (need delta)
     if (first_calculation) {
         last_idle_runtime = idle_runtime;
@@ -313,34 +356,12 @@ static void health_window_timer_cb(TimerHandle_t) {
     health_window_update_sample(internal_free, heap_largest, psram_free, psram_largest);
 }
 
-static void health_window_get_snapshot(
-    HealthWindowStats* out_last,
-    bool* out_has_last,
-    HealthWindowStats* out_current,
-    unsigned long* out_current_start_ms,
-    unsigned long* out_last_start_ms,
-    unsigned long* out_last_end_ms
-) {
-    if (!out_last || !out_has_last || !out_current || !out_current_start_ms || !out_last_start_ms || !out_last_end_ms) {
-        return;
-    }
-
-    portENTER_CRITICAL(&g_health_window_mux);
-    *out_last = g_health_window_last;
-    *out_has_last = g_health_window_last_valid;
-    *out_current = g_health_window_current;
-    *out_current_start_ms = g_health_window_current_start_ms;
-    *out_last_start_ms = g_health_window_last_start_ms;
-    *out_last_end_ms = g_health_window_last_end_ms;
-    portEXIT_CRITICAL(&g_health_window_mux);
-}
-
 static void log_task_stack_watermarks_one_shot() {
     const UBaseType_t task_count = uxTaskGetNumberOfTasks();
     if (task_count == 0) return;
 
     TaskStatus_t* tasks = nullptr;
-    if (psramFound()) {
+    if (board_psram_available()) {
         tasks = (TaskStatus_t*)heap_caps_malloc(sizeof(TaskStatus_t) * task_count, MALLOC_CAP_SPIRAM | MALLOC_CAP_8BIT);
     }
     if (!tasks) {
@@ -481,6 +502,9 @@ void device_telemetry_check_tripwires() {
         (unsigned)MEMORY_TRIPWIRE_INTERNAL_MIN_BYTES
     );
     log_task_stack_watermarks_one_shot();
+    #if CRASH_RECORD_SUPPORTED
+    crash_record_note_tripwire((uint32_t)snapshot.heap_internal_min_free_bytes);
+    #endif
     #endif
 }
 
@@ -530,18 +554,262 @@ void device_telemetry_fill_mqtt(JsonDocument &doc) {
     // IMPORTANT:
     // - The key "cpu_temperature" is used for the SoC/internal temperature.
     //   You can safely use "temperature" for an external/ambient sensor.
+    // - With MQTT_HEALTH_TEMPLATE (default) the published payload is rendered
+    //   from a fixed skeleton instead of this document: add a MqttHealthSlot
+    //   (device_telemetry.h), its key to kMqttHealthKeys and the value in
+    //   device_telemetry_collect_mqtt().
     //
     // Example (commented out):
     // doc["temperature"] = 23.4;
     // doc["humidity"] = 55.2;
 }
 
+// Deadband per MQTT health field. Matched by exact key, or by prefix when the
+// entry ends in '*'. relative = deadband is a percentage of the previous value.
+struct HealthDeadband {
+    const char* key;
+    float deadband;     // < 0 = ignore field
+    bool relative;
+};
+
+static const HealthDeadband kHealthDeadbands[] = {
+    {"uptime_seconds", -1.0f, false},
+    {"cpu_usage", (float)MQTT_HEALTH_DEADBAND_PCT, false},
+    {"cpu_temperature", (float)MQTT_HEALTH_DEADBAND_TEMP_C, false},
+    {"heap_fragmentation", (float)MQTT_HEALTH_DEADBAND_PCT, false},
+    {"psram_fragmentation", (float)MQTT_HEALTH_DEADBAND_PCT, false},
+    {"heap_*", (float)MQTT_HEALTH_DEADBAND_BYTES, false},
+    {"psram_*", (float)MQTT_HEALTH_DEADBAND_BYTES, false},
+    {"fs_used_bytes", (float)MQTT_HEALTH_DEADBAND_BYTES, false},
+    {"wifi_rssi", (float)MQTT_HEALTH_DEADBAND_RSSI_DBM, false},
+    {"display_*", (float)MQTT_HEALTH_DEADBAND_PERF_PCT, true},
+    // USER-EXTEND: add deadbands for custom sensors, e.g. {"temperature", 0.5f, false},
+};
+
+static const HealthDeadband* find_health_deadband(const char* key) {
+    for (const HealthDeadband& d : kHealthDeadbands) {
+        const size_t n = strlen(d.key);
+        if (n > 0 && d.key[n - 1] == '*') {
+            if (strncmp(key, d.key, n - 1) == 0) return &d;
+        } else if (strcmp(key, d.key) == 0) {
+            return &d;
+        }
+    }
+    return nullptr;
+}
+
+bool device_telemetry_mqtt_changed(const JsonDocument &prev, const JsonDocument &cur) {
+    JsonObjectConst p = prev.as<JsonObjectConst>();
+    JsonObjectConst c = cur.as<JsonObjectConst>();
+    if (p.isNull() || c.isNull()) return true;
+    if (p.size() != c.size()) return true;
+
+    for (JsonPairConst kv : c) {
+        const char* key = kv.key().c_str();
+        JsonVariantConst now_v = kv.value();
+        JsonVariantConst was_v = p[key];
+
+        const HealthDeadband* band = find_health_deadband(key);
+        if (band && band->deadband < 0.0f) continue;
+
+        if (now_v.isNull() != was_v.isNull()) return true;
+        if (now_v.isNull()) continue;
+
+        const bool numeric = (now_v.is<double>() || now_v.is<long long>()) && !now_v.is<bool>();
+        if (band && numeric && (was_v.is<double>() || was_v.is<long long>())) {
+            const double was = was_v.as<double>();
+            const double diff = fabs(now_v.as<double>() - was);
+            const double limit = band->relative ? fabs(was) * (double)band->deadband / 100.0 : (double)band->deadband;
+            if (diff >= limit && diff > 0.0) return true;
+            continue;
+        }
+
+        if (now_v != was_v) return true;
+    }
+    return false;
+}
+
+#if MQTT_HEALTH_TEMPLATE
+static constexpr size_t kMqttHealthSlotCount = (size_t)MqttHealthSlot::Count;
+
+// Key per MqttHealthSlot, in the order device_telemetry_fill_mqtt() writes them.
+static const char* const kMqttHealthKeys[] = {
+    "uptime_seconds",
+    "cpu_usage",
+    "cpu_temperature",
+    "heap_free",
+    "heap_min",
+    "heap_largest",
+    "heap_internal_free",
+    "heap_internal_min",
+    "heap_internal_largest",
+    "psram_free",
+    "psram_min",
+    "psram_largest",
+    "heap_fragmentation",
+    "psram_fragmentation",
+    "flash_used",
+    "flash_total",
+    "fs_mounted",
+    "fs_used_bytes",
+    "fs_total_bytes",
+    "display_fps",
+    "display_lv_timer_us",
+    "display_present_us",
+#if HAS_DISPLAY
+    "display_lv_timer_p95_us",
+    "display_lv_timer_max_us",
+    "display_flush_p95_us",
+    "display_flush_max_us",
+    "display_bus_bytes_per_s",
+#endif
+    "wifi_rssi",
+};
+static_assert(sizeof(kMqttHealthKeys) / sizeof(kMqttHealthKeys[0]) == kMqttHealthSlotCount,
+              "kMqttHealthKeys must list one key per MqttHealthSlot");
+
+// Keys + the reset reason come to ~560 bytes.
+static char g_mqtt_skeleton[768];
+// Always large enough for device_telemetry_render_mqtt().
+static constexpr size_t kMqttHealthRenderBytes = sizeof(g_mqtt_skeleton) + kMqttHealthSlotCount * 20 + 1;
+static JsonTemplate g_mqtt_template;
+static const HealthDeadband* g_mqtt_slot_bands[kMqttHealthSlotCount] = {};
+
+// Once from device_telemetry_init(); the template is read-only afterwards.
+static void build_mqtt_template() {
+    JsonTemplateField fields[kMqttHealthSlotCount + 1];
+    size_t n = 0;
+    for (size_t i = 0; i < kMqttHealthSlotCount; i++) {
+        const MqttHealthSlot slot = (MqttHealthSlot)i;
+        const JsonTemplateKind kind = (slot == MqttHealthSlot::FsMounted) ? JsonTemplateKind::Bool : JsonTemplateKind::Int;
+        fields[n++] = {kMqttHealthKeys[i], kind, nullptr};
+        if (slot == MqttHealthSlot::UptimeSeconds) {
+            // Fixed for the whole boot, so it is part of the skeleton.
+            fields[n++] = {"reset_reason", JsonTemplateKind::Text, reset_reason_string()};
+        }
+        g_mqtt_slot_bands[i] = find_health_deadband(kMqttHealthKeys[i]);
+    }
+
+    if (!g_mqtt_template.build(fields, n, g_mqtt_skeleton, sizeof(g_mqtt_skeleton))) {
+        LOGE("Health", "MQTT health template does not fit (%u bytes)", (unsigned)sizeof(g_mqtt_skeleton));
+    }
+}
+
+void device_telemetry_collect_mqtt(DeviceHealthValues* out) {
+    int64_t* v = out->v;
+    for (size_t i = 0; i < kMqttHealthSlotCount; i++) v[i] = kJsonTemplateNull;
+    auto set = [v](MqttHealthSlot slot, int64_t value) { v[(size_t)slot] = value; };
+
+    set(MqttHealthSlot::UptimeSeconds, (int64_t)(esp_timer_get_time() / 1000000));
+
+    const int cpu_usage = device_telemetry_get_cpu_usage();
+    if (cpu_usage >= 0) set(MqttHealthSlot::CpuUsage, cpu_usage);
+
+    int temp_celsius = 0;
+    if (read_cpu_temperature(&temp_celsius)) set(MqttHealthSlot::CpuTemperature, temp_celsius);
+
+    size_t heap_free = 0;
+    size_t heap_min = 0;
+    size_t heap_largest = 0;
+    size_t internal_free = 0;
+    size_t internal_min = 0;
+    size_t psram_free = 0;
+    size_t psram_min = 0;
+    size_t psram_largest = 0;
+
+    get_memory_snapshot(
+        &heap_free,
+        &heap_min,
+        &heap_largest,
+        &internal_free,
+        &internal_min,
+        &psram_free,
+        &psram_min,
+        &psram_largest
+    );
+    const size_t internal_largest = heap_caps_get_largest_free_block(MALLOC_CAP_INTERNAL | MALLOC_CAP_8BIT);
+
+    set(MqttHealthSlot::HeapFree, heap_free);
+    set(MqttHealthSlot::HeapMin, heap_min);
+    set(MqttHealthSlot::HeapLargest, heap_largest);
+    set(MqttHealthSlot::HeapInternalFree, internal_free);
+    set(MqttHealthSlot::HeapInternalMin, internal_min);
+    set(MqttHealthSlot::HeapInternalLargest, internal_largest);
+    set(MqttHealthSlot::PsramFree, psram_free);
+    set(MqttHealthSlot::PsramMin, psram_min);
+    set(MqttHealthSlot::PsramLargest, psram_largest);
+    set(MqttHealthSlot::HeapFragmentation, health_window_fragmentation_percent(internal_free, internal_largest));
+    set(MqttHealthSlot::PsramFragmentation, health_window_fragmentation_percent(psram_free, psram_largest));
+
+    const size_t sketch_size = device_telemetry_sketch_size();
+    set(MqttHealthSlot::FlashUsed, sketch_size);
+    set(MqttHealthSlot::FlashTotal, sketch_size + device_telemetry_free_sketch_space());
+
+    FSHealthStats fs;
+    fs_health_get(&fs);
+    if (fs.ffat_partition_present) {
+        set(MqttHealthSlot::FsMounted, fs.ffat_mounted ? 1 : 0);
+        if (fs.ffat_mounted && fs.ffat_total_bytes > 0) {
+            set(MqttHealthSlot::FsUsedBytes, (int64_t)fs.ffat_used_bytes);
+            set(MqttHealthSlot::FsTotalBytes, (int64_t)fs.ffat_total_bytes);
+        }
+    }
+
+    #if HAS_DISPLAY
+    DisplayPerfStats stats;
+    if (displayManager && display_manager_get_perf_stats(&stats)) {
+        set(MqttHealthSlot::DisplayFps, stats.fps);
+        set(MqttHealthSlot::DisplayLvTimerUs, stats.lv_timer_us);
+        set(MqttHealthSlot::DisplayPresentUs, stats.present_us);
+        set(MqttHealthSlot::DisplayLvTimerP95Us, stats.lv_timer_dist_us.p95);
+        set(MqttHealthSlot::DisplayLvTimerMaxUs, stats.lv_timer_dist_us.max);
+        set(MqttHealthSlot::DisplayFlushP95Us, stats.flush_dist_us.p95);
+        set(MqttHealthSlot::DisplayFlushMaxUs, stats.flush_dist_us.max);
+        set(MqttHealthSlot::DisplayBusBytesPerS, stats.bus_bytes_per_s);
+    }
+    #endif
+
+    if (WiFi.status() == WL_CONNECTED) set(MqttHealthSlot::WifiRssi, WiFi.RSSI());
+
+    // USER-EXTEND: set custom slots here (leave them at kJsonTemplateNull when unknown).
+}
+
+size_t device_telemetry_render_mqtt(const DeviceHealthValues &values, char *out, size_t cap) {
+    return g_mqtt_template.render(values.v, out, cap);
+}
+
+bool device_telemetry_mqtt_values_changed(const DeviceHealthValues &prev, const DeviceHealthValues &cur) {
+    for (size_t i = 0; i < kMqttHealthSlotCount; i++) {
+        const HealthDeadband* band = g_mqtt_slot_bands[i];
+        if (band && band->deadband < 0.0f) continue;
+
+        const int64_t was = prev.v[i];
+        const int64_t now = cur.v[i];
+        if ((was == kJsonTemplateNull) != (now == kJsonTemplateNull)) return true;
+        if (now == kJsonTemplateNull || now == was) continue;
+
+        if (band) {
+            const double diff = fabs((double)now - (double)was);
+            const double limit = band->relative ? fabs((double)was) * (double)band->deadband / 100.0 : (double)band->deadband;
+            if (diff >= limit) return true;
+            continue;
+        }
+        return true;
+    }
+    return false;
+}
+#endif
+
 void device_telemetry_init() {
     if (flash_cache_initialized) return;
 
     cached_sketch_size = ESP.getSketchSize();
     cached_free_sketch_space = ESP.getFreeSketchSpace();
     flash_cache_initialized = true;
+
+    #if MQTT_HEALTH_TEMPLATE
+    build_mqtt_template();
+    #endif
 }
 
 size_t device_telemetry_sketch_size() {
@@ -558,15 +826,146 @@ size_t device_telemetry_free_sketch_space() {
     return cached_free_sketch_space;
 }
 
-// Background task: Calculate CPU usage every 1s.
+#if HEALTH_SNAPSHOT_ENABLED
+// Published snapshot plus the previous one, kept as a spare: once no request or
+// publish holds it anymore its block is refilled instead of allocating a new one.
+static portMUX_TYPE g_snapshot_mux = portMUX_INITIALIZER_UNLOCKED;
+static std::shared_ptr<DeviceHealthSnapshot> g_snapshot;
+static std::shared_ptr<DeviceHealthSnapshot> g_snapshot_spare;
+static BasicJsonDocument<PsramJsonAllocator>* g_snapshot_api_doc = nullptr;
+static uint32_t g_snapshot_seq = 0;
+static bool g_snapshot_overflow_logged = false;
+
+static void snapshot_free(DeviceHealthSnapshot* snap) {
+    if (!snap) return;
+    snap->~DeviceHealthSnapshot();
+    heap_caps_free(snap);
+}
+
+static std::shared_ptr<DeviceHealthSnapshot> snapshot_alloc(size_t text_capacity) {
+    const size_t bytes = sizeof(DeviceHealthSnapshot) + text_capacity;
+    void* mem = nullptr;
+    if (board_psram_available()) {
+        mem = heap_caps_malloc(bytes, MALLOC_CAP_SPIRAM | MALLOC_CAP_8BIT);
+    }
+    if (!mem) {
+        mem = heap_caps_malloc(bytes, MALLOC_CAP_INTERNAL | MALLOC_CAP_8BIT);
+    }
+    if (!mem) return nullptr;
+
+    DeviceHealthSnapshot* snap = new (mem) DeviceHealthSnapshot();
+    snap->text_capacity = text_capacity;
+    return std::shared_ptr<DeviceHealthSnapshot>(snap, snapshot_free);
+}
+
+static void refresh_health_snapshot() {
+    if (!g_snapshot_api_doc) {
+        g_snapshot_api_doc = new (std::nothrow) BasicJsonDocument<PsramJsonAllocator>(kDeviceTelemetryApiDocCapacity);
+        if (!g_snapshot_api_doc || g_snapshot_api_doc->capacity() == 0) {
+            LOGE("Health", "Snapshot document allocation failed");
+            delete g_snapshot_api_doc;
+            g_snapshot_api_doc = nullptr;
+            return;
+        }
+    }
+
+    BasicJsonDocument<PsramJsonAllocator>& api_doc = *g_snapshot_api_doc;
+    api_doc.clear();
+    device_telemetry_fill_api(api_doc);
+
+    #if MQTT_HEALTH_TEMPLATE
+    // Static: keeps the values and text off the (small) monitoring task stack.
+    static DeviceHealthValues mqtt_values;
+    static char mqtt_text[kMqttHealthRenderBytes];
+    device_telemetry_collect_mqtt(&mqtt_values);
+    const size_t mqtt_len = device_telemetry_render_mqtt(mqtt_values, mqtt_text, sizeof(mqtt_text));
+    const bool mqtt_overflow = mqtt_len == 0;
+    #else
+    // Static: keeps the document off the (small) monitoring task stack.
+    static StaticJsonDocument<kDeviceTelemetryMqttDocCapacity> mqtt_doc;
+    mqtt_doc.clear();
+    device_telemetry_fill_mqtt(mqtt_doc);
+    const bool mqtt_overflow = mqtt_doc.overflowed();
+    #endif
+
+    if (api_doc.overflowed() || mqtt_overflow) {
+        // Requests fall back to building the document themselves (and report the overflow).
+        if (!g_snapshot_overflow_logged) {
+            LOGE("Health", "Snapshot JSON overflow (api=%d mqtt=%d)", (int)api_doc.overflowed(), (int)mqtt_overflow);
+            g_snapshot_overflow_logged = true;
+        }
+        std::shared_ptr<DeviceHealthSnapshot> stale;
+        portENTER_CRITICAL(&g_snapshot_mux);
+        stale.swap(g_snapshot);
+        portEXIT_CRITICAL(&g_snapshot_mux);
+        return;
+    }
+
+    const size_t api_len = measureJson(api_doc);
+    #if !MQTT_HEALTH_TEMPLATE
+    const size_t mqtt_len = measureJson(mqtt_doc);
+    #endif
+    const size_t needed = api_len + 1 + mqtt_len + 1;
+
+    std::shared_ptr<DeviceHealthSnapshot> snap;
+    if (g_snapshot_spare && g_snapshot_spare.use_count() == 1 && g_snapshot_spare->text_capacity >= needed) {
+        snap.swap(g_snapshot_spare);
+    } else {
+        g_snapshot_spare.reset();
+        // Headroom so small size changes between refreshes can reuse the block.
+        snap = snapshot_alloc(needed + 256);
+        if (!snap) return;
+    }
+
+    char* text = reinterpret_cast<char*>(snap.get() + 1);
+    serializeJson(api_doc, text, api_len + 1);
+    #if MQTT_HEALTH_TEMPLATE
+    memcpy(text + api_len + 1, mqtt_text, mqtt_len + 1);
+    snap->mqtt_values = mqtt_values;
+    #else
+    serializeJson(mqtt_doc, text + api_len + 1, mqtt_len + 1);
+    snap->mqtt_doc = mqtt_doc;
+    #endif
+    snap->api_json = text;
+    snap->api_len = api_len;
+    snap->mqtt_json = text + api_len + 1;
+    snap->mqtt_len = mqtt_len;
+    snap->seq = ++g_snapshot_seq;
+    snap->built_ms = millis();
+
+    portENTER_CRITICAL(&g_snapshot_mux);
+    snap.swap(g_snapshot);
+    portEXIT_CRITICAL(&g_snapshot_mux);
+
+    // `snap` now holds the previous snapshot; its references drop outside the lock.
+    g_snapshot_spare.swap(snap);
+}
+
+std::shared_ptr<const DeviceHealthSnapshot> device_telemetry_get_health_snapshot() {
+    std::shared_ptr<const DeviceHealthSnapshot> out;
+    portENTER_CRITICAL(&g_snapshot_mux);
+    out = g_snapshot;
+    portEXIT_CRITICAL(&g_snapshot_mux);
+    return out;
+}
+#endif
+
+// Background task: Calculate CPU usage every 1s (and refresh the health snapshot).
 static void cpu_monitoring_task(void* param) {
     while (true) {
-        const int new_value = calculate_cpu_usage();
+        // Walk the task list outside the lock; readers only wait for the copy.
+        static DeviceTaskStats sample;  // off the small task stack
+        const int usage = calculate_cpu_usage(&sample);
 
         xSemaphoreTake(cpu_mutex, portMAX_DELAY);
-        cpu_usage_current = new_value;
+        cpu_usage_current = usage;
+        cpu_task_stats = sample;
         xSemaphoreGive(cpu_mutex);
 
+        #if HEALTH_SNAPSHOT_ENABLED
+        refresh_health_snapshot();
+        #endif
+
         vTaskDelay(pdMS_TO_TICKS(1000));
     }
 }
@@ -580,38 +979,7 @@ void device_telemetry_start_cpu_monitoring() {
         return;
     }
     
-#if SOC_SPIRAM_SUPPORTED
-    if (heap_caps_get_total_size(MALLOC_CAP_SPIRAM) > 0) {
-        const bool ok = rtos_create_task_psram_stack(
-            cpu_monitoring_task,
-            "cpu_monitor",
-            2048,  // Stack depth (words)
-            nullptr,
-            1,  // Low priority
-            &cpu_task_handle,
-            &cpu_task_alloc
-        );
-
-        if (!ok) {
-            LOGE("CPU", "Failed to create PSRAM-backed cpu_monitor task");
-            abort();
-        }
-
-        LOGI("CPU", "Created task with PSRAM-backed stack");
-        return;
-    }
-#endif
-
-    BaseType_t result = xTaskCreate(
-        cpu_monitoring_task,
-        "cpu_monitor",
-        2048,  // Stack depth (words)
-        nullptr,
-        1,  // Low priority
-        &cpu_task_handle
-    );
-
-    if (result != pdPASS) {
+    if (!task_placement_create(AppTask::CpuMonitor, cpu_monitoring_task, nullptr, &cpu_task_handle, &cpu_task_alloc)) {
         LOGE("CPU", "Failed to create task");
         vSemaphoreDelete(cpu_mutex);
         cpu_mutex = nullptr;
@@ -628,13 +996,77 @@ int device_telemetry_get_cpu_usage() {
     return value;
 }
 
+bool device_telemetry_get_task_stats(DeviceTaskStats* out) {
+    if (!out || cpu_mutex == nullptr) return false;
+
+    xSemaphoreTake(cpu_mutex, portMAX_DELAY);
+    *out = cpu_task_stats;
+    xSemaphoreGive(cpu_mutex);
+    return out->valid;
+}
+
+bool device_telemetry_fill_tasks(JsonDocument &doc, size_t max_tasks) {
+    // Static: DeviceTaskStats is ~800 bytes and callers run on small task stacks.
+    // Callers are the web handler (async_tcp) and the MQTT task; serialize them.
+    static DeviceTaskStats stats;
+    static portMUX_TYPE fill_mux = portMUX_INITIALIZER_UNLOCKED;
+    static volatile bool fill_busy = false;
+
+    portENTER_CRITICAL(&fill_mux);
+    const bool busy = fill_busy;
+    fill_busy = true;
+    portEXIT_CRITICAL(&fill_mux);
+    if (busy) {
+        doc["available"] = false;
+        return false;
+    }
+
+    const bool ok = device_telemetry_get_task_stats(&stats);
+    doc["available"] = ok;
+    if (ok) {
+        doc["window_ms"] = stats.window_ms;
+        doc["cpu_usage"] = device_telemetry_get_cpu_usage();
+        JsonArray cores = doc.createNestedArray("cores");
+        for (uint8_t c = 0; c < stats.core_count && c < 2; c++) {
+            if (stats.core_usage[c] < 0) cores.add(nullptr);
+            else cores.add(stats.core_usage[c]);
+        }
+
+        JsonArray tasks = doc.createNestedArray("tasks");
+        const size_t n = stats.task_count < max_tasks ? stats.task_count : max_tasks;
+        for (size_t i = 0; i < n; i++) {
+            DeviceTaskStat& t = stats.tasks[i];
+            JsonObject o = tasks.createNestedObject();
+            o["name"] = t.name;  // char*: copied, stats is reused by the next call
+            o["cpu"] = (float)t.cpu_x10 / 10.0f;
+            o["stack_free_min"] = t.stack_free_min_bytes;
+            bool stack_psram = false;
+            const uint32_t budget = task_placement_stack_budget(t.name, &stack_psram);
+            if (budget > 0) {
+                o["stack_size"] = budget;
+                o["stack_used_pct"] = (t.stack_free_min_bytes >= budget) ? 0 : (uint32_t)(((budget - t.stack_free_min_bytes) * 100UL) / budget);
+                o["stack_psram"] = stack_psram;
+            }
+            o["priority"] = t.priority;
+            if (t.core < 0) o["core"] = nullptr;
+            else o["core"] = t.core;
+        }
+        doc["task_count"] = stats.task_count;
+    }
+
+    portENTER_CRITICAL(&fill_mux);
+    fill_busy = false;
+    portEXIT_CRITICAL(&fill_mux);
+    return ok;
+}
+
 void device_telemetry_start_health_window_sampling() {
     if (g_health_window_timer != nullptr) return;
 
     health_window_reset();
     g_health_window_timer = xTimerCreate(
         "health_win",
-        pdMS_TO_TICKS(kHealthWindowSamplePeriodMs),
+        pdMS_TO_TICKS(HEALTH_WINDOW_SAMPLE_MS),
         pdTRUE,
         nullptr,
         health_window_timer_cb
@@ -645,6 +1077,9 @@ void device_telemetry_start_health_window_sampling() {
         return;
     }
 
+    // First sample right away so the bands exist before the first period elapsed.
+    health_window_timer_cb(nullptr);
+
     if (xTimerStart(g_health_window_timer, 0) != pdPASS) {
         LOGE("Health", "Failed to start health window timer");
         xTimerDelete(g_health_window_timer, 0);
@@ -655,10 +1090,29 @@ void device_telemetry_start_health_window_sampling() {
 
 static void fill_health_window_fields(JsonDocument &doc) {
     HealthWindowComputed c = {};
-    if (!compute_health_window_computed(&c)) {
+    if (!health_window_read(&c)) {
         return;
     }
 
+    // Widen by the point-in-time fields already in `doc` so the band always contains
+    // them, even between samples (no second heap scan).
+    const uint32_t internal_free_now = doc["heap_internal_free"] | c.heap_internal_free_min_window;
+    const uint32_t internal_largest_now = doc["heap_largest"] | c.heap_internal_largest_min_window;
+    const int internal_frag_now = doc["heap_fragmentation"] | 0;
+    const uint32_t psram_free_now = doc["psram_free"] | c.psram_free_min_window;
+    const uint32_t psram_largest_now = doc["psram_largest"] | c.psram_largest_min_window;
+    const int psram_frag_now = doc["psram_fragmentation"] | 0;
+
+    if (internal_free_now < c.heap_internal_free_min_window) c.heap_internal_free_min_window = internal_free_now;
+    if (internal_free_now > c.heap_internal_free_max_window) c.heap_internal_free_max_window = internal_free_now;
+    if (internal_largest_now < c.heap_internal_largest_min_window) c.heap_internal_largest_min_window = internal_largest_now;
+    if (internal_largest_now > c.heap_internal_largest_max_window) c.heap_internal_largest_max_window = internal_largest_now;
+    if (internal_frag_now > c.heap_fragmentation_max_window) c.heap_fragmentation_max_window = internal_frag_now;
+    if (psram_free_now < c.psram_free_min_window) c.psram_free_min_window = psram_free_now;
+    if (psram_free_now > c.psram_free_max_window) c.psram_free_max_window = psram_free_now;
+    if (psram_largest_now < c.psram_largest_min_window) c.psram_largest_min_window = psram_largest_now;
+    if (psram_frag_now > c.psram_fragmentation_max_window) c.psram_fragmentation_max_window = psram_frag_now;
+
     doc["heap_internal_free_min_window"] = c.heap_internal_free_min_window;
     doc["heap_internal_free_max_window"] = c.heap_internal_free_max_window;
     doc["heap_internal_largest_min_window"] = c.heap_internal_largest_min_window;
@@ -671,124 +1125,10 @@ static void fill_health_window_fields(JsonDocument &doc) {
     doc["psram_fragmentation_max_window"] = c.psram_fragmentation_max_window;
 }
 
-static bool compute_health_window_computed(HealthWindowComputed* out) {
-    if (!out) return false;
-
-    HealthWindowStats last = {};
-    HealthWindowStats current = {};
-    bool has_last = false;
-    unsigned long current_start_ms = 0;
-    unsigned long last_start_ms = 0;
-    unsigned long last_end_ms = 0;
-
-    health_window_get_snapshot(&last, &has_last, &current, &current_start_ms, &last_start_ms, &last_end_ms);
-
-    // Also fold in instantaneous request-time values to guarantee the returned
-    // band contains the point-in-time fields, even between 200ms samples.
-    size_t heap_free_now = 0;
-    size_t heap_min_now = 0;
-    size_t heap_largest_now = 0;
-    size_t internal_free_now = 0;
-    size_t internal_min_now = 0;
-    size_t psram_free_now = 0;
-    size_t psram_min_now = 0;
-    size_t psram_largest_now = 0;
-    get_memory_snapshot(
-        &heap_free_now,
-        &heap_min_now,
-        &heap_largest_now,
-        &internal_free_now,
-        &internal_min_now,
-        &psram_free_now,
-        &psram_min_now,
-        &psram_largest_now
-    );
-    const int internal_frag_now = compute_fragmentation_percent(internal_free_now, heap_largest_now);
-    const int psram_frag_now = compute_fragmentation_percent(psram_free_now, psram_largest_now);
-
-    // Merge last-complete and current-in-progress windows.
-    // This is conservative (can be slightly wider than a strict "last N seconds" window),
-    // but avoids missing spikes without extra RAM.
-    HealthWindowStats merged = {};
-
-    const bool has_current = current.initialized;
-    const bool has_any = (has_current || (has_last && last.initialized));
-    if (has_any) {
-        merged.initialized = true;
-
-        // Start from whichever window is present.
-        const HealthWindowStats* base = has_current ? &current : &last;
-        merged.internal_free_min = base->internal_free_min;
-        merged.internal_free_max = base->internal_free_max;
-        merged.internal_largest_min = base->internal_largest_min;
-        merged.internal_largest_max = base->internal_largest_max;
-        merged.internal_frag_max = base->internal_frag_max;
-
-        merged.psram_free_min = base->psram_free_min;
-        merged.psram_free_max = base->psram_free_max;
-        merged.psram_largest_min = base->psram_largest_min;
-        merged.psram_frag_max = base->psram_frag_max;
-
-        if (has_current && has_last && last.initialized) {
-            if (last.internal_free_min < merged.internal_free_min) merged.internal_free_min = last.internal_free_min;
-            if (last.internal_free_max > merged.internal_free_max) merged.internal_free_max = last.internal_free_max;
-            if (last.internal_largest_min < merged.internal_largest_min) merged.internal_largest_min = last.internal_largest_min;
-            if (last.internal_largest_max > merged.internal_largest_max) merged.internal_largest_max = last.internal_largest_max;
-            if (last.internal_frag_max > merged.internal_frag_max) merged.internal_frag_max = last.internal_frag_max;
-
-            if (last.psram_free_min < merged.psram_free_min) merged.psram_free_min = last.psram_free_min;
-            if (last.psram_free_max > merged.psram_free_max) merged.psram_free_max = last.psram_free_max;
-            if (last.psram_largest_min < merged.psram_largest_min) merged.psram_largest_min = last.psram_largest_min;
-            if (last.psram_frag_max > merged.psram_frag_max) merged.psram_frag_max = last.psram_frag_max;
-        }
-    }
-
-    if (!merged.initialized) {
-        // Early boot: initialize from instantaneous values.
-        merged.initialized = true;
-        merged.internal_free_min = internal_free_now;
-        merged.internal_free_max = internal_free_now;
-        merged.internal_largest_min = heap_largest_now;
-        merged.internal_largest_max = heap_largest_now;
-        merged.internal_frag_max = internal_frag_now;
-
-        merged.psram_free_min = psram_free_now;
-        merged.psram_free_max = psram_free_now;
-        merged.psram_largest_min = psram_largest_now;
-        merged.psram_frag_max = psram_frag_now;
-    }
-
-    // Guarantee the instantaneous request-time values are within the returned band.
-    if (internal_free_now < merged.internal_free_min) merged.internal_free_min = internal_free_now;
-    if (internal_free_now > merged.internal_free_max) merged.internal_free_max = internal_free_now;
-    if (heap_largest_now < merged.internal_largest_min) merged.internal_largest_min = heap_largest_now;
-    if (heap_largest_now > merged.internal_largest_max) merged.internal_largest_max = heap_largest_now;
-    if (internal_frag_now > merged.internal_frag_max) merged.internal_frag_max = internal_frag_now;
-
-    if (psram_free_now < merged.psram_free_min) merged.psram_free_min = psram_free_now;
-    if (psram_free_now > merged.psram_free_max) merged.psram_free_max = psram_free_now;
-    if (psram_largest_now < merged.psram_largest_min) merged.psram_largest_min = psram_largest_now;
-    if (psram_frag_now > merged.psram_frag_max) merged.psram_frag_max = psram_frag_now;
-
-    out->heap_internal_free_min_window = (uint32_t)merged.internal_free_min;
-    out->heap_internal_free_max_window = (uint32_t)merged.internal_free_max;
-
-    out->heap_internal_largest_min_window = (uint32_t)merged.internal_largest_min;
-    out->heap_internal_largest_max_window = (uint32_t)merged.internal_largest_max;
-    out->heap_fragmentation_max_window = merged.internal_frag_max;
-
-    out->psram_free_min_window = (uint32_t)merged.psram_free_min;
-    out->psram_free_max_window = (uint32_t)merged.psram_free_max;
-    out->psram_largest_min_window = (uint32_t)merged.psram_largest_min;
-    out->psram_fragmentation_max_window = merged.psram_frag_max;
-
-    return true;
-}
-
 bool device_telemetry_get_health_window_bands(DeviceHealthWindowBands* out_bands) {
     if (!out_bands) return false;
     HealthWindowComputed c = {};
-    if (!compute_health_window_computed(&c)) return false;
+    if (!health_window_read(&c)) return false;
 
     out_bands->heap_internal_free_min_window = c.heap_internal_free_min_window;
     out_bands->heap_internal_free_max_window = c.heap_internal_free_max_window;
@@ -799,15 +1139,9 @@ bool device_telemetry_get_health_window_bands(DeviceHealthWindowBands* out_bands
     return true;
 }
 
-static void fill_common(JsonDocument &doc, bool include_ip_and_channel, bool include_debug_fields, bool include_mqtt_self_report) {
-    // System
-    uint64_t uptime_us = esp_timer_get_time();
-    doc["uptime_seconds"] = uptime_us / 1000000;
-
-    // Reset reason
-    esp_reset_reason_t reset_reason = esp_reset_reason();
+static const char* reset_reason_string() {
     const char* reset_str = "Unknown";
-    switch (reset_reason) {
+    switch (esp_reset_reason()) {
         case ESP_RST_POWERON:   reset_str = "Power On"; break;
         case ESP_RST_SW:        reset_str = "Software"; break;
         case ESP_RST_PANIC:     reset_str = "Panic"; break;
@@ -819,7 +1153,39 @@ static void fill_common(JsonDocument &doc, bool include_ip_and_channel, bool inc
         case ESP_RST_SDIO:      reset_str = "SDIO"; break;
         default: break;
     }
-    doc["reset_reason"] = reset_str;
+    return reset_str;
+}
+
+// SoC temperature; false when the sensor is missing or the read failed.
+static bool read_cpu_temperature(int* out_celsius) {
+#if SOC_TEMP_SENSOR_SUPPORTED
+    float temp_celsius = 0;
+    bool ok = false;
+    temperature_sensor_handle_t temp_sensor = NULL;
+    temperature_sensor_config_t temp_sensor_config = TEMPERATURE_SENSOR_CONFIG_DEFAULT(-10, 80);
+
+    if (temperature_sensor_install(&temp_sensor_config, &temp_sensor) == ESP_OK) {
+        if (temperature_sensor_enable(temp_sensor) == ESP_OK) {
+            ok = temperature_sensor_get_celsius(temp_sensor, &temp_celsius) == ESP_OK;
+            temperature_sensor_disable(temp_sensor);
+        }
+        temperature_sensor_uninstall(temp_sensor);
+    }
+    if (ok) *out_celsius = (int)temp_celsius;
+    return ok;
+#else
+    (void)out_celsius;
+    return false;
+#endif
+}
+
+static void fill_common(JsonDocument &doc, bool include_ip_and_channel, bool include_debug_fields, bool include_mqtt_self_report) {
+    // System
+    uint64_t uptime_us = esp_timer_get_time();
+    doc["uptime_seconds"] = uptime_us / 1000000;
+
+    // Reset reason
+    doc["reset_reason"] = reset_reason_string();
 
     // CPU (API includes cpu_freq; MQTT keeps payload smaller)
     if (include_debug_fields) {
@@ -835,29 +1201,12 @@ static void fill_common(JsonDocument &doc, bool include_ip_and_channel, bool inc
     }
 
     // CPU / SoC temperature
-#if SOC_TEMP_SENSOR_SUPPORTED
-    float temp_celsius = 0;
-    temperature_sensor_handle_t temp_sensor = NULL;
-    temperature_sensor_config_t temp_sensor_config = TEMPERATURE_SENSOR_CONFIG_DEFAULT(-10, 80);
-
-    if (temperature_sensor_install(&temp_sensor_config, &temp_sensor) == ESP_OK) {
-        if (temperature_sensor_enable(temp_sensor) == ESP_OK) {
-            if (temperature_sensor_get_celsius(temp_sensor, &temp_celsius) == ESP_OK) {
-                doc["cpu_temperature"] = (int)temp_celsius;
-            } else {
-                doc["cpu_temperature"] = nullptr;
-            }
-            temperature_sensor_disable(temp_sensor);
-        } else {
-            doc["cpu_temperature"] = nullptr;
-        }
-        temperature_sensor_uninstall(temp_sensor);
+    int temp_celsius = 0;
+    if (read_cpu_temperature(&temp_celsius)) {
+        doc["cpu_temperature"] = temp_celsius;
     } else {
         doc["cpu_temperature"] = nullptr;
     }
-#else
-    doc["cpu_temperature"] = nullptr;
-#endif
 
     // Memory
     size_t heap_free = 0;
@@ -943,6 +1292,279 @@ static void fill_common(JsonDocument &doc, bool include_ip_and_channel, bool inc
         }
     }
 
+    #if LOG_ASYNC_ENABLED
+    // Async logger: lines lost to a full ring (web API only)
+    if (include_mqtt_self_report) {
+        doc["log_dropped"] = log_dropped_count();
+    }
+    #endif
+
+    // Last WiFi connect phase timings (web API only)
+    if (include_mqtt_self_report) {
+        WifiFastConnectStats wfc;
+        wifi_fast_connect_get_stats(&wfc);
+        doc["wifi_connect_ms"] = wfc.last.total_ms;
+        doc["wifi_connect_scan_ms"] = wfc.last.scan_ms;
+        doc["wifi_connect_assoc_ms"] = wfc.last.assoc_ms;
+        doc["wifi_connect_fast"] = wfc.last.fast;
+        doc["wifi_fast_ok"] = wfc.fast_ok;
+        doc["wifi_fast_failed"] = wfc.fast_failed;
+    }
+
+    // Deferred config changes not yet written to NVS (web API only)
+    if (include_mqtt_self_report) {
+        doc["config_dirty"] = config_manager_is_dirty();
+    }
+
+    #if WEB_PORTAL_ADMISSION_ENABLED
+    // Web portal admission control (web API only)
+    if (include_mqtt_self_report) {
+        PortalAdmissionStats adm;
+        web_portal_admission_get_stats(&adm);
+        uint32_t in_flight = 0, admitted = 0, busy = 0, low_heap = 0;
+        for (size_t i = 0; i < (size_t)PortalRouteClass::Count; i++) {
+            in_flight += adm.cls[i].in_flight;
+            admitted += adm.cls[i].admitted;
+            busy += adm.cls[i].rejected_busy;
+            low_heap += adm.cls[i].rejected_heap;
+        }
+        doc["http_in_flight"] = in_flight;
+        doc["http_admitted"] = admitted;
+        doc["http_rejected_busy"] = busy;
+        doc["http_rejected_heap"] = low_heap;
+    }
+    #endif
+
+    #if HAS_IMAGE_API && IMAGE_URL_CACHE_ENABLED
+    // image_url flash cache (web API only; counters only, never mounts from here)
+    if (include_mqtt_self_report) {
+        ImageCacheStats ic;
+        image_cache_get_stats(&ic);
+        if (ic.mounted) {
+            doc["image_cache_entries"] = ic.entries;
+            doc["image_cache_bytes"] = ic.bytes;
+            doc["image_cache_hits"] = ic.hits;
+            doc["image_cache_misses"] = ic.misses;
+        }
+    }
+    #endif
+
+    #if HAS_IMAGE_API
+    // Image buffer arena (web API only)
+    if (include_mqtt_self_report) {
+        ImageArenaStats ia;
+        image_arena_get_stats(&ia);
+        if (ia.capacity > 0) {
+            doc["image_arena_bytes"] = ia.capacity;
+            doc["image_arena_used"] = ia.used;
+            doc["image_arena_peak"] = ia.peak;
+            doc["image_arena_largest_free"] = ia.largest_free;
+            doc["image_arena_fallbacks"] = ia.fallbacks;
+        }
+    }
+
+    // image_url keep-alive pool (web API only)
+    if (include_mqtt_self_report) {
+        ImageHttpPoolStats hp;
+        image_http_pool_get_stats(&hp);
+        doc["image_http_connects"] = hp.connects;
+        doc["image_http_reuses"] = hp.reuses;
+        doc["image_http_idle"] = hp.idle_open;
+    }
+
+    // StripDecoder sessions since boot, and which push path they took (web API only)
+    if (include_mqtt_self_report) {
+        StripDecodeStats sd;
+        strip_decoder_get_stats(&sd);
+        doc["strip_sessions"] = sd.sessions;
+        doc["strip_decoded"] = sd.total.strips;
+        doc["strip_failed"] = sd.total.failed;
+        doc["strip_bytes_in"] = sd.total.bytes_in;
+        doc["strip_pixels_out"] = sd.total.pixels_out;
+        doc["strip_decode_us"] = sd.total.decode_us;
+        doc["strip_push_us"] = sd.total.push_us;
+        doc["strip_yields"] = sd.total.yields;
+        doc["strip_async_rects"] = sd.total.async_rects;
+        doc["strip_batch_rects"] = sd.total.batch_rects;
+        doc["strip_line_rows"] = sd.total.line_rows;
+        doc["strip_line_fallback_sessions"] = sd.line_fallback_sessions;
+        doc["strip_batch_rows"] = sd.current.batch_rows;
+    }
+    #endif
+
+    #if IMAGE_REFRESH_SUPPORTED
+    // Scheduled image refresh (web API only)
+    if (include_mqtt_self_report) {
+        ImageRefreshStats rs;
+        image_refresh_get_stats(&rs);
+        doc["image_refresh_fetches"] = rs.fetches;
+        doc["image_refresh_not_modified"] = rs.not_modified;
+        doc["image_refresh_unchanged"] = rs.unchanged;
+        doc["image_refresh_redraws"] = rs.redraws;
+        doc["image_refresh_errors"] = rs.errors;
+    }
+    #endif
+
+    #if P1_METER_SUPPORTED
+    // Local P1 meter polling (web API only)
+    if (include_mqtt_self_report) {
+        P1MeterStats ps;
+        p1_meter_get_stats(&ps);
+        doc["p1_polls"] = ps.polls;
+        doc["p1_errors"] = ps.errors;
+        doc["p1_connects"] = ps.connects;
+        doc["p1_rtt_ms"] = ps.last_rtt_ms;
+    }
+    #endif
+
+    #if ENERGY_FASTPATH_SUPPORTED
+    // UDP multicast / ESP-NOW energy frames (web API only)
+    if (include_mqtt_self_report) {
+        EnergyFastpathStats fs;
+        energy_fastpath_get_stats(&fs);
+        doc["fastpath_frames"] = fs.frames;
+        doc["fastpath_applied"] = fs.applied;
+        doc["fastpath_stale"] = fs.stale;
+        doc["fastpath_malformed"] = fs.malformed;
+    }
+    #endif
+
+    #if ENERGY_LATENCY_SUPPORTED
+    // MQTT-to-pixel latency of energy values (web API only)
+    if (include_mqtt_self_report) {
+        static const char* const kStageKeys[(size_t)EnergyLatencyStage::Count][3] = {
+            {"energy_latency_rx_store_p50_us", "energy_latency_rx_store_p95_us", "energy_latency_rx_store_max_us"},
+            {"energy_latency_store_pickup_p50_us", "energy_latency_store_pickup_p95_us", "energy_latency_store_pickup_max_us"},
+            {"energy_latency_pickup_flush_p50_us", "energy_latency_pickup_flush_p95_us", "energy_latency_pickup_flush_max_us"},
+            {"energy_latency_flush_present_p50_us", "energy_latency_flush_present_p95_us", "energy_latency_flush_present_max_us"},
+            {"energy_latency_total_p50_us", "energy_latency_total_p95_us", "energy_latency_total_max_us"},
+        };
+        EnergyLatencyStats el;
+        if (energy_latency_get_stats(&el)) {
+            doc["energy_latency_samples"] = el.samples;
+            doc["energy_latency_dropped"] = el.dropped;
+            for (size_t i = 0; i < (size_t)EnergyLatencyStage::Count; i++) {
+                doc[kStageKeys[i][0]] = el.stage[i].p50_us;
+                doc[kStageKeys[i][1]] = el.stage[i].p95_us;
+                doc[kStageKeys[i][2]] = el.stage[i].max_us;
+            }
+        }
+    }
+    #endif
+
+    // Gated energy alarm (web API only; MQTT has its own <base>/energy/alarm topic)
+    if (include_mqtt_self_report) {
+        const EnergyAlarmState alarm = energy_alarm_get_state();
+        doc["energy_alarm_active"] = alarm.active;
+        doc["energy_alarm_episodes"] = alarm.episodes;
+    }
+
+    // WiFi power-save profile and per-profile link quality (web API only)
+    if (include_mqtt_self_report) {
+        WifiPowerStats wp;
+        wifi_power_get_stats(&wp);
+        JsonObject w = doc.createNestedObject("wifi_power");
+        w["profile"] = wifi_power_profile_name(wp.current);
+        for (size_t i = 0; i < (size_t)WifiPowerProfile::Count; i++) {
+            const WifiPowerProfileStats& ps = wp.profile[i];
+            if (ps.active_ms == 0) continue;
+            JsonObject p = w.createNestedObject(wifi_power_profile_name((WifiPowerProfile)i));
+            p["active_s"] = ps.active_ms / 1000;
+            if (ps.rssi_samples > 0) p["rssi_avg"] = ps.rssi_avg_dbm;
+            p["disconnects"] = ps.disconnects;
+            p["rtt_samples"] = ps.rtt_samples;
+            p["rtt_lost"] = ps.rtt_lost;
+            if (ps.rtt_samples > 0) {
+                p["rtt_avg_ms"] = ps.rtt_avg_ms;
+                p["rtt_max_ms"] = ps.rtt_max_ms;
+            }
+        }
+    }
+
+    #if APP_ALLOC_ACCOUNTING
+    // Per-subsystem heap accounting of app_alloc (web API only)
+    if (include_mqtt_self_report) {
+        JsonObject alloc = doc.createNestedObject("alloc");
+        for (size_t i = 0; i < (size_t)AllocTag::Count; i++) {
+            AllocTagStats as;
+            app_alloc_get_stats((AllocTag)i, &as);
+            if (as.allocs == 0 && as.failed == 0) continue;
+            JsonObject t = alloc.createNestedObject(app_alloc_tag_name((AllocTag)i));
+            t["live"] = as.live_bytes;
+            t["peak"] = as.peak_bytes;
+            t["psram"] = as.live_psram_bytes;
+            t["allocs"] = as.allocs;
+            t["failed"] = as.failed;
+        }
+    }
+    #endif
+
+    // Request-scoped JSON document arenas of the API handlers (web API only)
+    if (include_mqtt_self_report) {
+        JsonArenaStats js;
+        json_arena_get_stats(&js);
+        JsonObject ja = doc.createNestedObject("json_arena");
+        ja["slots"] = js.slots;
+        ja["in_use"] = js.in_use;
+        ja["peak_in_use"] = js.peak_in_use;
+        ja["checkouts"] = js.checkouts;
+        ja["fallbacks"] = js.fallbacks;
+        ja["peak_request"] = js.peak_request;
+    }
+
+    #if HAS_DISPLAY && LVGL_LOCK_STATS
+    // LVGL mutex wait/hold per caller site (web API only)
+    if (include_mqtt_self_report) {
+        JsonObject locks = doc.createNestedObject("lvgl_lock");
+        for (size_t i = 0; i < (size_t)LvglLockSite::Count; i++) {
+            LvglLockSiteStats ls;
+            if (!lvgl_lock_stats_get((LvglLockSite)i, &ls)) continue;
+            JsonObject s = locks.createNestedObject(lvgl_lock_site_name((LvglLockSite)i));
+            s["acquisitions"] = ls.acquisitions;
+            s["contended"] = ls.contended;
+            s["timeouts"] = ls.timeouts;
+            s["long_holds"] = ls.long_holds;
+            s["wait_max_us"] = ls.wait_max_us;
+            s["hold_max_us"] = ls.hold_max_us;
+            JsonArray wait = s.createNestedArray("wait_hist");
+            JsonArray hold = s.createNestedArray("hold_hist");
+            for (uint8_t b = 0; b < kLvglLockBuckets; b++) {
+                wait.add(ls.wait_hist[b]);
+                hold.add(ls.hold_hist[b]);
+            }
+        }
+    }
+    #endif
+
+    #if HAS_DISPLAY && LVGL_MEM_POOL_BYTES > 0
+    // Dedicated LVGL TLSF pool (web API only)
+    if (include_mqtt_self_report) {
+        LvglHeapStats lh;
+        lvgl_heap_get_stats(&lh);
+        if (lh.pool) {
+            doc["lvgl_pool_bytes"] = lh.total;
+            doc["lvgl_pool_psram"] = lh.pool_in_psram;
+            doc["lvgl_pool_used"] = lh.used;
+            doc["lvgl_pool_free"] = lh.free;
+            doc["lvgl_pool_largest_free"] = lh.largest_free;
+            doc["lvgl_pool_max_used"] = lh.max_used;
+            doc["lvgl_pool_frag_pct"] = lh.frag_pct;
+        }
+    }
+    #endif
+
+    #if LVGL_IMAGE_CACHE_SUPPORTED
+    // Decoded-image cache of the LVGL image screen (web API only)
+    if (include_mqtt_self_report) {
+        LvglImageCacheStats lc;
+        lvgl_image_cache_get_stats(&lc);
+        doc["lvgl_image_cache_hits"] = lc.hits;
+        doc["lvgl_image_cache_misses"] = lc.misses;
+        doc["lvgl_image_cache_bytes"] = lc.bytes;
+        doc["lvgl_image_cache_entries"] = lc.entries;
+    }
+    #endif
+
     // MQTT health (self-report)
     // Only included in the web API (/api/health). For MQTT consumers, availability/LWT is a better
     // source of truth, and retained state can make connection booleans misleading.
@@ -961,6 +1583,39 @@ static void fill_common(JsonDocument &doc, bool include_ip_and_channel, bool inc
                 doc["mqtt_last_health_publish_ms"] = last_pub;
                 doc["mqtt_health_publish_age_ms"] = (unsigned long)(millis() - last_pub);
             }
+
+            doc["mqtt_health_publishes_suppressed"] = mqtt_manager.healthPublishesSuppressed();
+
+            doc["mqtt_tls"] = mqtt_manager.tlsEnabled() ? true : false;
+            #if MQTT_TLS_ENABLED
+            if (mqtt_manager.tlsEnabled()) {
+                MqttTlsStats tls = {};
+                mqtt_manager.getTlsStats(&tls);
+                doc["mqtt_tls_handshakes"] = tls.handshakes;
+                doc["mqtt_tls_resumed"] = tls.resumed;
+                doc["mqtt_tls_failures"] = tls.failures;
+                doc["mqtt_tls_handshake_ms"] = tls.last_handshake_ms;
+                doc["mqtt_tls_heap_bytes"] = tls.last_heap_bytes;
+                doc["mqtt_tls_session_cached"] = tls.session_cached ? true : false;
+            }
+            #endif
+
+            MqttOutboundStats out = {};
+            mqtt_manager.getOutboundStats(&out);
+            doc["mqtt_outbound_depth"] = out.depth;
+            doc["mqtt_outbound_high_water"] = out.high_water;
+            doc["mqtt_outbound_dropped"] = out.dropped_full + out.dropped_oversize + out.send_failed;
+
+            MqttEnergyStartStats es = {};
+            mqtt_manager.getEnergyStartStats(&es);
+            if (es.first_value_ms == 0) {
+                doc["mqtt_energy_first_value_ms"] = nullptr;
+            } else {
+                doc["mqtt_energy_first_value_ms"] = es.first_value_ms;
+            }
+            doc["mqtt_energy_first_value_max_ms"] = es.first_value_max_ms;
+            doc["mqtt_energy_connects"] = es.connects;
+            doc["mqtt_energy_refresh_requests"] = es.refresh_requests;
         }
         #else
         doc["mqtt_enabled"] = false;
@@ -968,6 +1623,12 @@ static void fill_common(JsonDocument &doc, bool include_ip_and_channel, bool inc
         doc["mqtt_connected"] = false;
         doc["mqtt_last_health_publish_ms"] = nullptr;
         doc["mqtt_health_publish_age_ms"] = nullptr;
+        doc["mqtt_health_publishes_suppressed"] = 0;
+        doc["mqtt_tls"] = false;
+        doc["mqtt_outbound_depth"] = 0;
+        doc["mqtt_outbound_high_water"] = 0;
+        doc["mqtt_outbound_dropped"] = 0;
+        doc["mqtt_energy_first_value_ms"] = nullptr;
         #endif
     }
 
@@ -979,6 +1640,27 @@ static void fill_common(JsonDocument &doc, bool include_ip_and_channel, bool inc
             doc["display_fps"] = stats.fps;
             doc["display_lv_timer_us"] = stats.lv_timer_us;
             doc["display_present_us"] = stats.present_us;
+
+            // Rolling distributions. MQTT gets the tail (p95/max) + bus throughput to
+            // keep the payload within MQTT_MAX_PACKET_SIZE; the API gets everything.
+            doc["display_lv_timer_p95_us"] = stats.lv_timer_dist_us.p95;
+            doc["display_lv_timer_max_us"] = stats.lv_timer_dist_us.max;
+            doc["display_flush_p95_us"] = stats.flush_dist_us.p95;
+            doc["display_flush_max_us"] = stats.flush_dist_us.max;
+            doc["display_bus_bytes_per_s"] = stats.bus_bytes_per_s;
+            if (include_debug_fields) {
+                doc["display_lv_timer_p50_us"] = stats.lv_timer_dist_us.p50;
+                doc["display_flush_p50_us"] = stats.flush_dist_us.p50;
+                doc["display_flush_px_p50"] = stats.flush_dist_px.p50;
+                doc["display_flush_px_p95"] = stats.flush_dist_px.p95;
+                doc["display_flush_px_max"] = stats.flush_dist_px.max;
+                doc["display_draw_buf_px"] = stats.draw_buf_px;
+                doc["display_draw_buf_lines"] = stats.draw_buf_lines;
+                doc["display_draw_buf_count"] = stats.draw_buf_count;
+                doc["display_cmd_posted"] = stats.cmd_posted;
+                doc["display_cmd_dropped"] = stats.cmd_dropped;
+                doc["display_cmd_queue_peak"] = stats.cmd_queue_peak;
+            }
         } else {
             doc["display_fps"] = nullptr;
             doc["display_lv_timer_us"] = nullptr;
@@ -1,7 +1,10 @@
 #ifndef DEVICE_TELEMETRY_H
 #define DEVICE_TELEMETRY_H
 
+#include "board_config.h"
+
 #include <ArduinoJson.h>
+#include <memory>
 
 struct DeviceMemorySnapshot {
 	size_t heap_free_bytes;
@@ -27,6 +30,100 @@ struct DeviceHealthWindowBands {
 	uint32_t heap_internal_largest_max_window;
 };
 
+// Per-task CPU breakdown (/api/health/tasks), refreshed with cpu_usage every ~1 s.
+static constexpr size_t kDeviceTelemetryMaxTasks = 24;
+
+struct DeviceTaskStat {
+	char name[16];
+	uint16_t cpu_x10;               // share of one core since the previous sample, x10
+	uint32_t stack_free_min_bytes;  // stack high-water mark (lowest free stack ever)
+	uint8_t priority;
+	int8_t core;                    // pinned core, -1 = not pinned / unknown
+};
+
+struct DeviceTaskStats {
+	bool valid;
+	uint32_t window_ms;             // time covered by the deltas
+	uint8_t core_count;
+	int16_t core_usage[2];          // per-core utilization percent, -1 = unknown
+	uint8_t task_count;
+	DeviceTaskStat tasks[kDeviceTelemetryMaxTasks];  // busiest first
+};
+
+// JsonDocument capacities for the /api/health and MQTT health documents.
+// LVGL lock stats add up to ~2 KB (every site reporting), StripDecoder counters ~256 B.
+static constexpr size_t kDeviceTelemetryApiDocCapacity =
+    4864 + ((HAS_DISPLAY && LVGL_LOCK_STATS) ? 2048 : 0) + (HAS_IMAGE_API ? 256 : 0);
+static constexpr size_t kDeviceTelemetryMqttDocCapacity = 768;
+
+#if MQTT_HEALTH_TEMPLATE
+// Numeric fields of the MQTT health payload, in payload order (reset_reason is
+// constant per boot and lives in the skeleton). Slots must stay in step with
+// kMqttHealthKeys in device_telemetry.cpp.
+enum class MqttHealthSlot : uint8_t {
+	UptimeSeconds,
+	CpuUsage,
+	CpuTemperature,
+	HeapFree,
+	HeapMin,
+	HeapLargest,
+	HeapInternalFree,
+	HeapInternalMin,
+	HeapInternalLargest,
+	PsramFree,
+	PsramMin,
+	PsramLargest,
+	HeapFragmentation,
+	PsramFragmentation,
+	FlashUsed,
+	FlashTotal,
+	FsMounted,
+	FsUsedBytes,
+	FsTotalBytes,
+	DisplayFps,
+	DisplayLvTimerUs,
+	DisplayPresentUs,
+#if HAS_DISPLAY
+	DisplayLvTimerP95Us,
+	DisplayLvTimerMaxUs,
+	DisplayFlushP95Us,
+	DisplayFlushMaxUs,
+	DisplayBusBytesPerS,
+#endif
+	WifiRssi,
+	// USER-EXTEND: custom MQTT sensors get a slot here (see device_telemetry_collect_mqtt()).
+	Count
+};
+
+// One value per slot; kJsonTemplateNull (json_template.h) publishes null.
+struct DeviceHealthValues {
+	int64_t v[(size_t)MqttHealthSlot::Count];
+};
+#endif
+
+#if HEALTH_SNAPSHOT_ENABLED
+// Immutable, pre-serialized health documents built by the CPU monitoring task
+// (~1 Hz) and shared by every /api/health request and MQTT health publish.
+struct DeviceHealthSnapshot {
+	uint32_t seq;                   // increments per refresh
+	unsigned long built_ms;         // millis() when built
+	const char* api_json;           // /api/health body (device_telemetry_fill_api)
+	size_t api_len;
+	const char* mqtt_json;          // MQTT health/state payload (device_telemetry_fill_mqtt)
+	size_t mqtt_len;
+#if MQTT_HEALTH_TEMPLATE
+	DeviceHealthValues mqtt_values;  // raw values behind mqtt_json, for delta publishing
+#else
+	StaticJsonDocument<kDeviceTelemetryMqttDocCapacity> mqtt_doc;  // parsed form for delta publishing
+#endif
+	size_t text_capacity;           // bytes reserved behind the struct for both JSON strings
+};
+
+// Latest snapshot, or nullptr until the first refresh finished. Holding the pointer
+// keeps the snapshot alive; it is never modified after publication.
+std::shared_ptr<const DeviceHealthSnapshot> device_telemetry_get_health_snapshot();
+#endif
+
 // Initializes cached values used by device telemetry (safe to call multiple times).
 // This exists to avoid re-entrant calls into ESP-IDF image helpers from different tasks.
 void device_telemetry_init();
@@ -42,24 +139,49 @@ void device_telemetry_fill_api(JsonDocument &doc);
 // Intentionally excludes volatile/low-value fields like IP address.
 void device_telemetry_fill_mqtt(JsonDocument &doc);
 
+// Delta publishing (MQTT_HEALTH_DELTA_PUBLISH): true when any field of `cur`
+// moved past its deadband relative to the last published `prev`. Fields without a
+// deadband compare exactly; uptime_seconds is ignored (the keepalive covers it).
+bool device_telemetry_mqtt_changed(const JsonDocument &prev, const JsonDocument &cur);
+
+#if MQTT_HEALTH_TEMPLATE
+// Gather the MQTT health fields without building a JsonDocument.
+void device_telemetry_collect_mqtt(DeviceHealthValues* out);
+
+// Render `values` into `out` from the pre-built health skeleton (NUL-terminated).
+// Returns the length, 0 when `cap` is too small for the widest possible payload.
+size_t device_telemetry_render_mqtt(const DeviceHealthValues &values, char *out, size_t cap);
+
+// Same deadbands as device_telemetry_mqtt_changed(), compared slot by slot.
+bool device_telemetry_mqtt_values_changed(const DeviceHealthValues &prev, const DeviceHealthValues &cur);
+#endif
+
 // Get current CPU usage percentage (0-100).
 // Returns -1 when runtime stats are unavailable (treated as unknown).
 int device_telemetry_get_cpu_usage();
 
+// Copy the latest per-task breakdown. Returns false until two samples were taken
+// (or when runtime stats are unavailable).
+bool device_telemetry_get_task_stats(DeviceTaskStats* out);
+
+// Fill `doc` with the per-task breakdown (busiest `max_tasks` tasks).
+// Returns false (and sets "available": false) when no breakdown exists yet.
+bool device_telemetry_fill_tasks(JsonDocument &doc, size_t max_tasks);
+
 // Initialize CPU monitoring background task.
 // Must be called once during setup.
 void device_telemetry_start_cpu_monitoring();
 
-// Start 200ms health-window sampling (min/max fields between /api/health polls).
+// Start health-window sampling every HEALTH_WINDOW_SAMPLE_MS (min/max fields between /api/health polls).
 // Must be called once during setup.
 void device_telemetry_start_health_window_sampling();
 
 // Capture a point-in-time memory snapshot (heap/internal heap/PSRAM).
 DeviceMemorySnapshot device_telemetry_get_memory_snapshot();
 
-// Capture a merged snapshot of the current health-window band values.
-// Returns false if bands are unavailable (early boot), in which case callers should
-// fall back to instantaneous values.
+// Copy the merged health-window band values (precomputed by the sampler; lock-free,
+// O(1), callable from any task). Returns false if bands are unavailable (early boot),
+// in which case callers should fall back to instantaneous values.
 bool device_telemetry_get_health_window_bands(DeviceHealthWindowBands* out_bands);
 
 // Convenience logging helper (single line) using logger.
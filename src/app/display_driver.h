@@ -26,6 +26,20 @@
  * 5. Choose render mode:
  *    - Direct: driver pushes pixels to panel in LVGL flush callback
  *    - Buffered: driver accumulates into a buffer and implements present()
+ *
+ * 6. Declare the native pixel format:
+ *    - colorOrder(): RGB unless the panel's MADCTL BGR bit cannot be used
+ *    - acceptsWireOrderPixels(): true if pushColors(..., false) streams bytes as-is
+ *
+ * 7. Optional: async flush (DMA)
+ *    - Override supportsAsyncFlush()/pushColorsAsync()/waitAsyncFlush()/endAsyncFlush()
+ *      so LVGL can render into one draw buffer while the other is on the bus
+ *      (enabled per board with LVGL_DOUBLE_BUFFER)
+ *
+ * 8. Optional: hardware pixel shift (burn-in mitigation)
+ *    - Override hardwareShiftRange()/setHardwareShift() when the controller can
+ *      move the visible image itself (scroll start / window offset), so the
+ *      periodic shift costs a few commands instead of a full redraw
  */
 
 #ifndef DISPLAY_DRIVER_H
@@ -69,6 +83,14 @@ public:
     virtual void setBacklightBrightness(uint8_t brightness) = 0;  // 0-100
     virtual uint8_t getBacklightBrightness() = 0;
     virtual bool hasBacklightControl() = 0;  // Capability query
+
+    // Hardware backlight fade (LEDC fade engine) to `brightness` over `duration_ms`.
+    // Returns false when unsupported; callers then step the fade in software.
+    virtual bool fadeBacklightTo(uint8_t brightness, uint16_t duration_ms) {
+        (void)brightness;
+        (void)duration_ms;
+        return false;
+    }
     
     // Display-specific fixes/configuration (optional, board-dependent)
     virtual void applyDisplayFixes() = 0;
@@ -79,6 +101,27 @@ public:
     virtual void setAddrWindow(int16_t x, int16_t y, uint16_t w, uint16_t h) = 0;
     virtual void pushColors(uint16_t* data, uint32_t len, bool swap_bytes = true) = 0;
 
+    enum class ColorOrder : uint8_t {
+        RGB = 0,
+        BGR = 1,
+    };
+
+    // Channel order pushColors() expects in its RGB565 words.
+    // Panels with a MADCTL RGB/BGR bit (or TFT_RGB_ORDER) should configure it in
+    // init() so they accept RGB like LVGL renders; only report BGR when the panel
+    // cannot be switched. Default: RGB.
+    virtual ColorOrder colorOrder() const {
+        return ColorOrder::RGB;
+    }
+
+    // True when pushColors(..., swap_bytes=false) sends the buffer MSB-first as-is,
+    // so pixel producers (e.g., StripDecoder) can pack wire-order pixels directly
+    // instead of having the driver swap bytes per pixel.
+    // Default: false (driver consumes CPU-endian RGB565, e.g. a canvas in RAM).
+    virtual bool acceptsWireOrderPixels() const {
+        return false;
+    }
+
     // Declare whether the driver is Direct or Buffered.
     // Default: Direct (most SPI/QSPI drivers push pixels immediately in flush callback).
     virtual RenderMode renderMode() const {
@@ -86,11 +129,61 @@ public:
     }
 
     // For buffered drivers, push the accumulated framebuffer/canvas to the panel.
+    // Drivers should track the areas written by pushColors() and only push those.
     // Default: no-op (Direct drivers do not need an explicit present).
     virtual void present() {
         // Override in buffered drivers (e.g., Arduino_GFX canvas)
     }
+
+    // Bytes pushed to the panel by the last present() (perf stats only).
+    // Default: 0 (Direct drivers put their bytes on the bus during flush).
+    virtual uint32_t lastPresentBytes() const {
+        return 0;
+    }
+
+    // Optional asynchronous (DMA) flush path, used when LVGL_DOUBLE_BUFFER is enabled.
+    // When supported, DisplayManager queues each LVGL band with pushColorsAsync() and
+    // lets LVGL render the next band into the second draw buffer while the bus is busy.
+    // Default: not supported (flushes stay blocking).
+    virtual bool supportsAsyncFlush() const {
+        return false;
+    }
+
+    // Queue a window + pixel transfer and return without waiting for completion.
+    // The buffer must stay untouched until waitAsyncFlush() returns.
+    // Default: blocking fallback through the regular flush interface.
+    virtual void pushColorsAsync(int16_t x, int16_t y, uint16_t w, uint16_t h, uint16_t* data, bool swap_bytes = true) {
+        startWrite();
+        setAddrWindow(x, y, w, h);
+        pushColors(data, (uint32_t)w * h, swap_bytes);
+        endWrite();
+    }
+
+    // Block until the transfer queued by pushColorsAsync() has completed.
+    virtual void waitAsyncFlush() {
+    }
+
+    // Wait for outstanding transfers and release the bus (end of an LVGL frame).
+    virtual void endAsyncFlush() {
+    }
     
+    // Hardware pixel shift (PIXEL_SHIFT_INTERVAL_S): how far the controller can move
+    // the visible image along the logical (LVGL) x or y axis without new pixel data.
+    // Default: 0 (not supported; DisplayManager shifts the UI and redraws once).
+    virtual uint8_t hardwareShiftRange(bool horizontal) const {
+        (void)horizontal;
+        return 0;
+    }
+
+    // Move the visible image by (dx, dy) logical pixels from its home position.
+    // Called from the LVGL task with the display lock held. Returns false when the
+    // offset is outside hardwareShiftRange().
+    virtual bool setHardwareShift(int16_t dx, int16_t dy) {
+        (void)dx;
+        (void)dy;
+        return false;
+    }
+
     // LVGL configuration hook (override to customize LVGL driver settings)
     // Called during LVGL initialization to allow driver-specific configuration
     // such as software rotation, full refresh mode, etc.
@@ -18,4 +18,9 @@
 #error "No display driver selected or unknown driver type"
 #endif
 
+// Secondary status panel driver, unless the main panel already compiled it.
+#if (SECONDARY_DISPLAY_DRIVER == DISPLAY_DRIVER_ST7789V2) && (DISPLAY_DRIVER != DISPLAY_DRIVER_ST7789V2)
+#include "drivers/st7789v2_driver.cpp"
+#endif
+
 #endif // HAS_DISPLAY
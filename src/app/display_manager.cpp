@@ -1,9 +1,17 @@
 #include "board_config.h"
+#include "board_profile.h"
 
 #if HAS_DISPLAY
 
 #include "display_manager.h"
+#include "energy_latency.h"
 #include "log_manager.h"
+#include "lvgl_heap.h"
+#include "lvgl_lock_stats.h"
+#include "perf_histogram.h"
+#include "screenshot.h"
+#include "task_placement.h"
+#include "trace_ring.h"
 
 #include <esp_timer.h>
 
@@ -19,16 +27,69 @@
 #include "drivers/esp_panel_st77916_driver.h"
 #endif
 
+#if (SECONDARY_DISPLAY_DRIVER == DISPLAY_DRIVER_ST7789V2) && (DISPLAY_DRIVER != DISPLAY_DRIVER_ST7789V2)
+#include "drivers/st7789v2_driver.h"
+#endif
+
 #include <SPI.h>
+#include <atomic>
 
-static portMUX_TYPE g_splash_status_mux = portMUX_INITIALIZER_UNLOCKED;
 static portMUX_TYPE g_perf_mux = portMUX_INITIALIZER_UNLOCKED;
 
-static DisplayPerfStats g_perf = {0, 0, 0};
+static DisplayPerfStats g_perf = {};
 static bool g_perf_ready = false;
+
+// Command queue counters (posted from any task, peak from the LVGL task).
+static std::atomic<uint32_t> g_cmd_posted{0};
+static std::atomic<uint32_t> g_cmd_dropped{0};
+static std::atomic<uint8_t> g_cmd_queue_peak{0};
 static uint32_t g_perf_window_start_ms = 0;
 static uint16_t g_perf_frames_in_window = 0;
 
+// Perf histograms: only touched from the LVGL task (flush callback + lvglTask),
+// published into g_perf once per DISPLAY_PERF_HIST_WINDOW_MS.
+static PerfHistogram g_hist_lv_timer_us;
+static PerfHistogram g_hist_flush_us;
+static PerfHistogram g_hist_flush_px;
+static uint64_t g_hist_bus_bytes = 0;
+static uint32_t g_hist_window_start_ms = 0;
+
+static inline DisplayPerfDist perf_dist_from(const PerfHistogram& h) {
+    DisplayPerfDist d;
+    d.p50 = h.percentile(50);
+    d.p95 = h.percentile(95);
+    d.max = h.max;
+    return d;
+}
+
+static void perf_hist_publish_if_due(uint32_t now_ms) {
+    if (g_hist_window_start_ms == 0) {
+        g_hist_window_start_ms = now_ms;
+        return;
+    }
+
+    const uint32_t elapsed = now_ms - g_hist_window_start_ms;
+    if (elapsed < DISPLAY_PERF_HIST_WINDOW_MS) return;
+
+    const DisplayPerfDist lv_timer = perf_dist_from(g_hist_lv_timer_us);
+    const DisplayPerfDist flush_us = perf_dist_from(g_hist_flush_us);
+    const DisplayPerfDist flush_px = perf_dist_from(g_hist_flush_px);
+    const uint32_t bus_bps = (uint32_t)((g_hist_bus_bytes * 1000ULL) / elapsed);
+
+    portENTER_CRITICAL(&g_perf_mux);
+    g_perf.lv_timer_dist_us = lv_timer;
+    g_perf.flush_dist_us = flush_us;
+    g_perf.flush_dist_px = flush_px;
+    g_perf.bus_bytes_per_s = bus_bps;
+    portEXIT_CRITICAL(&g_perf_mux);
+
+    g_hist_lv_timer_us.reset();
+    g_hist_flush_us.reset();
+    g_hist_flush_px.reset();
+    g_hist_bus_bytes = 0;
+    g_hist_window_start_ms = now_ms;
+}
+
 // Global instance
 DisplayManager* displayManager = nullptr;
 
@@ -38,8 +99,7 @@ DisplayManager::DisplayManager(DeviceConfig* cfg)
       #if HAS_IMAGE_API
       directImageScreen(this),
       #endif
-                lvglTaskHandle(nullptr), lvglMutex(nullptr), screenCount(0), buf(nullptr), flushPending(false), directImageActive(false), pendingSplashStatusSet(false) {
-        pendingSplashStatus[0] = '\0';
+                lvglTaskHandle(nullptr), lvglMutex(nullptr), screenCount(0), residencyCount(0), buf(nullptr), buf2(nullptr), asyncFlush(false), flushPending(false), appliedRefreshPeriodMs(LV_DISP_DEF_REFR_PERIOD), directImageActive(false), renderSuspended(false), renderParked(false), cmdQueue(nullptr) {
     // Instantiate selected display driver
     #if DISPLAY_DRIVER == DISPLAY_DRIVER_TFT_ESPI
     driver = new TFT_eSPI_Driver();
@@ -55,7 +115,21 @@ DisplayManager::DisplayManager(DeviceConfig* cfg)
     
     // Create mutex for thread-safe LVGL access
     lvglMutex = xSemaphoreCreateMutex();
+    cmdQueue = xQueueCreateStatic(DISPLAY_CMD_QUEUE_DEPTH + DISPLAY_CMD_RESERVED_SLOTS, sizeof(DisplayCommand),
+                                  cmdQueueStorage, &cmdQueueStruct);
     
+    trackScreen(&splashScreen, "splash");
+    trackScreen(&infoScreen, "info");
+    trackScreen(&energyMonitorScreen, "energy");
+    trackScreen(&testScreen, "test");
+    trackScreen(&warningScreen, "warning");
+    #if HAS_IMAGE_API
+    trackScreen(&directImageScreen, "direct_image");
+    #if LV_USE_IMG
+    trackScreen(&lvglImageScreen, "lvgl_image");
+    #endif
+    #endif
+
     // Initialize screen registry (exclude splash - it's boot-specific)
     availableScreens[0] = {"energy", "Energy Monitor", &energyMonitorScreen};
     availableScreens[1] = {"info", "Info Screen", &infoScreen};
@@ -85,6 +159,7 @@ DisplayManager::~DisplayManager() {
     if (lvglTaskHandle) {
         vTaskDelete(lvglTaskHandle);
         lvglTaskHandle = nullptr;
+        task_placement_forget(AppTask::Lvgl);
     }
     
     if (currentScreen) {
@@ -109,6 +184,22 @@ DisplayManager::~DisplayManager() {
         delete driver;
         driver = nullptr;
     }
+
+    #if SECONDARY_DISPLAY_DRIVER
+    statusPanelScreen.destroy();
+    if (secondaryDriver) {
+        delete secondaryDriver;
+        secondaryDriver = nullptr;
+    }
+    if (secondarySpi) {
+        delete secondarySpi;
+        secondarySpi = nullptr;
+    }
+    if (secondaryBuf) {
+        heap_caps_free(secondaryBuf);
+        secondaryBuf = nullptr;
+    }
+    #endif
     
     // Delete mutex
     if (lvglMutex) {
@@ -116,11 +207,15 @@ DisplayManager::~DisplayManager() {
         lvglMutex = nullptr;
     }
     
-    // Free LVGL buffer
+    // Free LVGL buffers
     if (buf) {
         heap_caps_free(buf);
         buf = nullptr;
     }
+    if (buf2) {
+        heap_caps_free(buf2);
+        buf2 = nullptr;
+    }
 }
 
 const char* DisplayManager::getScreenIdForInstance(const Screen* screen) const {
@@ -149,6 +244,10 @@ const char* DisplayManager::getScreenIdForInstance(const Screen* screen) const {
 }
 
 // LVGL flush callback
+// With LV_COLOR_16_SWAP, LVGL already renders MSB-first pixels: pass its buffer
+// through untouched (drivers must report acceptsWireOrderPixels()).
+static constexpr bool kFlushSwapBytes = (LV_COLOR_16_SWAP == 0);
+
 void DisplayManager::flushCallback(lv_disp_drv_t *disp, const lv_area_t *area, lv_color_t *color_p) {
     DisplayManager* mgr = (DisplayManager*)disp->user_data;
 
@@ -161,13 +260,35 @@ void DisplayManager::flushCallback(lv_disp_drv_t *disp, const lv_area_t *area, l
     }
     #endif
     
+    TRACE_SCOPE(TraceEvent::LvFlush);
     uint32_t w = (area->x2 - area->x1 + 1);
     uint32_t h = (area->y2 - area->y1 + 1);
+    const uint64_t flush_start_us = esp_timer_get_time();
+    #if ENERGY_LATENCY_SUPPORTED
+    energy_latency_on_flush_start();
+    #endif
+
+    // Direct drivers put the pixels on the bus here; Buffered drivers account in present().
+    g_hist_flush_px.record(w * h);
+    if (mgr->driver->renderMode() == DisplayDriver::RenderMode::Direct) {
+        g_hist_bus_bytes += (uint64_t)w * h * sizeof(lv_color_t);
+    }
+
+    // Double-buffered async path: queue the transfer and return immediately.
+    // lv_disp_flush_ready() is signalled from flushWaitCallback()/completeAsyncFlush()
+    // once the driver reports the transfer as done.
+    if (mgr->asyncFlush) {
+        mgr->driver->pushColorsAsync(area->x1, area->y1, w, h, (uint16_t *)&color_p->full, kFlushSwapBytes);
+        g_hist_flush_us.record((uint32_t)(esp_timer_get_time() - flush_start_us));
+        mgr->flushPending = true;
+        return;
+    }
     
     mgr->driver->startWrite();
     mgr->driver->setAddrWindow(area->x1, area->y1, w, h);
-    mgr->driver->pushColors((uint16_t *)&color_p->full, w * h, true);
+    mgr->driver->pushColors((uint16_t *)&color_p->full, w * h, kFlushSwapBytes);
     mgr->driver->endWrite();
+    g_hist_flush_us.record((uint32_t)(esp_timer_get_time() - flush_start_us));
 
     // Signal that the driver may need a post-render present() step.
     // For Direct render-mode drivers this is harmless (present() is a no-op).
@@ -178,6 +299,71 @@ void DisplayManager::flushCallback(lv_disp_drv_t *disp, const lv_area_t *area, l
     lv_disp_flush_ready(disp);
 }
 
+#if SECONDARY_DISPLAY_DRIVER
+// Secondary panel: blocking flush on its own bus (no direct-image gate, no perf stats).
+void DisplayManager::secondaryFlushCallback(lv_disp_drv_t *disp, const lv_area_t *area, lv_color_t *color_p) {
+    DisplayManager* mgr = (DisplayManager*)disp->user_data;
+    if (mgr && mgr->secondaryDriver) {
+        const uint32_t w = (area->x2 - area->x1 + 1);
+        const uint32_t h = (area->y2 - area->y1 + 1);
+        mgr->secondaryDriver->startWrite();
+        mgr->secondaryDriver->setAddrWindow(area->x1, area->y1, w, h);
+        mgr->secondaryDriver->pushColors((uint16_t *)&color_p->full, w * h, kFlushSwapBytes);
+        mgr->secondaryDriver->endWrite();
+    }
+    lv_disp_flush_ready(disp);
+}
+#endif
+
+void DisplayManager::flushWaitCallback(lv_disp_drv_t *disp) {
+    DisplayManager* mgr = (DisplayManager*)disp->user_data;
+    if (mgr && mgr->driver) {
+        mgr->driver->waitAsyncFlush();
+    }
+    lv_disp_flush_ready(disp);
+}
+
+void DisplayManager::completeAsyncFlush() {
+    if (!asyncFlush) return;
+
+    // LVGL does not wait for the last band of a frame; finish it here so other
+    // bus users (direct image writes) never overlap an in-flight DMA transfer.
+    driver->endAsyncFlush();
+    if (draw_buf.flushing) {
+        lv_disp_flush_ready(&disp_drv);
+    }
+}
+
+void DisplayManager::applyRefreshGovernor() {
+    if (!currentScreen) return;
+
+    uint32_t period = currentScreen->refreshPeriodMs();
+    if (period < 1) period = 1;
+    if (period == appliedRefreshPeriodMs) return;
+
+    lv_disp_t* disp = lv_disp_get_default();
+    lv_timer_t* refrTimer = disp ? _lv_disp_get_refr_timer(disp) : nullptr;
+    if (!refrTimer) return;
+
+    lv_timer_set_period(refrTimer, period);
+    appliedRefreshPeriodMs = period;
+    LOGD("Display", "Refresh period %lums", (unsigned long)period);
+}
+
+void DisplayManager::pauseLvglRefresh(bool paused) {
+    lv_disp_t* disp = lv_disp_get_default();
+    lv_timer_t* refrTimer = disp ? _lv_disp_get_refr_timer(disp) : nullptr;
+    if (!refrTimer || refrTimer->paused == (paused ? 1 : 0)) return;
+
+    if (paused) {
+        lv_timer_pause(refrTimer);
+    } else {
+        lv_timer_resume(refrTimer);
+        lv_timer_ready(refrTimer);
+    }
+    LOGD("Display", "LVGL refresh %s", paused ? "paused" : "resumed");
+}
+
 bool DisplayManager::isInLvglTask() const {
     if (!lvglTaskHandle) return false;
     return xTaskGetCurrentTaskHandle() == lvglTaskHandle;
@@ -188,7 +374,7 @@ void DisplayManager::lockIfNeeded(bool& didLock) {
         didLock = false;
         return;
     }
-    lock();
+    lock(LvglLockSite::Display);
     didLock = true;
 }
 
@@ -198,21 +384,73 @@ void DisplayManager::unlockIfNeeded(bool didLock) {
     }
 }
 
-void DisplayManager::lock() {
+void DisplayManager::lock(LvglLockSite site) {
     if (lvglMutex) {
+        TRACE_BEGIN(TraceEvent::LvglLockWait);
+        #if LVGL_LOCK_STATS
+        const int64_t wait_start_us = esp_timer_get_time();
+        const bool contended = xSemaphoreTake(lvglMutex, 0) != pdTRUE;
+        if (contended) {
+            xSemaphoreTake(lvglMutex, portMAX_DELAY);
+        }
+        lvgl_lock_stats_acquired(site, (uint32_t)(esp_timer_get_time() - wait_start_us), contended);
+        #else
+        (void)site;
         xSemaphoreTake(lvglMutex, portMAX_DELAY);
+        #endif
+        TRACE_END(TraceEvent::LvglLockWait);
+        TRACE_BEGIN(TraceEvent::LvglLock);
     }
 }
 
 void DisplayManager::unlock() {
     if (lvglMutex) {
+        TRACE_END(TraceEvent::LvglLock);
+        #if LVGL_LOCK_STATS
+        LvglLockSite site;
+        const uint32_t hold_us = lvgl_lock_stats_releasing(&site);
+        xSemaphoreGive(lvglMutex);
+        lvgl_lock_stats_after_release(site, hold_us);
+        #else
         xSemaphoreGive(lvglMutex);
+        #endif
+    }
+
+    // External tasks only take the LVGL lock to change UI state; make sure the
+    // render task picks the change up instead of sleeping until its next deadline.
+    if (!isInLvglTask()) {
+        requestRender();
     }
 }
 
-bool DisplayManager::tryLock(uint32_t timeoutMs) {
+void DisplayManager::requestRender() {
+    if (lvglTaskHandle) {
+        xTaskNotifyGive(lvglTaskHandle);
+    }
+}
+
+bool DisplayManager::tryLock(uint32_t timeoutMs, LvglLockSite site) {
     if (!lvglMutex) return false;
-    return xSemaphoreTake(lvglMutex, pdMS_TO_TICKS(timeoutMs)) == pdTRUE;
+    TRACE_BEGIN(TraceEvent::LvglLockWait);
+    #if LVGL_LOCK_STATS
+    const int64_t wait_start_us = esp_timer_get_time();
+    const bool contended = xSemaphoreTake(lvglMutex, 0) != pdTRUE;
+    const bool locked = !contended || xSemaphoreTake(lvglMutex, pdMS_TO_TICKS(timeoutMs)) == pdTRUE;
+    const uint32_t wait_us = (uint32_t)(esp_timer_get_time() - wait_start_us);
+    if (locked) {
+        lvgl_lock_stats_acquired(site, wait_us, contended);
+    } else {
+        lvgl_lock_stats_timeout(site, wait_us);
+    }
+    #else
+    (void)site;
+    const bool locked = xSemaphoreTake(lvglMutex, pdMS_TO_TICKS(timeoutMs)) == pdTRUE;
+    #endif
+    TRACE_END(TraceEvent::LvglLockWait);
+    if (locked) {
+        TRACE_BEGIN(TraceEvent::LvglLock);
+    }
+    return locked;
 }
 
 // FreeRTOS task for continuous LVGL rendering
@@ -222,25 +460,30 @@ void DisplayManager::lvglTask(void* pvParameter) {
     LOGI("Display", "LVGL render task start (core %d)", xPortGetCoreID());
     
     while (true) {
-        mgr->lock();
-
-        // Apply any deferred splash status update.
-        if (mgr->pendingSplashStatusSet) {
-            char text[sizeof(mgr->pendingSplashStatus)];
-            bool has = false;
-            portENTER_CRITICAL(&g_splash_status_mux);
-            if (mgr->pendingSplashStatusSet) {
-                strlcpy(text, mgr->pendingSplashStatus, sizeof(text));
-                mgr->pendingSplashStatusSet = false;
-                has = true;
-            }
-            portEXIT_CRITICAL(&g_splash_status_mux);
-            if (has) {
-                mgr->splashScreen.setStatus(text);
+        // Parked: nothing is visible, so skip timers, screen updates and flushes until
+        // a wake (setRenderSuspended(false)) or a queued screen switch notifies us.
+        if (mgr->renderSuspended && uxQueueMessagesWaiting(mgr->cmdQueue) == 0) {
+            if (!mgr->renderParked) {
+                mgr->renderParked = true;
+                LOGI("Display", "Render parked");
             }
+            (void)ulTaskNotifyTake(pdTRUE, portMAX_DELAY);
+            continue;
         }
-        
-        // Process pending screen switch (deferred from external calls)
+
+        mgr->lock(LvglLockSite::Render);
+
+        if (mgr->renderParked && !mgr->renderSuspended) {
+            // The panel kept the last frame, but screen data moved on while parked.
+            mgr->renderParked = false;
+            lv_obj_invalidate(lv_scr_act());
+            LOGI("Display", "Render resumed");
+        }
+
+        // Commands posted by other tasks (and by LVGL callbacks) since the last frame.
+        mgr->drainCommands();
+
+        // Process pending screen switch (decided by those commands)
         if (mgr->pendingScreen) {
             Screen* target = mgr->pendingScreen;
             if (mgr->currentScreen) {
@@ -258,27 +501,53 @@ void DisplayManager::lvglTask(void* pvParameter) {
             mgr->previousScreen = mgr->currentScreen;
             #endif
             mgr->currentScreen = target;
+            mgr->ensureScreenCreated(target);
             mgr->currentScreen->show();
+            // Catch up on data before the first frame: a screen coming back from the
+            // background renders once with current values, not stale and then again.
+            mgr->currentScreen->update();
             mgr->pendingScreen = nullptr;
+            mgr->releaseHiddenScreens();
 
             #if HAS_IMAGE_API
             // Keep the flush gate in sync with the active screen.
             mgr->directImageActive = (mgr->currentScreen == &mgr->directImageScreen);
+            // While the decoder owns the panel, LVGL renders nothing at all (not even
+            // the blank screen's full-screen frame, whose flushes would be dropped).
+            // The screen returned to redraws once on resume: the image replaced
+            // every pixel it had on the panel.
+            mgr->pauseLvglRefresh(mgr->directImageActive);
             #endif
 
+            // A software pixel shift lives on the screen's widgets: carry it over.
+            if (mgr->pixelShiftTimer && mgr->pixelShiftRangeX == 0 && mgr->pixelShiftRangeY == 0) {
+                mgr->applyPixelShift();
+            }
+
             const char* screenId = mgr->getScreenIdForInstance(mgr->currentScreen);
             LOGI("Display", "Switched to %s", screenId ? screenId : "(unregistered)");
         }
         
         // Handle LVGL rendering (animations, timers, etc.)
         const uint64_t lv_start_us = esp_timer_get_time();
+        TRACE_BEGIN(TraceEvent::LvTimer);
         uint32_t delayMs = lv_timer_handler();
+        mgr->completeAsyncFlush();
+        TRACE_END(TraceEvent::LvTimer);
+        #if SCREENSHOT_SUPPORTED
+        screenshot_service();
+        #endif
         const uint32_t lv_timer_us = (uint32_t)(esp_timer_get_time() - lv_start_us);
         
         // Update current screen (data refresh)
         if (mgr->currentScreen) {
             mgr->currentScreen->update();
         }
+        #if SECONDARY_DISPLAY_DRIVER
+        mgr->statusPanelScreen.update();
+        #endif
+        mgr->applyRefreshGovernor();
+        lvgl_heap_sample();
 
         
         // Flush canvas buffer only when LVGL produced draw data.
@@ -292,11 +561,17 @@ void DisplayManager::lvglTask(void* pvParameter) {
             uint64_t present_start_us = 0;
             if (mgr->driver->renderMode() == DisplayDriver::RenderMode::Buffered) {
                 present_start_us = esp_timer_get_time();
+                TRACE_SCOPE(TraceEvent::Present);
                 mgr->driver->present();
+                g_hist_bus_bytes += mgr->driver->lastPresentBytes();
             }
 
             const uint32_t present_us = (present_start_us == 0) ? 0 : (uint32_t)(esp_timer_get_time() - present_start_us);
+            #if ENERGY_LATENCY_SUPPORTED
+            energy_latency_on_present_done();
+            #endif
             g_perf_frames_in_window++;
+            g_hist_lv_timer_us.record(lv_timer_us);
 
             // Update published stats every ~1s.
             const uint32_t elapsed = now_ms - g_perf_window_start_ms;
@@ -315,17 +590,39 @@ void DisplayManager::lvglTask(void* pvParameter) {
 
             mgr->flushPending = false;
         }
+
+        // Publish histogram percentiles on their own (longer) window, also on idle screens.
+        perf_hist_publish_if_due(millis());
         
         mgr->unlock();
         
-        // Sleep based on LVGL's suggested next timer deadline.
-        // Clamp to keep UI responsive while avoiding busy looping on static screens.
+        // Sleep until LVGL's next timer deadline or an explicit wakeup (requestRender():
+        // new energy data, screen switch, external LVGL changes). On a static screen LVGL
+        // pauses its refresh timer, so the task mostly idles here.
+        // The upper clamp keeps polling-based screen update() logic (timeouts, uptime) ticking.
         if (delayMs < 1) delayMs = 1;
-        if (delayMs > 20) delayMs = 20;
-        vTaskDelay(pdMS_TO_TICKS(delayMs));
+        if (delayMs > LVGL_TASK_MAX_IDLE_MS) delayMs = LVGL_TASK_MAX_IDLE_MS;
+        (void)ulTaskNotifyTake(pdTRUE, pdMS_TO_TICKS(delayMs));
     }
 }
 
+void display_manager_request_render() {
+    if (displayManager) {
+        displayManager->requestRender();
+    }
+}
+
+static std::atomic<uint32_t> g_info_generation{0};
+
+void display_manager_notify_info_changed() {
+    g_info_generation.fetch_add(1, std::memory_order_relaxed);
+    display_manager_request_render();
+}
+
+uint32_t display_manager_info_generation() {
+    return g_info_generation.load(std::memory_order_relaxed);
+}
+
 bool display_manager_get_perf_stats(DisplayPerfStats* out) {
     if (!out) return false;
     bool ok = false;
@@ -335,9 +632,82 @@ bool display_manager_get_perf_stats(DisplayPerfStats* out) {
         *out = g_perf;
     }
     portEXIT_CRITICAL(&g_perf_mux);
+    if (ok) {
+        out->cmd_posted = g_cmd_posted.load(std::memory_order_relaxed);
+        out->cmd_dropped = g_cmd_dropped.load(std::memory_order_relaxed);
+        out->cmd_queue_peak = g_cmd_queue_peak.load(std::memory_order_relaxed);
+    }
     return ok;
 }
 
+// Allocate one LVGL draw buffer, honouring LVGL_BUFFER_PREFER_INTERNAL.
+// DMA-capable internal RAM is tried first when the buffer feeds async DMA flushes.
+static lv_color_t* allocDrawBuffer(size_t pixels, bool dma) {
+    const size_t bytes = pixels * sizeof(lv_color_t);
+    lv_color_t* p = nullptr;
+
+    if (dma) {
+        p = (lv_color_t*)heap_caps_malloc(bytes, MALLOC_CAP_DMA | MALLOC_CAP_INTERNAL | MALLOC_CAP_8BIT);
+        if (p) return p;
+        LOGW("Display", "DMA-capable alloc failed, falling back...");
+    }
+
+    if constexpr (kBoardProfile.lvgl_buffer_prefer_internal || kBoardProfile.psram == BoardPsram::None) {
+        p = (lv_color_t*)heap_caps_malloc(bytes, MALLOC_CAP_INTERNAL | MALLOC_CAP_8BIT);
+        if (!p && board_psram_available()) {
+            LOGW("Display", "Internal RAM alloc failed, trying PSRAM...");
+            p = (lv_color_t*)heap_caps_malloc(bytes, MALLOC_CAP_SPIRAM);
+        }
+    } else {
+        // Default: PSRAM first, fallback to internal.
+        if (board_psram_available()) {
+            p = (lv_color_t*)heap_caps_malloc(bytes, MALLOC_CAP_SPIRAM);
+        }
+        if (!p) {
+            if (board_psram_available()) LOGW("Display", "PSRAM alloc failed, trying internal RAM...");
+            p = (lv_color_t*)heap_caps_malloc(bytes, MALLOC_CAP_INTERNAL | MALLOC_CAP_8BIT);
+        }
+    }
+    return p;
+}
+
+// Pixels per LVGL draw buffer. LVGL_BUFFER_SIZE, unless LVGL_BUFFER_ADAPTIVE and the
+// buffers go to internal RAM: then the tallest band (up to LVGL_BUFFER_MAX_LINES) for
+// which all `count` buffers fit the largest free block and internal RAM keeps
+// LVGL_BUFFER_INTERNAL_HEADROOM bytes. Taller bands = fewer flushes per frame.
+static uint32_t pickDrawBufferPixels(bool dma, uint8_t count) {
+    const uint32_t base = (uint32_t)LVGL_BUFFER_SIZE;
+    #if LVGL_BUFFER_ADAPTIVE
+    // The ESP_Panel byte-swap scratch is sized from LVGL_BUFFER_SIZE.
+    constexpr bool kFixedByDriver = (DISPLAY_DRIVER == DISPLAY_DRIVER_ESP_PANEL) && !LVGL_COLOR_16_SWAP;
+    const bool internal = dma || kBoardProfile.lvgl_buffer_prefer_internal || !board_psram_available();
+    if (kFixedByDriver || !internal) return base;
+
+    const uint32_t caps = dma ? (MALLOC_CAP_DMA | MALLOC_CAP_INTERNAL | MALLOC_CAP_8BIT)
+                              : (MALLOC_CAP_INTERNAL | MALLOC_CAP_8BIT);
+    const uint32_t largest = (uint32_t)heap_caps_get_largest_free_block(caps);
+    const uint32_t free_bytes = (uint32_t)heap_caps_get_free_size(MALLOC_CAP_INTERNAL | MALLOC_CAP_8BIT);
+    const uint32_t band_row_bytes = (uint32_t)DISPLAY_WIDTH * sizeof(lv_color_t) * count;
+
+    uint32_t lines = (uint32_t)LVGL_BUFFER_MAX_LINES;
+    if (lines > (uint32_t)DISPLAY_HEIGHT) lines = (uint32_t)DISPLAY_HEIGHT;
+    const uint32_t by_block = largest / band_row_bytes;
+    const uint32_t by_headroom = (free_bytes > (uint32_t)LVGL_BUFFER_INTERNAL_HEADROOM)
+        ? (free_bytes - (uint32_t)LVGL_BUFFER_INTERNAL_HEADROOM) / band_row_bytes : 0;
+    if (lines > by_block) lines = by_block;
+    if (lines > by_headroom) lines = by_headroom;
+
+    const uint32_t pixels = lines * (uint32_t)DISPLAY_WIDTH;
+    LOGI("Display", "Adaptive buffer: %lu free, %lu largest block -> %lu lines",
+         (unsigned long)free_bytes, (unsigned long)largest, (unsigned long)lines);
+    return (pixels > base) ? pixels : base;
+    #else
+    (void)dma;
+    (void)count;
+    return base;
+    #endif
+}
+
 void DisplayManager::initHardware() {
     LOGI("Display", "Init start");
     
@@ -362,6 +732,12 @@ void DisplayManager::initHardware() {
     
     // Apply display-specific settings (inversion, gamma, etc.)
     driver->applyDisplayFixes();
+
+    #if LV_COLOR_16_SWAP
+    if (!driver->acceptsWireOrderPixels()) {
+        LOGW("Display", "LVGL_COLOR_16_SWAP set but driver needs CPU-endian pixels (colors will be wrong)");
+    }
+    #endif
     
     LOGI("Display", "Init complete");
 }
@@ -371,27 +747,41 @@ void DisplayManager::initLVGL() {
     
     lv_init();
     
+    // Double buffering only pays off when the driver can flush asynchronously.
+    // DMA transfers need DMA-capable (internal) memory, so prefer that for both buffers.
+    bool wantDoubleBuffer = false;
+    #if LVGL_DOUBLE_BUFFER
+    wantDoubleBuffer = driver->supportsAsyncFlush();
+    if (!wantDoubleBuffer) {
+        LOGW("Display", "LVGL_DOUBLE_BUFFER set but driver has no async flush; using single buffer");
+    }
+    #endif
+
     // Allocate LVGL draw buffer.
     // Some QSPI panels/drivers require internal RAM for flush reliability.
-    if (LVGL_BUFFER_PREFER_INTERNAL) {
-        buf = (lv_color_t*)heap_caps_malloc(LVGL_BUFFER_SIZE * sizeof(lv_color_t), MALLOC_CAP_INTERNAL | MALLOC_CAP_8BIT);
-        if (!buf) {
-            LOGW("Display", "Internal RAM alloc failed, trying PSRAM...");
-            buf = (lv_color_t*)heap_caps_malloc(LVGL_BUFFER_SIZE * sizeof(lv_color_t), MALLOC_CAP_SPIRAM);
-        }
-    } else {
-        // Default: PSRAM first, fallback to internal.
-        buf = (lv_color_t*)heap_caps_malloc(LVGL_BUFFER_SIZE * sizeof(lv_color_t), MALLOC_CAP_SPIRAM);
-        if (!buf) {
-            LOGW("Display", "PSRAM alloc failed, trying internal RAM...");
-            buf = (lv_color_t*)heap_caps_malloc(LVGL_BUFFER_SIZE * sizeof(lv_color_t), MALLOC_CAP_INTERNAL | MALLOC_CAP_8BIT);
-        }
+    bufPixels = pickDrawBufferPixels(wantDoubleBuffer, wantDoubleBuffer ? 2 : 1);
+    buf = allocDrawBuffer(bufPixels, wantDoubleBuffer);
+    if (!buf && bufPixels > (uint32_t)LVGL_BUFFER_SIZE) {
+        LOGW("Display", "Adaptive LVGL buffer alloc failed; using LVGL_BUFFER_SIZE");
+        bufPixels = LVGL_BUFFER_SIZE;
+        buf = allocDrawBuffer(bufPixels, wantDoubleBuffer);
     }
     if (!buf) {
         LOGE("Display", "Failed to allocate LVGL buffer");
         return;
     }
-    LOGI("Display", "Buffer allocated: %d bytes (%d pixels)", LVGL_BUFFER_SIZE * sizeof(lv_color_t), LVGL_BUFFER_SIZE);
+    LOGI("Display", "Buffer allocated: %lu bytes (%lu pixels)",
+         (unsigned long)(bufPixels * sizeof(lv_color_t)), (unsigned long)bufPixels);
+
+    if (wantDoubleBuffer) {
+        buf2 = allocDrawBuffer(bufPixels, true);
+        if (buf2) {
+            asyncFlush = true;
+            LOGI("Display", "Second buffer allocated: async DMA flush enabled");
+        } else {
+            LOGW("Display", "Second LVGL buffer alloc failed; using single buffer");
+        }
+    }
     
     // Initialize default theme (dark mode with custom primary color)
     lv_theme_t* theme = lv_theme_default_init(
@@ -405,13 +795,16 @@ void DisplayManager::initLVGL() {
     LOGI("Display", "Theme: Default dark mode initialized");
     
     // Set up display buffer
-    lv_disp_draw_buf_init(&draw_buf, buf, NULL, LVGL_BUFFER_SIZE);
+    lv_disp_draw_buf_init(&draw_buf, buf, buf2, bufPixels);
     
     // Initialize display driver
     lv_disp_drv_init(&disp_drv);
     disp_drv.hor_res = DISPLAY_WIDTH;
     disp_drv.ver_res = DISPLAY_HEIGHT;
     disp_drv.flush_cb = DisplayManager::flushCallback;
+    if (asyncFlush) {
+        disp_drv.wait_cb = DisplayManager::flushWaitCallback;
+    }
     disp_drv.draw_buf = &draw_buf;
     disp_drv.user_data = this;  // Pass instance for callback
     
@@ -420,142 +813,402 @@ void DisplayManager::initLVGL() {
     
     lv_disp_drv_register(&disp_drv);
     
-    LOGI("Display", "Buffer: %d pixels (%d lines)", LVGL_BUFFER_SIZE, LVGL_BUFFER_SIZE / DISPLAY_WIDTH);
+    const uint16_t bandLines = (uint16_t)(bufPixels / DISPLAY_WIDTH);
+    const uint8_t bufCount = buf2 ? 2 : 1;
+    portENTER_CRITICAL(&g_perf_mux);
+    g_perf.draw_buf_px = bufPixels;
+    g_perf.draw_buf_lines = bandLines;
+    g_perf.draw_buf_count = bufCount;
+    portEXIT_CRITICAL(&g_perf_mux);
+    LOGI("Display", "Buffer: %lu pixels (%u lines) x%u, %u bands per full frame",
+         (unsigned long)bufPixels, (unsigned)bandLines, (unsigned)bufCount,
+         (unsigned)((DISPLAY_HEIGHT + bandLines - 1) / (bandLines ? bandLines : 1)));
     LOGI("Display", "LVGL init complete");
 }
 
+#if SECONDARY_DISPLAY_DRIVER
+void DisplayManager::initSecondaryDisplay() {
+    LOGI("Display", "Secondary panel init (%dx%d)", SECONDARY_DISPLAY_WIDTH, SECONDARY_DISPLAY_HEIGHT);
+
+    secondarySpi = new SPIClass(SECONDARY_DISPLAY_SPI_BUS);
+    const ST7789V2_Config cfg = {
+        secondarySpi,
+        (int8_t)SECONDARY_LCD_SCK_PIN,
+        (int8_t)SECONDARY_LCD_MOSI_PIN,
+        (int8_t)SECONDARY_LCD_CS_PIN,
+        (int8_t)SECONDARY_LCD_DC_PIN,
+        (int8_t)SECONDARY_LCD_RST_PIN,
+        (int8_t)SECONDARY_LCD_BL_PIN,
+        (uint16_t)SECONDARY_DISPLAY_WIDTH,
+        (uint16_t)SECONDARY_DISPLAY_HEIGHT,
+        (uint16_t)SECONDARY_DISPLAY_Y_OFFSET,
+    };
+    secondaryDriver = new ST7789V2_Driver(cfg);
+    secondaryDriver->init();
+    secondaryDriver->setRotation(SECONDARY_DISPLAY_ROTATION);
+    secondaryDriver->applyDisplayFixes();
+
+    const uint32_t pixels = (uint32_t)SECONDARY_DISPLAY_WIDTH * SECONDARY_LVGL_BUFFER_LINES;
+    secondaryBuf = allocDrawBuffer(pixels, false);
+    if (!secondaryBuf) {
+        LOGE("Display", "Failed to allocate secondary LVGL buffer");
+        return;
+    }
+    lv_disp_draw_buf_init(&secondaryDrawBuf, secondaryBuf, nullptr, pixels);
+
+    lv_disp_drv_init(&secondaryDispDrv);
+    secondaryDispDrv.hor_res = SECONDARY_DISPLAY_WIDTH;
+    secondaryDispDrv.ver_res = SECONDARY_DISPLAY_HEIGHT;
+    secondaryDispDrv.flush_cb = DisplayManager::secondaryFlushCallback;
+    secondaryDispDrv.draw_buf = &secondaryDrawBuf;
+    secondaryDispDrv.user_data = this;
+    secondaryDriver->configureLVGL(&secondaryDispDrv, SECONDARY_DISPLAY_ROTATION);
+
+    lock(LvglLockSite::Display);
+    // The main panel stays LVGL's default display (lv_scr_act(), screenshots, the
+    // refresh governor); the status screen is built while the secondary is default.
+    lv_disp_t* primary = lv_disp_get_default();
+    secondaryDisp = lv_disp_drv_register(&secondaryDispDrv);
+    lv_disp_set_theme(secondaryDisp, lv_disp_get_theme(primary));
+    lv_timer_t* refrTimer = _lv_disp_get_refr_timer(secondaryDisp);
+    if (refrTimer) lv_timer_set_period(refrTimer, SECONDARY_DISPLAY_REFRESH_MS);
+
+    lv_disp_set_default(secondaryDisp);
+    statusPanelScreen.create();
+    statusPanelScreen.show();
+    lv_disp_set_default(primary);
+    unlock();
+
+    secondaryDriver->setBacklight(true);
+    LOGI("Display", "Secondary panel ready (%lu px buffer, %d ms refresh)",
+         (unsigned long)pixels, (int)SECONDARY_DISPLAY_REFRESH_MS);
+}
+#endif
+
 void DisplayManager::init() {
     // Initialize hardware (TFT + gamma fix)
     initHardware();
     
     // Initialize LVGL
     initLVGL();
+    initPixelShift();
+    #if SECONDARY_DISPLAY_DRIVER
+    initSecondaryDisplay();
+    #endif
     
     LOGI("Display", "Manager init start");
     
-    // Create all screens
-    splashScreen.create();
-    infoScreen.create();
-    energyMonitorScreen.create();
-    testScreen.create();
-    warningScreen.create();
-    #if HAS_IMAGE_API
-    #if LV_USE_IMG
-    lvglImageScreen.create();
-    #endif
-    #endif
-    
+    // Screens are built on first show (the splash right below) unless lazy
+    // creation is off, in which case everything is built up front as before.
+    #if !SCREEN_LAZY_CREATE
+    lock(LvglLockSite::Display);
+    for (size_t i = 0; i < residencyCount; i++) {
+        // DirectImageScreen builds its own tree when first shown.
+        #if HAS_IMAGE_API
+        if (residency[i].screen == &directImageScreen) continue;
+        #endif
+        ensureScreenCreated(residency[i].screen);
+    }
+    unlock();
     LOGI("Display", "Screens created");
+    #endif
     
     // Show splash immediately
     showSplash();
     
-    // Create LVGL rendering task
-    // Stack size increased to 8KB for ESP32-S3 and larger displays
-    // On dual-core: pin to Core 0 (Arduino loop runs on Core 1)
-    // On single-core: runs on Core 0 (time-sliced with Arduino loop)
-    #if CONFIG_FREERTOS_UNICORE
-    xTaskCreate(lvglTask, "LVGL", 8192, this, 1, &lvglTaskHandle);
-    LOGI("Display", "Rendering task created (single-core)");
-    #else
-    xTaskCreatePinnedToCore(lvglTask, "LVGL", 8192, this, 1, &lvglTaskHandle, 0);
-    LOGI("Display", "Rendering task created (pinned to Core 0)");
-    #endif
+    // Create LVGL rendering task (core/priority from the task placement table).
+    // Stack size increased to 8KB for ESP32-S3 and larger displays.
+    if (!task_placement_create(AppTask::Lvgl, lvglTask, this, &lvglTaskHandle, nullptr)) {
+        LOGE("Display", "Failed to create rendering task");
+    } else {
+        LOGI("Display", "Rendering task created (core=%d)", (int)task_placement_get(AppTask::Lvgl)->core);
+    }
     
     LOGI("Display", "Manager init complete");
 }
 
+// ============================================================================
+// Pixel shift (burn-in mitigation)
+// ============================================================================
+// Every PIXEL_SHIFT_INTERVAL_S the whole UI moves to the next point of a small
+// orbit around its home position. When the controller can move the image itself
+// (DisplayDriver::setHardwareShift) a shift is a few commands and no pixels;
+// otherwise the children of the active screen get a style translate and the
+// screen redraws once. Nothing runs between shifts.
+
+static const int8_t kPixelShiftOrbit[][2] = {
+    {0, 0}, {1, 0}, {1, 1}, {0, 1}, {-1, 1}, {-1, 0}, {-1, -1}, {0, -1}, {1, -1},
+};
+static constexpr uint8_t kPixelShiftOrbitLen = sizeof(kPixelShiftOrbit) / sizeof(kPixelShiftOrbit[0]);
+
+void DisplayManager::initPixelShift() {
+    #if (PIXEL_SHIFT_INTERVAL_S > 0) && (PIXEL_SHIFT_MAX_PX > 0)
+    const uint8_t hw_x = driver->hardwareShiftRange(true);
+    const uint8_t hw_y = driver->hardwareShiftRange(false);
+    pixelShiftRangeX = (hw_x < PIXEL_SHIFT_MAX_PX) ? hw_x : (uint8_t)PIXEL_SHIFT_MAX_PX;
+    pixelShiftRangeY = (hw_y < PIXEL_SHIFT_MAX_PX) ? hw_y : (uint8_t)PIXEL_SHIFT_MAX_PX;
+
+    lock(LvglLockSite::Display);
+    pixelShiftTimer = lv_timer_create(DisplayManager::pixelShiftTimerCb, (uint32_t)PIXEL_SHIFT_INTERVAL_S * 1000u, this);
+    unlock();
+
+    const bool hardware = (pixelShiftRangeX > 0 || pixelShiftRangeY > 0);
+    LOGI("Display", "Pixel shift: every %ds, up to %dpx (%s)", (int)PIXEL_SHIFT_INTERVAL_S,
+         hardware ? (int)((pixelShiftRangeX > pixelShiftRangeY) ? pixelShiftRangeX : pixelShiftRangeY) : (int)PIXEL_SHIFT_MAX_PX,
+         hardware ? "hardware" : "redraw");
+    #endif
+}
+
+void DisplayManager::pixelShiftTimerCb(lv_timer_t* t) {
+    DisplayManager* mgr = (DisplayManager*)t->user_data;
+    if (!mgr) return;
+    // The image decoder owns the panel while DirectImageScreen is up; skip this step.
+    if (mgr->directImageActive) return;
+
+    mgr->pixelShiftStep = (uint8_t)((mgr->pixelShiftStep + 1) % kPixelShiftOrbitLen);
+    mgr->applyPixelShift();
+}
+
+// LVGL task (display lock held).
+void DisplayManager::applyPixelShift() {
+    const int8_t* p = kPixelShiftOrbit[pixelShiftStep];
+
+    if (pixelShiftRangeX > 0 || pixelShiftRangeY > 0) {
+        (void)driver->setHardwareShift((int16_t)(p[0] * pixelShiftRangeX), (int16_t)(p[1] * pixelShiftRangeY));
+        return;
+    }
+
+    lv_obj_t* scr = lv_scr_act();
+    if (!scr) return;
+    const lv_coord_t dx = (lv_coord_t)(p[0] * PIXEL_SHIFT_MAX_PX);
+    const lv_coord_t dy = (lv_coord_t)(p[1] * PIXEL_SHIFT_MAX_PX);
+    const uint32_t count = lv_obj_get_child_cnt(scr);
+    for (uint32_t i = 0; i < count; i++) {
+        lv_obj_t* child = lv_obj_get_child(scr, (int32_t)i);
+        if (lv_obj_get_style_translate_x(child, LV_PART_MAIN) != dx) lv_obj_set_style_translate_x(child, dx, 0);
+        if (lv_obj_get_style_translate_y(child, LV_PART_MAIN) != dy) lv_obj_set_style_translate_y(child, dy, 0);
+    }
+    // One redraw of the whole screen, including the strip the shift uncovered.
+    lv_obj_invalidate(scr);
+}
+
 void DisplayManager::showSplash() {
     // Splash shown during init - can switch immediately (no task running yet)
-    lock();
+    lock(LvglLockSite::Display);
     if (currentScreen) {
         currentScreen->hide();
     }
     currentScreen = &splashScreen;
+    ensureScreenCreated(currentScreen);
     currentScreen->show();
+    releaseHiddenScreens();
     unlock();
     LOGI("Display", "Switched to SplashScreen");
 }
 
+bool DisplayManager::postCommand(const DisplayCommand& cmd) {
+    if (!cmdQueue) return false;
+    // Never wait: a full queue means the LVGL task is stuck, and blocking the
+    // caller (async_tcp, MQTT, main loop) on it is what this queue avoids.
+    // Transitions pair up (enter/leave) and callers act on them, so only they may
+    // use the reserved slots; a dropped switch or splash text is just stale.
+    const bool transition = cmd.kind != DisplayCommand::Kind::ShowScreen &&
+                            cmd.kind != DisplayCommand::Kind::SplashStatus;
+    const bool full = !transition && uxQueueSpacesAvailable(cmdQueue) <= DISPLAY_CMD_RESERVED_SLOTS;
+    if (full || xQueueSend(cmdQueue, &cmd, 0) != pdTRUE) {
+        const uint32_t dropped = g_cmd_dropped.fetch_add(1, std::memory_order_relaxed) + 1;
+        LOGW("Display", "Command queue full, dropped kind %u (%lu total)", (unsigned)cmd.kind, (unsigned long)dropped);
+        return false;
+    }
+    g_cmd_posted.fetch_add(1, std::memory_order_relaxed);
+    requestRender();
+    return true;
+}
+
+void DisplayManager::drainCommands() {
+    const UBaseType_t waiting = uxQueueMessagesWaiting(cmdQueue);
+    if (waiting == 0) return;
+    if (waiting > g_cmd_queue_peak.load(std::memory_order_relaxed)) {
+        g_cmd_queue_peak.store((uint8_t)waiting, std::memory_order_relaxed);
+    }
+
+    DisplayCommand cmd;
+    while (xQueueReceive(cmdQueue, &cmd, 0) == pdTRUE) {
+        applyCommand(cmd);
+    }
+}
+
+void DisplayManager::applyCommand(const DisplayCommand& cmd) {
+    switch (cmd.kind) {
+        case DisplayCommand::Kind::ShowScreen:
+            pendingScreen = cmd.screen;
+            break;
+
+        case DisplayCommand::Kind::ShowWarning:
+            if (effectiveScreen() == &warningScreen) break;
+            warningPreviousScreen = effectiveScreen();
+            pendingScreen = &warningScreen;
+            break;
+
+        case DisplayCommand::Kind::ReturnFromWarning: {
+            Screen* target = warningPreviousScreen ? warningPreviousScreen : &infoScreen;
+            warningPreviousScreen = nullptr;
+            // If we're already on the target, do nothing.
+            if (effectiveScreen() != target) pendingScreen = target;
+            break;
+        }
+
+        #if HAS_IMAGE_API
+        case DisplayCommand::Kind::ShowDirectImage:
+            if (effectiveScreen() == &directImageScreen) break;
+            // Save current screen so we can return to it after timeout
+            if (effectiveScreen()) previousScreen = effectiveScreen();
+            pendingScreen = &directImageScreen;
+            break;
+
+        case DisplayCommand::Kind::ReturnToPrevious:
+            // If no previous screen, default to info screen
+            pendingScreen = previousScreen ? previousScreen : &infoScreen;
+            previousScreen = nullptr;  // Clear previous screen reference
+            break;
+        #else
+        case DisplayCommand::Kind::ShowDirectImage:
+        case DisplayCommand::Kind::ReturnToPrevious:
+            break;
+        #endif
+
+        case DisplayCommand::Kind::SplashStatus:
+            splashScreen.setStatus(cmd.text);
+            break;
+    }
+}
+
 void DisplayManager::showEnergyMonitor() {
-    // Defer screen switch to lvglTask (non-blocking)
-    pendingScreen = &energyMonitorScreen;
-    LOGI("Display", "Queued switch to EnergyMonitorScreen");
+    DisplayCommand cmd = {DisplayCommand::Kind::ShowScreen, &energyMonitorScreen, {0}};
+    if (postCommand(cmd)) LOGI("Display", "Queued switch to EnergyMonitorScreen");
 }
 
 void DisplayManager::showInfo() {
-    // Defer screen switch to lvglTask (non-blocking)
-    pendingScreen = &infoScreen;
-    LOGI("Display", "Queued switch to InfoScreen");
+    DisplayCommand cmd = {DisplayCommand::Kind::ShowScreen, &infoScreen, {0}};
+    if (postCommand(cmd)) LOGI("Display", "Queued switch to InfoScreen");
 }
 
 void DisplayManager::showTest() {
-    // Defer screen switch to lvglTask (non-blocking)
-    pendingScreen = &testScreen;
-    LOGI("Display", "Queued switch to TestScreen");
+    DisplayCommand cmd = {DisplayCommand::Kind::ShowScreen, &testScreen, {0}};
+    if (postCommand(cmd)) LOGI("Display", "Queued switch to TestScreen");
 }
 
 void DisplayManager::showWarningScreen() {
-    if (currentScreen == &warningScreen) {
-        return;
-    }
-
-    warningPreviousScreen = currentScreen;
-    pendingScreen = &warningScreen;
-    LOGI("Display", "Queued switch to WarningScreen");
+    DisplayCommand cmd = {DisplayCommand::Kind::ShowWarning, nullptr, {0}};
+    if (postCommand(cmd)) LOGI("Display", "Queued switch to WarningScreen");
 }
 
 void DisplayManager::returnFromWarningScreen() {
-    Screen* target = warningPreviousScreen ? warningPreviousScreen : &infoScreen;
-    warningPreviousScreen = nullptr;
-
-    // If we're already on the target, do nothing.
-    if (currentScreen == target) {
-        return;
-    }
-
-    pendingScreen = target;
-    LOGI("Display", "Queued return from WarningScreen");
+    DisplayCommand cmd = {DisplayCommand::Kind::ReturnFromWarning, nullptr, {0}};
+    if (postCommand(cmd)) LOGI("Display", "Queued return from WarningScreen");
 }
 
 #if HAS_IMAGE_API
-void DisplayManager::showDirectImage() {
+bool DisplayManager::showDirectImage() {
     // If we're already showing the DirectImageScreen, don't queue a redundant
     // LVGL screen switch (it would also risk clobbering previousScreen).
     if (currentScreen == &directImageScreen) {
         directImageActive = true;
         LOGI("Display", "Already on DirectImageScreen");
-        return;
+        return true;
     }
 
-    // Save current screen so we can return to it after timeout
-    // If we're already on DirectImageScreen, don't overwrite previousScreen
-    if (currentScreen && currentScreen != &directImageScreen) {
-        previousScreen = currentScreen;
-    }
-    
-    // Defer screen switch to lvglTask (non-blocking)
-    // Immediately gate LVGL flushes so the decoder can safely write even before
+    // Defer screen switch to lvglTask (non-blocking); it also records previousScreen.
+    DisplayCommand cmd = {DisplayCommand::Kind::ShowDirectImage, nullptr, {0}};
+    if (!postCommand(cmd)) return false;
+    // Gate LVGL flushes right away so the decoder can safely write even before
     // the screen switch is processed by the LVGL task.
     // Also drop any pending buffered present() to avoid flushing stale LVGL content
     // over the direct-image content.
     flushPending = false;
     directImageActive = true;
-    pendingScreen = &directImageScreen;
     LOGI("Display", "Queued switch to DirectImageScreen");
+    return true;
 }
 
 void DisplayManager::returnToPreviousScreen() {
-    // Defer screen switch to lvglTask (non-blocking)
-    // If no previous screen, default to info screen
-    Screen* targetScreen = previousScreen ? previousScreen : &infoScreen;
+    // Defer screen switch to lvglTask (non-blocking). If it cannot be queued the
+    // image screen stays up with its flush gate, instead of LVGL drawing over it.
+    DisplayCommand cmd = {DisplayCommand::Kind::ReturnToPrevious, nullptr, {0}};
+    if (!postCommand(cmd)) return;
     directImageActive = false;
-    pendingScreen = targetScreen;
-    previousScreen = nullptr;  // Clear previous screen reference
     LOGI("Display", "Queued return to previous screen");
 }
 #endif
 
+void DisplayManager::trackScreen(Screen* screen, const char* name) {
+    if (residencyCount >= kMaxOwnedScreens) return;
+    residency[residencyCount++] = {screen, name, 0, 0, false};
+}
+
+DisplayManager::ScreenResidency* DisplayManager::residencyFor(const Screen* screen) {
+    for (size_t i = 0; i < residencyCount; i++) {
+        if (residency[i].screen == screen) return &residency[i];
+    }
+    return nullptr;
+}
+
+void DisplayManager::ensureScreenCreated(Screen* screen) {
+    if (!screen) return;
+    ScreenResidency* r = residencyFor(screen);
+    if (!r) {
+        screen->create();
+        return;
+    }
+
+    r->lastShownMs = millis();
+    if (r->created) return;
+
+    const uint32_t before = lvgl_heap_used_bytes();
+    screen->create();
+    const uint32_t after = lvgl_heap_used_bytes();
+    r->bytes = (after > before) ? (after - before) : 0;
+    r->created = true;
+    LOGI("Display", "Built %s screen (%u B LVGL)", r->name, (unsigned)r->bytes);
+}
+
+void DisplayManager::releaseScreen(ScreenResidency& r) {
+    r.screen->destroy();
+    r.created = false;
+    LOGI("Display", "Released %s screen (%u B LVGL)", r.name, (unsigned)r.bytes);
+}
+
+void DisplayManager::releaseHiddenScreens() {
+    // The screen a direct image returns to stays built (no create() on the way back).
+    const Screen* returnScreen = nullptr;
+    #if HAS_IMAGE_API
+    if (currentScreen == &directImageScreen) returnScreen = previousScreen;
+    #endif
+
+    for (size_t i = 0; i < residencyCount; i++) {
+        ScreenResidency& r = residency[i];
+        if (!r.created || r.screen == currentScreen || r.screen == pendingScreen || r.screen == returnScreen) continue;
+        if (r.screen->retention() == ScreenRetention::Ephemeral) releaseScreen(r);
+    }
+
+    #if SCREEN_LVGL_BUDGET_BYTES > 0
+    // Hidden keep-warm screens over budget: drop the least recently shown first.
+    while (true) {
+        uint32_t held = 0;
+        ScreenResidency* lru = nullptr;
+        for (size_t i = 0; i < residencyCount; i++) {
+            ScreenResidency& r = residency[i];
+            if (!r.created || r.screen == currentScreen || r.screen == pendingScreen || r.screen == returnScreen) continue;
+            if (r.screen->retention() != ScreenRetention::KeepWarm) continue;
+            held += r.bytes;
+            if (!lru || (int32_t)(r.lastShownMs - lru->lastShownMs) < 0) lru = &r;
+        }
+        if (!lru || held <= (uint32_t)SCREEN_LVGL_BUDGET_BYTES) break;
+        releaseScreen(*lru);
+    }
+    #endif
+}
+
 void DisplayManager::setSplashStatus(const char* text) {
     // If called before the LVGL task exists (during early setup), update directly.
     // Otherwise, defer to the LVGL task to avoid cross-task LVGL calls.
@@ -567,10 +1220,9 @@ void DisplayManager::setSplashStatus(const char* text) {
         return;
     }
 
-    portENTER_CRITICAL(&g_splash_status_mux);
-    strlcpy(pendingSplashStatus, text ? text : "", sizeof(pendingSplashStatus));
-    pendingSplashStatusSet = true;
-    portEXIT_CRITICAL(&g_splash_status_mux);
+    DisplayCommand cmd = {DisplayCommand::Kind::SplashStatus, nullptr, {0}};
+    strlcpy(cmd.text, text ? text : "", sizeof(cmd.text));
+    postCommand(cmd);
 }
 
 bool DisplayManager::showScreen(const char* screen_id) {
@@ -580,7 +1232,8 @@ bool DisplayManager::showScreen(const char* screen_id) {
     for (size_t i = 0; i < screenCount; i++) {
         if (strcmp(availableScreens[i].id, screen_id) == 0) {
             // Defer screen switch to lvglTask (non-blocking)
-            pendingScreen = availableScreens[i].instance;
+            DisplayCommand cmd = {DisplayCommand::Kind::ShowScreen, availableScreens[i].instance, {0}};
+            if (!postCommand(cmd)) return false;
             LOGI("Display", "Queued switch to screen: %s", screen_id);
             return true;
         }
@@ -590,6 +1243,23 @@ bool DisplayManager::showScreen(const char* screen_id) {
     return false;
 }
 
+void DisplayManager::setRenderSuspended(bool suspended) {
+    if (renderSuspended == suspended) return;
+    renderSuspended = suspended;
+    requestRender();
+}
+
+bool DisplayManager::showAdjacentScreen(int direction) {
+    if (screenCount == 0) return false;
+    const char* current_id = getCurrentScreenId();
+    if (!current_id) return false;
+
+    size_t current = 0;
+    while (current < screenCount && availableScreens[current].instance != currentScreen) current++;
+    const size_t step = (direction < 0) ? screenCount - 1 : 1;
+    return showScreen(availableScreens[(current + step) % screenCount].id);
+}
+
 const char* DisplayManager::getCurrentScreenId() {
     // Return ID of current screen (nullptr if splash or unknown)
     for (size_t i = 0; i < screenCount; i++) {
@@ -663,6 +1333,13 @@ void display_manager_show_screen(const char* screen_id, bool* success) {
     if (success) *success = result;
 }
 
+bool display_manager_show_adjacent_screen(int direction) {
+    if (displayManager) {
+        return displayManager->showAdjacentScreen(direction);
+    }
+    return false;
+}
+
 const char* display_manager_get_current_screen_id() {
     if (displayManager) {
         return displayManager->getCurrentScreenId();
@@ -684,9 +1361,19 @@ void display_manager_set_backlight_brightness(uint8_t brightness) {
     }
 }
 
-void display_manager_lock() {
+void display_manager_set_render_suspended(bool suspended) {
+    if (displayManager) {
+        displayManager->setRenderSuspended(suspended);
+    }
+}
+
+bool display_manager_is_render_suspended() {
+    return !displayManager || displayManager->isRenderSuspended();
+}
+
+void display_manager_lock(LvglLockSite site) {
     if (displayManager) {
-        displayManager->lock();
+        displayManager->lock(site);
     }
 }
 
@@ -696,16 +1383,14 @@ void display_manager_unlock() {
     }
 }
 
-bool display_manager_try_lock(uint32_t timeout_ms) {
+bool display_manager_try_lock(uint32_t timeout_ms, LvglLockSite site) {
     if (!displayManager) return false;
-    return displayManager->tryLock(timeout_ms);
+    return displayManager->tryLock(timeout_ms, site);
 }
 
 #if HAS_IMAGE_API
-void display_manager_show_direct_image() {
-    if (displayManager) {
-        displayManager->showDirectImage();
-    }
+bool display_manager_show_direct_image() {
+    return displayManager && displayManager->showDirectImage();
 }
 
 DirectImageScreen* display_manager_get_direct_image_screen() {
@@ -4,6 +4,7 @@
 #include "board_config.h"
 #include "config_manager.h"
 #include "display_driver.h"
+#include "lvgl_lock_stats.h"
 #include "screens/screen.h"
 #include "screens/splash_screen.h"
 #include "screens/info_screen.h"
@@ -11,6 +12,11 @@
 #include "screens/test_screen.h"
 #include "screens/warning_screen.h"
 
+#if SECONDARY_DISPLAY_DRIVER
+#include "screens/status_panel_screen.h"
+class SPIClass;
+#endif
+
 #if HAS_IMAGE_API
 #include "screens/direct_image_screen.h"
 #include "screens/lvgl_image_screen.h"
@@ -20,6 +26,7 @@
 #include <freertos/FreeRTOS.h>
 #include <freertos/task.h>
 #include <freertos/semphr.h>
+#include <freertos/queue.h>
 
 // ============================================================================
 // Screen Registry
@@ -55,6 +62,8 @@ private:
     DisplayDriver* driver;
     lv_disp_draw_buf_t draw_buf;
     lv_color_t* buf;  // Dynamically allocated LVGL buffer
+    lv_color_t* buf2;  // Optional second LVGL buffer (LVGL_DOUBLE_BUFFER + async flush)
+    uint32_t bufPixels = LVGL_BUFFER_SIZE;  // per buffer (LVGL_BUFFER_ADAPTIVE may raise it)
     lv_disp_drv_t disp_drv;
     
     // Configuration reference
@@ -67,12 +76,35 @@ private:
     // Screen management
     Screen* currentScreen;
     Screen* previousScreen;  // Track previous screen for return navigation
-    Screen* pendingScreen;   // Deferred screen switch (processed in lvglTask)
+    Screen* pendingScreen;   // Screen switch for this frame (LVGL task only, set by a command)
     Screen* warningPreviousScreen;  // Track previous screen when showing warning
 
-    // Defer small LVGL UI updates (like splash status) to the LVGL task.
-    char pendingSplashStatus[96];
-    volatile bool pendingSplashStatusSet;
+    // Cross-task display commands: screen switches, warning/direct-image
+    // transitions and splash status are posted here (never blocking the caller)
+    // and applied by lvglTask, with the LVGL mutex held, at the start of a frame.
+    // Several switches posted between two frames collapse into one redraw.
+    struct DisplayCommand {
+        enum class Kind : uint8_t {
+            ShowScreen,
+            ShowWarning,
+            ReturnFromWarning,
+            ShowDirectImage,
+            ReturnToPrevious,
+            SplashStatus,
+        } kind;
+        Screen* screen;      // ShowScreen
+        char text[96];       // SplashStatus
+    };
+    // Transitions (warning and direct-image enter/leave) may also use the last
+    // DISPLAY_CMD_RESERVED_SLOTS slots; switches and splash text may not.
+    QueueHandle_t cmdQueue;
+    StaticQueue_t cmdQueueStruct;
+    uint8_t cmdQueueStorage[(DISPLAY_CMD_QUEUE_DEPTH + DISPLAY_CMD_RESERVED_SLOTS) * sizeof(DisplayCommand)];
+    bool postCommand(const DisplayCommand& cmd);
+    void drainCommands();
+    void applyCommand(const DisplayCommand& cmd);
+    // Screen after the switch already decided for this frame (LVGL task).
+    Screen* effectiveScreen() const { return pendingScreen ? pendingScreen : currentScreen; }
 
     // Helpers: avoid taking the LVGL mutex when already inside the LVGL task
     bool isInLvglTask() const;
@@ -99,6 +131,25 @@ private:
     ScreenInfo availableScreens[MAX_SCREENS];
     size_t screenCount;
 
+    // Lazy screen lifecycle: widget trees are built on first show and released
+    // again per Screen::retention() (see SCREEN_LAZY_CREATE / SCREEN_LVGL_BUDGET_BYTES).
+    struct ScreenResidency {
+        Screen* screen;
+        const char* name;
+        uint32_t bytes;          // LVGL bytes measured around create() (0 = unknown)
+        uint32_t lastShownMs;
+        bool created;
+    };
+    static constexpr size_t kMaxOwnedScreens = 7;
+    ScreenResidency residency[kMaxOwnedScreens];
+    size_t residencyCount;
+    void trackScreen(Screen* screen, const char* name);
+    ScreenResidency* residencyFor(const Screen* screen);
+    // Both run with the LVGL mutex held (LVGL task or init).
+    void ensureScreenCreated(Screen* screen);
+    void releaseHiddenScreens();
+    void releaseScreen(ScreenResidency& r);
+
     // Internal helper: map a Screen instance to its logical screen id.
     // Uses the registered screen list so adding new screens doesn't require
     // updating logging code.
@@ -111,6 +162,16 @@ private:
     // LVGL flush callback (static, accesses instance via user_data)
     static void flushCallback(lv_disp_drv_t *disp, const lv_area_t *area, lv_color_t *color_p);
 
+    // LVGL wait callback (double-buffered async flush): completes the in-flight transfer
+    // before LVGL hands over the next buffer.
+    static void flushWaitCallback(lv_disp_drv_t *disp);
+
+    // Finish the last async transfer of a frame and release the bus.
+    void completeAsyncFlush();
+
+    // True when the driver queues flushes via DMA into a double-buffered LVGL setup.
+    bool asyncFlush;
+
     // Buffered render-mode drivers (e.g., Arduino_GFX canvas) need an explicit
     // present() step, but only after LVGL has actually rendered something.
     bool flushPending;
@@ -119,7 +180,47 @@ private:
     // This is enabled as soon as DirectImageScreen is requested so that
     // the JPEG decoder can safely write to the display without SPI contention.
     volatile bool directImageActive;
+
+    // Screen saver asleep (backlight off): lvglTask parks instead of rendering into a dark panel.
+    volatile bool renderSuspended;
+    bool renderParked;
     
+    // Refresh-rate governor: retunes LVGL's display refresh timer to the current
+    // screen's refreshPeriodMs() (checked every frame; cheap when unchanged).
+    uint32_t appliedRefreshPeriodMs;
+    void applyRefreshGovernor();
+
+    // Stop/restart LVGL's display refresh timer (nothing is rendered while paused;
+    // invalidations accumulate and are drawn once on resume).
+    void pauseLvglRefresh(bool paused);
+
+    // Burn-in pixel shift (PIXEL_SHIFT_INTERVAL_S): an LVGL timer steps the UI around
+    // a small orbit. Non-zero ranges = the driver moves the image in hardware;
+    // otherwise the active screen's children are translated and redrawn once.
+    lv_timer_t* pixelShiftTimer = nullptr;
+    uint8_t pixelShiftStep = 0;
+    uint8_t pixelShiftRangeX = 0;
+    uint8_t pixelShiftRangeY = 0;
+    void initPixelShift();
+    void applyPixelShift();
+    static void pixelShiftTimerCb(lv_timer_t* t);
+
+    #if SECONDARY_DISPLAY_DRIVER
+    // Optional secondary status panel: its own driver, draw buffer, LVGL display and
+    // refresh period, rendered by lvglTask next to the main panel. LVGL runs each
+    // display's refresh timer when it comes due, so a slow frame on one panel
+    // delays the other by at most that frame, never starves it.
+    DisplayDriver* secondaryDriver = nullptr;
+    SPIClass* secondarySpi = nullptr;
+    lv_disp_draw_buf_t secondaryDrawBuf;
+    lv_disp_drv_t secondaryDispDrv;
+    lv_color_t* secondaryBuf = nullptr;
+    lv_disp_t* secondaryDisp = nullptr;
+    StatusPanelScreen statusPanelScreen;
+    void initSecondaryDisplay();
+    static void secondaryFlushCallback(lv_disp_drv_t *disp, const lv_area_t *area, lv_color_t *color_p);
+    #endif
+
     // FreeRTOS task for LVGL rendering
     static void lvglTask(void* pvParameter);
     
@@ -139,12 +240,21 @@ public:
     void returnFromWarningScreen();
     
     #if HAS_IMAGE_API
-    void showDirectImage();
+    bool showDirectImage();         // false = not queued (LVGL flushes stay ungated)
     void returnToPreviousScreen();  // Return to screen before image was shown
     #endif
     
+    // Park/unpark the LVGL render task (no lv_timer_handler, screen updates or flushes).
+    // Queued screen switches still render once; resuming redraws the active screen.
+    void setRenderSuspended(bool suspended);
+    bool isRenderSuspended() const { return renderSuspended; }
+
     // Screen selection by ID (thread-safe, returns true if found)
     bool showScreen(const char* screen_id);
+
+    // Step through the registered screens (+1 next, -1 previous, wrapping).
+    // No-op (false) while a non-registered screen (splash, warning, image) is shown.
+    bool showAdjacentScreen(int direction);
     
     // Get current screen ID (returns nullptr if splash or no screen)
     const char* getCurrentScreenId();
@@ -155,13 +265,17 @@ public:
     // Splash status update (thread-safe)
     void setSplashStatus(const char* text);
     
-    // Mutex helpers for external thread-safe access
-    void lock();
+    // Mutex helpers for external thread-safe access; `site` tags the caller
+    // for the wait/hold stats (lvgl_lock_stats.h).
+    void lock(LvglLockSite site = LvglLockSite::Other);
     void unlock();
 
     // Attempt to lock the LVGL mutex with a timeout (in milliseconds).
     // Returns true if the lock was acquired.
-    bool tryLock(uint32_t timeoutMs);
+    bool tryLock(uint32_t timeoutMs, LvglLockSite site = LvglLockSite::Other);
+
+    // Wake the LVGL task early (task context only; cheap, safe to call often).
+    void requestRender();
 
     // Active LVGL logical resolution (post driver->configureLVGL()).
     // Prefer using these instead of calling LVGL APIs from non-LVGL tasks.
@@ -185,11 +299,34 @@ public:
     DisplayDriver* getDriver() { return driver; }
 };
 
+// Approximate distribution of one perf metric over the last histogram window.
+struct DisplayPerfDist {
+    uint32_t p50;
+    uint32_t p95;
+    uint32_t max;
+};
+
 // Lightweight rendering/perf snapshot (best-effort).
 struct DisplayPerfStats {
     uint16_t fps;
     uint32_t lv_timer_us;
     uint32_t present_us;
+
+    // Rolling distributions (DISPLAY_PERF_HIST_WINDOW_MS window).
+    DisplayPerfDist lv_timer_dist_us;  // lv_timer_handler() time on frames that flushed
+    DisplayPerfDist flush_dist_us;     // time spent per LVGL flush callback
+    DisplayPerfDist flush_dist_px;     // pixels per LVGL flush callback
+    uint32_t bus_bytes_per_s;          // pixel bytes sent to the panel
+
+    // Draw buffer chosen at boot (see LVGL_BUFFER_ADAPTIVE).
+    uint32_t draw_buf_px;              // pixels per buffer
+    uint16_t draw_buf_lines;           // band height
+    uint8_t draw_buf_count;            // 1, or 2 with async double buffering
+
+    // Cross-task command queue (DISPLAY_CMD_QUEUE_DEPTH).
+    uint32_t cmd_posted;
+    uint32_t cmd_dropped;              // queue full: command lost
+    uint8_t cmd_queue_peak;            // most commands waiting at a frame start
 };
 
 // Global instance (managed by app.ino)
@@ -204,16 +341,28 @@ void display_manager_show_test();
 void display_manager_show_warning_screen();
 void display_manager_return_from_warning_screen();
 void display_manager_show_screen(const char* screen_id, bool* success);  // success is optional output
+bool display_manager_show_adjacent_screen(int direction);
 const char* display_manager_get_current_screen_id();
 const ScreenInfo* display_manager_get_available_screens(size_t* count);
 void display_manager_set_splash_status(const char* text);
 void display_manager_set_backlight_brightness(uint8_t brightness);  // 0-100%
+void display_manager_set_render_suspended(bool suspended);
+bool display_manager_is_render_suspended();  // true while parked (or before display init)
 
 // Serialization helpers for code running outside the LVGL task.
 // Use these to avoid concurrent access to buffered display backends (e.g., Arduino_GFX canvas).
-void display_manager_lock();
+void display_manager_lock(LvglLockSite site = LvglLockSite::Other);
 void display_manager_unlock();
-bool display_manager_try_lock(uint32_t timeout_ms);
+bool display_manager_try_lock(uint32_t timeout_ms, LvglLockSite site = LvglLockSite::Other);
+
+// Wake the LVGL render task (e.g. new data for the current screen).
+// Safe to call from any task, including before display init (no-op).
+void display_manager_request_render();
+
+// Device name or network state changed (config save, WiFi/AP events): bumps the
+// generation InfoScreen compares against, then wakes the render task. Any task.
+void display_manager_notify_info_changed();
+uint32_t display_manager_info_generation();
 
 // Best-effort perf stats for diagnostics (/api/health).
 // Returns false until a first stats window has been captured.
@@ -221,7 +370,8 @@ bool display_manager_get_perf_stats(DisplayPerfStats* out);
 
 #if HAS_IMAGE_API
 // C-style interface for image API
-void display_manager_show_direct_image();
+// False when the switch could not be queued: do not draw to the panel then.
+bool display_manager_show_direct_image();
 DirectImageScreen* display_manager_get_direct_image_screen();
 #if LV_USE_IMG
 LvglImageScreen* display_manager_get_lvgl_image_screen();
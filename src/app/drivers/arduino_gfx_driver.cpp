@@ -6,12 +6,13 @@
  */
 
 #include "arduino_gfx_driver.h"
+#include "../backlight_pwm.h"
 #include "../log_manager.h"
 
 Arduino_GFX_Driver::Arduino_GFX_Driver() 
     : bus(nullptr), gfx(nullptr), canvas(nullptr), currentBrightness(100), backlightPwmAttached(false),
       displayWidth(DISPLAY_WIDTH), displayHeight(DISPLAY_HEIGHT), displayRotation(DISPLAY_ROTATION),
-      currentX(0), currentY(0), currentW(0), currentH(0) {
+      currentX(0), currentY(0), currentW(0), currentH(0), dirtyRowMin(-1), dirtyRowMax(-1), presentBytes(0) {
 }
 
 Arduino_GFX_Driver::~Arduino_GFX_Driver() {
@@ -135,16 +136,11 @@ void Arduino_GFX_Driver::setBacklightBrightness(uint8_t brightness) {
     currentBrightness = brightness;
 
     #if HAS_BACKLIGHT
-    uint32_t duty = (brightness * 255) / 100;
-
-    // Handle active low vs active high backlight
-    #ifdef TFT_BACKLIGHT_ON
-    if (!TFT_BACKLIGHT_ON) {
-        duty = 255 - duty;
-    }
-    #endif
+    // Gamma-corrected duty (inverted for active-low)
+    const uint32_t duty = backlight_pwm_duty(brightness, BACKLIGHT_PWM_ACTIVE_LOW);
 
     #if ESP_ARDUINO_VERSION_MAJOR >= 3
+    backlight_pwm_stop_fade(LCD_BL_PIN);
     ledcWrite(LCD_BL_PIN, duty);  // New API: write to pin directly
     #else
     ledcWrite(TFT_BACKLIGHT_PWM_CHANNEL, duty);  // Old API: write to channel
@@ -159,6 +155,20 @@ void Arduino_GFX_Driver::setBacklightBrightness(uint8_t brightness) {
     #endif
 }
 
+bool Arduino_GFX_Driver::fadeBacklightTo(uint8_t brightness, uint16_t duration_ms) {
+    #if defined(LCD_BL_PIN) && HAS_BACKLIGHT
+    if (brightness > 100) brightness = 100;
+    if (!backlightPwmAttached) return false;
+    if (!backlight_pwm_fade(LCD_BL_PIN, backlight_pwm_duty(brightness, BACKLIGHT_PWM_ACTIVE_LOW), duration_ms)) return false;
+    currentBrightness = brightness;
+    return true;
+    #else
+    (void)brightness;
+    (void)duration_ms;
+    return false;
+    #endif
+}
+
 uint8_t Arduino_GFX_Driver::getBacklightBrightness() {
     return currentBrightness;
 }
@@ -200,7 +210,42 @@ void Arduino_GFX_Driver::pushColors(uint16_t* data, uint32_t len, bool swap_byte
     // Note: canvas accumulates draws; flush happens in LVGL rendering task
     if (canvas) {
         canvas->draw16bitRGBBitmap(currentX, currentY, data, currentW, currentH);
+        markDirty(currentX, currentY, currentW, currentH);
+    }
+}
+
+void Arduino_GFX_Driver::markDirty(int16_t x, int16_t y, uint16_t w, uint16_t h) {
+    if (w == 0 || h == 0) return;
+
+    // Map the logical (rotated) area to physical framebuffer rows.
+    // Matches Arduino_Canvas pixel addressing: rotation 1/3 map logical X to panel rows.
+    int32_t r0;
+    int32_t r1;
+    switch (displayRotation) {
+        case 1:
+            r0 = x;
+            r1 = x + w - 1;
+            break;
+        case 2:
+            r0 = (int32_t)displayHeight - (y + h);
+            r1 = (int32_t)displayHeight - 1 - y;
+            break;
+        case 3:
+            r0 = (int32_t)displayHeight - (x + w);
+            r1 = (int32_t)displayHeight - 1 - x;
+            break;
+        default:
+            r0 = y;
+            r1 = y + h - 1;
+            break;
     }
+
+    if (r0 < 0) r0 = 0;
+    if (r1 > (int32_t)displayHeight - 1) r1 = (int32_t)displayHeight - 1;
+    if (r0 > r1) return;
+
+    if (dirtyRowMin < 0 || r0 < dirtyRowMin) dirtyRowMin = (int16_t)r0;
+    if (dirtyRowMax < 0 || r1 > dirtyRowMax) dirtyRowMax = (int16_t)r1;
 }
 
 DisplayDriver::RenderMode Arduino_GFX_Driver::renderMode() const {
@@ -210,9 +255,32 @@ DisplayDriver::RenderMode Arduino_GFX_Driver::renderMode() const {
 void Arduino_GFX_Driver::present() {
     // Push canvas buffer to physical display.
     // Called by DisplayManager only when LVGL produced draw data.
-    if (canvas) {
-        canvas->flush();
+    presentBytes = 0;
+    if (!canvas) return;
+    if (dirtyRowMin < 0) return;
+
+    const int16_t r0 = dirtyRowMin;
+    const int16_t r1 = dirtyRowMax;
+    dirtyRowMin = -1;
+    dirtyRowMax = -1;
+
+    // Only push the rows touched since the last present (e.g. a value label update
+    // sends a thin band instead of the full 320x480 frame).
+    #if ARDUINO_GFX_PARTIAL_PRESENT
+    uint16_t* fb = canvas->getFramebuffer();
+    const uint16_t rows = (uint16_t)(r1 - r0 + 1);
+    if (fb && gfx && rows < displayHeight) {
+        gfx->draw16bitRGBBitmap(0, r0, fb + (size_t)r0 * displayWidth, displayWidth, rows);
+        presentBytes = (uint32_t)rows * displayWidth * 2;
+        return;
     }
+    #else
+    (void)r0;
+    (void)r1;
+    #endif
+
+    canvas->flush();
+    presentBytes = (uint32_t)displayWidth * displayHeight * 2;
 }
 
 void Arduino_GFX_Driver::configureLVGL(lv_disp_drv_t* drv, uint8_t rotation) {
@@ -29,6 +29,13 @@ private:
     // Current drawing area (set by setAddrWindow, used by pushColors)
     int16_t currentX, currentY;
     uint16_t currentW, currentH;
+
+    // Dirty physical framebuffer rows since the last present() (-1 = clean).
+    // Tracked as a single full-width row band: partial column windows gain little on
+    // QSPI and keep the panel address logic simple.
+    int16_t dirtyRowMin, dirtyRowMax;
+    uint32_t presentBytes;
+    void markDirty(int16_t x, int16_t y, uint16_t w, uint16_t h);
     
 public:
     Arduino_GFX_Driver();
@@ -42,6 +49,7 @@ public:
     void setBacklightBrightness(uint8_t brightness) override;  // 0-100%
     uint8_t getBacklightBrightness() override;
     bool hasBacklightControl() override;
+    bool fadeBacklightTo(uint8_t brightness, uint16_t duration_ms) override;
     void applyDisplayFixes() override;
     
     void startWrite() override;
@@ -50,7 +58,8 @@ public:
     void pushColors(uint16_t* data, uint32_t len, bool swap_bytes = true) override;
 
     RenderMode renderMode() const override;
-    void present() override;  // Flush canvas buffer to physical display
+    void present() override;  // Flush dirty canvas rows to physical display
+    uint32_t lastPresentBytes() const override { return presentBytes; }
     
     // Override LVGL configuration to use software rotation
     void configureLVGL(lv_disp_drv_t* drv, uint8_t rotation) override;
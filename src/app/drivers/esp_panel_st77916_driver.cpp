@@ -270,6 +270,11 @@ void ESPPanel_ST77916_Driver::init() {
 
     // Allocate a reusable swap buffer for optional byte swapping.
     // Size it to the LVGL draw buffer so we can swap+flush in one drawBitmap call.
+    // Not needed with LVGL_COLOR_16_SWAP: LVGL's buffer goes to the panel as-is.
+    #if LVGL_COLOR_16_SWAP
+    swapBufCapacityPixels = 0;
+    LOGI("ESP_Panel", "LVGL renders wire-order pixels; zero-copy flush");
+    #else
     swapBufCapacityPixels = (uint32_t)LVGL_BUFFER_SIZE;
     if (ESP_PANEL_SWAPBUF_PREFER_INTERNAL) {
         swapBuf = (uint16_t*)heap_caps_malloc(sizeof(uint16_t) * swapBufCapacityPixels, MALLOC_CAP_INTERNAL | MALLOC_CAP_8BIT);
@@ -284,6 +289,7 @@ void ESPPanel_ST77916_Driver::init() {
             swapBuf = (uint16_t*)heap_caps_malloc(sizeof(uint16_t) * swapBufCapacityPixels, MALLOC_CAP_INTERNAL | MALLOC_CAP_8BIT);
         }
     }
+    #endif
 
     LOGI("ESP_Panel", "Display initialized");
 }
@@ -1,52 +1,63 @@
 #include "st7789v2_driver.h"
+#include "../backlight_pwm.h"
 #include "../log_manager.h"
 
-ST7789V2_Driver::ST7789V2_Driver() : spi(&SPI), currentBrightness(100) {
-    // Initialize SPI pointer to default hardware SPI
+#if DISPLAY_DRIVER == DISPLAY_DRIVER_ST7789V2
+ST7789V2_Driver::ST7789V2_Driver()
+    : ST7789V2_Driver(ST7789V2_Config{&SPI, LCD_SCK_PIN, LCD_MOSI_PIN, LCD_CS_PIN, LCD_DC_PIN, LCD_RST_PIN, LCD_BL_PIN,
+                                      (uint16_t)DISPLAY_WIDTH, (uint16_t)DISPLAY_HEIGHT, 20}) {
+}
+#endif
+
+ST7789V2_Driver::ST7789V2_Driver(const ST7789V2_Config& config) : cfg(config), spi(config.spi ? config.spi : &SPI), currentBrightness(100) {
+}
+
+// Rows the image can scroll before GRAM outside the written area shows.
+uint16_t ST7789V2_Driver::shiftRange() const {
+    const uint16_t below = (uint16_t)(kGramRows - cfg.y_offset - cfg.height);
+    return (cfg.y_offset < below) ? cfg.y_offset : below;
 }
 
 void ST7789V2_Driver::writeCommand(uint8_t cmd) {
-    digitalWrite(LCD_DC_PIN, LOW);
+    digitalWrite(cfg.dc, LOW);
     spi->transfer(cmd);
-    digitalWrite(LCD_DC_PIN, HIGH);  // Return to data mode
+    digitalWrite(cfg.dc, HIGH);  // Return to data mode
 }
 
 void ST7789V2_Driver::writeData(uint8_t data) {
-    digitalWrite(LCD_DC_PIN, HIGH);
+    digitalWrite(cfg.dc, HIGH);
     spi->transfer(data);
 }
 
 void ST7789V2_Driver::setWindow(uint16_t x0, uint16_t y0, uint16_t x1, uint16_t y1) {
-    // 1.69" module uses 20px Y offset (panel always in portrait mode)
-    const uint16_t y_offset = 20;
-    const uint16_t x_offset = 0;
+    // The 1.69" module shows GRAM from row 20 (panel always in portrait mode)
+    setGramWindow(x0, y0 + cfg.y_offset, x1, y1 + cfg.y_offset);
+}
 
+void ST7789V2_Driver::setGramWindow(uint16_t x0, uint16_t y0, uint16_t x1, uint16_t y1) {
     writeCommand(ST7789_CASET);
-    writeData((x0 + x_offset) >> 8);
-    writeData((x0 + x_offset) & 0xFF);
-    writeData((x1 + x_offset) >> 8);
-    writeData((x1 + x_offset) & 0xFF);
+    writeData(x0 >> 8);
+    writeData(x0 & 0xFF);
+    writeData(x1 >> 8);
+    writeData(x1 & 0xFF);
 
     writeCommand(ST7789_RASET);
-    writeData((y0 + y_offset) >> 8);
-    writeData((y0 + y_offset) & 0xFF);
-    writeData((y1 + y_offset) >> 8);
-    writeData((y1 + y_offset) & 0xFF);
+    writeData(y0 >> 8);
+    writeData(y0 & 0xFF);
+    writeData(y1 >> 8);
+    writeData(y1 & 0xFF);
 
     writeCommand(ST7789_RAMWR);
 }
 
-void ST7789V2_Driver::rgb565ToBgr565(uint16_t* pixels, uint32_t count) {
-    // LVGL blends colors in RGB space, but ST7789V2 display expects BGR
-    // Swapping here fixes color artifacts on anti-aliased text edges
-    for (uint32_t i = 0; i < count; i++) {
-        uint16_t color = pixels[i];
-        // Extract RGB components from RGB565
-        uint16_t r = (color >> 11) & 0x1F;  // 5 bits red
-        uint16_t g = (color >> 5) & 0x3F;   // 6 bits green
-        uint16_t b = color & 0x1F;          // 5 bits blue
-        // Recombine as BGR565
-        pixels[i] = (b << 11) | (g << 5) | r;
+// Blank GRAM rows [y0, y1) across the full width (CS must be held by the caller).
+void ST7789V2_Driver::clearGramRows(uint16_t y0, uint16_t y1) {
+    if (y1 <= y0) return;
+    static const uint8_t kBlackRow[kGramCols * 2] = {};
+    setGramWindow(0, y0, cfg.width - 1, y1 - 1);
+    digitalWrite(cfg.dc, HIGH);
+    for (uint16_t y = y0; y < y1; y++) {
+        spi->writeBytes(kBlackRow, sizeof(kBlackRow));
     }
 }
 
@@ -54,19 +65,19 @@ void ST7789V2_Driver::init() {
     LOGI("ST7789V2", "Initializing native driver");
     
     // Configure GPIO pins
-    pinMode(LCD_CS_PIN, OUTPUT);
-    pinMode(LCD_DC_PIN, OUTPUT);
-    pinMode(LCD_RST_PIN, OUTPUT);
-    pinMode(LCD_BL_PIN, OUTPUT);
+    pinMode(cfg.cs, OUTPUT);
+    pinMode(cfg.dc, OUTPUT);
+    pinMode(cfg.rst, OUTPUT);
+    if (cfg.bl >= 0) pinMode(cfg.bl, OUTPUT);
 
-    digitalWrite(LCD_CS_PIN, HIGH);
-    digitalWrite(LCD_DC_PIN, HIGH);
+    digitalWrite(cfg.cs, HIGH);
+    digitalWrite(cfg.dc, HIGH);
 
     // Start backlight off until init completes
-    analogWrite(LCD_BL_PIN, 0);
+    if (cfg.bl >= 0) analogWrite(cfg.bl, 0);
 
     // SPI (Mode 3, MSB first) per Waveshare sample
-    spi->begin(LCD_SCK_PIN, -1, LCD_MOSI_PIN, LCD_CS_PIN);
+    spi->begin(cfg.sck, -1, cfg.mosi, cfg.cs);
     spi->setDataMode(SPI_MODE3);
     spi->setBitOrder(MSBFIRST);
     spi->setFrequency(60000000); // 60MHz - within ST7789 spec
@@ -74,18 +85,19 @@ void ST7789V2_Driver::init() {
     LOGI("ST7789V2", "SPI initialized at 60MHz");
 
     // Hardware reset (matches sample timing)
-    digitalWrite(LCD_CS_PIN, LOW);
+    digitalWrite(cfg.cs, LOW);
     delay(20);
-    digitalWrite(LCD_RST_PIN, LOW);
+    digitalWrite(cfg.rst, LOW);
     delay(20);
-    digitalWrite(LCD_RST_PIN, HIGH);
+    digitalWrite(cfg.rst, HIGH);
     delay(120);
 
     // ST7789V2 init sequence (from Waveshare sample)
-    // BGR mode (manufacturer default) - we swap RGB→BGR in pushColors
-    // This allows LVGL to blend colors correctly in RGB space, fixing anti-aliasing artifacts
+    // MADCTL bit 3 selects the panel's color order in hardware (0 = RGB), so
+    // LVGL's RGB565 output and decoded images go to the panel without any
+    // per-pixel RGB/BGR swap.
     writeCommand(0x36);
-    writeData(0x00);  // BGR mode (bit 3 = 0), portrait orientation
+    writeData(0x00);  // RGB order (bit 3 = 0), portrait orientation
 
     writeCommand(0x3A);
     writeData(0x05);
@@ -171,7 +183,7 @@ void ST7789V2_Driver::init() {
     delay(20);
     
     // End init sequence transaction
-    digitalWrite(LCD_CS_PIN, HIGH);
+    digitalWrite(cfg.cs, HIGH);
 
     LOGI("ST7789V2", "Display initialized");
     
@@ -182,6 +194,7 @@ void ST7789V2_Driver::init() {
 }
 
 void ST7789V2_Driver::setRotation(uint8_t rotation) {
+    rotationSetting = rotation;
     // Rotation is handled by LVGL software rotation (set in display_manager.cpp)
     // ST7789V2 panel stays in portrait mode (240x280)
     // No action needed here - just log for clarity
@@ -196,11 +209,11 @@ void ST7789V2_Driver::setBacklightBrightness(uint8_t brightness) {
     if (brightness > 100) brightness = 100;
     currentBrightness = brightness;
     
-    // Map 0-100% to 0-255 PWM duty cycle
-    uint32_t dutyCycle = (brightness * 255) / 100;
+    // Map 0-100% to a gamma-corrected 0-255 PWM duty cycle
+    const uint32_t dutyCycle = backlight_pwm_duty(brightness, false);
     
     // Simple Arduino-style PWM (matches Waveshare sample behavior)
-    analogWrite(LCD_BL_PIN, dutyCycle);
+    if (cfg.bl >= 0) analogWrite(cfg.bl, dutyCycle);
 }
 
 uint8_t ST7789V2_Driver::getBacklightBrightness() {
@@ -219,12 +232,12 @@ void ST7789V2_Driver::applyDisplayFixes() {
 
 void ST7789V2_Driver::startWrite() {
     // Begin SPI transaction
-    digitalWrite(LCD_CS_PIN, LOW);
+    digitalWrite(cfg.cs, LOW);
 }
 
 void ST7789V2_Driver::endWrite() {
     // End SPI transaction
-    digitalWrite(LCD_CS_PIN, HIGH);
+    digitalWrite(cfg.cs, HIGH);
 }
 
 void ST7789V2_Driver::setAddrWindow(int16_t x, int16_t y, uint16_t w, uint16_t h) {
@@ -232,13 +245,12 @@ void ST7789V2_Driver::setAddrWindow(int16_t x, int16_t y, uint16_t w, uint16_t h
 }
 
 void ST7789V2_Driver::pushColors(uint16_t* data, uint32_t len, bool swap_bytes) {
-    // NOTE: Removed RGB→BGR swap - this panel appears to be in RGB mode
-    // (despite 0x36=0x00 configuration which should be BGR mode)
-    // If colors appear correct without swap, the panel ignores the BGR bit
-    // or has different register mapping than standard ST7789V2
-    
+    // Color order is handled by MADCTL (see init()); pixels are sent as-is.
+    // Callers that already pack MSB-first pixels pass swap_bytes=false
+    // (see acceptsWireOrderPixels()) and skip both swap passes below.
+
     // Push pixel data
-    digitalWrite(LCD_DC_PIN, HIGH);
+    digitalWrite(cfg.dc, HIGH);
     // CS already managed by startWrite/endWrite
 
     if (!data || len == 0) {
@@ -272,6 +284,44 @@ void ST7789V2_Driver::pushColors(uint16_t* data, uint32_t len, bool swap_bytes)
     }
 }
 
+// Only the panel's native vertical axis can scroll; under LVGL's 90/270 degree
+// software rotation that is the logical x axis.
+uint8_t ST7789V2_Driver::hardwareShiftRange(bool horizontal) const {
+    const bool native_vertical = (rotationSetting & 1) ? horizontal : !horizontal;
+    return native_vertical ? (uint8_t)shiftRange() : 0;
+}
+
+bool ST7789V2_Driver::setHardwareShift(int16_t dx, int16_t dy) {
+    const int16_t along = (rotationSetting & 1) ? dx : dy;
+    const int16_t across = (rotationSetting & 1) ? dy : dx;
+    const int16_t range = (int16_t)shiftRange();
+    if (across != 0 || along > range || along < -range) return false;
+
+    startWrite();
+    if (!scrollAreaReady) {
+        // The GRAM rows above and below the visible ones scroll into view: blank
+        // them once, then make the whole GRAM the vertical scroll area.
+        clearGramRows(0, cfg.y_offset);
+        clearGramRows(cfg.y_offset + cfg.height, kGramRows);
+        writeCommand(ST7789_VSCRDEF);
+        writeData(0x00);  // top fixed area
+        writeData(0x00);
+        writeData(kGramRows >> 8);
+        writeData(kGramRows & 0xFF);
+        writeData(0x00);  // bottom fixed area
+        writeData(0x00);
+        scrollAreaReady = true;
+    }
+
+    // Display line n shows GRAM row (n + start) mod 320; pixel data is untouched.
+    const uint16_t start = (uint16_t)((kGramRows + along) % kGramRows);
+    writeCommand(ST7789_VSCRSADD);
+    writeData(start >> 8);
+    writeData(start & 0xFF);
+    endWrite();
+    return true;
+}
+
 // Configure LVGL display driver for ST7789V2-specific behavior
 void ST7789V2_Driver::configureLVGL(lv_disp_drv_t* drv, uint8_t rotation) {
     // ST7789V2 panel stays in portrait mode (240x280)
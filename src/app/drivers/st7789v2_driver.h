@@ -5,10 +5,14 @@
  * Direct SPI control for maximum performance (60MHz).
  * 
  * Features:
- * - BGR565 color swap for proper anti-aliasing
+ * - RGB color order via MADCTL (no per-pixel RGB/BGR swap)
  * - 20px Y-offset handling for 1.69" panel
  * - PWM backlight control (0-100%)
  * - Landscape mode via LVGL software rotation
+ * - Hardware pixel shift along the panel's long axis (vertical scroll into the
+ *   GRAM rows the 280-line panel does not show)
+ * - Pins/geometry from ST7789V2_Config, so a second panel (SECONDARY_DISPLAY_*)
+ *   can run its own instance on another SPI bus
  */
 
 #ifndef ST7789V2_DRIVER_H
@@ -22,28 +26,54 @@
 #define ST7789_CASET   0x2A
 #define ST7789_RASET   0x2B
 #define ST7789_RAMWR   0x2C
+#define ST7789_VSCRDEF 0x33
+#define ST7789_VSCRSADD 0x37
+
+// Wiring and native (portrait) geometry of one panel. Pins < 0 are not connected.
+struct ST7789V2_Config {
+    SPIClass* spi;       // nullptr = default SPI
+    int8_t sck;
+    int8_t mosi;
+    int8_t cs;
+    int8_t dc;
+    int8_t rst;
+    int8_t bl;
+    uint16_t width;
+    uint16_t height;
+    uint16_t y_offset;   // first GRAM row the panel shows (20 on the 240x280 module)
+};
 
 class ST7789V2_Driver : public DisplayDriver {
 private:
+    ST7789V2_Config cfg;
     SPIClass* spi;
     uint8_t currentBrightness;
+    uint8_t rotationSetting = 0;
+    bool scrollAreaReady = false;
+
+    // Controller GRAM; the panel shows cfg.height rows of it from cfg.y_offset.
+    static constexpr uint16_t kGramRows = 320;
+    static constexpr uint16_t kGramCols = 240;
+    uint16_t shiftRange() const;
     
     // Low-level SPI communication
     void writeCommand(uint8_t cmd);
     void writeData(uint8_t data);
     void setWindow(uint16_t x0, uint16_t y0, uint16_t x1, uint16_t y1);
-    
-    // RGB565 to BGR565 color swap for anti-aliasing fix
-    void rgb565ToBgr565(uint16_t* pixels, uint32_t count);
+    void setGramWindow(uint16_t x0, uint16_t y0, uint16_t x1, uint16_t y1);
+    void clearGramRows(uint16_t y0, uint16_t y1);
     
 public:
-    ST7789V2_Driver();
+    #if DISPLAY_DRIVER == DISPLAY_DRIVER_ST7789V2
+    ST7789V2_Driver();  // main panel from the LCD_* board pins
+    #endif
+    explicit ST7789V2_Driver(const ST7789V2_Config& config);
     ~ST7789V2_Driver() override = default;
     
     void init() override;
     void setRotation(uint8_t rotation) override;
-    int width() override { return (int)DISPLAY_WIDTH; }
-    int height() override { return (int)DISPLAY_HEIGHT; }
+    int width() override { return (int)cfg.width; }
+    int height() override { return (int)cfg.height; }
     void setBacklight(bool on) override;
     void setBacklightBrightness(uint8_t brightness) override;
     uint8_t getBacklightBrightness() override;
@@ -57,6 +87,10 @@ public:
     void endWrite() override;
     void setAddrWindow(int16_t x, int16_t y, uint16_t w, uint16_t h) override;
     void pushColors(uint16_t* data, uint32_t len, bool swap_bytes = true) override;
+    bool acceptsWireOrderPixels() const override { return true; }
+
+    uint8_t hardwareShiftRange(bool horizontal) const override;
+    bool setHardwareShift(int16_t dx, int16_t dy) override;
 };
 
 #endif // ST7789V2_DRIVER_H
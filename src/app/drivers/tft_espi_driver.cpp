@@ -1,7 +1,8 @@
 #include "tft_espi_driver.h"
+#include "../backlight_pwm.h"
 #include "../log_manager.h"
 
-TFT_eSPI_Driver::TFT_eSPI_Driver() : currentBrightness(100) {
+TFT_eSPI_Driver::TFT_eSPI_Driver() : currentBrightness(100), dmaReady(false), asyncWriteOpen(false) {
     // TFT_eSPI constructor already called
     // Initialize brightness to 100% (full brightness)
 }
@@ -9,6 +10,12 @@ TFT_eSPI_Driver::TFT_eSPI_Driver() : currentBrightness(100) {
 void TFT_eSPI_Driver::init() {
     LOGI("TFT_eSPI", "Initializing");
     tft.init();
+
+    #if LVGL_DOUBLE_BUFFER
+    // DMA lets the SPI transfer of one LVGL band overlap rendering of the next.
+    dmaReady = tft.initDMA();
+    LOGI("TFT_eSPI", "DMA %s", dmaReady ? "enabled" : "unavailable (blocking flush)");
+    #endif
     
     #if HAS_BACKLIGHT
     // Initialize PWM for backlight control
@@ -59,18 +66,12 @@ void TFT_eSPI_Driver::setBacklightBrightness(uint8_t brightness) {
     if (brightness > 100) brightness = 100;
     currentBrightness = brightness;
     
-    // Map 0-100% to 0-255 PWM duty cycle
-    uint32_t dutyCycle = (brightness * 255) / 100;
-    
-    // Handle active low vs active high backlight
-    #ifdef TFT_BACKLIGHT_ON
-    if (!TFT_BACKLIGHT_ON) {
-        dutyCycle = 255 - dutyCycle;  // Invert for active-low
-    }
-    #endif
+    // Map 0-100% to a gamma-corrected 0-255 PWM duty cycle (inverted for active-low)
+    const uint32_t dutyCycle = backlight_pwm_duty(brightness, BACKLIGHT_PWM_ACTIVE_LOW);
     
     // ESP32 Arduino Core 3.x uses new LEDC API
     #if ESP_ARDUINO_VERSION_MAJOR >= 3
+    backlight_pwm_stop_fade(TFT_BL);
     ledcWrite(TFT_BL, dutyCycle);  // New API: write to pin directly
     #else
     ledcWrite(TFT_BACKLIGHT_PWM_CHANNEL, dutyCycle);  // Old API: write to channel
@@ -78,6 +79,19 @@ void TFT_eSPI_Driver::setBacklightBrightness(uint8_t brightness) {
     #endif
 }
 
+bool TFT_eSPI_Driver::fadeBacklightTo(uint8_t brightness, uint16_t duration_ms) {
+    #if HAS_BACKLIGHT
+    if (brightness > 100) brightness = 100;
+    if (!backlight_pwm_fade(TFT_BL, backlight_pwm_duty(brightness, BACKLIGHT_PWM_ACTIVE_LOW), duration_ms)) return false;
+    currentBrightness = brightness;
+    return true;
+    #else
+    (void)brightness;
+    (void)duration_ms;
+    return false;
+    #endif
+}
+
 uint8_t TFT_eSPI_Driver::getBacklightBrightness() {
     #if HAS_BACKLIGHT
     return currentBrightness;
@@ -131,5 +145,45 @@ void TFT_eSPI_Driver::setAddrWindow(int16_t x, int16_t y, uint16_t w, uint16_t h
 }
 
 void TFT_eSPI_Driver::pushColors(uint16_t* data, uint32_t len, bool swap_bytes) {
+    // tft.pushColors(..., false) falls back to the sticky setSwapBytes() state,
+    // which the async path may have left enabled; reset it for wire-order pixels.
+    if (!swap_bytes) {
+        tft.setSwapBytes(false);
+    }
     tft.pushColors(data, len, swap_bytes);
 }
+
+bool TFT_eSPI_Driver::supportsAsyncFlush() const {
+    return dmaReady;
+}
+
+void TFT_eSPI_Driver::pushColorsAsync(int16_t x, int16_t y, uint16_t w, uint16_t h, uint16_t* data, bool swap_bytes) {
+    if (!dmaReady) {
+        DisplayDriver::pushColorsAsync(x, y, w, h, data, swap_bytes);
+        return;
+    }
+
+    // Keep the transaction open for the whole frame; endWrite() would block on the DMA.
+    if (!asyncWriteOpen) {
+        tft.startWrite();
+        asyncWriteOpen = true;
+    }
+
+    // pushImageDMA waits for the previous band, sets the window and queues the
+    // transfer. Byte swapping is done in place (the LVGL buffer is re-rendered anyway).
+    tft.setSwapBytes(swap_bytes);
+    tft.pushImageDMA(x, y, w, h, data);
+}
+
+void TFT_eSPI_Driver::waitAsyncFlush() {
+    if (dmaReady) {
+        tft.dmaWait();
+    }
+}
+
+void TFT_eSPI_Driver::endAsyncFlush() {
+    if (!asyncWriteOpen) return;
+    tft.dmaWait();
+    tft.endWrite();
+    asyncWriteOpen = false;
+}
@@ -16,6 +16,8 @@ class TFT_eSPI_Driver : public DisplayDriver {
 private:
     TFT_eSPI tft;
     uint8_t currentBrightness;  // Current brightness level (0-100%)
+    bool dmaReady;              // DMA channel initialized (LVGL_DOUBLE_BUFFER)
+    bool asyncWriteOpen;        // SPI transaction held open across queued DMA bands
     
 public:
     TFT_eSPI_Driver();
@@ -29,12 +31,20 @@ public:
     void setBacklightBrightness(uint8_t brightness) override;  // 0-100%
     uint8_t getBacklightBrightness() override;
     bool hasBacklightControl() override;
+    bool fadeBacklightTo(uint8_t brightness, uint16_t duration_ms) override;
     void applyDisplayFixes() override;
     
     void startWrite() override;
     void endWrite() override;
     void setAddrWindow(int16_t x, int16_t y, uint16_t w, uint16_t h) override;
     void pushColors(uint16_t* data, uint32_t len, bool swap_bytes = true) override;
+    bool acceptsWireOrderPixels() const override { return true; }
+
+    // Async (DMA) flush path
+    bool supportsAsyncFlush() const override;
+    void pushColorsAsync(int16_t x, int16_t y, uint16_t w, uint16_t h, uint16_t* data, bool swap_bytes = true) override;
+    void waitAsyncFlush() override;
+    void endAsyncFlush() override;
 };
 
 #endif // TFT_ESPI_DRIVER_H
@@ -1,8 +1,10 @@
 #include "xpt2046_driver.h"
 #include "../log_manager.h"
 
+// When gating, the driver owns the IRQ pin; the library polls only when asked.
 XPT2046_Driver::XPT2046_Driver(uint8_t cs, uint8_t irq) 
-    : ts(cs, irq), cs_pin(cs), irq_pin(irq), rotation(1), touchSPI(nullptr) {
+    : ts(cs, (TOUCH_IRQ_GATED && irq != 255) ? 255 : irq), cs_pin(cs), irq_pin(irq),
+      irq_gated(TOUCH_IRQ_GATED && irq != 255), pen_irq(false), tracking(false), rotation(1), touchSPI(nullptr) {
     // Default calibration values (will be overridden by board config)
     cal_x_min = 300;
     cal_x_max = 3900;
@@ -11,6 +13,9 @@ XPT2046_Driver::XPT2046_Driver(uint8_t cs, uint8_t irq)
 }
 
 XPT2046_Driver::~XPT2046_Driver() {
+    if (irq_gated) {
+        detachInterrupt(digitalPinToInterrupt(irq_pin));
+    }
     if (touchSPI) {
         delete touchSPI;
         touchSPI = nullptr;
@@ -35,17 +40,54 @@ void XPT2046_Driver::init() {
     #endif
     
     ts.setRotation(rotation);
+
+    if (irq_gated) {
+        // PENIRQ is open-drain with the controller's own pull-up; it goes low on pen-down.
+        pinMode(irq_pin, INPUT);
+        attachInterruptArg(digitalPinToInterrupt(irq_pin), onPenIrq, this, FALLING);
+        pen_irq = (digitalRead(irq_pin) == LOW);
+        LOGI("XPT2046", "IRQ-gated sampling on GPIO %d", irq_pin);
+    }
     
     LOGI("XPT2046", "Calibration (%d,%d) to (%d,%d), rotation=%d", 
                    cal_x_min, cal_y_min, cal_x_max, cal_y_max, rotation);
     LOGI("XPT2046", "Initialization complete");
 }
 
+void IRAM_ATTR XPT2046_Driver::onPenIrq(void* arg) {
+    static_cast<XPT2046_Driver*>(arg)->pen_irq = true;
+}
+
+// True when sampling can be skipped: no pen-down edge since the last release.
+bool XPT2046_Driver::idle() {
+    if (!irq_gated) return false;
+    if (pen_irq) {
+        pen_irq = false;
+        tracking = true;
+    }
+    return !tracking;
+}
+
+void XPT2046_Driver::noteReleased() {
+    if (!irq_gated) return;
+    // Edges raised by the conversion itself are stale; the pin level says whether the pen is still down.
+    tracking = false;
+    pen_irq = (digitalRead(irq_pin) == LOW);
+}
+
 bool XPT2046_Driver::isTouched() {
-    return ts.touched();
+    if (idle()) return false;
+    const bool touched = ts.touched();
+    if (!touched) noteReleased();
+    return touched;
 }
 
 bool XPT2046_Driver::getTouch(uint16_t* x, uint16_t* y, uint16_t* pressure) {
+    // Pen up with IRQ gating: report released without touching the bus.
+    if (idle()) {
+        return false;
+    }
+
     // Check if screen is being touched
     if (!ts.tirqTouched() && ts.bufferEmpty()) {
         return false;
@@ -57,12 +99,14 @@ bool XPT2046_Driver::getTouch(uint16_t* x, uint16_t* y, uint16_t* pressure) {
     // Validate raw values (should be in 0-4095 range, not max noise values)
     if (p.x >= 8000 || p.y >= 8000 || p.z >= 4000) {
         // Invalid/noise - touch controller not responding properly
+        noteReleased();
         return false;
     }
     
     // Filter by pressure - XPT2046 needs minimum pressure to be valid touch
     // z=0 is electrical noise, not actual touch
     if (p.z < 200) {  // Minimum pressure threshold
+        noteReleased();
         return false;
     }
     
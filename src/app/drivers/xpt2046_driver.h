@@ -5,6 +5,9 @@
  * Used on ESP32-2432S028R (CYD) and compatible displays.
  * 
  * Hardware: Resistive touch controller on separate VSPI bus
+ *
+ * With TOUCH_IRQ_GATED and an IRQ pin, the pen-down interrupt gates sampling:
+ * reads while nobody touches the panel return "released" without any SPI traffic.
  */
 
 #ifndef XPT2046_DRIVER_H
@@ -21,6 +24,14 @@ private:
     SPIClass* touchSPI;      // Persistent SPI instance for touch controller
     uint8_t cs_pin;
     uint8_t irq_pin;
+
+    // IRQ gating: set by the pen-down ISR, cleared once a read sees the pen lifted.
+    bool irq_gated;
+    volatile bool pen_irq;
+    bool tracking;
+    static void IRAM_ATTR onPenIrq(void* arg);
+    bool idle();
+    void noteReleased();
     
     // Calibration data
     uint16_t cal_x_min, cal_x_max;
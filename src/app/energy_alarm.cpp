@@ -0,0 +1,181 @@
+#include "energy_alarm.h"
+
+#include "energy_monitor.h"
+#include "log_manager.h"
+
+#if HAS_DISPLAY
+#include "display_manager.h"
+#endif
+
+#include <math.h>
+
+// Written by every ingest path (MQTT task, P1 task, fast-path callbacks) and
+// loop(); read by the LVGL task, the screen saver and MQTT.
+static portMUX_TYPE s_mux = portMUX_INITIALIZER_UNLOCKED;
+static EnergyAlarmState s_state = {false, {}, {}, 0, EnergyCategory::Count, 0, 0, 0, 0};
+static bool s_evaluated = false;
+static uint32_t s_eval_state_generation = 0;
+static uint32_t s_eval_rules_generation = 0;
+static uint32_t s_clear_start_ms = 0;  // 0 = not clearing
+
+static const char* const kCategoryNames[kEnergyAlarmCategoryCount] = {"solar", "home", "grid"};
+
+static const char* first_name(EnergyCategory c) {
+    return (c < EnergyCategory::Count) ? kCategoryNames[(size_t)c] : "none";
+}
+
+static void end_episode_locked() {
+    s_state.active = false;
+    s_state.latched_mask = 0;
+    s_state.first = EnergyCategory::Count;
+    s_state.active_since_ms = 0;
+    s_clear_start_ms = 0;
+    s_state.generation++;
+}
+
+// Apply the episode gate to the current per-category alarms (s_mux held).
+// raised_mask: categories that entered alarm with this evaluation.
+static bool gate_locked(uint8_t raised_mask, uint16_t clear_delay_ms, uint32_t now_ms) {
+    uint8_t alarm_mask = 0;
+    for (size_t c = 0; c < kEnergyAlarmCategoryCount; c++) {
+        if (s_state.category[c]) alarm_mask |= (uint8_t)(1u << c);
+    }
+
+    if (alarm_mask != 0) {
+        s_clear_start_ms = 0;
+        bool changed = false;
+        if (!s_state.active) {
+            s_state.active = true;
+            s_state.episodes++;
+            s_state.active_since_ms = now_ms ? now_ms : 1;
+            s_state.latched_mask = 0;
+            s_state.first = EnergyCategory::Count;
+            changed = true;
+        }
+        if (s_state.first == EnergyCategory::Count) {
+            // Prefer a category that just crossed T2 over one that was already high.
+            const uint8_t pick = raised_mask ? raised_mask : alarm_mask;
+            for (size_t c = 0; c < kEnergyAlarmCategoryCount; c++) {
+                if (pick & (1u << c)) {
+                    s_state.first = (EnergyCategory)c;
+                    break;
+                }
+            }
+        }
+        const uint8_t latched = (uint8_t)(s_state.latched_mask | alarm_mask);
+        if (latched != s_state.latched_mask) {
+            s_state.latched_mask = latched;
+            changed = true;
+        }
+        if (changed) s_state.generation++;
+        return changed;
+    }
+
+    if (!s_state.active) return false;
+    if (clear_delay_ms == 0) {
+        end_episode_locked();
+        return true;
+    }
+    if (s_clear_start_ms == 0) {
+        s_clear_start_ms = now_ms ? now_ms : 1;
+        return false;
+    }
+    if ((uint32_t)(now_ms - s_clear_start_ms) < (uint32_t)clear_delay_ms) return false;
+    end_episode_locked();
+    return true;
+}
+
+static void on_gated_change(const EnergyAlarmState& st) {
+    if (st.active) {
+        LOGI("Energy", "Alarm active (first: %s, latched 0x%02x)", first_name(st.first), (unsigned)st.latched_mask);
+    } else {
+        LOGI("Energy", "Alarm cleared");
+    }
+    #if HAS_DISPLAY
+    // The clear delay can expire without a new value; make sure the screen follows.
+    display_manager_request_render();
+    #endif
+}
+
+void energy_alarm_on_values(uint32_t now_ms) {
+    const EnergyMonitorState st = energy_monitor_get_state();
+    const EnergyRuleSet* rules = energy_thresholds_get();
+
+    float kw[kEnergyAlarmCategoryCount];
+    kw[(size_t)EnergyCategory::Solar] = st.value[ENERGY_CHANNEL_SOLAR];
+    kw[(size_t)EnergyCategory::Grid] = st.value[ENERGY_CHANNEL_GRID];
+    kw[(size_t)EnergyCategory::Home] = NAN;
+    if (!isnan(kw[(size_t)EnergyCategory::Solar]) && !isnan(kw[(size_t)EnergyCategory::Grid])) {
+        kw[(size_t)EnergyCategory::Home] = kw[(size_t)EnergyCategory::Solar] + kw[(size_t)EnergyCategory::Grid];
+    }
+
+    bool changed = false;
+    EnergyAlarmState snapshot;
+    portENTER_CRITICAL(&s_mux);
+    // Two ingest tasks can race between the store and this call: never let an
+    // older snapshot overwrite a newer evaluation.
+    if (s_evaluated && rules->generation == s_eval_rules_generation &&
+        (int32_t)(st.generation - s_eval_state_generation) <= 0) {
+        portEXIT_CRITICAL(&s_mux);
+        return;
+    }
+    s_evaluated = true;
+    s_eval_state_generation = st.generation;
+    s_eval_rules_generation = rules->generation;
+
+    uint8_t raised = 0;
+    for (size_t c = 0; c < kEnergyAlarmCategoryCount; c++) {
+        const EnergyClassification cls = energy_thresholds_classify(rules->category[c], kw[c], s_state.category[c]);
+        if (cls.alarm && !s_state.category[c]) raised |= (uint8_t)(1u << c);
+        s_state.category[c] = cls.alarm;
+        s_state.tier[c] = cls.tier;
+    }
+    changed = gate_locked(raised, rules->clear_delay_ms, now_ms);
+    s_state.eval_seq++;
+    snapshot = s_state;
+    portEXIT_CRITICAL(&s_mux);
+
+    if (changed) on_gated_change(snapshot);
+}
+
+void energy_alarm_loop(uint32_t now_ms) {
+    const EnergyRuleSet* rules = energy_thresholds_get();
+
+    portENTER_CRITICAL(&s_mux);
+    const bool recompiled = s_evaluated && rules->generation != s_eval_rules_generation;
+    bool changed = false;
+    EnergyAlarmState snapshot;
+    if (!recompiled && s_state.active && s_clear_start_ms != 0) {
+        changed = gate_locked(0, rules->clear_delay_ms, now_ms);
+    }
+    snapshot = s_state;
+    portEXIT_CRITICAL(&s_mux);
+
+    if (recompiled) {
+        // New thresholds apply to the current values right away.
+        energy_alarm_on_values(now_ms);
+    } else if (changed) {
+        on_gated_change(snapshot);
+    }
+}
+
+EnergyAlarmState energy_alarm_get_state() {
+    portENTER_CRITICAL(&s_mux);
+    const EnergyAlarmState copy = s_state;
+    portEXIT_CRITICAL(&s_mux);
+    return copy;
+}
+
+bool energy_alarm_active() {
+    portENTER_CRITICAL(&s_mux);
+    const bool active = s_state.active;
+    portEXIT_CRITICAL(&s_mux);
+    return active;
+}
+
+uint32_t energy_alarm_generation() {
+    portENTER_CRITICAL(&s_mux);
+    const uint32_t gen = s_state.generation;
+    portEXIT_CRITICAL(&s_mux);
+    return gen;
+}
@@ -0,0 +1,51 @@
+#ifndef ENERGY_ALARM_H
+#define ENERGY_ALARM_H
+
+#include <Arduino.h>
+#include "board_config.h"
+#include "energy_thresholds.h"
+
+// Energy T2 alarm engine.
+//
+// Evaluated once per incoming solar/grid value (from energy_monitor_set_channel,
+// on whichever task ingested it) against the compiled threshold rules:
+// - per-category alarm with hysteresis (exit at EnergyCategoryRules::clear_mkw)
+// - the episode stays active until every category has been clear for
+//   EnergyRuleSet::clear_delay_ms (energy_alarm_loop() ends it when no new value arrives)
+// - per-episode latches: which categories raised the alarm, and which one was first
+//
+// Consumers (energy monitor screen, screen saver / warning screen, MQTT) read the
+// state instead of classifying values themselves, so they always agree. Gated
+// changes (episode start/end, latched set) bump `generation`; every evaluation
+// bumps `eval_seq` (tiers may change without an alarm change).
+
+static constexpr size_t kEnergyAlarmCategoryCount = (size_t)EnergyCategory::Count;
+
+struct EnergyAlarmState {
+    bool active;                                      // gated episode state
+    bool category[kEnergyAlarmCategoryCount];         // raw per-category alarm (with hysteresis)
+    EnergyTier tier[kEnergyAlarmCategoryCount];       // tier of the last evaluated value
+    uint8_t latched_mask;                             // categories that alarmed this episode (bit = EnergyCategory)
+    EnergyCategory first;                             // category that started the episode (Count = none)
+    uint32_t generation;                              // bumped on every gated change
+    uint32_t eval_seq;                                // bumped on every evaluation
+    uint32_t episodes;                                // episodes started since boot
+    uint32_t active_since_ms;                         // millis() when the episode started (0 = inactive)
+};
+
+// Evaluate the current energy_monitor state (call after every store; any task).
+void energy_alarm_on_values(uint32_t now_ms);
+
+// End expired clear delays and re-evaluate after a rules recompile (call from loop()).
+void energy_alarm_loop(uint32_t now_ms);
+
+// Consistent snapshot (any task).
+EnergyAlarmState energy_alarm_get_state();
+
+// Gated alarm state (cheap; any task).
+bool energy_alarm_active();
+
+// Bumped on every gated change; compare against a remembered value to detect events.
+uint32_t energy_alarm_generation();
+
+#endif // ENERGY_ALARM_H
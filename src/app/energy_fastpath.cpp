@@ -0,0 +1,154 @@
+#include "energy_fastpath.h"
+
+#if ENERGY_FASTPATH_SUPPORTED
+
+#include "energy_latency.h"
+#include "energy_monitor.h"
+#include "log_manager.h"
+
+#include <Arduino.h>
+#include <WiFi.h>
+#include <math.h>
+#include <string.h>
+
+#if ENERGY_FASTPATH_UDP_ENABLED
+#include <AsyncUDP.h>
+#endif
+
+#if ENERGY_FASTPATH_ESPNOW_ENABLED
+#include <esp_idf_version.h>
+#include <esp_now.h>
+#endif
+
+static constexpr size_t kHeaderBytes = 8;
+static constexpr size_t kEntryBytes = 6;
+static constexpr uint8_t kMaxEntries = 8;
+static constexpr uint8_t kFrameVersion = 1;
+
+// Per-channel dedup state; written from the AsyncUDP and WiFi (ESP-NOW) tasks.
+static portMUX_TYPE s_mux = portMUX_INITIALIZER_UNLOCKED;
+static uint32_t s_last_seq[kEnergyChannelCount] = {};
+static uint32_t s_last_ms[kEnergyChannelCount] = {};  // 0 = never
+static EnergyFastpathStats s_stats = {};
+
+#if ENERGY_FASTPATH_UDP_ENABLED
+static AsyncUDP s_udp;
+static uint32_t s_udp_ip = 0;  // local IP the group was joined on (0 = not listening)
+#endif
+
+#if ENERGY_FASTPATH_ESPNOW_ENABLED
+static bool s_espnow_started = false;
+#endif
+
+static inline uint32_t rd_le32(const uint8_t* p) {
+    return (uint32_t)p[0] | ((uint32_t)p[1] << 8) | ((uint32_t)p[2] << 16) | ((uint32_t)p[3] << 24);
+}
+
+// Newer than the last accepted seq of the channel (wrap-safe), or the channel is
+// unused/silent long enough that the publisher may have restarted.
+static bool accept_seq_locked(uint8_t channel, uint32_t seq, uint32_t now_ms) {
+    const uint32_t last_ms = s_last_ms[channel];
+    const bool fresh = (last_ms == 0) || (uint32_t)(now_ms - last_ms) >= (uint32_t)ENERGY_FASTPATH_SEQ_RESET_MS;
+    if (!fresh && (int32_t)(seq - s_last_seq[channel]) <= 0) return false;
+    s_last_seq[channel] = seq;
+    s_last_ms[channel] = now_ms ? now_ms : 1;
+    return true;
+}
+
+bool energy_fastpath_handle_frame(const uint8_t* data, size_t len) {
+    const uint8_t count = (data && len >= kHeaderBytes) ? data[3] : 0;
+    if (!data || len < kHeaderBytes || data[0] != 'E' || data[1] != 'F' || data[2] != kFrameVersion ||
+        count == 0 || count > kMaxEntries || len != kHeaderBytes + (size_t)count * kEntryBytes) {
+        portENTER_CRITICAL(&s_mux);
+        s_stats.malformed++;
+        portEXIT_CRITICAL(&s_mux);
+        return false;
+    }
+
+    #if ENERGY_LATENCY_SUPPORTED
+    energy_latency_on_receive();
+    #endif
+    const uint32_t now = millis();
+    const uint32_t seq = rd_le32(data + 4);
+
+    // Decide under the lock, publish outside it (energy_monitor has its own seqlock).
+    bool apply[kMaxEntries];
+    uint32_t applied = 0;
+    uint32_t stale = 0;
+    portENTER_CRITICAL(&s_mux);
+    s_stats.frames++;
+    for (uint8_t i = 0; i < count; i++) {
+        const uint8_t channel = data[kHeaderBytes + i * kEntryBytes];
+        apply[i] = (channel < kEnergyChannelCount) && accept_seq_locked(channel, seq, now);
+        if (apply[i]) applied++;
+        else stale++;
+    }
+    s_stats.applied += applied;
+    s_stats.stale += stale;
+    portEXIT_CRITICAL(&s_mux);
+
+    for (uint8_t i = 0; i < count; i++) {
+        if (!apply[i]) continue;
+        const uint8_t* e = data + kHeaderBytes + i * kEntryBytes;
+        const int32_t mkw = (int32_t)rd_le32(e + 2);
+        energy_monitor_set_channel(e[0], mkw == INT32_MIN ? NAN : (float)mkw / 1000.0f, now);
+    }
+    return applied > 0;
+}
+
+#if ENERGY_FASTPATH_ESPNOW_ENABLED
+#if ESP_IDF_VERSION_MAJOR >= 5
+static void espnow_recv(const esp_now_recv_info_t*, const uint8_t* data, int len) {
+#else
+static void espnow_recv(const uint8_t*, const uint8_t* data, int len) {
+#endif
+    if (len > 0) energy_fastpath_handle_frame(data, (size_t)len);
+}
+#endif
+
+void energy_fastpath_loop() {
+    const bool up = (WiFi.status() == WL_CONNECTED);
+
+    #if ENERGY_FASTPATH_UDP_ENABLED
+    // The IGMP membership belongs to the interface address: rejoin after a reconnect.
+    const uint32_t ip = up ? (uint32_t)WiFi.localIP() : 0;
+    if (ip != s_udp_ip) {
+        s_udp.close();
+        s_udp_ip = 0;
+        if (ip != 0) {
+            IPAddress group;
+            if (!group.fromString(ENERGY_FASTPATH_UDP_GROUP) ||
+                !s_udp.listenMulticast(group, ENERGY_FASTPATH_UDP_PORT)) {
+                LOGW("FastPath", "Multicast listen on %s:%u failed", ENERGY_FASTPATH_UDP_GROUP, (unsigned)ENERGY_FASTPATH_UDP_PORT);
+            } else {
+                s_udp.onPacket([](AsyncUDPPacket& packet) {
+                    energy_fastpath_handle_frame(packet.data(), packet.length());
+                });
+                LOGI("FastPath", "Listening on %s:%u", ENERGY_FASTPATH_UDP_GROUP, (unsigned)ENERGY_FASTPATH_UDP_PORT);
+            }
+            // Remember the address even on failure so a broken group is not retried every loop().
+            s_udp_ip = ip;
+        }
+    }
+    #endif
+
+    #if ENERGY_FASTPATH_ESPNOW_ENABLED
+    if (up && !s_espnow_started) {
+        s_espnow_started = true;  // one attempt; ESP-NOW survives STA reconnects
+        if (esp_now_init() != ESP_OK || esp_now_register_recv_cb(espnow_recv) != ESP_OK) {
+            LOGW("FastPath", "ESP-NOW init failed");
+        } else {
+            LOGI("FastPath", "ESP-NOW receive on channel %d", (int)WiFi.channel());
+        }
+    }
+    #endif
+}
+
+void energy_fastpath_get_stats(EnergyFastpathStats* out) {
+    if (!out) return;
+    portENTER_CRITICAL(&s_mux);
+    *out = s_stats;
+    portEXIT_CRITICAL(&s_mux);
+}
+
+#endif // ENERGY_FASTPATH_SUPPORTED
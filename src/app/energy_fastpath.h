@@ -0,0 +1,62 @@
+/*
+ * Energy Fast Path (UDP multicast / ESP-NOW)
+ *
+ * Accepts compact binary energy frames and writes them straight into
+ * energy_monitor, next to the MQTT subscriptions (which stay the fallback). One
+ * publisher packet updates every panel in the multicast group (or ESP-NOW range)
+ * at once instead of one broker delivery per device.
+ *
+ * Frame (little-endian, 8 + 6 * count bytes):
+ *   u8  magic[2]   'E', 'F'
+ *   u8  version    1
+ *   u8  count      entries that follow (1..8)
+ *   u32 seq        publisher sequence number, incremented per frame
+ *   count x { u8 channel, u8 reserved (0), i32 milli_kw }
+ *
+ * Channels are energy_monitor channels (0 = solar, 1 = grid, then aux). An entry
+ * is applied only when its seq is newer than the last one seen for that channel,
+ * which drops duplicates (same frame via UDP and ESP-NOW, multicast repeats) and
+ * late reordered frames. A channel that has been silent for
+ * ENERGY_FASTPATH_SEQ_RESET_MS accepts any seq, so a restarted publisher is
+ * picked up. milli_kw INT32_MIN marks a channel as unknown (NAN).
+ *
+ * Transports:
+ *   UDP multicast ENERGY_FASTPATH_UDP_GROUP:ENERGY_FASTPATH_UDP_PORT (AsyncUDP)
+ *   ESP-NOW broadcast/unicast (ENERGY_FASTPATH_ESPNOW_ENABLED, same WiFi channel as the AP)
+ *
+ * Frames are unauthenticated, like anonymous MQTT: anything on the LAN segment
+ * can set values. Build with ENERGY_FASTPATH_UDP_ENABLED false on untrusted networks.
+ */
+
+#pragma once
+
+#include "board_config.h"
+
+#if ENERGY_FASTPATH_UDP_ENABLED || ENERGY_FASTPATH_ESPNOW_ENABLED
+
+#define ENERGY_FASTPATH_SUPPORTED 1
+
+#include <stddef.h>
+#include <stdint.h>
+
+struct EnergyFastpathStats {
+    uint32_t frames;      // well-formed frames received (all transports)
+    uint32_t applied;     // entries written to energy_monitor
+    uint32_t stale;       // entries dropped as duplicate/reordered
+    uint32_t malformed;   // packets that were not a valid frame
+};
+
+// (Re)join the multicast group / start ESP-NOW once WiFi is up (call from main loop;
+// cheap when nothing changed).
+void energy_fastpath_loop();
+
+// Decode one frame (exposed for transports; safe from any task).
+bool energy_fastpath_handle_frame(const uint8_t* data, size_t len);
+
+void energy_fastpath_get_stats(EnergyFastpathStats* out);
+
+#else
+
+#define ENERGY_FASTPATH_SUPPORTED 0
+
+#endif
@@ -0,0 +1,190 @@
+#include "energy_history.h"
+
+#include "board_config.h"
+#include "energy_monitor.h"
+#include "log_manager.h"
+#include "time_series_ring.h"
+
+#include <Arduino.h>
+
+#include <freertos/FreeRTOS.h>
+#include <freertos/timers.h>
+
+#include <math.h>
+
+float energy_history_to_kw(int16_t dw) {
+    if (dw == kEnergyHistoryNoValue) return NAN;
+    return (float)dw / 100.0f;
+}
+
+#if ENERGY_HISTORY_ENABLED
+
+static constexpr uint32_t kFinePeriodMs = 1000;
+static constexpr uint32_t kFinePerMinute = 60;
+static constexpr uint32_t kMinutesPerQuarter = 15;
+
+static const uint32_t kTierPeriodMs[(size_t)EnergyHistoryTier::Count] = {
+    kFinePeriodMs,
+    kFinePeriodMs * kFinePerMinute,
+    kFinePeriodMs * kFinePerMinute * kMinutesPerQuarter,
+};
+
+static const size_t kTierSamples[(size_t)EnergyHistoryTier::Count] = {
+    (size_t)ENERGY_HISTORY_FINE_SAMPLES,
+    (size_t)ENERGY_HISTORY_MINUTE_SAMPLES,
+    (size_t)ENERGY_HISTORY_QUARTER_SAMPLES,
+};
+
+// Running mean of the finer tier for the coarser sample being built.
+struct EnergyAccumulator {
+    int32_t solar_sum;
+    int32_t grid_sum;
+    uint16_t solar_n;
+    uint16_t grid_n;
+    uint16_t inputs;
+
+    void add(const EnergyHistorySample& s) {
+        if (s.solar_dw != kEnergyHistoryNoValue) { solar_sum += s.solar_dw; solar_n++; }
+        if (s.grid_dw != kEnergyHistoryNoValue) { grid_sum += s.grid_dw; grid_n++; }
+        inputs++;
+    }
+
+    EnergyHistorySample take() {
+        EnergyHistorySample out;
+        out.solar_dw = solar_n ? (int16_t)lroundf((float)solar_sum / (float)solar_n) : kEnergyHistoryNoValue;
+        out.grid_dw = grid_n ? (int16_t)lroundf((float)grid_sum / (float)grid_n) : kEnergyHistoryNoValue;
+        *this = {};
+        return out;
+    }
+};
+
+static TimerHandle_t g_energy_hist_timer = nullptr;
+static TimeSeriesRing<EnergyHistorySample> g_energy_tiers[(size_t)EnergyHistoryTier::Count];
+static volatile uint32_t g_energy_tier_last_ms[(size_t)EnergyHistoryTier::Count] = {};
+static volatile uint32_t g_energy_tier_total[(size_t)EnergyHistoryTier::Count] = {};
+
+// Only touched from the timer callback (FreeRTOS timer task).
+static EnergyAccumulator g_minute_acc = {};
+static EnergyAccumulator g_quarter_acc = {};
+
+static int16_t kw_to_dw(float kw) {
+    if (isnan(kw)) return kEnergyHistoryNoValue;
+    const float dw = roundf(kw * 100.0f);
+    if (dw > 32767.0f) return 32767;
+    if (dw < -32767.0f) return -32767;
+    return (int16_t)dw;
+}
+
+static void push_tier(EnergyHistoryTier tier, const EnergyHistorySample& s, uint32_t now_ms) {
+    g_energy_tiers[(size_t)tier].push(s);
+    g_energy_tier_last_ms[(size_t)tier] = now_ms;
+    g_energy_tier_total[(size_t)tier] = g_energy_tier_total[(size_t)tier] + 1;
+}
+
+static void energy_hist_timer_cb(TimerHandle_t) {
+    const uint32_t now = (uint32_t)millis();
+    const EnergyMonitorState st = energy_monitor_get_state();
+
+    EnergyHistorySample s;
+    s.solar_dw = kw_to_dw(st.value[ENERGY_CHANNEL_SOLAR]);
+    s.grid_dw = kw_to_dw(st.value[ENERGY_CHANNEL_GRID]);
+    push_tier(EnergyHistoryTier::Fine, s, now);
+
+    g_minute_acc.add(s);
+    if (g_minute_acc.inputs < kFinePerMinute) return;
+
+    const EnergyHistorySample minute = g_minute_acc.take();
+    push_tier(EnergyHistoryTier::Minute, minute, now);
+
+    g_quarter_acc.add(minute);
+    if (g_quarter_acc.inputs < kMinutesPerQuarter) return;
+
+    push_tier(EnergyHistoryTier::Quarter, g_quarter_acc.take(), now);
+}
+
+static void energy_hist_release() {
+    for (size_t i = 0; i < (size_t)EnergyHistoryTier::Count; i++) {
+        g_energy_tiers[i].release();
+    }
+}
+
+void energy_history_start() {
+    if (g_energy_hist_timer != nullptr) return;
+
+    size_t total_bytes = 0;
+    for (size_t i = 0; i < (size_t)EnergyHistoryTier::Count; i++) {
+        if (!g_energy_tiers[i].allocate(kTierSamples[i], ENERGY_HISTORY_ALLOW_INTERNAL)) {
+            LOGW("EnergyHist", "No memory for history (PSRAM %s)", ENERGY_HISTORY_ALLOW_INTERNAL ? "or internal" : "only");
+            energy_hist_release();
+            return;
+        }
+        total_bytes += g_energy_tiers[i].bytes();
+    }
+
+    g_minute_acc = {};
+    g_quarter_acc = {};
+
+    g_energy_hist_timer = xTimerCreate(
+        "energy_hist",
+        pdMS_TO_TICKS(kFinePeriodMs),
+        pdTRUE,
+        nullptr,
+        energy_hist_timer_cb
+    );
+
+    if (!g_energy_hist_timer || xTimerStart(g_energy_hist_timer, 0) != pdPASS) {
+        LOGE("EnergyHist", "Failed to start history timer");
+        if (g_energy_hist_timer) {
+            xTimerDelete(g_energy_hist_timer, 0);
+            g_energy_hist_timer = nullptr;
+        }
+        energy_hist_release();
+        return;
+    }
+
+    LOGI("EnergyHist", "Enabled: %u/%u/%u samples @ 1s/1m/15m (~%u bytes)",
+        (unsigned)kTierSamples[0],
+        (unsigned)kTierSamples[1],
+        (unsigned)kTierSamples[2],
+        (unsigned)total_bytes
+    );
+}
+
+bool energy_history_available() {
+    return (g_energy_hist_timer != nullptr) && g_energy_tiers[0].ready();
+}
+
+EnergyHistoryTierInfo energy_history_tier_info(EnergyHistoryTier tier) {
+    EnergyHistoryTierInfo info = {};
+    const size_t idx = (size_t)tier;
+    if (!energy_history_available() || idx >= (size_t)EnergyHistoryTier::Count) return info;
+
+    info.period_ms = kTierPeriodMs[idx];
+    info.capacity = g_energy_tiers[idx].capacity();
+    info.count = g_energy_tiers[idx].count();
+    info.last_sample_ms = g_energy_tier_last_ms[idx];
+    info.total = g_energy_tier_total[idx];
+    return info;
+}
+
+bool energy_history_get_sample(EnergyHistoryTier tier, size_t index, EnergyHistorySample* out_sample) {
+    const size_t idx = (size_t)tier;
+    if (!out_sample || idx >= (size_t)EnergyHistoryTier::Count) return false;
+    if (!energy_history_available()) return false;
+    return g_energy_tiers[idx].get(index, out_sample);
+}
+
+#else
+
+void energy_history_start() {}
+
+bool energy_history_available() { return false; }
+
+EnergyHistoryTierInfo energy_history_tier_info(EnergyHistoryTier) {
+    EnergyHistoryTierInfo info = {};
+    return info;
+}
+
+bool energy_history_get_sample(EnergyHistoryTier, size_t, EnergyHistorySample*) { return false; }
+
+#endif
@@ -0,0 +1,52 @@
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+
+// Device-side solar/grid history used by /api/energy/history (and on-screen
+// sparklines). Enabled via ENERGY_HISTORY_ENABLED.
+//
+// Three tiers, each a TimeSeriesRing filled by incremental downsampling:
+//   Fine:    1 s samples   (ENERGY_HISTORY_FINE_SAMPLES,    default 10 min)
+//   Minute:  1 min averages (ENERGY_HISTORY_MINUTE_SAMPLES,  default 24 h)
+//   Quarter: 15 min averages (ENERGY_HISTORY_QUARTER_SAMPLES, default 30 days)
+// Each coarser sample is the mean of the finer samples closed in its interval,
+// accumulated as they are written (no recomputation over the finer ring).
+
+enum class EnergyHistoryTier : uint8_t {
+    Fine = 0,
+    Minute,
+    Quarter,
+    Count
+};
+
+// Values in 10 W units (0.01 kW); kEnergyHistoryNoValue when unknown.
+static constexpr int16_t kEnergyHistoryNoValue = INT16_MIN;
+
+struct EnergyHistorySample {
+    int16_t solar_dw;
+    int16_t grid_dw;
+};
+
+struct EnergyHistoryTierInfo {
+    uint32_t period_ms;
+    size_t capacity;
+    size_t count;
+    uint32_t last_sample_ms;  // millis() of the newest sample (0 if none)
+    uint32_t total;           // samples written since start (monotonic; for incremental readers)
+};
+
+// Starts background sampling if enabled. Safe to call multiple times.
+void energy_history_start();
+
+// Returns whether device-side energy history is enabled and initialized.
+bool energy_history_available();
+
+// Tier metadata (all zeros when unavailable).
+EnergyHistoryTierInfo energy_history_tier_info(EnergyHistoryTier tier);
+
+// Copy the i-th oldest sample of a tier (0..count-1).
+bool energy_history_get_sample(EnergyHistoryTier tier, size_t index, EnergyHistorySample* out_sample);
+
+// kW helpers (NAN <-> kEnergyHistoryNoValue).
+float energy_history_to_kw(int16_t dw);
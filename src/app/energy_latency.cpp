@@ -0,0 +1,148 @@
+#include "energy_latency.h"
+
+#if ENERGY_LATENCY_SUPPORTED
+
+#include "perf_histogram.h"
+
+#include <Arduino.h>
+#include <esp_timer.h>
+#include <freertos/FreeRTOS.h>
+#include <freertos/portmacro.h>
+
+namespace {
+
+enum class TraceState : uint8_t {
+    Idle = 0,
+    Received,
+    Stored,
+    PickedUp,
+    Flushing,
+};
+
+struct Trace {
+    TraceState state;
+    uint32_t rx_us;
+    uint32_t store_us;
+    uint32_t pickup_us;
+    uint32_t flush_us;
+};
+
+static portMUX_TYPE s_mux = portMUX_INITIALIZER_UNLOCKED;
+static Trace s_trace = {};
+static uint32_t s_dropped = 0;
+
+// Histograms are only touched from the LVGL task (on_present_done); s_published under s_mux.
+static PerfHistogram s_hist[(size_t)EnergyLatencyStage::Count];
+static uint32_t s_window_start_ms = 0;
+static EnergyLatencyStats s_published = {};
+static bool s_published_valid = false;
+
+static inline uint32_t now_us() {
+    return (uint32_t)esp_timer_get_time();
+}
+
+static void publish_if_due(uint32_t now_ms) {
+    if (s_window_start_ms == 0) {
+        s_window_start_ms = now_ms ? now_ms : 1;
+        return;
+    }
+    if ((uint32_t)(now_ms - s_window_start_ms) < (uint32_t)ENERGY_LATENCY_WINDOW_MS) return;
+
+    EnergyLatencyStats st = {};
+    st.samples = s_hist[(size_t)EnergyLatencyStage::Total].count;
+    for (size_t i = 0; i < (size_t)EnergyLatencyStage::Count; i++) {
+        st.stage[i].p50_us = s_hist[i].percentile(50);
+        st.stage[i].p95_us = s_hist[i].percentile(95);
+        st.stage[i].max_us = s_hist[i].max;
+        s_hist[i].reset();
+    }
+
+    portENTER_CRITICAL(&s_mux);
+    st.dropped = s_dropped;
+    s_published = st;
+    s_published_valid = true;
+    portEXIT_CRITICAL(&s_mux);
+
+    s_window_start_ms = now_ms ? now_ms : 1;
+}
+
+} // namespace
+
+void energy_latency_on_receive() {
+    const uint32_t t = now_us();
+    portENTER_CRITICAL(&s_mux);
+    if (s_trace.state != TraceState::Idle && s_trace.state != TraceState::Received &&
+        (uint32_t)(t - s_trace.rx_us) > (uint32_t)ENERGY_LATENCY_STALE_MS * 1000u) {
+        s_trace.state = TraceState::Idle;
+        s_dropped++;
+    }
+    // Received but never stored (topic without a route): restart from this message.
+    if (s_trace.state == TraceState::Idle || s_trace.state == TraceState::Received) {
+        s_trace.state = TraceState::Received;
+        s_trace.rx_us = t;
+    }
+    portEXIT_CRITICAL(&s_mux);
+}
+
+void energy_latency_on_store() {
+    const uint32_t t = now_us();
+    portENTER_CRITICAL(&s_mux);
+    if (s_trace.state == TraceState::Received) {
+        s_trace.state = TraceState::Stored;
+        s_trace.store_us = t;
+    }
+    portEXIT_CRITICAL(&s_mux);
+}
+
+void energy_latency_on_pickup() {
+    const uint32_t t = now_us();
+    portENTER_CRITICAL(&s_mux);
+    if (s_trace.state == TraceState::Stored) {
+        s_trace.state = TraceState::PickedUp;
+        s_trace.pickup_us = t;
+    }
+    portEXIT_CRITICAL(&s_mux);
+}
+
+void energy_latency_on_flush_start() {
+    // Called for every flush band; only the first one after a pickup matters.
+    if (s_trace.state != TraceState::PickedUp) return;
+    const uint32_t t = now_us();
+    portENTER_CRITICAL(&s_mux);
+    if (s_trace.state == TraceState::PickedUp) {
+        s_trace.state = TraceState::Flushing;
+        s_trace.flush_us = t;
+    }
+    portEXIT_CRITICAL(&s_mux);
+}
+
+void energy_latency_on_present_done() {
+    const uint32_t t = now_us();
+    Trace done = {};
+    portENTER_CRITICAL(&s_mux);
+    if (s_trace.state == TraceState::Flushing) {
+        done = s_trace;
+        s_trace.state = TraceState::Idle;
+    }
+    portEXIT_CRITICAL(&s_mux);
+
+    if (done.state == TraceState::Flushing) {
+        s_hist[(size_t)EnergyLatencyStage::RxToStore].record(done.store_us - done.rx_us);
+        s_hist[(size_t)EnergyLatencyStage::StoreToPickup].record(done.pickup_us - done.store_us);
+        s_hist[(size_t)EnergyLatencyStage::PickupToFlush].record(done.flush_us - done.pickup_us);
+        s_hist[(size_t)EnergyLatencyStage::FlushToPresent].record(t - done.flush_us);
+        s_hist[(size_t)EnergyLatencyStage::Total].record(t - done.rx_us);
+    }
+    publish_if_due(millis());
+}
+
+bool energy_latency_get_stats(EnergyLatencyStats* out) {
+    if (!out) return false;
+    portENTER_CRITICAL(&s_mux);
+    *out = s_published;
+    const bool ok = s_published_valid;
+    portEXIT_CRITICAL(&s_mux);
+    return ok;
+}
+
+#endif // ENERGY_LATENCY_SUPPORTED
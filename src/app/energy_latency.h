@@ -0,0 +1,60 @@
+#pragma once
+
+#include "board_config.h"
+
+#if HAS_DISPLAY && HAS_MQTT && ENERGY_LATENCY_TRACE_ENABLED
+
+#define ENERGY_LATENCY_SUPPORTED 1
+
+#include <stdint.h>
+
+// MQTT-to-pixel latency trace for the energy path.
+//
+// One value at a time is followed through the pipeline:
+//   rx      MqttManager::handleIncomingMessage() received the message
+//   store   energy_monitor_set_channel() published it (solar/grid)
+//   pickup  EnergyMonitorScreen::update() saw the new generation
+//   flush   first LVGL flush callback after the pickup
+//   present the frame reached the panel (after present() for Buffered drivers)
+//
+// While a value is in flight, newer ones are not traced (sampling keeps every mark
+// O(1) and allocation-free). A trace that does not reach the panel within
+// ENERGY_LATENCY_STALE_MS (other screen active, unchanged labels) is dropped.
+// Per-stage distributions are published every ENERGY_LATENCY_WINDOW_MS.
+
+enum class EnergyLatencyStage : uint8_t {
+    RxToStore = 0,      // parse + state write (MQTT task)
+    StoreToPickup,      // render wakeup / LVGL task scheduling
+    PickupToFlush,      // LVGL layout + draw until the first flush
+    FlushToPresent,     // panel transfer
+    Total,              // rx -> present
+    Count,
+};
+
+struct EnergyLatencyDist {
+    uint32_t p50_us;
+    uint32_t p95_us;
+    uint32_t max_us;
+};
+
+struct EnergyLatencyStats {
+    uint32_t samples;   // traces completed in the last window
+    uint32_t dropped;   // stale traces since boot
+    EnergyLatencyDist stage[(size_t)EnergyLatencyStage::Count];
+};
+
+// Stage marks (cheap; safe from any task).
+void energy_latency_on_receive();
+void energy_latency_on_store();
+void energy_latency_on_pickup();
+void energy_latency_on_flush_start();
+void energy_latency_on_present_done();
+
+// False until the first window was published.
+bool energy_latency_get_stats(EnergyLatencyStats* out);
+
+#else
+
+#define ENERGY_LATENCY_SUPPORTED 0
+
+#endif
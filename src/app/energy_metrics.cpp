@@ -0,0 +1,121 @@
+#include "energy_metrics.h"
+
+#if ENERGY_METRICS_SUPPORTED
+
+#include "energy_alarm.h"
+#include "energy_monitor.h"
+#include "log_manager.h"
+#include "mqtt_manager.h"
+
+#include <math.h>
+#include <stdio.h>
+
+struct EnergyMetrics {
+    float home_kw;             // NAN when solar or grid is unknown
+    float self_consumption;    // percent, NAN without solar production
+    EnergyTier tier[kEnergyAlarmCategoryCount];
+    bool alarm;
+};
+
+// Loop task only.
+static EnergyMetrics s_last = {};
+static bool s_have_last = false;     // false => next check publishes unconditionally
+static bool s_was_connected = false;
+static bool s_attempted = false;     // s_last_publish_ms is valid
+static uint32_t s_last_publish_ms = 0;
+static char s_topic[128] = {0};
+
+// Below this the inverter is effectively idle; a ratio of noise is not useful.
+static constexpr float kMinSolarKw = 0.01f;
+
+static EnergyMetrics compute(const EnergyMonitorState& st, const EnergyAlarmState& alarm) {
+    EnergyMetrics m;
+    const float solar = st.value[ENERGY_CHANNEL_SOLAR];
+    const float grid = st.value[ENERGY_CHANNEL_GRID];
+
+    m.home_kw = (!isnan(solar) && !isnan(grid)) ? solar + grid : NAN;
+
+    m.self_consumption = NAN;
+    if (!isnan(solar) && !isnan(grid) && solar >= kMinSolarKw) {
+        const float exported = grid < 0.0f ? -grid : 0.0f;
+        float pct = (solar - exported) * 100.0f / solar;
+        if (pct < 0.0f) pct = 0.0f;
+        if (pct > 100.0f) pct = 100.0f;
+        m.self_consumption = pct;
+    }
+
+    for (size_t c = 0; c < kEnergyAlarmCategoryCount; c++) m.tier[c] = alarm.tier[c];
+    m.alarm = alarm.active;
+    return m;
+}
+
+static bool moved(float a, float b, float deadband) {
+    if (isnan(a) || isnan(b)) return isnan(a) != isnan(b);
+    return fabsf(a - b) >= deadband;
+}
+
+static bool changed(const EnergyMetrics& a, const EnergyMetrics& b) {
+    if (a.alarm != b.alarm) return true;
+    for (size_t c = 0; c < kEnergyAlarmCategoryCount; c++) {
+        if (a.tier[c] != b.tier[c]) return true;
+    }
+    return moved(a.home_kw, b.home_kw, (float)ENERGY_METRICS_DEADBAND_W / 1000.0f) ||
+           moved(a.self_consumption, b.self_consumption, (float)ENERGY_METRICS_DEADBAND_PCT);
+}
+
+static void format_number(char* buf, size_t len, float v, int decimals) {
+    if (isnan(v)) strlcpy(buf, "null", len);
+    else snprintf(buf, len, "%.*f", decimals, (double)v);
+}
+
+void energy_metrics_loop(uint32_t now_ms) {
+    if (!mqtt_manager.connected()) {
+        s_was_connected = false;
+        return;
+    }
+    if (!s_was_connected) {
+        // Fresh session: resend the retained state right away.
+        s_was_connected = true;
+        s_have_last = false;
+        s_attempted = false;
+    }
+
+    const EnergyMonitorState st = energy_monitor_get_state();
+    if (st.update_ms[ENERGY_CHANNEL_SOLAR] == 0 && st.update_ms[ENERGY_CHANNEL_GRID] == 0) return;
+
+    const EnergyMetrics m = compute(st, energy_alarm_get_state());
+    const uint32_t since = now_ms - s_last_publish_ms;
+    // The minimum interval also paces retries after a failed enqueue.
+    if (s_attempted && since < (uint32_t)ENERGY_METRICS_MIN_INTERVAL_MS) return;
+    if (s_have_last && since < (uint32_t)ENERGY_METRICS_MAX_INTERVAL_S * 1000UL && !changed(m, s_last)) return;
+
+    if (s_topic[0] == '\0') {
+        snprintf(s_topic, sizeof(s_topic), "%s/energy/derived", mqtt_manager.baseTopic());
+    }
+
+    char home[16];
+    char self[16];
+    format_number(home, sizeof(home), m.home_kw, 3);
+    format_number(self, sizeof(self), m.self_consumption, 1);
+
+    char payload[192];
+    snprintf(payload, sizeof(payload),
+             "{\"home_kw\":%s,\"self_consumption_pct\":%s,\"solar_tier\":\"%s\",\"home_tier\":\"%s\",\"grid_tier\":\"%s\",\"alarm\":%s}",
+             home, self,
+             energy_thresholds_tier_name(m.tier[(size_t)EnergyCategory::Solar]),
+             energy_thresholds_tier_name(m.tier[(size_t)EnergyCategory::Home]),
+             energy_thresholds_tier_name(m.tier[(size_t)EnergyCategory::Grid]),
+             m.alarm ? "true" : "false");
+
+    // Queued for the MQTT task; a full queue is retried after the min interval.
+    s_attempted = true;
+    s_last_publish_ms = now_ms;
+    if (mqtt_manager.publish(s_topic, payload, true)) {
+        s_last = m;
+        s_have_last = true;
+    } else {
+        LOGD("Energy", "Derived metrics publish deferred");
+    }
+}
+
+#endif // ENERGY_METRICS_SUPPORTED
@@ -0,0 +1,38 @@
+/*
+ * Derived Energy Metrics (MQTT)
+ *
+ * Publishes what the device already derives from the solar/grid readings, so Home
+ * Assistant does not have to recompute it with template sensors per panel:
+ *   home_kw               solar + grid
+ *   self_consumption_pct  share of the solar production used locally
+ *                         ((solar - export) / solar; null without production)
+ *   solar/home/grid_tier  threshold tier from energy_alarm ("good" ... "warning")
+ *   alarm                 gated T2 alarm (also on <base>/energy/alarm)
+ *
+ * Topic: <base>/energy/derived (retained JSON), with HA discovery entities.
+ *
+ * Change-driven: a new payload is sent when home power moves by
+ * ENERGY_METRICS_DEADBAND_W, self-consumption by ENERGY_METRICS_DEADBAND_PCT, or a
+ * tier/alarm changes; never more often than ENERGY_METRICS_MIN_INTERVAL_MS, and at
+ * least every ENERGY_METRICS_MAX_INTERVAL_S. Evaluated from loop() and sent
+ * through MqttManager's outbound queue, so a slow broker never blocks the caller.
+ */
+
+#pragma once
+
+#include "board_config.h"
+
+#if HAS_MQTT && ENERGY_METRICS_PUBLISH
+
+#define ENERGY_METRICS_SUPPORTED 1
+
+#include <stdint.h>
+
+// Check for changes and queue a publish when due (call from main loop).
+void energy_metrics_loop(uint32_t now_ms);
+
+#else
+
+#define ENERGY_METRICS_SUPPORTED 0
+
+#endif
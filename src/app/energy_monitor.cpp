@@ -1,81 +1,282 @@
 #include "energy_monitor.h"
 
+#include "board_config.h"
 #include "config_manager.h"
+#include "energy_alarm.h"
+#include "energy_totals.h"
+#include "energy_latency.h"
+#include "boot_timeline.h"
+#include "log_manager.h"
 
+#if HAS_DISPLAY
+#include "display_manager.h"
+#endif
+
+#include <atomic>
 #include <math.h>
 
-// FreeRTOS critical section for cross-task access.
+#if ENERGY_RTC_CACHE
+#include <esp_attr.h>
+#include <esp_rom_crc.h>
+#include <esp_system.h>
+#endif
+
+// Sequence lock for cross-task access.
 // (LVGL task reads; Arduino loop / MQTT callback writes.)
-static portMUX_TYPE s_energy_mux = portMUX_INITIALIZER_UNLOCKED;
+// s_seq is odd while a write is in progress; readers copy the state and retry
+// when the sequence changed underneath them. Several tasks ingest values (MQTT,
+// P1 poll, energy fast path), so writers are serialized with a writer-only
+// spinlock (readers never take it). The smoother runs under the same lock.
+static portMUX_TYPE s_energy_write_mux = portMUX_INITIALIZER_UNLOCKED;
+static std::atomic<uint32_t> s_seq{0};
 static EnergyMonitorState s_state;
 
-static int32_t kw_to_mkw_round(float kw) {
-    const float scaled = kw * 1000.0f;
-    return (int32_t)(scaled >= 0.0f ? (scaled + 0.5f) : (scaled - 0.5f));
+// Ingest coalescing. Set from the MQTT task, flushed from loop(); a racing
+// duplicate render request is harmless, so plain atomics are enough.
+static std::atomic<uint32_t> s_last_render_request_ms{0};
+static std::atomic<bool> s_render_pending{false};
+static uint32_t s_coalesced[kEnergyChannelCount] = {0};
+
+static_assert(kEnergyChannelCount <= 32, "restored_mask holds one bit per channel");
+
+#if ENERGY_RTC_CACHE
+// Last published value per channel in RTC memory, rewritten with every update (a
+// few words plus a CRC, no flash wear). Written under the state write lock.
+static constexpr uint32_t kRtcMagic = 0x454D5231; // "EMR1"
+
+struct RtcEnergyValues {
+    uint32_t magic;
+    uint8_t channels;    // kEnergyChannelCount of the build that wrote it
+    float value[kEnergyChannelCount];
+    uint32_t crc;        // over the fields above
+};
+
+RTC_NOINIT_ATTR static RtcEnergyValues s_rtc;
+
+static uint32_t rtc_crc() {
+    return esp_rom_crc32_le(0, (const uint8_t*)&s_rtc, offsetof(RtcEnergyValues, crc));
 }
 
-static bool is_triggered_t2(const EnergyCategoryColorConfig* cfg, float kw, bool use_abs) {
-    if (!cfg) return false;
-    if (isnan(kw)) return false;
+// Fills s_state.value from the previous boot; returns the restored channel mask.
+static uint32_t rtc_restore() {
+    uint32_t mask = 0;
+    // RTC memory holds garbage after power-on.
+    if (esp_reset_reason() != ESP_RST_POWERON && s_rtc.magic == kRtcMagic &&
+        s_rtc.channels == kEnergyChannelCount && s_rtc.crc == rtc_crc()) {
+        for (uint8_t i = 0; i < kEnergyChannelCount; i++) {
+            if (isnan(s_rtc.value[i])) continue;
+            s_state.value[i] = s_rtc.value[i];
+            mask |= (1u << i);
+        }
+    }
+    s_rtc.magic = kRtcMagic;
+    s_rtc.channels = kEnergyChannelCount;
+    for (uint8_t i = 0; i < kEnergyChannelCount; i++) s_rtc.value[i] = s_state.value[i];
+    s_rtc.crc = rtc_crc();
+    return mask;
+}
+#endif
 
-    const float v_kw = use_abs ? fabsf(kw) : kw;
-    const int32_t mkw = kw_to_mkw_round(v_kw);
-    return mkw >= cfg->threshold_mkw[2];
+#if ENERGY_INGEST_SMOOTHING_SAMPLES > 1
+// Guarded by s_energy_write_mux.
+struct ChannelSmoother {
+    float samples[ENERGY_INGEST_SMOOTHING_SAMPLES];
+    float sum;
+    uint8_t count;
+    uint8_t next;
+};
+static ChannelSmoother s_smooth[kEnergyChannelCount];
+
+static float smooth_push(uint8_t channel, float value) {
+    ChannelSmoother& sm = s_smooth[channel];
+    if (isnan(value)) {
+        // Unknown breaks the series: restart averaging from the next valid sample.
+        sm.count = 0;
+        sm.next = 0;
+        sm.sum = 0.0f;
+        return value;
+    }
+    if (sm.count == ENERGY_INGEST_SMOOTHING_SAMPLES) {
+        sm.sum -= sm.samples[sm.next];
+    } else {
+        sm.count++;
+    }
+    sm.samples[sm.next] = value;
+    sm.sum += value;
+    sm.next = (uint8_t)((sm.next + 1) % ENERGY_INGEST_SMOOTHING_SAMPLES);
+    return sm.sum / (float)sm.count;
+}
+#endif
+
+static void request_render_coalesced(uint8_t channel, uint32_t now_ms) {
+    #if HAS_DISPLAY
+    if (ENERGY_INGEST_MIN_RENDER_MS == 0 || s_last_render_request_ms == 0 ||
+        (uint32_t)(now_ms - s_last_render_request_ms) >= (uint32_t)ENERGY_INGEST_MIN_RENDER_MS) {
+        s_last_render_request_ms = now_ms ? now_ms : 1;
+        s_render_pending = false;
+        display_manager_request_render();
+        return;
+    }
+    s_render_pending = true;
+    #else
+    (void)now_ms;
+    #endif
+    s_coalesced[channel]++;
+}
+
+static inline void state_write_begin() {
+    portENTER_CRITICAL(&s_energy_write_mux);
+    s_seq.fetch_add(1, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+}
+
+static inline void state_write_end() {
+    s_state.generation++;
+    s_seq.fetch_add(1, std::memory_order_release);
+    portEXIT_CRITICAL(&s_energy_write_mux);
 }
 
 void energy_monitor_init() {
-    portENTER_CRITICAL(&s_energy_mux);
-    s_state.solar_value = NAN;
-    s_state.grid_value = NAN;
-    s_state.solar_updated = false;
-    s_state.grid_updated = false;
-    s_state.solar_update_ms = 0;
-    s_state.grid_update_ms = 0;
-    portEXIT_CRITICAL(&s_energy_mux);
+    state_write_begin();
+    for (uint8_t i = 0; i < kEnergyChannelCount; i++) {
+        s_state.value[i] = NAN;
+        s_state.update_ms[i] = 0;
+    }
+    s_state.restored_mask = 0;
+    #if ENERGY_RTC_CACHE
+    s_state.restored_mask = rtc_restore();
+    #endif
+    const uint32_t restored = s_state.restored_mask;
+    state_write_end();
+
+    if (restored) {
+        LOGI("Energy", "Restored last values from RTC memory (channels 0x%lx)", (unsigned long)restored);
+        #if BOOT_TIMELINE_SUPPORTED
+        boot_milestone("energy_restored");
+        #endif
+    }
+}
+
+EnergyStaleness energy_monitor_staleness(const EnergyMonitorState& st, uint8_t channel, uint32_t now_ms) {
+    if (channel >= kEnergyChannelCount) return EnergyStaleness::Fresh;
+    uint32_t age_ms;
+    if (st.restored_mask & (1u << channel)) {
+        age_ms = now_ms + (uint32_t)ENERGY_STALE_AGING_MS;  // unknown age: aging since boot
+    } else if (st.update_ms[channel] == 0) {
+        return EnergyStaleness::Fresh;
+    } else {
+        age_ms = now_ms - st.update_ms[channel];
+    }
+    if (age_ms >= (uint32_t)ENERGY_STALE_MS) return EnergyStaleness::Stale;
+    if (age_ms >= (uint32_t)ENERGY_STALE_AGING_MS) return EnergyStaleness::Aging;
+    return EnergyStaleness::Fresh;
+}
+
+void energy_monitor_set_channel(uint8_t channel, float value, uint32_t now_ms) {
+    if (channel >= kEnergyChannelCount) return;
+
+    state_write_begin();
+    #if ENERGY_INGEST_SMOOTHING_SAMPLES > 1
+    const float published = smooth_push(channel, value);
+    #else
+    const float published = value;
+    #endif
+    s_state.value[channel] = published;
+    s_state.update_ms[channel] = now_ms ? now_ms : 1;  // 0 = never
+    s_state.restored_mask &= ~(1u << channel);
+    #if ENERGY_RTC_CACHE
+    s_rtc.value[channel] = published;
+    s_rtc.crc = rtc_crc();
+    #endif
+    state_write_end();
+
+    // Only the built-in channels feed the kWh counters and the monitor screen.
+    if (channel == ENERGY_CHANNEL_SOLAR) {
+        energy_totals_on_solar(value, now_ms);
+    } else if (channel == ENERGY_CHANNEL_GRID) {
+        energy_totals_on_grid(value, now_ms);
+    } else {
+        return;
+    }
+
+    // Alarm state is derived here, once per value, before any consumer looks at it.
+    energy_alarm_on_values(now_ms);
+
+    #if ENERGY_LATENCY_SUPPORTED
+    energy_latency_on_store();
+    #endif
+    request_render_coalesced(channel, now_ms);
+
+    #if BOOT_TIMELINE_SUPPORTED
+    // Boot -> live data, as seen from the broker side.
+    static bool s_first_value_marked = false;
+    if (!s_first_value_marked) {
+        s_first_value_marked = true;
+        boot_milestone("first_energy");
+    }
+    #endif
+}
+
+void energy_monitor_loop(uint32_t now_ms) {
+    #if HAS_DISPLAY
+    if (!s_render_pending) return;
+    if ((uint32_t)(now_ms - s_last_render_request_ms) < (uint32_t)ENERGY_INGEST_MIN_RENDER_MS) return;
+
+    s_last_render_request_ms = now_ms ? now_ms : 1;
+    s_render_pending = false;
+    display_manager_request_render();
+    #else
+    (void)now_ms;
+    #endif
+}
+
+uint32_t energy_monitor_take_coalesced(uint8_t channel) {
+    if (channel >= kEnergyChannelCount) return 0;
+    const uint32_t n = s_coalesced[channel];
+    s_coalesced[channel] = 0;
+    return n;
 }
 
 void energy_monitor_set_solar(float value, uint32_t now_ms) {
-    portENTER_CRITICAL(&s_energy_mux);
-    s_state.solar_value = value;
-    s_state.solar_updated = true;
-    s_state.solar_update_ms = now_ms;
-    portEXIT_CRITICAL(&s_energy_mux);
+    energy_monitor_set_channel(ENERGY_CHANNEL_SOLAR, value, now_ms);
 }
 
 void energy_monitor_set_grid(float value, uint32_t now_ms) {
-    portENTER_CRITICAL(&s_energy_mux);
-    s_state.grid_value = value;
-    s_state.grid_updated = true;
-    s_state.grid_update_ms = now_ms;
-    portEXIT_CRITICAL(&s_energy_mux);
+    energy_monitor_set_channel(ENERGY_CHANNEL_GRID, value, now_ms);
 }
 
-EnergyMonitorState energy_monitor_get_state(bool clear_updates) {
+EnergyMonitorState energy_monitor_get_state() {
     EnergyMonitorState copy;
-    portENTER_CRITICAL(&s_energy_mux);
-    copy = s_state;
-    if (clear_updates) {
-        s_state.solar_updated = false;
-        s_state.grid_updated = false;
-    }
-    portEXIT_CRITICAL(&s_energy_mux);
+    uint32_t begin;
+    uint32_t end;
+    do {
+        begin = s_seq.load(std::memory_order_acquire);
+        if (begin & 1u) {
+            // Writer mid-update (runs on the other core or preempted us); retry.
+            continue;
+        }
+        copy = s_state;
+        std::atomic_thread_fence(std::memory_order_acquire);
+        end = s_seq.load(std::memory_order_relaxed);
+        if (begin == end) break;
+    } while (true);
     return copy;
 }
 
-bool energy_monitor_has_warning(const DeviceConfig* config) {
-    if (!config) return false;
+const char* energy_monitor_channel_name(const DeviceConfig* config, uint8_t channel, char* buf, size_t buf_len) {
+    if (channel == ENERGY_CHANNEL_SOLAR) return "solar";
+    if (channel == ENERGY_CHANNEL_GRID) return "grid";
+    if (!buf || buf_len == 0) return "aux";
 
-    const EnergyMonitorState st = energy_monitor_get_state(false /*clear_updates*/);
-    const float solar_kw = st.solar_value;
-    const float grid_kw = st.grid_value;
-    float home_kw = NAN;
-    if (!isnan(solar_kw) && !isnan(grid_kw)) {
-        home_kw = solar_kw + grid_kw;
+    const unsigned aux = (unsigned)(channel - ENERGY_CHANNEL_AUX_FIRST);
+    #if ENERGY_AUX_CHANNEL_COUNT > 0
+    if (config && aux < ENERGY_AUX_CHANNEL_COUNT && config->energy_aux_channels[aux].name[0] != '\0') {
+        strlcpy(buf, config->energy_aux_channels[aux].name, buf_len);
+        return buf;
     }
-
-    if (is_triggered_t2(&config->energy_solar_colors, solar_kw, true /*use_abs*/)) return true;
-    if (is_triggered_t2(&config->energy_home_colors, home_kw, true /*use_abs*/)) return true;
-    if (is_triggered_t2(&config->energy_grid_colors, grid_kw, false /*use_abs*/)) return true;
-
-    return false;
+    #else
+    (void)config;
+    #endif
+    snprintf(buf, buf_len, "aux%u", aux);
+    return buf;
 }
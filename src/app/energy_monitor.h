@@ -2,30 +2,73 @@
 #define ENERGY_MONITOR_H
 
 #include <Arduino.h>
+#include "board_config.h"
 
 // Thread-safe state for the Energy Monitor screen.
 // Updated from the MQTT loop task; read from the LVGL task.
+//
+// Published through a sequence lock: readers never block (they retry if a write
+// raced them), so the LVGL hot path cannot stall the MQTT callback.
+
+// Channel slots: solar and grid are built in (drive the monitor screen, history
+// and kWh totals); configurable extra sources follow (DeviceConfig::energy_aux_channels).
+enum EnergyChannel : uint8_t {
+    ENERGY_CHANNEL_SOLAR = 0,
+    ENERGY_CHANNEL_GRID = 1,
+    ENERGY_CHANNEL_AUX_FIRST = 2,
+};
+
+static constexpr uint8_t kEnergyChannelCount = ENERGY_CHANNEL_AUX_FIRST + ENERGY_AUX_CHANNEL_COUNT;
 
 struct EnergyMonitorState {
-    float solar_value;
-    float grid_value;
-    bool solar_updated;
-    bool grid_updated;
-    uint32_t solar_update_ms;
-    uint32_t grid_update_ms;
+    float value[kEnergyChannelCount];         // kW, NAN when unknown
+    uint32_t update_ms[kEnergyChannelCount];  // millis() of the last update (0 = never)
+
+    // Incremented on every set_solar/set_grid. Consumers remember the last value
+    // they rendered and compare (replaces per-field "updated" flags, so several
+    // readers can track changes independently).
+    uint32_t generation;
+
+    // Channels (bit per channel) whose value was restored from RTC memory at boot and
+    // has not been updated since; their update_ms is 0 (age unknown).
+    uint32_t restored_mask;
 };
 
+// How old a channel's value is, for rendering (ENERGY_STALE_AGING_MS / ENERGY_STALE_MS).
+enum class EnergyStaleness : uint8_t {
+    Fresh = 0,
+    Aging,    // no update for ENERGY_STALE_AGING_MS, or restored after a warm reboot
+    Stale,    // no update for ENERGY_STALE_MS
+};
+
+// With ENERGY_RTC_CACHE the last values survive software/watchdog resets and panics
+// (not power loss), so a warm reboot renders them before the first MQTT message.
 void energy_monitor_init();
 
-// Record a new value (value may be NAN).
+// Staleness of `channel` at `now_ms`. Channels that never had a value are Fresh (they
+// render "--" anyway); restored values count as Aging from boot.
+EnergyStaleness energy_monitor_staleness(const EnergyMonitorState& st, uint8_t channel, uint32_t now_ms);
+
+// Record a new value (value may be NAN). Out-of-range channels are ignored.
+// With ENERGY_INGEST_SMOOTHING_SAMPLES > 1 the published value is the moving
+// average of the last samples (kWh totals always integrate the raw value).
+void energy_monitor_set_channel(uint8_t channel, float value, uint32_t now_ms);
 void energy_monitor_set_solar(float value, uint32_t now_ms);
 void energy_monitor_set_grid(float value, uint32_t now_ms);
 
-// Read current state. If clear_updates is true, the *_updated flags are cleared.
-EnergyMonitorState energy_monitor_get_state(bool clear_updates);
+// Issue a coalesced render request once ENERGY_INGEST_MIN_RENDER_MS has passed
+// (call from loop(); updates inside the window only mark a render as pending).
+void energy_monitor_loop(uint32_t now_ms);
+
+// Updates whose render wakeup was coalesced since the last call (resets the count).
+uint32_t energy_monitor_take_coalesced(uint8_t channel);
+
+// Read a consistent snapshot of the current state (lock-free, never blocks).
+EnergyMonitorState energy_monitor_get_state();
 
-// True when any category exceeds its configured warning (T2) threshold.
 struct DeviceConfig;
-bool energy_monitor_has_warning(const DeviceConfig* config);
+
+// Display/log name of a channel ("solar", "grid", configured aux name or "aux<N>").
+const char* energy_monitor_channel_name(const DeviceConfig* config, uint8_t channel, char* buf, size_t buf_len);
 
 #endif // ENERGY_MONITOR_H
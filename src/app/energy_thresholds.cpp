@@ -0,0 +1,107 @@
+#include "energy_thresholds.h"
+
+#include "config_manager.h"
+#include "log_manager.h"
+
+#include <atomic>
+#include <math.h>
+
+// Rules before the first compile: never classify, render white.
+static EnergyRuleSet make_uncompiled_set() {
+    EnergyRuleSet set = {};
+    for (size_t c = 0; c < (size_t)EnergyCategory::Count; c++) {
+        for (size_t i = 0; i < (size_t)EnergyTier::Count; i++) {
+            set.category[c].tier_rgb[i] = 0xFFFFFF;
+            #if HAS_DISPLAY
+            set.category[c].tier_color[i] = lv_color_white();
+            #endif
+        }
+    }
+    return set;
+}
+
+// Double-buffered: compile fills the inactive slot, then publishes it, so a
+// reader on the LVGL task never sees a half-written rule set.
+static EnergyRuleSet s_sets[2] = {make_uncompiled_set(), make_uncompiled_set()};
+static std::atomic<uint8_t> s_active{0};
+static uint32_t s_generation = 0;
+
+static int32_t kw_to_mkw_round(float kw) {
+    const float scaled = kw * 1000.0f;
+    return (int32_t)(scaled >= 0.0f ? (scaled + 0.5f) : (scaled - 0.5f));
+}
+
+static void compile_category(const EnergyCategoryColorConfig& cfg, bool use_abs, int32_t clear_hyst_mkw, EnergyCategoryRules* out) {
+    out->valid = true;
+    out->use_abs = use_abs;
+    for (size_t i = 0; i < 3; i++) {
+        out->threshold_mkw[i] = cfg.threshold_mkw[i];
+    }
+
+    int32_t clear_mkw = cfg.threshold_mkw[2] - clear_hyst_mkw;
+    if (use_abs && clear_mkw < 0) clear_mkw = 0;
+    out->clear_mkw = clear_mkw;
+
+    out->tier_rgb[(size_t)EnergyTier::Unknown] = 0xFFFFFF;
+    out->tier_rgb[(size_t)EnergyTier::Good] = cfg.color_good_rgb & 0xFFFFFFu;
+    out->tier_rgb[(size_t)EnergyTier::Ok] = cfg.color_ok_rgb & 0xFFFFFFu;
+    out->tier_rgb[(size_t)EnergyTier::Attention] = cfg.color_attention_rgb & 0xFFFFFFu;
+    out->tier_rgb[(size_t)EnergyTier::Warning] = cfg.color_warning_rgb & 0xFFFFFFu;
+
+    #if HAS_DISPLAY
+    for (size_t i = 0; i < (size_t)EnergyTier::Count; i++) {
+        const uint32_t rgb = out->tier_rgb[i];
+        out->tier_color[i] = lv_color_make((uint8_t)((rgb >> 16) & 0xFFu), (uint8_t)((rgb >> 8) & 0xFFu), (uint8_t)(rgb & 0xFFu));
+    }
+    #endif
+}
+
+void energy_thresholds_compile(const DeviceConfig* config) {
+    if (!config) return;
+
+    const uint8_t next = (uint8_t)(s_active.load(std::memory_order_relaxed) ^ 1u);
+    EnergyRuleSet* set = &s_sets[next];
+
+    int32_t clear_hyst = config->energy_alarm_clear_hysteresis_mkw;
+    if (clear_hyst < 0) clear_hyst = 0;
+
+    compile_category(config->energy_solar_colors, true /*use_abs*/, clear_hyst, &set->category[(size_t)EnergyCategory::Solar]);
+    compile_category(config->energy_home_colors, true /*use_abs*/, clear_hyst, &set->category[(size_t)EnergyCategory::Home]);
+    compile_category(config->energy_grid_colors, false /*use_abs*/, clear_hyst, &set->category[(size_t)EnergyCategory::Grid]);
+    uint16_t clear_delay = config->energy_alarm_clear_delay_ms;
+    if (clear_delay > 60000) clear_delay = 60000;
+    set->clear_delay_ms = clear_delay;
+    set->generation = ++s_generation;
+
+    s_active.store(next, std::memory_order_release);
+    LOGD("Energy", "Threshold rules compiled (gen %lu)", (unsigned long)set->generation);
+}
+
+const EnergyRuleSet* energy_thresholds_get() {
+    return &s_sets[s_active.load(std::memory_order_acquire)];
+}
+
+const char* energy_thresholds_tier_name(EnergyTier tier) {
+    switch (tier) {
+        case EnergyTier::Good: return "good";
+        case EnergyTier::Ok: return "ok";
+        case EnergyTier::Attention: return "attention";
+        case EnergyTier::Warning: return "warning";
+        default: return "unknown";
+    }
+}
+
+EnergyClassification energy_thresholds_classify(const EnergyCategoryRules& rules, float kw, bool was_alarm) {
+    EnergyClassification c = {EnergyTier::Unknown, false};
+    if (!rules.valid || isnan(kw)) return c;
+
+    const int32_t mkw = kw_to_mkw_round(rules.use_abs ? fabsf(kw) : kw);
+
+    if (mkw < rules.threshold_mkw[0]) c.tier = EnergyTier::Good;
+    else if (mkw < rules.threshold_mkw[1]) c.tier = EnergyTier::Ok;
+    else if (mkw < rules.threshold_mkw[2]) c.tier = EnergyTier::Attention;
+    else c.tier = EnergyTier::Warning;
+
+    c.alarm = was_alarm ? (mkw >= rules.clear_mkw) : (c.tier == EnergyTier::Warning);
+    return c;
+}
@@ -0,0 +1,70 @@
+#ifndef ENERGY_THRESHOLDS_H
+#define ENERGY_THRESHOLDS_H
+
+#include <Arduino.h>
+#include "board_config.h"
+
+#if HAS_DISPLAY
+#include <lvgl.h>
+#endif
+
+// Compiled form of the per-category EnergyCategoryColorConfig.
+//
+// Built once from DeviceConfig (boot + every config save) so the hot path does
+// no per-frame RGB conversion. Alarm state is derived from these rules once per
+// incoming value by energy_alarm (see energy_alarm.h).
+
+struct DeviceConfig;
+
+enum class EnergyCategory : uint8_t {
+    Solar = 0,
+    Home,
+    Grid,
+    Count,
+};
+
+enum class EnergyTier : uint8_t {
+    Unknown = 0,  // NAN value or rules not compiled yet (rendered white)
+    Good,
+    Ok,
+    Attention,
+    Warning,
+    Count,
+};
+
+struct EnergyCategoryRules {
+    bool valid;
+    bool use_abs;                 // classify |kW| (solar/home) or signed kW (grid)
+    int32_t threshold_mkw[3];
+    int32_t clear_mkw;            // T2 minus clear hysteresis (alarm exit level)
+    uint32_t tier_rgb[(size_t)EnergyTier::Count];
+#if HAS_DISPLAY
+    lv_color_t tier_color[(size_t)EnergyTier::Count];
+#endif
+};
+
+struct EnergyRuleSet {
+    EnergyCategoryRules category[(size_t)EnergyCategory::Count];
+    uint16_t clear_delay_ms;      // alarm must stay clear this long before it ends (energy_alarm)
+    uint32_t generation;          // bumped on every compile
+};
+
+struct EnergyClassification {
+    EnergyTier tier;
+    bool alarm;                   // T2 alarm state (with hysteresis)
+};
+
+// Rebuild the rule set from config (call after load and after every save).
+void energy_thresholds_compile(const DeviceConfig* config);
+
+// Current rule set (never NULL; all categories invalid until the first compile).
+const EnergyRuleSet* energy_thresholds_get();
+
+// Lowercase tier name ("unknown", "good", "ok", "attention", "warning").
+const char* energy_thresholds_tier_name(EnergyTier tier);
+
+// Classify a kW value. was_alarm selects the exit threshold (hysteresis) so a
+// value hovering around T2 does not toggle the alarm.
+EnergyClassification energy_thresholds_classify(const EnergyCategoryRules& rules, float kw, bool was_alarm);
+
+#endif // ENERGY_THRESHOLDS_H
@@ -0,0 +1,229 @@
+#include "energy_totals.h"
+
+#include "board_config.h"
+#include "config_manager.h"
+#include "log_manager.h"
+
+#include <Arduino.h>
+#include <esp_system.h>
+#include <freertos/FreeRTOS.h>
+
+#include <math.h>
+
+// Fixed-point accumulators in micro-watt-hours: float/double increments of a
+// few mWh onto thousands of kWh would lose precision over time.
+struct EnergyCountersUwh {
+    uint64_t import_uwh;
+    uint64_t export_uwh;
+    uint64_t production_uwh;
+};
+
+// NVS record (bump version when the layout changes).
+struct EnergyTotalsRecord {
+    uint16_t version;
+    uint16_t reserved;
+    EnergyCountersUwh lifetime;
+    EnergyCountersUwh period;
+};
+
+static constexpr uint16_t kRecordVersion = 1;
+static const char* const kTotalsKey = "en_kwh";
+
+struct ChannelState {
+    bool valid;
+    float last_kw;
+    uint32_t last_ms;
+};
+
+static portMUX_TYPE g_totals_mux = portMUX_INITIALIZER_UNLOCKED;
+static EnergyCountersUwh g_lifetime = {};
+static EnergyCountersUwh g_period = {};
+static uint32_t g_period_start_ms = 0;
+static bool g_period_start_known = false;
+static volatile bool g_dirty = false;
+
+// Integrator state (g_totals_mux: solar and grid values arrive from several ingest tasks).
+static ChannelState g_solar = {};
+static ChannelState g_grid = {};
+
+static uint32_t g_last_persist_ms = 0;
+static bool g_persisted_once = false;
+static bool g_initialized = false;
+
+// kW * ms -> uWh: 1 kW for 1 ms = 1000 W * (1/3600000) h = 1/3.6 mWh = 277.78 uWh.
+static inline double kw_ms_to_uwh(double kw_ms) {
+    return kw_ms * (1000.0 * 1000.0 / 3600.0);
+}
+
+// Trapezoid area of the positive part of a linear segment a -> b over dt_ms.
+static double positive_area_kw_ms(float a, float b, uint32_t dt_ms) {
+    if (a >= 0.0f && b >= 0.0f) return ((double)a + (double)b) * 0.5 * (double)dt_ms;
+    if (a <= 0.0f && b <= 0.0f) return 0.0;
+
+    // Sign change: only the positive triangle counts.
+    const double hi = (a > 0.0f) ? (double)a : (double)b;
+    const double lo = (a > 0.0f) ? (double)b : (double)a;
+    const double frac = hi / (hi - lo);  // share of dt above zero
+    return hi * 0.5 * frac * (double)dt_ms;
+}
+
+// Returns false when the segment must not be integrated (first sample, gap, NAN).
+static bool advance_channel(ChannelState* ch, float kw, uint32_t now_ms, float* out_prev_kw, uint32_t* out_dt_ms) {
+    if (isnan(kw)) {
+        ch->valid = false;
+        return false;
+    }
+
+    const bool had_prev = ch->valid;
+    const float prev = ch->last_kw;
+    const uint32_t dt = now_ms - ch->last_ms;
+
+    ch->valid = true;
+    ch->last_kw = kw;
+    ch->last_ms = now_ms;
+
+    if (!had_prev || dt == 0 || dt > (uint32_t)ENERGY_TOTALS_MAX_GAP_MS) return false;
+
+    *out_prev_kw = prev;
+    *out_dt_ms = dt;
+    return true;
+}
+
+static void add_counters(uint64_t import_uwh, uint64_t export_uwh, uint64_t production_uwh) {
+    if (import_uwh == 0 && export_uwh == 0 && production_uwh == 0) return;
+
+    portENTER_CRITICAL(&g_totals_mux);
+    g_lifetime.import_uwh += import_uwh;
+    g_lifetime.export_uwh += export_uwh;
+    g_lifetime.production_uwh += production_uwh;
+    g_period.import_uwh += import_uwh;
+    g_period.export_uwh += export_uwh;
+    g_period.production_uwh += production_uwh;
+    portEXIT_CRITICAL(&g_totals_mux);
+    g_dirty = true;
+}
+
+void energy_totals_on_solar(float kw, uint32_t now_ms) {
+    float prev = 0.0f;
+    uint32_t dt = 0;
+    portENTER_CRITICAL(&g_totals_mux);
+    const bool integrate = advance_channel(&g_solar, kw, now_ms, &prev, &dt);
+    portEXIT_CRITICAL(&g_totals_mux);
+    if (!integrate) return;
+
+    // Inverters may report small negative standby draw; production counts only > 0.
+    const double prod = kw_ms_to_uwh(positive_area_kw_ms(prev, kw, dt));
+    add_counters(0, 0, (uint64_t)llround(prod));
+}
+
+void energy_totals_on_grid(float kw, uint32_t now_ms) {
+    float prev = 0.0f;
+    uint32_t dt = 0;
+    portENTER_CRITICAL(&g_totals_mux);
+    const bool integrate = advance_channel(&g_grid, kw, now_ms, &prev, &dt);
+    portEXIT_CRITICAL(&g_totals_mux);
+    if (!integrate) return;
+
+    const double imp = kw_ms_to_uwh(positive_area_kw_ms(prev, kw, dt));
+    const double exp_uwh = kw_ms_to_uwh(positive_area_kw_ms(-prev, -kw, dt));
+    add_counters((uint64_t)llround(imp), (uint64_t)llround(exp_uwh), 0);
+}
+
+static EnergyTotalsKwh to_kwh(const EnergyCountersUwh& c) {
+    EnergyTotalsKwh out;
+    out.import_kwh = (double)c.import_uwh / 1e9;
+    out.export_kwh = (double)c.export_uwh / 1e9;
+    out.production_kwh = (double)c.production_uwh / 1e9;
+    const double self = out.production_kwh - out.export_kwh;
+    out.self_consumption_kwh = self > 0.0 ? self : 0.0;
+    return out;
+}
+
+static void persist_now(uint32_t now_ms) {
+    EnergyTotalsRecord rec = {};
+    rec.version = kRecordVersion;
+    portENTER_CRITICAL(&g_totals_mux);
+    rec.lifetime = g_lifetime;
+    rec.period = g_period;
+    g_dirty = false;
+    portEXIT_CRITICAL(&g_totals_mux);
+
+    if (!config_manager_put_blob(kTotalsKey, &rec, sizeof(rec))) {
+        g_dirty = true;  // retry next interval
+        LOGW("EnergyTotals", "Checkpoint failed");
+        return;
+    }
+    g_last_persist_ms = now_ms;
+    g_persisted_once = true;
+    LOGD("EnergyTotals", "Checkpoint saved");
+}
+
+static void energy_totals_shutdown_handler() {
+    // Runs from esp_restart() (OTA, config save, /api/reboot).
+    energy_totals_flush();
+}
+
+void energy_totals_init() {
+    if (g_initialized) return;
+    g_initialized = true;
+
+    EnergyTotalsRecord rec = {};
+    if (config_manager_get_blob(kTotalsKey, &rec, sizeof(rec)) && rec.version == kRecordVersion) {
+        portENTER_CRITICAL(&g_totals_mux);
+        g_lifetime = rec.lifetime;
+        g_period = rec.period;
+        portEXIT_CRITICAL(&g_totals_mux);
+
+        const EnergyTotalsKwh k = to_kwh(rec.lifetime);
+        LOGI("EnergyTotals", "Restored: import=%.3f export=%.3f production=%.3f kWh",
+            k.import_kwh, k.export_kwh, k.production_kwh);
+    } else {
+        LOGI("EnergyTotals", "No checkpoint; starting from zero");
+    }
+
+    g_last_persist_ms = millis();
+    if (esp_register_shutdown_handler(energy_totals_shutdown_handler) != ESP_OK) {
+        LOGW("EnergyTotals", "Failed to register shutdown handler");
+    }
+}
+
+void energy_totals_loop(uint32_t now_ms) {
+    if (!g_initialized || !g_dirty) return;
+    if ((uint32_t)(now_ms - g_last_persist_ms) < (uint32_t)ENERGY_TOTALS_PERSIST_INTERVAL_MS) return;
+    persist_now(now_ms);
+}
+
+void energy_totals_flush() {
+    if (!g_initialized || !g_dirty) return;
+    persist_now(millis());
+}
+
+void energy_totals_reset_period() {
+    portENTER_CRITICAL(&g_totals_mux);
+    g_period = {};
+    g_period_start_ms = millis();
+    g_period_start_known = true;
+    portEXIT_CRITICAL(&g_totals_mux);
+    g_dirty = true;
+}
+
+EnergyTotalsSnapshot energy_totals_get() {
+    EnergyCountersUwh lifetime;
+    EnergyCountersUwh period;
+    uint32_t period_start_ms;
+    bool period_start_known;
+    portENTER_CRITICAL(&g_totals_mux);
+    lifetime = g_lifetime;
+    period = g_period;
+    period_start_ms = g_period_start_ms;
+    period_start_known = g_period_start_known;
+    portEXIT_CRITICAL(&g_totals_mux);
+
+    const uint32_t now = millis();
+    EnergyTotalsSnapshot snap = {};
+    snap.lifetime = to_kwh(lifetime);
+    snap.period = to_kwh(period);
+    snap.period_age_s = period_start_known ? (uint32_t)(now - period_start_ms) / 1000U : 0;
+    snap.last_persist_age_s = g_persisted_once ? (uint32_t)(now - g_last_persist_ms) / 1000U : UINT32_MAX;
+    return snap;
+}
@@ -0,0 +1,46 @@
+#pragma once
+
+#include <stdint.h>
+
+// On-device kWh counters integrated from the instantaneous solar/grid kW values.
+//
+// Sign conventions match the energy monitor: grid > 0 imports, grid < 0 exports,
+// home = solar + grid. Each channel is integrated with the trapezoid rule over
+// its own update timestamps (split at zero crossings for import/export), and
+// gaps longer than ENERGY_TOTALS_MAX_GAP_MS are not integrated.
+//
+// Counters are checkpointed to NVS (config_manager blob) at most every
+// ENERGY_TOTALS_PERSIST_INTERVAL_MS and on software restart, so at most one
+// interval is lost on power loss while keeping flash wear negligible.
+
+struct EnergyTotalsKwh {
+    double import_kwh;
+    double export_kwh;
+    double production_kwh;
+    double self_consumption_kwh;  // production - export (never negative)
+};
+
+struct EnergyTotalsSnapshot {
+    EnergyTotalsKwh lifetime;
+    EnergyTotalsKwh period;          // since the last energy_totals_reset_period()
+    uint32_t period_age_s;           // seconds of uptime since the period was reset (0 if unknown)
+    uint32_t last_persist_age_s;     // seconds since the last NVS checkpoint (UINT32_MAX if never)
+};
+
+// Load the last checkpoint and register the restart hook (after config_manager_init()).
+void energy_totals_init();
+
+// Feed new instantaneous values (called from energy_monitor_set_*; value may be NAN).
+void energy_totals_on_solar(float kw, uint32_t now_ms);
+void energy_totals_on_grid(float kw, uint32_t now_ms);
+
+// Rate-limited NVS checkpointing (call from loop()).
+void energy_totals_loop(uint32_t now_ms);
+
+// Force a checkpoint now if counters changed (e.g. before a planned restart).
+void energy_totals_flush();
+
+// Reset the period counters (e.g. daily totals reset by an automation at midnight).
+void energy_totals_reset_period();
+
+EnergyTotalsSnapshot energy_totals_get();
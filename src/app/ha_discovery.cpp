@@ -5,219 +5,253 @@
 #if HAS_MQTT
 
 #include "mqtt_manager.h"
+#include "energy_metrics.h"
 #include "web_assets.h" // PROJECT_DISPLAY_NAME
 #include "../version.h" // FIRMWARE_VERSION
-#include <ArduinoJson.h>
-
-static bool publish_sensor_config(
-    MqttManager &mqtt,
-    const char *object_id,
-    const char *name_suffix,
-    const char *value_template,
-    const char *unit_of_measurement,
-    const char *device_class,
-    const char *state_class,
-    const char *entity_category
-);
-
-static bool publish_binary_sensor_config(
-    MqttManager &mqtt,
-    const char *object_id,
-    const char *name_suffix,
-    const char *value_template,
-    const char *device_class,
-    const char *entity_category
-);
-
-void ha_discovery_publish_health(MqttManager &mqtt) {
-    // Notes:
-    // - Single JSON publish model: all entities share the same stat_t.
-    // - value_template extracts fields from the JSON payload.
-
-    publish_sensor_config(mqtt, "uptime", "Uptime", "{{ value_json.uptime_seconds }}", "s", "duration", "measurement", "diagnostic");
-    publish_sensor_config(mqtt, "reset_reason", "Reset Reason", "{{ value_json.reset_reason }}", "", "", "", "diagnostic");
-
-    publish_sensor_config(mqtt, "cpu_usage", "CPU Usage", "{{ value_json.cpu_usage }}", "%", "", "measurement", "diagnostic");
-    publish_sensor_config(mqtt, "cpu_temperature", "Core Temp", "{{ value_json.cpu_temperature }}", "°C", "temperature", "measurement", "diagnostic");
-
-    publish_sensor_config(mqtt, "heap_free", "Free Heap", "{{ value_json.heap_free }}", "B", "", "measurement", "diagnostic");
-    publish_sensor_config(mqtt, "heap_min", "Min Free Heap", "{{ value_json.heap_min }}", "B", "", "measurement", "diagnostic");
-    publish_sensor_config(mqtt, "heap_largest", "Largest Heap Block", "{{ value_json.heap_largest }}", "B", "", "measurement", "diagnostic");
-    publish_sensor_config(mqtt, "heap_fragmentation", "Heap Fragmentation", "{{ value_json.heap_fragmentation }}", "%", "", "measurement", "diagnostic");
-
-    publish_sensor_config(mqtt, "heap_internal_free", "Internal Heap Free", "{{ value_json.heap_internal_free }}", "B", "", "measurement", "diagnostic");
-    publish_sensor_config(mqtt, "heap_internal_min", "Internal Heap Min", "{{ value_json.heap_internal_min }}", "B", "", "measurement", "diagnostic");
-    publish_sensor_config(mqtt, "heap_internal_largest", "Internal Heap Largest", "{{ value_json.heap_internal_largest }}", "B", "", "measurement", "diagnostic");
-
-    publish_sensor_config(mqtt, "psram_free", "PSRAM Free", "{{ value_json.psram_free }}", "B", "", "measurement", "diagnostic");
-    publish_sensor_config(mqtt, "psram_min", "PSRAM Min Free", "{{ value_json.psram_min }}", "B", "", "measurement", "diagnostic");
-    publish_sensor_config(mqtt, "psram_largest", "PSRAM Largest Block", "{{ value_json.psram_largest }}", "B", "", "measurement", "diagnostic");
-    publish_sensor_config(mqtt, "psram_fragmentation", "PSRAM Fragmentation", "{{ value_json.psram_fragmentation }}", "%", "", "measurement", "diagnostic");
-
-    publish_sensor_config(mqtt, "flash_used", "Flash Used", "{{ value_json.flash_used }}", "B", "", "measurement", "diagnostic");
-    publish_sensor_config(mqtt, "flash_total", "Flash Total", "{{ value_json.flash_total }}", "B", "", "measurement", "diagnostic");
-
-    publish_binary_sensor_config(mqtt, "fs_mounted", "FS Mounted", "{{ 'ON' if value_json.fs_mounted else 'OFF' }}", "", "diagnostic");
-    publish_sensor_config(mqtt, "fs_used_bytes", "FS Used", "{{ value_json.fs_used_bytes }}", "B", "", "measurement", "diagnostic");
-    publish_sensor_config(mqtt, "fs_total_bytes", "FS Total", "{{ value_json.fs_total_bytes }}", "B", "", "measurement", "diagnostic");
+
+enum class HaComponent : uint8_t {
+    Sensor = 0,
+    BinarySensor,
+};
+
+struct HaEntity {
+    HaComponent component;
+    const char *object_id;
+    const char *name_suffix;
+    const char *value_template;
+    const char *unit_of_measurement;
+    const char *device_class;
+    const char *state_class;
+    const char *entity_category;
+    const char *state_topic;  // relative to ~; nullptr = the shared health state
+    const char *availability_template;  // 'online'/'offline' from the state payload; nullptr = device only
+};
+
+// Notes:
+// - Single JSON publish model: entities share the same stat_t unless state_topic is set.
+// - value_template extracts fields from the JSON payload.
+// - availability_template marks an entity unavailable while its field is null, instead of
+//   HA rendering the literal "None"; the device availability topic must be online too.
+// - Empty strings / nullptr omit the field.
+static const HaEntity kHaEntities[] = {
+    {HaComponent::Sensor, "uptime", "Uptime", "{{ value_json.uptime_seconds }}", "s", "duration", "measurement", "diagnostic"},
+    {HaComponent::Sensor, "reset_reason", "Reset Reason", "{{ value_json.reset_reason }}", "", "", "", "diagnostic"},
+
+    {HaComponent::Sensor, "cpu_usage", "CPU Usage", "{{ value_json.cpu_usage }}", "%", "", "measurement", "diagnostic"},
+    {HaComponent::Sensor, "cpu_temperature", "Core Temp", "{{ value_json.cpu_temperature }}", "°C", "temperature", "measurement", "diagnostic"},
+
+    {HaComponent::Sensor, "heap_free", "Free Heap", "{{ value_json.heap_free }}", "B", "", "measurement", "diagnostic"},
+    {HaComponent::Sensor, "heap_min", "Min Free Heap", "{{ value_json.heap_min }}", "B", "", "measurement", "diagnostic"},
+    {HaComponent::Sensor, "heap_largest", "Largest Heap Block", "{{ value_json.heap_largest }}", "B", "", "measurement", "diagnostic"},
+    {HaComponent::Sensor, "heap_fragmentation", "Heap Fragmentation", "{{ value_json.heap_fragmentation }}", "%", "", "measurement", "diagnostic"},
+
+    {HaComponent::Sensor, "heap_internal_free", "Internal Heap Free", "{{ value_json.heap_internal_free }}", "B", "", "measurement", "diagnostic"},
+    {HaComponent::Sensor, "heap_internal_min", "Internal Heap Min", "{{ value_json.heap_internal_min }}", "B", "", "measurement", "diagnostic"},
+    {HaComponent::Sensor, "heap_internal_largest", "Internal Heap Largest", "{{ value_json.heap_internal_largest }}", "B", "", "measurement", "diagnostic"},
+
+    {HaComponent::Sensor, "psram_free", "PSRAM Free", "{{ value_json.psram_free }}", "B", "", "measurement", "diagnostic"},
+    {HaComponent::Sensor, "psram_min", "PSRAM Min Free", "{{ value_json.psram_min }}", "B", "", "measurement", "diagnostic"},
+    {HaComponent::Sensor, "psram_largest", "PSRAM Largest Block", "{{ value_json.psram_largest }}", "B", "", "measurement", "diagnostic"},
+    {HaComponent::Sensor, "psram_fragmentation", "PSRAM Fragmentation", "{{ value_json.psram_fragmentation }}", "%", "", "measurement", "diagnostic"},
+
+    {HaComponent::Sensor, "flash_used", "Flash Used", "{{ value_json.flash_used }}", "B", "", "measurement", "diagnostic"},
+    {HaComponent::Sensor, "flash_total", "Flash Total", "{{ value_json.flash_total }}", "B", "", "measurement", "diagnostic"},
+
+    {HaComponent::BinarySensor, "fs_mounted", "FS Mounted", "{{ 'ON' if value_json.fs_mounted else 'OFF' }}", "", "", "", "diagnostic"},
+    {HaComponent::Sensor, "fs_used_bytes", "FS Used", "{{ value_json.fs_used_bytes }}", "B", "", "measurement", "diagnostic"},
+    {HaComponent::Sensor, "fs_total_bytes", "FS Total", "{{ value_json.fs_total_bytes }}", "B", "", "measurement", "diagnostic"},
 
     #if HAS_DISPLAY
-    publish_sensor_config(mqtt, "display_fps", "Display FPS", "{{ value_json.display_fps }}", "fps", "", "measurement", "diagnostic");
-    publish_sensor_config(mqtt, "display_lv_timer_us", "Display LV Timer", "{{ value_json.display_lv_timer_us }}", "us", "", "measurement", "diagnostic");
-    publish_sensor_config(mqtt, "display_present_us", "Display Present", "{{ value_json.display_present_us }}", "us", "", "measurement", "diagnostic");
+    {HaComponent::Sensor, "display_fps", "Display FPS", "{{ value_json.display_fps }}", "fps", "", "measurement", "diagnostic"},
+    {HaComponent::Sensor, "display_lv_timer_us", "Display LV Timer", "{{ value_json.display_lv_timer_us }}", "us", "", "measurement", "diagnostic"},
+    {HaComponent::Sensor, "display_present_us", "Display Present", "{{ value_json.display_present_us }}", "us", "", "measurement", "diagnostic"},
+    {HaComponent::Sensor, "display_lv_timer_p95_us", "Display LV Timer p95", "{{ value_json.display_lv_timer_p95_us }}", "us", "", "measurement", "diagnostic"},
+    {HaComponent::Sensor, "display_flush_p95_us", "Display Flush p95", "{{ value_json.display_flush_p95_us }}", "us", "", "measurement", "diagnostic"},
+    {HaComponent::Sensor, "display_bus_bytes_per_s", "Display Bus Throughput", "{{ value_json.display_bus_bytes_per_s }}", "B/s", "data_rate", "measurement", "diagnostic"},
     #endif
 
-    publish_sensor_config(mqtt, "wifi_rssi", "WiFi RSSI", "{{ value_json.wifi_rssi }}", "dBm", "signal_strength", "measurement", "diagnostic");
+    {HaComponent::Sensor, "wifi_rssi", "WiFi RSSI", "{{ value_json.wifi_rssi }}", "dBm", "signal_strength", "measurement", "diagnostic"},
+
+    // Gated T2 alarm from energy_alarm, published on change (not with health samples).
+    {HaComponent::BinarySensor, "energy_alarm", "Energy Alarm", "{{ value }}", "", "problem", "", nullptr, "~/energy/alarm"},
+
+    #if ENERGY_METRICS_SUPPORTED
+    // Derived energy metrics (energy_metrics.h), change-driven on their own topic.
+    {HaComponent::Sensor, "home_power", "Home Power", "{{ value_json.home_kw }}", "kW", "power", "measurement", nullptr, "~/energy/derived",
+     "{{ 'offline' if value_json.home_kw is none else 'online' }}"},
+    {HaComponent::Sensor, "self_consumption", "Self-Consumption", "{{ value_json.self_consumption_pct }}", "%", "", "measurement", nullptr, "~/energy/derived",
+     "{{ 'offline' if value_json.self_consumption_pct is none else 'online' }}"},
+    {HaComponent::Sensor, "solar_tier", "Solar Tier", "{{ value_json.solar_tier }}", "", "", "", nullptr, "~/energy/derived"},
+    {HaComponent::Sensor, "home_tier", "Home Tier", "{{ value_json.home_tier }}", "", "", "", nullptr, "~/energy/derived"},
+    {HaComponent::Sensor, "grid_tier", "Grid Tier", "{{ value_json.grid_tier }}", "", "", "", nullptr, "~/energy/derived"},
+    #endif
 
     // =====================================================================
     // USER-EXTEND: Add your own Home Assistant entities here
     // =====================================================================
     // To add new sensors (e.g. ambient temperature + humidity), you typically:
     //   1) Add JSON fields to device_telemetry_fill_mqtt() in device_telemetry.cpp
+    //      (with MQTT_HEALTH_TEMPLATE: a slot in device_telemetry_collect_mqtt())
     //   2) Add matching discovery entries below (value_template must match keys)
     //
     // Example (commented out): External temperature/humidity
     // (These will show up under the normal Sensors category in Home Assistant.)
-    // publish_sensor_config(mqtt, "temperature", "Temperature", "{{ value_json.temperature }}", "°C", "temperature", "measurement", nullptr);
-    // publish_sensor_config(mqtt, "humidity", "Humidity", "{{ value_json.humidity }}", "%", "humidity", "measurement", nullptr);
-}
-
-static bool publish_binary_sensor_config(
-    MqttManager &mqtt,
-    const char *object_id,
-    const char *name_suffix,
-    const char *value_template,
-    const char *device_class,
-    const char *entity_category
-) {
-    char topic[160];
-    snprintf(topic, sizeof(topic), "homeassistant/binary_sensor/%s/%s/config", mqtt.sanitizedName(), object_id);
-
-    StaticJsonDocument<768> doc;
-
-    // Use base topic shortcut to keep discovery payload small
-    doc["~"] = mqtt.baseTopic();
-
-    // Friendly name in payload
-    // Keep entity name short; HA already groups entities under the device name.
-    doc["name"] = name_suffix;
-
-    // Provide a stable object_id that includes the device name once.
-    char ha_object_id[96];
-    snprintf(ha_object_id, sizeof(ha_object_id), "%s_%s", mqtt.sanitizedName(), object_id);
-    doc["object_id"] = ha_object_id;
-
-    if (entity_category && strlen(entity_category) > 0) {
-        doc["entity_category"] = entity_category;
+    // {HaComponent::Sensor, "temperature", "Temperature", "{{ value_json.temperature }}", "°C", "temperature", "measurement", nullptr},
+    // {HaComponent::Sensor, "humidity", "Humidity", "{{ value_json.humidity }}", "%", "humidity", "measurement", nullptr},
+};
+
+// Payload sink: pass 1 only counts bytes (beginPublish needs the length up front),
+// pass 2 streams through a small stack buffer into the MQTT client.
+struct DiscoverySink {
+    MqttManager *mqtt;   // nullptr = count only
+    size_t len;
+    bool ok;
+    uint8_t buf[128];
+    size_t fill;
+
+    void flush() {
+        if (!mqtt || fill == 0) return;
+        if (mqtt->streamWrite(buf, fill) != fill) ok = false;
+        fill = 0;
     }
 
-    // Stable unique id (sanitized name + object id)
-    char uniq_id[96];
-    snprintf(uniq_id, sizeof(uniq_id), "%s_%s", mqtt.sanitizedName(), object_id);
-    doc["uniq_id"] = uniq_id;
-
-    doc["stat_t"] = "~/health/state";
-    doc["val_tpl"] = value_template;
-
-    // MQTT binary_sensor expects ON/OFF payloads.
-    doc["pl_on"] = "ON";
-    doc["pl_off"] = "OFF";
-
-    // Availability
-    doc["avty_t"] = "~/availability";
-    doc["pl_avail"] = "online";
-    doc["pl_not_avail"] = "offline";
-
-    if (device_class && strlen(device_class) > 0) {
-        doc["dev_cla"] = device_class;
+    void put(const char *s, size_t n) {
+        len += n;
+        if (!mqtt) return;
+        while (n > 0) {
+            size_t room = sizeof(buf) - fill;
+            size_t take = (n < room) ? n : room;
+            memcpy(buf + fill, s, take);
+            fill += take;
+            s += take;
+            n -= take;
+            if (fill == sizeof(buf)) flush();
+        }
     }
 
-    // Device block (kept minimal)
-    JsonObject dev = doc["dev"].to<JsonObject>();
-    JsonArray ids = dev["ids"].to<JsonArray>();
-    ids.add(mqtt.sanitizedName());
-    dev["name"] = mqtt.friendlyName();
-    dev["mdl"] = PROJECT_DISPLAY_NAME;
-    dev["sw"] = FIRMWARE_VERSION;
-
-    if (doc.overflowed()) {
-        return false;
+    void raw(const char *s) { put(s, strlen(s)); }
+
+    // JSON string literal (quotes + escaping for user-provided names).
+    void str(const char *s) {
+        raw("\"");
+        for (const char *p = s ? s : ""; *p; p++) {
+            const unsigned char c = (unsigned char)*p;
+            if (c == '"' || c == '\\') {
+                const char esc[2] = {'\\', (char)c};
+                put(esc, 2);
+            } else if (c < 0x20) {
+                char esc[8];
+                snprintf(esc, sizeof(esc), "\\u%04x", c);
+                raw(esc);
+            } else {
+                put(p, 1);
+            }
+        }
+        raw("\"");
     }
 
-    return mqtt.publishJson(topic, doc, true);
-}
+    void field(const char *key, const char *value) {
+        raw(",\"");
+        raw(key);
+        raw("\":");
+        str(value);
+    }
 
-static bool publish_sensor_config(
-    MqttManager &mqtt,
-    const char *object_id,
-    const char *name_suffix,
-    const char *value_template,
-    const char *unit_of_measurement,
-    const char *device_class,
-    const char *state_class,
-    const char *entity_category = nullptr
-) {
-    char topic[160];
-    snprintf(topic, sizeof(topic), "homeassistant/sensor/%s/%s/config", mqtt.sanitizedName(), object_id);
+    void optional_field(const char *key, const char *value) {
+        if (value && value[0]) field(key, value);
+    }
 
-    StaticJsonDocument<768> doc;
+    // "<sanitized>_<object_id>" without a temporary buffer.
+    void prefixed_field(const char *key, const char *prefix, const char *suffix) {
+        raw(",\"");
+        raw(key);
+        raw("\":\"");
+        put(prefix, strlen(prefix));
+        raw("_");
+        put(suffix, strlen(suffix));
+        raw("\"");
+    }
+};
 
+static void write_entity(DiscoverySink &s, MqttManager &mqtt, const HaEntity &e) {
     // Use base topic shortcut to keep discovery payload small
-    doc["~"] = mqtt.baseTopic();
+    s.raw("{\"~\":");
+    s.str(mqtt.baseTopic());
 
-    // Friendly name in payload
     // Keep entity name short; HA already groups entities under the device name.
-    // This also avoids HA generating entity_id values that repeat the device name.
-    doc["name"] = name_suffix;
+    s.field("name", e.name_suffix);
 
-    // Provide a stable object_id that includes the device name once.
-    // HA uses this to generate entity_id like: sensor.<sanitized>_<object_id>.
-    char ha_object_id[96];
-    snprintf(ha_object_id, sizeof(ha_object_id), "%s_%s", mqtt.sanitizedName(), object_id);
-    doc["object_id"] = ha_object_id;
+    // Stable object_id / unique id (sanitized name + object id). HA uses object_id
+    // to generate entity_id like: sensor.<sanitized>_<object_id>.
+    s.prefixed_field("object_id", mqtt.sanitizedName(), e.object_id);
+    s.optional_field("entity_category", e.entity_category);
+    s.prefixed_field("uniq_id", mqtt.sanitizedName(), e.object_id);
 
-    if (entity_category && strlen(entity_category) > 0) {
-        doc["entity_category"] = entity_category;
-    }
-
-    // Stable unique id (sanitized name + object id)
-    char uniq_id[96];
-    snprintf(uniq_id, sizeof(uniq_id), "%s_%s", mqtt.sanitizedName(), object_id);
-    doc["uniq_id"] = uniq_id;
+    if (e.state_topic) s.field("stat_t", e.state_topic);
+    else s.raw(",\"stat_t\":\"~/health/state\"");
+    s.field("val_tpl", e.value_template);
 
-    doc["stat_t"] = "~/health/state";
-    doc["val_tpl"] = value_template;
+    if (e.component == HaComponent::BinarySensor) {
+        // MQTT binary_sensor expects ON/OFF payloads.
+        s.raw(",\"pl_on\":\"ON\",\"pl_off\":\"OFF\"");
+    }
 
     // Availability
-    doc["avty_t"] = "~/availability";
-    doc["pl_avail"] = "online";
-    doc["pl_not_avail"] = "offline";
-
-    if (unit_of_measurement && strlen(unit_of_measurement) > 0) {
-        doc["unit_of_meas"] = unit_of_measurement;
+    if (e.availability_template && e.state_topic) {
+        // Both must be online: the device, and the entity's field in its own payload.
+        s.raw(",\"avty_mode\":\"all\",\"avty\":[{\"t\":\"~/availability\",\"pl_avail\":\"online\",\"pl_not_avail\":\"offline\"},{\"t\":");
+        s.str(e.state_topic);
+        s.field("val_tpl", e.availability_template);
+        s.raw(",\"pl_avail\":\"online\",\"pl_not_avail\":\"offline\"}]");
+    } else {
+        s.raw(",\"avty_t\":\"~/availability\",\"pl_avail\":\"online\",\"pl_not_avail\":\"offline\"");
     }
-    if (device_class && strlen(device_class) > 0) {
-        doc["dev_cla"] = device_class;
+
+    if (e.component == HaComponent::Sensor) {
+        s.optional_field("unit_of_meas", e.unit_of_measurement);
     }
-    if (state_class && strlen(state_class) > 0) {
-        doc["stat_cla"] = state_class;
+    s.optional_field("dev_cla", e.device_class);
+    if (e.component == HaComponent::Sensor) {
+        s.optional_field("stat_cla", e.state_class);
     }
 
     // Device block (kept minimal)
-    JsonObject dev = doc["dev"].to<JsonObject>();
-    JsonArray ids = dev["ids"].to<JsonArray>();
-    ids.add(mqtt.sanitizedName());
-    dev["name"] = mqtt.friendlyName();
-    dev["mdl"] = PROJECT_DISPLAY_NAME;
-    dev["sw"] = FIRMWARE_VERSION;
-
-    if (doc.overflowed()) {
-        // Payload too large for this StaticJsonDocument size.
-        // mqtt.publishJson() will also fail if serialization exceeds MQTT_MAX_PACKET_SIZE.
-        return false;
-    }
+    s.raw(",\"dev\":{\"ids\":[");
+    s.str(mqtt.sanitizedName());
+    s.raw("]");
+    s.field("name", mqtt.friendlyName());
+    s.field("mdl", PROJECT_DISPLAY_NAME);
+    s.field("sw", FIRMWARE_VERSION);
+    s.raw("}}");
+}
+
+size_t ha_discovery_entity_count() {
+    return sizeof(kHaEntities) / sizeof(kHaEntities[0]);
+}
+
+bool ha_discovery_publish_entity(MqttManager &mqtt, size_t index) {
+    if (index >= ha_discovery_entity_count()) return false;
+    const HaEntity &e = kHaEntities[index];
+
+    char topic[160];
+    snprintf(topic, sizeof(topic), "homeassistant/%s/%s/%s/config",
+             e.component == HaComponent::BinarySensor ? "binary_sensor" : "sensor",
+             mqtt.sanitizedName(), e.object_id);
+
+    DiscoverySink counter = {};
+    write_entity(counter, mqtt, e);
+
+    if (!mqtt.streamBegin(topic, counter.len, true)) return false;
+
+    DiscoverySink sink = {};
+    sink.mqtt = &mqtt;
+    sink.ok = true;
+    write_entity(sink, mqtt, e);
+    sink.flush();
 
-    return mqtt.publishJson(topic, doc, true);
+    // endPublish() must run even after a short write to release the client.
+    const bool ended = mqtt.streamEnd();
+    return sink.ok && ended && sink.len == counter.len;
 }
 
 #endif // HAS_MQTT
@@ -8,9 +8,20 @@
 
 class MqttManager;
 
-// Publish Home Assistant MQTT discovery configuration for the health sensors.
-// Intended to be called once per boot after MQTT connects.
-void ha_discovery_publish_health(MqttManager &mqtt);
+// Home Assistant MQTT discovery for the health sensors.
+//
+// Entities come from a flash-resident table and are published one at a time, so
+// MqttManager can spread discovery over several loop iterations (see
+// HA_DISCOVERY_ENTITIES_PER_TICK) instead of bursting everything on connect.
+// Payloads are streamed with beginPublish/write/endPublish; no JSON document or
+// MQTT_MAX_PACKET_SIZE buffer is needed.
+
+// Number of discovery entities for this build.
+size_t ha_discovery_entity_count();
+
+// Publish discovery config for entity `index` (0..count-1). MQTT task only.
+// Returns false when the publish failed (caller retries later).
+bool ha_discovery_publish_entity(MqttManager &mqtt, size_t index);
 
 #endif // HAS_MQTT
 
@@ -3,65 +3,152 @@
 #include "board_config.h"
 #include "device_telemetry.h"
 #include "log_manager.h"
+#include "time_series_ring.h"
+#include "app_alloc.h"
 
 #include <Arduino.h>
+#include <esp_attr.h>
+#include <esp_rom_crc.h>
+#include <esp_system.h>
 
 #include <freertos/FreeRTOS.h>
 #include <freertos/timers.h>
 
-#if ESP32
-#include <esp_heap_caps.h>
-#endif
-
 #if HEALTH_HISTORY_ENABLED
 
-static portMUX_TYPE g_hist_mux = portMUX_INITIALIZER_UNLOCKED;
+// Packed ring entry: 16 bytes instead of the 44-byte HealthHistorySample.
+// - Memory values are stored in 256-byte units (16 bits covers 16 MB).
+// - Window min/max are stored as distances below/above the current value in an
+//   8-bit float (4-bit exponent, 4-bit mantissa), rounded outward so the decoded
+//   band always contains the real one. Typical deltas of a few KB stay exact.
+// - Uptime keeps 16 bits of seconds; get() rebuilds it from the newest sample's
+//   full millis() (the window is far shorter than 65536 s). Rebuilt uptimes are
+//   whole seconds, so a sample reads back with the same uptime_ms however far the
+//   newest one has moved (the ?since= cursor relies on that).
+struct PackedHealthSample {
+    uint16_t uptime_s;
+    int8_t cpu_usage;          // -1 => unknown
+    uint8_t reserved;
+    uint16_t value[3];         // heap_internal_free, psram_free, heap_internal_largest
+    uint8_t below[3];          // f8(value - min_window)
+    uint8_t above[3];          // f8(max_window - value)
+};
+static_assert(sizeof(PackedHealthSample) == 16, "PackedHealthSample layout (HEALTH_HISTORY_MAX_BYTES guard assumes 16 B)");
+
+static_assert((uint64_t)HEALTH_HISTORY_SAMPLES * HEALTH_HISTORY_PERIOD_MS < 65536ULL * 1000ULL,
+              "Health history window must stay below 65536 s");
+static_assert(HEALTH_HISTORY_PERIOD_MS >= 1000, "Health history keeps one sample per uptime second at most");
+
+static constexpr uint32_t kUnitShift = 8;  // 256-byte units
+
 static TimerHandle_t g_hist_timer = nullptr;
-static HealthHistorySample* g_hist_samples = nullptr;
-static size_t g_hist_capacity = 0;
-static size_t g_hist_head = 0; // next write index
-static size_t g_hist_count = 0;
-
-static void* hist_alloc(size_t bytes) {
-    if (bytes == 0) return nullptr;
-
-#if SOC_SPIRAM_SUPPORTED
-    if (ESP.getPsramSize() > 0) {
-        void* p = heap_caps_malloc(bytes, MALLOC_CAP_SPIRAM);
-        if (p) return p;
+static TimeSeriesRing<PackedHealthSample> g_hist;
+static volatile uint32_t g_newest_uptime_ms = 0;
+
+#if HEALTH_HISTORY_RTC_SAMPLES > 0
+// Mirror of the newest samples in RTC slow memory: survives panics, watchdog and
+// software resets (not power loss), so the minutes before a crash can be read back
+// after the reboot. Written by the timer callback only.
+static constexpr size_t kRtcSamples = ((size_t)HEALTH_HISTORY_RTC_SAMPLES < (size_t)HEALTH_HISTORY_SAMPLES)
+    ? (size_t)HEALTH_HISTORY_RTC_SAMPLES : (size_t)HEALTH_HISTORY_SAMPLES;
+static constexpr uint32_t kRtcMagic = 0x48485231; // "HHR1"
+
+struct RtcHistory {
+    uint32_t magic;
+    uint32_t newest_uptime_ms;
+    uint16_t head;    // next slot to write
+    uint16_t count;
+    uint32_t crc;     // over the fields above; a torn header update reads as invalid
+    PackedHealthSample samples[kRtcSamples];
+};
+
+RTC_NOINIT_ATTR static RtcHistory s_rtc;
+
+// Previous boot, copied out of RTC memory before the mirror is reused.
+static PackedHealthSample* g_prev = nullptr;
+static size_t g_prev_count = 0;
+static uint32_t g_prev_newest_ms = 0;
+
+static uint32_t rtc_crc() {
+    return esp_rom_crc32_le(0, (const uint8_t*)&s_rtc, offsetof(RtcHistory, crc));
+}
+
+static bool rtc_valid() {
+    return s_rtc.magic == kRtcMagic && s_rtc.head < kRtcSamples && s_rtc.count <= kRtcSamples && s_rtc.crc == rtc_crc();
+}
+
+static void rtc_reset() {
+    s_rtc.magic = kRtcMagic;
+    s_rtc.newest_uptime_ms = 0;
+    s_rtc.head = 0;
+    s_rtc.count = 0;
+    s_rtc.crc = rtc_crc();
+}
+
+static void rtc_restore() {
+    // RTC slow memory holds garbage after power-on.
+    const esp_reset_reason_t reason = esp_reset_reason();
+    if (reason != ESP_RST_POWERON && rtc_valid() && s_rtc.count > 0) {
+        const size_t n = s_rtc.count;
+        g_prev = (PackedHealthSample*)app_alloc(AllocTag::History, n * sizeof(PackedHealthSample), AllocPolicy::PreferPsram);
+        if (g_prev) {
+            const size_t oldest = (s_rtc.head + kRtcSamples - n) % kRtcSamples;
+            for (size_t i = 0; i < n; i++) g_prev[i] = s_rtc.samples[(oldest + i) % kRtcSamples];
+            g_prev_count = n;
+            g_prev_newest_ms = s_rtc.newest_uptime_ms;
+            LOGI("HealthHist", "Restored %u samples of the previous boot (reset reason %d, up %lus)",
+                (unsigned)n, (int)reason, (unsigned long)(g_prev_newest_ms / 1000U));
+        }
     }
-#endif
+    rtc_reset();
+}
 
-#if ESP32
-    // Prefer internal heap but allow fallback.
-    void* p = heap_caps_malloc(bytes, MALLOC_CAP_INTERNAL | MALLOC_CAP_8BIT);
-    if (p) return p;
+static void rtc_mirror(const PackedHealthSample& p, uint32_t uptime_ms) {
+    s_rtc.samples[s_rtc.head] = p;
+    s_rtc.head = (uint16_t)((s_rtc.head + 1) % kRtcSamples);
+    if (s_rtc.count < kRtcSamples) s_rtc.count++;
+    s_rtc.newest_uptime_ms = uptime_ms;
+    s_rtc.crc = rtc_crc();
+}
 #endif
 
-    return malloc(bytes);
+static uint32_t f8_decode(uint8_t c) {
+    const uint32_t e = c >> 4;
+    const uint32_t m = c & 0x0F;
+    return e == 0 ? m : (16 + m) << (e - 1);
 }
 
-static void hist_free(void* p) {
-    if (!p) return;
-#if ESP32
-    heap_caps_free(p);
-#else
-    free(p);
-#endif
+// Smallest code whose decoded value is >= v (saturates at the largest code).
+static uint8_t f8_encode_up(uint32_t v) {
+    if (v < 16) return (uint8_t)v;
+    for (uint32_t e = 1; e < 16; e++) {
+        const uint32_t step = 1u << (e - 1);
+        const uint32_t m = (v + step - 1) / step;  // ceil
+        if (m <= 31) return (uint8_t)((e << 4) | (m - 16));
+    }
+    return 0xFF;
 }
 
-static void hist_write_sample(const HealthHistorySample& s) {
-    portENTER_CRITICAL(&g_hist_mux);
+static uint16_t to_units(uint32_t bytes) {
+    const uint32_t u = (bytes + (1u << (kUnitShift - 1))) >> kUnitShift;
+    return u > 0xFFFF ? (uint16_t)0xFFFF : (uint16_t)u;
+}
 
-    if (g_hist_samples && g_hist_capacity > 0) {
-        g_hist_samples[g_hist_head] = s;
-        g_hist_head = (g_hist_head + 1) % g_hist_capacity;
-        if (g_hist_count < g_hist_capacity) {
-            g_hist_count++;
-        }
-    }
+static void pack_metric(PackedHealthSample* p, int i, uint32_t value, uint32_t min_w, uint32_t max_w) {
+    const uint16_t v = to_units(value);
+    const uint32_t min_u = min_w >> kUnitShift;                                   // floor
+    const uint32_t max_u = (max_w + (1u << kUnitShift) - 1) >> kUnitShift;        // ceil
+    p->value[i] = v;
+    p->below[i] = f8_encode_up(min_u < v ? v - min_u : 0);
+    p->above[i] = f8_encode_up(max_u > v ? max_u - v : 0);
+}
 
-    portEXIT_CRITICAL(&g_hist_mux);
+static void unpack_metric(const PackedHealthSample& p, int i, uint32_t* value, uint32_t* min_w, uint32_t* max_w) {
+    const uint32_t v = p.value[i];
+    const uint32_t below = f8_decode(p.below[i]);
+    *value = v << kUnitShift;
+    *min_w = (below < v ? v - below : 0) << kUnitShift;
+    *max_w = (v + f8_decode(p.above[i])) << kUnitShift;
 }
 
 static void hist_timer_cb(TimerHandle_t) {
@@ -101,27 +188,39 @@ static void hist_timer_cb(TimerHandle_t) {
         s.heap_internal_largest_max_window = s.heap_internal_largest;
     }
 
-    hist_write_sample(s);
+    PackedHealthSample p = {};
+    p.uptime_s = (uint16_t)(s.uptime_ms / 1000U);
+    p.cpu_usage = (int8_t)(s.cpu_usage < 0 ? -1 : (s.cpu_usage > 127 ? 127 : s.cpu_usage));
+    pack_metric(&p, 0, s.heap_internal_free, s.heap_internal_free_min_window, s.heap_internal_free_max_window);
+    pack_metric(&p, 1, s.psram_free, s.psram_free_min_window, s.psram_free_max_window);
+    pack_metric(&p, 2, s.heap_internal_largest, s.heap_internal_largest_min_window, s.heap_internal_largest_max_window);
+
+    // Anchor first: a reader that sees this sample also sees its uptime.
+    g_newest_uptime_ms = s.uptime_ms;
+    g_hist.push(p);
+
+    #if HEALTH_HISTORY_RTC_SAMPLES > 0
+    rtc_mirror(p, s.uptime_ms);
+    #endif
 }
 
 void health_history_start() {
     if (g_hist_timer != nullptr) return;
 
-    g_hist_capacity = (size_t)HEALTH_HISTORY_SAMPLES;
-    g_hist_head = 0;
-    g_hist_count = 0;
-
-    const size_t bytes = g_hist_capacity * sizeof(HealthHistorySample);
-    g_hist_samples = (HealthHistorySample*)hist_alloc(bytes);
+    #if HEALTH_HISTORY_RTC_SAMPLES > 0
+    // Before the first sample overwrites the mirror.
+    static bool s_restored = false;
+    if (!s_restored) {
+        s_restored = true;
+        rtc_restore();
+    }
+    #endif
 
-    if (!g_hist_samples) {
+    if (!g_hist.allocate((size_t)HEALTH_HISTORY_SAMPLES)) {
         LOGE("HealthHist", "Failed to allocate history buffer");
-        g_hist_capacity = 0;
         return;
     }
 
-    memset(g_hist_samples, 0, bytes);
-
     g_hist_timer = xTimerCreate(
         "health_hist",
         pdMS_TO_TICKS((uint32_t)HEALTH_HISTORY_PERIOD_MS),
@@ -132,9 +231,7 @@ void health_history_start() {
 
     if (!g_hist_timer) {
         LOGE("HealthHist", "Failed to create history timer");
-        hist_free(g_hist_samples);
-        g_hist_samples = nullptr;
-        g_hist_capacity = 0;
+        g_hist.release();
         return;
     }
 
@@ -142,9 +239,7 @@ void health_history_start() {
         LOGE("HealthHist", "Failed to start history timer");
         xTimerDelete(g_hist_timer, 0);
         g_hist_timer = nullptr;
-        hist_free(g_hist_samples);
-        g_hist_samples = nullptr;
-        g_hist_capacity = 0;
+        g_hist.release();
         return;
     }
 
@@ -152,14 +247,14 @@ void health_history_start() {
     hist_timer_cb(nullptr);
 
     LOGI("HealthHist", "Enabled: %u samples @ %u ms (~%u bytes)",
-        (unsigned)g_hist_capacity,
+        (unsigned)g_hist.capacity(),
         (unsigned)HEALTH_HISTORY_PERIOD_MS,
-        (unsigned)bytes
+        (unsigned)g_hist.bytes()
     );
 }
 
 bool health_history_available() {
-    return (g_hist_timer != nullptr) && (g_hist_samples != nullptr) && (g_hist_capacity > 0);
+    return (g_hist_timer != nullptr) && g_hist.ready();
 }
 
 HealthHistoryParams health_history_params() {
@@ -167,42 +262,58 @@ HealthHistoryParams health_history_params() {
     if (!health_history_available()) return p;
     p.period_ms = (uint32_t)HEALTH_HISTORY_PERIOD_MS;
     p.seconds = (uint32_t)HEALTH_HISTORY_SECONDS;
-    p.samples = (uint32_t)g_hist_capacity;
+    p.samples = (uint32_t)g_hist.capacity();
     return p;
 }
 
 size_t health_history_count() {
-    portENTER_CRITICAL(&g_hist_mux);
-    const size_t c = g_hist_count;
-    portEXIT_CRITICAL(&g_hist_mux);
-    return c;
+    return g_hist.count();
 }
 
 size_t health_history_capacity() {
-    return g_hist_capacity;
+    return g_hist.capacity();
+}
+
+static void unpack_sample(const PackedHealthSample& p, uint32_t newest_ms, HealthHistorySample* out_sample) {
+    // Seconds back from the newest sample (mod 2^16), then back to millis() at the
+    // start of the stored second (independent of the newest sample's sub-second part).
+    const uint16_t age_s = (uint16_t)((uint16_t)(newest_ms / 1000U) - p.uptime_s);
+    out_sample->uptime_ms = (newest_ms - newest_ms % 1000U) - (uint32_t)age_s * 1000U;
+    out_sample->cpu_usage = p.cpu_usage;
+    unpack_metric(p, 0, &out_sample->heap_internal_free,
+                  &out_sample->heap_internal_free_min_window, &out_sample->heap_internal_free_max_window);
+    unpack_metric(p, 1, &out_sample->psram_free,
+                  &out_sample->psram_free_min_window, &out_sample->psram_free_max_window);
+    unpack_metric(p, 2, &out_sample->heap_internal_largest,
+                  &out_sample->heap_internal_largest_min_window, &out_sample->heap_internal_largest_max_window);
 }
 
 bool health_history_get_sample(size_t index, HealthHistorySample* out_sample) {
     if (!out_sample) return false;
     if (!health_history_available()) return false;
 
-    portENTER_CRITICAL(&g_hist_mux);
-    const size_t c = g_hist_count;
-    const size_t cap = g_hist_capacity;
-    const size_t head = g_hist_head;
-    if (index >= c || cap == 0) {
-        portEXIT_CRITICAL(&g_hist_mux);
-        return false;
-    }
+    PackedHealthSample p;
+    if (!g_hist.get(index, &p)) return false;
+    const uint32_t newest_ms = g_newest_uptime_ms;  // never older than p (set before push)
+    unpack_sample(p, newest_ms, out_sample);
+    return true;
+}
 
-    // Oldest sample index in the ring.
-    const size_t oldest = (head + cap - c) % cap;
-    const size_t pos = (oldest + index) % cap;
-    *out_sample = g_hist_samples[pos];
+#if HEALTH_HISTORY_RTC_SAMPLES > 0
+size_t health_history_previous_count() {
+    return g_prev_count;
+}
 
-    portEXIT_CRITICAL(&g_hist_mux);
+bool health_history_get_previous_sample(size_t index, HealthHistorySample* out_sample) {
+    if (!out_sample || index >= g_prev_count) return false;
+    unpack_sample(g_prev[index], g_prev_newest_ms, out_sample);
     return true;
 }
+#else
+size_t health_history_previous_count() { return 0; }
+
+bool health_history_get_previous_sample(size_t, HealthHistorySample*) { return false; }
+#endif
 
 #else
 
@@ -221,4 +332,8 @@ size_t health_history_capacity() { return 0; }
 
 bool health_history_get_sample(size_t, HealthHistorySample*) { return false; }
 
+size_t health_history_previous_count() { return 0; }
+
+bool health_history_get_previous_sample(size_t, HealthHistorySample*) { return false; }
+
 #endif
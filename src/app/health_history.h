@@ -4,7 +4,9 @@
 #include <stdint.h>
 
 // Device-side health history ring buffer used by /api/health/history.
-// Enabled via HEALTH_HISTORY_ENABLED.
+// Enabled via HEALTH_HISTORY_ENABLED. Samples are stored packed (16 bytes) and
+// expanded on read: memory values come back with 256-byte resolution, uptime_ms
+// with whole seconds (stable across reads, so it can serve as a cursor).
 
 struct HealthHistoryParams {
     uint32_t period_ms;
@@ -47,3 +49,9 @@ size_t health_history_capacity();
 
 // Copy the i-th oldest sample (0..count-1). Returns false if out of range/unavailable.
 bool health_history_get_sample(size_t index, HealthHistorySample* out_sample);
+
+// Samples of the previous boot, restored from RTC slow memory by health_history_start()
+// (HEALTH_HISTORY_RTC_SAMPLES). The newest ones mirror the last seconds before the
+// reset; uptime_ms is the previous boot's millis(). Empty after a power-on reset.
+size_t health_history_previous_count();
+bool health_history_get_previous_sample(size_t index, HealthHistorySample* out_sample);
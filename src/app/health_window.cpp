@@ -0,0 +1,89 @@
+#include "health_window.h"
+
+int health_window_fragmentation_percent(size_t free_bytes, size_t largest_bytes) {
+    if (free_bytes == 0) return 0;
+    if (largest_bytes > free_bytes) return 0;
+    float frag = (1.0f - ((float)largest_bytes / (float)free_bytes)) * 100.0f;
+    if (frag < 0) frag = 0;
+    if (frag > 100) frag = 100;
+    return (int)frag;
+}
+
+static void health_window_fold(HealthWindowStats* into, const HealthWindowStats& w) {
+    if (w.internal_free_min < into->internal_free_min) into->internal_free_min = w.internal_free_min;
+    if (w.internal_free_max > into->internal_free_max) into->internal_free_max = w.internal_free_max;
+    if (w.internal_largest_min < into->internal_largest_min) into->internal_largest_min = w.internal_largest_min;
+    if (w.internal_largest_max > into->internal_largest_max) into->internal_largest_max = w.internal_largest_max;
+    if (w.internal_frag_max > into->internal_frag_max) into->internal_frag_max = w.internal_frag_max;
+
+    if (w.psram_free_min < into->psram_free_min) into->psram_free_min = w.psram_free_min;
+    if (w.psram_free_max > into->psram_free_max) into->psram_free_max = w.psram_free_max;
+    if (w.psram_largest_min < into->psram_largest_min) into->psram_largest_min = w.psram_largest_min;
+    if (w.psram_frag_max > into->psram_frag_max) into->psram_frag_max = w.psram_frag_max;
+}
+
+void health_window_state_reset(HealthWindowState* state, uint32_t now_ms) {
+    *state = {};
+    state->current_start_ms = now_ms;
+}
+
+HealthWindowComputed health_window_apply_sample(HealthWindowState* state, uint32_t now_ms, uint32_t period_ms,
+                                                size_t internal_free, size_t internal_largest,
+                                                size_t psram_free, size_t psram_largest) {
+    const int internal_frag = health_window_fragmentation_percent(internal_free, internal_largest);
+    const int psram_frag = health_window_fragmentation_percent(psram_free, psram_largest);
+
+    if (state->current_start_ms == 0) {
+        state->current_start_ms = now_ms;
+    }
+
+    // Time-based rollover (shared across all clients).
+    // Roll over BEFORE applying the sample so the boundary sample belongs to the new window.
+    if ((uint32_t)(now_ms - state->current_start_ms) >= period_ms) {
+        if (state->current.initialized) {
+            state->last = state->current;
+            state->last_valid = true;
+        }
+
+        state->current = {};
+        state->current_start_ms = now_ms;
+    }
+
+    HealthWindowStats sample = {};
+    sample.initialized = true;
+    sample.internal_free_min = internal_free;
+    sample.internal_free_max = internal_free;
+    sample.internal_largest_min = internal_largest;
+    sample.internal_largest_max = internal_largest;
+    sample.internal_frag_max = internal_frag;
+    sample.psram_free_min = psram_free;
+    sample.psram_free_max = psram_free;
+    sample.psram_largest_min = psram_largest;
+    sample.psram_frag_max = psram_frag;
+
+    if (!state->current.initialized) {
+        state->current = sample;
+    } else {
+        health_window_fold(&state->current, sample);
+    }
+
+    // Merge last-complete and current-in-progress windows.
+    // This is conservative (can be slightly wider than a strict "last N seconds" window),
+    // but avoids missing spikes without extra RAM.
+    HealthWindowStats merged = state->current;
+    if (state->last_valid && state->last.initialized) {
+        health_window_fold(&merged, state->last);
+    }
+
+    HealthWindowComputed bands = {};
+    bands.heap_internal_free_min_window = (uint32_t)merged.internal_free_min;
+    bands.heap_internal_free_max_window = (uint32_t)merged.internal_free_max;
+    bands.heap_internal_largest_min_window = (uint32_t)merged.internal_largest_min;
+    bands.heap_internal_largest_max_window = (uint32_t)merged.internal_largest_max;
+    bands.heap_fragmentation_max_window = merged.internal_frag_max;
+    bands.psram_free_min_window = (uint32_t)merged.psram_free_min;
+    bands.psram_free_max_window = (uint32_t)merged.psram_free_max;
+    bands.psram_largest_min_window = (uint32_t)merged.psram_largest_min;
+    bands.psram_fragmentation_max_window = merged.psram_frag_max;
+    return bands;
+}
@@ -0,0 +1,62 @@
+#ifndef HEALTH_WINDOW_H
+#define HEALTH_WINDOW_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+// Min/max heap bands behind the /api/health *_window fields.
+//
+// Pure arithmetic (no heap scans, clocks or locks): the caller passes one memory
+// sample and the current time, and gets the merged bands of the last complete
+// window and the one in progress. device_telemetry owns the state, samples it
+// from its timer task and publishes the result to readers.
+
+struct HealthWindowStats {
+    bool initialized;
+
+    size_t internal_free_min;
+    size_t internal_free_max;
+    size_t internal_largest_min;
+    size_t internal_largest_max;
+    int internal_frag_max;
+
+    size_t psram_free_min;
+    size_t psram_free_max;
+    size_t psram_largest_min;
+    int psram_frag_max;
+};
+
+struct HealthWindowComputed {
+    uint32_t heap_internal_free_min_window;
+    uint32_t heap_internal_free_max_window;
+
+    uint32_t heap_internal_largest_min_window;
+    uint32_t heap_internal_largest_max_window;
+    int heap_fragmentation_max_window;
+
+    uint32_t psram_free_min_window;
+    uint32_t psram_free_max_window;
+    uint32_t psram_largest_min_window;
+    int psram_fragmentation_max_window;
+};
+
+struct HealthWindowState {
+    HealthWindowStats current;
+    HealthWindowStats last;
+    bool last_valid;
+    uint32_t current_start_ms;    // 0 = start the first window on the next sample
+};
+
+// Fragmentation in percent (0..100): share of free bytes outside the largest block.
+int health_window_fragmentation_percent(size_t free_bytes, size_t largest_bytes);
+
+// Drop both windows; the next one starts at now_ms.
+void health_window_state_reset(HealthWindowState* state, uint32_t now_ms);
+
+// Fold one sample into the current window, rolling it over once period_ms have
+// passed, and return the merged last + current bands.
+HealthWindowComputed health_window_apply_sample(HealthWindowState* state, uint32_t now_ms, uint32_t period_ms,
+                                                size_t internal_free, size_t internal_largest,
+                                                size_t psram_free, size_t psram_largest);
+
+#endif // HEALTH_WINDOW_H
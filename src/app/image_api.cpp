@@ -6,13 +6,23 @@
  */
 
 #include "board_config.h"
+#include "board_profile.h"
 
 #if HAS_IMAGE_API
 
 #include "image_api.h"
 #include "jpeg_preflight.h"
+#include "rgb565_codec.h"
+#include "app_alloc.h"
+#include "image_arena.h"
+#include "image_http_pool.h"
+#include "decode_slice.h"
+#include "strip_decoder.h"
 #include "log_manager.h"
 #include "device_telemetry.h"
+#if IMAGE_URL_CACHE_ENABLED
+#include "image_cache.h"
+#endif
 
 #if HAS_DISPLAY
 #include "display_manager.h"
@@ -22,37 +32,41 @@
 #include <ESPAsyncWebServer.h>
 #include <WiFi.h>
 #include <WiFiClient.h>
-#include <WiFiClientSecure.h>
 #include <ArduinoJson.h>
 #include <string.h>
 
 #include <freertos/FreeRTOS.h>
 #include <freertos/portmacro.h>
+#if IMAGE_UPLOAD_STREAMING
+#include <freertos/stream_buffer.h>
+#include <freertos/semphr.h>
+#include "task_placement.h"
+#include <atomic>
+#include <memory>
+#endif
 
 #include "lvgl_jpeg_decoder.h"
+#include "lvgl_image_cache.h"
 
 #include <esp_heap_caps.h>
+#include <esp_timer.h>
 #include <soc/soc_caps.h>
 
 static void* image_api_alloc(size_t size) {
     if (size == 0) return nullptr;
 
-#if SOC_SPIRAM_SUPPORTED
-    // Prefer PSRAM to reduce internal heap pressure when available.
-    void* p = heap_caps_malloc(size, MALLOC_CAP_SPIRAM);
-    if (p) return p;
-#endif
+    // Boot-time arena first so long-running devices don't fragment the heap.
+    void* a = image_arena_alloc(size);
+    if (a) return a;
 
-    // Fallback: any 8-bit heap.
-    // On some no-PSRAM boards, using INTERNAL|8BIT can exclude viable 8-bit regions.
-    // Using 8BIT matches ESP.getFreeHeap() behavior and can reduce pressure on the
-    // internal heap reserved for decode-time allocations.
-    return heap_caps_malloc(size, MALLOC_CAP_8BIT);
+    // Fallback: PSRAM, then any 8-bit heap (accounted as AllocTag::Image).
+    // On some no-PSRAM boards, using INTERNAL|8BIT can exclude viable 8-bit regions;
+    // the Any8bit chain ends on plain 8BIT, matching ESP.getFreeHeap() behavior.
+    return app_alloc(AllocTag::Image, size, AllocPolicy::Any8bit);
 }
 
 static void image_api_free(void* p) {
-    if (!p) return;
-    heap_caps_free(p);
+    image_arena_free(p);
 }
 
 static size_t image_api_no_psram_effective_headroom_bytes(size_t base_headroom, size_t free_heap, size_t largest_block) {
@@ -88,7 +102,7 @@ static size_t image_api_no_psram_effective_headroom_bytes(size_t base_headroom,
 // ===== Internal state =====
 
 static ImageApiConfig g_cfg;
-static ImageApiBackend g_backend = {nullptr, nullptr, nullptr};
+static ImageApiBackend g_backend = {nullptr, nullptr, nullptr, nullptr, nullptr, nullptr};
 static bool (*g_auth_gate)(AsyncWebServerRequest* request) = nullptr;
 
 // Image upload buffer (allocated temporarily during upload)
@@ -104,6 +118,7 @@ enum UploadState {
 };
 static volatile UploadState upload_state = UPLOAD_IDLE;
 static volatile unsigned long pending_op_id = 0;  // Incremented when new op is queued
+static volatile uint32_t client_op_seq = 0;       // Incremented per client request (see image_api_op_seq)
 
 // Pending image display operation (processed by main loop)
 struct PendingImageOp {
@@ -129,8 +144,75 @@ struct PendingStripOp {
     int total_strips;
     unsigned long timeout_ms;
     unsigned long start_time;
+    ImageStripFormat format;
+    int rows;  // RGB565 formats only (JPEG strips carry their own height)
+    bool region;  // sub-rect patch of the shown image (/api/display/image/region)
+    int x;
+    int y;
 };
-static PendingStripOp pending_strip_op = {nullptr, 0, 0, 0, 0, 0, 10000, 0};
+
+// Received strips waiting for decode. The AsyncTCP task pushes at the tail while the
+// main loop decodes the head in place, so strip N+1 can arrive while strip N decodes.
+// A full queue answers 409 and the client retries (HTTP backpressure).
+static_assert(IMAGE_STRIP_QUEUE_DEPTH >= 1, "IMAGE_STRIP_QUEUE_DEPTH must be >= 1");
+static PendingStripOp strip_queue[IMAGE_STRIP_QUEUE_DEPTH] = {};
+static size_t strip_queue_head = 0;
+static size_t strip_queue_count = 0;
+static portMUX_TYPE strip_queue_mux = portMUX_INITIALIZER_UNLOCKED;
+
+static size_t strip_queue_depth() {
+    portENTER_CRITICAL(&strip_queue_mux);
+    const size_t n = strip_queue_count;
+    portEXIT_CRITICAL(&strip_queue_mux);
+    return n;
+}
+
+static bool strip_queue_push(const PendingStripOp& op) {
+    bool ok = false;
+    portENTER_CRITICAL(&strip_queue_mux);
+    if (strip_queue_count < IMAGE_STRIP_QUEUE_DEPTH) {
+        strip_queue[(strip_queue_head + strip_queue_count) % IMAGE_STRIP_QUEUE_DEPTH] = op;
+        strip_queue_count++;
+        ok = true;
+    }
+    portEXIT_CRITICAL(&strip_queue_mux);
+    return ok;
+}
+
+// Copies entry `pos` (0 = oldest); the slot stays occupied until strip_queue_pop().
+static bool strip_queue_peek(PendingStripOp* out, size_t pos = 0) {
+    bool ok = false;
+    portENTER_CRITICAL(&strip_queue_mux);
+    if (strip_queue_count > pos) {
+        *out = strip_queue[(strip_queue_head + pos) % IMAGE_STRIP_QUEUE_DEPTH];
+        ok = true;
+    }
+    portEXIT_CRITICAL(&strip_queue_mux);
+    return ok;
+}
+
+// Releases the oldest slot and returns its buffer for the caller to free.
+static uint8_t* strip_queue_pop() {
+    uint8_t* buf = nullptr;
+    portENTER_CRITICAL(&strip_queue_mux);
+    if (strip_queue_count > 0) {
+        buf = strip_queue[strip_queue_head].buffer;
+        strip_queue[strip_queue_head].buffer = nullptr;
+        strip_queue_head = (strip_queue_head + 1) % IMAGE_STRIP_QUEUE_DEPTH;
+        strip_queue_count--;
+    }
+    portEXIT_CRITICAL(&strip_queue_mux);
+    return buf;
+}
+
+static void strip_queue_clear() {
+    while (strip_queue_depth() > 0) {
+        uint8_t* buf = strip_queue_pop();
+        if (buf) {
+            image_api_free((void*)buf);
+        }
+    }
+}
 
 // URL download state (queued by HTTP handler, executed in main loop)
 static constexpr size_t IMAGE_API_URL_MAX_LEN = 256;
@@ -138,13 +220,84 @@ struct PendingUrlOp {
     bool active;
     char url[IMAGE_API_URL_MAX_LEN];
     unsigned long timeout_ms;
+    bool cache;  // allow the FFat cache (IMAGE_URL_CACHE_ENABLED)
 };
-static PendingUrlOp pending_url_op = {false, {0}, 0};
+static PendingUrlOp pending_url_op = {false, {0}, 0, true};
 
 // AsyncWebServer handlers run on the AsyncTCP task; the main loop consumes this op.
 // Protect cross-task publication/consumption so we don't read stale url/timeout_ms.
 static portMUX_TYPE pending_url_op_mux = portMUX_INITIALIZER_UNLOCKED;
 
+// Timing of the newest client upload (full image or strip sequence), for throughput
+// benchmarks (GET /api/display/image/timing). Receive marks come from the AsyncTCP
+// task, decode marks from the main loop. URL/MJPEG/slideshow images are not tracked.
+struct ImageUploadTiming {
+    uint32_t seq;             // bumped when an upload starts
+    bool active;              // started and not complete
+    bool strips;
+    bool ok;
+    uint16_t strip_count;
+    uint16_t strips_received;
+    uint16_t strips_decoded;
+    uint32_t bytes;
+    int64_t start_us;         // first byte of the upload
+    uint32_t receive_us;      // first byte -> last byte queued
+    uint32_t decode_us;       // sum of decode calls (excludes waiting in the queue)
+    uint32_t decode_max_us;   // slowest single decode call
+    uint32_t total_us;        // first byte -> last strip on the panel
+};
+static ImageUploadTiming upload_timing = {};
+static portMUX_TYPE upload_timing_mux = portMUX_INITIALIZER_UNLOCKED;
+
+static void timing_begin(bool strips, int strip_count) {
+    const int64_t now = esp_timer_get_time();
+    portENTER_CRITICAL(&upload_timing_mux);
+    const uint32_t seq = upload_timing.seq + 1;
+    upload_timing = {};
+    upload_timing.seq = seq;
+    upload_timing.active = true;
+    upload_timing.strips = strips;
+    upload_timing.ok = true;
+    upload_timing.strip_count = (uint16_t)strip_count;
+    upload_timing.start_us = now;
+    portEXIT_CRITICAL(&upload_timing_mux);
+}
+
+static void timing_received(size_t bytes) {
+    const int64_t now = esp_timer_get_time();
+    portENTER_CRITICAL(&upload_timing_mux);
+    if (upload_timing.active) {
+        upload_timing.bytes += (uint32_t)bytes;
+        upload_timing.strips_received++;
+        upload_timing.receive_us = (uint32_t)(now - upload_timing.start_us);
+    }
+    portEXIT_CRITICAL(&upload_timing_mux);
+}
+
+// `strips` strips took `us` in one decode call; `last` = the image is finished.
+static void timing_decoded(int strips, uint32_t us, bool ok, bool last) {
+    const int64_t now = esp_timer_get_time();
+    portENTER_CRITICAL(&upload_timing_mux);
+    if (upload_timing.active) {
+        upload_timing.strips_decoded = (uint16_t)(upload_timing.strips_decoded + strips);
+        upload_timing.decode_us += us;
+        if (us > upload_timing.decode_max_us) upload_timing.decode_max_us = us;
+        if (!ok) upload_timing.ok = false;
+        if (last || !ok) {
+            upload_timing.total_us = (uint32_t)(now - upload_timing.start_us);
+            upload_timing.active = false;
+        }
+    }
+    portEXIT_CRITICAL(&upload_timing_mux);
+}
+
+static ImageUploadTiming timing_snapshot() {
+    portENTER_CRITICAL(&upload_timing_mux);
+    const ImageUploadTiming t = upload_timing;
+    portEXIT_CRITICAL(&upload_timing_mux);
+    return t;
+}
+
 // Small body buffer for /api/display/image_url to avoid heap allocation.
 // AsyncWebServer body callbacks can be interrupted by client disconnects; keeping this static
 // prevents leaks. We also add a timeout so a stalled upload doesn't block future requests.
@@ -157,11 +310,22 @@ static char image_url_body_buf[IMAGE_URL_BODY_MAX_SIZE + 1];
 // Track partial uploads so we can reclaim memory if the client disconnects mid-transfer.
 static unsigned long image_upload_start_ms = 0;
 static unsigned long strip_upload_last_activity_ms = 0;
+// A multi-strip image is between strips; region patches would break its row cursor.
+static volatile bool strip_image_open = false;
+// Header of the first JPEG strip of the current image; later strips that share its
+// tables skip the marker walk. Only touched from the strip handler (AsyncTCP task).
+static JpegHeaderInfo strip_session_header;
+static bool strip_session_header_valid = false;
 
 static bool is_jpeg_magic(const uint8_t* buf, size_t sz) {
     return (buf && sz >= 3 && buf[0] == 0xFF && buf[1] == 0xD8 && buf[2] == 0xFF);
 }
 
+// True while a strip image is being received or still has strips waiting for decode.
+static bool strip_pipeline_busy() {
+    return current_strip_buffer != nullptr || strip_queue_depth() > 0;
+}
+
 static unsigned long parse_timeout_ms(AsyncWebServerRequest* request) {
     // Parse optional timeout parameter from query string (e.g., ?timeout=30)
     unsigned long timeout_seconds = g_cfg.default_timeout_ms / 1000;
@@ -275,17 +439,58 @@ static bool parse_http_or_https_url(
     return true;
 }
 
-static bool download_jpeg_to_buffer(
+// One HTTP(S) GET for an image. Owns the client so the body can either be read into
+// a buffer (download_jpeg_to_buffer) or pulled incrementally by the decoder.
+// The client comes from the keep-alive pool and goes back to it on destruction;
+// set body_done once the response has been fully read so it can be kept.
+struct HttpImageConn {
+    Client* client = nullptr;
+    size_t content_length = 0;   // 0 = unknown (read until the server closes)
+    bool keep_alive = false;     // server allows reuse and the body is length-delimited
+    bool body_done = false;
+    unsigned long start_ms = 0;
+    unsigned long timeout_ms = 0;
+
+    // Cache validators from the response, and whether a conditional GET got a 304.
+    char etag[IMAGE_API_VALIDATOR_MAX] = {0};
+    char last_modified[IMAGE_API_VALIDATOR_MAX] = {0};
+    char content_type[IMAGE_API_VALIDATOR_MAX] = {0};
+    bool not_modified = false;
+
+    // Why a failed open failed: `status` of the response (0 = none), and whether the
+    // origin was never reached (offline, DNS/connect failure, timeout before a status).
+    int status = 0;
+    bool unreachable = false;
+
+    HttpImageConn() = default;
+    HttpImageConn(const HttpImageConn&) = delete;
+    HttpImageConn& operator=(const HttpImageConn&) = delete;
+    ~HttpImageConn() {
+        image_http_pool_release(client, keep_alive && body_done);
+    }
+
+    // Note: `millis()` wraps; use wrap-safe elapsed checks.
+    bool timed_out() const {
+        return (unsigned long)(millis() - start_ms) >= timeout_ms;
+    }
+};
+
+// Connect, send the GET and consume status + headers. On success the client is
+// positioned at the first body byte. require_length: reject responses without a
+// Content-Length or larger than max_image_size_bytes (buffered mode).
+// if_none_match / if_modified_since (optional) make it a conditional GET; a 304
+// then also succeeds with conn->not_modified set and no body.
+static bool http_image_open(
     const char* url,
     unsigned long timeout_ms,
-    uint8_t** out_buf,
-    size_t* out_sz,
+    bool require_length,
+    HttpImageConn* conn,
     char* err,
-    size_t err_len
+    size_t err_len,
+    const char* if_none_match = nullptr,
+    const char* if_modified_since = nullptr
 ) {
-    if (!out_buf || !out_sz) return false;
-    *out_buf = nullptr;
-    *out_sz = 0;
+    if (!conn) return false;
 
     if (!url || strlen(url) == 0) {
         snprintf(err, err_len, "Missing URL");
@@ -294,6 +499,7 @@ static bool download_jpeg_to_buffer(
 
     if (WiFi.status() != WL_CONNECTED) {
         snprintf(err, err_len, "WiFi not connected");
+        conn->unreachable = true;
         return false;
     }
 
@@ -308,9 +514,14 @@ static bool download_jpeg_to_buffer(
 
     // Keep a decode headroom guard on PSRAM boards (TLS + decode need internal heap).
 #if SOC_SPIRAM_SUPPORTED
-    if (psramFound()) {
+    if (board_psram_available()) {
         if (scheme == URL_SCHEME_HTTPS) {
-            const size_t internal_free = heap_caps_get_free_size(MALLOC_CAP_INTERNAL | MALLOC_CAP_8BIT);
+            size_t internal_free = heap_caps_get_free_size(MALLOC_CAP_INTERNAL | MALLOC_CAP_8BIT);
+            if (internal_free < g_cfg.decode_headroom_bytes) {
+                // Parked TLS sessions are the first thing to give back.
+                image_http_pool_close_idle();
+                internal_free = heap_caps_get_free_size(MALLOC_CAP_INTERNAL | MALLOC_CAP_8BIT);
+            }
             if (internal_free < g_cfg.decode_headroom_bytes) {
                 snprintf(err, err_len, "Insufficient internal heap for TLS/decode headroom");
                 return false;
@@ -320,20 +531,14 @@ static bool download_jpeg_to_buffer(
 #endif
 
     // Conservative per-operation timeout.
-    // Note: `millis()` wraps; use wrap-safe elapsed checks.
-    const unsigned long start_ms = millis();
-    unsigned long effective_timeout_ms = timeout_ms;
-    if (effective_timeout_ms == 0) effective_timeout_ms = 15000UL;
+    conn->start_ms = millis();
+    conn->timeout_ms = timeout_ms;
+    if (conn->timeout_ms == 0) conn->timeout_ms = 15000UL;
     // Clamp to avoid stalling the main loop for too long.
-    if (effective_timeout_ms > 30000UL) effective_timeout_ms = 30000UL;
+    if (conn->timeout_ms > 30000UL) conn->timeout_ms = 30000UL;
 
-    const auto timed_out = [&]() -> bool {
-        return (unsigned long)(millis() - start_ms) >= effective_timeout_ms;
-    };
+    const auto timed_out = [&]() -> bool { return conn->timed_out(); };
 
-    WiFiClientSecure client_tls;
-    WiFiClient client_plain;
-    Client* client = nullptr;
     if (scheme == URL_SCHEME_HTTPS) {
         // SECURITY NOTE:
         // We intentionally use insecure TLS mode for now (no certificate validation)
@@ -347,131 +552,311 @@ static bool download_jpeg_to_buffer(
                 "HTTPS image_url uses insecure TLS (no certificate validation). A MITM can spoof content. Use only on trusted networks, or implement CA verification/pinning."
             );
         }
-        client_tls.setInsecure();
-        client = &client_tls;
-    } else {
-        client = &client_plain;
     }
 
-    if (!client->connect(host, port)) {
-        snprintf(err, err_len, "%s connect failed", scheme == URL_SCHEME_HTTPS ? "TLS" : "TCP");
-        return false;
-    }
+    // A parked keep-alive connection may have been closed by the server since the last
+    // request; that only shows up once we try it, so a reused one gets one fresh retry.
+    for (int attempt = 0; attempt < 2; attempt++) {
+        bool reused = false;
+        conn->client = image_http_pool_acquire(scheme == URL_SCHEME_HTTPS, host, port, &reused);
+        if (!conn->client) {
+            snprintf(err, err_len, "%s connect failed", scheme == URL_SCHEME_HTTPS ? "TLS" : "TCP");
+            conn->unreachable = true;
+            return false;
+        }
+        Client* client = conn->client;
+        conn->keep_alive = false;
+        conn->etag[0] = '\0';
+        conn->last_modified[0] = '\0';
+        conn->content_type[0] = '\0';
+
+        client->printf("GET %s HTTP/1.1\r\n", path);
+        client->printf("Host: %s\r\n", host);
+        client->print("User-Agent: esp32-template-image-api/1.0\r\n");
+        client->print("Accept: image/jpeg, */*\r\n");
+        const bool conditional = (if_none_match && *if_none_match) || (if_modified_since && *if_modified_since);
+        if (if_none_match && *if_none_match) {
+            client->printf("If-None-Match: %s\r\n", if_none_match);
+        }
+        if (if_modified_since && *if_modified_since) {
+            client->printf("If-Modified-Since: %s\r\n", if_modified_since);
+        }
+        client->print(IMAGE_HTTP_POOL_SIZE > 0 ? "Connection: keep-alive\r\n\r\n" : "Connection: close\r\n\r\n");
+
+        // Read status + headers line-by-line to reduce stack usage.
+        // (Avoids buffering the entire header block.)
+        auto read_http_line = [&](char* out, size_t out_len) -> bool {
+            if (!out || out_len == 0) return false;
+            size_t n = 0;
+            while (!timed_out()) {
+                int b = client->read();
+                if (b < 0) {
+                    if (!client->connected()) {
+                        snprintf(err, err_len, "Connection closed by server");
+                        return false;
+                    }
+                    yield();
+                    continue;
+                }
 
-    client->printf("GET %s HTTP/1.1\r\n", path);
-    client->printf("Host: %s\r\n", host);
-    client->print("User-Agent: esp32-template-image-api/1.0\r\n");
-    client->print("Accept: image/jpeg, */*\r\n");
-    client->print("Connection: close\r\n\r\n");
-
-    // Read status + headers line-by-line to reduce stack usage.
-    // (Avoids buffering the entire header block.)
-    auto read_http_line = [&](char* out, size_t out_len) -> bool {
-        if (!out || out_len == 0) return false;
-        size_t n = 0;
-        while (!timed_out()) {
-            int b = client->read();
-            if (b < 0) {
-                yield();
-                continue;
+                if (b == '\r') {
+                    continue;
+                }
+
+                if (b == '\n') {
+                    out[n] = '\0';
+                    return true;
+                }
+
+                if (n + 1 >= out_len) {
+                    snprintf(err, err_len, "HTTP header line too long");
+                    return false;
+                }
+
+                out[n++] = (char)b;
             }
 
-            if (b == '\r') {
+            snprintf(err, err_len, "Timeout waiting for headers");
+            return false;
+        };
+
+        char line[256];
+        int status = 0;
+        line[0] = '\0';
+        const bool got_status = read_http_line(line, sizeof(line));
+        if (!got_status || line[0] == '\0') {
+            image_http_pool_release(client, false);
+            conn->client = nullptr;
+            if (reused && !timed_out()) {
+                LOGD("ImageApi", "Kept-alive connection went stale; reconnecting");
                 continue;
             }
-
-            if (b == '\n') {
-                out[n] = '\0';
-                return true;
+            if (got_status) snprintf(err, err_len, "Invalid HTTP response");
+            conn->unreachable = !got_status;  // timeout or closed before any response
+            return false;
+        }
+        // Example: HTTP/1.1 200 OK
+        if (sscanf(line, "HTTP/%*s %d", &status) != 1) {
+            snprintf(err, err_len, "Failed to parse HTTP status");
+            return false;
+        }
+        conn->status = status;
+        // HTTP/1.1 defaults to persistent connections; 1.0 only with an explicit keep-alive.
+        bool server_keep_alive = !starts_with_ignore_case(line, "HTTP/1.0");
+
+        bool chunked = false;
+        bool have_length = false;
+        size_t content_length = 0;
+        while (true) {
+            if (!read_http_line(line, sizeof(line))) {
+                return false;
             }
 
-            if (n + 1 >= out_len) {
-                snprintf(err, err_len, "HTTP header line too long");
-                return false;
+            // Empty line = end of headers
+            if (line[0] == '\0') {
+                break;
             }
 
-            out[n++] = (char)b;
+            if (starts_with_ignore_case(line, "Content-Length:")) {
+                const char* v = line + strlen("Content-Length:");
+                while (*v == ' ' || *v == '\t') v++;
+                content_length = (size_t)strtoul(v, nullptr, 10);
+                have_length = true;
+            } else if (starts_with_ignore_case(line, "Connection:")) {
+                const char* v = line + strlen("Connection:");
+                while (*v == ' ' || *v == '\t') v++;
+                if (starts_with_ignore_case(v, "close")) server_keep_alive = false;
+                else if (starts_with_ignore_case(v, "keep-alive")) server_keep_alive = true;
+            } else if (starts_with_ignore_case(line, "Content-Type:")) {
+                const char* v = line + strlen("Content-Type:");
+                while (*v == ' ' || *v == '\t') v++;
+                strlcpy(conn->content_type, v, sizeof(conn->content_type));
+            } else if (starts_with_ignore_case(line, "ETag:")) {
+                const char* v = line + strlen("ETag:");
+                while (*v == ' ' || *v == '\t') v++;
+                strlcpy(conn->etag, v, sizeof(conn->etag));
+            } else if (starts_with_ignore_case(line, "Last-Modified:")) {
+                const char* v = line + strlen("Last-Modified:");
+                while (*v == ' ' || *v == '\t') v++;
+                strlcpy(conn->last_modified, v, sizeof(conn->last_modified));
+            } else if (starts_with_ignore_case(line, "Transfer-Encoding:")) {
+                // If chunked, we bail for now (keeps implementation small + memory-predictable).
+                const char* v = line + strlen("Transfer-Encoding:");
+                while (*v == ' ' || *v == '\t') v++;
+
+                // Parse comma-separated transfer-coding tokens.
+                // We only match a standalone token "chunked" (case-insensitive) to avoid false positives
+                // like "not-chunked".
+                const char* p = v;
+                while (*p && !chunked) {
+                    while (*p == ' ' || *p == '\t' || *p == ',') p++;
+                    if (!*p) break;
+
+                    const char* token_start = p;
+                    while (*p && *p != ',' && *p != ';' && *p != ' ' && *p != '\t') p++;
+                    const size_t len = (size_t)(p - token_start);
+
+                    if (len == 7 && equals_ignore_case_n(token_start, "chunked", 7)) {
+                        chunked = true;
+                        break;
+                    }
+
+                    while (*p && *p != ',') p++;
+                }
+            }
         }
 
-        snprintf(err, err_len, "Timeout waiting for headers");
-        return false;
-    };
-
-    char line[256];
-    int status = 0;
-    if (!read_http_line(line, sizeof(line))) {
-        return false;
-    }
-    if (line[0] == '\0') {
-        snprintf(err, err_len, "Invalid HTTP response");
-        return false;
-    }
-    // Example: HTTP/1.1 200 OK
-    if (sscanf(line, "HTTP/%*s %d", &status) != 1) {
-        snprintf(err, err_len, "Failed to parse HTTP status");
-        return false;
-    }
+        // Only a length-delimited (or body-less) response leaves the socket reusable.
+        conn->keep_alive = server_keep_alive && !chunked && (have_length || status == 304);
 
-    bool chunked = false;
-    size_t content_length = 0;
-    while (true) {
-        if (!read_http_line(line, sizeof(line))) {
+        if (status == 304 && conditional) {
+            conn->not_modified = true;
+            conn->content_length = 0;
+            conn->body_done = true;
+            return true;
+        }
+        if (status != 200) {
+            snprintf(err, err_len, "HTTP status %d", status);
             return false;
         }
-
-        // Empty line = end of headers
-        if (line[0] == '\0') {
-            break;
+        if (chunked) {
+            snprintf(err, err_len, "Chunked transfer unsupported");
+            return false;
+        }
+        if (content_length == 0 && require_length) {
+            snprintf(err, err_len, "Missing Content-Length");
+            return false;
+        }
+        if (require_length && content_length > g_cfg.max_image_size_bytes) {
+            snprintf(err, err_len, "Image too large (%u bytes)", (unsigned)content_length);
+            return false;
         }
 
-        if (starts_with_ignore_case(line, "Content-Length:")) {
-            const char* v = line + strlen("Content-Length:");
-            while (*v == ' ' || *v == '\t') v++;
-            content_length = (size_t)strtoul(v, nullptr, 10);
-        } else if (starts_with_ignore_case(line, "Transfer-Encoding:")) {
-            // If chunked, we bail for now (keeps implementation small + memory-predictable).
-            const char* v = line + strlen("Transfer-Encoding:");
-            while (*v == ' ' || *v == '\t') v++;
+        conn->content_length = content_length;
+        return true;
+    }
 
-            // Parse comma-separated transfer-coding tokens.
-            // We only match a standalone token "chunked" (case-insensitive) to avoid false positives
-            // like "not-chunked".
-            const char* p = v;
-            while (*p && !chunked) {
-                while (*p == ' ' || *p == '\t' || *p == ',') p++;
-                if (!*p) break;
+    return false;
+}
 
-                const char* token_start = p;
-                while (*p && *p != ',' && *p != ';' && *p != ' ' && *p != '\t') p++;
-                const size_t len = (size_t)(p - token_start);
 
-                if (len == 7 && equals_ignore_case_n(token_start, "chunked", 7)) {
-                    chunked = true;
-                    break;
-                }
+// Per-download view of the FFat cache (IMAGE_URL_CACHE_ENABLED): validators of the
+// entry we already hold, plus the writer a 200 response is teed into.
+struct UrlCacheCtx {
+#if IMAGE_URL_CACHE_ENABLED
+    bool enabled = false;
+    bool have_entry = false;
+    ImageCacheValidators validators = {};
+    ImageCacheWriter writer;
+#endif
+};
 
-                while (*p && *p != ',') p++;
-            }
-        }
+#if IMAGE_URL_CACHE_ENABLED
+// Only a transport failure (offline, DNS, connect, timeout) falls back to the cached
+// copy. An HTTP error is the origin's current answer and is reported as such; an
+// entry the origin says is gone (404/410) is dropped.
+static bool cache_fallback_allowed(const HttpImageConn& conn, const char* url, UrlCacheCtx* cache) {
+    if (!cache || !cache->have_entry) return false;
+    if (conn.unreachable) return true;
+    if (conn.status == 404 || conn.status == 410) {
+        image_cache_remove(url);
+        cache->have_entry = false;
     }
+    return false;
+}
 
-    if (status != 200) {
-        snprintf(err, err_len, "HTTP status %d", status);
+static bool read_cached_to_buffer(const char* url, uint8_t** out_buf, size_t* out_sz, char* err, size_t err_len) {
+    File f;
+    if (!image_cache_open(url, &f)) {
+        snprintf(err, err_len, "Cached image unavailable");
         return false;
     }
-    if (chunked) {
-        snprintf(err, err_len, "Chunked transfer unsupported");
+    const size_t sz = f.size();
+    uint8_t* buf = (uint8_t*)image_api_alloc(sz);
+    if (!buf) {
+        f.close();
+        snprintf(err, err_len, "Out of memory allocating %u bytes", (unsigned)sz);
+        return false;
+    }
+    const size_t n = f.read(buf, sz);
+    f.close();
+    if (n != sz || !is_jpeg_magic(buf, sz)) {
+        image_api_free(buf);
+        image_cache_remove(url);
+        snprintf(err, err_len, "Cached image unreadable");
         return false;
     }
-    if (content_length == 0) {
-        snprintf(err, err_len, "Missing Content-Length");
+    image_cache_note_hit();
+    *out_buf = buf;
+    *out_sz = sz;
+    return true;
+}
+#endif
+
+static bool read_body_to_buffer(HttpImageConn* conn, uint8_t** out_buf, size_t* out_sz, char* err, size_t err_len);
+
+static bool download_jpeg_to_buffer(
+    const char* url,
+    unsigned long timeout_ms,
+    UrlCacheCtx* cache,
+    uint8_t** out_buf,
+    size_t* out_sz,
+    char* err,
+    size_t err_len
+) {
+    if (!out_buf || !out_sz) return false;
+    *out_buf = nullptr;
+    *out_sz = 0;
+    (void)cache;
+
+    const char* if_none_match = nullptr;
+    const char* if_modified_since = nullptr;
+    #if IMAGE_URL_CACHE_ENABLED
+    if (cache && cache->have_entry) {
+        if_none_match = cache->validators.etag;
+        if_modified_since = cache->validators.last_modified;
+    }
+    #endif
+
+    HttpImageConn conn;
+    if (!http_image_open(url, timeout_ms, true, &conn, err, err_len, if_none_match, if_modified_since)) {
+        #if IMAGE_URL_CACHE_ENABLED
+        // Offline/unreachable origin: a stale copy beats a blank panel.
+        if (cache_fallback_allowed(conn, url, cache)) {
+            LOGW("ImageApi", "Fetch failed (%s); showing cached copy", err);
+            return read_cached_to_buffer(url, out_buf, out_sz, err, err_len);
+        }
+        #endif
         return false;
     }
-    if (content_length > g_cfg.max_image_size_bytes) {
-        snprintf(err, err_len, "Image too large (%u bytes)", (unsigned)content_length);
+    #if IMAGE_URL_CACHE_ENABLED
+    if (conn.not_modified) {
+        LOGI("ImageApi", "304 Not Modified; decoding cached copy");
+        return read_cached_to_buffer(url, out_buf, out_sz, err, err_len);
+    }
+    #endif
+    if (!read_body_to_buffer(&conn, out_buf, out_sz, err, err_len)) {
         return false;
     }
 
+    #if IMAGE_URL_CACHE_ENABLED
+    if (cache && cache->enabled) {
+        image_cache_note_miss();
+        if (image_cache_writer_begin(&cache->writer, url, conn.etag, conn.last_modified, (uint32_t)*out_sz)) {
+            image_cache_writer_write(&cache->writer, *out_buf, *out_sz);
+            image_cache_writer_commit(&cache->writer);
+        }
+    }
+    #endif
+    return true;
+}
+
+// Read a Content-Length body from an opened connection into a new image buffer.
+static bool read_body_to_buffer(HttpImageConn* conn_ptr, uint8_t** out_buf, size_t* out_sz, char* err, size_t err_len) {
+    HttpImageConn& conn = *conn_ptr;
+    Client* client = conn.client;
+    const size_t content_length = conn.content_length;
+
     uint8_t* buf = (uint8_t*)image_api_alloc(content_length);
     if (!buf) {
         snprintf(err, err_len, "Out of memory allocating %u bytes", (unsigned)content_length);
@@ -479,7 +864,7 @@ static bool download_jpeg_to_buffer(
     }
 
     size_t pos = 0;
-    while (pos < content_length && !timed_out()) {
+    while (pos < content_length && !conn.timed_out()) {
         const int r = client->read(buf + pos, (int)min((size_t)1024, content_length - pos));
         if (r > 0) {
             pos += (size_t)r;
@@ -493,6 +878,7 @@ static bool download_jpeg_to_buffer(
         snprintf(err, err_len, "Incomplete body (%u/%u)", (unsigned)pos, (unsigned)content_length);
         return false;
     }
+    conn.body_done = true;
 
     if (!is_jpeg_magic(buf, content_length)) {
         image_api_free(buf);
@@ -505,89 +891,672 @@ static bool download_jpeg_to_buffer(
     return true;
 }
 
-// ===== Handlers =====
+#if IMAGE_API_URL_STREAMING
+// Streaming source for StripDecoder::decode_stream(): TJpgDec pulls from a small
+// refill buffer that is topped up straight from the HTTP client, so decoding
+// overlaps the transfer and RAM use is IMAGE_API_STREAM_BUFFER_BYTES, not the
+// image size. While waiting on the network the display lock is released so the
+// LVGL task is not stalled by a slow server.
+struct HttpJpegStream {
+    HttpImageConn* conn;
+    uint8_t* buf;
+    size_t cap;
+    size_t pos;
+    size_t len;
+    size_t body_read;     // body bytes taken from the socket so far
+    bool magic_checked;
+    bool failed;
+    char* err;
+    size_t err_len;
+    #if IMAGE_URL_CACHE_ENABLED
+    ImageCacheWriter* cache_writer;  // tee of the body into the FFat cache (may be inactive)
+    #endif
+};
 
-// POST /api/display/image - Upload and display JPEG image (deferred decode)
-static void handleImageUpload(AsyncWebServerRequest *request, String filename, size_t index, uint8_t *data, size_t len, bool final) {
-    if (g_auth_gate && !g_auth_gate(request)) return;
-    (void)filename;
+static bool http_jpeg_stream_refill(HttpJpegStream* s) {
+    Client* client = s->conn->client;
+    const size_t total = s->conn->content_length;
 
-    // First chunk - initialize upload
-    if (index == 0) {
-        // If upload already in progress OR pending display, reject (client can retry)
-        if (upload_state == UPLOAD_IN_PROGRESS || upload_state == UPLOAD_READY_TO_DISPLAY) {
-            request->send(409, "application/json", "{\"success\":false,\"message\":\"Upload busy\"}");
-            return;
+    while (true) {
+        if (total > 0 && s->body_read >= total) return false;  // EOF
+
+        size_t want = s->cap;
+        if (total > 0 && total - s->body_read < want) want = total - s->body_read;
+
+        const int r = client->read(s->buf, (int)want);
+        if (r > 0) {
+            s->pos = 0;
+            s->len = (size_t)r;
+            s->body_read += (size_t)r;
+
+            if (!s->magic_checked) {
+                s->magic_checked = true;
+                if (!is_jpeg_magic(s->buf, s->len)) {
+                    snprintf(s->err, s->err_len, "Downloaded data is not a JPEG");
+                    s->failed = true;
+                    return false;
+                }
+            }
+            #if IMAGE_URL_CACHE_ENABLED
+            if (s->cache_writer && s->cache_writer->active) {
+                // Flash writes can stall for an erase; keep LVGL running meanwhile.
+                #if HAS_DISPLAY
+                display_manager_unlock();
+                #endif
+                image_cache_writer_write(s->cache_writer, s->buf, s->len);
+                #if HAS_DISPLAY
+                display_manager_lock(LvglLockSite::ImageApi);
+                #endif
+            }
+            #endif
+            return true;
         }
 
-        LOGI("Upload", "Start");
-        LOGI("Upload", "Total size: %u bytes", request->contentLength());
+        if (!client->connected() && client->available() <= 0) {
+            if (total > 0) {
+                snprintf(s->err, s->err_len, "Incomplete body (%u/%u)", (unsigned)s->body_read, (unsigned)total);
+                s->failed = true;
+            }
+            return false;  // Unknown length: server close = EOF
+        }
+        if (s->conn->timed_out()) {
+            snprintf(s->err, s->err_len, "Timeout after %u body bytes", (unsigned)s->body_read);
+            s->failed = true;
+            return false;
+        }
 
-        image_upload_timeout_ms = parse_timeout_ms(request);
-        image_upload_start_ms = millis();
-        LOGI("Upload", "Timeout: %lu ms", image_upload_timeout_ms);
+        #if HAS_DISPLAY
+        display_manager_unlock();
+        delay(1);
+        display_manager_lock(LvglLockSite::ImageApi);
+        #else
+        delay(1);
+        #endif
+    }
+}
 
-        device_telemetry_log_memory_snapshot("img pre-clear");
+static size_t http_jpeg_stream_read(void* ctx, uint8_t* dst, size_t len) {
+    HttpJpegStream* s = (HttpJpegStream*)ctx;
+    if (!s || s->failed) return 0;
 
-        // Free any pending image buffer to make room for new upload
-        if (pending_image_op.buffer) {
-            LOGI("Upload", "Freeing pending image buffer");
-            image_api_free((void*)pending_image_op.buffer);
-            pending_image_op.buffer = nullptr;
-            pending_image_op.size = 0;
-        }
+    size_t done = 0;
+    while (done < len) {
+        if (s->pos >= s->len && !http_jpeg_stream_refill(s)) break;
 
-        device_telemetry_log_memory_snapshot("img post-clear");
+        size_t n = s->len - s->pos;
+        if (n > len - done) n = len - done;
+        if (dst) memcpy(dst + done, s->buf + s->pos, n);  // dst == nullptr: skip
+        s->pos += n;
+        done += n;
+    }
+    return done;
+}
 
-        // Check file size
-        size_t total_size = request->contentLength();
-        if (total_size > g_cfg.max_image_size_bytes) {
-            LOGE("Upload", "Image too large");
-            request->send(400, "application/json", "{\"success\":false,\"message\":\"Image too large\"}");
-            return;
+#if IMAGE_URL_CACHE_ENABLED
+// Decode source over a cached body on FFat (dst == nullptr: skip).
+static size_t cache_file_read(void* ctx, uint8_t* dst, size_t len) {
+    File* f = (File*)ctx;
+    if (!dst) {
+        const size_t remaining = (size_t)(f->size() - f->position());
+        const size_t n = len < remaining ? len : remaining;
+        return f->seek(f->position() + n) ? n : 0;
+    }
+    return f->read(dst, len);
+}
+
+static bool decode_cached_to_display(const char* url, unsigned long timeout_ms, char* err, size_t err_len) {
+    File f;
+    if (!image_cache_open(url, &f)) {
+        snprintf(err, err_len, "Cached image unavailable");
+        return false;
+    }
+
+    const unsigned long t0 = millis();
+    bool ok = false;
+    #if HAS_DISPLAY
+    display_manager_lock(LvglLockSite::ImageApi);
+    #endif
+    if (g_backend.start_strip_session(g_cfg.lcd_width, g_cfg.lcd_height, timeout_ms > 0 ? timeout_ms : g_cfg.default_timeout_ms, millis())) {
+        ok = g_backend.decode_stream(cache_file_read, &f, false);
+    }
+    #if HAS_DISPLAY
+    display_manager_unlock();
+    #endif
+    const size_t sz = f.size();
+    f.close();
+
+    if (!ok) {
+        // Corrupt entry: drop it so the next request refetches.
+        image_cache_remove(url);
+        snprintf(err, err_len, "Cached image failed to decode");
+        return false;
+    }
+    image_cache_note_hit();
+    LOGI("ImageApi", "Decoded %u cached bytes in %lums", (unsigned)sz, (unsigned long)(millis() - t0));
+    return true;
+}
+#endif
+
+// Download + decode in one pass via backend.decode_stream. Returns false with err set.
+static bool stream_jpeg_url_to_display(const char* url, unsigned long timeout_ms, UrlCacheCtx* cache, char* err, size_t err_len) {
+    (void)cache;
+    const char* if_none_match = nullptr;
+    const char* if_modified_since = nullptr;
+    #if IMAGE_URL_CACHE_ENABLED
+    if (cache && cache->have_entry) {
+        if_none_match = cache->validators.etag;
+        if_modified_since = cache->validators.last_modified;
+    }
+    #endif
+
+    HttpImageConn conn;
+    if (!http_image_open(url, timeout_ms, false, &conn, err, err_len, if_none_match, if_modified_since)) {
+        #if IMAGE_URL_CACHE_ENABLED
+        // Offline/unreachable origin: a stale copy beats a blank panel.
+        if (cache_fallback_allowed(conn, url, cache)) {
+            LOGW("ImageApi", "Fetch failed (%s); showing cached copy", err);
+            return decode_cached_to_display(url, timeout_ms, err, err_len);
         }
+        #endif
+        return false;
+    }
 
-        // Check memory availability.
-        // - Upload uses a single contiguous buffer.
-        // - The decode pipeline needs headroom (historically expressed via g_cfg.decode_headroom_bytes).
+    #if IMAGE_URL_CACHE_ENABLED
+    if (conn.not_modified) {
+        LOGI("ImageApi", "304 Not Modified; decoding cached copy");
+        return decode_cached_to_display(url, timeout_ms, err, err_len);
+    }
+    if (cache && cache->enabled) {
+        image_cache_note_miss();
+        // Unknown length (close-delimited body) cannot be budgeted; skip caching it.
+        if (conn.content_length > 0) {
+            image_cache_writer_begin(&cache->writer, url, conn.etag, conn.last_modified, (uint32_t)conn.content_length);
+        }
+    }
+    #endif
 
-#if SOC_SPIRAM_SUPPORTED
-        // `SOC_SPIRAM_SUPPORTED` means the SoC can use PSRAM, but some boards have no PSRAM fitted.
-        // Use a runtime check so no-PSRAM boards don't take PSRAM-specific headroom gating.
-        const bool has_psram = psramFound();
-        const size_t psram_free = has_psram ? heap_caps_get_free_size(MALLOC_CAP_SPIRAM) : 0;
-        const size_t psram_largest = has_psram ? heap_caps_get_largest_free_block(MALLOC_CAP_SPIRAM) : 0;
-        const bool psram_can_hold_upload = has_psram && (psram_free >= total_size) && (psram_largest >= total_size);
+    uint8_t* buf = (uint8_t*)image_api_alloc(IMAGE_API_STREAM_BUFFER_BYTES);
+    if (!buf) {
+        #if IMAGE_URL_CACHE_ENABLED
+        if (cache) image_cache_writer_abort(&cache->writer);
+        #endif
+        snprintf(err, err_len, "Out of memory allocating %u bytes", (unsigned)IMAGE_API_STREAM_BUFFER_BYTES);
+        return false;
+    }
+
+    HttpJpegStream stream = {};
+    stream.conn = &conn;
+    stream.buf = buf;
+    stream.cap = IMAGE_API_STREAM_BUFFER_BYTES;
+    stream.err = err;
+    stream.err_len = err_len;
+    #if IMAGE_URL_CACHE_ENABLED
+    stream.cache_writer = cache ? &cache->writer : nullptr;
+    #endif
+    err[0] = '\0';
+
+    const unsigned long t0 = millis();
+    bool ok = false;
+
+    #if HAS_DISPLAY
+    display_manager_lock(LvglLockSite::ImageApi);
+    #endif
+    if (g_backend.start_strip_session(g_cfg.lcd_width, g_cfg.lcd_height, timeout_ms > 0 ? timeout_ms : g_cfg.default_timeout_ms, millis())) {
+        ok = g_backend.decode_stream(http_jpeg_stream_read, &stream, false);
+    } else {
+        snprintf(err, err_len, "Failed to init image display");
+    }
+    // TJpgDec stops at EOI; pull any trailing bytes so the cached copy is complete
+    // and a kept-alive connection starts the next response at its status line.
+    const bool drain_for_cache =
+    #if IMAGE_URL_CACHE_ENABLED
+        stream.cache_writer && stream.cache_writer->active;
+    #else
+        false;
+    #endif
+    if (ok && !stream.failed && (drain_for_cache || (conn.keep_alive && conn.content_length > 0))) {
+        while (http_jpeg_stream_refill(&stream)) {
+        }
+    }
+    conn.body_done = !stream.failed && conn.content_length > 0 && stream.body_read >= conn.content_length;
+    #if HAS_DISPLAY
+    display_manager_unlock();
+    #endif
+
+    image_api_free(buf);
+
+    if (ok && stream.failed) ok = false;
+    #if IMAGE_URL_CACHE_ENABLED
+    if (stream.cache_writer && stream.cache_writer->active) {
+        if (ok) {
+            image_cache_writer_commit(stream.cache_writer);
+        } else {
+            image_cache_writer_abort(stream.cache_writer);
+        }
+    }
+    #endif
+    if (!ok && err[0] == '\0') {
+        snprintf(err, err_len, "Stream decode failed after %u bytes", (unsigned)stream.body_read);
+    }
+    if (ok) {
+        LOGI("ImageApi", "Streamed %u bytes to panel in %lums", (unsigned)stream.body_read, (unsigned long)(millis() - t0));
+    }
+    return ok;
+}
+#endif // IMAGE_API_URL_STREAMING
+
+#if IMAGE_UPLOAD_STREAMING
+// Streaming full-image upload: multipart chunks go from the AsyncTCP handler into a
+// bounded ring (IMAGE_UPLOAD_STREAM_RING_BYTES) that an image_stream task decodes from
+// while the body is still arriving, so no contentLength() buffer is allocated and the
+// decode does not wait for the next loop() pass. The handler never waits on the ring:
+// once less than a TCP receive window is free it withholds the ACKs of what arrives
+// (AsyncClient::ackLater), so the peer's window closes instead. A ring that stays
+// empty for IMAGE_UPLOAD_STREAM_STALL_MS fails the upload. The ring is created on
+// first use and kept for the uptime.
+#ifdef CONFIG_LWIP_TCP_WND_DEFAULT
+static constexpr size_t kUploadStreamTcpWnd = CONFIG_LWIP_TCP_WND_DEFAULT;
 #else
-        const size_t psram_free = 0;
-        const size_t psram_largest = 0;
-        const bool psram_can_hold_upload = false;
+static constexpr size_t kUploadStreamTcpWnd = 5760;
+#endif
+#ifdef CONFIG_LWIP_TCP_MSS
+static constexpr size_t kUploadStreamTcpMss = CONFIG_LWIP_TCP_MSS;
+#else
+static constexpr size_t kUploadStreamTcpMss = 1436;
 #endif
 
-        // PSRAM boards vs no-PSRAM boards behave very differently.
-        // - On PSRAM boards: upload buffer is expected to land in PSRAM; keep an internal headroom guard.
-        // - On no-PSRAM boards: keep the historical "total heap" guard (ESP.getFreeHeap) so we don't
-        //   falsely reject when internal-only metrics look tight but the system can still operate.
-#if SOC_SPIRAM_SUPPORTED
-        if (has_psram) {
-            const size_t internal_free = heap_caps_get_free_size(MALLOC_CAP_INTERNAL | MALLOC_CAP_8BIT);
-            if (internal_free < g_cfg.decode_headroom_bytes) {
-            LOGE(
-                "Upload",
-                "Insufficient internal memory for decode headroom (need %u, have %u)",
-                (unsigned)g_cfg.decode_headroom_bytes,
-                (unsigned)internal_free
-            );
-            device_telemetry_log_memory_snapshot("img insufficient");
-            char error_msg[240];
-            snprintf(
-                error_msg,
-                sizeof(error_msg),
-                "{\"success\":false,\"message\":\"Insufficient internal memory: need %uKB decode headroom, have %uKB.\"}",
-                (unsigned)(g_cfg.decode_headroom_bytes / 1024),
-                (unsigned)(internal_free / 1024)
-            );
-            LOGE("Upload", "Insufficient internal memory");
+enum : uint8_t { kUploadDecoding = 0, kUploadShown = 1, kUploadFailed = 2 };
+
+// Decode result of one streamed upload. Shared with the final response's filler,
+// which may still be waiting for it when the next upload starts.
+struct UploadOutcome {
+    std::atomic<uint8_t> state{kUploadDecoding};
+    unsigned long timeout_ms = 0;
+    uint32_t image_seq = 0;  // written before `state` leaves kUploadDecoding
+};
+
+struct UploadStream {
+    StreamBufferHandle_t ring;
+    StaticStreamBuffer_t ring_struct;
+    uint8_t* ring_storage;
+    AsyncWebServerRequest* owner;  // request feeding the ring (AsyncTCP task only)
+    uint32_t received;             // AsyncTCP task only
+    unsigned long timeout_ms;
+    unsigned long start_ms;
+    std::atomic<bool> eof;         // last chunk is in the ring
+    std::atomic<bool> failed;      // decode or transfer failed: drop further chunks
+    std::atomic<bool> decoding;    // image_stream task still reads the ring
+    std::atomic<size_t> held;      // chunk bytes since the ACKs were last withheld
+    AsyncClient* client;           // connection whose ACKs are withheld (client_lock)
+    SemaphoreHandle_t client_lock; // serializes AsyncClient::ack() and `client`
+    StaticSemaphore_t client_lock_struct;
+    std::shared_ptr<UploadOutcome> outcome;  // AsyncTCP task only
+};
+static UploadStream upload_stream;
+
+// Wait in short slices so the end of the body or a failure is noticed promptly.
+static constexpr TickType_t kUploadStreamPollTicks = pdMS_TO_TICKS(20);
+
+// ACK everything withheld so far. Called from the handler when the ring has room
+// again, and from the image_stream task when the peer's window is shut (no segment
+// will arrive to do it); `client_lock` keeps the two from acking at once.
+static void upload_stream_release_acks() {
+    UploadStream& s = upload_stream;
+    xSemaphoreTake(s.client_lock, portMAX_DELAY);
+    if (s.held.exchange(0) > 0 && s.client) {
+        s.client->ack(SIZE_MAX);  // clamped to what AsyncTCP holds back
+    }
+    xSemaphoreGive(s.client_lock);
+}
+
+// image_stream task: reopen a window that closed on a full ring once it drained.
+static void upload_stream_resume() {
+    UploadStream& s = upload_stream;
+    if (s.held.load() + kUploadStreamTcpMss < kUploadStreamTcpWnd) return;  // still open
+    if (xStreamBufferSpacesAvailable(s.ring) < kUploadStreamTcpWnd) return;
+    upload_stream_release_acks();
+}
+
+static size_t upload_stream_read(void* ctx, uint8_t* dst, size_t len) {
+    (void)ctx;
+    UploadStream& s = upload_stream;
+    uint8_t skip[64];
+    size_t done = 0;
+    unsigned long idle_since = 0;
+
+    while (done < len && !s.failed.load()) {
+        uint8_t* out = dst ? dst + done : skip;  // dst == nullptr: skip
+        size_t want = len - done;
+        if (!dst && want > sizeof(skip)) want = sizeof(skip);
+
+        size_t n = xStreamBufferReceive(s.ring, out, want, 0);
+        if (n == 0) {
+            if (s.eof.load() && xStreamBufferIsEmpty(s.ring)) break;
+            if (idle_since == 0) idle_since = millis();
+            if (millis() - idle_since >= IMAGE_UPLOAD_STREAM_STALL_MS) {
+                LOGE("Upload", "Stream stalled after %u bytes", (unsigned)done);
+                s.failed.store(true);
+                break;
+            }
+            // Waiting on the network: let the LVGL task run meanwhile.
+            #if HAS_DISPLAY
+            display_manager_unlock();
+            #endif
+            n = xStreamBufferReceive(s.ring, out, want, kUploadStreamPollTicks);
+            #if HAS_DISPLAY
+            display_manager_lock(LvglLockSite::ImageApi);
+            #endif
+        }
+        if (n > 0) {
+            idle_since = 0;
+            upload_stream_resume();
+        }
+        done += n;
+    }
+    return done;
+}
+
+static void upload_stream_task(void*) {
+    UploadStream& s = upload_stream;
+    std::shared_ptr<UploadOutcome> outcome = s.outcome;
+    bool ok = false;
+    const int64_t t0 = esp_timer_get_time();
+
+    #if HAS_DISPLAY
+    display_manager_lock(LvglLockSite::ImageApi);
+    #endif
+    const unsigned long timeout_ms = s.timeout_ms > 0 ? s.timeout_ms : g_cfg.default_timeout_ms;
+    if (g_backend.start_strip_session(g_cfg.lcd_width, g_cfg.lcd_height, timeout_ms, s.start_ms)) {
+        ok = g_backend.decode_stream(upload_stream_read, nullptr, false);
+    } else {
+        LOGE("Upload", "Failed to init image display");
+    }
+    #if HAS_DISPLAY
+    display_manager_unlock();
+    #endif
+
+    const uint32_t us = (uint32_t)(esp_timer_get_time() - t0);
+    if (!ok || s.failed.load()) {
+        ok = false;
+        s.failed.store(true);
+        LOGE("Upload", "Streamed decode failed");
+        if (g_backend.hide_current_image) {
+            g_backend.hide_current_image();
+        }
+    } else {
+        LOGI("Upload", "Streamed to panel in %lu us", (unsigned long)us);
+    }
+    timing_decoded(1, us, ok, true);
+    // The final chunk's response answers from this.
+    outcome->image_seq = timing_snapshot().seq;
+    outcome->state.store(ok ? kUploadShown : kUploadFailed, std::memory_order_release);
+    outcome.reset();  // vTaskDelete() skips destructors
+
+    // Consume what is still in flight (bytes after EOI, or the rest of a failed
+    // upload) so the peer's window reopens instead of closing on a ring nobody reads.
+    uint8_t scratch[256];
+    unsigned long idle_since = millis();
+    while (!s.eof.load() && millis() - idle_since < IMAGE_UPLOAD_STREAM_STALL_MS) {
+        if (xStreamBufferReceive(s.ring, scratch, sizeof(scratch), kUploadStreamPollTicks) > 0) {
+            idle_since = millis();
+            upload_stream_resume();
+        }
+    }
+
+    s.owner = nullptr;
+    s.decoding.store(false);
+    upload_state = UPLOAD_IDLE;
+    vTaskDelete(nullptr);
+}
+
+// Start streaming `request` (first chunk). False = use the buffered path instead.
+static bool upload_stream_start(AsyncWebServerRequest* request) {
+    if (!g_backend.decode_stream || !g_backend.start_strip_session) return false;
+    #if HAS_DISPLAY && LV_USE_IMG
+    // The LVGL image screen decodes the whole JPEG into an lv_img buffer.
+    const char* active_screen = display_manager_get_current_screen_id();
+    if (active_screen && strcmp(active_screen, "lvgl_image") == 0) return false;
+    #endif
+    // Withheld ACKs bound what is in flight to one receive window; the ring needs
+    // that headroom on top of what the decoder is working through.
+    if (IMAGE_UPLOAD_STREAM_RING_BYTES < 2 * kUploadStreamTcpWnd) return false;
+
+    UploadStream& s = upload_stream;
+    if (s.decoding.load()) return false;
+    if (!s.ring) {
+        s.ring_storage = (uint8_t*)image_api_alloc(IMAGE_UPLOAD_STREAM_RING_BYTES + 1);
+        if (!s.ring_storage) return false;
+        s.ring = xStreamBufferCreateStatic(IMAGE_UPLOAD_STREAM_RING_BYTES, 1, s.ring_storage, &s.ring_struct);
+        if (!s.ring) {
+            image_api_free(s.ring_storage);
+            s.ring_storage = nullptr;
+            return false;
+        }
+    }
+    if (!s.client_lock) s.client_lock = xSemaphoreCreateMutexStatic(&s.client_lock_struct);
+    std::shared_ptr<UploadOutcome> outcome(new (std::nothrow) UploadOutcome());
+    if (!outcome) return false;
+    outcome->timeout_ms = image_upload_timeout_ms;
+    xStreamBufferReset(s.ring);
+
+    AsyncClient* client = request->client();
+    xSemaphoreTake(s.client_lock, portMAX_DELAY);
+    s.client = client;
+    s.held.store(0);
+    xSemaphoreGive(s.client_lock);
+    // The decoder must not ack a connection that has gone away.
+    request->onDisconnect([client]() {
+        UploadStream& us = upload_stream;
+        xSemaphoreTake(us.client_lock, portMAX_DELAY);
+        if (us.client == client) us.client = nullptr;
+        xSemaphoreGive(us.client_lock);
+    });
+
+    s.owner = request;
+    s.outcome = outcome;
+    s.received = 0;
+    s.timeout_ms = image_upload_timeout_ms;
+    s.start_ms = millis();
+    s.eof.store(false);
+    s.failed.store(false);
+    s.decoding.store(true);
+    upload_state = UPLOAD_IN_PROGRESS;
+
+    TaskHandle_t task = nullptr;
+    if (!task_placement_create(AppTask::ImageStream, upload_stream_task, nullptr, &task, nullptr)) {
+        LOGW("Upload", "Stream task unavailable; buffering the upload");
+        s.owner = nullptr;
+        s.outcome.reset();
+        s.decoding.store(false);
+        upload_state = UPLOAD_IDLE;
+        return false;
+    }
+    client_op_seq++;
+    LOGI("Upload", "Streaming to decoder (%u B ring)", (unsigned)IMAGE_UPLOAD_STREAM_RING_BYTES);
+    return true;
+}
+
+// JSON body for a finished streamed decode. 0 = `max_len` too small.
+static size_t upload_stream_format(const UploadOutcome& outcome, char* out, size_t max_len) {
+    const int n = outcome.state.load(std::memory_order_acquire) == kUploadShown
+        ? snprintf(out, max_len,
+                   "{\"success\":true,\"message\":\"Image streamed to display (%lus timeout)\",\"image_seq\":%lu}",
+                   (unsigned long)(outcome.timeout_ms / 1000), (unsigned long)outcome.image_seq)
+        : snprintf(out, max_len, "{\"success\":false,\"message\":\"Image decode failed\"}");
+    return (n > 0 && (size_t)n < max_len) ? (size_t)n : 0;
+}
+
+// One multipart chunk of the streaming upload (AsyncTCP task). Never waits.
+static void upload_stream_receive(AsyncWebServerRequest* request, const uint8_t* data, size_t len, bool final) {
+    UploadStream& s = upload_stream;
+    if (len > 0 && !s.failed.load()) {
+        const size_t n = xStreamBufferSend(s.ring, data, len, 0);
+        s.received += n;
+        if (n < len) {
+            // More arrived than the withheld ACKs let through.
+            LOGE("Upload", "Ring overrun after %u bytes", (unsigned)s.received);
+            s.failed.store(true);
+        }
+    }
+    if (!final) {
+        if (!s.failed.load() && xStreamBufferSpacesAvailable(s.ring) < kUploadStreamTcpWnd) {
+            request->client()->ackLater();  // this segment's ACK waits for the decoder
+            s.held.fetch_add(len > 0 ? len : 1);
+        } else if (s.held.load() > 0) {
+            upload_stream_release_acks();
+        }
+        return;
+    }
+
+    upload_stream_release_acks();
+    xSemaphoreTake(s.client_lock, portMAX_DELAY);
+    s.client = nullptr;
+    xSemaphoreGive(s.client_lock);
+    s.owner = nullptr;
+    s.eof.store(true);
+    timing_received(s.received);
+    LOGI("Upload", "Upload complete: %u bytes (streamed)", (unsigned)s.received);
+
+    std::shared_ptr<UploadOutcome> outcome = s.outcome;
+    s.outcome.reset();
+    char response_msg[160];
+    if (outcome->state.load(std::memory_order_acquire) != kUploadDecoding) {
+        const bool shown = outcome->state.load() == kUploadShown;
+        upload_stream_format(*outcome, response_msg, sizeof(response_msg));
+        request->send(shown ? 200 : 400, "application/json", response_msg);
+        return;
+    }
+
+    // Up to a full ring of JPEG is still waiting to be decoded: answer with the
+    // decode result, not just the transfer's. The status line has to go out now,
+    // so the body carries it once the image_stream task has published it.
+    AsyncWebServerResponse* response = request->beginChunkedResponse(
+        "application/json",
+        [outcome](uint8_t* buffer, size_t max_len, size_t index) -> size_t {
+            if (index > 0) return 0;
+            if (outcome->state.load(std::memory_order_acquire) == kUploadDecoding) return RESPONSE_TRY_AGAIN;
+            const size_t n = upload_stream_format(*outcome, (char*)buffer, max_len);
+            return n > 0 ? n : RESPONSE_TRY_AGAIN;
+        }
+    );
+    response->addHeader("Cache-Control", "no-store");
+    request->send(response);
+}
+#endif // IMAGE_UPLOAD_STREAMING
+
+// ===== Handlers =====
+
+// POST /api/display/image - Upload and display JPEG image (deferred decode)
+static void handleImageUpload(AsyncWebServerRequest *request, String filename, size_t index, uint8_t *data, size_t len, bool final) {
+    if (g_auth_gate && !g_auth_gate(request)) return;
+    (void)filename;
+
+    #if IMAGE_UPLOAD_STREAMING
+    if (index > 0 && upload_stream.owner == request) {
+        upload_stream_receive(request, data, len, final);
+        return;
+    }
+    #endif
+
+    // First chunk - initialize upload
+    if (index == 0) {
+        // If upload already in progress OR pending display, reject (client can retry)
+        if (upload_state == UPLOAD_IN_PROGRESS || upload_state == UPLOAD_READY_TO_DISPLAY || strip_pipeline_busy()) {
+            request->send(409, "application/json", "{\"success\":false,\"message\":\"Upload busy\"}");
+            return;
+        }
+
+        LOGI("Upload", "Start");
+        LOGI("Upload", "Total size: %u bytes", request->contentLength());
+
+        // Refuse unsupported files from the first chunk when its header is in there,
+        // before freeing the pending image or buffering the body.
+        char prefix_err[160];
+        if (jpeg_preflight_tjpgd_prefix(data, len, g_cfg.lcd_width, g_cfg.lcd_height,
+                                        prefix_err, sizeof(prefix_err)) == JpegPrefixVerdict::Reject) {
+            LOGE("Upload", "JPEG preflight failed (first chunk): %s", prefix_err);
+            char resp[256];
+            snprintf(resp, sizeof(resp), "{\"success\":false,\"message\":\"%s\"}", prefix_err);
+            request->send(400, "application/json", resp);
+            return;
+        }
+
+        image_upload_timeout_ms = parse_timeout_ms(request);
+        image_upload_start_ms = millis();
+        timing_begin(false, 1);
+        LOGI("Upload", "Timeout: %lu ms", image_upload_timeout_ms);
+
+        device_telemetry_log_memory_snapshot("img pre-clear");
+
+        // Free any pending image buffer to make room for new upload
+        if (pending_image_op.buffer) {
+            LOGI("Upload", "Freeing pending image buffer");
+            image_api_free((void*)pending_image_op.buffer);
+            pending_image_op.buffer = nullptr;
+            pending_image_op.size = 0;
+        }
+
+        device_telemetry_log_memory_snapshot("img post-clear");
+
+        // Check file size
+        size_t total_size = request->contentLength();
+        if (total_size > g_cfg.max_image_size_bytes) {
+            LOGE("Upload", "Image too large");
+            request->send(400, "application/json", "{\"success\":false,\"message\":\"Image too large\"}");
+            return;
+        }
+
+        #if IMAGE_UPLOAD_STREAMING
+        // Feed the decoder as the body arrives (no full-size buffer).
+        if (is_jpeg_magic(data, len) && upload_stream_start(request)) {
+            upload_stream_receive(request, data, len, final);
+            return;
+        }
+        #endif
+
+        // Check memory availability.
+        // - Upload uses a single contiguous buffer.
+        // - The decode pipeline needs headroom (historically expressed via g_cfg.decode_headroom_bytes).
+        // - A buffer the image arena can hold costs the heap nothing (only headroom is checked).
+        const size_t heap_upload_bytes = image_arena_can_fit(total_size) ? 0 : total_size;
+
+#if SOC_SPIRAM_SUPPORTED
+        // `SOC_SPIRAM_SUPPORTED` means the SoC can use PSRAM, but some boards have no PSRAM fitted.
+        // The board profile says which (constant unless BOARD_PSRAM is left at detect).
+        const bool has_psram = board_psram_available();
+        const size_t psram_free = has_psram ? heap_caps_get_free_size(MALLOC_CAP_SPIRAM) : 0;
+        const size_t psram_largest = has_psram ? heap_caps_get_largest_free_block(MALLOC_CAP_SPIRAM) : 0;
+        const bool psram_can_hold_upload = has_psram && (psram_free >= heap_upload_bytes) && (psram_largest >= heap_upload_bytes);
+#else
+        const size_t psram_free = 0;
+        const size_t psram_largest = 0;
+        const bool psram_can_hold_upload = false;
+#endif
+
+        // PSRAM boards vs no-PSRAM boards behave very differently.
+        // - On PSRAM boards: upload buffer is expected to land in PSRAM; keep an internal headroom guard.
+        // - On no-PSRAM boards: keep the historical "total heap" guard (ESP.getFreeHeap) so we don't
+        //   falsely reject when internal-only metrics look tight but the system can still operate.
+#if SOC_SPIRAM_SUPPORTED
+        if (has_psram) {
+            const size_t internal_free = heap_caps_get_free_size(MALLOC_CAP_INTERNAL | MALLOC_CAP_8BIT);
+            if (internal_free < g_cfg.decode_headroom_bytes) {
+            LOGE(
+                "Upload",
+                "Insufficient internal memory for decode headroom (need %u, have %u)",
+                (unsigned)g_cfg.decode_headroom_bytes,
+                (unsigned)internal_free
+            );
+            device_telemetry_log_memory_snapshot("img insufficient");
+            char error_msg[240];
+            snprintf(
+                error_msg,
+                sizeof(error_msg),
+                "{\"success\":false,\"message\":\"Insufficient internal memory: need %uKB decode headroom, have %uKB.\"}",
+                (unsigned)(g_cfg.decode_headroom_bytes / 1024),
+                (unsigned)(internal_free / 1024)
+            );
+            LOGE("Upload", "Insufficient internal memory");
             request->send(507, "application/json", error_msg);
             return;
             }
@@ -596,8 +1565,8 @@ static void handleImageUpload(AsyncWebServerRequest *request, String filename, s
             // We'll fall back to non-PSRAM allocation; be conservative.
             const size_t heap8_free = heap_caps_get_free_size(MALLOC_CAP_8BIT);
             const size_t heap8_largest = heap_caps_get_largest_free_block(MALLOC_CAP_8BIT);
-            const size_t required_heap8 = total_size + g_cfg.decode_headroom_bytes;
-            if (heap8_free < required_heap8 || heap8_largest < total_size) {
+            const size_t required_heap8 = heap_upload_bytes + g_cfg.decode_headroom_bytes;
+            if (heap8_free < required_heap8 || heap8_largest < heap_upload_bytes) {
                 LOGE(
                     "Upload",
                     "Insufficient memory (need %u heap8, have %u; largest %u; internal_free %u; psram_free %u largest %u)",
@@ -628,8 +1597,8 @@ static void handleImageUpload(AsyncWebServerRequest *request, String filename, s
             const size_t free_heap = ESP.getFreeHeap();
             const size_t largest = heap_caps_get_largest_free_block(MALLOC_CAP_8BIT);
             const size_t headroom = image_api_no_psram_effective_headroom_bytes(g_cfg.decode_headroom_bytes, free_heap, largest);
-            const size_t required = total_size + headroom;
-            if (free_heap < required || largest < total_size) {
+            const size_t required = heap_upload_bytes + headroom;
+            if (free_heap < required || largest < heap_upload_bytes) {
                 LOGE(
                     "Upload",
                     "Insufficient memory (need %u heap, have %u; largest %u)",
@@ -657,8 +1626,8 @@ static void handleImageUpload(AsyncWebServerRequest *request, String filename, s
         const size_t free_heap = ESP.getFreeHeap();
         const size_t largest = heap_caps_get_largest_free_block(MALLOC_CAP_8BIT);
         const size_t headroom = image_api_no_psram_effective_headroom_bytes(g_cfg.decode_headroom_bytes, free_heap, largest);
-        const size_t required = total_size + headroom;
-        if (free_heap < required || largest < total_size) {
+        const size_t required = heap_upload_bytes + headroom;
+        if (free_heap < required || largest < heap_upload_bytes) {
             LOGE(
                 "Upload",
                 "Insufficient memory (need %u heap, have %u; largest %u)",
@@ -761,7 +1730,9 @@ static void handleImageUpload(AsyncWebServerRequest *request, String filename, s
             pending_image_op.timeout_ms = image_upload_timeout_ms;
             pending_image_op.start_time = millis();
             pending_op_id++;
+            client_op_seq++;
             upload_state = UPLOAD_READY_TO_DISPLAY;
+            timing_received(image_upload_size);
 
             // main loop owns the buffer now
             image_upload_buffer = nullptr;
@@ -771,8 +1742,8 @@ static void handleImageUpload(AsyncWebServerRequest *request, String filename, s
 
             char response_msg[160];
             snprintf(response_msg, sizeof(response_msg),
-                     "{\"success\":true,\"message\":\"Image queued for display (%lus timeout)\"}",
-                     (unsigned long)(image_upload_timeout_ms / 1000));
+                     "{\"success\":true,\"message\":\"Image queued for display (%lus timeout)\",\"image_seq\":%lu}",
+                     (unsigned long)(image_upload_timeout_ms / 1000), (unsigned long)timing_snapshot().seq);
             request->send(200, "application/json", response_msg);
         } else {
             LOGE("Upload", "No data received");
@@ -795,22 +1766,102 @@ static void handleImageDelete(AsyncWebServerRequest *request) {
     pending_image_op.dismiss = true;
     upload_state = UPLOAD_READY_TO_DISPLAY;
     pending_op_id++;
+    client_op_seq++;
 
     request->send(200, "application/json", "{\"success\":true,\"message\":\"Image dismiss queued\"}");
 }
 
+// GET /api/display/image/timing - Receive/decode timing of the newest upload
+static void handleImageTiming(AsyncWebServerRequest *request) {
+    if (g_auth_gate && !g_auth_gate(request)) return;
+    const ImageUploadTiming t = timing_snapshot();
+    DecodeSliceStats ds;
+    decode_slice_get_stats(&ds);
+    StripDecodeStats sd;
+    strip_decoder_get_stats(&sd);
+    const StripDecodeSession& cur = sd.current;
+    char response[1024];
+    snprintf(response, sizeof(response),
+             "{\"success\":true,\"seq\":%lu,\"kind\":\"%s\",\"complete\":%s,\"ok\":%s,"
+             "\"strip_count\":%u,\"strips_received\":%u,\"strips_decoded\":%u,\"bytes\":%lu,"
+             "\"receive_us\":%lu,\"decode_us\":%lu,\"decode_max_us\":%lu,\"total_us\":%lu,"
+             "\"slice\":{\"budget_us\":%lu,\"decoding\":%s,\"rows\":%lu,\"slices\":%lu,\"elapsed_us\":%lu,"
+             "\"total_slices\":%lu,\"starved\":%lu,\"max_slice_us\":%lu,\"yield_us\":%lu},"
+             "\"decoder\":{\"active\":%s,\"strips\":%lu,\"failed\":%lu,\"bytes_in\":%lu,\"pixels_out\":%lu,"
+             "\"decode_us\":%lu,\"push_us\":%lu,\"yields\":%lu,\"async_rects\":%lu,\"batch_rects\":%lu,"
+             "\"line_rows\":%lu,\"hw_strips\":%lu,\"batch_rows\":%u,\"pingpong\":%s,"
+             "\"sessions\":%lu,\"line_fallback_sessions\":%lu}}",
+             (unsigned long)t.seq, t.strips ? "strips" : "full",
+             (t.seq != 0 && !t.active) ? "true" : "false", t.ok ? "true" : "false",
+             (unsigned)t.strip_count, (unsigned)t.strips_received, (unsigned)t.strips_decoded,
+             (unsigned long)t.bytes, (unsigned long)t.receive_us, (unsigned long)t.decode_us,
+             (unsigned long)t.decode_max_us, (unsigned long)t.total_us,
+             (unsigned long)IMAGE_DECODE_SLICE_US, ds.active ? "true" : "false",
+             (unsigned long)ds.last_rows, (unsigned long)ds.last_slices, (unsigned long)ds.last_decode_us,
+             (unsigned long)ds.slices, (unsigned long)ds.starved, (unsigned long)ds.max_slice_us,
+             (unsigned long)ds.yield_us,
+             sd.active ? "true" : "false", (unsigned long)cur.strips, (unsigned long)cur.failed,
+             (unsigned long)cur.bytes_in, (unsigned long)cur.pixels_out, (unsigned long)cur.decode_us,
+             (unsigned long)cur.push_us, (unsigned long)cur.yields, (unsigned long)cur.async_rects,
+             (unsigned long)cur.batch_rects, (unsigned long)cur.line_rows, (unsigned long)cur.hw_strips,
+             (unsigned)cur.batch_rows, cur.pingpong ? "true" : "false",
+             (unsigned long)sd.sessions, (unsigned long)sd.line_fallback_sessions);
+    request->send(200, "application/json", response);
+}
+
+static bool url_op_busy() {
+    bool url_op_active = false;
+    portENTER_CRITICAL(&pending_url_op_mux);
+    url_op_active = pending_url_op.active;
+    portEXIT_CRITICAL(&pending_url_op_mux);
+    return upload_state == UPLOAD_IN_PROGRESS || upload_state == UPLOAD_READY_TO_DISPLAY || url_op_active || strip_pipeline_busy();
+}
+
+// Hand a validated URL to the main loop (AsyncTCP task).
+static void publish_url_op(const char* url, unsigned long timeout_ms, bool cache) {
+    // Free any pending image buffer to make room.
+    if (pending_image_op.buffer) {
+        image_api_free((void*)pending_image_op.buffer);
+        pending_image_op.buffer = nullptr;
+        pending_image_op.size = 0;
+    }
+
+    // Publish the URL op: fill fields first, then flip `active` last.
+    // This is shared between the AsyncTCP task and the main loop.
+    portENTER_CRITICAL(&pending_url_op_mux);
+    strncpy(pending_url_op.url, url, sizeof(pending_url_op.url));
+    pending_url_op.url[sizeof(pending_url_op.url) - 1] = '\0';
+    pending_url_op.timeout_ms = timeout_ms;
+    pending_url_op.cache = cache;
+    pending_url_op.active = true;
+    portEXIT_CRITICAL(&pending_url_op_mux);
+
+    upload_state = UPLOAD_READY_TO_DISPLAY;
+    pending_op_id++;
+    client_op_seq++;
+}
+
+bool image_api_queue_url(const char* url, long timeout_s, bool use_cache) {
+    if (!url || !url[0] || strlen(url) >= IMAGE_API_URL_MAX_LEN) return false;
+    if (url_op_busy()) return false;
+
+    unsigned long seconds = g_cfg.default_timeout_ms / 1000;
+    if (timeout_s >= 0) {
+        seconds = (unsigned long)timeout_s;
+        const unsigned long max_seconds = g_cfg.max_timeout_ms / 1000;
+        if (seconds > max_seconds) seconds = max_seconds;
+    }
+    publish_url_op(url, seconds * 1000UL, use_cache);
+    return true;
+}
+
 // POST /api/display/image_url - Queue HTTP(S) JPEG download for display
 // Body: {"url":"https://example.com/image.jpg"}
 static void handleImageUrl(AsyncWebServerRequest *request, uint8_t *data, size_t len, size_t index, size_t total) {
     if (g_auth_gate && !g_auth_gate(request)) return;
     // Only accept small JSON payloads.
     if (index == 0) {
-        bool url_op_active = false;
-        portENTER_CRITICAL(&pending_url_op_mux);
-        url_op_active = pending_url_op.active;
-        portEXIT_CRITICAL(&pending_url_op_mux);
-
-        if (upload_state == UPLOAD_IN_PROGRESS || upload_state == UPLOAD_READY_TO_DISPLAY || url_op_active || pending_strip_op.buffer) {
+        if (url_op_busy()) {
             request->send(409, "application/json", "{\"success\":false,\"message\":\"Busy\"}");
             return;
         }
@@ -874,25 +1925,7 @@ static void handleImageUrl(AsyncWebServerRequest *request, uint8_t *data, size_t
             return;
         }
 
-        // Free any pending image buffer to make room.
-        if (pending_image_op.buffer) {
-            image_api_free((void*)pending_image_op.buffer);
-            pending_image_op.buffer = nullptr;
-            pending_image_op.size = 0;
-        }
-
-        // Publish the URL op: fill fields first, then flip `active` last.
-        // This is shared between the AsyncTCP task and the main loop.
-        portENTER_CRITICAL(&pending_url_op_mux);
-        strncpy(pending_url_op.url, url, sizeof(pending_url_op.url));
-        pending_url_op.url[sizeof(pending_url_op.url) - 1] = '\0';
-        pending_url_op.timeout_ms = parse_timeout_ms(request);
-        pending_url_op.active = true;
-        portEXIT_CRITICAL(&pending_url_op_mux);
-
-        upload_state = UPLOAD_READY_TO_DISPLAY;
-        pending_op_id++;
-
+        publish_url_op(url, parse_timeout_ms(request), doc["cache"] | true);
         request->send(200, "application/json", "{\"success\":true,\"message\":\"Image URL queued\"}");
     }
 }
@@ -929,9 +1962,29 @@ static void handleStripUpload(AsyncWebServerRequest *request, uint8_t *data, siz
         ? (unsigned long)request->getParam("timeout", false)->value().toInt() * 1000UL
         : g_cfg.default_timeout_ms;
 
+    ImageStripFormat format = ImageStripFormat::Jpeg;
+    if (request->hasParam("format", false) &&
+        !image_strip_format_parse(request->getParam("format", false)->value().c_str(), &format)) {
+        if (index == 0) {
+            request->send(400, "application/json", "{\"success\":false,\"message\":\"Unknown format (jpeg, rgb565, rgb565_rle, rgb565_lz4)\"}");
+        }
+        return;
+    }
+    // Raw strips: rows follow from the body size; compressed strips must say how many.
+    const size_t row_bytes = (size_t)(imageWidth > 0 ? imageWidth : 0) * sizeof(uint16_t);
+    int stripRows = 0;
+    if (format == ImageStripFormat::Rgb565) {
+        stripRows = row_bytes > 0 ? (int)(total / row_bytes) : 0;
+    } else if (format != ImageStripFormat::Jpeg && request->hasParam("rows", false)) {
+        stripRows = request->getParam("rows", false)->value().toInt();
+    }
+
     if (index == 0) {
         // Reject if we're busy. AsyncWebServer runs on AsyncTCP task; do not block.
-        if (upload_state == UPLOAD_IN_PROGRESS || upload_state == UPLOAD_READY_TO_DISPLAY || pending_strip_op.buffer) {
+        // Strips only need a free queue slot and an idle receive buffer: earlier strips
+        // may still be decoding on the main loop.
+        if (upload_state == UPLOAD_IN_PROGRESS || upload_state == UPLOAD_READY_TO_DISPLAY ||
+            current_strip_buffer || strip_queue_depth() >= IMAGE_STRIP_QUEUE_DEPTH) {
             request->send(409, "application/json", "{\"success\":false,\"message\":\"Busy\"}");
             return;
         }
@@ -954,9 +2007,17 @@ static void handleStripUpload(AsyncWebServerRequest *request, uint8_t *data, siz
             return;
         }
 
-        if (current_strip_buffer) {
-            image_api_free((void*)current_strip_buffer);
-            current_strip_buffer = nullptr;
+        if (format != ImageStripFormat::Jpeg) {
+            if (!g_backend.push_rgb565_strip) {
+                request->send(400, "application/json", "{\"success\":false,\"message\":\"RGB565 strips not supported\"}");
+                return;
+            }
+            const bool size_ok = (format != ImageStripFormat::Rgb565) || (total == row_bytes * (size_t)stripRows);
+            if (stripRows <= 0 || stripRows > imageHeight || !size_ok) {
+                LOGE("Strip", "Invalid %s strip (%u bytes, rows=%d)", image_strip_format_name(format), (unsigned)total, stripRows);
+                request->send(400, "application/json", "{\"success\":false,\"message\":\"Invalid strip rows (rgb565: body must be width*rows*2 bytes; compressed: rows= required)\"}");
+                return;
+            }
         }
 
         current_strip_buffer = (uint8_t*)image_api_alloc(total);
@@ -970,6 +2031,9 @@ static void handleStripUpload(AsyncWebServerRequest *request, uint8_t *data, siz
 
         current_strip_size = 0;
         strip_upload_last_activity_ms = millis();
+        if (stripIndex == 0) {
+            timing_begin(true, totalStrips);
+        }
     }
 
     if (current_strip_buffer && current_strip_size + len <= total) {
@@ -978,7 +2042,7 @@ static void handleStripUpload(AsyncWebServerRequest *request, uint8_t *data, siz
         strip_upload_last_activity_ms = millis();
     }
 
-    // Final chunk: decode synchronously before returning
+    // Final chunk: validate and hand the strip to the decode queue
     if (index + len >= total) {
         if (current_strip_size != total) {
             image_api_free((void*)current_strip_buffer);
@@ -988,7 +2052,8 @@ static void handleStripUpload(AsyncWebServerRequest *request, uint8_t *data, siz
             return;
         }
 
-        if (!is_jpeg_magic(current_strip_buffer, current_strip_size)) {
+        // RGB565 formats have no header to sniff; size/rows were validated up front.
+        if (format == ImageStripFormat::Jpeg && !is_jpeg_magic(current_strip_buffer, current_strip_size)) {
             image_api_free((void*)current_strip_buffer);
             current_strip_buffer = nullptr;
             LOGE("Strip", "Invalid JPEG data");
@@ -996,15 +2061,20 @@ static void handleStripUpload(AsyncWebServerRequest *request, uint8_t *data, siz
             return;
         }
 
-        // Best-effort header preflight
+        // Best-effort header preflight (parsed once per image, then hash-matched)
         char preflight_err[160];
         const int remaining_height = imageHeight;
-        if (!jpeg_preflight_tjpgd_fragment_supported(
+        if (stripIndex == 0) {
+            strip_session_header_valid = false;
+        }
+        if (format == ImageStripFormat::Jpeg && !jpeg_preflight_tjpgd_fragment_cached(
                 current_strip_buffer,
                 current_strip_size,
                 imageWidth,
                 remaining_height,
                 g_cfg.lcd_height,
+                strip_session_header,
+                strip_session_header_valid,
                 preflight_err,
                 sizeof(preflight_err))) {
             LOGE("Strip", "JPEG fragment preflight failed: %s", preflight_err);
@@ -1017,50 +2087,210 @@ static void handleStripUpload(AsyncWebServerRequest *request, uint8_t *data, siz
             request->send(400, "application/json", resp);
             return;
         }
+        if (format == ImageStripFormat::Jpeg) {
+            strip_session_header_valid = strip_session_header.header_len > 0;
+        }
 
         // Queue strip for async decode (don't decode in HTTP handler)
-        // If we're busy, reject and let client retry.
-        if (upload_state == UPLOAD_IN_PROGRESS || upload_state == UPLOAD_READY_TO_DISPLAY || pending_strip_op.buffer) {
+        // If every slot is taken, reject and let client retry.
+        PendingStripOp op;
+        op.buffer = current_strip_buffer;
+        op.size = current_strip_size;
+        op.strip_index = (uint8_t)stripIndex;
+        op.image_width = imageWidth;
+        op.image_height = imageHeight;
+        op.total_strips = totalStrips;
+        op.timeout_ms = timeoutMs;
+        op.start_time = millis();
+        op.format = format;
+        op.rows = stripRows;
+        op.region = false;
+        op.x = 0;
+        op.y = 0;
+
+        if (upload_state == UPLOAD_IN_PROGRESS || upload_state == UPLOAD_READY_TO_DISPLAY || !strip_queue_push(op)) {
             image_api_free((void*)current_strip_buffer);
             current_strip_buffer = nullptr;
+            current_strip_size = 0;
             LOGW("Strip", "Busy");
             request->send(409, "application/json", "{\"success\":false,\"message\":\"Busy\"}" );
             return;
         }
 
-        // Transfer strip buffer to pending operation
-        upload_state = UPLOAD_IN_PROGRESS;
-        pending_strip_op.buffer = current_strip_buffer;
-        pending_strip_op.size = current_strip_size;
-        pending_strip_op.strip_index = (uint8_t)stripIndex;
-        pending_strip_op.image_width = imageWidth;
-        pending_strip_op.image_height = imageHeight;
-        pending_strip_op.total_strips = totalStrips;
-        pending_strip_op.timeout_ms = timeoutMs;
-        pending_strip_op.start_time = millis();
-        
+        const size_t queued_bytes = current_strip_size;
         current_strip_buffer = nullptr;
         current_strip_size = 0;
-        
-        upload_state = UPLOAD_READY_TO_DISPLAY;
-        pending_op_id++;
-        
+        if (stripIndex == 0) {
+            client_op_seq++;
+        }
+        strip_image_open = stripIndex < totalStrips - 1;
+        timing_received(queued_bytes);
+
         LOGI("Strip", "Strip %d/%d queued for decode", stripIndex, totalStrips - 1);
 
-        char response[160];
+        // Decode is deferred: report progress of this image's earlier strips.
+        // The decoder fields cover its current session (this image once strip 0 is decoded).
+        const ImageUploadTiming t = timing_snapshot();
+        StripDecodeStats sd;
+        strip_decoder_get_stats(&sd);
+        char response[352];
         snprintf(response, sizeof(response),
-                 "{\"success\":true,\"strip_index\":%d,\"strip_count\":%d,\"complete\":%s}",
-                 stripIndex, totalStrips, (stripIndex == totalStrips - 1) ? "true" : "false");
+                 "{\"success\":true,\"strip_index\":%d,\"strip_count\":%d,\"complete\":%s,"
+                 "\"image_seq\":%lu,\"strips_decoded\":%u,\"decode_us\":%lu,"
+                 "\"push_us\":%lu,\"yields\":%lu,\"batch_rows\":%u,\"batch_rects\":%lu,"
+                 "\"async_rects\":%lu,\"line_rows\":%lu}",
+                 stripIndex, totalStrips, (stripIndex == totalStrips - 1) ? "true" : "false",
+                 (unsigned long)t.seq, (unsigned)t.strips_decoded, (unsigned long)t.decode_us,
+                 (unsigned long)sd.current.push_us, (unsigned long)sd.current.yields,
+                 (unsigned)sd.current.batch_rows, (unsigned long)sd.current.batch_rects,
+                 (unsigned long)sd.current.async_rects, (unsigned long)sd.current.line_rows);
         request->send(200, "application/json", response);
     }
 }
 
+// POST /api/display/image/region?x=&y=&w=&h=[&format=]
+// Patch one panel rectangle of the image on screen with a JPEG or RGB565 payload
+// (same formats as strips; rows = h). Queued behind strips and decoded by the main loop.
+static void handleRegionUpload(AsyncWebServerRequest *request, uint8_t *data, size_t len, size_t index, size_t total) {
+    if (g_auth_gate && !g_auth_gate(request)) return;
+
+    if (!request->hasParam("x", false) || !request->hasParam("y", false) ||
+        !request->hasParam("w", false) || !request->hasParam("h", false)) {
+        if (index == 0) {
+            request->send(400, "application/json", "{\"success\":false,\"message\":\"Missing required parameters: x, y, w, h\"}");
+        }
+        return;
+    }
+
+    const int rx = request->getParam("x", false)->value().toInt();
+    const int ry = request->getParam("y", false)->value().toInt();
+    const int rw = request->getParam("w", false)->value().toInt();
+    const int rh = request->getParam("h", false)->value().toInt();
+
+    ImageStripFormat format = ImageStripFormat::Jpeg;
+    if (request->hasParam("format", false) &&
+        !image_strip_format_parse(request->getParam("format", false)->value().c_str(), &format)) {
+        if (index == 0) {
+            request->send(400, "application/json", "{\"success\":false,\"message\":\"Unknown format (jpeg, rgb565, rgb565_rle, rgb565_lz4)\"}");
+        }
+        return;
+    }
+
+    if (index == 0) {
+        if (!g_backend.begin_region) {
+            request->send(400, "application/json", "{\"success\":false,\"message\":\"Region updates not supported\"}");
+            return;
+        }
+        if (rx < 0 || ry < 0 || rw <= 0 || rh <= 0 || rx + rw > g_cfg.lcd_width || ry + rh > g_cfg.lcd_height) {
+            LOGE("Region", "Invalid region %d,%d %dx%d", rx, ry, rw, rh);
+            request->send(400, "application/json", "{\"success\":false,\"message\":\"Region outside the display\"}");
+            return;
+        }
+        if (format == ImageStripFormat::Rgb565 && total != (size_t)rw * (size_t)rh * sizeof(uint16_t)) {
+            request->send(400, "application/json", "{\"success\":false,\"message\":\"rgb565 body must be w*h*2 bytes\"}");
+            return;
+        }
+        if (format != ImageStripFormat::Jpeg && !g_backend.push_rgb565_strip) {
+            request->send(400, "application/json", "{\"success\":false,\"message\":\"RGB565 strips not supported\"}");
+            return;
+        }
+
+        // Same receive slot as strips; wait for a multi-strip image to finish (3s idle = abandoned).
+        const bool strips_pending = strip_image_open &&
+            (unsigned long)(millis() - strip_upload_last_activity_ms) < 3000UL;
+        if (upload_state == UPLOAD_IN_PROGRESS || upload_state == UPLOAD_READY_TO_DISPLAY ||
+            current_strip_buffer || strips_pending || strip_queue_depth() >= IMAGE_STRIP_QUEUE_DEPTH) {
+            request->send(409, "application/json", "{\"success\":false,\"message\":\"Busy\"}");
+            return;
+        }
+
+        current_strip_buffer = (uint8_t*)image_api_alloc(total);
+        if (!current_strip_buffer) {
+            LOGE("Region", "Out of memory (requested %u bytes)", (unsigned)total);
+            request->send(507, "application/json", "{\"success\":false,\"message\":\"Out of memory\"}");
+            return;
+        }
+        current_strip_size = 0;
+        strip_upload_last_activity_ms = millis();
+    }
+
+    if (current_strip_buffer && current_strip_size + len <= total) {
+        memcpy((uint8_t*)current_strip_buffer + current_strip_size, data, len);
+        current_strip_size += len;
+        strip_upload_last_activity_ms = millis();
+    }
+
+    if (index + len < total) {
+        return;
+    }
+
+    if (!current_strip_buffer || current_strip_size != total) {
+        image_api_free((void*)current_strip_buffer);
+        current_strip_buffer = nullptr;
+        current_strip_size = 0;
+        LOGE("Region", "Incomplete upload");
+        request->send(500, "application/json", "{\"success\":false,\"message\":\"Incomplete upload\"}");
+        return;
+    }
+
+    if (format == ImageStripFormat::Jpeg) {
+        char preflight_err[160];
+        const bool ok = is_jpeg_magic(current_strip_buffer, current_strip_size) &&
+            jpeg_preflight_tjpgd_fragment_supported(current_strip_buffer, current_strip_size, rw, rh,
+                                                    g_cfg.lcd_height, preflight_err, sizeof(preflight_err));
+        if (!ok) {
+            if (!is_jpeg_magic(current_strip_buffer, current_strip_size)) {
+                strlcpy(preflight_err, "Invalid JPEG data", sizeof(preflight_err));
+            }
+            LOGE("Region", "JPEG preflight failed: %s", preflight_err);
+            image_api_free((void*)current_strip_buffer);
+            current_strip_buffer = nullptr;
+            current_strip_size = 0;
+
+            char resp[256];
+            snprintf(resp, sizeof(resp), "{\"success\":false,\"message\":\"%s\"}", preflight_err);
+            request->send(400, "application/json", resp);
+            return;
+        }
+    }
+
+    PendingStripOp op = {};
+    op.buffer = current_strip_buffer;
+    op.size = current_strip_size;
+    op.strip_index = 0;
+    op.image_width = rw;
+    op.image_height = rh;
+    op.total_strips = 1;
+    op.timeout_ms = 0;
+    op.start_time = millis();
+    op.format = format;
+    op.rows = rh;
+    op.region = true;
+    op.x = rx;
+    op.y = ry;
+
+    if (!strip_queue_push(op)) {
+        image_api_free((void*)current_strip_buffer);
+        current_strip_buffer = nullptr;
+        current_strip_size = 0;
+        request->send(409, "application/json", "{\"success\":false,\"message\":\"Busy\"}");
+        return;
+    }
+    current_strip_buffer = nullptr;
+    current_strip_size = 0;
+
+    LOGI("Region", "Queued %s patch %d,%d %dx%d (%u bytes)", image_strip_format_name(format), rx, ry, rw, rh, (unsigned)total);
+    request->send(200, "application/json", "{\"success\":true,\"message\":\"Region update queued\"}");
+}
+
 // ===== Public API =====
 
 void image_api_init(const ImageApiConfig& cfg, const ImageApiBackend& backend) {
     g_cfg = cfg;
     g_backend = backend;
 
+    image_arena_init();
+
     image_upload_timeout_ms = g_cfg.default_timeout_ms;
 
     // Best-effort: reset state
@@ -1074,11 +2304,7 @@ void image_api_init(const ImageApiConfig& cfg, const ImageApiBackend& backend) {
     }
     current_strip_size = 0;
 
-    if (pending_strip_op.buffer) {
-        image_api_free((void*)pending_strip_op.buffer);
-        pending_strip_op.buffer = nullptr;
-    }
-    pending_strip_op = {nullptr, 0, 0, 0, 0, 0, g_cfg.default_timeout_ms, 0};
+    strip_queue_clear();
 
     if (image_upload_buffer) {
         image_api_free((void*)image_upload_buffer);
@@ -1087,9 +2313,117 @@ void image_api_init(const ImageApiConfig& cfg, const ImageApiBackend& backend) {
     image_upload_size = 0;
 }
 
+bool image_api_fetch_jpeg(const char* url, unsigned long timeout_ms, bool use_cache,
+                          uint8_t** out_buf, size_t* out_sz, char* err, size_t err_len) {
+    UrlCacheCtx cache;
+    (void)use_cache;
+    #if IMAGE_URL_CACHE_ENABLED
+    cache.enabled = use_cache && image_cache_available();
+    cache.have_entry = cache.enabled && image_cache_lookup(url, &cache.validators);
+    #endif
+    return download_jpeg_to_buffer(url, timeout_ms, &cache, out_buf, out_sz, err, err_len);
+}
+
+void image_api_free_buffer(void* p) {
+    image_api_free(p);
+}
+
+bool image_api_fetch_jpeg_if_modified(const char* url, unsigned long timeout_ms, ImageApiValidators* v,
+                                      bool* not_modified, uint8_t** out_buf, size_t* out_sz,
+                                      char* err, size_t err_len) {
+    if (!v || !not_modified || !out_buf || !out_sz) return false;
+    *not_modified = false;
+    *out_buf = nullptr;
+    *out_sz = 0;
+
+    HttpImageConn conn;
+    if (!http_image_open(url, timeout_ms, true, &conn, err, err_len, v->etag, v->last_modified)) {
+        return false;
+    }
+    if (conn.not_modified) {
+        *not_modified = true;
+        return true;
+    }
+    if (!read_body_to_buffer(&conn, out_buf, out_sz, err, err_len)) {
+        return false;
+    }
+    strlcpy(v->etag, conn.etag, sizeof(v->etag));
+    strlcpy(v->last_modified, conn.last_modified, sizeof(v->last_modified));
+    return true;
+}
+
+struct ImageApiHttpStream {
+    HttpImageConn conn;
+};
+
+ImageApiHttpStream* image_api_http_stream_open(const char* url, unsigned long timeout_ms,
+                                               char* content_type, size_t content_type_len,
+                                               char* err, size_t err_len) {
+    ImageApiHttpStream* s = new ImageApiHttpStream();
+    if (!http_image_open(url, timeout_ms, false, &s->conn, err, err_len)) {
+        delete s;
+        return nullptr;
+    }
+    if (content_type && content_type_len) {
+        strlcpy(content_type, s->conn.content_type, content_type_len);
+    }
+    return s;
+}
+
+int image_api_http_stream_read(ImageApiHttpStream* s, uint8_t* dst, size_t len) {
+    if (!s || !s->conn.client || !dst || len == 0) return -1;
+    Client* client = s->conn.client;
+    const int avail = client->available();
+    if (avail <= 0) {
+        return client->connected() ? 0 : -1;
+    }
+    const int r = client->read(dst, (int)min((size_t)avail, len));
+    return r > 0 ? r : 0;
+}
+
+void image_api_http_stream_close(ImageApiHttpStream* s) {
+    delete s;  // ~HttpImageConn closes the socket (never kept alive)
+}
+
+uint32_t image_api_claim_screen() {
+    return ++client_op_seq;
+}
+
+bool image_api_show_jpeg(uint8_t* buf, size_t sz, unsigned long timeout_ms) {
+    if (!buf) return false;
+    if (image_api_busy()) {
+        image_api_free(buf);
+        return false;
+    }
+    if (pending_image_op.buffer) {
+        image_api_free((void*)pending_image_op.buffer);
+    }
+    pending_image_op.buffer = buf;
+    pending_image_op.size = sz;
+    pending_image_op.dismiss = false;
+    pending_image_op.timeout_ms = timeout_ms;
+    pending_image_op.start_time = millis();
+    pending_op_id++;
+    client_op_seq++;
+    upload_state = UPLOAD_READY_TO_DISPLAY;
+    return true;
+}
+
+bool image_api_busy() {
+    bool url_op_active = false;
+    portENTER_CRITICAL(&pending_url_op_mux);
+    url_op_active = pending_url_op.active;
+    portEXIT_CRITICAL(&pending_url_op_mux);
+    return upload_state != UPLOAD_IDLE || url_op_active || strip_pipeline_busy();
+}
+
+uint32_t image_api_op_seq() {
+    return client_op_seq;
+}
+
 void image_api_register_routes(AsyncWebServer* server, bool (*auth_gate)(AsyncWebServerRequest* request)) {
     g_auth_gate = auth_gate;
-    // Register the more specific /strips endpoint before /image.
+    // Register the more specific /strips and /region endpoints before /image.
     server->on(
         "/api/display/image/strips",
         HTTP_POST,
@@ -1100,6 +2434,16 @@ void image_api_register_routes(AsyncWebServer* server, bool (*auth_gate)(AsyncWe
         handleStripUpload
     );
 
+    server->on(
+        "/api/display/image/region",
+        HTTP_POST,
+        [](AsyncWebServerRequest *request) {
+            if (g_auth_gate && !g_auth_gate(request)) return;
+        },
+        NULL,
+        handleRegionUpload
+    );
+
     server->on(
         "/api/display/image",
         HTTP_POST,
@@ -1119,12 +2463,188 @@ void image_api_register_routes(AsyncWebServer* server, bool (*auth_gate)(AsyncWe
         handleImageUrl
     );
 
+    server->on("/api/display/image/timing", HTTP_GET, handleImageTiming);
     server->on("/api/display/image", HTTP_DELETE, handleImageDelete);
 }
 
+// RGB565 strips: decompress (outside the display lock), then push straight to the panel.
+// Raw strips are pushed from the receive buffer itself.
+static bool push_rgb565_strip_op(const PendingStripOp& op) {
+    if (!g_backend.push_rgb565_strip) {
+        return false;
+    }
+
+    const size_t pixel_bytes = (size_t)op.image_width * (size_t)op.rows * sizeof(uint16_t);
+    uint16_t* pixels = nullptr;
+    bool owned = false;
+    if (op.format == ImageStripFormat::Rgb565) {
+        pixels = (uint16_t*)op.buffer;
+    } else {
+        pixels = (uint16_t*)image_api_alloc(pixel_bytes);
+        if (!pixels) {
+            LOGE("Portal", "Out of memory for %u-byte RGB565 strip", (unsigned)pixel_bytes);
+            return false;
+        }
+        owned = true;
+        const bool ok = (op.format == ImageStripFormat::Rgb565Lz4)
+            ? rgb565_lz4_decode(op.buffer, op.size, (uint8_t*)pixels, pixel_bytes)
+            : rgb565_rle_decode(op.buffer, op.size, (uint8_t*)pixels, pixel_bytes);
+        if (!ok) {
+            LOGE("Portal", "Malformed %s strip %d", image_strip_format_name(op.format), op.strip_index);
+            image_api_free((void*)pixels);
+            return false;
+        }
+    }
+
+    #if HAS_DISPLAY
+    display_manager_lock(LvglLockSite::ImageApi);
+    #endif
+    const bool success = g_backend.push_rgb565_strip(pixels, op.rows, false);
+    #if HAS_DISPLAY
+    display_manager_unlock();
+    #endif
+
+    if (owned) {
+        image_api_free((void*)pixels);
+    }
+    return success;
+}
+
+static bool decode_queued_op(const PendingStripOp& op) {
+    if (op.format != ImageStripFormat::Jpeg) {
+        return push_rgb565_strip_op(op);
+    }
+    if (!g_backend.decode_strip) {
+        return false;
+    }
+    #if HAS_DISPLAY
+    // Serialize with LVGL task to protect buffered backends (Arduino_GFX canvas)
+    // and prevent overlapping present()/SPI polling transactions.
+    display_manager_lock(LvglLockSite::ImageApi);
+    #endif
+    const bool success = g_backend.decode_strip(op.buffer, op.size, op.strip_index, false);
+    #if HAS_DISPLAY
+    display_manager_unlock();
+    #endif
+    return success;
+}
+
+static bool decode_queued_pair(const PendingStripOp& first, const PendingStripOp& next) {
+    #if HAS_DISPLAY
+    display_manager_lock(LvglLockSite::ImageApi);
+    #endif
+    const bool success = g_backend.decode_strip_pair(first.buffer, first.size, next.buffer, next.size, false);
+    #if HAS_DISPLAY
+    display_manager_unlock();
+    #endif
+    return success;
+}
+
+// A failed patch only logs: the rest of the image on screen is still valid.
+static void process_region_op(const PendingStripOp& op) {
+    LOGI("Portal", "Processing region %d,%d %dx%d (%u bytes)", op.x, op.y, op.image_width, op.image_height, (unsigned)op.size);
+    const bool ok = g_backend.begin_region &&
+                    g_backend.begin_region(op.x, op.y, op.image_width, op.image_height) &&
+                    decode_queued_op(op);
+    image_api_free((void*)strip_queue_pop());
+    if (!ok) {
+        LOGE("Portal", "Region update failed");
+    }
+}
+
+// Decode the oldest queued strip (at most one per call so the loop stays responsive).
+// When the next strip of the same image is already queued, both go to decode_strip_pair()
+// so a dual-core target decodes them side by side.
+// The slot is only released after decode so a strip in flight counts against the depth.
+static void process_strip_queue() {
+    PendingStripOp op;
+    if (!strip_queue_peek(&op)) {
+        return;
+    }
+
+    if (op.region) {
+        process_region_op(op);
+        return;
+    }
+
+    const uint8_t strip_index = op.strip_index;
+    const int total_strips = op.total_strips;
+
+    PendingStripOp next_op;
+    const bool pair = g_backend.decode_strip_pair && op.format == ImageStripFormat::Jpeg &&
+                      strip_queue_peek(&next_op, 1) && !next_op.region &&
+                      next_op.format == ImageStripFormat::Jpeg &&
+                      next_op.strip_index == (uint8_t)(strip_index + 1);
+    const uint8_t last_index = pair ? next_op.strip_index : strip_index;
+
+    if (pair) {
+        LOGI("Portal", "Processing strips %d-%d/%d (%u + %u bytes)", strip_index, last_index, total_strips - 1,
+             (unsigned)op.size, (unsigned)next_op.size);
+    } else {
+        LOGI("Portal", "Processing strip %d/%d (%u bytes)", strip_index, total_strips - 1, (unsigned)op.size);
+    }
+
+    if (strip_index == 0) {
+        device_telemetry_log_memory_snapshot("strip pre-decode");
+    }
+
+    // Initialize strip session on first strip
+    bool success = false;
+    bool session_ok = true;
+    if (strip_index == 0) {
+        if (!g_backend.start_strip_session) {
+            LOGE("Portal", "No strip session handler");
+            session_ok = false;
+        } else if (!g_backend.start_strip_session(op.image_width, op.image_height, op.timeout_ms, op.start_time)) {
+            LOGE("Portal", "Failed to init strip session");
+            session_ok = false;
+        }
+    }
+
+    // Decode strip
+    if (session_ok) {
+        const int64_t t0 = esp_timer_get_time();
+        success = pair ? decode_queued_pair(op, next_op) : decode_queued_op(op);
+        timing_decoded(pair ? 2 : 1, (uint32_t)(esp_timer_get_time() - t0), success,
+                       last_index == (uint8_t)(total_strips - 1));
+    } else {
+        timing_decoded(0, 0, false, true);
+    }
+
+    if (last_index == (uint8_t)(total_strips - 1)) {
+        device_telemetry_log_memory_snapshot("strip post-decode");
+    }
+
+    image_api_free((void*)strip_queue_pop());
+    if (pair) {
+        image_api_free((void*)strip_queue_pop());
+    }
+
+    if (!success) {
+        if (session_ok) {
+            LOGE("Portal", "Failed to decode strip %d", strip_index);
+            device_telemetry_log_memory_snapshot("strip decode-fail");
+        }
+        // Strips already queued behind a failure belong to the same broken image.
+        strip_queue_clear();
+        if (g_backend.hide_current_image) {
+            g_backend.hide_current_image();
+        }
+    } else if (last_index == total_strips - 1) {
+        LOGI("Portal", "\u2713 All %d strips decoded", total_strips);
+    }
+}
+
 void image_api_process_pending(bool ota_in_progress) {
     static unsigned long last_processed_id = 0;
 
+    // OTA needs the internal heap a parked TLS session holds.
+    if (ota_in_progress) {
+        image_http_pool_close_idle();
+    } else {
+        image_http_pool_sweep();
+    }
+
     // Reclaim memory from interrupted uploads.
     // AsyncWebServer may stop calling the upload handlers if the client disconnects mid-transfer.
     if (upload_state == UPLOAD_IN_PROGRESS && !ota_in_progress) {
@@ -1140,20 +2660,23 @@ void image_api_process_pending(bool ota_in_progress) {
                 upload_state = UPLOAD_IDLE;
             }
         }
+    }
 
-        // Strip upload stuck.
-        if (current_strip_buffer) {
-            const unsigned long elapsed = (unsigned long)(millis() - strip_upload_last_activity_ms);
-            if (elapsed > 3000UL) {
-                LOGW("IMG", "Aborting stuck strip upload; freeing buffer");
-                image_api_free((void*)current_strip_buffer);
-                current_strip_buffer = nullptr;
-                current_strip_size = 0;
-                upload_state = UPLOAD_IDLE;
-            }
+    // Strip upload stuck (strips never move upload_state; they go through strip_queue).
+    if (current_strip_buffer && !ota_in_progress) {
+        const unsigned long elapsed = (unsigned long)(millis() - strip_upload_last_activity_ms);
+        if (elapsed > 3000UL) {
+            LOGW("IMG", "Aborting stuck strip upload; freeing buffer");
+            image_api_free((void*)current_strip_buffer);
+            current_strip_buffer = nullptr;
+            current_strip_size = 0;
         }
     }
 
+    if (!ota_in_progress) {
+        process_strip_queue();
+    }
+
     if (upload_state != UPLOAD_READY_TO_DISPLAY || ota_in_progress) {
         return;
     }
@@ -1167,12 +2690,14 @@ void image_api_process_pending(bool ota_in_progress) {
     // Handle queued HTTP(S) download
     char url_to_download[IMAGE_API_URL_MAX_LEN];
     unsigned long url_timeout_ms = 0;
+    bool url_use_cache = true;
     bool has_url_op = false;
     portENTER_CRITICAL(&pending_url_op_mux);
     if (pending_url_op.active) {
         strncpy(url_to_download, pending_url_op.url, sizeof(url_to_download));
         url_to_download[sizeof(url_to_download) - 1] = '\0';
         url_timeout_ms = pending_url_op.timeout_ms;
+        url_use_cache = pending_url_op.cache;
         pending_url_op.active = false;
         pending_url_op.url[0] = '\0';
         has_url_op = true;
@@ -1186,11 +2711,40 @@ void image_api_process_pending(bool ota_in_progress) {
         upload_state = UPLOAD_IN_PROGRESS;
 
         const unsigned long timeout_ms = url_timeout_ms;
+        char err[128];
+
+        UrlCacheCtx cache;
+        (void)url_use_cache;
+        #if IMAGE_URL_CACHE_ENABLED
+        cache.enabled = url_use_cache && image_cache_available();
+        cache.have_entry = cache.enabled && image_cache_lookup(url_to_download, &cache.validators);
+        #endif
+
+        #if IMAGE_API_URL_STREAMING
+        // Decode straight off the socket unless the active screen needs the whole
+        // JPEG in memory (LVGL image screen decodes to an lv_img buffer).
+        bool stream_ok_for_screen = true;
+        #if HAS_DISPLAY && LV_USE_IMG
+        const char* active_screen = display_manager_get_current_screen_id();
+        stream_ok_for_screen = !(active_screen && strcmp(active_screen, "lvgl_image") == 0);
+        #endif
+        if (stream_ok_for_screen && g_backend.decode_stream && g_backend.start_strip_session) {
+            const bool streamed = stream_jpeg_url_to_display(url_to_download, timeout_ms, &cache, err, sizeof(err));
+            device_telemetry_log_memory_snapshot("urlimg post-stream");
+            upload_state = UPLOAD_IDLE;
+            if (!streamed) {
+                LOGE("Portal", "URL stream failed: %s", err);
+                if (g_backend.hide_current_image) {
+                    g_backend.hide_current_image();
+                }
+            }
+            return;
+        }
+        #endif
 
         uint8_t* downloaded = nullptr;
         size_t downloaded_sz = 0;
-        char err[128];
-        const bool ok = download_jpeg_to_buffer(url_to_download, timeout_ms, &downloaded, &downloaded_sz, err, sizeof(err));
+        const bool ok = download_jpeg_to_buffer(url_to_download, timeout_ms, &cache, &downloaded, &downloaded_sz, err, sizeof(err));
 
         device_telemetry_log_memory_snapshot("urlimg post-download");
 
@@ -1221,6 +2775,7 @@ void image_api_process_pending(bool ota_in_progress) {
     // Handle dismiss operation
     if (pending_image_op.dismiss) {
         device_telemetry_log_memory_snapshot("img dismiss");
+        strip_queue_clear();
         if (g_backend.hide_current_image) {
             g_backend.hide_current_image();
         }
@@ -1229,80 +2784,6 @@ void image_api_process_pending(bool ota_in_progress) {
         return;
     }
 
-    // Handle strip operation
-    if (pending_strip_op.buffer && pending_strip_op.size > 0) {
-        const uint8_t* buf = pending_strip_op.buffer;
-        const size_t sz = pending_strip_op.size;
-        const uint8_t strip_index = pending_strip_op.strip_index;
-        const int total_strips = pending_strip_op.total_strips;
-
-        LOGI("Portal", "Processing strip %d/%d (%u bytes)", strip_index, total_strips - 1, (unsigned)sz);
-
-        if (strip_index == 0) {
-            device_telemetry_log_memory_snapshot("strip pre-decode");
-        }
-
-        // Initialize strip session on first strip
-        if (strip_index == 0) {
-            if (!g_backend.start_strip_session) {
-                LOGE("Portal", "No strip session handler");
-                if (g_backend.hide_current_image) {
-                    g_backend.hide_current_image();
-                }
-                image_api_free((void*)pending_strip_op.buffer);
-                pending_strip_op.buffer = nullptr;
-                upload_state = UPLOAD_IDLE;
-                return;
-            }
-
-            if (!g_backend.start_strip_session(pending_strip_op.image_width, pending_strip_op.image_height, 
-                                                pending_strip_op.timeout_ms, pending_strip_op.start_time)) {
-                LOGE("Portal", "Failed to init strip session");
-                if (g_backend.hide_current_image) {
-                    g_backend.hide_current_image();
-                }
-                image_api_free((void*)pending_strip_op.buffer);
-                pending_strip_op.buffer = nullptr;
-                upload_state = UPLOAD_IDLE;
-                return;
-            }
-        }
-
-        // Decode strip
-        bool success = false;
-        if (g_backend.decode_strip) {
-            #if HAS_DISPLAY
-            // Serialize with LVGL task to protect buffered backends (Arduino_GFX canvas)
-            // and prevent overlapping present()/SPI polling transactions.
-            display_manager_lock();
-            #endif
-            success = g_backend.decode_strip(buf, sz, strip_index, false);
-            #if HAS_DISPLAY
-            display_manager_unlock();
-            #endif
-        }
-
-        if (strip_index == (uint8_t)(total_strips - 1)) {
-            device_telemetry_log_memory_snapshot("strip post-decode");
-        }
-
-        image_api_free((void*)pending_strip_op.buffer);
-        pending_strip_op.buffer = nullptr;
-        pending_strip_op.size = 0;
-        upload_state = UPLOAD_IDLE;
-
-        if (!success) {
-            LOGE("Portal", "Failed to decode strip %d", strip_index);
-            device_telemetry_log_memory_snapshot("strip decode-fail");
-            if (g_backend.hide_current_image) {
-                g_backend.hide_current_image();
-            }
-        } else if (strip_index == total_strips - 1) {
-            LOGI("Portal", "\u2713 All %d strips decoded", total_strips);
-        }
-        return;
-    }
-
     // Handle full image operation (fallback for full mode)
     if (pending_image_op.buffer && pending_image_op.size > 0) {
         const uint8_t* buf = pending_image_op.buffer;
@@ -1324,8 +2805,23 @@ void image_api_process_pending(bool ota_in_progress) {
             int scale_used = -1;
             char derr[96];
 
+            // Kiosks cycle through a few fixed images: reuse an earlier decode when cached.
+            bool cached = false;
+            #if LVGL_IMAGE_CACHE_SUPPORTED
+            const LvglImageCacheKey cache_key = lvgl_image_cache_key(buf, sz);
+            const uint16_t* cached_pixels = nullptr;
+            cached = lvgl_image_cache_acquire(cache_key, &cached_pixels, &w, &h);
+            if (cached) pixels = const_cast<uint16_t*>(cached_pixels);
+            #endif
+
             // Decode without holding the LVGL mutex.
-            const bool ok = lvgl_jpeg_decode_to_rgb565(buf, sz, &pixels, &w, &h, &scale_used, derr, sizeof(derr));
+            const int64_t t0 = esp_timer_get_time();
+            const bool ok = cached || lvgl_jpeg_decode_to_rgb565(
+                buf, sz,
+                LvglImageScreen::kImageBoxPx, LvglImageScreen::kImageBoxPx,
+                &pixels, &w, &h, &scale_used, derr, sizeof(derr)
+            );
+            timing_decoded(1, (uint32_t)(esp_timer_get_time() - t0), ok, true);
             if (!ok) {
                 LOGE("Portal", "LVGL JPEG decode failed: %s", derr);
                 device_telemetry_log_memory_snapshot("img lvgl-decode-fail");
@@ -1341,17 +2837,24 @@ void image_api_process_pending(bool ota_in_progress) {
                 return;
             }
 
+            const bool from_cache = cached;
+            #if LVGL_IMAGE_CACHE_SUPPORTED
+            if (!cached) cached = lvgl_image_cache_insert(cache_key, &pixels, w, h);
+            #endif
+
             LvglImageScreen* screen = display_manager_get_lvgl_image_screen();
             bool set_ok = false;
-            display_manager_lock();
-            if (screen) set_ok = screen->setImageRgb565(pixels, w, h);
+            display_manager_lock(LvglLockSite::ImageApi);
+            if (screen) set_ok = cached ? screen->setImageCachedRgb565(pixels, w, h) : screen->setImageRgb565(pixels, w, h);
             display_manager_unlock();
 
             // Helpful runtime diagnostics: show whether we decoded at reduced resolution.
             // The screen will scale this to a fixed 200x200 box via lv_img zoom.
             const int div = (scale_used >= 0 && scale_used <= 7) ? (1 << scale_used) : 0;
-            const double zoom = (double)200.0 / (double)((w > h) ? w : h);
-            if (div) {
+            const double zoom = (double)LvglImageScreen::kImageBoxPx / (double)((w > h) ? w : h);
+            if (from_cache) {
+                LOGI("Portal", "LVGL img: w=%d h=%d (cached decode) zoom=%.2fx", w, h, zoom);
+            } else if (div) {
                 LOGI(
                     "Portal",
                     "LVGL img: w=%d h=%d scale=%d div=%d zoom=%.2fx",
@@ -1373,7 +2876,14 @@ void image_api_process_pending(bool ota_in_progress) {
             }
 
             if (!set_ok) {
-                heap_caps_free(pixels);
+                #if LVGL_IMAGE_CACHE_SUPPORTED
+                if (cached) {
+                    lvgl_image_cache_release(pixels);
+                } else
+                #endif
+                {
+                    image_arena_free(pixels);
+                }
                 LOGE("Portal", "Failed to set LVGL image");
 
                 image_api_free((void*)pending_image_op.buffer);
@@ -1401,14 +2911,17 @@ void image_api_process_pending(bool ota_in_progress) {
         if (g_backend.start_strip_session && g_backend.decode_strip) {
             #if HAS_DISPLAY
             // Serialize with LVGL task for the duration of the full decode.
-            display_manager_lock();
+            display_manager_lock(LvglLockSite::ImageApi);
             #endif
 
             if (!g_backend.start_strip_session(g_cfg.lcd_width, g_cfg.lcd_height, pending_image_op.timeout_ms, pending_image_op.start_time)) {
                 LOGE("Portal", "Failed to init image display");
                 success = false;
+                timing_decoded(0, 0, false, true);
             } else {
+                const int64_t t0 = esp_timer_get_time();
                 success = g_backend.decode_strip(buf, sz, 0, false);
+                timing_decoded(1, (uint32_t)(esp_timer_get_time() - t0), success, true);
             }
 
             #if HAS_DISPLAY
@@ -21,12 +21,27 @@
 class AsyncWebServer;
 class AsyncWebServerRequest;
 
+// Pull reader used by streaming decode: copy up to `len` bytes into `dst` (or skip
+// `len` bytes when dst is nullptr). Returns bytes delivered; 0 = EOF/error.
+typedef size_t (*ImageApiReadFn)(void* ctx, uint8_t* dst, size_t len);
+
 // Backend adapter interface for connecting to display system
-// Implement these three hooks to integrate with your display pipeline
+// Implement these hooks to integrate with your display pipeline
+// (decode_stream is optional; without it image_url downloads are buffered.
+//  push_rgb565_strip is optional; without it non-JPEG strip formats are rejected.
+//  begin_region is optional; without it /api/display/image/region is rejected.
+//  decode_strip_pair is optional; without it queued strips decode one at a time).
 struct ImageApiBackend {
     void (*hide_current_image)();  // Hide/dismiss current image
     bool (*start_strip_session)(int width, int height, unsigned long timeout_ms, unsigned long start_time);
     bool (*decode_strip)(const uint8_t* jpeg_data, size_t jpeg_size, uint8_t strip_index, bool output_bgr565);
+    bool (*decode_stream)(ImageApiReadFn read, void* read_ctx, bool output_bgr565);
+    // Full-width rows of wire-order RGB565 (already decompressed); may modify `pixels`.
+    bool (*push_rgb565_strip)(uint16_t* pixels, int rows, bool output_bgr565);
+    // Aim the next decode_strip/push_rgb565_strip at a panel sub-rect of the shown image.
+    bool (*begin_region)(int x, int y, int w, int h);
+    // Decode two consecutive JPEG strips in one call (parallel on dual-core targets).
+    bool (*decode_strip_pair)(const uint8_t* first, size_t first_size, const uint8_t* next, size_t next_size, bool output_bgr565);
 };
 
 // Configuration structure (can be populated from board_config.h)
@@ -47,10 +62,65 @@ void image_api_init(const ImageApiConfig& cfg, const ImageApiBackend& backend);
 //   POST   /api/display/image          - Upload full JPEG (deferred decode)
 //   POST   /api/display/image_url      - Queue HTTP/HTTPS JPEG download (deferred download+decode)
 //   DELETE /api/display/image          - Dismiss current image
-//   POST   /api/display/image/strips   - Upload JPEG strip (synchronous)
+//   POST   /api/display/image/strips   - Upload JPEG or RGB565/RLE/LZ4 strip (?format=, deferred decode)
+//   POST   /api/display/image/region   - Patch an (x, y, w, h) region of the shown image
+//   GET    /api/display/image/timing   - Receive/decode timing of the newest upload
 // auth_gate: optional hook to enforce portal auth. Return true to allow, false to deny (should send response).
 void image_api_register_routes(AsyncWebServer* server, bool (*auth_gate)(AsyncWebServerRequest* request) = nullptr);
 
+// Download a JPEG over HTTP(S) into a heap buffer (main loop only; blocks for the transfer).
+// use_cache: revalidate/serve through the FFat image cache when IMAGE_URL_CACHE_ENABLED.
+// Free the buffer with image_api_free_buffer().
+bool image_api_fetch_jpeg(const char* url, unsigned long timeout_ms, bool use_cache,
+                          uint8_t** out_buf, size_t* out_sz, char* err, size_t err_len);
+void image_api_free_buffer(void* p);
+
+// Response validators for conditional GETs (see image_api_fetch_jpeg_if_modified).
+static constexpr size_t IMAGE_API_VALIDATOR_MAX = 96;
+struct ImageApiValidators {
+    char etag[IMAGE_API_VALIDATOR_MAX];
+    char last_modified[IMAGE_API_VALIDATOR_MAX];
+};
+
+// Conditional download outside the FFat cache (main loop only). Sends the validators in
+// `v` and replaces them with the response's on a 200. A 304 succeeds with *not_modified
+// set and no buffer.
+bool image_api_fetch_jpeg_if_modified(const char* url, unsigned long timeout_ms, ImageApiValidators* v,
+                                      bool* not_modified, uint8_t** out_buf, size_t* out_sz,
+                                      char* err, size_t err_len);
+
+// Queue a buffer from image_api_fetch_* for display, as if it had been uploaded (main loop
+// only; takes ownership). timeout_ms 0 = permanent. False (buffer freed) while busy.
+// Counts as an image operation (see image_api_op_seq).
+bool image_api_show_jpeg(uint8_t* buf, size_t sz, unsigned long timeout_ms);
+
+// Queue an HTTP(S) JPEG download for display, like POST /api/display/image_url
+// (AsyncTCP task only). timeout_s < 0 = default display timeout, 0 = permanent.
+// False when the URL is empty/too long or another image operation is pending.
+bool image_api_queue_url(const char* url, long timeout_s, bool use_cache);
+
+// Long-lived HTTP(S) GET whose body is consumed incrementally (MJPEG); main loop only.
+// timeout_ms bounds connect + response headers; the body has no time limit.
+// content_type receives the response Content-Type (e.g. "multipart/x-mixed-replace;boundary=...").
+struct ImageApiHttpStream;
+ImageApiHttpStream* image_api_http_stream_open(const char* url, unsigned long timeout_ms,
+                                               char* content_type, size_t content_type_len,
+                                               char* err, size_t err_len);
+// Non-blocking: bytes copied (0 = nothing available yet), -1 once the server closed the stream.
+int image_api_http_stream_read(ImageApiHttpStream* s, uint8_t* dst, size_t len);
+void image_api_http_stream_close(ImageApiHttpStream* s);
+
+// Count a screen takeover by another image source (MJPEG) as an image operation, so the
+// slideshow yields. Returns the new image_api_op_seq().
+uint32_t image_api_claim_screen();
+
+// True while an upload, URL download or strip decode is queued or running.
+bool image_api_busy();
+
+// Incremented whenever a client queues an image operation (upload, image_url, first
+// strip, dismiss), so other image sources (slideshow) can notice they were overridden.
+uint32_t image_api_op_seq();
+
 // Process pending image operations (call from main loop)
 // ota_in_progress: true if OTA update is in progress (skips processing)
 void image_api_process_pending(bool ota_in_progress);
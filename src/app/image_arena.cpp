@@ -0,0 +1,196 @@
+#include "image_arena.h"
+
+#if HAS_IMAGE_API
+
+#include "app_alloc.h"
+#include "board_profile.h"
+#include "log_manager.h"
+
+#include <Arduino.h>
+#include <esp_heap_caps.h>
+#include <freertos/FreeRTOS.h>
+#include <freertos/portmacro.h>
+#include <soc/soc_caps.h>
+
+namespace {
+
+static constexpr uint16_t kMagic = 0x1A6E;
+static constexpr size_t kAlign = 16;
+
+// 16 bytes so payloads stay 16-byte aligned (cache lines / DMA-friendly).
+struct BlockHdr {
+    uint32_t size;       // whole block incl. header, multiple of kAlign
+    uint32_t prev_size;  // size of the physically previous block (0 = first)
+    uint16_t magic;
+    uint8_t used;
+    uint8_t reserved;
+    uint32_t reserved2;
+};
+static_assert(sizeof(BlockHdr) == kAlign, "BlockHdr must keep payload alignment");
+
+static constexpr size_t kMinSplit = sizeof(BlockHdr) * 4;
+
+static portMUX_TYPE s_mux = portMUX_INITIALIZER_UNLOCKED;
+static uint8_t* s_base = nullptr;
+static uint8_t* s_end = nullptr;
+static bool s_tried = false;
+static ImageArenaStats s_stats = {};
+
+static inline BlockHdr* hdr_at(uint8_t* p) {
+    return (BlockHdr*)p;
+}
+
+static inline BlockHdr* next_of(BlockHdr* b) {
+    uint8_t* n = (uint8_t*)b + b->size;
+    return n < s_end ? (BlockHdr*)n : nullptr;
+}
+
+static inline void set_next_prev_size(BlockHdr* b) {
+    BlockHdr* n = next_of(b);
+    if (n) n->prev_size = b->size;
+}
+
+static void init_region(uint8_t* mem, size_t bytes) {
+    s_base = mem;
+    s_end = mem + bytes;
+    BlockHdr* b = hdr_at(mem);
+    b->size = (uint32_t)bytes;
+    b->prev_size = 0;
+    b->magic = kMagic;
+    b->used = 0;
+    s_stats.capacity = (uint32_t)bytes;
+}
+
+} // namespace
+
+bool image_arena_init() {
+    if (s_tried) return s_base != nullptr;
+    s_tried = true;
+
+    uint8_t* mem = nullptr;
+    size_t bytes = 0;
+
+#if SOC_SPIRAM_SUPPORTED
+    if (IMAGE_ARENA_PSRAM_BYTES > 0 && board_psram_available()) {
+        bytes = (size_t)IMAGE_ARENA_PSRAM_BYTES & ~(kAlign - 1);
+        mem = (uint8_t*)heap_caps_aligned_alloc(kAlign, bytes, MALLOC_CAP_SPIRAM | MALLOC_CAP_8BIT);
+        s_stats.in_psram = mem != nullptr;
+    }
+#endif
+
+    // Internal fallback only for boards without PSRAM: reserve it before the heap fragments.
+    if (!mem && !s_stats.in_psram && IMAGE_ARENA_INTERNAL_BYTES > 0 && !board_psram_available()) {
+        bytes = (size_t)IMAGE_ARENA_INTERNAL_BYTES & ~(kAlign - 1);
+        mem = (uint8_t*)heap_caps_aligned_alloc(kAlign, bytes, MALLOC_CAP_INTERNAL | MALLOC_CAP_8BIT);
+    }
+
+    if (!mem) {
+        LOGW("Arena", "No image arena reserved; image buffers use the heap");
+        return false;
+    }
+
+    init_region(mem, bytes);
+    LOGI("Arena", "Reserved %u KB image arena (%s)", (unsigned)(bytes / 1024), s_stats.in_psram ? "PSRAM" : "internal");
+    return true;
+}
+
+void* image_arena_alloc(size_t size) {
+    if (size == 0) return nullptr;
+    if (!s_base) {
+        s_stats.fallbacks++;
+        return nullptr;
+    }
+
+    const size_t need = ((size + kAlign - 1) & ~(kAlign - 1)) + sizeof(BlockHdr);
+    void* out = nullptr;
+
+    portENTER_CRITICAL(&s_mux);
+    for (BlockHdr* b = hdr_at(s_base); b; b = next_of(b)) {
+        if (b->used || b->size < need) continue;
+
+        if (b->size - need >= kMinSplit) {
+            BlockHdr* rest = (BlockHdr*)((uint8_t*)b + need);
+            rest->size = (uint32_t)(b->size - need);
+            rest->prev_size = (uint32_t)need;
+            rest->magic = kMagic;
+            rest->used = 0;
+            b->size = (uint32_t)need;
+            set_next_prev_size(rest);
+        }
+        b->used = 1;
+        s_stats.used += b->size;
+        if (s_stats.used > s_stats.peak) s_stats.peak = s_stats.used;
+        out = (uint8_t*)b + sizeof(BlockHdr);
+        break;
+    }
+    if (!out) s_stats.fallbacks++;
+    portEXIT_CRITICAL(&s_mux);
+    return out;
+}
+
+bool image_arena_owns(const void* p) {
+    return s_base && (const uint8_t*)p >= s_base + sizeof(BlockHdr) && (const uint8_t*)p < s_end;
+}
+
+void image_arena_free(void* p) {
+    if (!p) return;
+    if (!image_arena_owns(p)) {
+        // Heap fallbacks all come from app_alloc(AllocTag::Image, ...).
+        app_free(AllocTag::Image, p);
+        return;
+    }
+
+    BlockHdr* b = (BlockHdr*)((uint8_t*)p - sizeof(BlockHdr));
+    portENTER_CRITICAL(&s_mux);
+    if (b->magic != kMagic || !b->used) {
+        portEXIT_CRITICAL(&s_mux);
+        LOGE("Arena", "Bad free %p", p);
+        return;
+    }
+
+    b->used = 0;
+    s_stats.used -= b->size;
+
+    // Coalesce forward, then backward: boundary tags make both O(1).
+    BlockHdr* n = next_of(b);
+    if (n && !n->used) {
+        b->size += n->size;
+        n->magic = 0;
+    }
+    if (b->prev_size) {
+        BlockHdr* prev = (BlockHdr*)((uint8_t*)b - b->prev_size);
+        if (!prev->used) {
+            prev->size += b->size;
+            b->magic = 0;
+            b = prev;
+        }
+    }
+    set_next_prev_size(b);
+    portEXIT_CRITICAL(&s_mux);
+}
+
+bool image_arena_can_fit(size_t size) {
+    if (!s_base || size == 0) return false;
+    const size_t need = ((size + kAlign - 1) & ~(kAlign - 1)) + sizeof(BlockHdr);
+    bool fits = false;
+    portENTER_CRITICAL(&s_mux);
+    for (BlockHdr* b = hdr_at(s_base); b && !fits; b = next_of(b)) {
+        fits = !b->used && b->size >= need;
+    }
+    portEXIT_CRITICAL(&s_mux);
+    return fits;
+}
+
+void image_arena_get_stats(ImageArenaStats* out) {
+    if (!out) return;
+    portENTER_CRITICAL(&s_mux);
+    *out = s_stats;
+    uint32_t largest = 0;
+    for (BlockHdr* b = s_base ? hdr_at(s_base) : nullptr; b; b = next_of(b)) {
+        if (!b->used && b->size > largest) largest = b->size;
+    }
+    portEXIT_CRITICAL(&s_mux);
+    out->largest_free = largest > sizeof(BlockHdr) ? largest - (uint32_t)sizeof(BlockHdr) : 0;
+}
+
+#endif // HAS_IMAGE_API
@@ -0,0 +1,48 @@
+#pragma once
+
+#include "board_config.h"
+
+#if HAS_IMAGE_API
+
+#include <stddef.h>
+#include <stdint.h>
+
+// Boot-time arena for image buffers (uploads, strips, URL downloads, decode outputs).
+//
+// One region is reserved when image_api_init() runs: IMAGE_ARENA_PSRAM_BYTES in PSRAM,
+// or IMAGE_ARENA_INTERNAL_BYTES of internal RAM on boards without PSRAM (off by default,
+// so no-PSRAM boards keep using the heap unless they opt in). Blocks carry
+// boundary tags, so free() coalesces with both neighbours in O(1); allocation is a
+// first-fit walk over the handful of live blocks. Because these buffers never come
+// from the general heap, days of uploads cannot fragment it.
+//
+// Requests the arena cannot satisfy return nullptr; callers fall back to heap_caps_malloc.
+// Thread-safe (AsyncTCP handlers and the main loop allocate concurrently).
+
+struct ImageArenaStats {
+    bool in_psram;
+    uint32_t capacity;
+    uint32_t used;
+    uint32_t peak;
+    uint32_t largest_free;
+    uint32_t fallbacks;    // requests that had to go to the heap
+};
+
+// Reserve the region (idempotent). False when nothing could be reserved.
+bool image_arena_init();
+
+// nullptr when the arena is missing or full (the miss is counted as a fallback).
+void* image_arena_alloc(size_t size);
+
+// Free a block from image_arena_alloc() *or* any heap_caps allocation (nullptr is a no-op),
+// so buffers that may have fallen back to the heap have a single release path.
+void image_arena_free(void* p);
+
+bool image_arena_owns(const void* p);
+
+// True if a block of `size` bytes would currently fit (a hint; another task may race).
+bool image_arena_can_fit(size_t size);
+
+void image_arena_get_stats(ImageArenaStats* out);
+
+#endif // HAS_IMAGE_API
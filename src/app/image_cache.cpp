@@ -0,0 +1,391 @@
+#include "image_cache.h"
+
+#if HAS_IMAGE_API && IMAGE_URL_CACHE_ENABLED
+
+#include "fs_health.h"
+#include "log_manager.h"
+
+#include <FFat.h>
+
+namespace {
+
+static constexpr const char* kDir = "/imgcache";
+static constexpr uint32_t kMetaMagic = 0x31434D49;  // "IMC1"
+
+// On-flash entry metadata (<hash>.met).
+struct ImageCacheMeta {
+    uint32_t magic;
+    uint32_t seq;       // LRU clock: higher = used more recently
+    uint32_t size;
+    char url[IMAGE_CACHE_URL_MAX];
+    char etag[IMAGE_CACHE_VALIDATOR_MAX];
+    char last_modified[IMAGE_CACHE_VALIDATOR_MAX];
+};
+
+struct IndexEntry {
+    uint32_t hash;
+    uint32_t size;
+    uint32_t seq;
+    bool used;
+    bool dirty;         // seq bumped by a hit but not yet written to <hash>.met
+};
+
+static bool g_tried = false;
+static bool g_mounted = false;
+static IndexEntry g_index[IMAGE_URL_CACHE_MAX_ENTRIES] = {};
+static uint32_t g_seq = 0;
+static ImageCacheStats g_stats = {};
+
+static uint32_t url_hash(const char* url) {
+    // FNV-1a; collisions are caught by comparing the URL stored in the meta file.
+    uint32_t h = 2166136261u;
+    for (const char* p = url; *p; p++) {
+        h ^= (uint8_t)*p;
+        h *= 16777619u;
+    }
+    return h;
+}
+
+static void entry_path(char* out, size_t out_len, uint32_t hash, const char* ext) {
+    snprintf(out, out_len, "%s/%08lx.%s", kDir, (unsigned long)hash, ext);
+}
+
+static IndexEntry* find_entry(uint32_t hash) {
+    for (IndexEntry& e : g_index) {
+        if (e.used && e.hash == hash) return &e;
+    }
+    return nullptr;
+}
+
+static void refresh_totals() {
+    uint16_t n = 0;
+    uint32_t bytes = 0;
+    for (const IndexEntry& e : g_index) {
+        if (!e.used) continue;
+        n++;
+        bytes += e.size;
+    }
+    g_stats.entries = n;
+    g_stats.bytes = bytes;
+    fs_health_set_ffat_usage((uint32_t)FFat.usedBytes(), (uint32_t)FFat.totalBytes());
+}
+
+static bool read_meta(uint32_t hash, ImageCacheMeta* meta) {
+    char path[40];
+    entry_path(path, sizeof(path), hash, "met");
+    File f = FFat.open(path, FILE_READ);
+    if (!f) return false;
+    const bool ok = f.read((uint8_t*)meta, sizeof(*meta)) == sizeof(*meta) && meta->magic == kMetaMagic;
+    f.close();
+    if (ok) {
+        meta->url[sizeof(meta->url) - 1] = '\0';
+        meta->etag[sizeof(meta->etag) - 1] = '\0';
+        meta->last_modified[sizeof(meta->last_modified) - 1] = '\0';
+    }
+    return ok;
+}
+
+static bool write_meta(uint32_t hash, const ImageCacheMeta& meta) {
+    char path[40];
+    entry_path(path, sizeof(path), hash, "met");
+    File f = FFat.open(path, FILE_WRITE);
+    if (!f) return false;
+    const bool ok = f.write((const uint8_t*)&meta, sizeof(meta)) == sizeof(meta);
+    f.close();
+    return ok;
+}
+
+static void remove_files(uint32_t hash) {
+    char path[40];
+    entry_path(path, sizeof(path), hash, "met");
+    FFat.remove(path);
+    entry_path(path, sizeof(path), hash, "jpg");
+    FFat.remove(path);
+}
+
+static void drop_entry(IndexEntry* e) {
+    remove_files(e->hash);
+    e->used = false;
+}
+
+// Hits only move entries in RAM; their order reaches flash on the next eviction or
+// insert, so serving from the cache never writes. A reboot before that forgets the
+// latest hits, which only makes eviction a little less exact.
+static void persist_lru() {
+    for (IndexEntry& e : g_index) {
+        if (!e.used || !e.dirty) continue;
+        ImageCacheMeta meta;
+        if (read_meta(e.hash, &meta) && meta.seq != e.seq) {
+            meta.seq = e.seq;
+            write_meta(e.hash, meta);
+        }
+        e.dirty = false;
+    }
+}
+
+static bool evict_lru() {
+    IndexEntry* victim = nullptr;
+    for (IndexEntry& e : g_index) {
+        if (e.used && (!victim || e.seq < victim->seq)) victim = &e;
+    }
+    if (!victim) return false;
+    LOGI("ImgCache", "Evict %08lx (%lu bytes)", (unsigned long)victim->hash, (unsigned long)victim->size);
+    drop_entry(victim);
+    g_stats.evictions++;
+    persist_lru();
+    return true;
+}
+
+// Scan /imgcache once after mount: rebuild the index, delete orphans and stale .tmp files.
+static void load_index() {
+    File dir = FFat.open(kDir);
+    if (!dir || !dir.isDirectory()) {
+        FFat.mkdir(kDir);
+        return;
+    }
+
+    for (File f = dir.openNextFile(); f; f = dir.openNextFile()) {
+        char name[48];
+        strlcpy(name, f.name(), sizeof(name));
+        const size_t file_size = f.size();
+        f.close();
+
+        const char* base = strrchr(name, '/');
+        base = base ? base + 1 : name;
+        const char* dot = strchr(base, '.');
+        if (!dot) continue;
+
+        char full[64];
+        snprintf(full, sizeof(full), "%s/%s", kDir, base);
+        if (strcmp(dot, ".tmp") == 0) {
+            FFat.remove(full);
+            continue;
+        }
+        if (strcmp(dot, ".met") != 0) continue;
+
+        const uint32_t hash = (uint32_t)strtoul(base, nullptr, 16);
+        ImageCacheMeta meta;
+        char body[40];
+        entry_path(body, sizeof(body), hash, "jpg");
+        if (!read_meta(hash, &meta) || file_size != sizeof(meta) || !FFat.exists(body)) {
+            remove_files(hash);
+            continue;
+        }
+
+        IndexEntry* slot = nullptr;
+        for (IndexEntry& e : g_index) {
+            if (!e.used) { slot = &e; break; }
+        }
+        if (!slot) {
+            // Table shrank since the entry was written (IMAGE_URL_CACHE_MAX_ENTRIES changed).
+            remove_files(hash);
+            continue;
+        }
+        *slot = {hash, meta.size, meta.seq, true};
+        if (meta.seq > g_seq) g_seq = meta.seq;
+    }
+    dir.close();
+}
+
+} // namespace
+
+bool image_cache_available() {
+    if (g_tried) return g_mounted;
+    g_tried = true;
+
+    FSHealthStats fs;
+    fs_health_get(&fs);
+    if (!fs.ffat_partition_present) {
+        LOGI("ImgCache", "No FFat partition; image cache disabled");
+        return false;
+    }
+
+    // Never format implicitly: the partition may hold data from other features.
+    if (!FFat.begin(false)) {
+        LOGW("ImgCache", "FFat mount failed; image cache disabled");
+        return false;
+    }
+
+    g_mounted = true;
+    g_stats.mounted = true;
+    load_index();
+    refresh_totals();
+    LOGI("ImgCache", "Mounted: %u entries, %lu bytes", (unsigned)g_stats.entries, (unsigned long)g_stats.bytes);
+    return true;
+}
+
+bool image_cache_lookup(const char* url, ImageCacheValidators* out) {
+    if (!url || !out || !image_cache_available()) return false;
+
+    const uint32_t hash = url_hash(url);
+    if (!find_entry(hash)) return false;
+
+    ImageCacheMeta meta;
+    if (!read_meta(hash, &meta) || strcmp(meta.url, url) != 0) return false;
+
+    strlcpy(out->etag, meta.etag, sizeof(out->etag));
+    strlcpy(out->last_modified, meta.last_modified, sizeof(out->last_modified));
+    out->size = meta.size;
+    return true;
+}
+
+bool image_cache_open(const char* url, File* out) {
+    if (!url || !out || !image_cache_available()) return false;
+
+    const uint32_t hash = url_hash(url);
+    IndexEntry* e = find_entry(hash);
+    if (!e) return false;
+
+    ImageCacheMeta meta;
+    if (!read_meta(hash, &meta) || strcmp(meta.url, url) != 0) return false;
+
+    char path[40];
+    entry_path(path, sizeof(path), hash, "jpg");
+    *out = FFat.open(path, FILE_READ);
+    if (!*out || out->size() != meta.size) {
+        if (*out) out->close();
+        drop_entry(e);
+        refresh_totals();
+        return false;
+    }
+
+    e->seq = ++g_seq;
+    e->dirty = true;
+    return true;
+}
+
+void image_cache_remove(const char* url) {
+    if (!url || !image_cache_available()) return;
+    IndexEntry* e = find_entry(url_hash(url));
+    if (!e) return;
+    drop_entry(e);
+    refresh_totals();
+}
+
+bool image_cache_writer_begin(ImageCacheWriter* w, const char* url, const char* etag,
+                              const char* last_modified, uint32_t size) {
+    if (!w) return false;
+    w->active = false;
+    if (!url || size == 0 || !image_cache_available()) return false;
+    if (strlen(url) >= sizeof(w->url)) return false;
+    // Without a validator the entry could never be revalidated; not worth the flash wear.
+    if ((!etag || !*etag) && (!last_modified || !*last_modified)) return false;
+    if (size > (uint32_t)IMAGE_URL_CACHE_MAX_BYTES) return false;
+
+    const uint32_t hash = url_hash(url);
+    IndexEntry* existing = find_entry(hash);
+    if (existing) drop_entry(existing);
+
+    // Make room: entry count, cache budget and actual free space on the partition.
+    auto slots_used = []() {
+        size_t n = 0;
+        for (const IndexEntry& e : g_index) n += e.used ? 1 : 0;
+        return n;
+    };
+    auto bytes_used = []() {
+        uint32_t b = 0;
+        for (const IndexEntry& e : g_index) b += e.used ? e.size : 0;
+        return b;
+    };
+    while (slots_used() >= IMAGE_URL_CACHE_MAX_ENTRIES ||
+           bytes_used() + size > (uint32_t)IMAGE_URL_CACHE_MAX_BYTES ||
+           FFat.totalBytes() - FFat.usedBytes() < (size_t)size + 8192) {
+        if (!evict_lru()) break;
+    }
+    if (FFat.totalBytes() - FFat.usedBytes() < (size_t)size + 8192) {
+        refresh_totals();
+        return false;
+    }
+
+    char path[40];
+    entry_path(path, sizeof(path), hash, "tmp");
+    w->file = FFat.open(path, FILE_WRITE);
+    if (!w->file) return false;
+
+    w->hash = hash;
+    w->expected = size;
+    w->written = 0;
+    strlcpy(w->url, url, sizeof(w->url));
+    strlcpy(w->etag, etag ? etag : "", sizeof(w->etag));
+    strlcpy(w->last_modified, last_modified ? last_modified : "", sizeof(w->last_modified));
+    w->active = true;
+    return true;
+}
+
+bool image_cache_writer_write(ImageCacheWriter* w, const uint8_t* data, size_t len) {
+    if (!w || !w->active) return false;
+    if (w->written + len > w->expected || w->file.write(data, len) != len) {
+        image_cache_writer_abort(w);
+        return false;
+    }
+    w->written += (uint32_t)len;
+    return true;
+}
+
+bool image_cache_writer_commit(ImageCacheWriter* w) {
+    if (!w || !w->active) return false;
+    w->file.close();
+    w->active = false;
+
+    char tmp[40];
+    char body[40];
+    entry_path(tmp, sizeof(tmp), w->hash, "tmp");
+    entry_path(body, sizeof(body), w->hash, "jpg");
+    if (w->written != w->expected) {
+        FFat.remove(tmp);
+        return false;
+    }
+
+    IndexEntry* slot = nullptr;
+    for (IndexEntry& e : g_index) {
+        if (!e.used) { slot = &e; break; }
+    }
+
+    ImageCacheMeta meta = {};
+    meta.magic = kMetaMagic;
+    meta.seq = ++g_seq;
+    meta.size = w->written;
+    strlcpy(meta.url, w->url, sizeof(meta.url));
+    strlcpy(meta.etag, w->etag, sizeof(meta.etag));
+    strlcpy(meta.last_modified, w->last_modified, sizeof(meta.last_modified));
+
+    FFat.remove(body);
+    if (!slot || !FFat.rename(tmp, body) || !write_meta(w->hash, meta)) {
+        FFat.remove(tmp);
+        remove_files(w->hash);
+        refresh_totals();
+        return false;
+    }
+
+    *slot = {w->hash, meta.size, meta.seq, true};
+    persist_lru();
+    g_stats.stores++;
+    refresh_totals();
+    LOGI("ImgCache", "Stored %lu bytes (%u entries, %lu bytes total)",
+         (unsigned long)meta.size, (unsigned)g_stats.entries, (unsigned long)g_stats.bytes);
+    return true;
+}
+
+void image_cache_writer_abort(ImageCacheWriter* w) {
+    if (!w || !w->active) return;
+    w->file.close();
+    w->active = false;
+    char tmp[40];
+    entry_path(tmp, sizeof(tmp), w->hash, "tmp");
+    FFat.remove(tmp);
+}
+
+void image_cache_note_hit() {
+    g_stats.hits++;
+}
+
+void image_cache_note_miss() {
+    g_stats.misses++;
+}
+
+void image_cache_get_stats(ImageCacheStats* out) {
+    if (!out) return;
+    *out = g_stats;
+}
+
+#endif // HAS_IMAGE_API && IMAGE_URL_CACHE_ENABLED
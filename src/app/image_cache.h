@@ -0,0 +1,76 @@
+#pragma once
+
+#include "board_config.h"
+
+#if HAS_IMAGE_API && IMAGE_URL_CACHE_ENABLED
+
+#include <Arduino.h>
+#include <FS.h>
+
+// Persistent LRU cache for /api/display/image_url downloads on the FFat partition.
+//
+// Entries are keyed by URL and keep the server's ETag / Last-Modified validators so
+// the next fetch can be a conditional GET; a 304 decodes straight from flash.
+// Layout: /imgcache/<fnv32(url)>.jpg (body) + .met (ImageCacheMeta). Bodies are written
+// to a .tmp file and renamed on commit, so a reset mid-download never leaves a torn entry.
+//
+// Main-loop only (not thread-safe). FFat is mounted lazily on first use.
+
+static constexpr size_t IMAGE_CACHE_URL_MAX = 256;
+static constexpr size_t IMAGE_CACHE_VALIDATOR_MAX = 96;
+
+struct ImageCacheValidators {
+    char etag[IMAGE_CACHE_VALIDATOR_MAX];
+    char last_modified[IMAGE_CACHE_VALIDATOR_MAX];
+    uint32_t size;
+};
+
+struct ImageCacheStats {
+    bool mounted;
+    uint16_t entries;
+    uint32_t bytes;
+    uint32_t hits;          // served from flash after a 304 (or offline fallback)
+    uint32_t misses;        // no entry / entry replaced by a 200
+    uint32_t stores;
+    uint32_t evictions;
+};
+
+// In-progress store of a 200 response (tee the body through write()).
+struct ImageCacheWriter {
+    File file;
+    uint32_t hash = 0;
+    uint32_t expected = 0;
+    uint32_t written = 0;
+    bool active = false;
+    char url[IMAGE_CACHE_URL_MAX];
+    char etag[IMAGE_CACHE_VALIDATOR_MAX];
+    char last_modified[IMAGE_CACHE_VALIDATOR_MAX];
+};
+
+// Mounts FFat and loads the index on first call; false if no FFat partition/mount failed.
+bool image_cache_available();
+
+// Validators of a cached entry for `url` (false = not cached).
+bool image_cache_lookup(const char* url, ImageCacheValidators* out);
+
+// Open the cached body for reading and bump its LRU position (in RAM only; the order
+// is written to flash on the next eviction or insert).
+bool image_cache_open(const char* url, File* out);
+
+// Drop an entry (e.g. it failed to decode).
+void image_cache_remove(const char* url);
+
+// Start caching a response of `size` bytes (evicts LRU entries to make room).
+// Returns false (writer stays inactive) when the body cannot be cached.
+bool image_cache_writer_begin(ImageCacheWriter* w, const char* url, const char* etag,
+                              const char* last_modified, uint32_t size);
+bool image_cache_writer_write(ImageCacheWriter* w, const uint8_t* data, size_t len);
+// Publish the entry; only succeeds when exactly `size` bytes were written.
+bool image_cache_writer_commit(ImageCacheWriter* w);
+void image_cache_writer_abort(ImageCacheWriter* w);
+
+void image_cache_note_hit();
+void image_cache_note_miss();
+void image_cache_get_stats(ImageCacheStats* out);
+
+#endif // HAS_IMAGE_API && IMAGE_URL_CACHE_ENABLED
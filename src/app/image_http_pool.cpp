@@ -0,0 +1,162 @@
+#include "image_http_pool.h"
+
+#if HAS_IMAGE_API
+
+#include "log_manager.h"
+
+#include <Arduino.h>
+#include <WiFi.h>
+#include <WiFiClientSecure.h>
+#include <esp_heap_caps.h>
+
+namespace {
+
+// Pool size 0 still needs one slot to own the in-flight client; it is just never kept.
+static constexpr size_t kSlots = IMAGE_HTTP_POOL_SIZE > 0 ? IMAGE_HTTP_POOL_SIZE : 1;
+static constexpr size_t kHostMax = 128;
+
+struct PoolSlot {
+    bool in_use = false;
+    bool parked = false;     // connected and idle
+    bool tls = false;
+    uint16_t port = 0;
+    char host[kHostMax] = {0};
+    WiFiClientSecure* secure = nullptr;
+    WiFiClient* plain = nullptr;
+    unsigned long last_used_ms = 0;
+
+    Client* client() {
+        return tls ? (Client*)secure : (Client*)plain;
+    }
+};
+
+static PoolSlot s_slots[kSlots];
+static ImageHttpPoolStats s_stats = {};
+
+static void slot_close(PoolSlot& s) {
+    Client* c = s.client();
+    if (c) c->stop();
+    s.parked = false;
+}
+
+static bool slot_matches(const PoolSlot& s, bool tls, const char* host, uint16_t port) {
+    return s.tls == tls && s.port == port && strcasecmp(s.host, host) == 0;
+}
+
+static bool over_memory_cap() {
+    return heap_caps_get_free_size(MALLOC_CAP_INTERNAL | MALLOC_CAP_8BIT) < (size_t)IMAGE_HTTP_POOL_MIN_INTERNAL_FREE;
+}
+
+} // namespace
+
+Client* image_http_pool_acquire(bool tls, const char* host, uint16_t port, bool* reused) {
+    if (reused) *reused = false;
+    if (!host || !*host || strlen(host) >= kHostMax) return nullptr;
+
+    if (WiFi.status() != WL_CONNECTED) {
+        image_http_pool_close_idle();
+    }
+
+    // Parked connection to the same origin that the server has not closed yet.
+    for (size_t i = 0; i < kSlots; i++) {
+        PoolSlot& s = s_slots[i];
+        if (s.in_use || !s.parked || !slot_matches(s, tls, host, port)) continue;
+        Client* c = s.client();
+        s.parked = false;
+        if (!c || !c->connected()) {
+            slot_close(s);
+            continue;
+        }
+        // Stray bytes from the previous response would corrupt this one.
+        while (c->available() > 0) c->read();
+        s.in_use = true;
+        s_stats.reuses++;
+        if (reused) *reused = true;
+        return c;
+    }
+
+    // Otherwise a free slot, evicting the least recently used parked one if needed.
+    PoolSlot* slot = nullptr;
+    for (size_t i = 0; i < kSlots; i++) {
+        PoolSlot& s = s_slots[i];
+        if (s.in_use) continue;
+        if (!s.parked) {
+            slot = &s;
+            break;
+        }
+        if (!slot || (long)(s.last_used_ms - slot->last_used_ms) < 0) slot = &s;
+    }
+    if (!slot) return nullptr;
+    slot_close(*slot);
+
+    slot->tls = tls;
+    slot->port = port;
+    strlcpy(slot->host, host, sizeof(slot->host));
+    if (tls && !slot->secure) {
+        slot->secure = new WiFiClientSecure();
+        slot->secure->setInsecure();
+    } else if (!tls && !slot->plain) {
+        slot->plain = new WiFiClient();
+    }
+
+    Client* c = slot->client();
+    if (!c->connect(host, port)) {
+        c->stop();
+        return nullptr;
+    }
+    slot->in_use = true;
+    s_stats.connects++;
+    return c;
+}
+
+void image_http_pool_release(Client* client, bool keep) {
+    if (!client) return;
+    for (size_t i = 0; i < kSlots; i++) {
+        PoolSlot& s = s_slots[i];
+        if (!s.in_use || s.client() != client) continue;
+        s.in_use = false;
+        s.last_used_ms = millis();
+        const bool park = keep && IMAGE_HTTP_POOL_SIZE > 0 && client->connected() && !(s.tls && over_memory_cap());
+        if (park) {
+            s.parked = true;
+        } else {
+            slot_close(s);
+        }
+        return;
+    }
+    // Not ours: close it anyway.
+    client->stop();
+}
+
+void image_http_pool_sweep() {
+    const bool wifi_up = WiFi.status() == WL_CONNECTED;
+    const bool low_mem = over_memory_cap();
+    for (size_t i = 0; i < kSlots; i++) {
+        PoolSlot& s = s_slots[i];
+        if (s.in_use || !s.parked) continue;
+        const bool expired = (unsigned long)(millis() - s.last_used_ms) >= (unsigned long)IMAGE_HTTP_POOL_IDLE_MS;
+        Client* c = s.client();
+        if (!wifi_up || expired || (s.tls && low_mem) || !c || !c->connected()) {
+            LOGD("HttpPool", "Closing idle %s:%u", s.host, (unsigned)s.port);
+            slot_close(s);
+        }
+    }
+}
+
+void image_http_pool_close_idle() {
+    for (size_t i = 0; i < kSlots; i++) {
+        PoolSlot& s = s_slots[i];
+        if (!s.in_use && s.parked) slot_close(s);
+    }
+}
+
+void image_http_pool_get_stats(ImageHttpPoolStats* out) {
+    if (!out) return;
+    *out = s_stats;
+    out->idle_open = 0;
+    for (size_t i = 0; i < kSlots; i++) {
+        if (!s_slots[i].in_use && s_slots[i].parked) out->idle_open++;
+    }
+}
+
+#endif // HAS_IMAGE_API
@@ -0,0 +1,45 @@
+#pragma once
+
+#include "board_config.h"
+
+#if HAS_IMAGE_API
+
+#include <stddef.h>
+#include <stdint.h>
+
+class Client;
+
+// Keep-alive connection pool for image_url fetches.
+//
+// Up to IMAGE_HTTP_POOL_SIZE TCP/TLS connections stay open between requests, keyed by
+// scheme + host + port, so polling the same camera every few seconds skips DNS and the
+// TLS handshake. Idle connections close after IMAGE_HTTP_POOL_IDLE_MS, on WiFi loss, or
+// straight away when internal heap drops below IMAGE_HTTP_POOL_MIN_INTERNAL_FREE
+// (each idle TLS session pins its mbedTLS buffers).
+//
+// Main loop only (image_api_process_pending / slideshow); not thread-safe.
+
+struct ImageHttpPoolStats {
+    uint32_t connects;     // fresh TCP/TLS connects
+    uint32_t reuses;       // requests served on a kept-alive connection
+    uint8_t idle_open;     // connections currently parked
+};
+
+// Connected client for host:port, reusing a parked one when possible (*reused set).
+// TLS clients do not validate certificates (same policy as before pooling).
+// nullptr when the connect fails.
+Client* image_http_pool_acquire(bool tls, const char* host, uint16_t port, bool* reused);
+
+// Hand a client back. keep: the response was fully consumed and the server allows
+// keep-alive; otherwise (or when over the memory cap) the connection is closed.
+void image_http_pool_release(Client* client, bool keep);
+
+// Close idle connections past their timeout or whose peer hung up (call periodically).
+void image_http_pool_sweep();
+
+// Close every idle connection (e.g. before OTA, to free TLS buffers).
+void image_http_pool_close_idle();
+
+void image_http_pool_get_stats(ImageHttpPoolStats* out);
+
+#endif // HAS_IMAGE_API
@@ -0,0 +1,605 @@
+#include "image_mjpeg.h"
+
+#if IMAGE_MJPEG_SUPPORTED
+
+#include "board_profile.h"
+#include "image_api.h"
+#include "jpeg_preflight.h"
+#include "display_manager.h"
+#include "display_driver.h"
+#include "screen_saver_manager.h"
+#include "screens/direct_image_screen.h"
+#include "log_manager.h"
+
+#include <Arduino.h>
+#include <ArduinoJson.h>
+#include <ESPAsyncWebServer.h>
+#include <WiFi.h>
+#include <esp_heap_caps.h>
+#include <freertos/FreeRTOS.h>
+#include <freertos/portmacro.h>
+#include <string.h>
+
+namespace {
+
+static constexpr size_t kUrlMax = 256;
+static constexpr size_t kBodyMax = 512;
+static constexpr size_t kLineMax = 128;
+static constexpr size_t kReadChunk = 1024;
+static constexpr unsigned long kConnectTimeoutMs = 8000;
+static constexpr unsigned long kFpsWindowMs = 2000;
+
+// Multipart parser: part headers are read line by line; the body is either copied
+// for Content-Length bytes or scanned to the JPEG EOI marker (FF D9).
+enum class PartState : uint8_t {
+    Headers,
+    BodyLength,
+    BodyScan,
+};
+
+// BodyScan walks the JPEG's marker segments by their lengths, so an FF D9 inside
+// one (the EXIF thumbnail in APP1 ends with its own EOI) does not end the frame.
+// Only entropy-coded data after SOS is scanned byte by byte for the real EOI.
+enum class JpegScan : uint8_t {
+    Marker,     // between segments: expecting FF xx
+    LengthHi,   // segment length, big endian, includes these two bytes
+    LengthLo,
+    Segment,    // skipping the segment payload
+    Entropy,    // scan data: FF 00 and RSTn are data, FF D9 ends the image
+};
+
+static bool (*g_auth_gate)(AsyncWebServerRequest* request) = nullptr;
+
+// Handoff from AsyncTCP handlers to the main loop.
+static portMUX_TYPE s_handoff_mux = portMUX_INITIALIZER_UNLOCKED;
+static char s_incoming_url[kUrlMax] = {0};
+static bool s_start_requested = false;
+static bool s_stop_requested = false;
+
+// POST body accumulation (tiny; static so a client disconnect cannot leak it).
+static char s_body[kBodyMax + 1];
+static size_t s_body_len = 0;
+
+// Main-loop state.
+static bool s_active = false;
+static char s_url[kUrlMax] = {0};
+static ImageApiHttpStream* s_stream = nullptr;
+static unsigned long s_reconnect_at_ms = 0;
+static uint32_t s_op_seq = 0;
+static bool s_shown = false;
+static int s_shown_w = 0;
+static int s_shown_h = 0;
+static JpegHeaderInfo s_header = {};
+static bool s_header_valid = false;
+
+// Two frame buffers: one being filled from the socket, one complete and waiting.
+static uint8_t* s_frames[2] = {nullptr, nullptr};
+static size_t s_frame_len[2] = {0, 0};
+static int s_fill = 0;        // buffer the parser writes into
+static int s_ready = -1;      // complete undecoded frame (-1 = none)
+
+static PartState s_state = PartState::Headers;
+static char s_line[kLineMax];
+static size_t s_line_len = 0;
+static bool s_in_part = false;      // saw a boundary / part header since the last body
+static size_t s_part_length = 0;    // Content-Length of the current part (0 = unknown)
+static size_t s_part_read = 0;
+static bool s_part_overflow = false;
+static uint8_t s_prev_byte = 0;
+static JpegScan s_scan = JpegScan::Marker;
+static uint8_t s_scan_marker = 0;   // marker whose segment is being read
+static uint16_t s_scan_left = 0;    // Segment bytes still to skip
+
+// Stats (single words; written by the main loop only).
+static volatile uint32_t s_frames_decoded = 0;
+static volatile uint32_t s_frames_dropped = 0;
+static volatile uint32_t s_errors = 0;
+static volatile uint16_t s_fps_x10 = 0;
+static volatile bool s_status_active = false;
+static volatile bool s_status_connected = false;
+static uint32_t s_fps_frames = 0;
+static unsigned long s_fps_window_ms = 0;
+
+static void* alloc_prefer_psram(size_t bytes) {
+    void* p = nullptr;
+    if (board_psram_available()) {
+        p = heap_caps_malloc(bytes, MALLOC_CAP_SPIRAM | MALLOC_CAP_8BIT);
+    }
+    if (!p) {
+        p = heap_caps_malloc(bytes, MALLOC_CAP_INTERNAL | MALLOC_CAP_8BIT);
+    }
+    return p;
+}
+
+static void reset_parser() {
+    s_state = PartState::Headers;
+    s_line_len = 0;
+    s_in_part = false;
+    s_part_length = 0;
+    s_part_read = 0;
+    s_part_overflow = false;
+    s_prev_byte = 0;
+    s_scan = JpegScan::Marker;
+    s_frame_len[0] = 0;
+    s_frame_len[1] = 0;
+    s_ready = -1;
+}
+
+static void disconnect() {
+    if (s_stream) {
+        image_api_http_stream_close(s_stream);
+        s_stream = nullptr;
+    }
+    s_status_connected = false;
+    reset_parser();
+}
+
+static void finish(bool hide) {
+    disconnect();
+    for (int i = 0; i < 2; i++) {
+        if (s_frames[i]) {
+            heap_caps_free(s_frames[i]);
+            s_frames[i] = nullptr;
+        }
+    }
+    if (hide && s_shown) {
+        DirectImageScreen* screen = display_manager_get_direct_image_screen();
+        if (screen) screen->end_strip_session();
+        display_manager_return_to_previous_screen();
+    }
+    s_active = false;
+    s_shown = false;
+    s_shown_w = 0;
+    s_shown_h = 0;
+    s_header_valid = false;
+    s_fps_x10 = 0;
+    s_status_active = false;
+}
+
+static void schedule_reconnect() {
+    disconnect();
+    s_reconnect_at_ms = millis() + IMAGE_MJPEG_RECONNECT_MS;
+    if (s_reconnect_at_ms == 0) s_reconnect_at_ms = 1;
+}
+
+static bool connect_stream() {
+    char err[128];
+    char content_type[IMAGE_API_VALIDATOR_MAX];
+    s_stream = image_api_http_stream_open(s_url, kConnectTimeoutMs, content_type, sizeof(content_type),
+                                          err, sizeof(err));
+    if (!s_stream) {
+        LOGW("MJPEG", "Connect failed: %s", err);
+        return false;
+    }
+    if (strncasecmp(content_type, "multipart/", 10) != 0) {
+        LOGW("MJPEG", "Not a multipart stream (%s)", content_type[0] ? content_type : "no Content-Type");
+        image_api_http_stream_close(s_stream);
+        s_stream = nullptr;
+        return false;
+    }
+    reset_parser();
+    s_status_connected = true;
+    LOGI("MJPEG", "Connected");
+    return true;
+}
+
+static void frame_complete() {
+    const int idx = s_fill;
+    const size_t len = s_frame_len[idx];
+    if (s_part_overflow || len < 4 || s_frames[idx][0] != 0xFF || s_frames[idx][1] != 0xD8) {
+        if (s_part_overflow) {
+            LOGW("MJPEG", "Frame over %u bytes skipped", (unsigned)IMAGE_MJPEG_MAX_FRAME_BYTES);
+        }
+        s_errors++;
+        s_frame_len[idx] = 0;
+        return;
+    }
+    if (s_ready >= 0) {
+        // Decode fell behind: the newer frame replaces the waiting one.
+        s_frames_dropped++;
+    }
+    s_ready = idx;
+    s_fill = 1 - idx;
+    s_frame_len[s_fill] = 0;
+}
+
+static void end_part() {
+    frame_complete();
+    s_state = PartState::Headers;
+    s_in_part = false;
+    s_part_length = 0;
+    s_part_read = 0;
+    s_part_overflow = false;
+    s_prev_byte = 0;
+    s_scan = JpegScan::Marker;
+    s_line_len = 0;
+}
+
+static void header_line() {
+    s_line[s_line_len] = '\0';
+    if (s_line_len == 0) {
+        // Blank line: end of part headers (blank lines between parts are skipped).
+        if (!s_in_part) return;
+        s_part_read = 0;
+        s_part_overflow = false;
+        s_prev_byte = 0;
+        s_scan = JpegScan::Marker;
+        s_frame_len[s_fill] = 0;
+        s_state = s_part_length > 0 ? PartState::BodyLength : PartState::BodyScan;
+        return;
+    }
+    if (s_line[0] == '-' && s_line[1] == '-') {
+        s_in_part = true;
+        s_part_length = 0;
+        return;
+    }
+    if (strncasecmp(s_line, "Content-Length:", 15) == 0) {
+        s_in_part = true;
+        s_part_length = (size_t)strtoul(s_line + 15, nullptr, 10);
+    } else if (strncasecmp(s_line, "Content-Type:", 13) == 0) {
+        s_in_part = true;
+    }
+}
+
+static void body_byte(uint8_t b) {
+    uint8_t* frame = s_frames[s_fill];
+    size_t& len = s_frame_len[s_fill];
+    if (len < IMAGE_MJPEG_MAX_FRAME_BYTES) {
+        frame[len++] = b;
+    } else {
+        s_part_overflow = true;
+    }
+}
+
+// One BodyScan byte; true at the image's EOI.
+static bool scan_byte(uint8_t b) {
+    const uint8_t prev = s_prev_byte;
+    s_prev_byte = b;
+    switch (s_scan) {
+        case JpegScan::Marker:
+            if (prev != 0xFF || b == 0xFF) return false;  // prefix or fill bytes
+            if (b == 0xD9) return true;
+            if (b == 0xD8 || b == 0x01 || (b >= 0xD0 && b <= 0xD7)) return false;  // no length
+            s_scan_marker = b;
+            s_scan = JpegScan::LengthHi;
+            return false;
+        case JpegScan::LengthHi:
+            s_scan_left = (uint16_t)(b << 8);
+            s_scan = JpegScan::LengthLo;
+            return false;
+        case JpegScan::LengthLo:
+            s_scan_left = (uint16_t)(s_scan_left | b);
+            s_scan_left = s_scan_left >= 2 ? (uint16_t)(s_scan_left - 2) : 0;
+            s_prev_byte = 0;
+            if (s_scan_left > 0) {
+                s_scan = JpegScan::Segment;
+            } else {
+                s_scan = s_scan_marker == 0xDA ? JpegScan::Entropy : JpegScan::Marker;
+            }
+            return false;
+        case JpegScan::Segment:
+            if (--s_scan_left == 0) {
+                s_prev_byte = 0;
+                s_scan = s_scan_marker == 0xDA ? JpegScan::Entropy : JpegScan::Marker;
+            }
+            return false;
+        case JpegScan::Entropy:
+            if (prev != 0xFF || b == 0xFF || b == 0x00 || (b >= 0xD0 && b <= 0xD7)) return false;
+            if (b == 0xD9) return true;
+            // Another segment (progressive scans: DHT, SOS, ...).
+            s_scan_marker = b;
+            s_scan = JpegScan::LengthHi;
+            return false;
+    }
+    return false;
+}
+
+static void parse(const uint8_t* data, size_t n) {
+    size_t i = 0;
+    while (i < n) {
+        if (s_state == PartState::Headers) {
+            const uint8_t c = data[i++];
+            if (c == '\n') {
+                header_line();
+                s_line_len = 0;
+            } else if (c != '\r' && s_line_len < kLineMax - 1) {
+                s_line[s_line_len++] = (char)c;
+            }
+            continue;
+        }
+
+        if (s_state == PartState::BodyLength) {
+            size_t take = s_part_length - s_part_read;
+            if (take > n - i) take = n - i;
+            size_t& len = s_frame_len[s_fill];
+            const size_t room = len < IMAGE_MJPEG_MAX_FRAME_BYTES ? IMAGE_MJPEG_MAX_FRAME_BYTES - len : 0;
+            const size_t copy = take < room ? take : room;
+            memcpy(s_frames[s_fill] + len, data + i, copy);
+            len += copy;
+            if (copy < take) s_part_overflow = true;
+            s_part_read += take;
+            i += take;
+            if (s_part_read >= s_part_length) end_part();
+            continue;
+        }
+
+        // BodyScan: no Content-Length, the part ends at EOI.
+        const uint8_t b = data[i++];
+        body_byte(b);
+        if (scan_byte(b)) end_part();
+    }
+}
+
+// Returns false when the stream ended or failed.
+static bool pump() {
+    static uint8_t buf[kReadChunk];
+    const unsigned long start = millis();
+    while ((unsigned long)(millis() - start) < IMAGE_MJPEG_PUMP_BUDGET_MS) {
+        const int r = image_api_http_stream_read(s_stream, buf, sizeof(buf));
+        if (r < 0) return false;
+        if (r == 0) break;
+        parse(buf, (size_t)r);
+    }
+    return true;
+}
+
+static void update_fps() {
+    const unsigned long now = millis();
+    if (s_fps_window_ms == 0) {
+        s_fps_window_ms = now;
+        s_fps_frames = 0;
+        return;
+    }
+    const unsigned long elapsed = now - s_fps_window_ms;
+    if (elapsed < kFpsWindowMs) return;
+    s_fps_x10 = (uint16_t)((s_fps_frames * 10000UL) / elapsed);
+    s_fps_frames = 0;
+    s_fps_window_ms = now;
+}
+
+static void decode_ready() {
+    const int idx = s_ready;
+    s_ready = -1;
+
+    DirectImageScreen* screen = display_manager_get_direct_image_screen();
+    DisplayDriver* drv = displayManager ? displayManager->getDriver() : nullptr;
+    if (!screen || !drv) {
+        finish(false);
+        return;
+    }
+    const int lcd_w = drv->width();
+    const int lcd_h = drv->height();
+
+    char err[96];
+    int w = 0;
+    int h = 0;
+    if (!jpeg_preflight_tjpgd_frame_cached(s_frames[idx], s_frame_len[idx], lcd_w, lcd_h,
+                                           s_header, s_header_valid, &w, &h, err, sizeof(err))) {
+        s_header_valid = false;
+        s_errors++;
+        LOGW("MJPEG", "Frame rejected: %s", err);
+        return;
+    }
+    s_header_valid = true;
+
+    if (!s_shown || w != s_shown_w || h != s_shown_h) {
+        if (!s_shown) {
+            // First frame: same wake semantics as any other image request.
+            screen_saver_manager_notify_activity(true);
+        }
+        // Gates LVGL flushes; the stream owns the screen until stopped (timeout 0).
+        // Not queued: drop this frame rather than draw under LVGL's flushes.
+        if (!display_manager_show_direct_image()) {
+            s_errors++;
+            return;
+        }
+        screen->set_timeout(0);
+        if (w < lcd_w || h < lcd_h) {
+            display_manager_lock(LvglLockSite::Mjpeg);
+            screen->clear_panel();
+            display_manager_unlock();
+        }
+        LOGI("MJPEG", "Frame size %dx%d", w, h);
+        s_shown = true;
+        s_shown_w = w;
+        s_shown_h = h;
+    }
+
+    display_manager_lock(LvglLockSite::Mjpeg);
+    bool ok = screen->begin_region((lcd_w - w) / 2, (lcd_h - h) / 2, w, h);
+    if (ok) {
+        ok = screen->decode_strip(s_frames[idx], s_frame_len[idx], 0, false);
+    }
+    display_manager_unlock();
+
+    if (!ok) {
+        s_errors++;
+        return;
+    }
+    s_frames_decoded++;
+    s_fps_frames++;
+}
+
+static bool valid_url(const char* url) {
+    if (!url) return false;
+    const size_t n = strlen(url);
+    if (n == 0 || n >= kUrlMax) return false;
+    return strncmp(url, "http://", 7) == 0 || strncmp(url, "https://", 8) == 0;
+}
+
+static void send_error(AsyncWebServerRequest* request, int code, const char* message) {
+    char resp[160];
+    snprintf(resp, sizeof(resp), "{\"success\":false,\"message\":\"%s\"}", message);
+    request->send(code, "application/json", resp);
+}
+
+// POST /api/display/mjpeg {"url":"http://camera/stream"}
+static void handleMjpegBody(AsyncWebServerRequest* request, uint8_t* data, size_t len, size_t index, size_t total) {
+    if (g_auth_gate && !g_auth_gate(request)) return;
+
+    if (index == 0) {
+        if (total == 0 || total > kBodyMax) {
+            send_error(request, 413, "Body too large");
+            return;
+        }
+        s_body_len = 0;
+    }
+    if (index != s_body_len || index + len > kBodyMax) {
+        return;
+    }
+    memcpy(s_body + index, data, len);
+    s_body_len = index + len;
+    if (s_body_len < total) return;
+    s_body[s_body_len] = '\0';
+
+    StaticJsonDocument<kBodyMax + 128> doc;
+    if (deserializeJson(doc, s_body, s_body_len)) {
+        send_error(request, 400, "Invalid JSON");
+        return;
+    }
+    const char* url = doc["url"] | "";
+    if (!valid_url(url)) {
+        send_error(request, 400, "Missing or invalid url");
+        return;
+    }
+
+    portENTER_CRITICAL(&s_handoff_mux);
+    strlcpy(s_incoming_url, url, sizeof(s_incoming_url));
+    s_start_requested = true;
+    s_stop_requested = false;
+    portEXIT_CRITICAL(&s_handoff_mux);
+
+    LOGI("MJPEG", "Stream queued");
+    request->send(200, "application/json", "{\"success\":true,\"message\":\"MJPEG stream queued\"}");
+}
+
+static void handleMjpegGet(AsyncWebServerRequest* request) {
+    if (g_auth_gate && !g_auth_gate(request)) return;
+    ImageMjpegStats st;
+    image_mjpeg_get_stats(&st);
+    char resp[224];
+    snprintf(resp, sizeof(resp),
+             "{\"active\":%s,\"connected\":%s,\"frames\":%lu,\"dropped\":%lu,\"errors\":%lu,"
+             "\"fps\":%u.%u,\"width\":%u,\"height\":%u}",
+             st.active ? "true" : "false", st.connected ? "true" : "false",
+             (unsigned long)st.frames, (unsigned long)st.dropped, (unsigned long)st.errors,
+             (unsigned)(st.fps_x10 / 10), (unsigned)(st.fps_x10 % 10),
+             (unsigned)st.width, (unsigned)st.height);
+    request->send(200, "application/json", resp);
+}
+
+static void handleMjpegDelete(AsyncWebServerRequest* request) {
+    if (g_auth_gate && !g_auth_gate(request)) return;
+    portENTER_CRITICAL(&s_handoff_mux);
+    s_start_requested = false;
+    s_stop_requested = true;
+    portEXIT_CRITICAL(&s_handoff_mux);
+    request->send(200, "application/json", "{\"success\":true,\"message\":\"MJPEG stop queued\"}");
+}
+
+} // namespace
+
+void image_mjpeg_register_routes(AsyncWebServer* server, bool (*auth_gate)(AsyncWebServerRequest* request)) {
+    g_auth_gate = auth_gate;
+    server->on(
+        "/api/display/mjpeg",
+        HTTP_POST,
+        [](AsyncWebServerRequest* request) {
+            if (g_auth_gate && !g_auth_gate(request)) return;
+        },
+        NULL,
+        handleMjpegBody
+    );
+    server->on("/api/display/mjpeg", HTTP_GET, handleMjpegGet);
+    server->on("/api/display/mjpeg", HTTP_DELETE, handleMjpegDelete);
+}
+
+void image_mjpeg_loop(bool ota_in_progress) {
+    bool start = false;
+    bool stop = false;
+    portENTER_CRITICAL(&s_handoff_mux);
+    start = s_start_requested;
+    stop = s_stop_requested;
+    if (start) strlcpy(s_url, s_incoming_url, sizeof(s_url));
+    s_start_requested = false;
+    s_stop_requested = false;
+    portEXIT_CRITICAL(&s_handoff_mux);
+
+    if (stop && s_active) {
+        LOGI("MJPEG", "Stopped");
+        finish(true);
+    }
+    if (start) {
+        // A restart keeps the direct image screen; the next frame redraws it.
+        finish(false);
+        for (int i = 0; i < 2; i++) {
+            s_frames[i] = (uint8_t*)alloc_prefer_psram(IMAGE_MJPEG_MAX_FRAME_BYTES);
+        }
+        if (!s_frames[0] || !s_frames[1]) {
+            LOGE("MJPEG", "No memory for 2x%u byte frame buffers", (unsigned)IMAGE_MJPEG_MAX_FRAME_BYTES);
+            s_errors++;
+            finish(false);
+            return;
+        }
+        s_active = true;
+        s_status_active = true;
+        s_fill = 0;
+        s_reconnect_at_ms = 0;
+        s_fps_window_ms = 0;
+        s_frames_decoded = 0;
+        s_frames_dropped = 0;
+        s_errors = 0;
+        // Counts as an image operation: a running slideshow yields to the stream.
+        s_op_seq = image_api_claim_screen();
+        return;
+    }
+    if (!s_active) return;
+
+    if (ota_in_progress) {
+        LOGI("MJPEG", "Stopped for OTA");
+        finish(true);
+        return;
+    }
+    // Another client put something on screen: it wins, the stream ends quietly.
+    if (image_api_op_seq() != s_op_seq) {
+        LOGI("MJPEG", "Overridden by another image request");
+        finish(false);
+        return;
+    }
+    if (image_api_busy()) return;
+
+    if (!s_stream) {
+        if (s_reconnect_at_ms != 0 && (long)(millis() - s_reconnect_at_ms) < 0) return;
+        if (WiFi.status() != WL_CONNECTED || !connect_stream()) {
+            s_errors++;
+            schedule_reconnect();
+            return;
+        }
+        s_reconnect_at_ms = 0;
+    }
+
+    if (!pump()) {
+        LOGW("MJPEG", "Stream closed by server");
+        s_errors++;
+        schedule_reconnect();
+        return;
+    }
+    if (s_ready >= 0) {
+        decode_ready();
+    }
+    update_fps();
+}
+
+void image_mjpeg_get_stats(ImageMjpegStats* out) {
+    if (!out) return;
+    out->active = s_status_active;
+    out->connected = s_status_connected;
+    out->frames = s_frames_decoded;
+    out->dropped = s_frames_dropped;
+    out->errors = s_errors;
+    out->fps_x10 = s_fps_x10;
+    out->width = (uint16_t)s_shown_w;
+    out->height = (uint16_t)s_shown_h;
+}
+
+#endif // IMAGE_MJPEG_SUPPORTED
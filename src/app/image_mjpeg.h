@@ -0,0 +1,55 @@
+/*
+ * MJPEG Stream Display
+ *
+ * Shows a multipart/x-mixed-replace JPEG stream (IP cameras, ESP32-CAM, motion,
+ * go2rtc, ...) from one long-lived HTTP(S) connection. Frames are decoded through
+ * the DirectImageScreen strip path, centered on the panel. The socket is pumped from
+ * the main loop into two frame buffers: when a new frame completes before the
+ * previous one was decoded, the older one is dropped, so the panel always shows the
+ * newest frame and latency never builds up.
+ *
+ * Endpoints:
+ *   POST   /api/display/mjpeg   - Start streaming {"url":"http://cam/stream"}
+ *   GET    /api/display/mjpeg   - Status (connected, frames, dropped, fps, size)
+ *   DELETE /api/display/mjpeg   - Stop and return to the previous screen
+ *
+ * Any other image request (upload, image_url, strips, slideshow, dismiss) stops the stream.
+ */
+
+#pragma once
+
+#include "board_config.h"
+
+#if HAS_DISPLAY && HAS_IMAGE_API && IMAGE_MJPEG_ENABLED
+
+#define IMAGE_MJPEG_SUPPORTED 1
+
+#include <stdint.h>
+
+class AsyncWebServer;
+class AsyncWebServerRequest;
+
+struct ImageMjpegStats {
+    bool active;
+    bool connected;
+    uint32_t frames;    // frames decoded to the panel
+    uint32_t dropped;   // complete frames replaced by a newer one before decode
+    uint32_t errors;    // connect/stream/decode failures
+    uint16_t fps_x10;   // decoded frames per second over the last window, x10
+    uint16_t width;
+    uint16_t height;
+};
+
+// auth_gate: same contract as image_api_register_routes().
+void image_mjpeg_register_routes(AsyncWebServer* server, bool (*auth_gate)(AsyncWebServerRequest* request) = nullptr);
+
+// Connect / read / decode (call from main loop, after image_api_process_pending).
+void image_mjpeg_loop(bool ota_in_progress);
+
+void image_mjpeg_get_stats(ImageMjpegStats* out);
+
+#else
+
+#define IMAGE_MJPEG_SUPPORTED 0
+
+#endif
@@ -0,0 +1,132 @@
+#include "image_refresh.h"
+
+#if IMAGE_REFRESH_SUPPORTED
+
+#include "config_manager.h"
+#include "image_api.h"
+#include "log_manager.h"
+
+#include <Arduino.h>
+#include <WiFi.h>
+#include <esp_random.h>
+#include <string.h>
+
+static const DeviceConfig* s_config = nullptr;
+
+// URL the validators/hash below belong to (a config change starts over).
+static char s_url[CONFIG_IMAGE_REFRESH_URL_MAX_LEN] = {0};
+static uint16_t s_interval_s = 0;
+static ImageApiValidators s_validators = {};
+static uint32_t s_body_hash = 0;
+static bool s_have_hash = false;
+static unsigned long s_due_ms = 0;
+static ImageRefreshStats s_stats = {};
+
+static uint32_t body_hash(const uint8_t* data, size_t len) {
+    uint32_t h = 2166136261u; // FNV-1a
+    for (size_t i = 0; i < len; i++) {
+        h ^= data[i];
+        h *= 16777619u;
+    }
+    return h;
+}
+
+// interval +/- IMAGE_REFRESH_JITTER_PCT, or a random point within the jitter span for the
+// first fetch so devices booted together spread out.
+static void schedule_next(bool first) {
+    const uint32_t interval_ms = (uint32_t)s_interval_s * 1000UL;
+    uint32_t span_ms = (uint32_t)(((uint64_t)interval_ms * IMAGE_REFRESH_JITTER_PCT) / 100);
+    if (span_ms < 1000UL) span_ms = 1000UL;
+    uint32_t delay_ms;
+    if (first) {
+        delay_ms = esp_random() % span_ms;
+    } else {
+        delay_ms = interval_ms - span_ms + (esp_random() % (2 * span_ms + 1));
+        if ((int32_t)delay_ms < (int32_t)(IMAGE_REFRESH_MIN_INTERVAL_S * 1000UL)) {
+            delay_ms = IMAGE_REFRESH_MIN_INTERVAL_S * 1000UL;
+        }
+    }
+    s_due_ms = millis() + delay_ms;
+}
+
+static void run_refresh() {
+    s_stats.fetches++;
+
+    bool not_modified = false;
+    uint8_t* buf = nullptr;
+    size_t sz = 0;
+    char err[160];
+    if (!image_api_fetch_jpeg_if_modified(s_url, 0, &s_validators, &not_modified, &buf, &sz, err, sizeof(err))) {
+        s_stats.errors++;
+        LOGW("Refresh", "Fetch failed: %s", err);
+        return;
+    }
+    if (not_modified) {
+        s_stats.not_modified++;
+        return;
+    }
+
+    const uint32_t h = body_hash(buf, sz);
+    if (s_have_hash && h == s_body_hash) {
+        // Server without validators (or one that changed them) sent the same bytes.
+        s_stats.unchanged++;
+        image_api_free_buffer(buf);
+        return;
+    }
+
+    if (!image_api_show_jpeg(buf, sz, (unsigned long)IMAGE_REFRESH_DISPLAY_TIMEOUT_S * 1000UL)) {
+        // Busy with a client request; forget the validators so the next tick refetches.
+        s_validators = {};
+        LOGW("Refresh", "Image API busy; retrying next interval");
+        return;
+    }
+    s_body_hash = h;
+    s_have_hash = true;
+    s_stats.redraws++;
+    LOGI("Refresh", "New image (%u bytes)", (unsigned)sz);
+}
+
+void image_refresh_init(const DeviceConfig* config) {
+    s_config = config;
+}
+
+void image_refresh_loop(bool ota_in_progress) {
+    if (!s_config || ota_in_progress) return;
+
+    const char* url = s_config->image_refresh_url;
+    uint16_t interval_s = s_config->image_refresh_interval_seconds;
+    if (!url[0] || interval_s == 0) {
+        s_url[0] = '\0';
+        return;
+    }
+    if (interval_s < IMAGE_REFRESH_MIN_INTERVAL_S) interval_s = IMAGE_REFRESH_MIN_INTERVAL_S;
+
+    if (strcmp(url, s_url) != 0 || interval_s != s_interval_s) {
+        const bool url_changed = strcmp(url, s_url) != 0;
+        strlcpy(s_url, url, sizeof(s_url));
+        s_interval_s = interval_s;
+        if (url_changed) {
+            s_validators = {};
+            s_have_hash = false;
+        }
+        LOGI("Refresh", "Every %us: %s", (unsigned)s_interval_s, s_url);
+        schedule_next(true);
+        return;
+    }
+
+    if ((long)(millis() - s_due_ms) < 0) return;
+    if (WiFi.status() != WL_CONNECTED || image_api_busy()) {
+        s_due_ms = millis() + 1000UL;
+        return;
+    }
+
+    run_refresh();
+    schedule_next(false);
+}
+
+void image_refresh_get_stats(ImageRefreshStats* out) {
+    if (!out) return;
+    *out = s_stats;
+}
+
+#endif // IMAGE_REFRESH_SUPPORTED
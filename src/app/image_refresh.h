@@ -0,0 +1,46 @@
+/*
+ * Scheduled Image Refresh
+ *
+ * Device-side replacement for an external scheduler POSTing /api/display/image_url:
+ * every image_refresh_interval_seconds (config) the device fetches image_refresh_url
+ * with If-None-Match / If-Modified-Since. A 304, or a 200 whose body hashes the same as
+ * the image last drawn, skips the decode and redraw. Each interval is jittered by
+ * +/- IMAGE_REFRESH_JITTER_PCT so a fleet does not fetch in lockstep.
+ *
+ * Other image requests still take the screen; the refreshed image comes back the next
+ * time its content changes.
+ */
+
+#pragma once
+
+#include "board_config.h"
+
+#if HAS_DISPLAY && HAS_IMAGE_API
+
+#define IMAGE_REFRESH_SUPPORTED 1
+
+#include <stdint.h>
+
+struct DeviceConfig;
+
+struct ImageRefreshStats {
+    uint32_t fetches;
+    uint32_t not_modified;   // 304 responses
+    uint32_t unchanged;      // 200 with the same body hash
+    uint32_t redraws;
+    uint32_t errors;
+};
+
+// config is read live, so URL/interval changes from /api/config apply on the next tick.
+void image_refresh_init(const DeviceConfig* config);
+
+// Run a due refresh (call from main loop, after image_api_process_pending).
+void image_refresh_loop(bool ota_in_progress);
+
+void image_refresh_get_stats(ImageRefreshStats* out);
+
+#else
+
+#define IMAGE_REFRESH_SUPPORTED 0
+
+#endif
@@ -0,0 +1,470 @@
+#include "image_slideshow.h"
+
+#if IMAGE_SLIDESHOW_SUPPORTED
+
+#include "board_profile.h"
+#include "image_api.h"
+#include "display_manager.h"
+#include "display_driver.h"
+#include "screen_saver_manager.h"
+#include "screens/direct_image_screen.h"
+#include "log_manager.h"
+#include "psram_json_allocator.h"
+#include "image_arena.h"
+
+#include <Arduino.h>
+#include <ArduinoJson.h>
+#include <ESPAsyncWebServer.h>
+#include <esp_heap_caps.h>
+#include <freertos/FreeRTOS.h>
+#include <freertos/portmacro.h>
+#include <string.h>
+
+namespace {
+
+static constexpr size_t kUrlMax = 256;
+
+enum class SlideTransition : uint8_t {
+    Cut = 0,   // whole frame in one blit
+    Wipe = 1,  // top-to-bottom in IMAGE_SLIDESHOW_WIPE_STEPS bands
+};
+
+struct SlideItem {
+    char url[kUrlMax];
+    uint32_t dwell_ms;
+    SlideTransition transition;
+};
+
+struct Playlist {
+    uint8_t count;
+    bool loop;
+    bool cache;
+    SlideItem items[IMAGE_SLIDESHOW_MAX_ITEMS];
+};
+
+static bool (*g_auth_gate)(AsyncWebServerRequest* request) = nullptr;
+
+// Handoff from AsyncTCP handlers to the main loop.
+static portMUX_TYPE s_handoff_mux = portMUX_INITIALIZER_UNLOCKED;
+static Playlist* s_incoming = nullptr;
+static bool s_stop_requested = false;
+
+// POST body accumulation (allocated once; a client disconnect cannot leak it).
+static char* s_body = nullptr;
+static size_t s_body_len = 0;
+
+// Main-loop state.
+static Playlist* s_playlist = nullptr;
+static int s_shown = -1;              // item on screen (-1 = none yet)
+static int s_next = 0;                // item s_frame belongs to (-1 = playlist finished)
+static uint16_t* s_frame = nullptr;   // panel-sized, lv_color_t layout (PSRAM when available)
+static int s_frame_w = 0;
+static int s_frame_h = 0;
+static bool s_frame_ready = false;
+static unsigned long s_shown_at_ms = 0;
+static uint32_t s_op_seq = 0;
+static int s_wipe_row = -1;           // >= 0 while a wipe is running
+static unsigned long s_wipe_step_ms = 0;
+static uint8_t s_failures = 0;        // consecutive prefetch failures
+static unsigned long s_retry_at_ms = 0;
+
+// Snapshot for GET (single words; written by the main loop only).
+static volatile bool s_status_active = false;
+static volatile int s_status_index = -1;
+static volatile int s_status_count = 0;
+static volatile bool s_status_next_ready = false;
+
+static void* alloc_prefer_psram(size_t bytes) {
+    void* p = nullptr;
+    if (board_psram_available()) {
+        p = heap_caps_malloc(bytes, MALLOC_CAP_SPIRAM | MALLOC_CAP_8BIT);
+    }
+    if (!p) {
+        p = heap_caps_malloc(bytes, MALLOC_CAP_INTERNAL | MALLOC_CAP_8BIT);
+    }
+    return p;
+}
+
+static int advance(int index) {
+    if (!s_playlist) return -1;
+    if (index + 1 < s_playlist->count) return index + 1;
+    return s_playlist->loop ? 0 : -1;
+}
+
+static void publish_status() {
+    s_status_active = s_playlist != nullptr;
+    s_status_index = s_shown;
+    s_status_count = s_playlist ? s_playlist->count : 0;
+    s_status_next_ready = s_frame_ready;
+}
+
+static void finish(bool hide) {
+    if (s_playlist) {
+        heap_caps_free(s_playlist);
+        s_playlist = nullptr;
+    }
+    if (s_frame) {
+        heap_caps_free(s_frame);
+        s_frame = nullptr;
+    }
+    s_frame_ready = false;
+    s_shown = -1;
+    s_next = 0;
+    s_wipe_row = -1;
+    s_failures = 0;
+    if (hide) {
+        display_manager_return_to_previous_screen();
+    }
+    publish_status();
+}
+
+// Download + decode item `index` into s_frame (center-cropped/black-padded to the panel).
+static bool prefetch(int index) {
+    const SlideItem& item = s_playlist->items[index];
+    DisplayDriver* drv = displayManager ? displayManager->getDriver() : nullptr;
+    if (!drv) return false;
+
+    const int lcd_w = drv->width();
+    const int lcd_h = drv->height();
+    if (!s_frame || s_frame_w != lcd_w || s_frame_h != lcd_h) {
+        if (s_frame) heap_caps_free(s_frame);
+        s_frame = (uint16_t*)alloc_prefer_psram((size_t)lcd_w * lcd_h * sizeof(uint16_t));
+        s_frame_w = s_frame ? lcd_w : 0;
+        s_frame_h = s_frame ? lcd_h : 0;
+        if (!s_frame) {
+            LOGE("Slides", "No memory for %dx%d frame", lcd_w, lcd_h);
+            return false;
+        }
+    }
+
+    char err[128];
+    uint8_t* jpeg = nullptr;
+    size_t jpeg_sz = 0;
+    const unsigned long t0 = millis();
+    if (!image_api_fetch_jpeg(item.url, 0, s_playlist->cache, &jpeg, &jpeg_sz, err, sizeof(err))) {
+        LOGW("Slides", "Fetch %d failed: %s", index, err);
+        return false;
+    }
+
+    uint16_t* pixels = nullptr;
+    int w = 0;
+    int h = 0;
+    int scale = -1;
+    const bool ok = lvgl_jpeg_decode_to_rgb565(jpeg, jpeg_sz, lcd_w, lcd_h, &pixels, &w, &h, &scale, err, sizeof(err));
+    image_api_free_buffer(jpeg);
+    if (!ok) {
+        LOGW("Slides", "Decode %d failed: %s", index, err);
+        return false;
+    }
+
+    // Compose into the panel frame so every blit covers the whole screen.
+    memset(s_frame, 0, (size_t)lcd_w * lcd_h * sizeof(uint16_t));
+    const int src_x = w > lcd_w ? (w - lcd_w) / 2 : 0;
+    const int src_y = h > lcd_h ? (h - lcd_h) / 2 : 0;
+    const int dst_x = w < lcd_w ? (lcd_w - w) / 2 : 0;
+    const int dst_y = h < lcd_h ? (lcd_h - h) / 2 : 0;
+    const int copy_w = w < lcd_w ? w : lcd_w;
+    const int copy_h = h < lcd_h ? h : lcd_h;
+    for (int y = 0; y < copy_h; y++) {
+        memcpy(s_frame + (size_t)(dst_y + y) * lcd_w + dst_x,
+               pixels + (size_t)(src_y + y) * w + src_x,
+               (size_t)copy_w * sizeof(uint16_t));
+    }
+    image_arena_free(pixels);
+
+    LOGI("Slides", "Prefetched %d/%d (%u bytes, scale %d) in %lums",
+         index, s_playlist->count - 1, (unsigned)jpeg_sz, scale, (unsigned long)(millis() - t0));
+    return true;
+}
+
+static void slide_shown() {
+    s_shown = s_next;
+    s_shown_at_ms = millis();
+    s_frame_ready = false;
+    s_wipe_row = -1;
+    s_next = advance(s_shown);
+}
+
+static bool blit_rows(int first_row, int rows) {
+    DirectImageScreen* screen = display_manager_get_direct_image_screen();
+    if (!screen) return false;
+    display_manager_lock(LvglLockSite::Slideshow);
+    const bool ok = screen->blit_rgb565(s_frame, s_frame_w, s_frame_h, first_row, rows);
+    display_manager_unlock();
+    return ok;
+}
+
+static void begin_transition() {
+    DirectImageScreen* screen = display_manager_get_direct_image_screen();
+    if (!screen) {
+        finish(false);
+        return;
+    }
+    if (s_shown < 0) {
+        // First slide: same wake semantics as any other image request.
+        screen_saver_manager_notify_activity(true);
+    }
+    // Gates LVGL flushes immediately; the slideshow owns dwell timing (timeout 0).
+    if (!display_manager_show_direct_image()) {
+        finish(false);
+        return;
+    }
+    screen->set_timeout(0);
+
+    if (s_playlist->items[s_next].transition == SlideTransition::Wipe) {
+        s_wipe_row = 0;
+        s_wipe_step_ms = 0;  // first band right away
+        return;
+    }
+    blit_rows(0, s_frame_h);
+    slide_shown();
+}
+
+static void step_wipe() {
+    const unsigned long now = millis();
+    if (s_wipe_step_ms != 0 && (unsigned long)(now - s_wipe_step_ms) < IMAGE_SLIDESHOW_WIPE_STEP_MS) return;
+    s_wipe_step_ms = now ? now : 1;
+
+    const int band = (s_frame_h + IMAGE_SLIDESHOW_WIPE_STEPS - 1) / IMAGE_SLIDESHOW_WIPE_STEPS;
+    blit_rows(s_wipe_row, band);
+    s_wipe_row += band;
+    if (s_wipe_row >= s_frame_h) {
+        slide_shown();
+    }
+}
+
+static bool parse_transition(const char* name, SlideTransition* out) {
+    if (!name || !*name || strcmp(name, "cut") == 0 || strcmp(name, "none") == 0) {
+        *out = SlideTransition::Cut;
+        return true;
+    }
+    if (strcmp(name, "wipe") == 0) {
+        *out = SlideTransition::Wipe;
+        return true;
+    }
+    return false;
+}
+
+static bool valid_url(const char* url) {
+    if (!url) return false;
+    const size_t n = strlen(url);
+    if (n == 0 || n >= kUrlMax) return false;
+    return strncmp(url, "http://", 7) == 0 || strncmp(url, "https://", 8) == 0;
+}
+
+static void send_error(AsyncWebServerRequest* request, int code, const char* message) {
+    char resp[160];
+    snprintf(resp, sizeof(resp), "{\"success\":false,\"message\":\"%s\"}", message);
+    request->send(code, "application/json", resp);
+}
+
+// POST /api/display/slideshow
+// {"items":[{"url":"...","dwell":10,"transition":"wipe"}, "https://..."], "dwell":10,
+//  "transition":"cut", "loop":true, "cache":true}
+static void handleSlideshowBody(AsyncWebServerRequest* request, uint8_t* data, size_t len, size_t index, size_t total) {
+    if (g_auth_gate && !g_auth_gate(request)) return;
+
+    if (index == 0) {
+        if (total == 0 || total > IMAGE_SLIDESHOW_BODY_MAX) {
+            send_error(request, 413, "Body too large");
+            return;
+        }
+        if (!s_body) {
+            s_body = (char*)alloc_prefer_psram(IMAGE_SLIDESHOW_BODY_MAX + 1);
+            if (!s_body) {
+                send_error(request, 507, "Out of memory");
+                return;
+            }
+        }
+        s_body_len = 0;
+    }
+    if (!s_body || index != s_body_len || index + len > IMAGE_SLIDESHOW_BODY_MAX) {
+        return;
+    }
+    memcpy(s_body + index, data, len);
+    s_body_len = index + len;
+    if (s_body_len < total) return;
+    s_body[s_body_len] = '\0';
+
+    BasicJsonDocument<PsramJsonAllocator> doc(IMAGE_SLIDESHOW_BODY_MAX + 1024);
+    if (deserializeJson(doc, s_body, s_body_len)) {
+        send_error(request, 400, "Invalid JSON");
+        return;
+    }
+
+    JsonArrayConst items = doc["items"].as<JsonArrayConst>();
+    if (items.isNull() || items.size() == 0) {
+        send_error(request, 400, "Missing items");
+        return;
+    }
+    if (items.size() > IMAGE_SLIDESHOW_MAX_ITEMS) {
+        send_error(request, 400, "Too many items");
+        return;
+    }
+
+    const uint32_t default_dwell_s = doc["dwell"] | (uint32_t)IMAGE_SLIDESHOW_DEFAULT_DWELL_S;
+    SlideTransition default_transition;
+    if (!parse_transition(doc["transition"] | "cut", &default_transition)) {
+        send_error(request, 400, "Unknown transition");
+        return;
+    }
+
+    Playlist* pl = (Playlist*)alloc_prefer_psram(sizeof(Playlist));
+    if (!pl) {
+        send_error(request, 507, "Out of memory");
+        return;
+    }
+    memset(pl, 0, sizeof(*pl));
+    pl->loop = doc["loop"] | true;
+    pl->cache = doc["cache"] | true;
+
+    for (JsonVariantConst v : items) {
+        SlideItem& item = pl->items[pl->count];
+        const char* url = v.is<const char*>() ? v.as<const char*>() : (v["url"] | "");
+        uint32_t dwell_s = v.is<const char*>() ? default_dwell_s : (v["dwell"] | default_dwell_s);
+        SlideTransition transition = default_transition;
+        if (!valid_url(url) ||
+            (!v.is<const char*>() && !v["transition"].isNull() && !parse_transition(v["transition"] | "", &transition))) {
+            heap_caps_free(pl);
+            send_error(request, 400, "Invalid item");
+            return;
+        }
+        if (dwell_s < 1) dwell_s = 1;
+        if (dwell_s > 86400) dwell_s = 86400;
+        strlcpy(item.url, url, sizeof(item.url));
+        item.dwell_ms = dwell_s * 1000UL;
+        item.transition = transition;
+        pl->count++;
+    }
+
+    Playlist* replaced = nullptr;
+    portENTER_CRITICAL(&s_handoff_mux);
+    replaced = s_incoming;
+    s_incoming = pl;
+    s_stop_requested = false;
+    portEXIT_CRITICAL(&s_handoff_mux);
+    if (replaced) heap_caps_free(replaced);
+
+    LOGI("Slides", "Playlist queued (%u items, loop=%d)", (unsigned)pl->count, pl->loop ? 1 : 0);
+    char resp[96];
+    snprintf(resp, sizeof(resp), "{\"success\":true,\"count\":%u}", (unsigned)pl->count);
+    request->send(200, "application/json", resp);
+}
+
+static void handleSlideshowGet(AsyncWebServerRequest* request) {
+    if (g_auth_gate && !g_auth_gate(request)) return;
+    char resp[128];
+    snprintf(resp, sizeof(resp), "{\"active\":%s,\"index\":%d,\"count\":%d,\"next_ready\":%s}",
+             s_status_active ? "true" : "false", (int)s_status_index, (int)s_status_count,
+             s_status_next_ready ? "true" : "false");
+    request->send(200, "application/json", resp);
+}
+
+static void handleSlideshowDelete(AsyncWebServerRequest* request) {
+    if (g_auth_gate && !g_auth_gate(request)) return;
+    Playlist* dropped = nullptr;
+    portENTER_CRITICAL(&s_handoff_mux);
+    dropped = s_incoming;
+    s_incoming = nullptr;
+    s_stop_requested = true;
+    portEXIT_CRITICAL(&s_handoff_mux);
+    if (dropped) heap_caps_free(dropped);
+    request->send(200, "application/json", "{\"success\":true,\"message\":\"Slideshow stop queued\"}");
+}
+
+} // namespace
+
+void image_slideshow_register_routes(AsyncWebServer* server, bool (*auth_gate)(AsyncWebServerRequest* request)) {
+    g_auth_gate = auth_gate;
+    server->on(
+        "/api/display/slideshow",
+        HTTP_POST,
+        [](AsyncWebServerRequest* request) {
+            if (g_auth_gate && !g_auth_gate(request)) return;
+        },
+        NULL,
+        handleSlideshowBody
+    );
+    server->on("/api/display/slideshow", HTTP_GET, handleSlideshowGet);
+    server->on("/api/display/slideshow", HTTP_DELETE, handleSlideshowDelete);
+}
+
+void image_slideshow_loop(bool ota_in_progress) {
+    Playlist* incoming = nullptr;
+    bool stop = false;
+    portENTER_CRITICAL(&s_handoff_mux);
+    incoming = s_incoming;
+    s_incoming = nullptr;
+    stop = s_stop_requested;
+    s_stop_requested = false;
+    portEXIT_CRITICAL(&s_handoff_mux);
+
+    if (stop) {
+        if (s_playlist) {
+            LOGI("Slides", "Stopped");
+            finish(s_shown >= 0);
+        }
+    }
+    if (incoming) {
+        finish(false);
+        s_playlist = incoming;
+        s_op_seq = image_api_claim_screen();  // a running MJPEG stream yields
+        s_retry_at_ms = 0;
+        publish_status();
+        return;
+    }
+    if (!s_playlist || ota_in_progress) return;
+
+    // Another client put something on screen: it wins, the playlist ends quietly.
+    if (image_api_op_seq() != s_op_seq) {
+        LOGI("Slides", "Overridden by another image request");
+        finish(false);
+        return;
+    }
+    if (image_api_busy()) return;
+
+    if (s_wipe_row >= 0) {
+        step_wipe();
+        publish_status();
+        return;
+    }
+
+    const unsigned long now = millis();
+    const bool dwell_elapsed = s_shown < 0 ||
+        (unsigned long)(now - s_shown_at_ms) >= s_playlist->items[s_shown].dwell_ms;
+
+    if (s_next < 0) {
+        // Non-looping playlist: the last slide stays for its dwell, then we leave.
+        if (dwell_elapsed) {
+            LOGI("Slides", "Playlist finished");
+            finish(true);
+        }
+        return;
+    }
+
+    // One heavy step per call: prefetch now, transition on a later tick.
+    if (!s_frame_ready) {
+        if (s_retry_at_ms != 0 && (long)(now - s_retry_at_ms) < 0) return;
+        if (prefetch(s_next)) {
+            s_frame_ready = true;
+            s_failures = 0;
+            s_retry_at_ms = 0;
+        } else if (++s_failures >= s_playlist->count) {
+            // Every item failed in a row: back off instead of hammering the servers.
+            s_failures = 0;
+            s_retry_at_ms = now + IMAGE_SLIDESHOW_RETRY_MS;
+            if (s_retry_at_ms == 0) s_retry_at_ms = 1;
+        } else {
+            s_next = advance(s_next);
+        }
+        publish_status();
+        return;
+    }
+
+    if (dwell_elapsed) {
+        begin_transition();
+        publish_status();
+    }
+}
+
+#endif // IMAGE_SLIDESHOW_SUPPORTED
@@ -0,0 +1,39 @@
+/*
+ * Image Slideshow
+ *
+ * Device-side playlist of image URLs with per-slide dwell time and transition.
+ * While one slide is on screen the next one is downloaded (through the image_url
+ * FFat cache when available) and pre-decoded into a panel-sized RGB565 frame in
+ * PSRAM, so the switch is a single blit instead of download + decode.
+ *
+ * Endpoints:
+ *   POST   /api/display/slideshow   - Start a playlist (replaces any running one)
+ *   GET    /api/display/slideshow   - Playlist status
+ *   DELETE /api/display/slideshow   - Stop and return to the previous screen
+ *
+ * Any other image request (upload, image_url, strips, dismiss) stops the slideshow.
+ */
+
+#pragma once
+
+#include "board_config.h"
+#include "lvgl_jpeg_decoder.h"
+
+#if HAS_DISPLAY && HAS_IMAGE_API && IMAGE_SLIDESHOW_ENABLED && LV_USE_IMG
+
+#define IMAGE_SLIDESHOW_SUPPORTED 1
+
+class AsyncWebServer;
+class AsyncWebServerRequest;
+
+// auth_gate: same contract as image_api_register_routes().
+void image_slideshow_register_routes(AsyncWebServer* server, bool (*auth_gate)(AsyncWebServerRequest* request) = nullptr);
+
+// Advance prefetch / dwell / transitions (call from main loop, after image_api_process_pending).
+void image_slideshow_loop(bool ota_in_progress);
+
+#else
+
+#define IMAGE_SLIDESHOW_SUPPORTED 0
+
+#endif
@@ -0,0 +1,114 @@
+#include "jpeg_hw_decoder.h"
+
+#if JPEG_HW_DECODER_SUPPORTED
+
+#include "log_manager.h"
+
+#include <driver/jpeg_decode.h>
+#include <esp_heap_caps.h>
+#include <string.h>
+
+static jpeg_decoder_handle_t s_engine = nullptr;
+static bool s_engine_failed = false;
+
+static bool ensure_engine() {
+    if (s_engine) return true;
+    if (s_engine_failed) return false;
+
+    jpeg_decode_engine_cfg_t cfg = {};
+    cfg.intr_priority = 0;
+    cfg.timeout_ms = IMAGE_JPEG_HW_TIMEOUT_MS;
+    if (jpeg_new_decoder_engine(&cfg, &s_engine) != ESP_OK) {
+        LOGW("JPEGHW", "Engine init failed; using TJpgDec");
+        s_engine = nullptr;
+        s_engine_failed = true;  // don't retry on every image
+        return false;
+    }
+    LOGI("JPEGHW", "Hardware JPEG decoder ready");
+    return true;
+}
+
+// MCU size for the chroma subsampling (the engine writes whole MCUs).
+static void mcu_size(jpeg_down_sampling_type_t sampling, int* w, int* h) {
+    switch (sampling) {
+        case JPEG_DOWN_SAMPLING_YUV420: *w = 16; *h = 16; break;
+        case JPEG_DOWN_SAMPLING_YUV422: *w = 16; *h = 8; break;
+        default: *w = 8; *h = 8; break;
+    }
+}
+
+bool jpeg_hw_decode_rgb565(const uint8_t* jpeg, size_t jpeg_size, bool bgr, int max_w, int max_h,
+                           JpegHwImage* out, char* err, size_t err_len) {
+    if (!out) return false;
+    *out = JpegHwImage();
+    if (!jpeg || jpeg_size < 4 || !ensure_engine()) {
+        if (err && err_len) snprintf(err, err_len, "HW decoder unavailable");
+        return false;
+    }
+
+    jpeg_decode_picture_info_t info = {};
+    if (jpeg_decoder_get_info(jpeg, (uint32_t)jpeg_size, &info) != ESP_OK || info.width == 0 || info.height == 0) {
+        if (err && err_len) snprintf(err, err_len, "HW decoder: unsupported header");
+        return false;
+    }
+    if ((max_w > 0 && (int)info.width > max_w) || (max_h > 0 && (int)info.height > max_h)) {
+        if (err && err_len) snprintf(err, err_len, "HW decoder: %ux%u exceeds %dx%d",
+                                     (unsigned)info.width, (unsigned)info.height, max_w, max_h);
+        return false;
+    }
+
+    int mcu_w = 8;
+    int mcu_h = 8;
+    mcu_size(info.sample_method, &mcu_w, &mcu_h);
+    const int stride = ((int)info.width + mcu_w - 1) / mcu_w * mcu_w;
+    const int rows = ((int)info.height + mcu_h - 1) / mcu_h * mcu_h;
+
+    // Both buffers are DMA targets: the driver hands out cache-line aligned blocks.
+    jpeg_decode_memory_alloc_cfg_t in_cfg = {};
+    in_cfg.buffer_direction = JPEG_DEC_ALLOC_INPUT_BUFFER;
+    size_t in_alloc = 0;
+    uint8_t* in = (uint8_t*)jpeg_alloc_decoder_mem(jpeg_size, &in_cfg, &in_alloc);
+
+    jpeg_decode_memory_alloc_cfg_t out_cfg = {};
+    out_cfg.buffer_direction = JPEG_DEC_ALLOC_OUTPUT_BUFFER;
+    size_t out_alloc = 0;
+    uint16_t* pixels = in ? (uint16_t*)jpeg_alloc_decoder_mem((size_t)stride * rows * 2, &out_cfg, &out_alloc) : nullptr;
+    if (!in || !pixels) {
+        heap_caps_free(in);
+        heap_caps_free(pixels);
+        if (err && err_len) snprintf(err, err_len, "HW decoder: out of DMA memory");
+        return false;
+    }
+    memcpy(in, jpeg, jpeg_size);
+
+    // IDF names the in-memory element order: ORDER_BGR yields CPU-order RGB565 words
+    // (red in the top bits), ORDER_RGB the channel-swapped BGR565 layout.
+    jpeg_decode_cfg_t dec_cfg = {};
+    dec_cfg.output_format = JPEG_DECODE_OUT_FORMAT_RGB565;
+    dec_cfg.rgb_order = bgr ? JPEG_DEC_RGB_ELEMENT_ORDER_RGB : JPEG_DEC_RGB_ELEMENT_ORDER_BGR;
+    dec_cfg.conv_std = JPEG_YUV_RGB_CONV_STD_BT601;
+
+    uint32_t out_size = 0;
+    const esp_err_t res = jpeg_decoder_process(s_engine, &dec_cfg, in, (uint32_t)jpeg_size,
+                                               (uint8_t*)pixels, (uint32_t)out_alloc, &out_size);
+    heap_caps_free(in);
+    if (res != ESP_OK) {
+        heap_caps_free(pixels);
+        if (err && err_len) snprintf(err, err_len, "HW decode failed (%d)", (int)res);
+        return false;
+    }
+
+    out->pixels = pixels;
+    out->width = (int)info.width;
+    out->height = (int)info.height;
+    out->stride = stride;
+    return true;
+}
+
+void jpeg_hw_image_free(JpegHwImage* img) {
+    if (!img) return;
+    heap_caps_free(img->pixels);
+    *img = JpegHwImage();
+}
+
+#endif // JPEG_HW_DECODER_SUPPORTED
@@ -0,0 +1,52 @@
+/*
+ * Hardware JPEG Decoder (optional)
+ *
+ * Thin wrapper over the ESP-IDF JPEG codec driver (driver/jpeg_decode.h) for targets
+ * that have one (ESP32-P4). The StripDecoder and lvgl_jpeg_decode_to_rgb565() try it
+ * first for in-memory JPEGs and fall back to the ROM TJpgDec when it is absent,
+ * disabled (IMAGE_JPEG_HW_DECODE=false) or rejects the stream.
+ *
+ * Streaming decodes (image_url straight off the socket) always use TJpgDec: the
+ * hardware engine needs the whole bitstream in one DMA-capable buffer.
+ */
+
+#pragma once
+
+#include "board_config.h"
+
+#if HAS_IMAGE_API && IMAGE_JPEG_HW_DECODE
+    #if __has_include(<soc/soc_caps.h>)
+        #include <soc/soc_caps.h>
+    #endif
+    #if (defined(SOC_JPEG_DECODE_SUPPORTED) || defined(SOC_JPEG_CODEC_SUPPORTED)) && __has_include(<driver/jpeg_decode.h>)
+        #define JPEG_HW_DECODER_SUPPORTED 1
+    #endif
+#endif
+
+#ifndef JPEG_HW_DECODER_SUPPORTED
+#define JPEG_HW_DECODER_SUPPORTED 0
+#endif
+
+#if JPEG_HW_DECODER_SUPPORTED
+
+#include <stddef.h>
+#include <stdint.h>
+
+// Decoded frame in CPU-order RGB565 (or BGR565). Rows are `stride` pixels apart:
+// the engine pads the output to whole MCUs (8 or 16 px).
+struct JpegHwImage {
+    uint16_t* pixels = nullptr;
+    int width = 0;
+    int height = 0;
+    int stride = 0;
+};
+
+// Decode a complete JPEG. Fails (without side effects) when the engine is unavailable,
+// the image exceeds max_w x max_h (0 = no limit), or the stream is not supported.
+bool jpeg_hw_decode_rgb565(const uint8_t* jpeg, size_t jpeg_size, bool bgr, int max_w, int max_h,
+                           JpegHwImage* out, char* err, size_t err_len);
+
+// Free pixels (heap_caps_free also works; the buffer is a cache-aligned heap block).
+void jpeg_hw_image_free(JpegHwImage* img);
+
+#endif // JPEG_HW_DECODER_SUPPORTED
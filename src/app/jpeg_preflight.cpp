@@ -9,22 +9,25 @@
 #include "jpeg_preflight.h"
 #include <stdio.h>
 
-struct JpegSofInfo {
-    bool found = false;
-    bool progressive = false;
-    uint16_t width = 0;
-    uint16_t height = 0;
-    uint8_t components = 0;
-    // Sampling factors (h,v) for component IDs 1(Y),2(Cb),3(Cr)
-    uint8_t y_h = 0, y_v = 0;
-    uint8_t cb_h = 0, cb_v = 0;
-    uint8_t cr_h = 0, cr_v = 0;
-};
-
-static bool jpeg_parse_sof_best_effort(const uint8_t* data, size_t size, JpegSofInfo& out) {
-    if (!data || size < 4) return false;
+// Header bytes hashed for the strip-session fast path never include the SOF height,
+// so strips that differ only in height (typically the last one) still match.
+static uint32_t jpeg_header_hash(const uint8_t* data, size_t len, size_t skip_offset) {
+    uint32_t h = 2166136261u; // FNV-1a
+    for (size_t i = 0; i < len; i++) {
+        if (i == skip_offset || i == skip_offset + 1) continue;
+        h ^= data[i];
+        h *= 16777619u;
+    }
+    return h;
+}
+
+// Walks marker segments up to SOS. Fills SOF fields as soon as SOF0/SOF2 is seen;
+// header_len/header_hash only once SOS is reached.
+static JpegHeaderParse jpeg_parse_header(const uint8_t* data, size_t size, JpegHeaderInfo& out) {
+    out = JpegHeaderInfo();
+    if (!data || size < 4) return JpegHeaderParse::NeedMore;
     // Must start with SOI
-    if (!(data[0] == 0xFF && data[1] == 0xD8)) return false;
+    if (!(data[0] == 0xFF && data[1] == 0xD8)) return JpegHeaderParse::Invalid;
 
     size_t i = 2;
     while (i + 3 < size) {
@@ -35,6 +38,7 @@ static bool jpeg_parse_sof_best_effort(const uint8_t* data, size_t size, JpegSof
         }
 
         // Skip fill bytes 0xFF
+        const size_t marker_pos = i;
         while (i < size && data[i] == 0xFF) i++;
         if (i >= size) break;
 
@@ -45,20 +49,26 @@ static bool jpeg_parse_sof_best_effort(const uint8_t* data, size_t size, JpegSof
         if (marker == 0x01 || (marker >= 0xD0 && marker <= 0xD7)) continue; // TEM / RSTn
 
         // Start of Scan: header ends; no more metadata segments reliably parseable
-        if (marker == 0xDA) break;
+        if (marker == 0xDA) {
+            if (!out.found) return JpegHeaderParse::Invalid;
+            out.header_len = (uint32_t)marker_pos;
+            out.header_hash = jpeg_header_hash(data, marker_pos, out.sof_height_offset);
+            return JpegHeaderParse::Complete;
+        }
 
         if (i + 1 >= size) break;
         const uint16_t seg_len = (uint16_t)((data[i] << 8) | data[i + 1]);
-        if (seg_len < 2) return false;
-        if (i + seg_len > size) return false;
+        if (seg_len < 2) return JpegHeaderParse::Invalid;
+        if (i + seg_len > size) break;
 
         // SOF0 (baseline DCT) or SOF2 (progressive DCT)
         if (marker == 0xC0 || marker == 0xC2) {
             out.found = true;
             out.progressive = (marker == 0xC2);
-            if (seg_len < 8) return false;
+            if (seg_len < 8) return JpegHeaderParse::Invalid;
             const size_t p = i + 2;
             // p+0: precision
+            out.sof_height_offset = (uint16_t)(p + 1);
             out.height = (uint16_t)((data[p + 1] << 8) | data[p + 2]);
             out.width  = (uint16_t)((data[p + 3] << 8) | data[p + 4]);
             out.components = data[p + 5];
@@ -74,18 +84,17 @@ static bool jpeg_parse_sof_best_effort(const uint8_t* data, size_t size, JpegSof
                 else if (cid == 3) { out.cr_h = h; out.cr_v = v; }
                 cpos += 3;
             }
-            return true;
         }
 
         // Move to next segment
         i += seg_len;
     }
 
-    return out.found;
+    return out.found ? JpegHeaderParse::SofOnly : JpegHeaderParse::NeedMore;
 }
 
 static bool jpeg_preflight_common(
-    const JpegSofInfo& info,
+    const JpegHeaderInfo& info,
     char* err,
     size_t err_sz
 ) {
@@ -122,6 +131,28 @@ static bool jpeg_preflight_common(
     return true;
 }
 
+static bool jpeg_preflight_fragment_dims(
+    const JpegHeaderInfo& info,
+    int expected_width,
+    int max_height,
+    int panel_max_height,
+    char* err,
+    size_t err_sz
+) {
+    if ((int)info.width != expected_width) {
+        snprintf(err, err_sz, "Unsupported JPEG fragment width: got %u, expected %d", (unsigned)info.width, expected_width);
+        return false;
+    }
+
+    const int h = (int)info.height;
+    if (h <= 0 || h > max_height || h > panel_max_height) {
+        snprintf(err, err_sz, "Unsupported JPEG fragment height: got %u (max %d)", (unsigned)info.height, max_height);
+        return false;
+    }
+
+    return true;
+}
+
 bool jpeg_preflight_tjpgd_supported(
     const uint8_t* data,
     size_t size,
@@ -130,8 +161,9 @@ bool jpeg_preflight_tjpgd_supported(
     char* err,
     size_t err_sz
 ) {
-    JpegSofInfo info;
-    if (!jpeg_parse_sof_best_effort(data, size, info) || !info.found) {
+    JpegHeaderInfo info;
+    const JpegHeaderParse r = jpeg_parse_header(data, size, info);
+    if (r == JpegHeaderParse::Invalid || !info.found) {
         snprintf(err, err_sz, "Invalid JPEG header (missing SOF marker)");
         return false;
     }
@@ -145,6 +177,34 @@ bool jpeg_preflight_tjpgd_supported(
     return jpeg_preflight_common(info, err, err_sz);
 }
 
+JpegPrefixVerdict jpeg_preflight_tjpgd_prefix(
+    const uint8_t* data,
+    size_t size,
+    int expected_width,
+    int expected_height,
+    char* err,
+    size_t err_sz
+) {
+    // Too short to tell; the full-buffer check on completion still runs.
+    if (!data || size < 3) return JpegPrefixVerdict::Undecided;
+    if (!(data[0] == 0xFF && data[1] == 0xD8 && data[2] == 0xFF)) {
+        snprintf(err, err_sz, "Invalid JPEG file");
+        return JpegPrefixVerdict::Reject;
+    }
+
+    JpegHeaderInfo info;
+    const JpegHeaderParse r = jpeg_parse_header(data, size, info);
+    if (r == JpegHeaderParse::Invalid) {
+        snprintf(err, err_sz, "Invalid JPEG header (missing SOF marker)");
+        return JpegPrefixVerdict::Reject;
+    }
+    if (!info.found) return JpegPrefixVerdict::Undecided;
+
+    return jpeg_preflight_tjpgd_supported(data, size, expected_width, expected_height, err, err_sz)
+        ? JpegPrefixVerdict::Accept
+        : JpegPrefixVerdict::Reject;
+}
+
 bool jpeg_preflight_tjpgd_fragment_supported(
     const uint8_t* data,
     size_t size,
@@ -154,24 +214,97 @@ bool jpeg_preflight_tjpgd_fragment_supported(
     char* err,
     size_t err_sz
 ) {
-    JpegSofInfo info;
-    if (!jpeg_parse_sof_best_effort(data, size, info) || !info.found) {
+    JpegHeaderInfo info;
+    return jpeg_preflight_tjpgd_fragment_cached(data, size, expected_width, max_height, panel_max_height,
+                                                 info, false, err, err_sz);
+}
+
+bool jpeg_preflight_tjpgd_fragment_cached(
+    const uint8_t* data,
+    size_t size,
+    int expected_width,
+    int max_height,
+    int panel_max_height,
+    JpegHeaderInfo& session,
+    bool session_valid,
+    char* err,
+    size_t err_sz
+) {
+    // Fast path: same tables/layout as the strip that was fully checked, so only the
+    // height (the one field allowed to differ) needs re-reading.
+    if (session_valid && session.header_len > 0 && size > (size_t)session.header_len + 1 &&
+        data[session.header_len] == 0xFF && data[session.header_len + 1] == 0xDA &&
+        jpeg_header_hash(data, session.header_len, session.sof_height_offset) == session.header_hash) {
+        JpegHeaderInfo info = session;
+        info.height = (uint16_t)((data[session.sof_height_offset] << 8) | data[session.sof_height_offset + 1]);
+        return jpeg_preflight_fragment_dims(info, expected_width, max_height, panel_max_height, err, err_sz);
+    }
+
+    JpegHeaderInfo info;
+    const JpegHeaderParse r = jpeg_parse_header(data, size, info);
+    if (r == JpegHeaderParse::Invalid || !info.found) {
         snprintf(err, err_sz, "Invalid JPEG header (missing SOF marker)");
         return false;
     }
 
-    if ((int)info.width != expected_width) {
-        snprintf(err, err_sz, "Unsupported JPEG fragment width: got %u, expected %d", (unsigned)info.width, expected_width);
+    if (!jpeg_preflight_fragment_dims(info, expected_width, max_height, panel_max_height, err, err_sz)) {
         return false;
     }
 
-    const int h = (int)info.height;
-    if (h <= 0 || h > max_height || h > panel_max_height) {
-        snprintf(err, err_sz, "Unsupported JPEG fragment height: got %u (max %d)", (unsigned)info.height, max_height);
+    if (!jpeg_preflight_common(info, err, err_sz)) {
         return false;
     }
 
-    return jpeg_preflight_common(info, err, err_sz);
+    // Only cache headers whose scan start was found (hash covers everything before SOS).
+    if (r == JpegHeaderParse::Complete) {
+        session = info;
+    }
+    return true;
+}
+
+bool jpeg_preflight_tjpgd_frame_cached(
+    const uint8_t* data,
+    size_t size,
+    int max_width,
+    int max_height,
+    JpegHeaderInfo& session,
+    bool session_valid,
+    int* out_w,
+    int* out_h,
+    char* err,
+    size_t err_sz
+) {
+    JpegHeaderInfo info;
+    bool parsed = false;
+    if (session_valid && session.header_len > 0 && size > (size_t)session.header_len + 1 &&
+        data[session.header_len] == 0xFF && data[session.header_len + 1] == 0xDA &&
+        jpeg_header_hash(data, session.header_len, session.sof_height_offset) == session.header_hash) {
+        info = session;
+        info.height = (uint16_t)((data[session.sof_height_offset] << 8) | data[session.sof_height_offset + 1]);
+    } else {
+        const JpegHeaderParse r = jpeg_parse_header(data, size, info);
+        if (r == JpegHeaderParse::Invalid || !info.found) {
+            snprintf(err, err_sz, "Invalid JPEG header (missing SOF marker)");
+            return false;
+        }
+        if (!jpeg_preflight_common(info, err, err_sz)) {
+            return false;
+        }
+        parsed = (r == JpegHeaderParse::Complete);
+    }
+
+    if (info.width == 0 || info.height == 0 || (int)info.width > max_width || (int)info.height > max_height) {
+        snprintf(err, err_sz, "Unsupported JPEG frame: %ux%u does not fit %dx%d",
+                 (unsigned)info.width, (unsigned)info.height, max_width, max_height);
+        return false;
+    }
+
+    if (parsed) {
+        session = info;
+    }
+    if (out_w) *out_w = (int)info.width;
+    if (out_h) *out_h = (int)info.height;
+    return true;
 }
 
 #endif // HAS_IMAGE_API
@@ -14,6 +14,35 @@
 #include <stddef.h>
 #include <stdint.h>
 
+// SOF summary plus the bytes before SOS, as seen by the header scanner.
+struct JpegHeaderInfo {
+    bool found = false;
+    bool progressive = false;
+    uint16_t width = 0;
+    uint16_t height = 0;
+    uint8_t components = 0;
+    // Sampling factors (h,v) for component IDs 1(Y),2(Cb),3(Cr)
+    uint8_t y_h = 0, y_v = 0;
+    uint8_t cb_h = 0, cb_v = 0;
+    uint8_t cr_h = 0, cr_v = 0;
+    uint16_t sof_height_offset = 0; // Byte offset of the SOF height field
+    uint32_t header_len = 0;        // Offset of the SOS marker (0 = not reached)
+    uint32_t header_hash = 0;       // FNV-1a of [0, header_len) excluding the SOF height
+};
+
+enum class JpegHeaderParse : uint8_t {
+    Invalid,    // Not a JPEG / malformed segment
+    NeedMore,   // SOF not within the bytes given
+    SofOnly,    // SOF parsed, SOS not within the bytes given
+    Complete,   // SOF parsed and SOS reached
+};
+
+enum class JpegPrefixVerdict : uint8_t {
+    Accept,     // Header in the prefix passes the full-frame checks
+    Reject,     // Definitely unsupported (err filled)
+    Undecided,  // SOF not in the prefix; check again once complete
+};
+
 // Validates a full-frame JPEG against exact dimensions.
 // Returns true if the JPEG header looks compatible with TJpgDec, 
 // else writes a human-friendly error message to err buffer.
@@ -26,6 +55,17 @@ bool jpeg_preflight_tjpgd_supported(
     size_t err_sz
 );
 
+// Same checks as jpeg_preflight_tjpgd_supported() on the first bytes of an upload, so
+// unsupported files are refused before the body is buffered.
+JpegPrefixVerdict jpeg_preflight_tjpgd_prefix(
+    const uint8_t* data,
+    size_t size,
+    int expected_width,
+    int expected_height,
+    char* err,
+    size_t err_sz
+);
+
 // Validates a JPEG fragment (strip) against expected width and height bounds.
 // max_height is typically the remaining image height for this fragment.
 // panel_max_height is the display panel height cap.
@@ -39,4 +79,35 @@ bool jpeg_preflight_tjpgd_fragment_supported(
     size_t err_sz
 );
 
+// Fragment check for strip sessions. When session_valid and the bytes before SOS hash
+// the same as `session`, only the dimensions are re-checked; otherwise the header is
+// parsed in full and, if it passes, stored into `session` for the next strip.
+bool jpeg_preflight_tjpgd_fragment_cached(
+    const uint8_t* data,
+    size_t size,
+    int expected_width,
+    int max_height,
+    int panel_max_height,
+    JpegHeaderInfo& session,
+    bool session_valid,
+    char* err,
+    size_t err_sz
+);
+
+// Frame check for streams of independent JPEGs (MJPEG): any size up to max_width x
+// max_height. Uses and refreshes `session` like jpeg_preflight_tjpgd_fragment_cached();
+// on success *out_w / *out_h hold the frame dimensions.
+bool jpeg_preflight_tjpgd_frame_cached(
+    const uint8_t* data,
+    size_t size,
+    int max_width,
+    int max_height,
+    JpegHeaderInfo& session,
+    bool session_valid,
+    int* out_w,
+    int* out_h,
+    char* err,
+    size_t err_sz
+);
+
 #endif // HAS_IMAGE_API
@@ -0,0 +1,121 @@
+#include "json_arena.h"
+
+#include "app_alloc.h"
+#include "log_manager.h"
+
+#include <freertos/FreeRTOS.h>
+#include <freertos/portmacro.h>
+
+static constexpr size_t kSlotCount = (size_t)JSON_ARENA_SMALL_SLOTS + (size_t)JSON_ARENA_LARGE_SLOTS;
+static_assert(kSlotCount <= 32, "JSON arena: at most 32 slots (one bit each)");
+static_assert(JSON_ARENA_SMALL_BYTES % 8 == 0 && JSON_ARENA_LARGE_BYTES % 8 == 0,
+              "JSON arena slot sizes must keep 8-byte alignment");
+
+static constexpr size_t kPoolBytes =
+    (size_t)JSON_ARENA_SMALL_SLOTS * JSON_ARENA_SMALL_BYTES + (size_t)JSON_ARENA_LARGE_SLOTS * JSON_ARENA_LARGE_BYTES;
+
+static portMUX_TYPE s_mux = portMUX_INITIALIZER_UNLOCKED;
+static uint8_t* s_pool = nullptr;
+static bool s_pool_failed = false;
+static uint32_t s_busy = 0;  // bit i = slot i checked out
+static JsonArenaStats s_stats = {};
+
+// Small slots first, then the large ones.
+static size_t slot_offset(size_t i) {
+    if (i < (size_t)JSON_ARENA_SMALL_SLOTS) return i * JSON_ARENA_SMALL_BYTES;
+    return (size_t)JSON_ARENA_SMALL_SLOTS * JSON_ARENA_SMALL_BYTES +
+           (i - (size_t)JSON_ARENA_SMALL_SLOTS) * JSON_ARENA_LARGE_BYTES;
+}
+
+static size_t slot_size(size_t i) {
+    return (i < (size_t)JSON_ARENA_SMALL_SLOTS) ? (size_t)JSON_ARENA_SMALL_BYTES : (size_t)JSON_ARENA_LARGE_BYTES;
+}
+
+// -1 when `p` is not the start of a slot.
+static int slot_index(const void* p) {
+    if (!s_pool || !p) return -1;
+    const uint8_t* b = (const uint8_t*)p;
+    if (b < s_pool || b >= s_pool + kPoolBytes) return -1;
+    const size_t off = (size_t)(b - s_pool);
+    for (size_t i = 0; i < kSlotCount; i++) {
+        if (slot_offset(i) == off) return (int)i;
+    }
+    return -1;
+}
+
+static bool ensure_pool() {
+    if (s_pool) return true;
+    if (s_pool_failed || kSlotCount == 0) return false;
+
+    // Outside the spinlock: allocation may block.
+    uint8_t* pool = (uint8_t*)app_alloc(AllocTag::Json, kPoolBytes, AllocPolicy::PreferPsram);
+    portENTER_CRITICAL(&s_mux);
+    const bool lost_race = (s_pool != nullptr);
+    if (!lost_race && pool) {
+        s_pool = pool;
+        s_stats.slots = (uint16_t)kSlotCount;
+    } else if (!pool) {
+        s_pool_failed = true;
+    }
+    portEXIT_CRITICAL(&s_mux);
+
+    if (lost_race) {
+        app_free(AllocTag::Json, pool);
+    } else if (pool) {
+        LOGI("JsonArena", "%u x %u B + %u x %u B reserved",
+             (unsigned)JSON_ARENA_SMALL_SLOTS, (unsigned)JSON_ARENA_SMALL_BYTES,
+             (unsigned)JSON_ARENA_LARGE_SLOTS, (unsigned)JSON_ARENA_LARGE_BYTES);
+    } else {
+        LOGW("JsonArena", "Pool alloc failed (%u B); documents use the heap", (unsigned)kPoolBytes);
+    }
+    return s_pool != nullptr;
+}
+
+void* json_arena_checkout(size_t size) {
+    const bool have_pool = ensure_pool();
+
+    void* p = nullptr;
+    portENTER_CRITICAL(&s_mux);
+    if ((uint32_t)size > s_stats.peak_request) s_stats.peak_request = (uint32_t)size;
+    if (have_pool) {
+        for (size_t i = 0; i < kSlotCount; i++) {
+            if ((s_busy & (1u << i)) || slot_size(i) < size) continue;
+            s_busy |= (1u << i);
+            p = s_pool + slot_offset(i);
+            s_stats.checkouts++;
+            s_stats.in_use++;
+            if (s_stats.in_use > s_stats.peak_in_use) s_stats.peak_in_use = s_stats.in_use;
+            break;
+        }
+    }
+    if (!p) s_stats.fallbacks++;
+    portEXIT_CRITICAL(&s_mux);
+    return p;
+}
+
+bool json_arena_owns(const void* p) {
+    return slot_index(p) >= 0;
+}
+
+size_t json_arena_slot_bytes(const void* p) {
+    const int i = slot_index(p);
+    return (i >= 0) ? slot_size((size_t)i) : 0;
+}
+
+void json_arena_release(void* p) {
+    const int i = slot_index(p);
+    if (i < 0) return;
+    portENTER_CRITICAL(&s_mux);
+    if (s_busy & (1u << i)) {
+        s_busy &= ~(1u << i);
+        s_stats.in_use--;
+    }
+    portEXIT_CRITICAL(&s_mux);
+}
+
+void json_arena_get_stats(JsonArenaStats* out) {
+    if (!out) return;
+    portENTER_CRITICAL(&s_mux);
+    *out = s_stats;
+    portEXIT_CRITICAL(&s_mux);
+}
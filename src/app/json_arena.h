@@ -0,0 +1,79 @@
+#pragma once
+
+#include "board_config.h"
+
+#include <stddef.h>
+#include <stdint.h>
+
+// Reusable JSON document arenas for the web API handlers.
+//
+// API requests come in bursts (the portal polls health, config and energy together),
+// and every response used to malloc and free its own JsonDocument pool, in sizes
+// from a few hundred bytes to several KB. Over weeks that interleaving fragments the
+// heap. The pool reserves JSON_ARENA_SMALL_SLOTS x JSON_ARENA_SMALL_BYTES and
+// JSON_ARENA_LARGE_SLOTS x JSON_ARENA_LARGE_BYTES once, in a single block (PSRAM
+// first, AllocTag::Json), on first use. A document takes the smallest free slot
+// its capacity fits and hands it back when it is destroyed. Nothing is cleared in
+// between, because ArduinoJson resets its pool itself.
+//
+// Requests larger than a large slot, or arriving while every fitting slot is out,
+// fall back to the tagged heap and are counted. Thread-safe.
+
+struct JsonArenaStats {
+    uint16_t slots;          // small + large
+    uint16_t in_use;
+    uint16_t peak_in_use;
+    uint32_t checkouts;      // documents served from a slot
+    uint32_t fallbacks;      // documents that went to the heap
+    uint32_t peak_request;   // largest capacity asked for (bytes)
+};
+
+// nullptr when the request should go to the heap (no fitting slot free).
+void* json_arena_checkout(size_t size);
+
+// True when `p` was returned by json_arena_checkout().
+bool json_arena_owns(const void* p);
+
+// Capacity of the slot holding `p` (0 when not a slot).
+size_t json_arena_slot_bytes(const void* p);
+
+void json_arena_release(void* p);
+
+void json_arena_get_stats(JsonArenaStats* out);
+
+#include "psram_json_allocator.h"
+
+#include <string.h>
+
+// ArduinoJson allocator backed by the arena pool (PsramJsonAllocator when no
+// slot fits).
+struct JsonArenaAllocator {
+    void* allocate(size_t size) {
+        void* p = json_arena_checkout(size);
+        return p ? p : PsramJsonAllocator().allocate(size);
+    }
+
+    void deallocate(void* ptr) {
+        if (json_arena_owns(ptr)) {
+            json_arena_release(ptr);
+            return;
+        }
+        PsramJsonAllocator().deallocate(ptr);
+    }
+
+    void* reallocate(void* ptr, size_t new_size) {
+        const size_t slot = json_arena_slot_bytes(ptr);
+        if (slot == 0) return PsramJsonAllocator().reallocate(ptr, new_size);
+        if (new_size == 0) {
+            json_arena_release(ptr);
+            return nullptr;
+        }
+        // shrinkToFit() keeps the slot; growing past it moves to the heap.
+        if (new_size <= slot) return ptr;
+        void* moved = PsramJsonAllocator().allocate(new_size);
+        if (!moved) return nullptr;
+        memcpy(moved, ptr, slot);
+        json_arena_release(ptr);
+        return moved;
+    }
+};
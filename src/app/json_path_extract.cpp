@@ -0,0 +1,220 @@
+#include "json_path_extract.h"
+
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+
+namespace {
+
+struct Cursor {
+    const char *p;
+    const char *end;
+};
+
+// One parsed path segment: either an object key (name/name_len) or an array index.
+struct Segment {
+    bool is_index;
+    const char *name;
+    size_t name_len;
+    uint32_t index;
+};
+
+// Nested value skipping is iterative, so this only bounds path recursion.
+static constexpr int kMaxPathDepth = 16;
+
+static inline void skip_ws(Cursor &c) {
+    while (c.p < c.end && (*c.p == ' ' || *c.p == '\t' || *c.p == '\n' || *c.p == '\r')) c.p++;
+}
+
+// Skip a string starting at the opening quote. Leaves the cursor after the closing quote.
+static bool skip_string(Cursor &c) {
+    if (c.p >= c.end || *c.p != '"') return false;
+    c.p++;
+    while (c.p < c.end) {
+        const char ch = *c.p++;
+        if (ch == '\\') {
+            if (c.p >= c.end) return false;
+            c.p++;
+        } else if (ch == '"') {
+            return true;
+        }
+    }
+    return false;
+}
+
+// Skip any JSON value (scalars, or whole objects/arrays via a depth counter).
+static bool skip_value(Cursor &c) {
+    skip_ws(c);
+    if (c.p >= c.end) return false;
+
+    if (*c.p == '"') return skip_string(c);
+
+    if (*c.p == '{' || *c.p == '[') {
+        int depth = 0;
+        while (c.p < c.end) {
+            const char ch = *c.p;
+            if (ch == '"') {
+                if (!skip_string(c)) return false;
+                continue;
+            }
+            if (ch == '{' || ch == '[') depth++;
+            else if (ch == '}' || ch == ']') {
+                depth--;
+                if (depth == 0) {
+                    c.p++;
+                    return true;
+                }
+            }
+            c.p++;
+        }
+        return false;
+    }
+
+    // Number / true / false / null: run until a structural character.
+    while (c.p < c.end) {
+        const char ch = *c.p;
+        if (ch == ',' || ch == '}' || ch == ']' || ch == ' ' || ch == '\t' || ch == '\n' || ch == '\r') break;
+        c.p++;
+    }
+    return true;
+}
+
+static bool parse_number_at(const char *s, size_t n, double *out) {
+    if (n == 0 || n > 40) return false;
+    char tmp[48];
+    memcpy(tmp, s, n);
+    tmp[n] = '\0';
+
+    char *endp = nullptr;
+    const double v = strtod(tmp, &endp);
+    if (!endp || endp == tmp) return false;
+    while (*endp == ' ' || *endp == '\t') endp++;
+    if (*endp != '\0') return false;
+    *out = v;
+    return true;
+}
+
+// Parse the value under the cursor as a number (or numeric string).
+static bool read_number(Cursor &c, double *out) {
+    skip_ws(c);
+    if (c.p >= c.end) return false;
+
+    if (*c.p == '"') {
+        const char *start = c.p + 1;
+        const char *q = start;
+        while (q < c.end && *q != '"') {
+            if (*q == '\\') return false;  // escaped content is never a plain number
+            q++;
+        }
+        if (q >= c.end) return false;
+        return parse_number_at(start, (size_t)(q - start), out);
+    }
+
+    const char *start = c.p;
+    const char *q = start;
+    while (q < c.end) {
+        const char ch = *q;
+        if ((ch >= '0' && ch <= '9') || ch == '-' || ch == '+' || ch == '.' || ch == 'e' || ch == 'E') {
+            q++;
+            continue;
+        }
+        break;
+    }
+    return parse_number_at(start, (size_t)(q - start), out);
+}
+
+// Parse the next path segment. Returns false at end of path (or on syntax error, with *err set).
+static bool next_segment(const char *&path, Segment *seg, bool *err) {
+    *err = false;
+    while (*path == '.') path++;
+    if (*path == '\0') return false;
+
+    if (*path == '[') {
+        path++;
+        uint32_t idx = 0;
+        bool any = false;
+        while (*path >= '0' && *path <= '9') {
+            idx = idx * 10u + (uint32_t)(*path - '0');
+            path++;
+            any = true;
+        }
+        if (!any || *path != ']') {
+            *err = true;
+            return false;
+        }
+        path++;
+        seg->is_index = true;
+        seg->index = idx;
+        seg->name = nullptr;
+        seg->name_len = 0;
+        return true;
+    }
+
+    const char *start = path;
+    while (*path != '\0' && *path != '.' && *path != '[') path++;
+    seg->is_index = false;
+    seg->name = start;
+    seg->name_len = (size_t)(path - start);
+    seg->index = 0;
+    return true;
+}
+
+static bool extract(Cursor &c, const char *path, int depth, double *out) {
+    Segment seg;
+    bool err = false;
+    if (!next_segment(path, &seg, &err)) {
+        if (err) return false;
+        return read_number(c, out);
+    }
+    if (depth >= kMaxPathDepth) return false;
+
+    skip_ws(c);
+    if (c.p >= c.end) return false;
+
+    if (seg.is_index) {
+        if (*c.p != '[') return false;
+        c.p++;
+        for (uint32_t i = 0;; i++) {
+            skip_ws(c);
+            if (c.p >= c.end || *c.p == ']') return false;
+            if (i == seg.index) return extract(c, path, depth + 1, out);
+            if (!skip_value(c)) return false;
+            skip_ws(c);
+            if (c.p >= c.end || *c.p != ',') return false;
+            c.p++;
+        }
+    }
+
+    if (*c.p != '{') return false;
+    c.p++;
+    while (true) {
+        skip_ws(c);
+        if (c.p >= c.end || *c.p != '"') return false;
+
+        // Keys are compared on their raw bytes (escaped keys never match).
+        const char *key = c.p + 1;
+        if (!skip_string(c)) return false;
+        const size_t key_len = (size_t)(c.p - 1 - key);
+
+        skip_ws(c);
+        if (c.p >= c.end || *c.p != ':') return false;
+        c.p++;
+
+        if (key_len == seg.name_len && memcmp(key, seg.name, key_len) == 0) {
+            return extract(c, path, depth + 1, out);
+        }
+
+        if (!skip_value(c)) return false;
+        skip_ws(c);
+        if (c.p >= c.end || *c.p != ',') return false;
+        c.p++;
+    }
+}
+
+} // namespace
+
+bool json_path_extract_number(const char *json, size_t len, const char *path, double *out) {
+    if (!json || len == 0 || !out) return false;
+    Cursor c = {json, json + len};
+    return extract(c, path ? path : "", 0, out);
+}
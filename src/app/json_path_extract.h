@@ -0,0 +1,17 @@
+#ifndef JSON_PATH_EXTRACT_H
+#define JSON_PATH_EXTRACT_H
+
+#include <stddef.h>
+
+// Single-pass numeric extractor for MQTT energy payloads.
+//
+// Walks the payload bytes once, skipping everything that is not on the path,
+// without building a JSON DOM or allocating. Works on payloads of any size
+// (no StaticJsonDocument capacity limit) and does not require NUL termination.
+//
+// Path syntax: dotted keys and array indices, e.g. "value", "data.power[0].value",
+// "[2].w". "" or "." selects the root (a bare numeric payload such as "0.92").
+// The selected value must be a JSON number or a string holding a number.
+bool json_path_extract_number(const char *json, size_t len, const char *path, double *out);
+
+#endif // JSON_PATH_EXTRACT_H
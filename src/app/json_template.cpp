@@ -0,0 +1,190 @@
+#include "json_template.h"
+
+#include <stdio.h>
+#include <string.h>
+
+namespace {
+
+// "00".."99", two characters per entry.
+static const char kDigitPairs[201] =
+    "00010203040506070809"
+    "10111213141516171819"
+    "20212223242526272829"
+    "30313233343536373839"
+    "40414243444546474849"
+    "50515253545556575859"
+    "60616263646566676869"
+    "70717273747576777879"
+    "80818283848586878889"
+    "90919293949596979899";
+
+// Widest rendering per kind: "-9223372036854775808", "false"; "null" fits both.
+static constexpr size_t kIntMaxChars = 20;
+static constexpr size_t kBoolMaxChars = 5;
+
+// Appends to the skeleton during build(); `ok` drops on the first overflow.
+struct SkeletonWriter {
+    char* out;
+    size_t cap;
+    size_t len;
+    bool ok;
+
+    void put(const char* s, size_t n) {
+        if (!ok || len + n > cap) {
+            ok = false;
+            return;
+        }
+        memcpy(out + len, s, n);
+        len += n;
+    }
+
+    void raw(const char* s) { put(s, strlen(s)); }
+
+    // JSON string literal (same escaping as the discovery payloads).
+    void str(const char* s) {
+        raw("\"");
+        for (const char* p = s ? s : ""; *p; p++) {
+            const unsigned char c = (unsigned char)*p;
+            if (c == '"' || c == '\\') {
+                const char esc[2] = {'\\', (char)c};
+                put(esc, 2);
+            } else if (c < 0x20) {
+                char esc[8];
+                snprintf(esc, sizeof(esc), "\\u%04x", c);
+                raw(esc);
+            } else {
+                put(p, 1);
+            }
+        }
+        raw("\"");
+    }
+};
+
+static size_t format_u32(uint32_t v, char* out) {
+    char tmp[10];
+    char* p = tmp + sizeof(tmp);
+    while (v >= 100) {
+        const uint32_t pair = (v % 100) * 2;
+        v /= 100;
+        *--p = kDigitPairs[pair + 1];
+        *--p = kDigitPairs[pair];
+    }
+    if (v >= 10) {
+        *--p = kDigitPairs[v * 2 + 1];
+        *--p = kDigitPairs[v * 2];
+    } else {
+        *--p = (char)('0' + v);
+    }
+    const size_t n = (size_t)(tmp + sizeof(tmp) - p);
+    memcpy(out, p, n);
+    return n;
+}
+
+static size_t format_u64(uint64_t v, char* out) {
+    if (v <= UINT32_MAX) return format_u32((uint32_t)v, out);
+
+    // Peel off 9-digit chunks with one 64-bit division each; the rest stays 32-bit.
+    char tmp[20];
+    char* p = tmp + sizeof(tmp);
+    while (v > UINT32_MAX) {
+        uint32_t chunk = (uint32_t)(v % 1000000000ULL);
+        v /= 1000000000ULL;
+        for (int i = 0; i < 4; i++) {
+            const uint32_t pair = (chunk % 100) * 2;
+            chunk /= 100;
+            *--p = kDigitPairs[pair + 1];
+            *--p = kDigitPairs[pair];
+        }
+        *--p = (char)('0' + chunk);
+    }
+    const size_t head = format_u32((uint32_t)v, out);
+    const size_t tail = (size_t)(tmp + sizeof(tmp) - p);
+    memcpy(out + head, p, tail);
+    return head + tail;
+}
+
+} // namespace
+
+size_t json_template_format_int(int64_t value, char* out) {
+    if (value < 0) {
+        out[0] = '-';
+        // Negate in unsigned arithmetic so INT64_MIN does not overflow.
+        return 1 + format_u64(0 - (uint64_t)value, out + 1);
+    }
+    return format_u64((uint64_t)value, out);
+}
+
+bool JsonTemplate::build(const JsonTemplateField* fields, size_t count, char* storage, size_t storage_cap) {
+    _built = false;
+    _slots = 0;
+    _max_len = 0;
+    if (!fields || !storage) return false;
+
+    SkeletonWriter w = {storage, storage_cap, 0, true};
+    w.raw("{");
+    for (size_t i = 0; i < count; i++) {
+        const JsonTemplateField& f = fields[i];
+        if (i > 0) w.raw(",");
+        w.str(f.key);
+        w.raw(":");
+
+        if (f.kind == JsonTemplateKind::Text) {
+            w.str(f.text);
+            continue;
+        }
+
+        if (_slots >= kJsonTemplateMaxSlots) return false;
+        _frag_end[_slots] = (uint16_t)w.len;
+        _kind[_slots] = f.kind;
+        _max_len += (f.kind == JsonTemplateKind::Bool) ? kBoolMaxChars : kIntMaxChars;
+        _slots++;
+    }
+    w.raw("}");
+    if (!w.ok || w.len > UINT16_MAX) return false;
+
+    _frag_end[_slots] = (uint16_t)w.len;
+    _max_len += w.len;
+    _text = storage;
+    _built = true;
+    return true;
+}
+
+size_t JsonTemplate::render(const int64_t* values, char* out, size_t cap) const {
+    if (!_built || !values || !out || cap == 0) return 0;
+
+    // Slot i's value follows fragment i; the last fragment closes the object.
+    // One bounds check per slot (fragment + widest value), none per character.
+    char* p = out;
+    char* const end = out + cap;
+    size_t frag_start = 0;
+    for (size_t i = 0; i < _slots; i++) {
+        const size_t n = _frag_end[i] - frag_start;
+        const size_t widest = (_kind[i] == JsonTemplateKind::Bool) ? kBoolMaxChars : kIntMaxChars;
+        if ((size_t)(end - p) < n + widest) return 0;
+        memcpy(p, _text + frag_start, n);
+        p += n;
+        frag_start = _frag_end[i];
+
+        const int64_t v = values[i];
+        if (v == kJsonTemplateNull) {
+            memcpy(p, "null", 4);
+            p += 4;
+        } else if (_kind[i] == JsonTemplateKind::Bool) {
+            if (v) {
+                memcpy(p, "true", 4);
+                p += 4;
+            } else {
+                memcpy(p, "false", 5);
+                p += 5;
+            }
+        } else {
+            p += json_template_format_int(v, p);
+        }
+    }
+    const size_t n = _frag_end[_slots] - frag_start;
+    if ((size_t)(end - p) <= n) return 0;
+    memcpy(p, _text + frag_start, n);
+    p += n;
+    *p = '\0';
+    return (size_t)(p - out);
+}
@@ -0,0 +1,69 @@
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+
+// Fixed-shape JSON objects rendered without a JsonDocument.
+//
+// Some payloads have the same keys, in the same order, every time they are built,
+// and only their numbers change (the MQTT health state is the main one). For these
+// the object is described once by a field table. build() lays all the key text out
+// as fragments in caller-provided storage, and fixed string values (for example,
+// the reset reason, which stays the same for a whole boot) are folded into them.
+// After that, render() just alternates memcpy'd fragments with integers formatted
+// two digits at a time. No DOM, no heap, and no per-key lookups. The output is
+// compact JSON, byte-identical to what serializeJson() produces for the same values
+// (keys and Text values without control characters).
+//
+// A template is immutable after build(), so any number of tasks may render it
+// concurrently into their own buffers.
+
+enum class JsonTemplateKind : uint8_t {
+    Int,     // signed 64-bit integer
+    Bool,    // 0 = false, anything else = true
+    Text,    // constant string baked into the skeleton (no value slot)
+};
+
+struct JsonTemplateField {
+    const char* key;
+    JsonTemplateKind kind;
+    const char* text;        // Text only
+};
+
+// Value of a slot that renders as JSON null.
+static constexpr int64_t kJsonTemplateNull = INT64_MIN;
+
+static constexpr size_t kJsonTemplateMaxSlots = 48;
+
+class JsonTemplate {
+public:
+    // Lays out the skeleton for `fields`, in payload order, inside `storage`.
+    // Returns false when it does not fit or has more than kJsonTemplateMaxSlots
+    // value slots. Keys and Text values are escaped here once.
+    bool build(const JsonTemplateField* fields, size_t count, char* storage, size_t storage_cap);
+
+    bool valid() const { return _built; }
+
+    // Number of values render() expects: the non-Text fields, in table order.
+    size_t slotCount() const { return _slots; }
+
+    // Longest possible output (every slot at its widest), excluding the NUL.
+    size_t maxLength() const { return _max_len; }
+
+    // Writes the object to `out` with one value per slot, NUL-terminated. Returns
+    // the length, or 0 when the template is not built or the output may not fit
+    // (a buffer larger than maxLength() always fits).
+    size_t render(const int64_t* values, char* out, size_t cap) const;
+
+private:
+    const char* _text = nullptr;
+    uint16_t _frag_end[kJsonTemplateMaxSlots + 1] = {};   // fragment i = [_frag_end[i-1], _frag_end[i])
+    JsonTemplateKind _kind[kJsonTemplateMaxSlots] = {};
+    uint8_t _slots = 0;
+    size_t _max_len = 0;
+    bool _built = false;
+};
+
+// Fast integer formatting as used by JsonTemplate::render(); `out` needs 20 bytes.
+// Returns the number of characters written (not NUL-terminated).
+size_t json_template_format_int(int64_t value, char* out);
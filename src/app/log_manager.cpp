@@ -5,10 +5,20 @@
  */
 
 #include "log_manager.h"
+#include "log_stream.h"
+#include "task_placement.h"
+
+#include <esp_system.h>
+#include <limits.h>
+#include <freertos/FreeRTOS.h>
+#include <freertos/task.h>
 #include <stdarg.h>
+#include <string.h>
 
 static bool g_log_manager_begun = false;
 
+uint8_t g_log_runtime_level = LOG_RUNTIME_LEVEL;
+
 static inline bool serial_ready_for_logging() {
 #if defined(ARDUINO_USB_CDC_ON_BOOT) && (ARDUINO_USB_CDC_ON_BOOT == 1)
     return (bool)Serial;
@@ -17,11 +27,6 @@ static inline bool serial_ready_for_logging() {
 #endif
 }
 
-void log_init(unsigned long baud) {
-    Serial.begin(baud);
-    g_log_manager_begun = true;
-}
-
 static inline char log_level_char(LogLevel level) {
     switch (level) {
         case LOG_LEVEL_ERROR: return 'E';
@@ -32,6 +37,418 @@ static inline char log_level_char(LogLevel level) {
     }
 }
 
+// Formats "[<ms>] L MODULE: msg\n" into out; returns the length (truncated lines keep '\n').
+static size_t log_format_line(char* out, size_t cap, unsigned long t, LogLevel level, const char* module, const char* msg) {
+    int n = snprintf(out, cap, "[%lums] %c %s: %s\n", t, log_level_char(level), module, msg);
+    if (n < 0) return 0;
+    if ((size_t)n >= cap) {
+        n = (int)cap - 1;
+        out[n - 1] = '\n';
+    }
+    return (size_t)n;
+}
+
+#if LOG_BINARY_ENABLED
+// Encoded arguments (see log_arg_put()): tag byte + payload.
+//   'i' int64, 'u' uint64, 'f' double, 'p' pointer, 's' length byte + bytes.
+struct LogArgReader {
+    const uint8_t* p;
+    const uint8_t* end;
+};
+
+static bool log_arg_next(LogArgReader& r, char* tag, const uint8_t** data, size_t* n) {
+    if (r.p >= r.end) return false;
+    *tag = (char)*r.p++;
+    size_t len = 0;
+    switch (*tag) {
+        case 'i':
+        case 'u':
+        case 'f':
+            len = 8;
+            break;
+        case 'p':
+            len = sizeof(void*);
+            break;
+        case 's':
+            if (r.p >= r.end) return false;
+            len = *r.p++;
+            break;
+        default:
+            r.p = r.end;
+            return false;
+    }
+    if ((size_t)(r.end - r.p) < len) {
+        r.p = r.end;
+        return false;
+    }
+    *data = r.p;
+    *n = len;
+    r.p += len;
+    return true;
+}
+
+static long long log_arg_as_int(char tag, const uint8_t* d) {
+    if (tag == 'i' || tag == 'u') {
+        long long v;
+        memcpy(&v, d, sizeof(v));
+        return v;
+    }
+    if (tag == 'f') {
+        double v;
+        memcpy(&v, d, sizeof(v));
+        return (long long)v;
+    }
+    return 0;
+}
+
+static double log_arg_as_double(char tag, const uint8_t* d) {
+    if (tag == 'f') {
+        double v;
+        memcpy(&v, d, sizeof(v));
+        return v;
+    }
+    if (tag == 'u') {
+        unsigned long long v;
+        memcpy(&v, d, sizeof(v));
+        return (double)v;
+    }
+    return (double)log_arg_as_int(tag, d);
+}
+
+// printf subset over encoded arguments: flags/width/precision (including '*') are
+// honoured, length modifiers are implied by the stored type. Missing or mismatched
+// arguments print as '?'.
+static size_t log_format_encoded(char* out, size_t cap, const char* format, const uint8_t* args, size_t len) {
+    LogArgReader r = {args, args + len};
+    size_t o = 0;
+    const char* f = format;
+
+    while (*f && o + 1 < cap) {
+        if (*f != '%') {
+            out[o++] = *f++;
+            continue;
+        }
+        if (f[1] == '%') {
+            out[o++] = '%';
+            f += 2;
+            continue;
+        }
+
+        char spec[24];
+        size_t sn = 0;
+        spec[sn++] = '%';
+        f++;
+        while (*f && strchr("-+ #0123456789.*", *f) && sn < sizeof(spec) - 4) {
+            if (*f == '*') {
+                char tag;
+                const uint8_t* d;
+                size_t n;
+                const long long v = log_arg_next(r, &tag, &d, &n) ? log_arg_as_int(tag, d) : 0;
+                const size_t avail = sizeof(spec) - 4 - sn;
+                const int w = snprintf(spec + sn, avail, "%d", (int)v);
+                if (w > 0) sn += ((size_t)w < avail) ? (size_t)w : avail - 1;
+                f++;
+                continue;
+            }
+            spec[sn++] = *f++;
+        }
+        while (*f && strchr("hlLqjzt", *f)) f++;
+        const char conv = *f;
+        if (!conv) break;
+        f++;
+
+        char tag = 0;
+        const uint8_t* d = nullptr;
+        size_t n = 0;
+        const bool have = log_arg_next(r, &tag, &d, &n);
+        const size_t room = cap - o;
+        int written = -1;
+
+        if (have) {
+            switch (conv) {
+                case 'd':
+                case 'i': {
+                    const long long v = log_arg_as_int(tag, d);
+                    if (v >= LONG_MIN && v <= LONG_MAX) {
+                        spec[sn++] = 'l';
+                        spec[sn++] = conv;
+                        spec[sn] = '\0';
+                        written = snprintf(out + o, room, spec, (long)v);
+                    } else {
+                        spec[sn++] = 'l';
+                        spec[sn++] = 'l';
+                        spec[sn++] = conv;
+                        spec[sn] = '\0';
+                        written = snprintf(out + o, room, spec, v);
+                    }
+                    break;
+                }
+                case 'o':
+                case 'u':
+                case 'x':
+                case 'X': {
+                    const unsigned long long v = (unsigned long long)log_arg_as_int(tag, d);
+                    if (v <= ULONG_MAX) {
+                        spec[sn++] = 'l';
+                        spec[sn++] = conv;
+                        spec[sn] = '\0';
+                        written = snprintf(out + o, room, spec, (unsigned long)v);
+                    } else {
+                        spec[sn++] = 'l';
+                        spec[sn++] = 'l';
+                        spec[sn++] = conv;
+                        spec[sn] = '\0';
+                        written = snprintf(out + o, room, spec, v);
+                    }
+                    break;
+                }
+                case 'c':
+                    spec[sn++] = 'c';
+                    spec[sn] = '\0';
+                    written = snprintf(out + o, room, spec, (int)log_arg_as_int(tag, d));
+                    break;
+                case 'f':
+                case 'F':
+                case 'e':
+                case 'E':
+                case 'g':
+                case 'G':
+                case 'a':
+                case 'A':
+                    spec[sn++] = conv;
+                    spec[sn] = '\0';
+                    written = snprintf(out + o, room, spec, log_arg_as_double(tag, d));
+                    break;
+                case 's':
+                    if (tag == 's') {
+                        char str[256];
+                        memcpy(str, d, n);
+                        str[n] = '\0';
+                        spec[sn++] = 's';
+                        spec[sn] = '\0';
+                        written = snprintf(out + o, room, spec, str);
+                    }
+                    break;
+                case 'p':
+                    if (tag == 'p') {
+                        void* v;
+                        memcpy(&v, d, sizeof(v));
+                        written = snprintf(out + o, room, "%p", v);
+                    }
+                    break;
+                default:
+                    break;
+            }
+        }
+
+        if (written < 0) {
+            out[o++] = '?';
+            continue;
+        }
+        o += ((size_t)written < room) ? (size_t)written : room - 1;
+    }
+
+    out[o] = '\0';
+    return o;
+}
+#endif // LOG_BINARY_ENABLED
+
+#if LOG_ASYNC_ENABLED
+
+static_assert((LOG_ASYNC_SLOTS & (LOG_ASYNC_SLOTS - 1)) == 0, "LOG_ASYNC_SLOTS must be a power of two");
+static_assert(LOG_ASYNC_LINE_BYTES >= 32 && LOG_ASYNC_LINE_BYTES <= 65535, "LOG_ASYNC_LINE_BYTES out of range");
+
+// Bounded MPSC ring (Vyukov): a slot is free for producer position p when
+// seq == p and holds a line for the consumer at position p when seq == p + 1.
+enum LogSlotKind : uint8_t {
+    kLogSlotText = 0,     // text[] is the finished line
+    kLogSlotBinary = 1,   // text[] is a LogBinaryRecord followed by encoded arguments
+};
+
+struct LogSlot {
+    uint32_t seq;
+    uint16_t len;
+    uint8_t kind;
+    char text[LOG_ASYNC_LINE_BYTES];
+};
+
+#if LOG_BINARY_ENABLED
+struct LogBinaryRecord {
+    uint32_t ms;
+    const char* module;
+    const char* format;
+    uint8_t level;
+};
+
+static_assert(sizeof(LogBinaryRecord) + LOG_BINARY_ARGS_BYTES <= LOG_ASYNC_LINE_BYTES,
+              "LOG_BINARY_ARGS_BYTES does not fit into LOG_ASYNC_LINE_BYTES");
+#endif
+
+static LogSlot g_log_ring[LOG_ASYNC_SLOTS];
+static uint32_t g_log_tail = 0;      // next producer position (CAS)
+static uint32_t g_log_head = 0;      // next consumer position (owner of g_log_consumer)
+static uint32_t g_log_dropped = 0;
+static uint32_t g_log_dropped_reported = 0;
+static bool g_log_consumer = false;  // one drain at a time (task or log_flush)
+static TaskHandle_t g_log_task = nullptr;
+static RtosTaskPsramAlloc g_log_task_alloc = {};
+
+static LogSlot* log_claim(uint32_t* out_pos) {
+    uint32_t pos = __atomic_load_n(&g_log_tail, __ATOMIC_RELAXED);
+    while (true) {
+        LogSlot* slot = &g_log_ring[pos & (LOG_ASYNC_SLOTS - 1)];
+        const uint32_t seq = __atomic_load_n(&slot->seq, __ATOMIC_ACQUIRE);
+        const int32_t diff = (int32_t)(seq - pos);
+        if (diff == 0) {
+            if (__atomic_compare_exchange_n(&g_log_tail, &pos, pos + 1, true, __ATOMIC_RELAXED, __ATOMIC_RELAXED)) {
+                *out_pos = pos;
+                return slot;
+            }
+        } else if (diff < 0) {
+            __atomic_fetch_add(&g_log_dropped, 1, __ATOMIC_RELAXED);
+            return nullptr;
+        } else {
+            pos = __atomic_load_n(&g_log_tail, __ATOMIC_RELAXED);
+        }
+    }
+}
+
+static inline void log_publish(LogSlot* slot, uint32_t pos, size_t len, LogSlotKind kind = kLogSlotText) {
+    slot->len = (uint16_t)len;
+    slot->kind = (uint8_t)kind;
+    __atomic_store_n(&slot->seq, pos + 1, __ATOMIC_RELEASE);
+}
+
+static bool log_consumer_acquire() {
+    bool expected = false;
+    return __atomic_compare_exchange_n(&g_log_consumer, &expected, true, false, __ATOMIC_ACQUIRE, __ATOMIC_RELAXED);
+}
+
+static void log_consumer_release() {
+    __atomic_store_n(&g_log_consumer, false, __ATOMIC_RELEASE);
+}
+
+// Caller owns g_log_consumer.
+static void log_drain_locked() {
+    while (true) {
+        LogSlot* slot = &g_log_ring[g_log_head & (LOG_ASYNC_SLOTS - 1)];
+        if (__atomic_load_n(&slot->seq, __ATOMIC_ACQUIRE) != g_log_head + 1) break;
+        #if LOG_BINARY_ENABLED
+        if (slot->kind == kLogSlotBinary) {
+            LogBinaryRecord rec;
+            memcpy(&rec, slot->text, sizeof(rec));
+            char msg[128];
+            log_format_encoded(msg, sizeof(msg), rec.format,
+                (const uint8_t*)slot->text + sizeof(rec), slot->len - sizeof(rec));
+            char line[LOG_ASYNC_LINE_BYTES + 32];
+            const size_t n = log_format_line(line, sizeof(line), rec.ms, (LogLevel)rec.level, rec.module, msg);
+            Serial.write((const uint8_t*)line, n);
+            #if LOG_STREAM_SUPPORTED
+            log_stream_append(line, n);
+            #endif
+        } else
+        #endif
+        {
+            Serial.write((const uint8_t*)slot->text, slot->len);
+            #if LOG_STREAM_SUPPORTED
+            log_stream_append(slot->text, slot->len);
+            #endif
+        }
+        __atomic_store_n(&slot->seq, g_log_head + LOG_ASYNC_SLOTS, __ATOMIC_RELEASE);
+        g_log_head++;
+    }
+
+    const uint32_t dropped = __atomic_load_n(&g_log_dropped, __ATOMIC_RELAXED);
+    if (dropped != g_log_dropped_reported) {
+        char line[64];
+        const int n = snprintf(line, sizeof(line), "[%lums] W Log: %lu lines dropped\n",
+            millis(), (unsigned long)(dropped - g_log_dropped_reported));
+        g_log_dropped_reported = dropped;
+        if (n > 0) {
+            const size_t len = (size_t)min(n, (int)sizeof(line) - 1);
+            Serial.write((const uint8_t*)line, len);
+            #if LOG_STREAM_SUPPORTED
+            log_stream_append(line, len);
+            #endif
+        }
+    }
+}
+
+static void log_drain_task(void*) {
+    while (true) {
+        ulTaskNotifyTake(pdTRUE, pdMS_TO_TICKS(100));
+        if (log_consumer_acquire()) {
+            log_drain_locked();
+            log_consumer_release();
+        }
+    }
+}
+
+static void log_shutdown_handler() {
+    log_flush();
+}
+
+void log_flush() {
+    if (!g_log_task) return;
+    // Wait briefly for the drain task to finish its current batch. If it still
+    // holds the ring, leave the drain to it rather than racing it on g_log_head.
+    bool acquired = log_consumer_acquire();
+    for (int i = 0; i < 50 && !acquired; i++) {
+        vTaskDelay(1);
+        acquired = log_consumer_acquire();
+    }
+    if (!acquired) return;
+    log_drain_locked();
+    log_consumer_release();
+    Serial.flush();
+}
+
+uint32_t log_dropped_count() {
+    return __atomic_load_n(&g_log_dropped, __ATOMIC_RELAXED);
+}
+
+#endif // LOG_ASYNC_ENABLED
+
+void log_init(unsigned long baud) {
+    Serial.begin(baud);
+    g_log_manager_begun = true;
+
+    #if LOG_STREAM_SUPPORTED
+    log_stream_init();
+    #endif
+
+    #if LOG_ASYNC_ENABLED
+    for (uint32_t i = 0; i < LOG_ASYNC_SLOTS; i++) {
+        g_log_ring[i].seq = i;
+    }
+    if (task_placement_create(AppTask::LogDrain, log_drain_task, nullptr, &g_log_task, &g_log_task_alloc)) {
+        esp_register_shutdown_handler(log_shutdown_handler);
+    } else {
+        g_log_task = nullptr;
+        Serial.print("[0ms] W Log: drain task failed, logging synchronously\n");
+    }
+    #endif
+}
+
+// Queue (or, without a drain task, print) an already formatted message.
+static void log_emit(LogLevel level, const char* module, unsigned long t, const char* msg) {
+    #if LOG_ASYNC_ENABLED
+    if (g_log_task) {
+        uint32_t pos = 0;
+        LogSlot* slot = log_claim(&pos);
+        if (!slot) return;
+        const size_t n = log_format_line(slot->text, sizeof(slot->text), t, level, module, msg);
+        log_publish(slot, pos, n);
+        xTaskNotifyGive(g_log_task);
+        return;
+    }
+    #endif
+
+    char line[200];
+    const size_t n = log_format_line(line, sizeof(line), t, level, module, msg);
+    Serial.write((const uint8_t*)line, n);
+}
+
 void log_write(LogLevel level, const char* module, const char* format, ...) {
     if (!serial_ready_for_logging()) return;
     const unsigned long t = millis();
@@ -42,7 +459,90 @@ void log_write(LogLevel level, const char* module, const char* format, ...) {
     vsnprintf(msgbuf, sizeof(msgbuf), format, args);
     va_end(args);
 
-    char line[200];
-    snprintf(line, sizeof(line), "[%lums] %c %s: %s\n", t, log_level_char(level), module, msgbuf);
-    Serial.print(line);
+    log_emit(level, module, t, msgbuf);
 }
+
+#if LOG_BINARY_ENABLED
+void log_write_encoded(LogLevel level, const char* module, const char* format, const uint8_t* args, size_t len) {
+    if (!serial_ready_for_logging()) return;
+    const unsigned long t = millis();
+
+    #if LOG_ASYNC_ENABLED
+    if (g_log_task) {
+        uint32_t pos = 0;
+        LogSlot* slot = log_claim(&pos);
+        if (!slot) return;
+        const LogBinaryRecord rec = {(uint32_t)t, module, format, (uint8_t)level};
+        memcpy(slot->text, &rec, sizeof(rec));
+        memcpy(slot->text + sizeof(rec), args, len);  // len <= LOG_BINARY_ARGS_BYTES (static_assert)
+        log_publish(slot, pos, sizeof(rec) + len, kLogSlotBinary);
+        xTaskNotifyGive(g_log_task);
+        return;
+    }
+    #endif
+
+    char msgbuf[128];
+    log_format_encoded(msgbuf, sizeof(msgbuf), format, args, len);
+    log_emit(level, module, t, msgbuf);
+}
+#endif
+
+void log_set_level(LogLevel level) {
+    __atomic_store_n(&g_log_runtime_level, (uint8_t)level, __ATOMIC_RELAXED);
+}
+
+LogLevel log_get_level() {
+    return (LogLevel)__atomic_load_n(&g_log_runtime_level, __ATOMIC_RELAXED);
+}
+
+void log_write_isr(LogLevel level, const char* module, const char* message) {
+    #if LOG_ASYNC_ENABLED
+    if (!g_log_task || !g_log_manager_begun) return;
+    uint32_t pos = 0;
+    LogSlot* slot = log_claim(&pos);
+    if (!slot) return;
+
+    // No printf in ISR context: assemble "[<ms>] L MODULE: message\n" by hand.
+    char* p = slot->text;
+    char* const end = slot->text + sizeof(slot->text) - 1;  // room for '\n'
+    char digits[11];
+    size_t nd = 0;
+    uint32_t ms = (uint32_t)millis();
+    do {
+        digits[nd++] = (char)('0' + ms % 10);
+        ms /= 10;
+    } while (ms && nd < sizeof(digits));
+    *p++ = '[';
+    while (nd) *p++ = digits[--nd];
+    *p++ = 'm';
+    *p++ = 's';
+    *p++ = ']';
+    *p++ = ' ';
+    *p++ = log_level_char(level);
+    *p++ = ' ';
+    for (const char* s = module ? module : "?"; *s && p < end; ) *p++ = *s++;
+    if (p < end) *p++ = ':';
+    if (p < end) *p++ = ' ';
+    for (const char* s = message ? message : ""; *s && p < end; ) *p++ = *s++;
+    *p++ = '\n';
+    log_publish(slot, pos, (size_t)(p - slot->text));
+
+    BaseType_t woken = pdFALSE;
+    vTaskNotifyGiveFromISR(g_log_task, &woken);
+    if (woken) portYIELD_FROM_ISR();
+    #else
+    (void)level;
+    (void)module;
+    (void)message;
+    #endif
+}
+
+#if !LOG_ASYNC_ENABLED
+void log_flush() {
+    Serial.flush();
+}
+
+uint32_t log_dropped_count() {
+    return 0;
+}
+#endif
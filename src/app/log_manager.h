@@ -3,12 +3,32 @@
  *
  * Format: [<ms>] <LEVEL> <MODULE>: <message>
  * Designed for multi-task safety (no shared nesting state).
+ *
+ * With LOG_ASYNC_ENABLED, log_write() formats into a slot of a lock-free
+ * multi-producer ring in internal RAM and returns; a low-priority drain task
+ * writes the lines to Serial. A full ring drops the line (counted, reported by
+ * the drain task) instead of blocking the caller.
+ *
+ * Filtering happens before any argument is evaluated:
+ * - LOG_LEVEL: global compile-time floor (call sites above it are not compiled).
+ * - LOG_MODULE_FLOORS: per-module compile-time floors, e.g.
+ *     -DLOG_MODULE_FLOORS='{"MQTT", LOG_LEVEL_WARN}, {"Display", LOG_LEVEL_DEBUG},'
+ *   A floor may also raise a module above LOG_LEVEL (up to LOG_MODULE_MAX_LEVEL).
+ * - log_set_level(): runtime level, checked before formatting.
+ *
+ * With LOG_BINARY_ENABLED, the LOG* macros store the format pointer and raw
+ * arguments (strings copied) in the ring; the drain task formats them, so
+ * callers never pay for vsnprintf (notably %f on FPU-less targets).
  */
 
 #ifndef LOG_MANAGER_H
 #define LOG_MANAGER_H
 
+#include "board_config.h"
+
 #include <Arduino.h>
+#include <stddef.h>
+#include <string.h>
 
 enum LogLevel : uint8_t {
     LOG_LEVEL_ERROR = 1,
@@ -21,38 +41,163 @@ enum LogLevel : uint8_t {
 #define LOG_LEVEL LOG_LEVEL_INFO
 #endif
 
+// Highest level a LOG_MODULE_FLOORS entry can enable (call sites above it are not compiled).
+#ifndef LOG_MODULE_MAX_LEVEL
+#define LOG_MODULE_MAX_LEVEL LOG_LEVEL
+#endif
+
+// Per-module compile-time floors: comma-terminated {"Module", LOG_LEVEL_x} entries.
+#ifndef LOG_MODULE_FLOORS
+#define LOG_MODULE_FLOORS
+#endif
+
+// Initial runtime level (log_set_level() changes it).
+#ifndef LOG_RUNTIME_LEVEL
+#define LOG_RUNTIME_LEVEL LOG_LEVEL_DEBUG
+#endif
+
 // Initialize Serial logging.
 void log_init(unsigned long baud);
 
 // Core logging function (printf-style).
 void log_write(LogLevel level, const char* module, const char* format, ...);
 
+// ISR-safe variant: copies a constant message (no formatting) into the ring.
+// Dropped when the ring is full or when the logger is synchronous.
+void log_write_isr(LogLevel level, const char* module, const char* message);
+
+// Write out every queued line from the calling task (before restart / deep sleep).
+// Also runs from a shutdown handler on esp_restart().
+void log_flush();
+
+// Lines dropped because the async ring was full (0 when synchronous).
+uint32_t log_dropped_count();
+
+// Runtime level: lines above it are skipped before their arguments are evaluated.
+extern uint8_t g_log_runtime_level;
+void log_set_level(LogLevel level);
+LogLevel log_get_level();
+
+// Compile-time per-module floors.
+struct LogModuleFloor {
+    const char* module;
+    uint8_t level;
+};
+
+static constexpr LogModuleFloor kLogModuleFloors[] = { LOG_MODULE_FLOORS {nullptr, 0} };
+
+constexpr bool log_str_eq(const char* a, const char* b) {
+    return *a == *b && (*a == '\0' || log_str_eq(a + 1, b + 1));
+}
+
+constexpr uint8_t log_module_floor(const char* module, size_t i = 0) {
+    return kLogModuleFloors[i].module == nullptr ? (uint8_t)LOG_LEVEL
+        : log_str_eq(kLogModuleFloors[i].module, module) ? kLogModuleFloors[i].level
+        : log_module_floor(module, i + 1);
+}
+
+// Compile-time part folds to a constant for literal module names, which drops the call site.
+#define LOG_ENABLED(level, module) \
+    ((level) <= log_module_floor(module) && (level) <= g_log_runtime_level)
+
+#if LOG_BINARY_ENABLED
+// Deferred formatting: arguments are encoded as tagged values (see log_manager.cpp).
+struct LogArgWriter {
+    uint8_t* p;
+    uint8_t* end;
+    bool truncated;
+};
+
+inline void log_arg_raw(LogArgWriter& w, char tag, const void* data, size_t n) {
+    if (w.truncated || (size_t)(w.end - w.p) < n + 1) {
+        w.truncated = true;
+        return;
+    }
+    *w.p++ = (uint8_t)tag;
+    memcpy(w.p, data, n);
+    w.p += n;
+}
+
+inline void log_arg_put(LogArgWriter& w, long long v) { log_arg_raw(w, 'i', &v, sizeof(v)); }
+inline void log_arg_put(LogArgWriter& w, unsigned long long v) { log_arg_raw(w, 'u', &v, sizeof(v)); }
+inline void log_arg_put(LogArgWriter& w, int v) { log_arg_put(w, (long long)v); }
+inline void log_arg_put(LogArgWriter& w, long v) { log_arg_put(w, (long long)v); }
+inline void log_arg_put(LogArgWriter& w, unsigned int v) { log_arg_put(w, (unsigned long long)v); }
+inline void log_arg_put(LogArgWriter& w, unsigned long v) { log_arg_put(w, (unsigned long long)v); }
+inline void log_arg_put(LogArgWriter& w, double v) { log_arg_raw(w, 'f', &v, sizeof(v)); }
+inline void log_arg_put(LogArgWriter& w, const void* v) { log_arg_raw(w, 'p', &v, sizeof(v)); }
+
+inline void log_arg_put(LogArgWriter& w, const char* s) {
+    if (!s) s = "(null)";
+    size_t n = strlen(s);
+    if (w.truncated || w.end - w.p < 3) {
+        w.truncated = true;
+        return;
+    }
+    const size_t room = (size_t)(w.end - w.p) - 2;  // tag + length byte
+    if (n > room) n = room;
+    if (n > 255) n = 255;
+    *w.p++ = (uint8_t)'s';
+    *w.p++ = (uint8_t)n;
+    memcpy(w.p, s, n);
+    w.p += n;
+}
+
+inline void log_args_put(LogArgWriter&) {}
+
+template <typename T, typename... Rest>
+inline void log_args_put(LogArgWriter& w, T v, Rest... rest) {
+    log_arg_put(w, v);
+    log_args_put(w, rest...);
+}
+
+// format and module must be string literals (their pointers are stored).
+void log_write_encoded(LogLevel level, const char* module, const char* format, const uint8_t* args, size_t len);
+
+template <typename... Args>
+inline void log_write_binary(LogLevel level, const char* module, const char* format, Args... args) {
+    uint8_t buf[LOG_BINARY_ARGS_BYTES];
+    LogArgWriter w = {buf, buf + sizeof(buf), false};
+    log_args_put(w, args...);
+    log_write_encoded(level, module, format, buf, (size_t)(w.p - buf));
+}
+
+#define LOG_EMIT(level, module, format, ...) log_write_binary(level, module, format, ##__VA_ARGS__)
+#else
+#define LOG_EMIT(level, module, format, ...) log_write(level, module, format, ##__VA_ARGS__)
+#endif
+
+#define LOG_AT(level, module, format, ...) \
+    do { \
+        if (LOG_ENABLED(level, module)) LOG_EMIT(level, module, format, ##__VA_ARGS__); \
+    } while (0)
+
 // Convenience duration helper.
 inline void log_duration(const char* module, const char* label, unsigned long start_ms) {
     const unsigned long elapsed = millis() - start_ms;
     log_write(LOG_LEVEL_INFO, module, "%s dur=%lums", label, elapsed);
 }
 
-#if LOG_LEVEL >= LOG_LEVEL_ERROR
-#define LOGE(module, format, ...) log_write(LOG_LEVEL_ERROR, module, format, ##__VA_ARGS__)
+#if LOG_MODULE_MAX_LEVEL >= LOG_LEVEL_ERROR
+#define LOGE(module, format, ...) LOG_AT(LOG_LEVEL_ERROR, module, format, ##__VA_ARGS__)
 #else
 #define LOGE(module, format, ...) ((void)0)
 #endif
 
-#if LOG_LEVEL >= LOG_LEVEL_WARN
-#define LOGW(module, format, ...) log_write(LOG_LEVEL_WARN, module, format, ##__VA_ARGS__)
+#if LOG_MODULE_MAX_LEVEL >= LOG_LEVEL_WARN
+#define LOGW(module, format, ...) LOG_AT(LOG_LEVEL_WARN, module, format, ##__VA_ARGS__)
 #else
 #define LOGW(module, format, ...) ((void)0)
 #endif
 
-#if LOG_LEVEL >= LOG_LEVEL_INFO
-#define LOGI(module, format, ...) log_write(LOG_LEVEL_INFO, module, format, ##__VA_ARGS__)
+#if LOG_MODULE_MAX_LEVEL >= LOG_LEVEL_INFO
+#define LOGI(module, format, ...) LOG_AT(LOG_LEVEL_INFO, module, format, ##__VA_ARGS__)
 #else
 #define LOGI(module, format, ...) ((void)0)
 #endif
 
-#if LOG_LEVEL >= LOG_LEVEL_DEBUG
-#define LOGD(module, format, ...) log_write(LOG_LEVEL_DEBUG, module, format, ##__VA_ARGS__)
+#if LOG_MODULE_MAX_LEVEL >= LOG_LEVEL_DEBUG
+#define LOGD(module, format, ...) LOG_AT(LOG_LEVEL_DEBUG, module, format, ##__VA_ARGS__)
 #else
 #define LOGD(module, format, ...) ((void)0)
 #endif
@@ -0,0 +1,205 @@
+#include "log_stream.h"
+
+#if LOG_STREAM_SUPPORTED
+
+#include "app_alloc.h"
+#include "board_profile.h"
+#include "web_portal_json.h"
+
+#include <Arduino.h>
+#include <ESPAsyncWebServer.h>
+#include <esp_heap_caps.h>
+#include <memory>
+#include <new>
+#include <string.h>
+
+static_assert((LOG_STREAM_BUFFER_BYTES & (LOG_STREAM_BUFFER_BYTES - 1)) == 0, "LOG_STREAM_BUFFER_BYTES must be a power of two");
+static_assert((LOG_STREAM_BUFFER_BYTES_INTERNAL & (LOG_STREAM_BUFFER_BYTES_INTERNAL - 1)) == 0, "LOG_STREAM_BUFFER_BYTES_INTERNAL must be a power of two");
+
+namespace {
+
+// Byte ring with free-running offsets. The single writer first raises g_low (the
+// oldest byte still intact) and then writes; a reader that copied bytes below the
+// g_low it sees afterwards knows they may have been overwritten.
+static char* g_buf = nullptr;
+static uint32_t g_mask = 0;
+static uint32_t g_head = 0;   // offset one past the newest byte
+static uint32_t g_low = 0;    // oldest intact offset
+static uint8_t g_clients = 0; // open streams (atomic)
+
+static bool (*g_auth_gate)(AsyncWebServerRequest* request) = nullptr;
+
+static constexpr size_t kBatchRawBytes = 768;         // log bytes copied per filler call
+static constexpr unsigned long kKeepaliveMs = 15000;  // comment line while idle
+
+struct LogStreamClient {
+    uint32_t cursor;
+    unsigned long last_send_ms;
+    bool need_resync;  // cursor may sit mid-line (start or after a drop)
+    char raw[kBatchRawBytes];
+
+    ~LogStreamClient() {
+        __atomic_fetch_sub(&g_clients, 1, __ATOMIC_RELAXED);
+    }
+};
+
+static void ring_copy(uint32_t from, char* out, size_t n) {
+    const uint32_t cap = g_mask + 1;
+    const uint32_t start = from & g_mask;
+    const size_t first = (start + n <= cap) ? n : cap - start;
+    memcpy(out, g_buf + start, first);
+    if (first < n) memcpy(out + first, g_buf, n - first);
+}
+
+// Fill `buffer` with SSE for the client; RESPONSE_TRY_AGAIN while there is nothing to send.
+static size_t stream_fill(LogStreamClient* c, uint8_t* buffer, size_t max_len) {
+    size_t out = 0;
+    const unsigned long now = millis();
+
+    const uint32_t head = __atomic_load_n(&g_head, __ATOMIC_ACQUIRE);
+    uint32_t low = __atomic_load_n(&g_low, __ATOMIC_ACQUIRE);
+    if ((int32_t)(c->cursor - low) < 0) {
+        // Fell behind by more than the ring: skip ahead.
+        const int n = snprintf((char*)buffer, max_len, ": dropped %lu bytes\n\n", (unsigned long)(low - c->cursor));
+        if (n <= 0 || (size_t)n >= max_len) return RESPONSE_TRY_AGAIN;
+        out = (size_t)n;
+        c->cursor = low;
+        c->need_resync = true;
+    }
+
+    size_t avail = head - c->cursor;
+    if (avail > sizeof(c->raw)) avail = sizeof(c->raw);
+    if (avail > 0) {
+        ring_copy(c->cursor, c->raw, avail);
+        __atomic_thread_fence(__ATOMIC_ACQUIRE);
+        low = __atomic_load_n(&g_low, __ATOMIC_ACQUIRE);
+        if ((int32_t)(c->cursor - low) < 0) {
+            // Overwritten while copying; the next call reports the drop.
+            return out ? out : RESPONSE_TRY_AGAIN;
+        }
+
+        size_t pos = 0;
+        if (c->need_resync) {
+            const char* nl = (const char*)memchr(c->raw, '\n', avail);
+            if (!nl) return out ? out : RESPONSE_TRY_AGAIN;
+            pos = (size_t)(nl - c->raw) + 1;
+            c->cursor += (uint32_t)pos;
+            c->need_resync = false;
+        }
+
+        // One SSE event per batch, one data: field per complete line.
+        bool any = false;
+        while (pos < avail) {
+            const char* line = c->raw + pos;
+            const char* nl = (const char*)memchr(line, '\n', avail - pos);
+            if (!nl) {
+                // Partial line: wait for the rest (a batch-sized fragment can only be garbage).
+                if (pos == 0 && avail == sizeof(c->raw)) c->need_resync = true;
+                break;
+            }
+            const size_t len = (size_t)(nl - line);
+            if (out + 6 + len + 1 + 1 > max_len) break;  // "data: " + line + "\n" + final "\n"
+            memcpy(buffer + out, "data: ", 6);
+            memcpy(buffer + out + 6, line, len);
+            buffer[out + 6 + len] = '\n';
+            out += 6 + len + 1;
+            pos += len + 1;
+            c->cursor += (uint32_t)(len + 1);
+            any = true;
+        }
+        if (any) buffer[out++] = '\n';
+    }
+
+    if (out == 0) {
+        if (now - c->last_send_ms < kKeepaliveMs || max_len < 3) return RESPONSE_TRY_AGAIN;
+        memcpy(buffer, ":\n\n", 3);
+        out = 3;
+    }
+    c->last_send_ms = now;
+    return out;
+}
+
+static void handleLogStream(AsyncWebServerRequest* request) {
+    if (g_auth_gate && !g_auth_gate(request)) return;
+    if (!g_buf) {
+        web_portal_send_json_error(request, 503, "Log stream buffer not allocated");
+        return;
+    }
+    if (__atomic_add_fetch(&g_clients, 1, __ATOMIC_RELAXED) > LOG_STREAM_MAX_CLIENTS) {
+        __atomic_fetch_sub(&g_clients, 1, __ATOMIC_RELAXED);
+        web_portal_send_json_error(request, 429, "Too many log stream clients");
+        return;
+    }
+
+    std::shared_ptr<LogStreamClient> c(new (std::nothrow) LogStreamClient());
+    if (!c) {
+        __atomic_fetch_sub(&g_clients, 1, __ATOMIC_RELAXED);
+        web_portal_send_json_error(request, 503, "Out of memory");
+        return;
+    }
+    // Start with the buffered backlog.
+    c->cursor = __atomic_load_n(&g_low, __ATOMIC_ACQUIRE);
+    c->need_resync = (c->cursor != 0);
+    c->last_send_ms = millis();
+
+    AsyncWebServerResponse* response = request->beginChunkedResponse(
+        "text/event-stream",
+        [c](uint8_t* buffer, size_t max_len, size_t) -> size_t {
+            return stream_fill(c.get(), buffer, max_len);
+        }
+    );
+    response->addHeader("Cache-Control", "no-cache");
+    response->addHeader("X-Accel-Buffering", "no");
+    request->send(response);
+}
+
+} // namespace
+
+void log_stream_init() {
+    if (g_buf) return;
+
+    uint32_t bytes = 0;
+    char* buf = nullptr;
+    if (board_psram_available()) {
+        buf = (char*)app_alloc(AllocTag::Log, LOG_STREAM_BUFFER_BYTES, AllocPolicy::PsramOnly);
+        bytes = LOG_STREAM_BUFFER_BYTES;
+    }
+    if (!buf && LOG_STREAM_BUFFER_BYTES_INTERNAL > 0) {
+        buf = (char*)app_alloc(AllocTag::Log, LOG_STREAM_BUFFER_BYTES_INTERNAL, AllocPolicy::Internal);
+        bytes = LOG_STREAM_BUFFER_BYTES_INTERNAL;
+    }
+    if (!buf) return;
+
+    g_mask = bytes - 1;
+    __atomic_store_n(&g_buf, buf, __ATOMIC_RELEASE);
+}
+
+void log_stream_append(const char* line, size_t len) {
+    if (!g_buf || !line || len == 0) return;
+    const uint32_t cap = g_mask + 1;
+    if (len > cap) {
+        line += len - cap;
+        len = cap;
+    }
+
+    const uint32_t head = g_head;
+    const uint32_t new_head = head + (uint32_t)len;
+    if (new_head - g_low > cap) {
+        __atomic_store_n(&g_low, new_head - cap, __ATOMIC_RELEASE);
+        __atomic_thread_fence(__ATOMIC_SEQ_CST);
+    }
+
+    const uint32_t start = head & g_mask;
+    const size_t first = (start + len <= cap) ? len : cap - start;
+    memcpy(g_buf + start, line, first);
+    if (first < len) memcpy(g_buf, line + first, len - first);
+
+    __atomic_store_n(&g_head, new_head, __ATOMIC_RELEASE);
+}
+
+void log_stream_register_routes(AsyncWebServer* server, bool (*auth_gate)(AsyncWebServerRequest* request)) {
+    g_auth_gate = auth_gate;
+    server->on("/api/logs/stream", HTTP_GET, handleLogStream);
+}
+
+#endif // LOG_STREAM_SUPPORTED
@@ -0,0 +1,42 @@
+/*
+ * Live Log Streaming (Server-Sent Events)
+ *
+ * The log drain task copies every line it writes to Serial into a byte ring
+ * (PSRAM when available). Each SSE client keeps its own cursor into that ring and
+ * is fed from the AsyncTCP callbacks in batches (one "data:" line per log line);
+ * producers never wait on clients. A client that falls more than a ring behind
+ * skips ahead and receives a ": dropped <n> bytes" comment.
+ *
+ * Endpoints:
+ *   GET /api/logs/stream   - text/event-stream of log lines (starts with the buffered backlog)
+ *
+ * Requires LOG_ASYNC_ENABLED (lines are captured by the drain task).
+ */
+
+#pragma once
+
+#include "board_config.h"
+
+#if LOG_STREAM_ENABLED && LOG_ASYNC_ENABLED
+
+#define LOG_STREAM_SUPPORTED 1
+
+#include <stddef.h>
+
+class AsyncWebServer;
+class AsyncWebServerRequest;
+
+// Allocate the ring (called from log_init()).
+void log_stream_init();
+
+// Append one finished line (drain task only; single writer).
+void log_stream_append(const char* line, size_t len);
+
+// auth_gate: same contract as image_api_register_routes().
+void log_stream_register_routes(AsyncWebServer* server, bool (*auth_gate)(AsyncWebServerRequest* request) = nullptr);
+
+#else
+
+#define LOG_STREAM_SUPPORTED 0
+
+#endif
@@ -0,0 +1,182 @@
+#include "loop_scheduler.h"
+
+#include "log_manager.h"
+
+#include <Arduino.h>
+#include <esp_timer.h>
+#include <freertos/FreeRTOS.h>
+#include <freertos/task.h>
+
+struct LoopJob {
+    const char* name;
+    LoopJobFn fn;
+    uint32_t period_ms;
+    uint32_t budget_us;
+    uint32_t next_ms;
+    uint32_t runs;
+    uint32_t overruns;
+    uint32_t late;
+    uint32_t max_us;
+    uint32_t last_us;
+    uint64_t total_us;
+    uint32_t overruns_logged;  // overruns already covered by a log line
+};
+
+// Stats are read by the web task while the loop task updates them.
+static portMUX_TYPE s_mux = portMUX_INITIALIZER_UNLOCKED;
+static LoopJob s_jobs[LOOP_SCHEDULER_MAX_JOBS];
+static size_t s_job_count = 0;
+
+// Min-heap of job indices ordered by next_ms.
+static uint8_t s_heap[LOOP_SCHEDULER_MAX_JOBS];
+static size_t s_heap_size = 0;
+
+static uint32_t s_last_overrun_log_ms = 0;
+
+static inline bool before(uint8_t a, uint8_t b) {
+    return (int32_t)(s_jobs[a].next_ms - s_jobs[b].next_ms) < 0;
+}
+
+static void heap_swap(size_t i, size_t j) {
+    const uint8_t t = s_heap[i];
+    s_heap[i] = s_heap[j];
+    s_heap[j] = t;
+}
+
+static void sift_up(size_t i) {
+    while (i > 0) {
+        const size_t parent = (i - 1) / 2;
+        if (!before(s_heap[i], s_heap[parent])) break;
+        heap_swap(i, parent);
+        i = parent;
+    }
+}
+
+static void sift_down(size_t i) {
+    for (;;) {
+        const size_t l = 2 * i + 1;
+        const size_t r = l + 1;
+        size_t m = i;
+        if (l < s_heap_size && before(s_heap[l], s_heap[m])) m = l;
+        if (r < s_heap_size && before(s_heap[r], s_heap[m])) m = r;
+        if (m == i) break;
+        heap_swap(i, m);
+        i = m;
+    }
+}
+
+bool loop_scheduler_add(const char* name, LoopJobFn fn, uint32_t period_ms, uint32_t budget_us) {
+    if (!fn || period_ms == 0) return false;
+    if (s_job_count >= LOOP_SCHEDULER_MAX_JOBS) {
+        LOGE("Sched", "Job table full, dropping %s", name ? name : "?");
+        return false;
+    }
+    const uint8_t idx = (uint8_t)s_job_count;
+    LoopJob& job = s_jobs[idx];
+    job = {};
+    job.name = name ? name : "?";
+    job.fn = fn;
+    job.period_ms = period_ms;
+    job.budget_us = budget_us;
+    job.next_ms = millis() + period_ms;
+
+    portENTER_CRITICAL(&s_mux);
+    s_job_count++;
+    portEXIT_CRITICAL(&s_mux);
+
+    s_heap[s_heap_size] = idx;
+    sift_up(s_heap_size);
+    s_heap_size++;
+    return true;
+}
+
+// First overrun of a job right away, then one line per job per LOOP_SCHEDULER_OVERRUN_LOG_MS.
+static void log_overruns(uint32_t now_ms, LoopJob& job) {
+    if (job.overruns_logged == 0) {
+        job.overruns_logged = job.overruns;
+        LOGW("Sched", "%s overran %luus budget (%luus)", job.name,
+             (unsigned long)job.budget_us, (unsigned long)job.last_us);
+        return;
+    }
+    if ((uint32_t)(now_ms - s_last_overrun_log_ms) < (uint32_t)LOOP_SCHEDULER_OVERRUN_LOG_MS) return;
+    s_last_overrun_log_ms = now_ms;
+    for (size_t i = 0; i < s_job_count; i++) {
+        LoopJob& j = s_jobs[i];
+        if (j.overruns == j.overruns_logged) continue;
+        LOGW("Sched", "%s: %lu overruns since last report (max %luus, budget %luus)", j.name,
+             (unsigned long)(j.overruns - j.overruns_logged),
+             (unsigned long)j.max_us, (unsigned long)j.budget_us);
+        j.overruns_logged = j.overruns;
+    }
+}
+
+uint32_t loop_scheduler_run() {
+    const uint32_t now = millis();
+
+    // Rescheduled jobs always land after `now`, so each runs at most once per call.
+    while (s_heap_size > 0) {
+        LoopJob& job = s_jobs[s_heap[0]];
+        const int32_t lag = (int32_t)(now - job.next_ms);
+        if (lag < 0) break;
+
+        const int64_t start_us = esp_timer_get_time();
+        job.fn(now);
+        const uint32_t took_us = (uint32_t)(esp_timer_get_time() - start_us);
+        const bool overrun = job.budget_us > 0 && took_us > job.budget_us;
+
+        portENTER_CRITICAL(&s_mux);
+        job.runs++;
+        job.last_us = took_us;
+        job.total_us += took_us;
+        if (took_us > job.max_us) job.max_us = took_us;
+        if (overrun) job.overruns++;
+        if ((uint32_t)lag >= job.period_ms) job.late++;
+        portEXIT_CRITICAL(&s_mux);
+
+        // Keep the phase when on time; a late job restarts one period from now
+        // instead of firing back-to-back to catch up.
+        job.next_ms += job.period_ms;
+        if ((int32_t)(job.next_ms - now) <= 0) job.next_ms = now + job.period_ms;
+        sift_down(0);
+
+        if (overrun) log_overruns(now, job);
+    }
+
+    if (s_heap_size == 0) return LOOP_SCHEDULER_MAX_SLEEP_MS;
+    const int32_t wait = (int32_t)(s_jobs[s_heap[0]].next_ms - millis());
+    if (wait <= 0) return 0;
+    return (uint32_t)wait < (uint32_t)LOOP_SCHEDULER_MAX_SLEEP_MS ? (uint32_t)wait : (uint32_t)LOOP_SCHEDULER_MAX_SLEEP_MS;
+}
+
+void loop_scheduler_idle(uint32_t sleep_ms) {
+    TickType_t ticks = pdMS_TO_TICKS(sleep_ms);
+    if (ticks == 0) ticks = 1;
+    vTaskDelay(ticks);
+}
+
+size_t loop_scheduler_job_count() {
+    portENTER_CRITICAL(&s_mux);
+    const size_t n = s_job_count;
+    portEXIT_CRITICAL(&s_mux);
+    return n;
+}
+
+bool loop_scheduler_get_stats(size_t index, LoopJobStats* out) {
+    if (!out) return false;
+    portENTER_CRITICAL(&s_mux);
+    if (index >= s_job_count) {
+        portEXIT_CRITICAL(&s_mux);
+        return false;
+    }
+    const LoopJob& job = s_jobs[index];
+    out->name = job.name;
+    out->period_ms = job.period_ms;
+    out->budget_us = job.budget_us;
+    out->runs = job.runs;
+    out->overruns = job.overruns;
+    out->late = job.late;
+    out->max_us = job.max_us;
+    out->avg_us = job.runs ? (uint32_t)(job.total_us / job.runs) : 0;
+    portEXIT_CRITICAL(&s_mux);
+    return true;
+}
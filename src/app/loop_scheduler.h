@@ -0,0 +1,50 @@
+/*
+ * Loop Scheduler
+ *
+ * Deadline-ordered cooperative scheduler for the Arduino loop(). Each job has a
+ * period and a time budget; a min-heap keyed by the next run time picks the job
+ * that is due first, so loop() runs exactly the jobs whose time has come and then
+ * sleeps until the earliest next deadline instead of polling every
+ * `now - last >= interval` condition on every pass.
+ *
+ * A job that runs longer than its budget is counted as an overrun (first one and
+ * then one summary per LOOP_SCHEDULER_OVERRUN_LOG_MS are logged with the job
+ * name). A late job is not run repeatedly to catch up: its next deadline is
+ * rescheduled one period from now. Per-job stats are reported in
+ * /api/health/tasks (`loop_jobs`).
+ *
+ * Jobs run on the loop task only; registration happens in setup().
+ */
+
+#pragma once
+
+#include "board_config.h"
+
+#include <stddef.h>
+#include <stdint.h>
+
+typedef void (*LoopJobFn)(uint32_t now_ms);
+
+struct LoopJobStats {
+    const char* name;
+    uint32_t period_ms;
+    uint32_t budget_us;
+    uint32_t runs;
+    uint32_t overruns;   // runs longer than budget_us
+    uint32_t late;       // runs that started more than one period after their deadline
+    uint32_t max_us;
+    uint32_t avg_us;
+};
+
+// Register a periodic job (setup() only). The first run is due one period later.
+// name must be a string literal. Returns false when LOOP_SCHEDULER_MAX_JOBS is reached.
+bool loop_scheduler_add(const char* name, LoopJobFn fn, uint32_t period_ms, uint32_t budget_us);
+
+// Run every due job; returns ms until the next deadline (clamped to LOOP_SCHEDULER_MAX_SLEEP_MS).
+uint32_t loop_scheduler_run();
+
+// Block the loop task for sleep_ms (at least one tick so lower-priority tasks get the CPU).
+void loop_scheduler_idle(uint32_t sleep_ms);
+
+size_t loop_scheduler_job_count();
+bool loop_scheduler_get_stats(size_t index, LoopJobStats* out);
@@ -25,7 +25,12 @@
 #define LV_COLOR_DEPTH 16
 
 /* Swap the 2 bytes of RGB565 color. Useful if the display has a 8 bit interface (e.g. SPI)*/
+/* Per-board via LVGL_COLOR_16_SWAP (board_config.h); flushes then skip the driver-side swap. */
+#if LVGL_COLOR_16_SWAP
+#define LV_COLOR_16_SWAP 1
+#else
 #define LV_COLOR_16_SWAP 0
+#endif
 
 /* Enable features to draw on transparent background */
 #define LV_COLOR_SCREEN_TRANSP 0
@@ -38,13 +43,22 @@
  *=========================*/
 
 /* 1: use custom malloc/free, 0: use the built-in `lv_mem_alloc()` and `lv_mem_free()` */
+/* Per-board via LVGL_MEM_POOL_BYTES (board_config.h): a dedicated TLSF pool keeps LVGL's
+ * small, churny blocks out of the heap shared with network and image buffers. */
+#if LVGL_MEM_POOL_BYTES > 0
+#define LV_MEM_CUSTOM 0
+#else
 #define LV_MEM_CUSTOM 1
+#endif
 #if LV_MEM_CUSTOM == 0
   /* Size of the memory available for `lv_mem_alloc()` in bytes (>= 2kB)*/
-  #define LV_MEM_SIZE (48U * 1024U)          /*[bytes]*/
+  #define LV_MEM_SIZE (LVGL_MEM_POOL_BYTES)          /*[bytes]*/
 
   /* Set an address for the memory pool instead of allocating it as a normal array. */
   #define LV_MEM_ADR 0     /*0: unused*/
+  /* Reserve the pool at lv_init() (PSRAM or internal, see LVGL_MEM_POOL_PSRAM). */
+  #define LV_MEM_POOL_INCLUDE "lvgl_heap.h"
+  #define LV_MEM_POOL_ALLOC lvgl_heap_pool_alloc
 #else       /*LV_MEM_CUSTOM*/
   #define LV_MEM_CUSTOM_INCLUDE "lvgl_heap.h"   /*Header for the dynamic memory function*/
   #define LV_MEM_CUSTOM_ALLOC   lvgl_heap_malloc
@@ -1,44 +1,102 @@
 #include "lvgl_heap.h"
 
-#include <esp_heap_caps.h>
+#include "app_alloc.h"
+#include "board_config.h"
+#include "board_profile.h"
+#include "log_manager.h"
 
-static inline bool psram_available() {
-#if SOC_SPIRAM_SUPPORTED
-    return heap_caps_get_total_size(MALLOC_CAP_SPIRAM) > 0;
-#else
-    return false;
+#include <Arduino.h>
+#include <freertos/FreeRTOS.h>
+#include <freertos/portmacro.h>
+#include <string.h>
+
+#if HAS_DISPLAY && LVGL_MEM_POOL_BYTES > 0
+#include <lvgl.h>
 #endif
-}
+
+// LVGL's heap (LV_MEM_CUSTOM) goes through the tagged facade so its footprint shows up
+// as the "lvgl" bucket of /api/health. PSRAM first, internal 8-bit as the fallback;
+// if both fail LVGL handles the OOM.
+//
+// With LVGL_MEM_POOL_BYTES set, LVGL instead runs its built-in TLSF allocator on one
+// region reserved here at lv_init(); only that region is seen by the shared heap.
 
 extern "C" void* lvgl_heap_malloc(size_t size) {
-    if (size == 0) return nullptr;
+    return app_alloc(AllocTag::Lvgl, size, AllocPolicy::PreferPsram);
+}
 
-    if (psram_available()) {
-        void* p = heap_caps_malloc(size, MALLOC_CAP_SPIRAM | MALLOC_CAP_8BIT);
-        if (p) return p;
-    }
+extern "C" void* lvgl_heap_realloc(void* ptr, size_t size) {
+    return app_realloc(AllocTag::Lvgl, ptr, size, AllocPolicy::PreferPsram);
+}
 
-    return heap_caps_malloc(size, MALLOC_CAP_INTERNAL | MALLOC_CAP_8BIT);
+extern "C" void lvgl_heap_free(void* ptr) {
+    app_free(AllocTag::Lvgl, ptr);
 }
 
-extern "C" void* lvgl_heap_realloc(void* ptr, size_t size) {
-    if (ptr == nullptr) return lvgl_heap_malloc(size);
-    if (size == 0) {
-        lvgl_heap_free(ptr);
-        return nullptr;
-    }
+static portMUX_TYPE s_stats_mux = portMUX_INITIALIZER_UNLOCKED;
+static LvglHeapStats s_stats = {};
+static bool s_pool_in_psram = false;
 
-    if (psram_available()) {
-        void* p = heap_caps_realloc(ptr, size, MALLOC_CAP_SPIRAM | MALLOC_CAP_8BIT);
-        if (p) return p;
+extern "C" void* lvgl_heap_pool_alloc(size_t size) {
+    void* p = nullptr;
+    if (LVGL_MEM_POOL_PSRAM && board_psram_available()) {
+        p = app_alloc(AllocTag::Lvgl, size, AllocPolicy::PsramOnly);
+        s_pool_in_psram = (p != nullptr);
+    }
+    if (!p) {
+        p = app_alloc(AllocTag::Lvgl, size, AllocPolicy::Internal);
     }
+    if (!p) {
+        // lv_init() asserts on a null pool; say why first.
+        LOGE("LVGL", "Pool alloc failed (%u bytes)", (unsigned)size);
+    } else {
+        LOGI("LVGL", "TLSF pool: %u bytes in %s", (unsigned)size, s_pool_in_psram ? "PSRAM" : "internal RAM");
+    }
+    return p;
+}
 
-    // Fall back to internal 8-bit RAM.
-    // If this fails, LVGL will handle the OOM.
-    return heap_caps_realloc(ptr, size, MALLOC_CAP_INTERNAL | MALLOC_CAP_8BIT);
+extern "C" uint32_t lvgl_heap_used_bytes(void) {
+#if HAS_DISPLAY && LVGL_MEM_POOL_BYTES > 0
+    lv_mem_monitor_t mon;
+    lv_mem_monitor(&mon);
+    return (mon.total_size > mon.free_size) ? (uint32_t)(mon.total_size - mon.free_size) : 0;
+#else
+    AllocTagStats s;
+    app_alloc_get_stats(AllocTag::Lvgl, &s);
+    return s.live_bytes;
+#endif
 }
 
-extern "C" void lvgl_heap_free(void* ptr) {
-    if (!ptr) return;
-    heap_caps_free(ptr);
+extern "C" void lvgl_heap_sample(void) {
+#if HAS_DISPLAY && LVGL_MEM_POOL_BYTES > 0
+    static uint32_t last_ms = 0;
+    const uint32_t now = millis();
+    if (last_ms != 0 && (uint32_t)(now - last_ms) < 1000) return;
+    last_ms = now;
+
+    lv_mem_monitor_t mon;
+    lv_mem_monitor(&mon);
+
+    LvglHeapStats s = {};
+    s.pool = true;
+    s.pool_in_psram = s_pool_in_psram;
+    s.total = mon.total_size;
+    s.free = mon.free_size;
+    s.used = (mon.total_size > mon.free_size) ? (mon.total_size - mon.free_size) : 0;
+    s.largest_free = mon.free_biggest_size;
+    s.max_used = mon.max_used;
+    s.used_pct = mon.used_pct;
+    s.frag_pct = mon.frag_pct;
+
+    portENTER_CRITICAL(&s_stats_mux);
+    s_stats = s;
+    portEXIT_CRITICAL(&s_stats_mux);
+#endif
+}
+
+extern "C" void lvgl_heap_get_stats(LvglHeapStats* out) {
+    if (!out) return;
+    portENTER_CRITICAL(&s_stats_mux);
+    *out = s_stats;
+    portEXIT_CRITICAL(&s_stats_mux);
 }
@@ -1,6 +1,8 @@
 #pragma once
 
+#include <stdbool.h>
 #include <stddef.h>
+#include <stdint.h>
 
 #ifdef __cplusplus
 extern "C" {
@@ -10,6 +12,31 @@ void* lvgl_heap_malloc(size_t size);
 void* lvgl_heap_realloc(void* ptr, size_t size);
 void  lvgl_heap_free(void* ptr);
 
+// Reserves the LVGL TLSF pool when LVGL_MEM_POOL_BYTES > 0 (called once by lv_init()).
+void* lvgl_heap_pool_alloc(size_t size);
+
+typedef struct {
+    bool pool;              // false: LVGL uses the shared heap and the fields below are 0
+    bool pool_in_psram;
+    uint32_t total;
+    uint32_t used;
+    uint32_t free;
+    uint32_t largest_free;
+    uint32_t max_used;
+    uint8_t used_pct;
+    uint8_t frag_pct;       // 100 - largest_free * 100 / free
+} LvglHeapStats;
+
+// Bytes LVGL currently holds: pool usage with LVGL_MEM_POOL_BYTES, otherwise the live
+// bytes of AllocTag::Lvgl (0 when unknown, e.g. on Arduino core 2.x). LVGL task only.
+uint32_t lvgl_heap_used_bytes(void);
+
+// Refresh the cached pool stats (~1 Hz). LVGL task only: it walks the TLSF pool.
+void lvgl_heap_sample(void);
+
+// Thread-safe copy of the last sample.
+void lvgl_heap_get_stats(LvglHeapStats* out);
+
 #ifdef __cplusplus
 }
 #endif
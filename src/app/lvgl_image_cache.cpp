@@ -0,0 +1,183 @@
+#include "lvgl_image_cache.h"
+
+#if LVGL_IMAGE_CACHE_SUPPORTED
+
+#include "app_alloc.h"
+#include "board_profile.h"
+#include "image_arena.h"
+
+#include <Arduino.h>
+#include <esp_heap_caps.h>
+#include <freertos/FreeRTOS.h>
+#include <freertos/portmacro.h>
+#include <string.h>
+
+namespace {
+
+struct CacheEntry {
+    LvglImageCacheKey key;
+    uint16_t* pixels;      // PSRAM, owned by the cache (nullptr = free slot)
+    uint32_t bytes;
+    uint16_t w;
+    uint16_t h;
+    uint32_t last_used;    // s_clock value at the last acquire/insert
+    uint8_t pins;
+};
+
+static portMUX_TYPE s_mux = portMUX_INITIALIZER_UNLOCKED;
+static CacheEntry s_entries[LVGL_IMAGE_CACHE_MAX_ENTRIES] = {};
+static uint32_t s_clock = 0;
+static uint32_t s_bytes = 0;
+static uint32_t s_hits = 0;
+static uint32_t s_misses = 0;
+
+static CacheEntry* find_locked(const LvglImageCacheKey& key) {
+    for (CacheEntry& e : s_entries) {
+        if (e.pixels && e.key.hash == key.hash && e.key.size == key.size) return &e;
+    }
+    return nullptr;
+}
+
+// Least recently used unpinned entry, or nullptr.
+static CacheEntry* victim_locked() {
+    CacheEntry* best = nullptr;
+    for (CacheEntry& e : s_entries) {
+        if (!e.pixels || e.pins) continue;
+        if (!best || (int32_t)(e.last_used - best->last_used) < 0) best = &e;
+    }
+    return best;
+}
+
+static CacheEntry* free_slot_locked() {
+    for (CacheEntry& e : s_entries) {
+        if (!e.pixels) return &e;
+    }
+    return nullptr;
+}
+
+// Detach one entry for eviction; the caller frees the returned buffer outside the lock.
+static uint16_t* evict_locked(CacheEntry* e) {
+    uint16_t* p = e->pixels;
+    s_bytes -= e->bytes;
+    memset(e, 0, sizeof(*e));
+    return p;
+}
+
+} // namespace
+
+LvglImageCacheKey lvgl_image_cache_key(const uint8_t* jpeg, size_t jpeg_size) {
+    // FNV-1a over the compressed bytes.
+    uint32_t h = 2166136261u;
+    for (size_t i = 0; i < jpeg_size; i++) {
+        h ^= jpeg[i];
+        h *= 16777619u;
+    }
+    LvglImageCacheKey key;
+    key.hash = h;
+    key.size = (uint32_t)jpeg_size;
+    return key;
+}
+
+bool lvgl_image_cache_acquire(const LvglImageCacheKey& key, const uint16_t** pixels, int* w, int* h) {
+    bool hit = false;
+    portENTER_CRITICAL(&s_mux);
+    CacheEntry* e = find_locked(key);
+    if (e) {
+        e->pins++;
+        e->last_used = ++s_clock;
+        *pixels = e->pixels;
+        *w = e->w;
+        *h = e->h;
+        s_hits++;
+        hit = true;
+    } else {
+        s_misses++;
+    }
+    portEXIT_CRITICAL(&s_mux);
+    return hit;
+}
+
+bool lvgl_image_cache_insert(const LvglImageCacheKey& key, uint16_t** pixels, int w, int h) {
+    if (!pixels || !*pixels || w <= 0 || h <= 0 || !board_psram_available()) return false;
+    const uint32_t bytes = (uint32_t)w * (uint32_t)h * sizeof(uint16_t);
+    if (bytes > LVGL_IMAGE_CACHE_BYTES) return false;
+
+    // Make room first (LRU, skipping pinned entries); frees happen outside the lock.
+    for (;;) {
+        uint16_t* evicted = nullptr;
+        bool fits = false;
+        bool stuck = false;
+        portENTER_CRITICAL(&s_mux);
+        if (s_bytes + bytes <= LVGL_IMAGE_CACHE_BYTES && free_slot_locked()) {
+            fits = true;
+        } else {
+            CacheEntry* v = victim_locked();
+            if (v) {
+                evicted = evict_locked(v);
+            } else {
+                stuck = true;
+            }
+        }
+        portEXIT_CRITICAL(&s_mux);
+        if (evicted) image_arena_free(evicted);
+        if (fits) break;
+        if (stuck) return false;  // everything left is pinned
+    }
+
+    // Long-lived: move arena outputs to the general PSRAM heap so the arena stays
+    // free for uploads and downloads.
+    uint16_t* owned = *pixels;
+    if (image_arena_owns(owned)) {
+        uint16_t* copy = (uint16_t*)app_alloc(AllocTag::Image, bytes, AllocPolicy::PsramOnly);
+        if (!copy) return false;
+        memcpy(copy, owned, bytes);
+        image_arena_free(owned);
+        owned = copy;
+        *pixels = copy;
+    }
+
+    portENTER_CRITICAL(&s_mux);
+    CacheEntry* e = free_slot_locked();
+    if (e && s_bytes + bytes <= LVGL_IMAGE_CACHE_BYTES && !find_locked(key)) {
+        e->key = key;
+        e->pixels = owned;
+        e->bytes = bytes;
+        e->w = (uint16_t)w;
+        e->h = (uint16_t)h;
+        e->last_used = ++s_clock;
+        e->pins = 1;
+        s_bytes += bytes;
+    } else {
+        e = nullptr;
+    }
+    portEXIT_CRITICAL(&s_mux);
+    return e != nullptr;
+}
+
+void lvgl_image_cache_release(const uint16_t* pixels) {
+    if (!pixels) return;
+    portENTER_CRITICAL(&s_mux);
+    for (CacheEntry& e : s_entries) {
+        if (e.pixels == pixels) {
+            if (e.pins) e.pins--;
+            break;
+        }
+    }
+    portEXIT_CRITICAL(&s_mux);
+}
+
+void lvgl_image_cache_get_stats(LvglImageCacheStats* out) {
+    if (!out) return;
+    portENTER_CRITICAL(&s_mux);
+    out->hits = s_hits;
+    out->misses = s_misses;
+    out->bytes = s_bytes;
+    uint8_t n = 0;
+    for (const CacheEntry& e : s_entries) {
+        if (e.pixels) n++;
+    }
+    out->entries = n;
+    portEXIT_CRITICAL(&s_mux);
+}
+
+#endif // LVGL_IMAGE_CACHE_SUPPORTED
@@ -0,0 +1,63 @@
+#pragma once
+
+#include "board_config.h"
+
+#if HAS_DISPLAY && HAS_IMAGE_API
+
+#include <lvgl.h>
+
+#if LV_USE_IMG && LVGL_IMAGE_CACHE_BYTES > 0
+
+#define LVGL_IMAGE_CACHE_SUPPORTED 1
+
+#include <stddef.h>
+#include <stdint.h>
+
+// Decoded-image cache for LvglImageScreen.
+//
+// Keeps RGB565 outputs of lvgl_jpeg_decode_to_rgb565() in PSRAM, keyed by a hash of
+// the compressed JPEG, within LVGL_IMAGE_CACHE_BYTES (least recently used entries are
+// evicted). Showing an image that is already cached skips the decode entirely.
+// Boards without PSRAM never cache (every lookup is a miss).
+//
+// Entries handed out by acquire()/insert() are pinned until release(), so the
+// buffer LVGL is drawing from is never evicted.
+
+struct LvglImageCacheKey {
+    uint32_t hash;
+    uint32_t size;   // compressed size (cheap second check against hash collisions)
+};
+
+struct LvglImageCacheStats {
+    uint32_t hits;
+    uint32_t misses;
+    uint32_t bytes;     // decoded bytes currently cached
+    uint8_t entries;
+};
+
+LvglImageCacheKey lvgl_image_cache_key(const uint8_t* jpeg, size_t jpeg_size);
+
+// On hit: pins the entry and returns its pixels (owned by the cache) and dimensions.
+bool lvgl_image_cache_acquire(const LvglImageCacheKey& key, const uint16_t** pixels, int* w, int* h);
+
+// Offer a freshly decoded image. On success the cache owns it (copied into PSRAM when
+// it came from the image arena; `*pixels` is updated) and the entry is pinned.
+// On failure ownership stays with the caller.
+bool lvgl_image_cache_insert(const LvglImageCacheKey& key, uint16_t** pixels, int w, int h);
+
+// Unpin a buffer returned by acquire()/insert().
+void lvgl_image_cache_release(const uint16_t* pixels);
+
+void lvgl_image_cache_get_stats(LvglImageCacheStats* out);
+
+#else
+
+#define LVGL_IMAGE_CACHE_SUPPORTED 0
+
+#endif // LV_USE_IMG && LVGL_IMAGE_CACHE_BYTES > 0
+
+#endif // HAS_DISPLAY && HAS_IMAGE_API
+
+#ifndef LVGL_IMAGE_CACHE_SUPPORTED
+#define LVGL_IMAGE_CACHE_SUPPORTED 0
+#endif
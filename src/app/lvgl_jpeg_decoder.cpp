@@ -3,6 +3,11 @@
 #if HAS_DISPLAY && HAS_IMAGE_API
 
 #include "lvgl_jpeg_decoder.h"
+#include "rgb565_convert.h"
+#include "jpeg_hw_decoder.h"
+#include "app_alloc.h"
+#include "image_arena.h"
+#include "decode_slice.h"
 
 #if LV_USE_IMG
 
@@ -63,6 +68,7 @@ struct JpegOutputContext {
     uint16_t* dst = nullptr;
     int dst_w = 0;
     int dst_h = 0;
+    DecodeSlicer* slicer = nullptr;
 };
 
 struct JpegSessionContext {
@@ -89,9 +95,8 @@ static UINT jpeg_input_func(JDEC* jd, BYTE* buff, UINT nbyte) {
     return (UINT)to_read;
 }
 
-static inline uint16_t pack_rgb565(uint8_t r, uint8_t g, uint8_t b) {
-    return (uint16_t)(((r & 0xF8) << 8) | ((g & 0xFC) << 3) | (b >> 3));
-}
+// LV_IMG_CF_TRUE_COLOR pixels must match LVGL's in-memory color format.
+static constexpr Rgb565ConvertFn kConvertRow = rgb565_convert_rgb888<false, (bool)LVGL_COLOR_16_SWAP>;
 
 static UINT jpeg_output_to_rgb565(JDEC* jd, void* bitmap, JRECT* rect) {
     JpegSessionContext* session = (JpegSessionContext*)jd->device;
@@ -112,18 +117,10 @@ static UINT jpeg_output_to_rgb565(JDEC* jd, void* bitmap, JRECT* rect) {
     for (int row = 0; row < rect_h; row++) {
         const int y = rect->top + row;
         uint16_t* dst_row = out->dst + (size_t)y * (size_t)out->dst_w + (size_t)rect->left;
-        for (int col = 0; col < rect_w; col++) {
-            const uint8_t r = *src++;
-            const uint8_t g = *src++;
-            const uint8_t b = *src++;
-            dst_row[col] = pack_rgb565(r, g, b);
-        }
-
-        // Yield periodically to avoid watchdog issues on single-core boards.
-        if ((y & 0x07) == 0) {
-            taskYIELD();
-        }
+        kConvertRow(src, dst_row, rect_w);
+        src += rect_w * 3;
     }
+    if (out->slicer) out->slicer->checkpoint((uint32_t)rect_h);
 
     return 1;
 }
@@ -131,22 +128,34 @@ static UINT jpeg_output_to_rgb565(JDEC* jd, void* bitmap, JRECT* rect) {
 static void* alloc_any_8bit(size_t bytes) {
     if (bytes == 0) return nullptr;
 
-#if SOC_SPIRAM_SUPPORTED
-    if (heap_caps_get_total_size(MALLOC_CAP_SPIRAM) > 0) {
-        void* p = heap_caps_malloc(bytes, MALLOC_CAP_SPIRAM | MALLOC_CAP_8BIT);
-        if (p) return p;
-    }
-#endif
+    void* a = image_arena_alloc(bytes);
+    if (a) return a;
+
+    // Heap fallback is accounted as AllocTag::Image; image_arena_free() releases it.
+    return app_alloc(AllocTag::Image, bytes, AllocPolicy::Any8bit);
+}
 
-    void* p = heap_caps_malloc(bytes, MALLOC_CAP_INTERNAL | MALLOC_CAP_8BIT);
-    if (p) return p;
+// Largest TJpgDec scale (0..3) whose output still covers the fit box, i.e. the lv_img
+// zoom needed to "contain" the image stays <= 1x.
+static uint8_t pick_fit_scale(int src_w, int src_h, int fit_w, int fit_h) {
+    if (fit_w <= 0 || fit_h <= 0) return 0;
 
-    return heap_caps_malloc(bytes, MALLOC_CAP_8BIT);
+    uint8_t best = 0;
+    for (uint8_t scale = 1; scale <= 3; scale++) {
+        const int div = 1 << scale;
+        const int outw = (src_w + div - 1) / div;
+        const int outh = (src_h + div - 1) / div;
+        if (outw < fit_w && outh < fit_h) break;
+        best = scale;
+    }
+    return best;
 }
 
 bool lvgl_jpeg_decode_to_rgb565(
     const uint8_t* jpeg,
     size_t jpeg_size,
+    int fit_w,
+    int fit_h,
     uint16_t** out_pixels,
     int* out_w,
     int* out_h,
@@ -167,23 +176,7 @@ bool lvgl_jpeg_decode_to_rgb565(
 
     // TJpgDec work area.
     static const size_t kWorkSize = 4096;
-    bool work_is_caps = true;
-
-    void* work = nullptr;
-
-#if SOC_SPIRAM_SUPPORTED
-    if (heap_caps_get_total_size(MALLOC_CAP_SPIRAM) > 0) {
-        work = heap_caps_malloc(kWorkSize, MALLOC_CAP_SPIRAM | MALLOC_CAP_8BIT);
-    }
-#endif
-
-    if (!work) {
-        work = heap_caps_malloc(kWorkSize, MALLOC_CAP_INTERNAL | MALLOC_CAP_8BIT);
-    }
-    if (!work) {
-        work_is_caps = false;
-        work = malloc(kWorkSize);
-    }
+    void* work = app_alloc(AllocTag::Decode, kWorkSize, AllocPolicy::Any8bit);
     if (!work) {
         if (err && err_len) snprintf(err, err_len, "Out of memory (work buffer)");
         return false;
@@ -191,14 +184,50 @@ bool lvgl_jpeg_decode_to_rgb565(
 
     auto free_work = [&]() {
         if (!work) return;
-        if (work_is_caps) heap_caps_free(work);
-        else free(work);
+        app_free(AllocTag::Decode, work);
         work = nullptr;
     };
 
-    // Best-effort: try full-res first, then 1/2, 1/4, 1/8 if the heap is fragmented.
-    // TJpgDec scale factors: 0=1/1, 1=1/2, 2=1/4, 3=1/8
-    for (uint8_t scale = 0; scale <= 3; scale++) {
+    // Start at the scale that fits the target box, then fall back to 1/2, 1/4, 1/8
+    // if the heap is fragmented. TJpgDec scale factors: 0=1/1, 1=1/2, 2=1/4, 3=1/8
+    uint8_t first_scale = 0;
+    {
+        JDEC probe;
+        JpegSessionContext session;
+        session.input.data = jpeg;
+        session.input.size = jpeg_size;
+        session.input.pos = 0;
+        if (jd_prepare(&probe, jpeg_input_func, (void*)work, (UINT)kWorkSize, &session) == JDR_OK) {
+            first_scale = pick_fit_scale((int)probe.width, (int)probe.height, fit_w, fit_h);
+        }
+    }
+
+#if JPEG_HW_DECODER_SUPPORTED
+    // The hardware codec has no downscaler: only use it when TJpgDec would decode at 1/1.
+    if (first_scale == 0) {
+        JpegHwImage img;
+        char hw_err[96];
+        if (jpeg_hw_decode_rgb565(jpeg, jpeg_size, false, 0, 0, &img, hw_err, sizeof(hw_err))) {
+            // Repack MCU-padded rows in place (dst never overtakes src) into lv_color_t layout.
+            for (int y = 0; y < img.height; y++) {
+                uint16_t* dst = img.pixels + (size_t)y * img.width;
+                const uint16_t* src = img.pixels + (size_t)y * img.stride;
+                for (int x = 0; x < img.width; x++) {
+                    const uint16_t v = src[x];
+                    dst[x] = LVGL_COLOR_16_SWAP ? (uint16_t)((v << 8) | (v >> 8)) : v;
+                }
+            }
+            free_work();
+            *out_pixels = img.pixels;
+            *out_w = img.width;
+            *out_h = img.height;
+            if (out_scale_used) *out_scale_used = 0;
+            return true;
+        }
+    }
+#endif
+
+    for (uint8_t scale = first_scale; scale <= 3; scale++) {
         JDEC jd;
         JpegSessionContext session;
         session.input.data = jpeg;
@@ -238,9 +267,11 @@ bool lvgl_jpeg_decode_to_rgb565(
         session.output.dst_w = outw;
         session.output.dst_h = outh;
 
+        DecodeSlicer slicer;
+        session.output.slicer = &slicer;
         JRESULT dec = jd_decomp(&jd, jpeg_output_to_rgb565, scale);
         if (dec != JDR_OK) {
-            heap_caps_free(pixels);
+            image_arena_free(pixels);
             // Try smaller scale.
             continue;
         }
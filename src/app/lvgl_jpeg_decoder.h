@@ -13,12 +13,20 @@
 
 // Decode a baseline JPEG into an RGB565 pixel buffer.
 //
-// - Allocates the output buffer with heap_caps_malloc/malloc (caller owns).
+// - Allocates the output buffer from the image arena (heap fallback); caller owns
+//   it and releases it with image_arena_free().
 // - Returns false with a short error string on failure.
 // - output_bgr565 is not supported here; output is always RGB565.
+// - Pixels are byte-swapped when LVGL_COLOR_16_SWAP is set (matches lv_color_t).
+// - fit_w/fit_h (>0): pick the smallest TJpgDec scale (1/1..1/8) whose output
+//   still covers a fit_w x fit_h box (contain fit), so oversized images are
+//   never decoded at full resolution. 0 = start at full resolution.
+// - Smaller scales are still tried when the output buffer cannot be allocated.
 bool lvgl_jpeg_decode_to_rgb565(
     const uint8_t* jpeg,
     size_t jpeg_size,
+    int fit_w,
+    int fit_h,
     uint16_t** out_pixels,
     int* out_w,
     int* out_h,
@@ -0,0 +1,100 @@
+#include "lvgl_lock_stats.h"
+
+#include "log_manager.h"
+
+#include <Arduino.h>
+#include <esp_timer.h>
+#include <freertos/FreeRTOS.h>
+#include <freertos/portmacro.h>
+#include <string.h>
+
+static const char* const kSiteNames[(size_t)LvglLockSite::Count] = {
+    "render", "display", "image_api", "mjpeg", "slideshow", "touch", "bench", "other",
+};
+
+const char* lvgl_lock_site_name(LvglLockSite site) {
+    const size_t i = (size_t)site;
+    return (i < (size_t)LvglLockSite::Count) ? kSiteNames[i] : "?";
+}
+
+#if LVGL_LOCK_STATS
+
+// Between long-hold warnings of one site (a stuck decoder would log every frame).
+static constexpr uint32_t kLongHoldLogIntervalMs = 5000;
+
+static portMUX_TYPE s_mux = portMUX_INITIALIZER_UNLOCKED;
+static LvglLockSiteStats s_sites[(size_t)LvglLockSite::Count] = {};
+static uint32_t s_last_long_log_ms[(size_t)LvglLockSite::Count] = {};
+
+// Current holder: written while the mutex is held, so never raced.
+static LvglLockSite s_holder = LvglLockSite::Other;
+static int64_t s_hold_start_us = 0;
+
+static uint8_t bucket_for(uint32_t us) {
+    uint8_t b = 0;
+    for (uint32_t bound = 100; b < kLvglLockBuckets - 1 && us >= bound; bound *= 10) b++;
+    return b;
+}
+
+void lvgl_lock_stats_acquired(LvglLockSite site, uint32_t wait_us, bool contended) {
+    if ((size_t)site >= (size_t)LvglLockSite::Count) site = LvglLockSite::Other;
+    s_holder = site;
+    s_hold_start_us = esp_timer_get_time();
+
+    LvglLockSiteStats& s = s_sites[(size_t)site];
+    portENTER_CRITICAL(&s_mux);
+    s.acquisitions++;
+    if (contended) s.contended++;
+    if (wait_us > s.wait_max_us) s.wait_max_us = wait_us;
+    s.wait_hist[bucket_for(wait_us)]++;
+    portEXIT_CRITICAL(&s_mux);
+}
+
+uint32_t lvgl_lock_stats_releasing(LvglLockSite* site_out) {
+    const LvglLockSite site = s_holder;
+    const uint32_t hold_us = (uint32_t)(esp_timer_get_time() - s_hold_start_us);
+    if (site_out) *site_out = site;
+
+    LvglLockSiteStats& s = s_sites[(size_t)site];
+    portENTER_CRITICAL(&s_mux);
+    if (hold_us > s.hold_max_us) s.hold_max_us = hold_us;
+    s.hold_hist[bucket_for(hold_us)]++;
+    if (hold_us >= (uint32_t)LVGL_LOCK_LONG_HOLD_MS * 1000u) s.long_holds++;
+    portEXIT_CRITICAL(&s_mux);
+    return hold_us;
+}
+
+void lvgl_lock_stats_after_release(LvglLockSite site, uint32_t hold_us) {
+    if (hold_us < (uint32_t)LVGL_LOCK_LONG_HOLD_MS * 1000u) return;
+    if ((size_t)site >= (size_t)LvglLockSite::Count) return;
+
+    const uint32_t now = millis();
+    uint32_t& last = s_last_long_log_ms[(size_t)site];
+    if (last != 0 && (uint32_t)(now - last) < kLongHoldLogIntervalMs) return;
+    last = now ? now : 1;
+
+    LvglLockSiteStats s;
+    lvgl_lock_stats_get(site, &s);
+    LOGW("Display", "LVGL lock held %lu ms by %s (%lu long holds)",
+         (unsigned long)(hold_us / 1000), lvgl_lock_site_name(site), (unsigned long)s.long_holds);
+}
+
+void lvgl_lock_stats_timeout(LvglLockSite site, uint32_t wait_us) {
+    if ((size_t)site >= (size_t)LvglLockSite::Count) site = LvglLockSite::Other;
+    LvglLockSiteStats& s = s_sites[(size_t)site];
+    portENTER_CRITICAL(&s_mux);
+    s.timeouts++;
+    s.contended++;
+    if (wait_us > s.wait_max_us) s.wait_max_us = wait_us;
+    portEXIT_CRITICAL(&s_mux);
+}
+
+bool lvgl_lock_stats_get(LvglLockSite site, LvglLockSiteStats* out) {
+    if (!out || (size_t)site >= (size_t)LvglLockSite::Count) return false;
+    portENTER_CRITICAL(&s_mux);
+    *out = s_sites[(size_t)site];
+    portEXIT_CRITICAL(&s_mux);
+    return out->acquisitions != 0 || out->timeouts != 0;
+}
+
+#endif // LVGL_LOCK_STATS
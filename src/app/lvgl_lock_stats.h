@@ -0,0 +1,62 @@
+#pragma once
+
+#include "board_config.h"
+
+#include <stdint.h>
+
+// Wait/hold accounting for the LVGL mutex (DisplayManager::lock()).
+//
+// Every lock/tryLock names its caller with a LvglLockSite tag. Per site we keep
+// acquisitions, how many found the mutex taken (contended), tryLock timeouts,
+// the max wait and max hold, and decade histograms of both (<100 us, <1 ms,
+// <10 ms, <100 ms, <1 s, >= 1 s). A hold of LVGL_LOCK_LONG_HOLD_MS or more is
+// counted and logged with the site (rate-limited), which is what a "UI froze"
+// report needs: who held the lock, and for how long.
+//
+// Recording happens while the mutex is held, so the holder bookkeeping needs no
+// extra lock; the counters themselves sit behind a spinlock for readers.
+
+enum class LvglLockSite : uint8_t {
+    Render,      // LVGL task frame
+    Display,     // DisplayManager screen/splash/init calls from other tasks
+    ImageApi,    // uploads, strip/region decodes, URL and stream pipeline
+    Mjpeg,
+    Slideshow,
+    Touch,
+    Bench,
+    Other,
+    Count
+};
+
+static constexpr uint8_t kLvglLockBuckets = 6;
+
+struct LvglLockSiteStats {
+    uint32_t acquisitions;
+    uint32_t contended;      // mutex was taken when this site asked
+    uint32_t timeouts;       // tryLock gave up
+    uint32_t long_holds;     // held >= LVGL_LOCK_LONG_HOLD_MS
+    uint32_t wait_max_us;
+    uint32_t hold_max_us;
+    uint32_t wait_hist[kLvglLockBuckets];
+    uint32_t hold_hist[kLvglLockBuckets];
+};
+
+const char* lvgl_lock_site_name(LvglLockSite site);
+
+#if LVGL_LOCK_STATS
+
+// Mutex just acquired by `site` after waiting `wait_us` (holder only).
+void lvgl_lock_stats_acquired(LvglLockSite site, uint32_t wait_us, bool contended);
+
+// About to release (holder only). Returns the hold time; flags a long hold.
+uint32_t lvgl_lock_stats_releasing(LvglLockSite* site_out);
+
+// Call after the mutex was given back: logs a long hold reported by releasing().
+void lvgl_lock_stats_after_release(LvglLockSite site, uint32_t hold_us);
+
+void lvgl_lock_stats_timeout(LvglLockSite site, uint32_t wait_us);
+
+// Thread-safe copy; false for sites that never asked for the lock.
+bool lvgl_lock_stats_get(LvglLockSite site, LvglLockSiteStats* out);
+
+#endif // LVGL_LOCK_STATS
@@ -4,75 +4,172 @@
 
 #if HAS_MQTT
 
+#include "app_alloc.h"
 #include "ha_discovery.h"
 #include "device_telemetry.h"
 #include "log_manager.h"
 #include "energy_monitor.h"
+#include "energy_alarm.h"
+#include "energy_latency.h"
+#include "json_path_extract.h"
+#include "task_placement.h"
+#include "trace_ring.h"
+#include "wifi_power.h"
+
+#include <esp_heap_caps.h>
+#include "soc/soc_caps.h"
 
-#include <ctype.h>
 #include <math.h>
 #include <stdlib.h>
 
 static MqttManager* s_mqtt_manager_instance = nullptr;
 
-static float parse_float_from_payload(const uint8_t* payload, unsigned int length, bool* ok) {
-    if (ok) *ok = false;
-    if (!payload || length == 0) return NAN;
+// ============================================================================
+// Outbound queue
+// ============================================================================
+// Bounded multi-producer / single-consumer ring (Vyukov-style sequence numbers):
+// producers reserve a slot with a CAS on the head and publish it by bumping the
+// slot's sequence; the MQTT task is the only consumer. No locks, so a web handler
+// or timer publishing health never waits on a blocked socket.
+//
+// Sequence counters stay in internal RAM (atomics); slot payloads prefer PSRAM.
+static_assert((MQTT_OUTBOUND_QUEUE_DEPTH & (MQTT_OUTBOUND_QUEUE_DEPTH - 1)) == 0,
+              "MQTT_OUTBOUND_QUEUE_DEPTH must be a power of two");
+
+struct OutboundSlot {
+    bool retained;
+    uint16_t len;
+    char topic[CONFIG_MQTT_TOPIC_MAX_LEN];
+    uint8_t payload[MQTT_OUTBOUND_PAYLOAD_MAX];
+};
+
+static constexpr uint32_t kOutboundMask = MQTT_OUTBOUND_QUEUE_DEPTH - 1;
+static OutboundSlot* s_out_slots = nullptr;
+static std::atomic<uint32_t> s_out_seq[MQTT_OUTBOUND_QUEUE_DEPTH];
+static std::atomic<uint32_t> s_out_head{0};
+// Written by the consumer only; producers read it (relaxed) for the high-water mark.
+static std::atomic<uint32_t> s_out_tail{0};
+
+static std::atomic<uint32_t> s_out_enqueued{0};
+static std::atomic<uint32_t> s_out_sent{0};
+static std::atomic<uint32_t> s_out_send_failed{0};
+static std::atomic<uint32_t> s_out_dropped_full{0};
+static std::atomic<uint32_t> s_out_dropped_oversize{0};
+static std::atomic<uint32_t> s_out_high_water{0};
+
+static bool outbound_init() {
+    if (s_out_slots) return true;
+
+    const size_t bytes = sizeof(OutboundSlot) * MQTT_OUTBOUND_QUEUE_DEPTH;
+    void* p = app_alloc(AllocTag::Mqtt, bytes, AllocPolicy::PreferPsram);
+    if (!p) {
+        LOGE("MQTT", "Outbound queue alloc failed (%u bytes)", (unsigned)bytes);
+        return false;
+    }
+
+    for (uint32_t i = 0; i < MQTT_OUTBOUND_QUEUE_DEPTH; i++) {
+        s_out_seq[i].store(i, std::memory_order_relaxed);
+    }
+    s_out_head.store(0, std::memory_order_relaxed);
+    s_out_tail.store(0, std::memory_order_relaxed);
+    s_out_slots = (OutboundSlot*)p;
+    return true;
+}
 
-    // Fast path: parse a bare number without allocating/decoding JSON.
-    // Copy a small prefix to a temporary buffer and parse with strtod.
-    char tmp[64];
-    unsigned int i = 0;
-    while (i < length && isspace((int)payload[i])) i++;
-    unsigned int j = 0;
-    while (i < length && j < (sizeof(tmp) - 1)) {
-        char c = (char)payload[i];
-        if (c == '\0' || isspace((int)c) || c == ',' || c == '}' || c == ']') break;
-        tmp[j++] = c;
-        i++;
-    }
-    tmp[j] = 0;
-
-    if (j > 0) {
-        char* endp = nullptr;
-        double v = strtod(tmp, &endp);
-        if (endp && endp != tmp) {
-            if (ok) *ok = true;
-            return (float)v;
+static bool outbound_push(const char* topic, const uint8_t* payload, size_t len, bool retained) {
+    if (!s_out_slots) return false;
+
+    if (len > MQTT_OUTBOUND_PAYLOAD_MAX || strlen(topic) >= CONFIG_MQTT_TOPIC_MAX_LEN) {
+        s_out_dropped_oversize.fetch_add(1, std::memory_order_relaxed);
+        return false;
+    }
+
+    uint32_t pos = s_out_head.load(std::memory_order_relaxed);
+    while (true) {
+        const uint32_t seq = s_out_seq[pos & kOutboundMask].load(std::memory_order_acquire);
+        const int32_t dif = (int32_t)(seq - pos);
+        if (dif == 0) {
+            if (s_out_head.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed)) break;
+        } else if (dif < 0) {
+            s_out_dropped_full.fetch_add(1, std::memory_order_relaxed);
+            return false;
+        } else {
+            pos = s_out_head.load(std::memory_order_relaxed);
         }
     }
 
-    // Fallback: if payload is a JSON number, parse it as JSON.
-    StaticJsonDocument<256> doc;
-    DeserializationError err = deserializeJson(doc, payload, length);
-    if (!err && doc.is<float>()) {
-        if (ok) *ok = true;
-        return doc.as<float>();
+    OutboundSlot& slot = s_out_slots[pos & kOutboundMask];
+    strlcpy(slot.topic, topic, sizeof(slot.topic));
+    if (len > 0) memcpy(slot.payload, payload, len);
+    slot.len = (uint16_t)len;
+    slot.retained = retained;
+    s_out_seq[pos & kOutboundMask].store(pos + 1, std::memory_order_release);
+
+    s_out_enqueued.fetch_add(1, std::memory_order_relaxed);
+    // A stale tail only overstates the depth; the bound below discards that.
+    const uint32_t depth = (pos + 1) - s_out_tail.load(std::memory_order_relaxed);
+    uint32_t hw = s_out_high_water.load(std::memory_order_relaxed);
+    while (depth > hw && depth <= MQTT_OUTBOUND_QUEUE_DEPTH &&
+           !s_out_high_water.compare_exchange_weak(hw, depth, std::memory_order_relaxed)) {
     }
+    return true;
+}
+
+// Consumer side: returns the next ready slot (or nullptr) without releasing it.
+static OutboundSlot* outbound_peek() {
+    if (!s_out_slots) return nullptr;
+    const uint32_t pos = s_out_tail.load(std::memory_order_relaxed);
+    const uint32_t seq = s_out_seq[pos & kOutboundMask].load(std::memory_order_acquire);
+    if ((int32_t)(seq - (pos + 1)) < 0) return nullptr;
+    return &s_out_slots[pos & kOutboundMask];
+}
 
-    return NAN;
+static void outbound_release() {
+    const uint32_t pos = s_out_tail.load(std::memory_order_relaxed);
+    s_out_seq[pos & kOutboundMask].store(pos + MQTT_OUTBOUND_QUEUE_DEPTH, std::memory_order_release);
+    s_out_tail.store(pos + 1, std::memory_order_relaxed);
 }
 
+// value_path: "." (bare numeric payload) or a dotted/indexed JSON path such as
+// "value" or "data.power[0].value". Scans the payload in place (no JSON DOM),
+// so large Zigbee2MQTT/Shelly payloads cost neither stack nor heap.
 static float parse_value_using_path(const uint8_t* payload, unsigned int length, const char* value_path, bool* ok) {
     if (ok) *ok = false;
+    if (!payload || length == 0) return NAN;
 
-    if (!value_path || strlen(value_path) == 0 || strcmp(value_path, ".") == 0) {
-        return parse_float_from_payload(payload, length, ok);
+    double v = 0.0;
+    if (!json_path_extract_number((const char*)payload, (size_t)length, value_path, &v)) {
+        return NAN;
     }
+    if (ok) *ok = true;
+    return (float)v;
+}
 
-    // Minimal implementation: value_path is a top-level JSON key.
-    StaticJsonDocument<512> doc;
-    DeserializationError err = deserializeJson(doc, payload, length);
-    if (err) return NAN;
-
-    if (!doc.containsKey(value_path)) return NAN;
-    JsonVariant v = doc[value_path];
-    if (v.is<float>() || v.is<int>() || v.is<long>() || v.is<double>()) {
-        if (ok) *ok = true;
-        return v.as<float>();
+uint32_t mqtt_topic_hash(const char *topic, size_t *len_out) {
+    uint32_t h = 2166136261u;
+    size_t n = 0;
+    if (topic) {
+        while (topic[n] != '\0') {
+            h ^= (uint8_t)topic[n];
+            h *= 16777619u;
+            n++;
+        }
     }
+    if (len_out) *len_out = n;
+    return h;
+}
 
-    return NAN;
+uint32_t mqtt_energy_topics_fingerprint(const DeviceConfig *config) {
+    if (!config) return 0;
+
+    uint32_t fp = mqtt_topic_hash(config->mqtt_topic_solar, nullptr);
+    fp = (fp * 31u) ^ mqtt_topic_hash(config->mqtt_topic_grid, nullptr);
+    #if ENERGY_AUX_CHANNEL_COUNT > 0
+    for (unsigned i = 0; i < ENERGY_AUX_CHANNEL_COUNT; i++) {
+        fp = (fp * 31u) ^ mqtt_topic_hash(config->energy_aux_channels[i].topic, nullptr);
+    }
+    #endif
+    return fp;
 }
 
 static void mqtt_message_trampoline(char* topic, uint8_t* payload, unsigned int length) {
@@ -109,81 +206,283 @@ void MqttManager::begin(const DeviceConfig *config, const char *friendly_name, c
     snprintf(_base_topic, sizeof(_base_topic), "devices/%s", _sanitized_name);
     snprintf(_availability_topic, sizeof(_availability_topic), "%s/availability", _base_topic);
     snprintf(_health_state_topic, sizeof(_health_state_topic), "%s/health/state", _base_topic);
-
-    _client.setBufferSize(MQTT_MAX_PACKET_SIZE);
+    #if MQTT_TASK_STATS_PUBLISH
+    snprintf(_health_tasks_topic, sizeof(_health_tasks_topic), "%s/health/tasks", _base_topic);
+    #endif
+    snprintf(_alarm_topic, sizeof(_alarm_topic), "%s/energy/alarm", _base_topic);
+    snprintf(_energy_refresh_topic, sizeof(_energy_refresh_topic), "%s/energy/refresh", _base_topic);
+    #if WIFI_POWER_RTT_PROBE_MS > 0
+    snprintf(_rtt_topic, sizeof(_rtt_topic), "%s/rtt", _base_topic);
+    #endif
+
+    // Receive buffer sized for large subscription payloads; outbound JSON still
+    // uses MQTT_MAX_PACKET_SIZE stack buffers.
+    _client.setBufferSize(MQTT_RX_BUFFER_SIZE > MQTT_MAX_PACKET_SIZE ? MQTT_RX_BUFFER_SIZE : MQTT_MAX_PACKET_SIZE);
 
     _discovery_published_this_boot = false;
+    _discovery_cursor = 0;
+    _discovery_attempts = 0;
+    _discovery_skipped = 0;
     _last_reconnect_attempt_ms = 0;
     _last_health_publish_ms = 0;
+    _last_health_sample_ms = 0;
+    #if MQTT_HEALTH_DELTA_PUBLISH
+    _last_health_valid = false;
+    #endif
     _energy_subscriptions_active = false;
     _last_energy_subscribe_attempt_ms = 0;
+    _energy_subscribe_tries = 0;
+    _reconnect_backoff_ms = 5000;
+
+    outbound_init();
+}
+
+void MqttManager::rebuildEnergyRoutes() {
+    _energy_route_count = 0;
+    if (!_config) return;
+
+    auto add = [&](uint8_t channel, const char *topic, const char *value_path) {
+        if (!topic || topic[0] == '\0') return;
+        if (_energy_route_count >= kEnergyChannelCount) return;
+
+        size_t len = 0;
+        EnergyRoute &r = _energy_routes[_energy_route_count++];
+        r.hash = mqtt_topic_hash(topic, &len);
+        r.topic_len = (uint16_t)len;
+        r.channel = channel;
+        r.topic = topic;
+        r.value_path = value_path;
+        r.window_start_ms = 0;
+        r.msgs = 0;
+        r.parse_errors = 0;
+    };
+
+    add(ENERGY_CHANNEL_SOLAR, _config->mqtt_topic_solar, _config->mqtt_solar_value_path);
+    add(ENERGY_CHANNEL_GRID, _config->mqtt_topic_grid, _config->mqtt_grid_value_path);
+    #if ENERGY_AUX_CHANNEL_COUNT > 0
+    for (uint8_t i = 0; i < ENERGY_AUX_CHANNEL_COUNT; i++) {
+        const EnergyChannelConfig &ch = _config->energy_aux_channels[i];
+        add((uint8_t)(ENERGY_CHANNEL_AUX_FIRST + i), ch.topic, ch.value_path);
+    }
+    #endif
 }
 
 void MqttManager::subscribeEnergyMonitorTopics() {
     if (!_config) return;
     if (!_client.connected()) return;
 
+    rebuildEnergyRoutes();
+    _last_energy_subscribe_attempt_ms = millis();
+    if (_energy_subscribe_tries < 255) _energy_subscribe_tries++;
+
     bool any = false;
 
-    if (strlen(_config->mqtt_topic_solar) > 0) {
-        bool ok = _client.subscribe(_config->mqtt_topic_solar);
-        LOGI("MQTT", "Subscribe solar '%s': %s", _config->mqtt_topic_solar, ok ? "OK" : "FAIL");
-        any = any || ok;
-    }
-    if (strlen(_config->mqtt_topic_grid) > 0) {
-        bool ok = _client.subscribe(_config->mqtt_topic_grid);
-        LOGI("MQTT", "Subscribe grid '%s': %s", _config->mqtt_topic_grid, ok ? "OK" : "FAIL");
+    // SUBSCRIBEs go out back to back (PubSubClient does not wait for SUBACK); the
+    // broker answers each with the topic's retained value, if it has one.
+    for (uint8_t i = 0; i < _energy_route_count; i++) {
+        const EnergyRoute &r = _energy_routes[i];
+        char name_buf[CONFIG_ENERGY_CHANNEL_NAME_MAX_LEN];
+        const char *name = energy_monitor_channel_name(_config, r.channel, name_buf, sizeof(name_buf));
+        bool ok = _client.subscribe(r.topic, MQTT_ENERGY_SUBSCRIBE_QOS);
+        LOGI("MQTT", "Subscribe %s '%s': %s", name, r.topic, ok ? "OK" : "FAIL");
         any = any || ok;
     }
 
     _energy_subscriptions_active = any;
+    if (any) _energy_subscribed_ms = _last_energy_subscribe_attempt_ms;
+}
+
+// Channels without a value MQTT_ENERGY_RETAINED_WAIT_MS after subscribing had no
+// retained message: ask a companion (e.g. a Home Assistant automation republishing
+// the sensor states) once per connect via <base>/energy/refresh.
+void MqttManager::stepEnergyFastStart() {
+    #if MQTT_ENERGY_REFRESH_REQUEST
+    if (!_energy_subscriptions_active || _energy_refresh_sent) return;
+    if (millis() - _energy_subscribed_ms < (unsigned long)MQTT_ENERGY_RETAINED_WAIT_MS) return;
+    _energy_refresh_sent = true;
+
+    StaticJsonDocument<384> doc;
+    JsonArray channels = doc.createNestedArray("channels");
+    for (uint8_t i = 0; i < _energy_route_count; i++) {
+        const EnergyRoute &r = _energy_routes[i];
+        if (_energy_seen_mask & (1u << r.channel)) continue;
+        char name_buf[CONFIG_ENERGY_CHANNEL_NAME_MAX_LEN];
+        channels.add(energy_monitor_channel_name(_config, r.channel, name_buf, sizeof(name_buf)));
+    }
+    if (channels.size() == 0) return;
+
+    if (publishJson(_energy_refresh_topic, doc, false)) {
+        _energy_refresh_requests.fetch_add(1, std::memory_order_relaxed);
+        LOGI("MQTT", "No retained value for %u energy channel(s); refresh requested", (unsigned)channels.size());
+    }
+    #endif
 }
 
 void MqttManager::requestReconnect() {
+    // Applied by the MQTT task (PubSubClient is not thread-safe).
+    _reconnect_requested.store(true, std::memory_order_release);
+}
+
+void MqttManager::applyReconnectRequest() {
+    if (!_reconnect_requested.exchange(false, std::memory_order_acq_rel)) return;
+
     // Force PubSubClient to drop the current connection so ensureConnected()
     // uses the latest host/credentials/topics from _config.
     if (_client.connected()) {
         _client.disconnect();
     }
+    _connected.store(false, std::memory_order_relaxed);
 
     _energy_subscriptions_active = false;
+    _energy_route_count = 0;
     _last_reconnect_attempt_ms = 0;
+    _reconnect_backoff_ms = 5000;
     _last_energy_subscribe_attempt_ms = 0;
+    _energy_subscribe_tries = 0;
+}
+
+void MqttManager::taskEntry(void *param) {
+    MqttManager *self = (MqttManager *)param;
+    for (;;) {
+        self->loop();
+        // Idle slowly when MQTT is not configured; poll quickly while connected.
+        const uint32_t delay_ms = (self->enabled() && self->connected()) ? MQTT_TASK_POLL_MS : 100;
+        vTaskDelay(pdMS_TO_TICKS(delay_ms));
+    }
+}
+
+bool MqttManager::startTask() {
+    if (_task) return true;
+    if (!task_placement_create(AppTask::Mqtt, MqttManager::taskEntry, this, &_task, &_task_alloc)) {
+        LOGE("MQTT", "Task create failed; running from loop()");
+        _task = nullptr;
+        return false;
+    }
+    LOGI("MQTT", "Task started");
+    return true;
+}
+
+bool MqttManager::onMqttTask() const {
+    // Before the task exists, loop() runs MQTT inline: treat the caller as the owner.
+    return _task == nullptr || xTaskGetCurrentTaskHandle() == _task;
+}
+
+void MqttManager::getOutboundStats(MqttOutboundStats *out) const {
+    if (!out) return;
+    out->enqueued = s_out_enqueued.load(std::memory_order_relaxed);
+    out->sent = s_out_sent.load(std::memory_order_relaxed);
+    out->send_failed = s_out_send_failed.load(std::memory_order_relaxed);
+    out->dropped_full = s_out_dropped_full.load(std::memory_order_relaxed);
+    out->dropped_oversize = s_out_dropped_oversize.load(std::memory_order_relaxed);
+    const uint32_t depth = s_out_head.load(std::memory_order_relaxed) - s_out_tail.load(std::memory_order_relaxed);
+    out->depth = (uint16_t)(depth > MQTT_OUTBOUND_QUEUE_DEPTH ? MQTT_OUTBOUND_QUEUE_DEPTH : depth);
+    out->high_water = (uint16_t)s_out_high_water.load(std::memory_order_relaxed);
+}
+
+void MqttManager::getEnergyStartStats(MqttEnergyStartStats *out) const {
+    if (!out) return;
+    out->connects = _energy_connects.load(std::memory_order_relaxed);
+    out->first_value_ms = _energy_first_value_ms.load(std::memory_order_relaxed);
+    out->first_value_max_ms = _energy_first_value_max_ms.load(std::memory_order_relaxed);
+    out->refresh_requests = _energy_refresh_requests.load(std::memory_order_relaxed);
+}
+
+void MqttManager::drainOutbound() {
+    // Bounded per iteration so incoming messages keep flowing.
+    for (int i = 0; i < MQTT_OUTBOUND_QUEUE_DEPTH; i++) {
+        OutboundSlot *slot = outbound_peek();
+        if (!slot) return;
+
+        const bool ok = _client.connected() &&
+                        _client.publish(slot->topic, slot->payload, slot->len, slot->retained);
+        if (ok) {
+            s_out_sent.fetch_add(1, std::memory_order_relaxed);
+        } else {
+            s_out_send_failed.fetch_add(1, std::memory_order_relaxed);
+        }
+        outbound_release();
+    }
 }
 
 void MqttManager::handleIncomingMessage(const char *topic, const uint8_t *payload, unsigned int length) {
     if (!_config) return;
     if (!topic || !payload || length == 0) return;
+    TRACE_SCOPE(TraceEvent::MqttMessage);
 
+    #if WIFI_POWER_RTT_PROBE_MS > 0
+    if (_rtt_sent_ms != 0 && strcmp(topic, _rtt_topic) == 0) {
+        handleRttEcho(payload, length);
+        return;
+    }
+    #endif
+
+    #if ENERGY_LATENCY_SUPPORTED
+    energy_latency_on_receive();
+    #endif
     uint32_t now = millis();
 
-    if (strlen(_config->mqtt_topic_solar) > 0 && strcmp(topic, _config->mqtt_topic_solar) == 0) {
+    size_t topic_len = 0;
+    const uint32_t hash = mqtt_topic_hash(topic, &topic_len);
+
+    for (uint8_t i = 0; i < _energy_route_count; i++) {
+        EnergyRoute &r = _energy_routes[i];
+        if (r.hash != hash || r.topic_len != topic_len) continue;
+        if (strcmp(topic, r.topic) != 0) continue;
+
         bool ok = false;
-        float v = parse_value_using_path(payload, length, _config->mqtt_solar_value_path, &ok);
-        energy_monitor_set_solar(ok ? v : NAN, now);
-        char buf[24];
-        if (ok) {
-            snprintf(buf, sizeof(buf), "%.3f", (double)v);
-        } else {
-            strlcpy(buf, "NAN", sizeof(buf));
+        float v = parse_value_using_path(payload, length, r.value_path, &ok);
+        energy_monitor_set_channel(r.channel, ok ? v : NAN, now);
+        logEnergyIngest(r, ok, v, now);
+
+        _energy_seen_mask |= (1u << r.channel);
+        if (_energy_first_pending) {
+            _energy_first_pending = false;
+            const uint32_t ms = (uint32_t)(now - _energy_connack_ms);
+            _energy_first_value_ms.store(ms ? ms : 1, std::memory_order_relaxed);
+            if (ms > _energy_first_value_max_ms.load(std::memory_order_relaxed)) {
+                _energy_first_value_max_ms.store(ms, std::memory_order_relaxed);
+            }
+            LOGI("MQTT", "First energy value %lu ms after connect", (unsigned long)ms);
         }
-        LOGI("MQTT", "Energy solar update: %s -> %s", topic, buf);
         return;
     }
+}
 
-    if (strlen(_config->mqtt_topic_grid) > 0 && strcmp(topic, _config->mqtt_topic_grid) == 0) {
-        bool ok = false;
-        float v = parse_value_using_path(payload, length, _config->mqtt_grid_value_path, &ok);
-        energy_monitor_set_grid(ok ? v : NAN, now);
-        char buf[24];
-        if (ok) {
-            snprintf(buf, sizeof(buf), "%.3f", (double)v);
-        } else {
-            strlcpy(buf, "NAN", sizeof(buf));
-        }
-        LOGI("MQTT", "Energy grid update: %s -> %s", topic, buf);
+void MqttManager::logEnergyIngest(EnergyRoute &r, bool ok, float value, uint32_t now_ms) {
+    r.msgs++;
+    if (!ok) r.parse_errors++;
+
+    // The first message after (re)subscribing is always logged; after that, one
+    // summary per interval keeps serial output from eating loop time at 10 Hz.
+    const bool first = (r.window_start_ms == 0);
+    if (!first && ENERGY_INGEST_LOG_INTERVAL_MS > 0 &&
+        (uint32_t)(now_ms - r.window_start_ms) < (uint32_t)ENERGY_INGEST_LOG_INTERVAL_MS) {
         return;
     }
+
+    char buf[24];
+    if (ok) {
+        snprintf(buf, sizeof(buf), "%.3f", (double)value);
+    } else {
+        strlcpy(buf, "NAN", sizeof(buf));
+    }
+    char name_buf[CONFIG_ENERGY_CHANNEL_NAME_MAX_LEN];
+    const char *name = energy_monitor_channel_name(_config, r.channel, name_buf, sizeof(name_buf));
+
+    if (first || ENERGY_INGEST_LOG_INTERVAL_MS == 0) {
+        LOGI("MQTT", "Energy %s update: %s -> %s", name, r.topic, buf);
+    } else {
+        const uint32_t window_ms = (uint32_t)(now_ms - r.window_start_ms);
+        const float rate = window_ms > 0 ? ((float)r.msgs * 1000.0f / (float)window_ms) : 0.0f;
+        LOGI("MQTT", "Energy %s: %lu msgs (%.1f/s), %lu coalesced, %lu parse errors, last %s",
+             name, (unsigned long)r.msgs, (double)rate,
+             (unsigned long)energy_monitor_take_coalesced(r.channel),
+             (unsigned long)r.parse_errors, buf);
+    }
+
+    r.window_start_ms = now_ms ? now_ms : 1;
+    r.msgs = 0;
+    r.parse_errors = 0;
 }
 
 bool MqttManager::connectEnabled() const {
@@ -194,7 +493,16 @@ bool MqttManager::connectEnabled() const {
 
 uint16_t MqttManager::resolvedPort() const {
     if (!_config) return 1883;
-    return _config->mqtt_port > 0 ? _config->mqtt_port : 1883;
+    if (_config->mqtt_port > 0) return _config->mqtt_port;
+    return tlsEnabled() ? 8883 : 1883;
+}
+
+bool MqttManager::tlsEnabled() const {
+    #if MQTT_TLS_ENABLED
+    return _config && _config->mqtt_tls;
+    #else
+    return false;
+    #endif
 }
 
 bool MqttManager::enabled() const {
@@ -209,15 +517,21 @@ bool MqttManager::publishEnabled() const {
     return _config->mqtt_interval_seconds > 0;
 }
 
-bool MqttManager::connected() {
-    return _client.connected();
+bool MqttManager::publishRaw(const char *topic, const uint8_t *payload, size_t len, bool retained) {
+    if (!enabled()) return false;
+
+    if (!onMqttTask()) {
+        if (!connected()) return false;
+        return outbound_push(topic, payload, len, retained);
+    }
+
+    if (!_client.connected()) return false;
+    return _client.publish(topic, payload, (unsigned)len, retained);
 }
 
 bool MqttManager::publish(const char *topic, const char *payload, bool retained) {
-    if (!enabled() || !_client.connected()) return false;
     if (!topic || !payload) return false;
-
-    return _client.publish(topic, payload, retained);
+    return publishRaw(topic, (const uint8_t*)payload, strlen(payload), retained);
 }
 
 bool MqttManager::publishJson(const char *topic, JsonDocument &doc, bool retained) {
@@ -231,8 +545,7 @@ bool MqttManager::publishJson(const char *topic, JsonDocument &doc, bool retaine
         return false;
     }
 
-    if (!enabled() || !_client.connected()) return false;
-    return _client.publish(topic, (const uint8_t*)payload, (unsigned)n, retained);
+    return publishRaw(topic, (const uint8_t*)payload, n, retained);
 }
 
 bool MqttManager::publishImmediate(const char *topic, const char *payload, bool retained) {
@@ -244,32 +557,159 @@ void MqttManager::publishAvailability(bool online) {
     _client.publish(_availability_topic, online ? "online" : "offline", true);
 }
 
-void MqttManager::publishDiscoveryOncePerBoot() {
+// Alarm episodes start/end at most a few times per minute (clear delay +
+// hysteresis), so every gated change is published right away.
+void MqttManager::publishAlarmIfChanged() {
+    const uint32_t generation = energy_alarm_generation();
+    if (_alarm_published && generation == _alarm_published_generation) return;
+    // A change between the two reads only leaves the generation behind: republished next loop.
+    const bool active = energy_alarm_active();
+    if (_client.publish(_alarm_topic, active ? "ON" : "OFF", true)) {
+        _alarm_published = true;
+        _alarm_published_generation = generation;
+    }
+}
+
+bool MqttManager::streamBegin(const char *topic, size_t len, bool retained) {
+    if (!onMqttTask() || !_client.connected()) return false;
+    return _client.beginPublish(topic, (unsigned int)len, retained);
+}
+
+size_t MqttManager::streamWrite(const uint8_t *data, size_t len) {
+    return _client.write(data, len);
+}
+
+bool MqttManager::streamEnd() {
+    return _client.endPublish() == 1;
+}
+
+void MqttManager::startDiscovery() {
     if (_discovery_published_this_boot) return;
 
-    LOGI("MQTT", "Publishing HA discovery");
-    ha_discovery_publish_health(*this);
-    _discovery_published_this_boot = true;
+    // Jittered start so a broker restart does not get every device's discovery at once.
+    const uint32_t jitter = HA_DISCOVERY_START_JITTER_MS > 0 ? (esp_random() % (HA_DISCOVERY_START_JITTER_MS + 1)) : 0;
+    _discovery_next_ms = millis() + jitter;
+    _discovery_attempts = 0;
+    LOGI("MQTT", "Publishing HA discovery (%u entities, from #%u, in %lums)",
+         (unsigned)ha_discovery_entity_count(), (unsigned)_discovery_cursor, (unsigned long)jitter);
 }
 
-void MqttManager::publishHealthNow() {
-    if (!_client.connected()) return;
+void MqttManager::stepDiscovery() {
+    if (_discovery_published_this_boot) return;
 
-    StaticJsonDocument<768> doc;
-    device_telemetry_fill_mqtt(doc);
+    const unsigned long now = millis();
+    if ((long)(now - _discovery_next_ms) < 0) return;
+
+    const size_t count = ha_discovery_entity_count();
+    for (int i = 0; i < HA_DISCOVERY_ENTITIES_PER_TICK && _discovery_cursor < count; i++) {
+        if (ha_discovery_publish_entity(*this, _discovery_cursor)) {
+            _discovery_cursor++;
+            _discovery_attempts = 0;
+            continue;
+        }
 
+        if (++_discovery_attempts >= HA_DISCOVERY_MAX_ATTEMPTS) {
+            LOGW("MQTT", "HA discovery entity #%u failed, skipping", (unsigned)_discovery_cursor);
+            _discovery_cursor++;
+            _discovery_skipped++;
+            _discovery_attempts = 0;
+        }
+        _discovery_next_ms = now + HA_DISCOVERY_RETRY_MS;
+        return;
+    }
+
+    if (_discovery_cursor >= count) {
+        _discovery_published_this_boot = true;
+        LOGI("MQTT", "HA discovery done (%u skipped)", (unsigned)_discovery_skipped);
+        return;
+    }
+    _discovery_next_ms = now + HA_DISCOVERY_TICK_MS;
+}
+
+#if MQTT_HEALTH_TEMPLATE
+bool MqttManager::publishHealthValues(const DeviceHealthValues &values, const char *payload, size_t len) {
+    char buffer[MQTT_MAX_PACKET_SIZE];
+    if (!payload) {
+        len = device_telemetry_render_mqtt(values, buffer, sizeof(buffer));
+        payload = buffer;
+    }
+    if (len == 0 || len >= sizeof(buffer)) {
+        LOGE("MQTT", "Health JSON payload too large for MQTT_MAX_PACKET_SIZE (%u)", (unsigned)sizeof(buffer));
+        return false;
+    }
+
+    if (!_client.publish(_health_state_topic, (const uint8_t*)payload, (unsigned)len, true)) {
+        return false;
+    }
+
+    #if MQTT_HEALTH_DELTA_PUBLISH
+    _last_health_values = values;
+    _last_health_valid = true;
+    #endif
+    return true;
+}
+#else
+bool MqttManager::publishHealthDoc(const JsonDocument &doc, const char *payload, size_t len) {
     if (doc.overflowed()) {
         LOGE("MQTT", "Health JSON overflow (StaticJsonDocument too small)");
-        return;
+        return false;
     }
 
-    char payload[MQTT_MAX_PACKET_SIZE];
-    size_t n = serializeJson(doc, payload, sizeof(payload));
-    if (n == 0 || n >= sizeof(payload)) {
-        LOGE("MQTT", "Health JSON payload too large for MQTT_MAX_PACKET_SIZE (%u)", (unsigned)sizeof(payload));
+    char buffer[MQTT_MAX_PACKET_SIZE];
+    if (!payload) {
+        len = serializeJson(doc, buffer, sizeof(buffer));
+        payload = buffer;
+    }
+    if (len == 0 || len >= sizeof(buffer)) {
+        LOGE("MQTT", "Health JSON payload too large for MQTT_MAX_PACKET_SIZE (%u)", (unsigned)sizeof(buffer));
+        return false;
+    }
+
+    if (!_client.publish(_health_state_topic, (const uint8_t*)payload, (unsigned)len, true)) {
+        return false;
+    }
+
+    #if MQTT_HEALTH_DELTA_PUBLISH
+    _last_health_doc = doc;
+    _last_health_valid = !_last_health_doc.overflowed();
+    #endif
+    return true;
+}
+#endif
+
+// Optional diagnostic (MQTT_TASK_STATS_PUBLISH): per-task CPU breakdown, not retained.
+void MqttManager::publishTaskStats() {
+    #if MQTT_TASK_STATS_PUBLISH
+    StaticJsonDocument<1024> doc;
+    if (!device_telemetry_fill_tasks(doc, MQTT_TASK_STATS_TOP)) return;
+    publishJson(_health_tasks_topic, doc, false);
+    #endif
+}
+
+void MqttManager::publishHealthNow() {
+    if (!_client.connected()) return;
+
+    #if HEALTH_SNAPSHOT_ENABLED
+    std::shared_ptr<const DeviceHealthSnapshot> snap = device_telemetry_get_health_snapshot();
+    if (snap) {
+        #if MQTT_HEALTH_TEMPLATE
+        publishHealthValues(snap->mqtt_values, snap->mqtt_json, snap->mqtt_len);
+        #else
+        publishHealthDoc(snap->mqtt_doc, snap->mqtt_json, snap->mqtt_len);
+        #endif
         return;
     }
-    _client.publish(_health_state_topic, (const uint8_t*)payload, (unsigned)n, true);
+    #endif
+
+    #if MQTT_HEALTH_TEMPLATE
+    DeviceHealthValues values;
+    device_telemetry_collect_mqtt(&values);
+    publishHealthValues(values);
+    #else
+    StaticJsonDocument<kDeviceTelemetryMqttDocCapacity> doc;
+    device_telemetry_fill_mqtt(doc);
+    publishHealthDoc(doc);
+    #endif
 }
 
 void MqttManager::publishHealthIfDue() {
@@ -279,28 +719,67 @@ void MqttManager::publishHealthIfDue() {
     unsigned long now = millis();
     unsigned long interval_ms = (unsigned long)_config->mqtt_interval_seconds * 1000UL;
 
-    if (_last_health_publish_ms == 0 || (now - _last_health_publish_ms) >= interval_ms) {
-        StaticJsonDocument<768> doc;
-        device_telemetry_fill_mqtt(doc);
-
-        if (doc.overflowed()) {
-            LOGE("MQTT", "Health JSON overflow (StaticJsonDocument too small)");
-            return;
-        }
-
-        char payload[MQTT_MAX_PACKET_SIZE];
-        size_t n = serializeJson(doc, payload, sizeof(payload));
-        if (n == 0 || n >= sizeof(payload)) {
-            LOGE("MQTT", "Health JSON payload too large for MQTT_MAX_PACKET_SIZE (%u)", (unsigned)sizeof(payload));
-            return;
-        }
-
-        bool ok = _client.publish(_health_state_topic, (const uint8_t*)payload, (unsigned)n, true);
+    // mqtt_interval_seconds is the sampling period. In delta mode a sample is only
+    // published when a field crossed its deadband or the keepalive expired.
+    const unsigned long last_sample = _last_health_sample_ms ? _last_health_sample_ms : _last_health_publish_ms;
+    if (last_sample != 0 && (now - last_sample) < interval_ms) return;
+    _last_health_sample_ms = now;
+
+    // The snapshot (when available) is at most ~1 s old; fall back to a fresh fill.
+    #if HEALTH_SNAPSHOT_ENABLED
+    std::shared_ptr<const DeviceHealthSnapshot> snap = device_telemetry_get_health_snapshot();
+    #endif
+    #if MQTT_HEALTH_TEMPLATE
+    DeviceHealthValues fresh;
+    const DeviceHealthValues* values = &fresh;
+    #else
+    StaticJsonDocument<kDeviceTelemetryMqttDocCapacity> fresh;
+    const JsonDocument* doc = &fresh;
+    #endif
+    const char* payload = nullptr;
+    size_t payload_len = 0;
+    #if HEALTH_SNAPSHOT_ENABLED
+    if (snap) {
+        #if MQTT_HEALTH_TEMPLATE
+        values = &snap->mqtt_values;
+        #else
+        doc = &snap->mqtt_doc;
+        #endif
+        payload = snap->mqtt_json;
+        payload_len = snap->mqtt_len;
+    }
+    #endif
+    if (!payload) {
+        #if MQTT_HEALTH_TEMPLATE
+        device_telemetry_collect_mqtt(&fresh);
+        #else
+        device_telemetry_fill_mqtt(fresh);
+        #endif
+    }
 
-        if (ok) {
-            _last_health_publish_ms = now;
-        }
+    #if MQTT_HEALTH_DELTA_PUBLISH
+    const bool keepalive_due = _last_health_publish_ms == 0 ||
+        (now - _last_health_publish_ms) >= (unsigned long)MQTT_HEALTH_MAX_INTERVAL_S * 1000UL;
+    #if MQTT_HEALTH_TEMPLATE
+    const bool changed = !_last_health_valid || device_telemetry_mqtt_values_changed(_last_health_values, *values);
+    #else
+    const bool changed = !_last_health_valid || device_telemetry_mqtt_changed(_last_health_doc, *doc);
+    #endif
+    if (!keepalive_due && !changed) {
+        _health_suppressed++;
+        return;
+    }
+    #endif
+
+    #if MQTT_HEALTH_TEMPLATE
+    const bool published = publishHealthValues(*values, payload, payload_len);
+    #else
+    const bool published = publishHealthDoc(*doc, payload, payload_len);
+    #endif
+    if (published) {
+        _last_health_publish_ms = now;
     }
+    publishTaskStats();
 }
 
 void MqttManager::ensureConnected() {
@@ -309,12 +788,22 @@ void MqttManager::ensureConnected() {
 
     if (_client.connected()) return;
 
+    // Exponential backoff (5 s doubling up to MQTT_RECONNECT_BACKOFF_MAX_MS) so an
+    // unreachable broker costs one blocking connect attempt per window, on this task only.
     unsigned long now = millis();
-    if (_last_reconnect_attempt_ms > 0 && (now - _last_reconnect_attempt_ms) < 5000) {
+    if (_last_reconnect_attempt_ms > 0 && (now - _last_reconnect_attempt_ms) < _reconnect_backoff_ms) {
         return;
     }
     _last_reconnect_attempt_ms = now;
 
+    #if MQTT_TLS_ENABLED
+    // The TLS client keeps its session cache across reconnects (fast resumption).
+    if (tlsEnabled()) {
+        _client.setClient(_tls);
+    } else {
+        _client.setClient(_net);
+    }
+    #endif
     _client.setServer(_config->mqtt_host, resolvedPort());
 
     // Client ID: sanitized name
@@ -324,7 +813,7 @@ void MqttManager::ensureConnected() {
     bool has_user = strlen(_config->mqtt_username) > 0;
     bool has_pass = strlen(_config->mqtt_password) > 0;
 
-    LOGI("MQTT", "Connecting to %s:%d", _config->mqtt_host, resolvedPort());
+    LOGI("MQTT", "Connecting to %s:%d%s", _config->mqtt_host, resolvedPort(), tlsEnabled() ? " (TLS)" : "");
 
     bool connected = false;
     if (has_user) {
@@ -350,40 +839,125 @@ void MqttManager::ensureConnected() {
 
     if (connected) {
         LOGI("MQTT", "Connected");
-        publishAvailability(true);
-        publishDiscoveryOncePerBoot();
-
-        // Subscribe after connect so we receive Energy Monitor updates.
+        _connected.store(true, std::memory_order_relaxed);
+        _reconnect_backoff_ms = 5000;
+
+        // Subscribe right after CONNACK, ahead of the availability/health publishes,
+        // so retained energy values are already on their way while those go out.
+        _energy_connack_ms = millis();
+        _energy_seen_mask = 0;
+        _energy_first_pending = true;
+        _energy_refresh_sent = false;
+        _energy_subscribe_tries = 0;
+        _energy_first_value_ms.store(0, std::memory_order_relaxed);
+        _energy_connects.fetch_add(1, std::memory_order_relaxed);
         subscribeEnergyMonitorTopics();
 
+        publishAvailability(true);
+        startDiscovery();
+        _alarm_published = false;
+        #if WIFI_POWER_RTT_PROBE_MS > 0
+        _rtt_subscribed = false;
+        _rtt_sent_ms = 0;
+        #endif
+
         // Publish a single retained state after connect so HA entities have values,
         // even when periodic publishing is disabled (interval = 0).
         publishHealthNow();
 
         // If periodic publishing is enabled, start interval timing from now.
         _last_health_publish_ms = millis();
+        _last_health_sample_ms = 0;
     } else {
-        LOGW("MQTT", "Connect failed (state %d)", _client.state());
+        _reconnect_backoff_ms = (_reconnect_backoff_ms * 2 > MQTT_RECONNECT_BACKOFF_MAX_MS)
+            ? MQTT_RECONNECT_BACKOFF_MAX_MS
+            : _reconnect_backoff_ms * 2;
+        LOGW("MQTT", "Connect failed (state %d), retry in %lus", _client.state(), (unsigned long)(_reconnect_backoff_ms / 1000));
         _energy_subscriptions_active = false;
     }
 }
 
 void MqttManager::loop() {
-    if (!enabled()) return;
+    applyReconnectRequest();
+
+    if (!enabled()) {
+        _connected.store(false, std::memory_order_relaxed);
+        return;
+    }
 
     ensureConnected();
 
-    if (_client.connected()) {
+    const bool is_connected = _client.connected();
+    _connected.store(is_connected, std::memory_order_relaxed);
+
+    // Queued publishes from other tasks (dropped and counted while disconnected).
+    drainOutbound();
+
+    if (is_connected) {
         _client.loop();
+        stepDiscovery();
         if (!_energy_subscriptions_active) {
+            // The first retries follow on the next iterations; then every 5 s.
             unsigned long now = millis();
-            if (_last_energy_subscribe_attempt_ms == 0 || (now - _last_energy_subscribe_attempt_ms) >= 5000) {
-                _last_energy_subscribe_attempt_ms = now;
+            if (_energy_subscribe_tries < MQTT_ENERGY_SUBSCRIBE_FAST_RETRIES ||
+                (now - _last_energy_subscribe_attempt_ms) >= 5000) {
                 subscribeEnergyMonitorTopics();
             }
         }
+        stepEnergyFastStart();
         publishHealthIfDue();
+        publishAlarmIfChanged();
+        #if WIFI_POWER_RTT_PROBE_MS > 0
+        stepRttProbe();
+        #endif
+    }
+    #if WIFI_POWER_RTT_PROBE_MS > 0
+    else {
+        _rtt_subscribed = false;
+        _rtt_sent_ms = 0;
     }
+    #endif
+}
+
+#if WIFI_POWER_RTT_PROBE_MS > 0
+// Broker round trip: publish a token to an own (non-retained) topic and time the
+// echo. Measured under the current WiFi power-save profile (wifi_power.h).
+void MqttManager::stepRttProbe() {
+    const unsigned long now = millis();
+    if (!_rtt_subscribed) {
+        _rtt_subscribed = _client.subscribe(_rtt_topic);
+        _rtt_next_ms = now + (unsigned long)WIFI_POWER_RTT_PROBE_MS;
+        return;
+    }
+
+    if (_rtt_sent_ms != 0) {
+        if (now - _rtt_sent_ms >= kRttProbeTimeoutMs) {
+            _rtt_sent_ms = 0;
+            wifi_power_record_rtt_lost();
+        }
+        return;
+    }
+    if ((long)(now - _rtt_next_ms) < 0) return;
+
+    _rtt_next_ms = now + (unsigned long)WIFI_POWER_RTT_PROBE_MS;
+    _rtt_token++;
+    char payload[12];
+    const int len = snprintf(payload, sizeof(payload), "%lu", (unsigned long)_rtt_token);
+    if (publishRaw(_rtt_topic, (const uint8_t *)payload, (size_t)len, false)) {
+        _rtt_sent_ms = now ? now : 1;
+    }
+}
+
+void MqttManager::handleRttEcho(const uint8_t *payload, unsigned int length) {
+    char buf[12];
+    const size_t n = length < sizeof(buf) - 1 ? length : sizeof(buf) - 1;
+    memcpy(buf, payload, n);
+    buf[n] = '\0';
+    if (strtoul(buf, nullptr, 10) != _rtt_token) return;  // late echo of an earlier probe
+    const unsigned long rtt = millis() - _rtt_sent_ms;
+    _rtt_sent_ms = 0;
+    wifi_power_record_rtt((uint32_t)rtt);
 }
+#endif
 
 #endif // HAS_MQTT
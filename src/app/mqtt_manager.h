@@ -16,12 +16,46 @@
 #include <ArduinoJson.h>
 
 #include "config_manager.h"
+#include "device_telemetry.h"
+#include "energy_monitor.h"
+#include "rtos_task_utils.h"
+#include "mqtt_tls_client.h"
+
+#include <atomic>
+
+// Outbound queue counters (publishes issued from tasks other than the MQTT task).
+struct MqttOutboundStats {
+    uint32_t enqueued;
+    uint32_t sent;
+    uint32_t send_failed;       // dequeued while disconnected or rejected by PubSubClient
+    uint32_t dropped_full;      // backpressure: queue full, publish() returned false
+    uint32_t dropped_oversize;  // payload > MQTT_OUTBOUND_PAYLOAD_MAX
+    uint16_t depth;
+    uint16_t high_water;
+};
+
+// Connect-to-first-energy-value timing ("fast start": retained values, then a refresh
+// request on <base>/energy/refresh for the channels still missing).
+struct MqttEnergyStartStats {
+    uint32_t connects;            // connects since boot
+    uint32_t first_value_ms;      // CONNACK -> first energy value, newest connect (0 = none yet)
+    uint32_t first_value_max_ms;  // slowest since boot
+    uint32_t refresh_requests;    // refresh requests published
+};
 
 class MqttManager {
 public:
     MqttManager();
 
     void begin(const DeviceConfig *config, const char *friendly_name, const char *sanitized_name);
+
+    // Run the MQTT client in its own task (AppTask::Mqtt), so broker connects and
+    // socket timeouts never stall Arduino loop(). Returns false if the task could
+    // not be created; loop() must then be called from the Arduino loop instead.
+    bool startTask();
+    bool taskRunning() const { return _task != nullptr; }
+
+    // One iteration of connect/poll/publish work (MQTT task, or loop() fallback).
     void loop();
 
     // Request a reconnect (applies updated MQTT settings/topics).
@@ -32,11 +66,23 @@ public:
 
     bool enabled() const;
     bool publishEnabled() const;
-    bool connected();
+    bool connected() const { return _connected.load(std::memory_order_relaxed); }
+
+    void getOutboundStats(MqttOutboundStats *out) const;
+    void getEnergyStartStats(MqttEnergyStartStats *out) const;
+
+    // True when the configured transport is TLS (mqtt_tls + MQTT_TLS_ENABLED).
+    bool tlsEnabled() const;
+    #if MQTT_TLS_ENABLED
+    void getTlsStats(MqttTlsStats *out) const { _tls.getStats(out); }
+    #endif
 
     unsigned long lastHealthPublishMs() const { return _last_health_publish_ms; }
+    // Health samples skipped by delta publishing (MQTT_HEALTH_DELTA_PUBLISH).
+    uint32_t healthPublishesSuppressed() const { return _health_suppressed; }
 
-    // Publish helpers
+    // Publish helpers. Safe from any task: calls from outside the MQTT task are
+    // copied into the bounded outbound queue (false = dropped, see stats).
     bool publish(const char *topic, const char *payload, bool retained);
     bool publishJson(const char *topic, JsonDocument &doc, bool retained);
 
@@ -51,18 +97,48 @@ public:
     const char *friendlyName() const { return _friendly_name; }
     const char *sanitizedName() const { return _sanitized_name; }
 
+    // Streamed publish (MQTT task only): payload length must be known up front,
+    // but the payload itself never has to fit MQTT_MAX_PACKET_SIZE.
+    bool streamBegin(const char *topic, size_t len, bool retained);
+    size_t streamWrite(const uint8_t *data, size_t len);
+    bool streamEnd();
+
 private:
+    static void taskEntry(void *param);
+    bool onMqttTask() const;
+    bool publishRaw(const char *topic, const uint8_t *payload, size_t len, bool retained);
+    void drainOutbound();
+    void applyReconnectRequest();
+
     void ensureConnected();
     void publishAvailability(bool online);
-    void publishDiscoveryOncePerBoot();
+    // payload/len: pre-serialized form of doc/values (health snapshot); serialized here when null.
+    #if MQTT_HEALTH_TEMPLATE
+    bool publishHealthValues(const DeviceHealthValues &values, const char *payload = nullptr, size_t len = 0);
+    #else
+    bool publishHealthDoc(const JsonDocument &doc, const char *payload = nullptr, size_t len = 0);
+    #endif
+    void publishTaskStats();
+    void startDiscovery();
+    void stepDiscovery();
     void publishHealthNow();
     void publishHealthIfDue();
     void subscribeEnergyMonitorTopics();
+    void rebuildEnergyRoutes();
+    void stepEnergyFastStart();
 
     bool connectEnabled() const;
     uint16_t resolvedPort() const;
+    #if WIFI_POWER_RTT_PROBE_MS > 0
+    void stepRttProbe();
+    void handleRttEcho(const uint8_t *payload, unsigned int length);
+    #endif
+    void publishAlarmIfChanged();
 
     WiFiClient _net;
+    #if MQTT_TLS_ENABLED
+    MqttTlsClient _tls;
+    #endif
     PubSubClient _client;
 
     const DeviceConfig *_config = nullptr;
@@ -72,13 +148,86 @@ private:
     char _base_topic[96] = {0};
     char _availability_topic[128] = {0};
     char _health_state_topic[128] = {0};
-
+    #if MQTT_TASK_STATS_PUBLISH
+    char _health_tasks_topic[128] = {0};
+    #endif
+    // Gated energy alarm (energy_alarm.h), retained ON/OFF; republished after every connect.
+    char _alarm_topic[128] = {0};
+    bool _alarm_published = false;
+    uint32_t _alarm_published_generation = 0;
+    #if WIFI_POWER_RTT_PROBE_MS > 0
+    // Round-trip probe (WIFI_POWER_RTT_PROBE_MS): one token in flight at a time.
+    static constexpr unsigned long kRttProbeTimeoutMs = 10000;
+    char _rtt_topic[128] = {0};
+    bool _rtt_subscribed = false;
+    uint32_t _rtt_token = 0;
+    unsigned long _rtt_sent_ms = 0;  // 0 = no probe in flight
+    unsigned long _rtt_next_ms = 0;
+    #endif
+
+    // Energy topic dispatch table (rebuilt on every (re)subscribe). Incoming topics
+    // are hashed once and compared by hash + length; strcmp only confirms a hit.
+    struct EnergyRoute {
+        uint32_t hash;
+        uint16_t topic_len;
+        uint8_t channel;
+        const char *topic;
+        const char *value_path;
+
+        // Log sampling (ENERGY_INGEST_LOG_INTERVAL_MS): counters since the last summary.
+        uint32_t window_start_ms;
+        uint32_t msgs;
+        uint32_t parse_errors;
+    };
+    void logEnergyIngest(EnergyRoute &route, bool ok, float value, uint32_t now_ms);
+    EnergyRoute _energy_routes[kEnergyChannelCount] = {};
+    uint8_t _energy_route_count = 0;
+
+    // HA discovery cursor: advanced a few entities per loop() iteration and kept
+    // across reconnects, so discovery is completed once per boot.
     bool _discovery_published_this_boot = false;
+    uint16_t _discovery_cursor = 0;
+    uint8_t _discovery_attempts = 0;
+    uint16_t _discovery_skipped = 0;
+    unsigned long _discovery_next_ms = 0;
     bool _energy_subscriptions_active = false;
 
+    TaskHandle_t _task = nullptr;
+    RtosTaskPsramAlloc _task_alloc = {};
+
+    std::atomic<bool> _connected{false};
+    std::atomic<bool> _reconnect_requested{false};
+    uint32_t _reconnect_backoff_ms = 5000;
+
     unsigned long _last_reconnect_attempt_ms = 0;
     unsigned long _last_health_publish_ms = 0;
+    unsigned long _last_health_sample_ms = 0;
     unsigned long _last_energy_subscribe_attempt_ms = 0;
+    uint8_t _energy_subscribe_tries = 0;    // since the last connect
+
+    // Fast start (MQTT task only): channels heard from since the last connect.
+    char _energy_refresh_topic[128] = {0};
+    unsigned long _energy_connack_ms = 0;
+    unsigned long _energy_subscribed_ms = 0;
+    uint32_t _energy_seen_mask = 0;
+    bool _energy_first_pending = false;
+    bool _energy_refresh_sent = false;
+    std::atomic<uint32_t> _energy_connects{0};
+    std::atomic<uint32_t> _energy_first_value_ms{0};
+    std::atomic<uint32_t> _energy_first_value_max_ms{0};
+    std::atomic<uint32_t> _energy_refresh_requests{0};
+
+    // Last published health payload (delta publishing baseline; the document is
+    // kDeviceTelemetryMqttDocCapacity bytes, so builds without it do not carry it).
+    #if MQTT_HEALTH_DELTA_PUBLISH
+    #if MQTT_HEALTH_TEMPLATE
+    DeviceHealthValues _last_health_values = {};
+    #else
+    StaticJsonDocument<kDeviceTelemetryMqttDocCapacity> _last_health_doc;
+    #endif
+    bool _last_health_valid = false;
+    #endif
+    uint32_t _health_suppressed = 0;
 };
 
 // Global instance (defined in app.ino)
@@ -87,6 +236,12 @@ extern MqttManager mqtt_manager;
 // Request a reconnect from outside the MQTT manager (thread-safe by design).
 void mqtt_manager_request_reconnect();
 
+// 32-bit FNV-1a of an MQTT topic (also returns its length).
+uint32_t mqtt_topic_hash(const char *topic, size_t *len_out);
+
+// Fingerprint of all energy subscription topics (detects changes needing a resubscribe).
+uint32_t mqtt_energy_topics_fingerprint(const DeviceConfig *config);
+
 #endif // HAS_MQTT
 
 #endif // MQTT_MANAGER_H
@@ -0,0 +1,352 @@
+#include "mqtt_tls_client.h"
+
+#if HAS_MQTT && MQTT_TLS_ENABLED
+
+#include "log_manager.h"
+
+#include <WiFi.h>
+#include <esp_heap_caps.h>
+#include <lwip/sockets.h>
+#include <errno.h>
+#include <fcntl.h>
+
+#include <mbedtls/error.h>
+
+// mbedTLS 3.x hides struct members behind MBEDTLS_PRIVATE(); 2.x exposes them.
+#ifndef MBEDTLS_PRIVATE
+#define MBEDTLS_PRIVATE(member) member
+#endif
+
+static const char kTlsCaPem[] = MQTT_TLS_CA_PEM;
+
+MqttTlsClient::MqttTlsClient() {
+    mbedtls_ssl_session_init(&_session);
+    _net.fd = -1;
+}
+
+MqttTlsClient::~MqttTlsClient() {
+    stop();
+    mbedtls_ssl_session_free(&_session);
+    if (_warm) {
+        mbedtls_ssl_config_free(&_conf);
+        mbedtls_x509_crt_free(&_ca);
+        mbedtls_ctr_drbg_free(&_drbg);
+        mbedtls_entropy_free(&_entropy);
+    }
+}
+
+bool MqttTlsClient::warmUp() {
+    if (_warm) return true;
+
+    mbedtls_entropy_init(&_entropy);
+    mbedtls_ctr_drbg_init(&_drbg);
+    mbedtls_ssl_config_init(&_conf);
+    mbedtls_x509_crt_init(&_ca);
+
+    static const char kPers[] = "mqtt_tls";
+    int ret = mbedtls_ctr_drbg_seed(&_drbg, mbedtls_entropy_func, &_entropy,
+                                    (const unsigned char*)kPers, sizeof(kPers) - 1);
+    if (ret == 0) {
+        ret = mbedtls_ssl_config_defaults(&_conf, MBEDTLS_SSL_IS_CLIENT,
+                                          MBEDTLS_SSL_TRANSPORT_STREAM, MBEDTLS_SSL_PRESET_DEFAULT);
+    }
+    if (ret != 0) {
+        LOGE("MQTT", "TLS init failed (-0x%04x)", (unsigned)-ret);
+        _stats.last_error = ret;
+        mbedtls_ssl_config_free(&_conf);
+        mbedtls_x509_crt_free(&_ca);
+        mbedtls_ctr_drbg_free(&_drbg);
+        mbedtls_entropy_free(&_entropy);
+        return false;
+    }
+
+    _verify = false;
+    if (sizeof(kTlsCaPem) > 1) {
+        ret = mbedtls_x509_crt_parse(&_ca, (const unsigned char*)kTlsCaPem, sizeof(kTlsCaPem));
+        if (ret == 0) {
+            _verify = true;
+        } else {
+            LOGE("MQTT", "MQTT_TLS_CA_PEM parse failed (-0x%04x)", (unsigned)-ret);
+        }
+    }
+
+    if (_verify) {
+        mbedtls_ssl_conf_authmode(&_conf, MBEDTLS_SSL_VERIFY_REQUIRED);
+        mbedtls_ssl_conf_ca_chain(&_conf, &_ca, nullptr);
+    } else {
+        #if MQTT_TLS_INSECURE
+        LOGW("MQTT", "TLS without MQTT_TLS_CA_PEM: broker certificate is not verified (MQTT_TLS_INSECURE)");
+        mbedtls_ssl_conf_authmode(&_conf, MBEDTLS_SSL_VERIFY_NONE);
+        #else
+        // Without a CA anyone on the path could pose as the broker and collect the
+        // MQTT credentials: refuse to connect unless that was opted into.
+        LOGE("MQTT", "TLS needs a valid MQTT_TLS_CA_PEM (or MQTT_TLS_INSECURE=true); not connecting");
+        mbedtls_ssl_config_free(&_conf);
+        mbedtls_x509_crt_free(&_ca);
+        mbedtls_ctr_drbg_free(&_drbg);
+        mbedtls_entropy_free(&_entropy);
+        return false;
+        #endif
+    }
+    mbedtls_ssl_conf_rng(&_conf, mbedtls_ctr_drbg_random, &_drbg);
+
+    #if defined(MBEDTLS_SSL_SESSION_TICKETS)
+    mbedtls_ssl_conf_session_tickets(&_conf, MBEDTLS_SSL_SESSION_TICKETS_ENABLED);
+    #endif
+
+    _warm = true;
+    return true;
+}
+
+void MqttTlsClient::forgetSession() {
+    mbedtls_ssl_session_free(&_session);
+    mbedtls_ssl_session_init(&_session);
+    _session_valid = false;
+    _session_host[0] = '\0';
+    _session_port = 0;
+}
+
+bool MqttTlsClient::waitSocket(bool for_write, uint32_t timeout_ms) {
+    if (_net.fd < 0) return false;
+
+    fd_set fds;
+    FD_ZERO(&fds);
+    FD_SET(_net.fd, &fds);
+    struct timeval tv;
+    tv.tv_sec = timeout_ms / 1000;
+    tv.tv_usec = (timeout_ms % 1000) * 1000;
+
+    const int r = for_write ? select(_net.fd + 1, nullptr, &fds, nullptr, &tv)
+                            : select(_net.fd + 1, &fds, nullptr, nullptr, &tv);
+    return r > 0;
+}
+
+void MqttTlsClient::closeSocket() {
+    if (_net.fd >= 0) {
+        lwip_close(_net.fd);
+        _net.fd = -1;
+    }
+}
+
+int MqttTlsClient::connect(IPAddress ip, uint16_t port) {
+    return connectTo(nullptr, ip, port);
+}
+
+int MqttTlsClient::connect(const char *host, uint16_t port) {
+    IPAddress ip;
+    if (!host || !WiFi.hostByName(host, ip)) {
+        LOGW("MQTT", "TLS: cannot resolve %s", host ? host : "(null)");
+        return 0;
+    }
+    return connectTo(host, ip, port);
+}
+
+int MqttTlsClient::connectTo(const char *host, IPAddress ip, uint16_t port) {
+    stop();
+    if (!warmUp()) return 0;
+
+    // TCP connect (non-blocking with timeout; the socket stays non-blocking).
+    _net.fd = lwip_socket(AF_INET, SOCK_STREAM, IPPROTO_TCP);
+    if (_net.fd < 0) return 0;
+    fcntl(_net.fd, F_SETFL, fcntl(_net.fd, F_GETFL, 0) | O_NONBLOCK);
+
+    struct sockaddr_in addr = {};
+    addr.sin_family = AF_INET;
+    addr.sin_port = htons(port);
+    addr.sin_addr.s_addr = (uint32_t)ip;
+
+    int r = lwip_connect(_net.fd, (struct sockaddr*)&addr, sizeof(addr));
+    if (r != 0 && errno != EINPROGRESS) {
+        closeSocket();
+        return 0;
+    }
+    if (r != 0) {
+        int so_error = 0;
+        socklen_t len = sizeof(so_error);
+        if (!waitSocket(true, MQTT_TLS_TIMEOUT_MS) ||
+            getsockopt(_net.fd, SOL_SOCKET, SO_ERROR, &so_error, &len) != 0 || so_error != 0) {
+            LOGW("MQTT", "TLS: TCP connect failed");
+            closeSocket();
+            return 0;
+        }
+    }
+
+    // TLS handshake.
+    const size_t heap_before = heap_caps_get_free_size(MALLOC_CAP_INTERNAL | MALLOC_CAP_8BIT);
+    const uint32_t t0 = millis();
+
+    mbedtls_ssl_init(&_ssl);
+    _ssl_live = true;
+    int ret = mbedtls_ssl_setup(&_ssl, &_conf);
+    const char *sni = host ? host : "";
+    if (ret == 0 && host) ret = mbedtls_ssl_set_hostname(&_ssl, sni);
+
+    const bool offered = _session_valid && _session_port == port && strcmp(_session_host, sni) == 0;
+    if (ret == 0 && offered) {
+        // A stale/rejected session is not fatal: the server falls back to a full handshake.
+        if (mbedtls_ssl_set_session(&_ssl, &_session) != 0) {
+            forgetSession();
+        }
+    }
+
+    if (ret == 0) {
+        mbedtls_ssl_set_bio(&_ssl, &_net, mbedtls_net_send, mbedtls_net_recv, nullptr);
+        while ((ret = mbedtls_ssl_handshake(&_ssl)) != 0) {
+            if (ret != MBEDTLS_ERR_SSL_WANT_READ && ret != MBEDTLS_ERR_SSL_WANT_WRITE) break;
+            if ((uint32_t)(millis() - t0) > MQTT_TLS_TIMEOUT_MS) {
+                ret = MBEDTLS_ERR_SSL_TIMEOUT;
+                break;
+            }
+            waitSocket(ret == MBEDTLS_ERR_SSL_WANT_WRITE, 50);
+        }
+    }
+
+    if (ret != 0) {
+        char err[64];
+        mbedtls_strerror(ret, err, sizeof(err));
+        LOGW("MQTT", "TLS handshake failed (-0x%04x %s)", (unsigned)-ret, err);
+        _stats.failures++;
+        _stats.last_error = ret;
+        if (offered) forgetSession();
+        stop();
+        return 0;
+    }
+
+    _stats.last_handshake_ms = millis() - t0;
+    _stats.last_heap_bytes = (int32_t)heap_before -
+        (int32_t)heap_caps_get_free_size(MALLOC_CAP_INTERNAL | MALLOC_CAP_8BIT);
+    _stats.last_error = 0;
+    _stats.handshakes++;
+
+    // The server echoes the offered session ID when it accepts the resumption.
+    mbedtls_ssl_session fresh;
+    mbedtls_ssl_session_init(&fresh);
+    bool resumed = false;
+    if (mbedtls_ssl_get_session(&_ssl, &fresh) == 0) {
+        resumed = offered &&
+            fresh.MBEDTLS_PRIVATE(id_len) > 0 &&
+            fresh.MBEDTLS_PRIVATE(id_len) == _session.MBEDTLS_PRIVATE(id_len) &&
+            memcmp(fresh.MBEDTLS_PRIVATE(id), _session.MBEDTLS_PRIVATE(id), fresh.MBEDTLS_PRIVATE(id_len)) == 0;
+
+        mbedtls_ssl_session_free(&_session);
+        _session = fresh;  // take ownership (ticket buffer moves with it)
+        _session_valid = true;
+        strlcpy(_session_host, sni, sizeof(_session_host));
+        _session_port = port;
+    } else {
+        mbedtls_ssl_session_free(&fresh);
+    }
+    if (resumed) _stats.resumed++;
+
+    LOGI("MQTT", "TLS %s in %lums (%ld B heap)", resumed ? "resumed" : "handshake",
+         (unsigned long)_stats.last_handshake_ms, (long)_stats.last_heap_bytes);
+
+    _open = true;
+    return 1;
+}
+
+size_t MqttTlsClient::write(uint8_t b) {
+    return write(&b, 1);
+}
+
+size_t MqttTlsClient::write(const uint8_t *buf, size_t size) {
+    if (!_open) return 0;
+
+    size_t done = 0;
+    const uint32_t t0 = millis();
+    while (done < size) {
+        int ret = mbedtls_ssl_write(&_ssl, buf + done, size - done);
+        if (ret > 0) {
+            done += (size_t)ret;
+            continue;
+        }
+        if ((ret != MBEDTLS_ERR_SSL_WANT_WRITE && ret != MBEDTLS_ERR_SSL_WANT_READ) ||
+            (uint32_t)(millis() - t0) > MQTT_TLS_TIMEOUT_MS) {
+            _stats.last_error = ret;
+            stop();
+            break;
+        }
+        waitSocket(ret == MBEDTLS_ERR_SSL_WANT_WRITE, 50);
+    }
+    return done;
+}
+
+int MqttTlsClient::available() {
+    if (!_open) return 0;
+
+    int n = (int)mbedtls_ssl_get_bytes_avail(&_ssl) + (_peek >= 0 ? 1 : 0);
+    if (n > 0) return n;
+
+    // Zero-length read pulls the next record off the (non-blocking) socket.
+    int ret = mbedtls_ssl_read(&_ssl, nullptr, 0);
+    if (ret < 0 && ret != MBEDTLS_ERR_SSL_WANT_READ && ret != MBEDTLS_ERR_SSL_WANT_WRITE
+        #if defined(MBEDTLS_ERR_SSL_RECEIVED_NEW_SESSION_TICKET)
+        && ret != MBEDTLS_ERR_SSL_RECEIVED_NEW_SESSION_TICKET
+        #endif
+    ) {
+        if (ret != MBEDTLS_ERR_SSL_PEER_CLOSE_NOTIFY) _stats.last_error = ret;
+        stop();
+        return 0;
+    }
+    return (int)mbedtls_ssl_get_bytes_avail(&_ssl);
+}
+
+int MqttTlsClient::read() {
+    uint8_t b;
+    return (read(&b, 1) == 1) ? b : -1;
+}
+
+int MqttTlsClient::read(uint8_t *buf, size_t size) {
+    if (!_open || size == 0) return -1;
+
+    size_t off = 0;
+    if (_peek >= 0) {
+        buf[off++] = (uint8_t)_peek;
+        _peek = -1;
+        if (off == size) return (int)off;
+    }
+
+    int ret = mbedtls_ssl_read(&_ssl, buf + off, size - off);
+    if (ret > 0) return (int)off + ret;
+    if (ret == MBEDTLS_ERR_SSL_WANT_READ || ret == MBEDTLS_ERR_SSL_WANT_WRITE) {
+        return off > 0 ? (int)off : -1;
+    }
+    if (ret != 0 && ret != MBEDTLS_ERR_SSL_PEER_CLOSE_NOTIFY) _stats.last_error = ret;
+    stop();
+    return off > 0 ? (int)off : -1;
+}
+
+int MqttTlsClient::peek() {
+    if (_peek >= 0) return _peek;
+    uint8_t b;
+    if (read(&b, 1) != 1) return -1;
+    _peek = b;
+    return _peek;
+}
+
+void MqttTlsClient::flush() {
+    // Writes are not buffered beyond the mbedTLS record layer.
+}
+
+void MqttTlsClient::stop() {
+    if (_ssl_live) {
+        if (_open) mbedtls_ssl_close_notify(&_ssl);
+        mbedtls_ssl_free(&_ssl);
+        _ssl_live = false;
+    }
+    closeSocket();
+    _open = false;
+    _peek = -1;
+}
+
+uint8_t MqttTlsClient::connected() {
+    return _open ? 1 : 0;
+}
+
+void MqttTlsClient::getStats(MqttTlsStats *out) const {
+    if (!out) return;
+    *out = _stats;
+    out->session_cached = _session_valid;
+}
+
+#endif // HAS_MQTT && MQTT_TLS_ENABLED
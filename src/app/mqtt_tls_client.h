@@ -0,0 +1,95 @@
+#ifndef MQTT_TLS_CLIENT_H
+#define MQTT_TLS_CLIENT_H
+
+#include <Arduino.h>
+#include "board_config.h"
+
+#if HAS_MQTT && MQTT_TLS_ENABLED
+
+#include <Client.h>
+
+#include "config_manager.h"
+
+#include <mbedtls/ctr_drbg.h>
+#include <mbedtls/entropy.h>
+#include <mbedtls/net_sockets.h>
+#include <mbedtls/ssl.h>
+#include <mbedtls/x509_crt.h>
+
+// MQTT TLS transport statistics (surfaced in /api/health).
+struct MqttTlsStats {
+    uint32_t handshakes;          // successful handshakes since boot
+    uint32_t resumed;             // of which resumed a cached session (abbreviated handshake)
+    uint32_t failures;
+    uint32_t last_handshake_ms;   // TCP connect excluded
+    int32_t last_heap_bytes;      // internal heap held by the live TLS context
+    int32_t last_error;           // last mbedtls error code (0 = none)
+    bool session_cached;
+};
+
+// Arduino Client over mbedTLS with client-side session resumption.
+//
+// The first handshake to a broker is a full one (1-3 s of CPU on an ESP32). The
+// negotiated session (session ID and/or RFC 5077 ticket) is then kept in RAM and
+// offered on the next connect, so a reconnect after a WiFi blip does an
+// abbreviated handshake: no certificate chain, no key exchange.
+//
+// The DRBG, entropy source and parsed CA chain are set up once and kept
+// ("warm"); only the per-connection SSL context is allocated and freed on each
+// connect/stop.
+//
+// Used from the MQTT task only; not thread-safe.
+class MqttTlsClient : public Client {
+public:
+    MqttTlsClient();
+    ~MqttTlsClient();
+
+    int connect(IPAddress ip, uint16_t port) override;
+    int connect(const char *host, uint16_t port) override;
+    size_t write(uint8_t b) override;
+    size_t write(const uint8_t *buf, size_t size) override;
+    int available() override;
+    int read() override;
+    int read(uint8_t *buf, size_t size) override;
+    int peek() override;
+    void flush() override;
+    void stop() override;
+    uint8_t connected() override;
+    operator bool() override { return connected(); }
+
+    // Drop the cached session (e.g. broker host changed).
+    void forgetSession();
+
+    void getStats(MqttTlsStats *out) const;
+
+private:
+    bool warmUp();
+    int connectTo(const char *host, IPAddress ip, uint16_t port);
+    bool waitSocket(bool for_write, uint32_t timeout_ms);
+    void closeSocket();
+
+    bool _warm = false;
+    mbedtls_entropy_context _entropy;
+    mbedtls_ctr_drbg_context _drbg;
+    mbedtls_ssl_config _conf;
+    mbedtls_x509_crt _ca;
+    bool _verify = false;
+
+    mbedtls_ssl_context _ssl;
+    mbedtls_net_context _net;
+    bool _ssl_live = false;
+    bool _open = false;
+    int _peek = -1;
+
+    // Cached session for the last broker (host:port).
+    mbedtls_ssl_session _session;
+    bool _session_valid = false;
+    char _session_host[CONFIG_MQTT_HOST_MAX_LEN] = {0};
+    uint16_t _session_port = 0;
+
+    MqttTlsStats _stats = {};
+};
+
+#endif // HAS_MQTT && MQTT_TLS_ENABLED
+
+#endif // MQTT_TLS_CLIENT_H
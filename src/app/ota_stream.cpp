@@ -0,0 +1,400 @@
+#include "ota_stream.h"
+
+#include "log_manager.h"
+#include "task_placement.h"
+
+#include <Arduino.h>
+#include <esp_heap_caps.h>
+#include <esp_image_format.h>
+#include <esp_ota_ops.h>
+#include <esp_partition.h>
+#include <freertos/FreeRTOS.h>
+#include <freertos/queue.h>
+#include <freertos/semphr.h>
+#include <mbedtls/sha256.h>
+#ifdef OTA_SIGNING_PUBLIC_KEY_PEM
+#include <mbedtls/base64.h>
+#include <mbedtls/pk.h>
+#endif
+
+#include <atomic>
+#include <ctype.h>
+#include <stdio.h>
+#include <string.h>
+
+namespace {
+
+static constexpr size_t kBlockSize = 4096;  // SPI flash sector
+static constexpr uint8_t kFlushToken = 0xFF;
+
+struct OtaStreamState {
+    const esp_partition_t* part;
+    esp_ota_handle_t handle;
+    mbedtls_sha256_context sha;
+    uint8_t* blocks[OTA_STREAM_BLOCKS];
+    uint16_t block_len[OTA_STREAM_BLOCKS];
+    QueueHandle_t free_q;     // block indexes ready to fill
+    QueueHandle_t filled_q;   // block indexes (or kFlushToken) for the writer
+    SemaphoreHandle_t flushed;
+    int cur;                  // block being filled (-1 = none)
+    size_t cur_len;
+    uint32_t received;
+    uint32_t start_ms;
+    uint32_t max_stall_ms;
+
+    // Writer task only.
+    uint32_t write_offset;
+    uint32_t erased_upto;
+    uint32_t erase_limit;
+    uint32_t writer_busy_ms;
+
+    bool active;
+};
+
+static OtaStreamState g_ota = {};
+// First failure wins; set from both the network task and the writer.
+static std::atomic<const char*> g_error{nullptr};
+static const char* g_last_error = nullptr;
+// Bytes the writer has put in flash (for resume checkpoints).
+static std::atomic<uint32_t> g_committed{0};
+
+static void fail(const char* error) {
+    const char* expected = nullptr;
+    if (g_error.compare_exchange_strong(expected, error)) {
+        LOGE("OTA", "%s", error);
+    }
+}
+
+static bool erase_next_sector() {
+    if (esp_partition_erase_range(g_ota.part, g_ota.erased_upto, kBlockSize) != ESP_OK) {
+        fail("Flash erase failed");
+        return false;
+    }
+    g_ota.erased_upto += kBlockSize;
+    return true;
+}
+
+#ifdef OTA_SIGNING_PUBLIC_KEY_PEM
+// Signature over the SHA-256 of the image (ECDSA or RSA, as the key dictates), base64.
+static bool verify_signature(const uint8_t digest[32], const char* sig_b64) {
+    uint8_t sig[512];
+    size_t sig_len = 0;
+    if (mbedtls_base64_decode(sig, sizeof(sig), &sig_len, (const unsigned char*)sig_b64, strlen(sig_b64)) != 0) {
+        return false;
+    }
+
+    static const char kPublicKey[] = OTA_SIGNING_PUBLIC_KEY_PEM;
+    mbedtls_pk_context pk;
+    mbedtls_pk_init(&pk);
+    int rc = mbedtls_pk_parse_public_key(&pk, (const unsigned char*)kPublicKey, sizeof(kPublicKey));
+    if (rc == 0) {
+        rc = mbedtls_pk_verify(&pk, MBEDTLS_MD_SHA256, digest, 32, sig, sig_len);
+    }
+    mbedtls_pk_free(&pk);
+    return rc == 0;
+}
+#endif
+
+static void writer_task(void*) {
+    for (;;) {
+        TickType_t wait = portMAX_DELAY;
+        #if OTA_STREAM_ERASE_AHEAD
+        // Nothing queued yet: use the gap to erase sectors the data will land in.
+        if (!g_error.load() && g_ota.erased_upto < g_ota.erase_limit &&
+            g_ota.erased_upto < g_ota.write_offset + OTA_STREAM_ERASE_AHEAD_BYTES) {
+            wait = 0;
+        }
+        #endif
+
+        uint8_t idx;
+        if (xQueueReceive(g_ota.filled_q, &idx, wait) != pdTRUE) {
+            const uint32_t t0 = millis();
+            erase_next_sector();
+            g_ota.writer_busy_ms += millis() - t0;
+            continue;
+        }
+        if (idx == kFlushToken) break;
+
+        const uint32_t t0 = millis();
+        if (!g_error.load()) {
+            const size_t len = g_ota.block_len[idx];
+            // Offset writes (and our own erases) so a session can resume mid-partition.
+            esp_err_t err = ESP_OK;
+            while (err == ESP_OK && g_ota.erased_upto < g_ota.write_offset + len) {
+                if (!erase_next_sector()) err = ESP_FAIL;
+            }
+            if (err == ESP_OK) {
+                err = esp_ota_write_with_offset(g_ota.handle, g_ota.blocks[idx], len, g_ota.write_offset);
+            }
+            if (err != ESP_OK) {
+                fail("Flash write failed");
+            } else {
+                g_ota.write_offset += len;
+                g_committed.store(g_ota.write_offset);
+            }
+        }
+        g_ota.writer_busy_ms += millis() - t0;
+        xQueueSend(g_ota.free_q, &idx, portMAX_DELAY);
+    }
+
+    xSemaphoreGive(g_ota.flushed);
+    vTaskDelete(nullptr);
+}
+
+static void release_resources() {
+    for (size_t i = 0; i < OTA_STREAM_BLOCKS; i++) {
+        heap_caps_free(g_ota.blocks[i]);
+        g_ota.blocks[i] = nullptr;
+    }
+    if (g_ota.free_q) vQueueDelete(g_ota.free_q);
+    if (g_ota.filled_q) vQueueDelete(g_ota.filled_q);
+    if (g_ota.flushed) vSemaphoreDelete(g_ota.flushed);
+    g_ota.free_q = nullptr;
+    g_ota.filled_q = nullptr;
+    g_ota.flushed = nullptr;
+    mbedtls_sha256_free(&g_ota.sha);
+    g_ota.active = false;
+}
+
+// Hands the last block to the writer and waits until it has stopped.
+static void stop_writer() {
+    if (g_ota.cur >= 0 && g_ota.cur_len > 0) {
+        const uint8_t idx = (uint8_t)g_ota.cur;
+        g_ota.block_len[idx] = (uint16_t)g_ota.cur_len;
+        xQueueSend(g_ota.filled_q, &idx, portMAX_DELAY);
+    }
+    g_ota.cur = -1;
+    g_ota.cur_len = 0;
+
+    const uint8_t token = kFlushToken;
+    xQueueSend(g_ota.filled_q, &token, portMAX_DELAY);
+    xSemaphoreTake(g_ota.flushed, portMAX_DELAY);
+}
+
+static bool take_free_block() {
+    const uint32_t t0 = millis();
+    uint8_t idx;
+    if (xQueueReceive(g_ota.free_q, &idx, pdMS_TO_TICKS(OTA_STREAM_STALL_TIMEOUT_MS)) != pdTRUE) {
+        fail("Flash writer stalled");
+        return false;
+    }
+    const uint32_t stall = millis() - t0;
+    if (stall > g_ota.max_stall_ms) g_ota.max_stall_ms = stall;
+    g_ota.cur = idx;
+    g_ota.cur_len = 0;
+    return true;
+}
+
+} // namespace
+
+// Resume: the first `offset` bytes are already in the partition. Re-hash them
+// so the digest still covers the whole image.
+static bool rehash_existing(size_t offset) {
+    uint8_t* buf = g_ota.blocks[0];
+    for (size_t pos = 0; pos < offset; pos += kBlockSize) {
+        const size_t n = (offset - pos < kBlockSize) ? offset - pos : kBlockSize;
+        if (esp_partition_read(g_ota.part, pos, buf, n) != ESP_OK) return false;
+        if (pos == 0 && buf[0] != ESP_IMAGE_HEADER_MAGIC) return false;
+        mbedtls_sha256_update(&g_ota.sha, buf, n);
+    }
+    return true;
+}
+
+bool ota_stream_begin(size_t size_hint, size_t resume_offset) {
+    if (g_ota.active) {
+        LOGE("OTA", "Stream already active");
+        return false;
+    }
+    g_error.store(nullptr);
+    g_last_error = nullptr;
+
+    const esp_partition_t* part = esp_ota_get_next_update_partition(nullptr);
+    if (!part) {
+        g_last_error = "No OTA partition";
+        LOGE("OTA", "%s", g_last_error);
+        return false;
+    }
+
+    OtaStreamState& s = g_ota;
+    s = OtaStreamState{};
+    s.part = part;
+    s.cur = -1;
+    s.start_ms = millis();
+    s.erase_limit = (size_hint > 0 && size_hint < part->size) ? (uint32_t)size_hint : (uint32_t)part->size;
+    g_committed.store(0);
+    if (resume_offset % kBlockSize != 0 || resume_offset >= part->size) {
+        g_last_error = "Bad resume offset";
+        LOGE("OTA", "%s", g_last_error);
+        return false;
+    }
+    mbedtls_sha256_init(&s.sha);
+    mbedtls_sha256_starts(&s.sha, 0);
+    s.active = true;
+
+    // Blocks stay in internal RAM: they are written while the flash cache is off.
+    s.free_q = xQueueCreate(OTA_STREAM_BLOCKS, sizeof(uint8_t));
+    s.filled_q = xQueueCreate(OTA_STREAM_BLOCKS + 1, sizeof(uint8_t));
+    s.flushed = xSemaphoreCreateBinary();
+    bool ok = s.free_q && s.filled_q && s.flushed;
+    for (size_t i = 0; ok && i < OTA_STREAM_BLOCKS; i++) {
+        s.blocks[i] = (uint8_t*)heap_caps_malloc(kBlockSize, MALLOC_CAP_INTERNAL | MALLOC_CAP_8BIT);
+        if (!s.blocks[i]) {
+            ok = false;
+            break;
+        }
+        const uint8_t idx = (uint8_t)i;
+        xQueueSend(s.free_q, &idx, 0);
+    }
+    if (!ok) {
+        g_last_error = "Out of memory";
+        LOGE("OTA", "%s", g_last_error);
+        release_resources();
+        return false;
+    }
+
+    if (resume_offset > 0) {
+        const uint32_t t0 = millis();
+        if (!rehash_existing(resume_offset)) {
+            g_last_error = "Resume data unreadable";
+            LOGE("OTA", "%s", g_last_error);
+            release_resources();
+            return false;
+        }
+        s.received = s.write_offset = s.erased_upto = (uint32_t)resume_offset;
+        g_committed.store((uint32_t)resume_offset);
+        LOGI("OTA", "Resuming at %u (re-hashed in %lu ms)", (unsigned)resume_offset, (unsigned long)(millis() - t0));
+    }
+
+    // Sequential-writes mode: nothing is erased up front (that would block for seconds).
+    if (esp_ota_begin(part, OTA_WITH_SEQUENTIAL_WRITES, &s.handle) != ESP_OK) {
+        g_last_error = "OTA begin failed";
+        LOGE("OTA", "%s", g_last_error);
+        release_resources();
+        return false;
+    }
+
+    TaskHandle_t writer = nullptr;
+    if (!task_placement_create(AppTask::OtaWriter, writer_task, nullptr, &writer, nullptr)) {
+        g_last_error = "Writer task failed";
+        LOGE("OTA", "%s", g_last_error);
+        esp_ota_abort(s.handle);
+        release_resources();
+        return false;
+    }
+
+    LOGI("OTA", "Stream to %s (%u KB, %u x 4 KB blocks%s)", part->label, (unsigned)(part->size / 1024),
+        (unsigned)OTA_STREAM_BLOCKS, OTA_STREAM_ERASE_AHEAD ? ", erase-ahead" : "");
+    return true;
+}
+
+bool ota_stream_write(const uint8_t* data, size_t len) {
+    if (!g_ota.active || g_error.load()) return false;
+    if (len == 0) return true;
+
+    if (g_ota.received == 0 && data[0] != ESP_IMAGE_HEADER_MAGIC) {
+        fail("Not an ESP firmware image");
+        return false;
+    }
+    if (g_ota.received + len > g_ota.part->size) {
+        fail("Firmware too large");
+        return false;
+    }
+
+    mbedtls_sha256_update(&g_ota.sha, data, len);
+    g_ota.received += len;
+
+    while (len > 0) {
+        if (g_ota.cur < 0 && !take_free_block()) return false;
+        const size_t n = (len < kBlockSize - g_ota.cur_len) ? len : kBlockSize - g_ota.cur_len;
+        memcpy(g_ota.blocks[g_ota.cur] + g_ota.cur_len, data, n);
+        g_ota.cur_len += n;
+        data += n;
+        len -= n;
+
+        if (g_ota.cur_len == kBlockSize) {
+            const uint8_t idx = (uint8_t)g_ota.cur;
+            g_ota.block_len[idx] = (uint16_t)kBlockSize;
+            xQueueSend(g_ota.filled_q, &idx, portMAX_DELAY);
+            g_ota.cur = -1;
+        }
+    }
+    return !g_error.load();
+}
+
+void ota_stream_finish(const char* expected_sha256_hex, OtaStreamResult* out, const char* signature_b64) {
+    OtaStreamResult r = {};
+    if (!g_ota.active) {
+        r.error = "No update in progress";
+        if (out) *out = r;
+        return;
+    }
+
+    stop_writer();
+
+    uint8_t digest[32];
+    mbedtls_sha256_finish(&g_ota.sha, digest);
+    for (size_t i = 0; i < sizeof(digest); i++) {
+        snprintf(&r.sha256_hex[i * 2], 3, "%02x", digest[i]);
+    }
+    r.bytes = g_ota.received;
+    r.elapsed_ms = millis() - g_ota.start_ms;
+    r.writer_busy_ms = g_ota.writer_busy_ms;
+    r.max_stall_ms = g_ota.max_stall_ms;
+
+    const char* error = g_error.load();
+    if (!error && g_ota.received == 0) error = "Empty upload";
+    if (!error && expected_sha256_hex && *expected_sha256_hex) {
+        if (strlen(expected_sha256_hex) != 64 || strncasecmp(expected_sha256_hex, r.sha256_hex, 64) != 0) {
+            error = "SHA-256 mismatch";
+        }
+    }
+    #ifdef OTA_SIGNING_PUBLIC_KEY_PEM
+    if (!error && (!signature_b64 || !*signature_b64)) {
+        error = "Signature required";
+    } else if (!error && !verify_signature(digest, signature_b64)) {
+        error = "Signature invalid";
+    }
+    #else
+    (void)signature_b64;
+    #endif
+
+    if (error) {
+        esp_ota_abort(g_ota.handle);
+    } else if (esp_ota_end(g_ota.handle) != ESP_OK) {
+        error = "Image validation failed";
+    } else if (esp_ota_set_boot_partition(g_ota.part) != ESP_OK) {
+        error = "Set boot partition failed";
+    }
+
+    r.ok = (error == nullptr);
+    r.error = error;
+    g_last_error = error;
+    if (r.ok) {
+        LOGI("OTA", "Stream done: %lu bytes in %lu ms (writer busy %lu ms, max stall %lu ms) sha256=%s",
+            (unsigned long)r.bytes, (unsigned long)r.elapsed_ms, (unsigned long)r.writer_busy_ms,
+            (unsigned long)r.max_stall_ms, r.sha256_hex);
+    } else {
+        LOGE("OTA", "Stream failed: %s", error);
+    }
+
+    release_resources();
+    if (out) *out = r;
+}
+
+void ota_stream_abort() {
+    if (!g_ota.active) return;
+    fail("Aborted");
+    stop_writer();
+    esp_ota_abort(g_ota.handle);
+    g_last_error = g_error.load();
+    release_resources();
+}
+
+size_t ota_stream_committed_bytes() {
+    return g_committed.load();
+}
+
+const char* ota_stream_last_error() {
+    const char* e = g_error.load();
+    return e ? e : g_last_error;
+}
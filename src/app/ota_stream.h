@@ -0,0 +1,53 @@
+/*
+ * Streaming OTA writer
+ *
+ * Takes firmware bytes as they arrive (any chunk size), hashes them with
+ * SHA-256 on the fly, and groups them into flash-sector (4 KB) blocks that a
+ * separate ota_writer task writes to the next OTA partition. The network task
+ * only copies and hashes; sector erases and writes overlap the transfer. With
+ * OTA_STREAM_ERASE_AHEAD, the writer also pre-erases upcoming sectors while it
+ * waits for data. Writes go to explicit offsets, so a session can resume on top
+ * of bytes an earlier (interrupted) session already put in the partition.
+ *
+ * When OTA_SIGNING_PUBLIC_KEY_PEM is defined (board_overrides.h), finish()
+ * also requires a base64 signature of the image's SHA-256 made with that key.
+ *
+ * Single session at a time (callers already gate concurrent updates).
+ */
+
+#pragma once
+
+#include "board_config.h"
+
+#include <stddef.h>
+#include <stdint.h>
+
+struct OtaStreamResult {
+    bool ok;
+    const char* error;     // static string when !ok
+    char sha256_hex[65];   // digest of all bytes written
+    uint32_t bytes;
+    uint32_t elapsed_ms;   // begin() to finish()
+    uint32_t writer_busy_ms;
+    uint32_t max_stall_ms; // longest wait of write() for a free block
+};
+
+// `size_hint` bounds erase-ahead (0 = partition size). `resume_offset`
+// (sector-aligned) keeps that many bytes already in the partition and re-hashes
+// them. False when no OTA partition / memory / task is available.
+bool ota_stream_begin(size_t size_hint, size_t resume_offset = 0);
+
+// Hash and queue bytes. Blocks briefly only when every buffer is waiting for
+// flash. False once the session has failed (see ota_stream_last_error()).
+bool ota_stream_write(const uint8_t* data, size_t len);
+
+// Flush, stop the writer, validate the image and (when `expected_sha256_hex`
+// is non-empty) the digest, then select the new partition for the next boot.
+void ota_stream_finish(const char* expected_sha256_hex, OtaStreamResult* out, const char* signature_b64 = nullptr);
+
+void ota_stream_abort();
+
+// Bytes the writer has already put in flash (a safe resume offset once aligned down).
+size_t ota_stream_committed_bytes();
+
+const char* ota_stream_last_error();
@@ -0,0 +1,280 @@
+#include "p1_meter.h"
+
+#if P1_METER_SUPPORTED
+
+#include "config_manager.h"
+#include "energy_latency.h"
+#include "energy_monitor.h"
+#include "json_path_extract.h"
+#include "log_manager.h"
+#include "task_placement.h"
+
+#include <Arduino.h>
+#include <WiFi.h>
+#include <math.h>
+#include <stdlib.h>
+#include <string.h>
+
+static const DeviceConfig* s_config = nullptr;
+static TaskHandle_t s_task = nullptr;
+
+// Only touched by the polling task.
+static WiFiClient s_client;
+static char s_url[CONFIG_P1_METER_URL_MAX_LEN] = {0};  // URL the parsed target belongs to
+static char s_host[64] = {0};
+static char s_path[CONFIG_P1_METER_URL_MAX_LEN] = {0};
+static uint16_t s_port = 80;
+static bool s_url_valid = false;
+static bool s_failing = false;  // last poll failed (log transitions only)
+static char s_body[P1_METER_BODY_MAX_BYTES];
+
+static P1MeterStats s_stats = {};
+
+// "http://host[:port][/path]" or "host[:port][/path]"; path defaults to /api/v1/data.
+static bool parse_url(const char* url) {
+    if (strncmp(url, "http://", 7) == 0) {
+        url += 7;
+    } else if (strstr(url, "://")) {
+        return false;  // https:// and friends are not supported
+    }
+
+    const char* path = strchr(url, '/');
+    const size_t authority_len = path ? (size_t)(path - url) : strlen(url);
+    if (authority_len == 0 || authority_len >= sizeof(s_host)) return false;
+
+    memcpy(s_host, url, authority_len);
+    s_host[authority_len] = '\0';
+    s_port = 80;
+    char* colon = strchr(s_host, ':');
+    if (colon) {
+        *colon = '\0';
+        const long port = strtol(colon + 1, nullptr, 10);
+        if (port <= 0 || port > 65535 || s_host[0] == '\0') return false;
+        s_port = (uint16_t)port;
+    }
+    strlcpy(s_path, (path && path[0]) ? path : "/api/v1/data", sizeof(s_path));
+    return true;
+}
+
+// Read one header line (CRLF stripped, truncated to len - 1) before deadline.
+static bool read_line(char* line, size_t len, unsigned long deadline_ms) {
+    size_t n = 0;
+    for (;;) {
+        if (!s_client.available()) {
+            if (!s_client.connected() || (long)(millis() - deadline_ms) >= 0) return false;
+            vTaskDelay(1);
+            continue;
+        }
+        const int c = s_client.read();
+        if (c < 0) continue;
+        if (c == '\n') break;
+        if (c != '\r' && n + 1 < len) line[n++] = (char)c;
+    }
+    line[n] = '\0';
+    return true;
+}
+
+// Read exactly len bytes (or until the peer closes when until_close) before deadline.
+static bool read_body(char* buf, size_t len, bool until_close, unsigned long deadline_ms, size_t* out_len) {
+    size_t n = 0;
+    while (n < len) {
+        const int avail = s_client.available();
+        if (avail <= 0) {
+            if (!s_client.connected()) break;
+            if ((long)(millis() - deadline_ms) >= 0) return false;
+            vTaskDelay(1);
+            continue;
+        }
+        size_t want = len - n;
+        if ((size_t)avail < want) want = (size_t)avail;
+        const int got = s_client.read((uint8_t*)buf + n, want);
+        if (got > 0) n += (size_t)got;
+    }
+    *out_len = n;
+    return until_close || n == len;
+}
+
+static bool header_is(const char* line, const char* name, const char** value) {
+    const size_t n = strlen(name);
+    if (strncasecmp(line, name, n) != 0 || line[n] != ':') return false;
+    const char* v = line + n + 1;
+    while (*v == ' ' || *v == '\t') v++;
+    *value = v;
+    return true;
+}
+
+// One request/response on the (possibly reused) connection. Returns the body
+// length, or -1 on failure (the connection is then closed).
+static int fetch_once(const char** err) {
+    char line[128];
+    const int req_len = snprintf(line, sizeof(line),
+                                 "GET %s HTTP/1.1\r\nHost: %s\r\nAccept: application/json\r\nConnection: keep-alive\r\n\r\n",
+                                 s_path, s_host);
+    if (req_len <= 0 || (size_t)req_len >= sizeof(line)) {
+        *err = "URL too long";
+        return -1;
+    }
+    if (s_client.write((const uint8_t*)line, (size_t)req_len) != (size_t)req_len) {
+        *err = "write failed";
+        return -1;
+    }
+
+    const unsigned long deadline = millis() + P1_METER_TIMEOUT_MS;
+    if (!read_line(line, sizeof(line), deadline)) {
+        *err = "no response";
+        return -1;
+    }
+    int status = 0;
+    if (strncmp(line, "HTTP/1.", 7) != 0 || sscanf(line + 9, "%d", &status) != 1) {
+        *err = "bad status line";
+        return -1;
+    }
+
+    long content_length = -1;
+    bool keep_alive = (line[7] == '1');  // HTTP/1.1 defaults to keep-alive
+    for (;;) {
+        if (!read_line(line, sizeof(line), deadline)) {
+            *err = "header timeout";
+            return -1;
+        }
+        if (line[0] == '\0') break;
+        const char* v = nullptr;
+        if (header_is(line, "Content-Length", &v)) {
+            content_length = strtol(v, nullptr, 10);
+        } else if (header_is(line, "Connection", &v)) {
+            keep_alive = (strncasecmp(v, "close", 5) != 0);
+        } else if (header_is(line, "Transfer-Encoding", &v) && strncasecmp(v, "chunked", 7) == 0) {
+            *err = "chunked responses not supported";
+            return -1;
+        }
+    }
+
+    if (status != 200) {
+        *err = "HTTP error";
+        LOGD("P1", "HTTP %d", status);
+        return -1;
+    }
+    if (content_length >= (long)sizeof(s_body)) {
+        *err = "body larger than P1_METER_BODY_MAX_BYTES";
+        return -1;
+    }
+
+    const bool until_close = (content_length < 0);
+    size_t body_len = 0;
+    if (!read_body(s_body, until_close ? sizeof(s_body) : (size_t)content_length, until_close, deadline, &body_len)) {
+        *err = "body timeout";
+        return -1;
+    }
+    if (until_close || !keep_alive) s_client.stop();
+    return (int)body_len;
+}
+
+static void publish(uint8_t channel, const char* path, size_t body_len, uint32_t now_ms, bool* parsed) {
+    if (!path || !path[0]) return;
+    double v = 0.0;
+    const bool ok = json_path_extract_number(s_body, body_len, path, &v);
+    energy_monitor_set_channel(channel, ok ? (float)(v * P1_METER_VALUE_SCALE) : NAN, now_ms);
+    if (!ok) *parsed = false;
+}
+
+static void poll_once() {
+    const char* url = s_config->p1_meter_url;
+    if (strcmp(url, s_url) != 0) {
+        s_client.stop();
+        strlcpy(s_url, url, sizeof(s_url));
+        s_url_valid = s_url[0] && parse_url(s_url);
+        s_failing = false;
+        if (s_url[0] && !s_url_valid) {
+            LOGW("P1", "Unsupported meter URL: %s (http://host[:port]/path)", s_url);
+        } else if (s_url_valid) {
+            LOGI("P1", "Polling http://%s:%u%s every %ums", s_host, (unsigned)s_port, s_path, (unsigned)P1_METER_POLL_MS);
+        }
+    }
+    if (!s_url_valid) return;
+    if (WiFi.status() != WL_CONNECTED) {
+        s_client.stop();
+        return;
+    }
+
+    const char* err = nullptr;
+    const unsigned long start_ms = millis();
+    int body_len = -1;
+    // A reused connection may have been closed by the meter while idle: retry once fresh.
+    for (int attempt = 0; attempt < 2 && body_len < 0; attempt++) {
+        const bool reused = s_client.connected();
+        if (!reused) {
+            s_client.stop();
+            if (!s_client.connect(s_host, s_port, P1_METER_TIMEOUT_MS)) {
+                err = "connect failed";
+                break;
+            }
+            s_client.setNoDelay(true);
+            s_stats.connects++;
+        }
+        body_len = fetch_once(&err);
+        if (body_len < 0) {
+            s_client.stop();
+            if (!reused) break;
+        }
+    }
+
+    if (body_len < 0) {
+        s_stats.errors++;
+        if (!s_failing) LOGW("P1", "Poll failed: %s", err ? err : "unknown");
+        s_failing = true;
+        return;
+    }
+
+    #if ENERGY_LATENCY_SUPPORTED
+    energy_latency_on_receive();
+    #endif
+    const uint32_t now = millis();
+    bool parsed = true;
+    publish(ENERGY_CHANNEL_GRID, s_config->p1_meter_grid_path, (size_t)body_len, now, &parsed);
+    publish(ENERGY_CHANNEL_SOLAR, s_config->p1_meter_solar_path, (size_t)body_len, now, &parsed);
+
+    if (!parsed) {
+        s_stats.errors++;
+        if (!s_failing) LOGW("P1", "Value path not found in meter response");
+        s_failing = true;
+        return;
+    }
+    s_stats.polls++;
+    s_stats.last_rtt_ms = (uint32_t)(now - start_ms);
+    if (s_failing || s_stats.polls == 1) {
+        LOGI("P1", "Meter ok (%u bytes, %lums)", (unsigned)body_len, (unsigned long)s_stats.last_rtt_ms);
+    }
+    s_failing = false;
+}
+
+static void p1_task(void*) {
+    for (;;) {
+        const TickType_t start = xTaskGetTickCount();
+        poll_once();
+        // Fixed cadence: the poll time counts towards the period.
+        const TickType_t period = pdMS_TO_TICKS(P1_METER_POLL_MS);
+        const TickType_t spent = xTaskGetTickCount() - start;
+        vTaskDelay(spent < period ? period - spent : 1);
+    }
+}
+
+void p1_meter_init(const DeviceConfig* config) {
+    s_config = config;
+    p1_meter_loop();
+}
+
+void p1_meter_loop() {
+    if (s_task || !s_config || !s_config->p1_meter_url[0]) return;
+    if (!task_placement_create(AppTask::P1Meter, p1_task, nullptr, &s_task, nullptr)) {
+        LOGE("P1", "Task create failed");
+        s_task = nullptr;
+        s_config = nullptr;  // do not retry every loop()
+    }
+}
+
+void p1_meter_get_stats(P1MeterStats* out) {
+    if (!out) return;
+    *out = s_stats;
+}
+
+#endif // P1_METER_SUPPORTED
@@ -0,0 +1,52 @@
+/*
+ * Local P1 Meter Polling
+ *
+ * Alternative energy source to MQTT: a task polls the meter's local JSON API
+ * (p1_meter_url in config, e.g. http://192.168.1.50/api/v1/data for a HomeWizard
+ * P1 meter) every P1_METER_POLL_MS over one HTTP/1.1 keep-alive connection and
+ * feeds the grid (and optionally solar) channel straight into energy_monitor,
+ * skipping the meter -> Home Assistant -> broker hops. The dashboard keeps working
+ * while HA or the broker is down.
+ *
+ * The body is read into a fixed buffer and the values are pulled out with
+ * json_path_extract_number(), so a poll allocates nothing. Values are multiplied
+ * by P1_METER_VALUE_SCALE (W -> kW by default).
+ *
+ * Plain http:// only (local meter APIs do not use TLS). The MQTT grid topic should
+ * be left empty when the meter is the grid source, otherwise both feed the channel.
+ */
+
+#pragma once
+
+#include "board_config.h"
+
+#if P1_METER_ENABLED
+
+#define P1_METER_SUPPORTED 1
+
+#include <stdint.h>
+
+struct DeviceConfig;
+
+struct P1MeterStats {
+    uint32_t polls;         // successful polls (200 + body read)
+    uint32_t errors;        // connect/timeout/HTTP/parse failures
+    uint32_t connects;      // fresh TCP connections (the rest reused keep-alive)
+    uint32_t last_rtt_ms;   // request -> body of the last successful poll
+};
+
+// config is read live, so URL/path changes from /api/config apply on the next
+// poll; clearing the URL idles the task.
+void p1_meter_init(const DeviceConfig* config);
+
+// Start the polling task once a URL is configured (call from main loop; the task
+// and its stack only exist on devices that use a meter).
+void p1_meter_loop();
+
+void p1_meter_get_stats(P1MeterStats* out);
+
+#else
+
+#define P1_METER_SUPPORTED 0
+
+#endif
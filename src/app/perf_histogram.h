@@ -0,0 +1,67 @@
+#pragma once
+
+#include <stdint.h>
+#include <string.h>
+
+// Fixed-size log-linear histogram for latency/size distributions.
+//
+// Each power-of-two range is split into 4 sub-buckets (~19% resolution), so
+// percentiles are approximate, but recording is O(1), allocation-free, and the
+// whole histogram is ~250 bytes. Not thread-safe: record and query from the
+// same task (or guard externally).
+struct PerfHistogram {
+    static constexpr uint8_t kSubBits = 2;
+    static constexpr uint8_t kSubCount = 1 << kSubBits;
+    static constexpr uint8_t kBuckets = (32 - kSubBits + 1) * kSubCount;
+
+    uint16_t counts[kBuckets];
+    uint32_t count;
+    uint32_t max;
+
+    void reset() {
+        memset(counts, 0, sizeof(counts));
+        count = 0;
+        max = 0;
+    }
+
+    static uint8_t bucketFor(uint32_t v) {
+        if (v < kSubCount) return (uint8_t)v;
+        const uint8_t msb = (uint8_t)(31 - __builtin_clz(v));
+        const uint8_t shift = msb - kSubBits;
+        return (uint8_t)(((shift + 1) << kSubBits) + ((v >> shift) & (kSubCount - 1)));
+    }
+
+    // Inclusive upper bound of a bucket (reported value for percentiles).
+    static uint32_t bucketUpper(uint8_t idx) {
+        if (idx < kSubCount) return idx;
+        const uint8_t shift = (idx >> kSubBits) - 1;
+        const uint64_t upper = ((uint64_t)(kSubCount + (idx & (kSubCount - 1)) + 1) << shift) - 1;
+        return upper > 0xFFFFFFFFull ? 0xFFFFFFFFu : (uint32_t)upper;
+    }
+
+    void record(uint32_t v) {
+        const uint8_t idx = bucketFor(v);
+        if (counts[idx] != 0xFFFF) counts[idx]++;
+        count++;
+        if (v > max) max = v;
+    }
+
+    // Approximate percentile (0-100). Returns 0 when empty; never exceeds max.
+    uint32_t percentile(uint8_t pct) const {
+        if (count == 0) return 0;
+        uint32_t total = 0;
+        for (uint8_t i = 0; i < kBuckets; i++) total += counts[i];
+        if (total == 0) return 0;
+
+        const uint32_t target = (uint32_t)(((uint64_t)total * pct + 99) / 100);
+        uint32_t seen = 0;
+        for (uint8_t i = 0; i < kBuckets; i++) {
+            seen += counts[i];
+            if (seen >= target && seen > 0) {
+                const uint32_t upper = bucketUpper(i);
+                return upper < max ? upper : max;
+            }
+        }
+        return max;
+    }
+};
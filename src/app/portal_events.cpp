@@ -0,0 +1,241 @@
+#include "portal_events.h"
+
+#if PORTAL_EVENTS_SUPPORTED
+
+#include "device_telemetry.h"
+#include "energy_monitor.h"
+#include "config_manager.h"
+#include "web_portal_json.h"
+#include "web_portal_state.h"
+
+#include <Arduino.h>
+#include <ESPAsyncWebServer.h>
+#include <math.h>
+#include <memory>
+#include <new>
+#include <stdarg.h>
+#include <string.h>
+
+namespace {
+
+static uint8_t g_clients = 0;  // open streams (atomic)
+
+static bool (*g_auth_gate)(AsyncWebServerRequest* request) = nullptr;
+
+static constexpr unsigned long kKeepaliveMs = 15000;  // comment line while idle
+
+struct PortalEventsClient {
+    // Health event in flight: header/trailer go through `pending`, the body is
+    // copied straight out of the (immutable) snapshot.
+    std::shared_ptr<const DeviceHealthSnapshot> health;
+    size_t health_pos;
+    uint32_t health_seq;
+    unsigned long health_sent_ms;
+    bool health_primed;
+
+    uint32_t energy_generation;
+    unsigned long energy_sent_ms;
+    bool energy_primed;
+    float energy_kw[kEnergyChannelCount];  // last values sent
+
+    unsigned long last_send_ms;
+    char pending[640];
+    size_t pending_len;
+    size_t pending_pos;
+
+    ~PortalEventsClient() {
+        __atomic_fetch_sub(&g_clients, 1, __ATOMIC_RELAXED);
+    }
+};
+
+// Appends s as a JSON string body (quotes not included); returns false when out of room.
+static bool append_json_escaped(char* out, size_t cap, size_t* len, const char* s) {
+    for (; *s; s++) {
+        const char c = *s;
+        if ((unsigned char)c < 0x20) continue;
+        const bool esc = (c == '"' || c == '\\');
+        if (*len + (esc ? 2 : 1) >= cap) return false;
+        if (esc) out[(*len)++] = '\\';
+        out[(*len)++] = c;
+    }
+    return true;
+}
+
+static bool appendf(char* out, size_t cap, size_t* len, const char* fmt, ...) {
+    va_list ap;
+    va_start(ap, fmt);
+    const int n = vsnprintf(out + *len, cap - *len, fmt, ap);
+    va_end(ap);
+    if (n < 0 || (size_t)n >= cap - *len) return false;
+    *len += (size_t)n;
+    return true;
+}
+
+static bool same_value(float a, float b) {
+    return memcmp(&a, &b, sizeof(a)) == 0;  // NAN == NAN, no change
+}
+
+// Builds an energy event into c->pending; false when nothing changed or it did
+// not fit. The per-channel baseline only moves once the whole event is built, so
+// a change left out of a dropped event is still a change next time.
+static bool build_energy_event(PortalEventsClient* c, const EnergyMonitorState& st, unsigned long now) {
+    const bool full = !c->energy_primed;
+    const DeviceConfig* config = full ? web_portal_get_current_config() : nullptr;
+
+    char* p = c->pending;
+    const size_t cap = sizeof(c->pending);
+    size_t len = 0;
+    bool any = false;
+    float sent_kw[kEnergyChannelCount];
+    memcpy(sent_kw, c->energy_kw, sizeof(sent_kw));
+
+    if (!appendf(p, cap, &len, "event: energy\ndata: {\"now_ms\":%lu,\"full\":%s,\"channels\":[",
+            (unsigned long)now, full ? "true" : "false")) {
+        return false;
+    }
+    for (uint8_t i = 0; i < kEnergyChannelCount; i++) {
+        if (!full && same_value(c->energy_kw[i], st.value[i])) continue;
+
+        bool ok = appendf(p, cap, &len, "%s{\"id\":%u", any ? "," : "", (unsigned)i);
+        if (ok && full) {
+            char name_buf[CONFIG_ENERGY_CHANNEL_NAME_MAX_LEN];
+            ok = appendf(p, cap, &len, ",\"name\":\"")
+                && append_json_escaped(p, cap, &len, energy_monitor_channel_name(config, i, name_buf, sizeof(name_buf)))
+                && appendf(p, cap, &len, "\"");
+        }
+        if (ok) {
+            ok = isnan(st.value[i]) ? appendf(p, cap, &len, ",\"kw\":null")
+                                    : appendf(p, cap, &len, ",\"kw\":%.3f", (double)st.value[i]);
+        }
+        if (ok && full) {
+            ok = (st.update_ms[i] == 0) ? appendf(p, cap, &len, ",\"age_ms\":null")
+                                        : appendf(p, cap, &len, ",\"age_ms\":%lu", (unsigned long)(now - st.update_ms[i]));
+        }
+        if (!ok || !appendf(p, cap, &len, "}")) return false;
+        sent_kw[i] = st.value[i];
+        any = true;
+    }
+    if (!any || !appendf(p, cap, &len, "]}\n\n")) return false;
+
+    memcpy(c->energy_kw, sent_kw, sizeof(sent_kw));
+    c->energy_primed = true;
+    c->pending_len = len;
+    c->pending_pos = 0;
+    return true;
+}
+
+// Queues the next event into the client state; false when there is nothing to send.
+static bool refill(PortalEventsClient* c, unsigned long now) {
+    c->pending_len = 0;
+    c->pending_pos = 0;
+
+    const EnergyMonitorState st = energy_monitor_get_state();
+    if ((!c->energy_primed || st.generation != c->energy_generation)
+            && (!c->energy_primed || now - c->energy_sent_ms >= (unsigned long)PORTAL_EVENTS_ENERGY_MIN_MS)) {
+        c->energy_generation = st.generation;
+        c->energy_sent_ms = now;
+        if (build_energy_event(c, st, now)) return true;
+    }
+
+    if (!c->health_primed || now - c->health_sent_ms >= (unsigned long)PORTAL_EVENTS_HEALTH_MIN_MS) {
+        std::shared_ptr<const DeviceHealthSnapshot> snap = device_telemetry_get_health_snapshot();
+        if (snap && (!c->health_primed || snap->seq != c->health_seq)) {
+            const int n = snprintf(c->pending, sizeof(c->pending), "event: health\nid: %lu\ndata: ", (unsigned long)snap->seq);
+            if (n <= 0 || (size_t)n >= sizeof(c->pending)) return false;
+            c->pending_len = (size_t)n;
+            c->health = snap;
+            c->health_pos = 0;
+            c->health_seq = snap->seq;
+            c->health_sent_ms = now;
+            c->health_primed = true;
+            return true;
+        }
+    }
+    return false;
+}
+
+// Fill `buffer` with SSE for the client; RESPONSE_TRY_AGAIN while there is nothing to send.
+static size_t events_fill(PortalEventsClient* c, uint8_t* buffer, size_t max_len) {
+    const unsigned long now = millis();
+    size_t out = 0;
+
+    while (out < max_len) {
+        if (c->pending_pos < c->pending_len) {
+            const size_t n = min(c->pending_len - c->pending_pos, max_len - out);
+            memcpy(buffer + out, c->pending + c->pending_pos, n);
+            c->pending_pos += n;
+            out += n;
+            continue;
+        }
+        if (c->health) {
+            // The snapshot body is single-line JSON, so one data: field carries it.
+            const size_t remaining = c->health->api_len - c->health_pos;
+            if (remaining > 0) {
+                const size_t n = min(remaining, max_len - out);
+                memcpy(buffer + out, c->health->api_json + c->health_pos, n);
+                c->health_pos += n;
+                out += n;
+                continue;
+            }
+            c->health.reset();
+            memcpy(c->pending, "\n\n", 2);
+            c->pending_len = 2;
+            c->pending_pos = 0;
+            continue;
+        }
+        if (!refill(c, now)) break;
+    }
+
+    if (out == 0) {
+        if (now - c->last_send_ms < kKeepaliveMs || max_len < 3) return RESPONSE_TRY_AGAIN;
+        memcpy(buffer, ":\n\n", 3);
+        out = 3;
+    }
+    c->last_send_ms = now;
+    return out;
+}
+
+static void handleEvents(AsyncWebServerRequest* request) {
+    if (g_auth_gate && !g_auth_gate(request)) return;
+    if (__atomic_add_fetch(&g_clients, 1, __ATOMIC_RELAXED) > PORTAL_EVENTS_MAX_CLIENTS) {
+        __atomic_fetch_sub(&g_clients, 1, __ATOMIC_RELAXED);
+        web_portal_send_json_error(request, 429, "Too many event stream clients");
+        return;
+    }
+
+    std::shared_ptr<PortalEventsClient> c(new (std::nothrow) PortalEventsClient());
+    if (!c) {
+        __atomic_fetch_sub(&g_clients, 1, __ATOMIC_RELAXED);
+        web_portal_send_json_error(request, 503, "Out of memory");
+        return;
+    }
+    c->health_pos = 0;
+    c->health_seq = 0;
+    c->health_sent_ms = 0;
+    c->health_primed = false;
+    c->energy_generation = 0;
+    c->energy_sent_ms = 0;
+    c->energy_primed = false;
+    c->last_send_ms = millis();
+    c->pending_len = 0;
+    c->pending_pos = 0;
+
+    AsyncWebServerResponse* response = request->beginChunkedResponse(
+        "text/event-stream",
+        [c](uint8_t* buffer, size_t max_len, size_t) -> size_t {
+            return events_fill(c.get(), buffer, max_len);
+        }
+    );
+    response->addHeader("Cache-Control", "no-cache");
+    response->addHeader("X-Accel-Buffering", "no");
+    request->send(response);
+}
+
+} // namespace
+
+void portal_events_register_routes(AsyncWebServer* server, bool (*auth_gate)(AsyncWebServerRequest* request)) {
+    g_auth_gate = auth_gate;
+    server->on("/api/events", HTTP_GET, handleEvents);
+}
+
+#endif // PORTAL_EVENTS_SUPPORTED
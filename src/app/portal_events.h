@@ -0,0 +1,39 @@
+/*
+ * Portal Event Stream (Server-Sent Events)
+ *
+ * Pushes live state to the web portal instead of having every open page poll
+ * REST endpoints. Each client is fed from the AsyncTCP callbacks: the filler only
+ * runs when the connection can take more bytes and always reads the newest
+ * state, so a slow client skips intermediate values instead of queueing them.
+ *
+ * Events:
+ *   health - the pre-serialized /api/health snapshot (when it changed, at most
+ *            every PORTAL_EVENTS_HEALTH_MIN_MS); id: is the snapshot sequence
+ *   energy - energy channels: the first event lists every channel ("full":true),
+ *            later ones only the channels whose value changed
+ *
+ * Endpoints:
+ *   GET /api/events   - text/event-stream (at most PORTAL_EVENTS_MAX_CLIENTS; more get 429)
+ *
+ * Requires HEALTH_SNAPSHOT_ENABLED (health events reuse the cached snapshot).
+ */
+
+#pragma once
+
+#include "board_config.h"
+
+#if PORTAL_EVENTS_ENABLED && HEALTH_SNAPSHOT_ENABLED
+
+#define PORTAL_EVENTS_SUPPORTED 1
+
+class AsyncWebServer;
+class AsyncWebServerRequest;
+
+// auth_gate: same contract as image_api_register_routes().
+void portal_events_register_routes(AsyncWebServer* server, bool (*auth_gate)(AsyncWebServerRequest* request) = nullptr);
+
+#else
+
+#define PORTAL_EVENTS_SUPPORTED 0
+
+#endif
@@ -2,32 +2,22 @@
 #define PSRAM_JSON_ALLOCATOR_H
 
 #include <Arduino.h>
-#include <esp_heap_caps.h>
+
+#include "app_alloc.h"
 
 // ArduinoJson-compatible allocator that prefers PSRAM (when available) and
-// falls back to internal heap.
+// falls back to internal heap. Pools are accounted under AllocTag::Json.
 //
 // Note: This only affects the JsonDocument memory pool. The document object
 // itself stays on the stack (small), while the heavy storage is allocated via
-// heap_caps_*.
+// the tagged heap facade.
 struct PsramJsonAllocator {
     void* allocate(size_t size) {
-        if (size == 0) return nullptr;
-
-        void* p = nullptr;
-        if (psramFound()) {
-            p = heap_caps_malloc(size, MALLOC_CAP_SPIRAM | MALLOC_CAP_8BIT);
-        }
-        if (!p) {
-            p = heap_caps_malloc(size, MALLOC_CAP_INTERNAL | MALLOC_CAP_8BIT);
-        }
-        return p;
+        return app_alloc(AllocTag::Json, size, AllocPolicy::PreferPsram);
     }
 
     void deallocate(void* ptr) {
-        if (ptr) {
-            heap_caps_free(ptr);
-        }
+        app_free(AllocTag::Json, ptr);
     }
 
     void* reallocate(void* ptr, size_t new_size) {
@@ -37,9 +27,9 @@ struct PsramJsonAllocator {
             return nullptr;
         }
 
-        // Let ESP-IDF decide the best place to grow/shrink this allocation.
-        // (Keeping the original memory region is typically preferable to a copy.)
-        return heap_caps_realloc(ptr, new_size, MALLOC_CAP_8BIT);
+        // Any 8-bit region: shrinkToFit() mostly shrinks in place, and keeping the
+        // original region is typically preferable to a copy.
+        return app_realloc(AllocTag::Json, ptr, new_size, AllocPolicy::Any8bit);
     }
 };
 
@@ -0,0 +1,116 @@
+#include "rgb565_codec.h"
+
+#if HAS_IMAGE_API
+
+#include <string.h>
+
+bool image_strip_format_parse(const char* name, ImageStripFormat* out) {
+    if (!name || !out) return false;
+    if (!*name || strcmp(name, "jpeg") == 0) {
+        *out = ImageStripFormat::Jpeg;
+    } else if (strcmp(name, "rgb565") == 0) {
+        *out = ImageStripFormat::Rgb565;
+    } else if (strcmp(name, "rgb565_rle") == 0) {
+        *out = ImageStripFormat::Rgb565Rle;
+    } else if (strcmp(name, "rgb565_lz4") == 0) {
+        *out = ImageStripFormat::Rgb565Lz4;
+    } else {
+        return false;
+    }
+    return true;
+}
+
+const char* image_strip_format_name(ImageStripFormat fmt) {
+    switch (fmt) {
+        case ImageStripFormat::Rgb565: return "rgb565";
+        case ImageStripFormat::Rgb565Rle: return "rgb565_rle";
+        case ImageStripFormat::Rgb565Lz4: return "rgb565_lz4";
+        case ImageStripFormat::Jpeg:
+        default: return "jpeg";
+    }
+}
+
+bool rgb565_rle_decode(const uint8_t* src, size_t src_len, uint8_t* dst, size_t dst_len) {
+    if (!src || !dst || (dst_len & 1)) return false;
+
+    size_t ip = 0;
+    size_t op = 0;
+    while (ip < src_len) {
+        const uint8_t h = src[ip++];
+        const size_t n = (size_t)(h & 0x7F) + 1;
+        const size_t bytes = n * 2;
+        if (op + bytes > dst_len) return false;
+
+        if (h & 0x80) {
+            if (ip + 2 > src_len) return false;
+            const uint8_t hi = src[ip];
+            const uint8_t lo = src[ip + 1];
+            ip += 2;
+            for (size_t i = 0; i < n; i++) {
+                dst[op++] = hi;
+                dst[op++] = lo;
+            }
+        } else {
+            if (ip + bytes > src_len) return false;
+            memcpy(dst + op, src + ip, bytes);
+            ip += bytes;
+            op += bytes;
+        }
+    }
+    return op == dst_len;
+}
+
+// Reads an LZ4 length extension (sequence of 255s terminated by a smaller byte).
+static bool lz4_read_length(const uint8_t* src, size_t src_len, size_t* ip, size_t* len) {
+    uint8_t b;
+    do {
+        if (*ip >= src_len) return false;
+        b = src[(*ip)++];
+        *len += b;
+    } while (b == 255);
+    return true;
+}
+
+bool rgb565_lz4_decode(const uint8_t* src, size_t src_len, uint8_t* dst, size_t dst_len) {
+    if (!src || !dst) return false;
+
+    size_t ip = 0;
+    size_t op = 0;
+    while (ip < src_len) {
+        const uint8_t token = src[ip++];
+
+        size_t lit = token >> 4;
+        if (lit == 15 && !lz4_read_length(src, src_len, &ip, &lit)) return false;
+        if (ip + lit > src_len || op + lit > dst_len) return false;
+        memcpy(dst + op, src + ip, lit);
+        ip += lit;
+        op += lit;
+
+        // The last sequence carries literals only.
+        if (ip == src_len) break;
+
+        if (ip + 2 > src_len) return false;
+        const size_t offset = (size_t)src[ip] | ((size_t)src[ip + 1] << 8);
+        ip += 2;
+        if (offset == 0 || offset > op) return false;
+
+        size_t match = token & 0x0F;
+        if (match == 15 && !lz4_read_length(src, src_len, &ip, &match)) return false;
+        match += 4;
+        if (op + match > dst_len) return false;
+
+        // Byte copy: matches may overlap their own output (offset < length = run).
+        const uint8_t* m = dst + op - offset;
+        if (offset >= match) {
+            memcpy(dst + op, m, match);
+            op += match;
+        } else {
+            for (size_t i = 0; i < match; i++) {
+                dst[op++] = m[i];
+            }
+        }
+    }
+    return op == dst_len;
+}
+
+#endif // HAS_IMAGE_API
@@ -0,0 +1,40 @@
+/*
+ * RGB565 Frame Codecs
+ *
+ * Decoders for the non-JPEG strip formats of /api/display/image/strips.
+ * All formats carry big-endian (MSB-first) RGB565 pixels, i.e. the SPI wire order,
+ * so an uncompressed strip can go to the panel without touching a single pixel.
+ *
+ *   rgb565      raw pixels, width * rows * 2 bytes
+ *   rgb565_rle  PackBits over 16-bit pixels: header byte h
+ *                 h & 0x80 -> repeat the next pixel (h & 0x7F) + 1 times
+ *                 else     -> h + 1 literal pixels follow
+ *   rgb565_lz4  one LZ4 block (no frame header, e.g. lz4.block.compress(store_size=False))
+ */
+
+#pragma once
+
+#include "board_config.h"
+
+#if HAS_IMAGE_API
+
+#include <stddef.h>
+#include <stdint.h>
+
+enum class ImageStripFormat : uint8_t {
+    Jpeg = 0,
+    Rgb565,
+    Rgb565Rle,
+    Rgb565Lz4,
+};
+
+// Parse a `format` query value ("jpeg", "rgb565", "rgb565_rle", "rgb565_lz4").
+bool image_strip_format_parse(const char* name, ImageStripFormat* out);
+const char* image_strip_format_name(ImageStripFormat fmt);
+
+// Decompress into exactly `dst_len` bytes. Returns false on malformed input, output
+// overrun, or short output (the strip would leave stale rows on the panel).
+bool rgb565_rle_decode(const uint8_t* src, size_t src_len, uint8_t* dst, size_t dst_len);
+bool rgb565_lz4_decode(const uint8_t* src, size_t src_len, uint8_t* dst, size_t dst_len);
+
+#endif // HAS_IMAGE_API
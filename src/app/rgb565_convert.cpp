@@ -0,0 +1,77 @@
+#include "board_config.h"
+
+#if HAS_IMAGE_API
+
+#include "rgb565_convert.h"
+#include "log_manager.h"
+
+#include <Arduino.h>
+#include <esp_heap_caps.h>
+#include <esp_timer.h>
+
+Rgb565ConvertFn rgb565_select_convert(bool bgr, bool wire_order) {
+    if (bgr) {
+        return wire_order ? rgb565_convert_rgb888<true, true> : rgb565_convert_rgb888<true, false>;
+    }
+    return wire_order ? rgb565_convert_rgb888<false, true> : rgb565_convert_rgb888<false, false>;
+}
+
+// Byte-at-a-time reference (the pre-word-path loop), kept for benchmark comparison.
+static void rgb565_convert_bytewise(const uint8_t* src, uint16_t* dst, int count) {
+    for (int i = 0; i < count; i++) {
+        dst[i] = rgb565_pack<false, true>(src[0], src[1], src[2]);
+        src += 3;
+    }
+}
+
+bool rgb565_convert_benchmark_log() {
+    // One 320x16 MCU band: representative of a TJpgDec output rect batch.
+    static constexpr int kPixels = 320 * 16;
+    static constexpr int kRounds = 64;
+
+    uint8_t* src = (uint8_t*)heap_caps_malloc((size_t)kPixels * 3, MALLOC_CAP_INTERNAL | MALLOC_CAP_8BIT);
+    uint16_t* dst = (uint16_t*)heap_caps_malloc((size_t)kPixels * sizeof(uint16_t), MALLOC_CAP_INTERNAL | MALLOC_CAP_8BIT);
+    if (!src || !dst) {
+        heap_caps_free(src);
+        heap_caps_free(dst);
+        LOGW("RGB565", "Benchmark skipped (no scratch RAM)");
+        return false;
+    }
+    for (int i = 0; i < kPixels * 3; i++) {
+        src[i] = (uint8_t)(i * 37);
+    }
+
+    struct Variant {
+        const char* name;
+        Rgb565ConvertFn fn;
+        const uint8_t* src;
+    };
+    const Variant variants[] = {
+        {"bytewise", rgb565_convert_bytewise, src},
+        {"rgb/wire", rgb565_convert_rgb888<false, true>, src},
+        {"rgb/cpu", rgb565_convert_rgb888<false, false>, src},
+        {"bgr/wire", rgb565_convert_rgb888<true, true>, src},
+        // Odd source offset forces the scalar path (unaligned TJpgDec buffers).
+        {"rgb/wire unaligned", rgb565_convert_rgb888<false, true>, src + 1},
+    };
+
+    LOGI("RGB565", "Convert benchmark (%s, %d MHz)", CONFIG_IDF_TARGET, (int)getCpuFrequencyMhz());
+    for (const Variant& v : variants) {
+        const int count = (v.src == src) ? kPixels : kPixels - 1;
+        v.fn(v.src, dst, count);  // warm caches
+        const int64_t t0 = esp_timer_get_time();
+        for (int r = 0; r < kRounds; r++) {
+            v.fn(v.src, dst, count);
+        }
+        const int64_t us = esp_timer_get_time() - t0;
+        // pixels/us == Mpx/s; keep two decimals without pulling in float printf.
+        const uint32_t centi_mpps = us > 0 ? (uint32_t)(((int64_t)count * kRounds * 100) / us) : 0;
+        LOGI("RGB565", "  %-18s %3u.%02u Mpx/s", v.name, (unsigned)(centi_mpps / 100), (unsigned)(centi_mpps % 100));
+    }
+
+    heap_caps_free(src);
+    heap_caps_free(dst);
+    return true;
+}
+
+#endif // HAS_IMAGE_API
@@ -0,0 +1,65 @@
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+
+// RGB888 -> 16-bit pixel conversion shared by the JPEG decoders.
+//
+// kBgr packs blue in the high bits (BGR565); kWireOrder stores each pixel MSB-first
+// so SPI drivers can stream the buffer without swapping (LVGL_COLOR_16_SWAP layout).
+// Both are template parameters so every combination compiles to a branch-free loop.
+//
+// When both pointers are 4-byte aligned the kernel consumes 4 pixels per iteration:
+// three 32-bit loads (12 source bytes) and two 32-bit stores (two pixels each),
+// instead of three byte loads and one halfword store per pixel.
+
+typedef void (*Rgb565ConvertFn)(const uint8_t* src, uint16_t* dst, int count);
+
+template <bool kBgr, bool kWireOrder>
+static inline uint16_t rgb565_pack(uint8_t r, uint8_t g, uint8_t b) {
+    const uint8_t hi = kBgr ? b : r;
+    const uint8_t lo = kBgr ? r : b;
+    const uint16_t v = (uint16_t)(((hi & 0xF8) << 8) | ((g & 0xFC) << 3) | (lo >> 3));
+    return kWireOrder ? (uint16_t)((v << 8) | (v >> 8)) : v;
+}
+
+template <bool kBgr, bool kWireOrder>
+static void rgb565_convert_rgb888(const uint8_t* src, uint16_t* dst, int count) {
+    int i = 0;
+
+    // The word path assumes a little-endian core (all ESP32 targets are).
+    if ((((uintptr_t)src | (uintptr_t)dst) & 0x3) == 0) {
+        const uint32_t* s = (const uint32_t*)src;
+        uint32_t* d = (uint32_t*)dst;
+        for (; i + 4 <= count; i += 4) {
+            // w0 = r0 g0 b0 r1 | w1 = g1 b1 r2 g2 | w2 = b2 r3 g3 b3 (byte 0 first)
+            const uint32_t w0 = s[0];
+            const uint32_t w1 = s[1];
+            const uint32_t w2 = s[2];
+            s += 3;
+
+            const uint16_t p0 = rgb565_pack<kBgr, kWireOrder>((uint8_t)w0, (uint8_t)(w0 >> 8), (uint8_t)(w0 >> 16));
+            const uint16_t p1 = rgb565_pack<kBgr, kWireOrder>((uint8_t)(w0 >> 24), (uint8_t)w1, (uint8_t)(w1 >> 8));
+            const uint16_t p2 = rgb565_pack<kBgr, kWireOrder>((uint8_t)(w1 >> 16), (uint8_t)(w1 >> 24), (uint8_t)w2);
+            const uint16_t p3 = rgb565_pack<kBgr, kWireOrder>((uint8_t)(w2 >> 8), (uint8_t)(w2 >> 16), (uint8_t)(w2 >> 24));
+
+            d[0] = (uint32_t)p0 | ((uint32_t)p1 << 16);
+            d[1] = (uint32_t)p2 | ((uint32_t)p3 << 16);
+            d += 2;
+        }
+        src += (size_t)i * 3;
+    }
+
+    // Unaligned buffers and the 0..3 pixel tail.
+    for (; i < count; i++) {
+        dst[i] = rgb565_pack<kBgr, kWireOrder>(src[0], src[1], src[2]);
+        src += 3;
+    }
+}
+
+// Runtime selection for callers whose pixel format depends on the display driver.
+Rgb565ConvertFn rgb565_select_convert(bool bgr, bool wire_order);
+
+// Times every kernel variant over a scratch buffer and logs megapixels/second
+// (used by RGB565_CONVERT_BENCH_AT_BOOT; returns false if scratch alloc fails).
+bool rgb565_convert_benchmark_log();
@@ -1,14 +1,29 @@
 #include "rtos_task_utils.h"
 
+#include "board_profile.h"
 #include "soc/soc_caps.h"
 
 #include <esp_heap_caps.h>
 
-static inline bool psram_available() {
-#if SOC_SPIRAM_SUPPORTED
-    return heap_caps_get_total_size(MALLOC_CAP_SPIRAM) > 0;
+TaskHandle_t rtos_create_task_static_pinned(
+    TaskFunction_t taskFunction,
+    const char* name,
+    uint32_t stackDepthWords,
+    void* param,
+    UBaseType_t priority,
+    StackType_t* stack,
+    StaticTask_t* tcb,
+    BaseType_t coreId
+) {
+    if (!taskFunction || !name || stackDepthWords == 0 || !stack || !tcb) {
+        return nullptr;
+    }
+
+#if CONFIG_FREERTOS_UNICORE
+    (void)coreId;
+    return xTaskCreateStatic(taskFunction, name, stackDepthWords, param, priority, stack, tcb);
 #else
-    return false;
+    return xTaskCreateStaticPinnedToCore(taskFunction, name, stackDepthWords, param, priority, stack, tcb, coreId);
 #endif
 }
 
@@ -20,6 +35,21 @@ bool rtos_create_task_psram_stack(
     UBaseType_t priority,
     TaskHandle_t* outHandle,
     RtosTaskPsramAlloc* outAlloc
+) {
+    return rtos_create_task_psram_stack_pinned(
+        taskFunction, name, stackDepthWords, param, priority, outHandle, outAlloc, tskNO_AFFINITY
+    );
+}
+
+bool rtos_create_task_psram_stack_pinned(
+    TaskFunction_t taskFunction,
+    const char* name,
+    uint32_t stackDepthWords,
+    void* param,
+    UBaseType_t priority,
+    TaskHandle_t* outHandle,
+    RtosTaskPsramAlloc* outAlloc,
+    BaseType_t coreId
 ) {
     if (!taskFunction || !name || stackDepthWords == 0 || !outHandle) {
         return false;
@@ -27,7 +57,7 @@ bool rtos_create_task_psram_stack(
 
     *outHandle = nullptr;
 
-    if (!psram_available()) {
+    if (!board_psram_available()) {
         return false;
     }
 
@@ -48,7 +78,7 @@ bool rtos_create_task_psram_stack(
         return false;
     }
 
-    TaskHandle_t handle = xTaskCreateStatic(taskFunction, name, stackDepthWords, param, priority, stack, tcb);
+    TaskHandle_t handle = rtos_create_task_static_pinned(taskFunction, name, stackDepthWords, param, priority, stack, tcb, coreId);
 
     if (handle == nullptr) {
         heap_caps_free(tcb);
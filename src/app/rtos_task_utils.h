@@ -24,3 +24,29 @@ bool rtos_create_task_psram_stack(
     TaskHandle_t* outHandle,
     RtosTaskPsramAlloc* outAlloc
 );
+
+// Create a task on caller-owned storage (xTaskCreateStatic, pinned to `coreId` on
+// dual-core builds). `stack` and `tcb` must outlive the task.
+TaskHandle_t rtos_create_task_static_pinned(
+    TaskFunction_t taskFunction,
+    const char* name,
+    uint32_t stackDepthWords,
+    void* param,
+    UBaseType_t priority,
+    StackType_t* stack,
+    StaticTask_t* tcb,
+    BaseType_t coreId
+);
+
+// Same as rtos_create_task_psram_stack(), pinned to `coreId`
+// (tskNO_AFFINITY = any core; ignored on single-core builds).
+bool rtos_create_task_psram_stack_pinned(
+    TaskFunction_t taskFunction,
+    const char* name,
+    uint32_t stackDepthWords,
+    void* param,
+    UBaseType_t priority,
+    TaskHandle_t* outHandle,
+    RtosTaskPsramAlloc* outAlloc,
+    BaseType_t coreId
+);
@@ -5,7 +5,7 @@
 #include "screen_saver_manager.h"
 #include "log_manager.h"
 #include "display_manager.h"
-#include "energy_monitor.h"
+#include "energy_alarm.h"
 
 #if HAS_TOUCH
 #include "touch_manager.h"
@@ -26,6 +26,8 @@ uint32_t g_fade_start_ms = 0;
 uint32_t g_fade_duration_ms = 0;
 uint8_t g_fade_from = 0;
 uint8_t g_fade_to = 0;
+// The running fade is on the LEDC fade engine; update_fade() only tracks it.
+bool g_fade_hw = false;
 
 uint8_t g_current_brightness = 100;
 uint8_t g_target_brightness = 100;
@@ -42,6 +44,12 @@ bool g_prev_touch = false;
 #endif
 
 bool g_warning_screen_active = false;
+bool g_render_suspended = false;
+
+// Auto-brightness (ambient_light): replaces the config brightness as the target while active.
+bool g_auto_active = false;
+uint8_t g_auto_pct = 0;
+volatile bool g_pending_auto = false;
 
 static bool is_enabled() {
     if (!g_config) return false;
@@ -64,6 +72,7 @@ static uint16_t fade_in_ms() {
 }
 
 static uint8_t config_brightness() {
+    if (g_auto_active) return g_auto_pct;
     if (!g_config) return 100;
     uint8_t b = g_config->backlight_brightness;
     if (b > 100) b = 100;
@@ -90,6 +99,7 @@ static void start_fade(ScreenSaverState newState, uint8_t from, uint8_t to, uint
     g_fade_from = from;
     g_fade_to = to;
     g_target_brightness = to;
+    g_fade_hw = false;
 
     // If duration is 0, apply immediately.
     if (duration_ms == 0) {
@@ -99,6 +109,15 @@ static void start_fade(ScreenSaverState newState, uint8_t from, uint8_t to, uint
         return;
     }
 
+    // Prefer the hardware fade: it starts from the duty actually on the pin and
+    // stays smooth while loop() is busy (MQTT, image decode).
+    DisplayDriver* driver = (displayManager) ? displayManager->getDriver() : nullptr;
+    if (driver && driver->hasBacklightControl() && driver->fadeBacklightTo(to, duration_ms)) {
+        g_fade_hw = true;
+        g_current_brightness = from;
+        return;
+    }
+
     // Apply the starting brightness right away to avoid a one-loop delay.
     g_current_brightness = from;
     apply_brightness(from);
@@ -153,7 +172,7 @@ static void handle_pending_requests() {
         // If both are requested, prefer wake.
         // Sleep is a manual override and should work even when the feature is disabled.
         if (!doWake) {
-            if (energy_monitor_has_warning(g_config)) {
+            if (energy_alarm_active()) {
                 const uint8_t target = config_brightness();
                 g_current_brightness = target;
                 g_target_brightness = target;
@@ -198,6 +217,26 @@ static void handle_pending_requests() {
     }
 }
 
+// Awake: ease to the new ambient target. Asleep/fading: the next wake or
+// warning screen picks it up through config_brightness().
+static void apply_auto_brightness() {
+    if (!g_pending_auto) return;
+    portENTER_CRITICAL(&g_mux);
+    g_pending_auto = false;
+    portEXIT_CRITICAL(&g_mux);
+
+    if (g_state != ScreenSaverState::Awake) return;
+    const uint8_t target = config_brightness();
+    if (target == g_current_brightness) return;
+
+    g_target_brightness = target;
+    g_current_brightness = target;
+    DisplayDriver* driver = (displayManager) ? displayManager->getDriver() : nullptr;
+    if (!(driver && driver->hasBacklightControl() && driver->fadeBacklightTo(target, SCREEN_SAVER_AUTO_BRIGHTNESS_FADE_MS))) {
+        apply_brightness(target);
+    }
+}
+
 static void update_fade() {
     if (g_state != ScreenSaverState::FadingOut && g_state != ScreenSaverState::FadingIn) {
         return;
@@ -212,19 +251,25 @@ static void update_fade() {
 
     if (elapsed >= g_fade_duration_ms) {
         g_current_brightness = g_fade_to;
-        apply_brightness(g_fade_to);
+        // The hardware fade has already landed on the target.
+        if (!g_fade_hw) apply_brightness(g_fade_to);
+        g_fade_hw = false;
         g_state = (g_fade_to == 0) ? ScreenSaverState::Asleep : ScreenSaverState::Awake;
         return;
     }
 
-    // Linear interpolation: from + (to-from) * t
-    const float t = (float)elapsed / (float)g_fade_duration_ms;
+    // Linear interpolation: from + (to-from) * elapsed / duration
     const int delta = (int)g_fade_to - (int)g_fade_from;
-    int value = (int)g_fade_from + (int)((float)delta * t);
+    int value = (int)g_fade_from + (int)(((int32_t)delta * (int32_t)elapsed) / (int32_t)g_fade_duration_ms);
     if (value < 0) value = 0;
     if (value > 100) value = 100;
 
     const uint8_t newBrightness = (uint8_t)value;
+    if (g_fade_hw) {
+        // Status estimate only; the LEDC engine drives the pin.
+        g_current_brightness = newBrightness;
+        return;
+    }
     if (newBrightness != g_current_brightness) {
         g_current_brightness = newBrightness;
         apply_brightness(newBrightness);
@@ -242,7 +287,7 @@ static void maybe_auto_sleep() {
 
     const uint32_t now = millis();
     if (now - g_last_activity_ms >= toMs) {
-        if (energy_monitor_has_warning(g_config)) {
+        if (energy_alarm_active()) {
             const uint8_t target = config_brightness();
             g_current_brightness = target;
             g_target_brightness = target;
@@ -266,6 +311,13 @@ static void poll_touch_activity() {
     // Only poll the raw touch state to wake the backlight when sleeping/dimming.
     if (g_state == ScreenSaverState::Awake || g_state == ScreenSaverState::FadingIn) return;
 
+    // Asleep, this is the only touch reader left (LVGL is parked); a slower rate
+    // still catches a wake tap and keeps I2C/SPI controllers mostly idle.
+    static uint32_t last_poll_ms = 0;
+    const uint32_t now = millis();
+    if (g_state == ScreenSaverState::Asleep && (uint32_t)(now - last_poll_ms) < SCREEN_SAVER_ASLEEP_TOUCH_POLL_MS) return;
+    last_poll_ms = now;
+
     const bool touched = touch_manager_is_touched();
     const bool pressedEdge = touched && !g_prev_touch;
     g_prev_touch = touched;
@@ -334,11 +386,12 @@ void screen_saver_manager_loop() {
     g_prev_enabled = enabledNow;
 
     handle_pending_requests();
+    apply_auto_brightness();
 
     // While asleep, show warning screen with backlight on when warning is active.
     // If warning clears, return to previous screen and turn backlight off.
     if (g_state == ScreenSaverState::Asleep) {
-        if (energy_monitor_has_warning(g_config)) {
+        if (energy_alarm_active()) {
             const uint8_t target = config_brightness();
             if (g_current_brightness != target) {
                 g_current_brightness = target;
@@ -365,6 +418,16 @@ void screen_saver_manager_loop() {
     update_fade();
     maybe_auto_sleep();
 
+    // Dark panel: park LVGL. Wake sources stay live (touch polling above, API
+    // wake/activity, and the energy warning check that brings up the warning screen).
+    #if SCREEN_SAVER_SUSPEND_RENDER
+    const bool suspend = (g_state == ScreenSaverState::Asleep) && !g_warning_screen_active && g_current_brightness == 0;
+    if (suspend != g_render_suspended) {
+        g_render_suspended = suspend;
+        display_manager_set_render_suspended(suspend);
+    }
+    #endif
+
     #if HAS_TOUCH
     // While dimming/asleep/fading in, suppress LVGL input so wake gestures don't click-through.
     // This is based on state (not config enabled), so it also protects transitions caused
@@ -384,6 +447,15 @@ void screen_saver_manager_lvgl_update() {
 }
 
 
+void screen_saver_manager_set_auto_brightness(bool active, uint8_t brightness) {
+    if (brightness > 100) brightness = 100;
+    portENTER_CRITICAL(&g_mux);
+    g_auto_active = active;
+    g_auto_pct = brightness;
+    g_pending_auto = true;
+    portEXIT_CRITICAL(&g_mux);
+}
+
 void screen_saver_manager_notify_activity(bool wake) {
     request_activity(wake);
 }
@@ -406,6 +478,7 @@ ScreenSaverStatus screen_saver_manager_get_status() {
     status.state = g_state;
     status.current_brightness = g_current_brightness;
     status.target_brightness = g_target_brightness;
+    status.render_suspended = g_render_suspended;
 
     status.seconds_until_sleep = 0;
     if (status.enabled && g_state == ScreenSaverState::Awake) {
@@ -25,6 +25,7 @@ struct ScreenSaverStatus {
     uint8_t current_brightness;
     uint8_t target_brightness;
     uint32_t seconds_until_sleep;
+    bool render_suspended;  // LVGL render task parked (asleep, backlight off)
 };
 
 // Initialize with the current config (must remain valid for lifetime)
@@ -37,6 +38,10 @@ void screen_saver_manager_loop();
 // Activity resets the inactivity timer; optionally wakes immediately (with fade)
 void screen_saver_manager_notify_activity(bool wake);
 
+// Auto-brightness target (ambient_light). While active it replaces the configured
+// brightness; changes while awake ease in with a (hardware) fade. Any task.
+void screen_saver_manager_set_auto_brightness(bool active, uint8_t brightness);
+
 // Explicit controls
 void screen_saver_manager_sleep_now();
 void screen_saver_manager_wake();
@@ -61,15 +66,17 @@ struct ScreenSaverStatus {
     uint8_t current_brightness;
     uint8_t target_brightness;
     uint32_t seconds_until_sleep;
+    bool render_suspended;
 };
 
 inline void screen_saver_manager_init(DeviceConfig*) {}
 inline void screen_saver_manager_loop() {}
 inline void screen_saver_manager_notify_activity(bool) {}
+inline void screen_saver_manager_set_auto_brightness(bool, uint8_t) {}
 inline void screen_saver_manager_sleep_now() {}
 inline void screen_saver_manager_wake() {}
 inline bool screen_saver_manager_is_asleep() { return false; }
-inline ScreenSaverStatus screen_saver_manager_get_status() { return {false, ScreenSaverState::Awake, 0, 0, 0}; }
+inline ScreenSaverStatus screen_saver_manager_get_status() { return {false, ScreenSaverState::Awake, 0, 0, 0, false}; }
 
 #endif // HAS_DISPLAY
 
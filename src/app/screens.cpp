@@ -13,12 +13,18 @@
 #if HAS_DISPLAY
 
 // Include all screen implementations
+#include "screens/digit_label.cpp"
+#include "screens/sparkline.cpp"
 #include "screens/splash_screen.cpp"
 #include "screens/info_screen.cpp"
 #include "screens/energy_monitor_screen.cpp"
 #include "screens/test_screen.cpp"
 #include "screens/warning_screen.cpp"
 
+#if SECONDARY_DISPLAY_DRIVER
+#include "screens/status_panel_screen.cpp"
+#endif
+
 #if HAS_IMAGE_API
 #include "screens/direct_image_screen.cpp"
 #include "screens/lvgl_image_screen.cpp"
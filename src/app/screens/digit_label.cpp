@@ -0,0 +1,233 @@
+#include "digit_label.h"
+
+#include "log_manager.h"
+
+#include <string.h>
+
+namespace {
+
+static const char kGlyphs[] = "0123456789.-";
+static constexpr size_t kGlyphCount = sizeof(kGlyphs) - 1;
+static constexpr size_t kMaxText = 12;
+static constexpr size_t kMaxAtlases = 2;
+
+struct DigitGlyph {
+    lv_img_dsc_t img;    // A8 bitmap (box_w x box_h), data in the atlas block
+    int16_t ofs_x;
+    int16_t top;         // y of the bitmap's top row relative to the line top
+    uint16_t adv_w;
+    int16_t ink_x1;      // horizontal extent touched when drawn (advance cell plus overhang)
+    int16_t ink_x2;
+};
+
+struct DigitAtlas {
+    const lv_font_t* font;
+    DigitGlyph glyphs[kGlyphCount];
+    uint16_t max_adv_w;
+    uint8_t* pixels;
+};
+
+struct DigitLabelState {
+    const DigitAtlas* atlas;
+    uint8_t max_chars;
+    char text[kMaxText + 1];
+};
+
+// Atlases live for the lifetime of the firmware (fonts are static).
+static DigitAtlas s_atlases[kMaxAtlases];
+static size_t s_atlas_count = 0;
+
+static int glyph_index(char c) {
+    const char* p = strchr(kGlyphs, c);
+    return (p && c) ? (int)(p - kGlyphs) : -1;
+}
+
+// Font bitmaps are a continuous bit stream of `bpp`-bit coverage values.
+static uint8_t read_coverage(const uint8_t* src, uint32_t index, uint8_t bpp) {
+    if (bpp == 8) return src[index];
+    const uint32_t bit = index * bpp;
+    const uint8_t in_byte = (uint8_t)(bit & 7);
+    uint16_t word = (uint16_t)src[bit >> 3] << 8;
+    if (in_byte + bpp > 8) word |= src[(bit >> 3) + 1];  // only 3 bpp straddles bytes
+    const uint8_t shift = (uint8_t)(16 - bpp - in_byte);
+    const uint8_t v = (uint8_t)((word >> shift) & ((1u << bpp) - 1));
+    return (uint8_t)((v * 255u) / ((1u << bpp) - 1));
+}
+
+static const DigitAtlas* atlas_for(const lv_font_t* font) {
+    for (size_t i = 0; i < s_atlas_count; i++) {
+        if (s_atlases[i].font == font) return &s_atlases[i];
+    }
+    if (s_atlas_count >= kMaxAtlases) return nullptr;
+
+    DigitAtlas& a = s_atlases[s_atlas_count];
+    memset(&a, 0, sizeof(a));
+    a.font = font;
+
+    lv_font_glyph_dsc_t g[kGlyphCount];
+    size_t total = 0;
+    for (size_t i = 0; i < kGlyphCount; i++) {
+        if (!lv_font_get_glyph_dsc(font, &g[i], (uint32_t)kGlyphs[i], 0)) {
+            memset(&g[i], 0, sizeof(g[i]));
+        }
+        total += (size_t)g[i].box_w * g[i].box_h;
+    }
+
+    a.pixels = (uint8_t*)lv_mem_alloc(total ? total : 1);
+    if (!a.pixels) {
+        LOGE("Digits", "Atlas alloc failed (%u bytes)", (unsigned)total);
+        return nullptr;
+    }
+
+    const int16_t baseline_top = (int16_t)(font->line_height - font->base_line);
+    uint8_t* dst = a.pixels;
+    for (size_t i = 0; i < kGlyphCount; i++) {
+        DigitGlyph& out = a.glyphs[i];
+        out.adv_w = g[i].adv_w;
+        out.ofs_x = g[i].ofs_x;
+        out.top = (int16_t)(baseline_top - (int16_t)g[i].box_h - g[i].ofs_y);
+        if (out.adv_w > a.max_adv_w) a.max_adv_w = out.adv_w;
+        out.ink_x1 = (int16_t)(g[i].ofs_x < 0 ? g[i].ofs_x : 0);
+        out.ink_x2 = (int16_t)(g[i].ofs_x + g[i].box_w > g[i].adv_w ? g[i].ofs_x + g[i].box_w : g[i].adv_w) - 1;
+
+        const uint32_t n = (uint32_t)g[i].box_w * g[i].box_h;
+        const uint8_t* src = (n > 0) ? lv_font_get_glyph_bitmap(font, (uint32_t)kGlyphs[i]) : nullptr;
+        if (src) {
+            for (uint32_t p = 0; p < n; p++) dst[p] = read_coverage(src, p, g[i].bpp);
+        } else {
+            memset(dst, 0, n);
+        }
+
+        out.img.header.always_zero = 0;
+        out.img.header.cf = LV_IMG_CF_ALPHA_8BIT;
+        out.img.header.w = g[i].box_w;
+        out.img.header.h = g[i].box_h;
+        out.img.data_size = n;
+        out.img.data = dst;
+        dst += n;
+    }
+
+    s_atlas_count++;
+    LOGI("Digits", "Atlas for %upx font: %u bytes", (unsigned)font->line_height, (unsigned)total);
+    return &a;
+}
+
+static int32_t box_width(const DigitLabelState* s) {
+    return (int32_t)s->atlas->max_adv_w * s->max_chars;
+}
+
+static int32_t text_width(const DigitAtlas* a, const char* text) {
+    int32_t w = 0;
+    for (const char* p = text; *p; p++) {
+        const int gi = glyph_index(*p);
+        if (gi >= 0) w += a->glyphs[gi].adv_w;
+    }
+    return w;
+}
+
+// Invalidate the area one glyph drawn at x (relative to the object) touches.
+static void invalidate_cell(lv_obj_t* obj, const DigitAtlas* a, int gi, int32_t x) {
+    if (gi < 0) return;
+    lv_area_t area;
+    area.x1 = (lv_coord_t)(obj->coords.x1 + x + a->glyphs[gi].ink_x1);
+    area.x2 = (lv_coord_t)(obj->coords.x1 + x + a->glyphs[gi].ink_x2);
+    area.y1 = obj->coords.y1;
+    area.y2 = obj->coords.y2;
+    lv_obj_invalidate_area(obj, &area);
+}
+
+static void draw_cb(lv_event_t* e) {
+    lv_obj_t* obj = lv_event_get_target(e);
+    DigitLabelState* s = (DigitLabelState*)lv_obj_get_user_data(obj);
+    if (!s || !s->atlas) return;
+    lv_draw_ctx_t* draw_ctx = lv_event_get_draw_ctx(e);
+
+    lv_draw_img_dsc_t dsc;
+    lv_draw_img_dsc_init(&dsc);
+    dsc.recolor = lv_obj_get_style_text_color(obj, LV_PART_MAIN);  // A8: the glyph color
+    dsc.opa = lv_obj_get_style_text_opa(obj, LV_PART_MAIN);
+
+    int32_t x = (box_width(s) - text_width(s->atlas, s->text)) / 2;
+    for (const char* p = s->text; *p; p++) {
+        const int gi = glyph_index(*p);
+        if (gi < 0) continue;
+        const DigitGlyph& g = s->atlas->glyphs[gi];
+        if (g.img.header.w > 0 && g.img.header.h > 0) {
+            lv_area_t area;
+            area.x1 = (lv_coord_t)(obj->coords.x1 + x + g.ofs_x);
+            area.y1 = (lv_coord_t)(obj->coords.y1 + g.top);
+            area.x2 = (lv_coord_t)(area.x1 + g.img.header.w - 1);
+            area.y2 = (lv_coord_t)(area.y1 + g.img.header.h - 1);
+            lv_draw_img(draw_ctx, &dsc, &area, &g.img);
+        }
+        x += g.adv_w;
+    }
+}
+
+static void delete_cb(lv_event_t* e) {
+    lv_obj_t* obj = lv_event_get_target(e);
+    void* s = lv_obj_get_user_data(obj);
+    lv_obj_set_user_data(obj, nullptr);
+    if (s) lv_mem_free(s);
+}
+
+} // namespace
+
+lv_obj_t* digit_label_create(lv_obj_t* parent, const lv_font_t* font, uint8_t max_chars) {
+    if (max_chars == 0 || max_chars > kMaxText) max_chars = kMaxText;
+
+    lv_obj_t* obj = lv_obj_create(parent);
+    lv_obj_remove_style_all(obj);
+    lv_obj_clear_flag(obj, (lv_obj_flag_t)(LV_OBJ_FLAG_SCROLLABLE | LV_OBJ_FLAG_CLICKABLE));
+
+    DigitLabelState* s = (DigitLabelState*)lv_mem_alloc(sizeof(DigitLabelState));
+    if (s) {
+        memset(s, 0, sizeof(*s));
+        s->atlas = atlas_for(font);
+        s->max_chars = max_chars;
+    }
+    lv_obj_set_user_data(obj, s);
+
+    const lv_coord_t w = (s && s->atlas) ? (lv_coord_t)box_width(s) : 0;
+    lv_obj_set_size(obj, w, font ? font->line_height : 0);
+    lv_obj_add_event_cb(obj, draw_cb, LV_EVENT_DRAW_MAIN, nullptr);
+    lv_obj_add_event_cb(obj, delete_cb, LV_EVENT_DELETE, nullptr);
+    return obj;
+}
+
+bool digit_label_set_text(lv_obj_t* obj, const char* text) {
+    if (!obj) return false;
+    DigitLabelState* s = (DigitLabelState*)lv_obj_get_user_data(obj);
+    if (!s || !s->atlas) return false;
+    if (!text) text = "";
+
+    char next[kMaxText + 1];
+    strlcpy(next, text, (size_t)s->max_chars + 1);
+    if (strcmp(next, s->text) == 0) return false;
+
+    // Lay out both runs and invalidate every cell whose glyph or position differs.
+    const int32_t box_w = box_width(s);
+    int32_t xo = (box_w - text_width(s->atlas, s->text)) / 2;
+    int32_t xn = (box_w - text_width(s->atlas, next)) / 2;
+    const char* po = s->text;
+    const char* pn = next;
+    while (*po || *pn) {
+        const int go = *po ? glyph_index(*po) : -1;
+        const int gn = *pn ? glyph_index(*pn) : -1;
+        if (go != gn || xo != xn) {
+            invalidate_cell(obj, s->atlas, go, xo);
+            invalidate_cell(obj, s->atlas, gn, xn);
+        }
+        if (*po) {
+            if (go >= 0) xo += s->atlas->glyphs[go].adv_w;
+            po++;
+        }
+        if (*pn) {
+            if (gn >= 0) xn += s->atlas->glyphs[gn].adv_w;
+            pn++;
+        }
+    }
+
+    memcpy(s->text, next, sizeof(next));
+    return true;
+}
@@ -0,0 +1,30 @@
+#ifndef DIGIT_LABEL_H
+#define DIGIT_LABEL_H
+
+#include <lvgl.h>
+#include <stddef.h>
+
+// ============================================================================
+// Digit Label
+// ============================================================================
+// Numeric text widget for values that change often (the energy kW readouts).
+//
+// The glyphs "0123456789.-" of a font are rasterized once into a shared A8 atlas
+// (one per font, ~3 KB for Montserrat 24). The widget then draws straight from that
+// atlas in its DRAW_MAIN handler, recolored with the object's text color. A text
+// change does no label layout: it compares the old and new glyph runs and
+// invalidates only the glyph cells that differ (a "1.23" -> "1.24" update redraws
+// one digit). Other characters are not drawn; "--" stays two '-' glyphs.
+//
+// The object has a fixed size of `max_chars` of the widest glyph by the font's
+// line height, so alignment never moves; the text is centered inside. Style it
+// like a label: lv_obj_set_style_text_color() recolors it.
+//
+// LVGL task only (like every LVGL call).
+
+lv_obj_t* digit_label_create(lv_obj_t* parent, const lv_font_t* font, uint8_t max_chars);
+
+// Returns true when the text changed (and the changed cells were invalidated).
+bool digit_label_set_text(lv_obj_t* obj, const char* text);
+
+#endif // DIGIT_LABEL_H
@@ -11,8 +11,10 @@
 
 #include "direct_image_screen.h"
 #include "../display_manager.h"
+#include "../display_driver.h"
 #include "../log_manager.h"
 #include <Arduino.h>
+#include <esp_heap_caps.h>
 
 DirectImageScreen::DirectImageScreen(DisplayManager* mgr) 
     : manager(mgr), screen_obj(nullptr), session_active(false), visible(false) {
@@ -142,6 +144,32 @@ void DirectImageScreen::begin_strip_session(int width, int height) {
     LOGI("DIRIMG", "Strip session ready");
 }
 
+bool DirectImageScreen::begin_region(int x, int y, int w, int h) {
+    if (!visible) {
+        LOGW("DIRIMG", "Region update ignored: no image on screen");
+        return false;
+    }
+
+    // A patch counts as a new upload for the display timeout.
+    display_start_time = millis();
+
+    if (manager) {
+        decoder.setDisplayDriver(manager->getDriver());
+    }
+
+    int lcd_width = DISPLAY_WIDTH;
+    int lcd_height = DISPLAY_HEIGHT;
+    if (manager && manager->getDriver()) {
+        lcd_width = manager->getDriver()->width();
+        lcd_height = manager->getDriver()->height();
+    }
+
+    // Buffers are kept when the region width matches the previous session.
+    decoder.begin(w, h, lcd_width, lcd_height, x, y);
+    session_active = true;
+    return true;
+}
+
 bool DirectImageScreen::decode_strip(const uint8_t* jpeg_data, size_t jpeg_size, int strip_index, bool output_bgr565) {
     if (!session_active) {
         LOGE("DIRIMG", "No active strip session");
@@ -158,6 +186,117 @@ bool DirectImageScreen::decode_strip(const uint8_t* jpeg_data, size_t jpeg_size,
     return success;
 }
 
+bool DirectImageScreen::decode_strip_pair(const uint8_t* first, size_t first_size, const uint8_t* next, size_t next_size,
+                                          bool output_bgr565) {
+    if (!session_active) {
+        LOGE("DIRIMG", "No active strip session");
+        return false;
+    }
+
+    bool success = decoder.decode_strip_pair(first, first_size, next, next_size, output_bgr565);
+
+    if (!success) {
+        LOGE("DIRIMG", "Strip pair decode failed");
+    }
+
+    return success;
+}
+
+bool DirectImageScreen::decode_stream(StripDecoderReadFn read, void* read_ctx, bool output_bgr565) {
+    if (!session_active) {
+        LOGE("DIRIMG", "No active strip session");
+        return false;
+    }
+
+    bool success = decoder.decode_stream(read, read_ctx, output_bgr565);
+
+    if (!success) {
+        LOGE("DIRIMG", "Stream decode failed");
+    }
+
+    return success;
+}
+
+bool DirectImageScreen::push_rgb565_strip(uint16_t* pixels, int rows, bool output_bgr565) {
+    if (!session_active) {
+        LOGE("DIRIMG", "No active strip session");
+        return false;
+    }
+
+    bool success = decoder.push_rgb565(pixels, rows, output_bgr565);
+
+    if (!success) {
+        LOGE("DIRIMG", "RGB565 strip push failed");
+    }
+
+    return success;
+}
+
+bool DirectImageScreen::blit_rgb565(uint16_t* pixels, int w, int h, int first_row, int rows) {
+    DisplayDriver* drv = manager ? manager->getDriver() : nullptr;
+    if (!drv || !pixels || w <= 0 || h <= 0) return false;
+
+    const int lcd_w = drv->width();
+    const int lcd_h = drv->height();
+
+    // Center on the panel; crop whatever does not fit (contain-fit decodes may overshoot).
+    const int src_x = w > lcd_w ? (w - lcd_w) / 2 : 0;
+    const int src_y = h > lcd_h ? (h - lcd_h) / 2 : 0;
+    const int dst_x = w < lcd_w ? (lcd_w - w) / 2 : 0;
+    const int dst_y = h < lcd_h ? (lcd_h - h) / 2 : 0;
+    const int copy_w = w < lcd_w ? w : lcd_w;
+    const int copy_h = h < lcd_h ? h : lcd_h;
+
+    // Rows are counted in the visible (cropped) window.
+    if (first_row < 0) first_row = 0;
+    if (first_row + rows > copy_h) rows = copy_h - first_row;
+    if (rows <= 0) return true;
+
+    // Same byte order as the LVGL flush path: frame pixels use lv_color_t layout.
+    static constexpr bool kSwapBytes = (LV_COLOR_16_SWAP == 0);
+
+    drv->startWrite();
+    if (copy_w == w) {
+        // Rows are contiguous in the source: one window, one transfer.
+        drv->setAddrWindow(dst_x, dst_y + first_row, copy_w, rows);
+        drv->pushColors(pixels + (size_t)(src_y + first_row) * w + src_x, (uint32_t)copy_w * rows, kSwapBytes);
+    } else {
+        for (int r = 0; r < rows; r++) {
+            const int y = first_row + r;
+            drv->setAddrWindow(dst_x, dst_y + y, copy_w, 1);
+            drv->pushColors(pixels + (size_t)(src_y + y) * w + src_x, (uint32_t)copy_w, kSwapBytes);
+        }
+    }
+    drv->endWrite();
+
+    if (drv->renderMode() == DisplayDriver::RenderMode::Buffered) {
+        drv->present();
+    }
+    return true;
+}
+
+void DirectImageScreen::clear_panel() {
+    DisplayDriver* drv = manager ? manager->getDriver() : nullptr;
+    if (!drv) return;
+
+    const int lcd_w = drv->width();
+    const int lcd_h = drv->height();
+    uint16_t* row = (uint16_t*)heap_caps_calloc((size_t)lcd_w, sizeof(uint16_t), MALLOC_CAP_INTERNAL | MALLOC_CAP_8BIT);
+    if (!row) return;
+
+    drv->startWrite();
+    for (int y = 0; y < lcd_h; y++) {
+        drv->setAddrWindow(0, y, lcd_w, 1);
+        drv->pushColors(row, (uint32_t)lcd_w, false);
+    }
+    drv->endWrite();
+    heap_caps_free(row);
+
+    if (drv->renderMode() == DisplayDriver::RenderMode::Buffered) {
+        drv->present();
+    }
+}
+
 void DirectImageScreen::end_strip_session() {
     if (!session_active) return;
     
@@ -30,6 +30,12 @@ public:
     void create() override;
     void destroy() override;
     void update() override;
+
+    // LVGL flushes are gated while the decoder owns the panel.
+    uint32_t refreshPeriodMs() const override { return 500; }
+
+    // The blank tree is tiny, and destroy() would end an active session.
+    ScreenRetention retention() const override { return ScreenRetention::Pinned; }
     void show() override;
     void hide() override;
     
@@ -38,9 +44,34 @@ public:
     // height: image height in pixels
     void begin_strip_session(int width, int height);
     
+    // Retarget the decoder at an (x, y, w, h) panel region of the image on screen,
+    // so the next decode_strip()/push_rgb565_strip() patches just that region.
+    // Returns false when no image is visible (nothing to patch).
+    bool begin_region(int x, int y, int w, int h);
+    
     // Decode and display a single strip
     // Returns: true on success, false on failure
     bool decode_strip(const uint8_t* jpeg_data, size_t jpeg_size, int strip_index, bool output_bgr565 = true);
+
+    // Decode two consecutive strips, the second on the other core (see StripDecoder::decode_strip_pair)
+    bool decode_strip_pair(const uint8_t* first, size_t first_size, const uint8_t* next, size_t next_size,
+                           bool output_bgr565 = true);
+
+    // Decode a whole JPEG pulled from a stream (see StripDecoder::decode_stream)
+    bool decode_stream(StripDecoderReadFn read, void* read_ctx, bool output_bgr565 = true);
+    
+    // Push pre-rendered RGB565 rows (wire order) at the strip session's current Y
+    // (see StripDecoder::push_rgb565). `pixels` is modified in place.
+    bool push_rgb565_strip(uint16_t* pixels, int rows, bool output_bgr565 = true);
+    
+    // Push rows [first_row, first_row + rows) of a pre-decoded w x h frame in lv_color_t
+    // layout (e.g. from lvgl_jpeg_decode_to_rgb565), centered and cropped to the panel.
+    // Caller holds the display lock. Used by the slideshow for instant, decode-free swaps.
+    bool blit_rgb565(uint16_t* pixels, int w, int h, int first_row, int rows);
+    
+    // Paint the whole panel black (caller holds the display lock). Used before frames
+    // smaller than the panel so no stale pixels remain around them.
+    void clear_panel();
     
     // End strip upload session
     void end_strip_session();
@@ -54,6 +85,8 @@ public:
     // Check if timeout expired
     bool is_timeout_expired();
     
+    bool is_visible() const { return visible; }
+    
     // Get strip decoder for progress tracking
     StripDecoder* get_decoder() { return &decoder; }
     
@@ -0,0 +1,102 @@
+#ifndef ENERGY_LAYOUT_H
+#define ENERGY_LAYOUT_H
+
+#include "../board_profile.h"
+#include <stdint.h>
+
+// ============================================================================
+// Energy Layout
+// ============================================================================
+// Widget geometry of EnergyMonitorScreen, resolved at compile time from the board
+// profile instead of being recomputed in create() and update().
+//
+// The spec is the 320x240 reference layout (three columns: icon, kW value, unit,
+// vertical bar). Taller panels push the block down by a quarter of the spare
+// height and give half of it to the bars; round panels first shrink the content
+// box to 3/4 of the width and inset it by 1/8 of the height so every column stays
+// inside the circle. At 240 px of usable height the result is the reference
+// layout unchanged. With ENERGY_SPARKLINE the bars give up the room for a
+// sparkline strip below them.
+//
+// Both orientations of the panel are resolved, because a driver may rotate in
+// LVGL (logical size swapped) or in hardware (logical size = DISPLAY_WIDTH x
+// DISPLAY_HEIGHT); energy_layout_for_hor_res() picks one with a single compare.
+//
+// Bars are anchored bottom-mid inside a fixed background, so an update is one
+// lv_obj_set_height() on the fill: no resize of the frame, no realignment.
+
+struct EnergyLayout {
+    int16_t col_dx;     // column centre offset from the screen centre
+    int16_t arrow_dx;   // flow arrows sit between two columns
+    int16_t icon_y;
+    int16_t arrow_y;
+    int16_t value_y;
+    int16_t unit_y;
+    int16_t bar_y;
+    int16_t bar_w;
+    int16_t bar_h;      // full-scale fill height
+    int16_t spark_y;    // ENERGY_SPARKLINE strip (0 height when disabled)
+    int16_t spark_w;
+    int16_t spark_h;
+    int16_t halo_w;     // ENERGY_ALARM_HALO_MODE column backdrop
+    int16_t halo_y;
+    int16_t halo_h;
+    int16_t halo_radius;
+};
+
+constexpr int16_t kEnergyLayoutRefHeight = 240;
+constexpr int16_t kEnergyLayoutMinBarHeight = 16;
+constexpr int16_t kEnergyLayoutSparkHeight = 20;
+constexpr int16_t kEnergyLayoutSparkGap = 6;
+
+constexpr EnergyLayout energy_layout_for(int32_t w, int32_t h, bool round, bool sparkline) {
+    const int32_t content_w = round ? (w * 3) / 4 : w;
+    const int32_t inset_y = round ? h / 8 : 0;
+    const int32_t avail_h = h - 2 * inset_y;
+    const int32_t spare = avail_h - kEnergyLayoutRefHeight;
+
+    const int32_t top = inset_y + (spare > 0 ? spare / 4 : 0);
+    const int32_t spark_h = sparkline ? kEnergyLayoutSparkHeight : 0;
+    int32_t bar_h = 100 + (spare > 0 ? spare / 2 : spare) - (sparkline ? spark_h + kEnergyLayoutSparkGap : 0);
+    if (bar_h < kEnergyLayoutMinBarHeight) bar_h = kEnergyLayoutMinBarHeight;
+
+    const int32_t col_dx = content_w / 3;
+    const int32_t value_y = top + 80;
+    const int32_t bar_y = top + 140;
+    const int32_t spark_y = sparkline ? bar_y + bar_h + kEnergyLayoutSparkGap : bar_y + bar_h;
+    const int32_t halo_y = value_y - 10;
+
+    return EnergyLayout{
+        /* col_dx */ (int16_t)col_dx,
+        /* arrow_dx */ (int16_t)(col_dx / 2),
+        /* icon_y */ (int16_t)(top + 15),
+        /* arrow_y */ (int16_t)(top + 25),
+        /* value_y */ (int16_t)value_y,
+        /* unit_y */ (int16_t)(top + 115),
+        /* bar_y */ (int16_t)bar_y,
+        /* bar_w */ 12,
+        /* bar_h */ (int16_t)bar_h,
+        /* spark_y */ (int16_t)spark_y,
+        /* spark_w */ (int16_t)(sparkline ? col_dx - 16 : 0),
+        /* spark_h */ (int16_t)spark_h,
+        /* halo_w */ (int16_t)(col_dx - 12),
+        /* halo_y */ (int16_t)halo_y,
+        /* halo_h */ (int16_t)(spark_y + spark_h + 6 - halo_y),
+        /* halo_radius */ 12,
+    };
+}
+
+// Panel in its native orientation, and with width/height swapped.
+inline constexpr EnergyLayout kEnergyLayout =
+    energy_layout_for(kBoardProfile.panel_width, kBoardProfile.panel_height, kBoardProfile.panel_round, ENERGY_SPARKLINE);
+inline constexpr EnergyLayout kEnergyLayoutRotated =
+    energy_layout_for(kBoardProfile.panel_height, kBoardProfile.panel_width, kBoardProfile.panel_round, ENERGY_SPARKLINE);
+
+static_assert(!kBoardProfile.has_display || kEnergyLayout.halo_w > 0,
+              "Energy layout: panel too narrow for three columns");
+
+inline const EnergyLayout& energy_layout_for_hor_res(int32_t hor_res) {
+    return (hor_res == (int32_t)kBoardProfile.panel_width) ? kEnergyLayout : kEnergyLayoutRotated;
+}
+
+#endif // ENERGY_LAYOUT_H
@@ -1,42 +1,31 @@
 #include "energy_monitor_screen.h"
 
 #include "log_manager.h"
-#include "../energy_monitor.h"
+#include "../energy_thresholds.h"
+#include "../energy_alarm.h"
+#include "../energy_latency.h"
+#include "../energy_history.h"
 #include "../board_config.h"
 #include "../png_assets.h"
+#include "digit_label.h"
+#include "sparkline.h"
 
 #include <math.h>
+#include <string.h>
 
-static int32_t kw_to_mkw_round(float kw) {
-    const float scaled = kw * 1000.0f;
-    return (int32_t)(scaled >= 0.0f ? (scaled + 0.5f) : (scaled - 0.5f));
-}
-
-static bool is_triggered_t2(const EnergyCategoryColorConfig* cfg, float kw, bool use_abs) {
-    if (!cfg) return false;
-    if (isnan(kw)) return false;
-
-    const float v_kw = use_abs ? fabsf(kw) : kw;
-    const int32_t mkw = kw_to_mkw_round(v_kw);
-    return mkw >= cfg->threshold_mkw[2];
-}
-
-static bool is_cleared_t2(const EnergyCategoryColorConfig* cfg, float kw, bool use_abs, int32_t clear_hysteresis_mkw) {
-    if (!cfg) return true;
-    if (isnan(kw)) return true;
+// Hard-coded contrast policy:
+// If intended is too close to the pulsing background near its peak, blend toward white.
+static constexpr uint8_t kRemapStart = 160;       // start remapping after ~63% into the pulse
+static constexpr uint8_t kRemapLowContrast = 170; // smaller => more aggressive remap
 
-    const float v_kw = use_abs ? fabsf(kw) : kw;
-    const int32_t mkw = kw_to_mkw_round(v_kw);
-    int32_t clear_threshold = cfg->threshold_mkw[2] - clear_hysteresis_mkw;
-    if (use_abs && clear_threshold < 0) clear_threshold = 0;
-    return mkw < clear_threshold;
-}
+// kW readouts are clamped to +/-kKwDisplayMax so "%.2f" never needs more than
+// kKwMaxChars ("-999.99"); the digit widget has a fixed width and drops the rest.
+static constexpr float kKwDisplayMax = 999.99f;
+static constexpr uint8_t kKwMaxChars = 7;
 
 static lv_color_t contrast_remap_for_bg(lv_color_t intended, lv_color_t bg, uint8_t bg_strength_255) {
-    // Hard-coded contrast policy:
-    // If intended is too close to the pulsing background near its peak, blend toward white.
-    const uint8_t kStart = 160;          // start remapping after ~63% into the pulse
-    const uint8_t kLowContrast = 170;    // smaller => more aggressive remap
+    const uint8_t kStart = kRemapStart;
+    const uint8_t kLowContrast = kRemapLowContrast;
 
     if (bg_strength_255 <= kStart) return intended;
 
@@ -61,8 +50,56 @@ static lv_color_t contrast_remap_for_bg(lv_color_t intended, lv_color_t bg, uint
     return lv_color_mix(lv_color_white(), intended, mix);
 }
 
+// Alarm foreground for `intended` at background strength `mix`. The remap only
+// depends on (intended, peak, mix), so the strengths above kRemapStart are
+// computed once per color pair and ticks become a table lookup.
+lv_color_t EnergyMonitorScreen::remappedColor(RemapTable& table, lv_color_t intended, uint8_t mix) {
+    static_assert(kRemapTableLen == 255 - kRemapStart, "remap table must cover strengths above kRemapStart");
+    if (mix <= kRemapStart) return intended;
+
+    if (!table.valid || table.intended.full != intended.full || table.peak.full != alarmPeakColor.full) {
+        for (uint16_t m = kRemapStart + 1; m <= 255; m++) {
+            const lv_color_t bg = lv_color_mix(alarmPeakColor, lv_color_black(), (uint8_t)m);
+            table.color[m - kRemapStart - 1] = contrast_remap_for_bg(intended, bg, (uint8_t)m);
+        }
+        table.intended = intended;
+        table.peak = alarmPeakColor;
+        table.valid = true;
+    }
+    return table.color[mix - kRemapStart - 1];
+}
+
+// Column color for a staleness tier: aging keeps 60% of the brightness, stale 35%.
+static lv_color_t staleness_color(lv_color_t color, EnergyStaleness tier) {
+    switch (tier) {
+        case EnergyStaleness::Aging: return lv_color_mix(color, lv_color_black(), 153);
+        case EnergyStaleness::Stale: return lv_color_mix(color, lv_color_black(), 90);
+        default: return color;
+    }
+}
+
+static void set_stale_unit(lv_obj_t* unit, EnergyStaleness was, EnergyStaleness now) {
+    if (!unit || (was == EnergyStaleness::Stale) == (now == EnergyStaleness::Stale)) return;
+    lv_label_set_text(unit, (now == EnergyStaleness::Stale) ? "kW " LV_SYMBOL_WARNING : "kW");
+}
+
+// kW readout showing "--" until the first value: a digit-atlas widget, or a plain label.
+static lv_obj_t* create_kw_value(lv_obj_t* parent) {
+    #if ENERGY_DIGIT_ATLAS
+    lv_obj_t* value = digit_label_create(parent, &lv_font_montserrat_24, kKwMaxChars);
+    digit_label_set_text(value, "--");
+    #else
+    lv_obj_t* value = lv_label_create(parent);
+    lv_label_set_text(value, "--");
+    lv_obj_set_style_text_font(value, &lv_font_montserrat_24, 0);
+    #endif
+    return value;
+}
+
 EnergyMonitorScreen::EnergyMonitorScreen(DeviceConfig* deviceConfig, DisplayManager* manager)
-    : config(deviceConfig), displayMgr(manager) {}
+    : config(deviceConfig), displayMgr(manager) {
+    resetRenderCache();
+}
 
 EnergyMonitorScreen::~EnergyMonitorScreen() {
     destroy();
@@ -83,90 +120,106 @@ void EnergyMonitorScreen::create() {
     lv_obj_set_style_bg_color(background, lv_color_black(), 0);
     lv_obj_clear_flag(background, LV_OBJ_FLAG_SCROLLABLE);
 
-    const int32_t col_dx = (int32_t)(LV_HOR_RES / 3);
-    const int32_t arrow_dx = col_dx / 2;
+    layout = &energy_layout_for_hor_res(LV_HOR_RES);
+    const EnergyLayout& L = *layout;
+    const int32_t col_dx = L.col_dx;
+
+    // Alarm halos (created first so they sit behind the value/unit/bar widgets).
+    #if ENERGY_ALARM_HALO_MODE
+    auto init_halo = [&](int32_t x_off) -> lv_obj_t* {
+        lv_obj_t* halo = lv_obj_create(background);
+        lv_obj_set_size(halo, L.halo_w, L.halo_h);
+        lv_obj_align(halo, LV_ALIGN_TOP_MID, x_off, L.halo_y);
+        lv_obj_set_style_pad_all(halo, 0, 0);
+        lv_obj_set_style_border_width(halo, 0, 0);
+        lv_obj_set_style_radius(halo, L.halo_radius, 0);
+        lv_obj_set_style_bg_color(halo, lv_color_black(), 0);
+        lv_obj_set_style_bg_opa(halo, LV_OPA_COVER, 0);
+        lv_obj_clear_flag(halo, LV_OBJ_FLAG_SCROLLABLE);
+        lv_obj_clear_flag(halo, LV_OBJ_FLAG_CLICKABLE);
+        lv_obj_add_flag(halo, LV_OBJ_FLAG_HIDDEN);
+        return halo;
+    };
+
+    solar_halo = init_halo(-col_dx);
+    home_halo = init_halo(0);
+    grid_halo = init_halo(col_dx);
+    #endif
 
     // Icons row
         solar_icon = lv_img_create(background);
         lv_img_set_src(solar_icon, &img_sun);
         lv_obj_set_style_img_recolor(solar_icon, lv_color_white(), 0);
         lv_obj_set_style_img_recolor_opa(solar_icon, LV_OPA_COVER, 0);
-        lv_obj_align(solar_icon, LV_ALIGN_TOP_MID, -col_dx, 15);
+        lv_obj_align(solar_icon, LV_ALIGN_TOP_MID, -col_dx, L.icon_y);
 
     arrow1 = lv_label_create(background);
     lv_label_set_text(arrow1, LV_SYMBOL_RIGHT);
     lv_obj_set_style_text_font(arrow1, &lv_font_montserrat_24, 0);
     lv_obj_set_style_text_color(arrow1, lv_color_white(), 0);
-    lv_obj_align(arrow1, LV_ALIGN_TOP_MID, -arrow_dx, 25);
+    lv_obj_align(arrow1, LV_ALIGN_TOP_MID, -L.arrow_dx, L.arrow_y);
     lv_obj_add_flag(arrow1, LV_OBJ_FLAG_HIDDEN);
 
         home_icon = lv_img_create(background);
         lv_img_set_src(home_icon, &img_home);
         lv_obj_set_style_img_recolor(home_icon, lv_color_white(), 0);
         lv_obj_set_style_img_recolor_opa(home_icon, LV_OPA_COVER, 0);
-        lv_obj_align(home_icon, LV_ALIGN_TOP_MID, 0, 15);
+        lv_obj_align(home_icon, LV_ALIGN_TOP_MID, 0, L.icon_y);
 
     arrow2 = lv_label_create(background);
     lv_label_set_text(arrow2, LV_SYMBOL_RIGHT);
     lv_obj_set_style_text_font(arrow2, &lv_font_montserrat_24, 0);
     lv_obj_set_style_text_color(arrow2, lv_color_white(), 0);
-    lv_obj_align(arrow2, LV_ALIGN_TOP_MID, arrow_dx, 25);
+    lv_obj_align(arrow2, LV_ALIGN_TOP_MID, L.arrow_dx, L.arrow_y);
     lv_obj_add_flag(arrow2, LV_OBJ_FLAG_HIDDEN);
 
         grid_icon = lv_img_create(background);
         lv_img_set_src(grid_icon, &img_grid);
         lv_obj_set_style_img_recolor(grid_icon, lv_color_white(), 0);
         lv_obj_set_style_img_recolor_opa(grid_icon, LV_OPA_COVER, 0);
-        lv_obj_align(grid_icon, LV_ALIGN_TOP_MID, col_dx, 15);
+        lv_obj_align(grid_icon, LV_ALIGN_TOP_MID, col_dx, L.icon_y);
 
     // Values row
-    solar_value = lv_label_create(background);
-    lv_label_set_text(solar_value, "--");
-    lv_obj_set_style_text_font(solar_value, &lv_font_montserrat_24, 0);
+    solar_value = create_kw_value(background);
     lv_obj_set_style_text_color(solar_value, lv_color_white(), 0);
-    lv_obj_align(solar_value, LV_ALIGN_TOP_MID, -col_dx, 80);
+    lv_obj_align(solar_value, LV_ALIGN_TOP_MID, -col_dx, L.value_y);
 
-    home_value = lv_label_create(background);
-    lv_label_set_text(home_value, "--");
-    lv_obj_set_style_text_font(home_value, &lv_font_montserrat_24, 0);
+    home_value = create_kw_value(background);
     lv_obj_set_style_text_color(home_value, lv_color_white(), 0);
-    lv_obj_align(home_value, LV_ALIGN_TOP_MID, 0, 80);
+    lv_obj_align(home_value, LV_ALIGN_TOP_MID, 0, L.value_y);
 
-    grid_value = lv_label_create(background);
-    lv_label_set_text(grid_value, "--");
-    lv_obj_set_style_text_font(grid_value, &lv_font_montserrat_24, 0);
+    grid_value = create_kw_value(background);
     lv_obj_set_style_text_color(grid_value, lv_color_white(), 0);
-    lv_obj_align(grid_value, LV_ALIGN_TOP_MID, col_dx, 80);
+    lv_obj_align(grid_value, LV_ALIGN_TOP_MID, col_dx, L.value_y);
 
     // Units row
     solar_unit = lv_label_create(background);
     lv_label_set_text(solar_unit, "kW");
     lv_obj_set_style_text_font(solar_unit, &lv_font_montserrat_14, 0);
     lv_obj_set_style_text_color(solar_unit, lv_color_white(), 0);
-    lv_obj_align(solar_unit, LV_ALIGN_TOP_MID, -col_dx, 115);
+    lv_obj_align(solar_unit, LV_ALIGN_TOP_MID, -col_dx, L.unit_y);
 
     home_unit = lv_label_create(background);
     lv_label_set_text(home_unit, "kW");
     lv_obj_set_style_text_font(home_unit, &lv_font_montserrat_14, 0);
     lv_obj_set_style_text_color(home_unit, lv_color_white(), 0);
-    lv_obj_align(home_unit, LV_ALIGN_TOP_MID, 0, 115);
+    lv_obj_align(home_unit, LV_ALIGN_TOP_MID, 0, L.unit_y);
 
     grid_unit = lv_label_create(background);
     lv_label_set_text(grid_unit, "kW");
     lv_obj_set_style_text_font(grid_unit, &lv_font_montserrat_14, 0);
     lv_obj_set_style_text_color(grid_unit, lv_color_white(), 0);
-    lv_obj_align(grid_unit, LV_ALIGN_TOP_MID, col_dx, 115);
+    lv_obj_align(grid_unit, LV_ALIGN_TOP_MID, col_dx, L.unit_y);
 
-    // Bar charts (manual: bg + fill) - LV_USE_BAR is disabled in lv_conf.h
-    const int32_t bar_width = 12;
-    const int32_t bar_height = 100;
-    const int32_t bar_y = 140;
+    // Bar charts (manual: bg + fill) - LV_USE_BAR is disabled in lv_conf.h.
+    // The fill is aligned bottom-mid once here; LVGL keeps the alignment when its
+    // height changes, so update() only sets the height.
     const lv_color_t bar_bg_color = lv_color_make(0x33, 0x33, 0x33);
 
     auto init_bar = [&](lv_obj_t** bg_out, lv_obj_t** fill_out, int32_t x_off) {
         lv_obj_t* bg = lv_obj_create(background);
-        lv_obj_set_size(bg, bar_width, bar_height);
-        lv_obj_align(bg, LV_ALIGN_TOP_MID, x_off, bar_y);
+        lv_obj_set_size(bg, L.bar_w, L.bar_h);
+        lv_obj_align(bg, LV_ALIGN_TOP_MID, x_off, L.bar_y);
         lv_obj_set_style_pad_all(bg, 0, 0);
         lv_obj_set_style_border_width(bg, 0, 0);
         lv_obj_set_style_radius(bg, 0, 0);
@@ -175,7 +228,7 @@ void EnergyMonitorScreen::create() {
         lv_obj_clear_flag(bg, LV_OBJ_FLAG_SCROLLABLE);
 
         lv_obj_t* fill = lv_obj_create(bg);
-        lv_obj_set_size(fill, bar_width, 0);
+        lv_obj_set_size(fill, L.bar_w, 0);
         lv_obj_align(fill, LV_ALIGN_BOTTOM_MID, 0, 0);
         lv_obj_set_style_pad_all(fill, 0, 0);
         lv_obj_set_style_border_width(fill, 0, 0);
@@ -192,12 +245,59 @@ void EnergyMonitorScreen::create() {
     init_bar(&home_bar_bg, &home_bar_fill, 0);
     init_bar(&grid_bar_bg, &grid_bar_fill, col_dx);
 
+    // Trend strips below the bars; filled from the history already recorded.
+    #if ENERGY_SPARKLINE
+    auto init_spark = [&](int32_t x_off) -> lv_obj_t* {
+        lv_obj_t* spark = sparkline_create(background, L.spark_w, L.spark_h, 10);  // >= 0.1 kW full scale
+        lv_obj_set_style_text_color(spark, lv_color_white(), 0);
+        lv_obj_align(spark, LV_ALIGN_TOP_MID, x_off, L.spark_y);
+        return spark;
+    };
+
+    solar_spark = init_spark(-col_dx);
+    home_spark = init_spark(0);
+    grid_spark = init_spark(col_dx);
+    sparkHistoryTotal = 0;
+    updateSparklines();
+    #endif
+
     // Timer drives the alarm animation (background + contrast remap).
     // Start paused; it will be resumed when a T2 breach is detected.
     if (!alarmTimer) {
-        alarmTimer = lv_timer_create(EnergyMonitorScreen::alarmTimerCb, 40 /*ms*/, this);
+        alarmTimer = lv_timer_create(EnergyMonitorScreen::alarmTimerCb, kAlarmStepMs, this);
         lv_timer_pause(alarmTimer);
     }
+
+    // Staleness tiers; the first run (right away) also picks up values restored at boot.
+    solarStale = EnergyStaleness::Fresh;
+    homeStale = EnergyStaleness::Fresh;
+    gridStale = EnergyStaleness::Fresh;
+    if (!staleTimer) {
+        staleTimer = lv_timer_create(EnergyMonitorScreen::staleTimerCb, kStaleCheckMs, this);
+        lv_timer_ready(staleTimer);
+    }
+
+    // Widgets were just created with their initial text/colors.
+    resetRenderCache();
+    strcpy(solarCache.text, "--");
+    strcpy(homeCache.text, "--");
+    strcpy(gridCache.text, "--");
+}
+
+void EnergyMonitorScreen::resetRenderCache() {
+    CategoryRenderCache* caches[] = {&solarCache, &homeCache, &gridCache};
+    for (CategoryRenderCache* c : caches) {
+        c->text[0] = '\0';
+        c->barHeightPx = -1;
+        c->color = lv_color_white();
+        c->colorValid = false;
+        c->haloColor = lv_color_black();
+        c->haloState = -1;
+    }
+    appliedBgColor = lv_color_black();
+    bgColorValid = false;
+    arrow1State = -1;
+    arrow2State = -1;
 }
 
 void EnergyMonitorScreen::destroy() {
@@ -206,11 +306,14 @@ void EnergyMonitorScreen::destroy() {
             lv_timer_del(alarmTimer);
             alarmTimer = nullptr;
         }
+        if (staleTimer) {
+            lv_timer_del(staleTimer);
+            staleTimer = nullptr;
+        }
         alarmState = AlarmState::Off;
         alarmPhase = 0;
         alarmDir = 1;
         alarmPeakColor = lv_color_make(255, 0, 0);
-        alarmClearStartMs = 0;
 
         lv_obj_del(screen);
         screen = nullptr;
@@ -233,6 +336,15 @@ void EnergyMonitorScreen::destroy() {
         home_bar_fill = nullptr;
         grid_bar_bg = nullptr;
         grid_bar_fill = nullptr;
+        solar_spark = nullptr;
+        home_spark = nullptr;
+        grid_spark = nullptr;
+        sparkHistoryTotal = 0;
+        solar_halo = nullptr;
+        home_halo = nullptr;
+        grid_halo = nullptr;
+
+        resetRenderCache();
     }
 }
 
@@ -255,7 +367,7 @@ void EnergyMonitorScreen::alarmTick() {
     if (!screen || !background) return;
     if (alarmState == AlarmState::Off) return;
 
-    const uint32_t tick_ms = alarmTimer ? alarmTimer->period : 40;
+    const uint32_t tick_ms = alarmTimer ? alarmTimer->period : kAlarmStepMs;
     uint16_t cycle_ms = config ? config->energy_alarm_pulse_cycle_ms : 2000;
     if (cycle_ms < 200) cycle_ms = 200;
     if (cycle_ms > 10000) cycle_ms = 10000;
@@ -281,8 +393,7 @@ void EnergyMonitorScreen::alarmTick() {
             alarmState = AlarmState::Off;
             alarmPhase = 0;
             alarmPeakColor = lv_color_make(255, 0, 0);
-            alarmClearStartMs = 0;
-            if (alarmTimer) lv_timer_pause(alarmTimer);
+                if (alarmTimer) lv_timer_pause(alarmTimer);
             applyNormalStyles();
             return;
         }
@@ -293,32 +404,95 @@ void EnergyMonitorScreen::alarmTick() {
     applyAlarmStyles();
 }
 
+void EnergyMonitorScreen::staleTimerCb(lv_timer_t* t) {
+    EnergyMonitorScreen* self = (EnergyMonitorScreen*)t->user_data;
+    if (self) self->staleTick();
+}
+
+void EnergyMonitorScreen::staleTick() {
+    if (!screen) return;
+
+    const EnergyMonitorState st = energy_monitor_get_state();
+    const uint32_t now = millis();
+    const EnergyStaleness solar = energy_monitor_staleness(st, ENERGY_CHANNEL_SOLAR, now);
+    const EnergyStaleness grid = energy_monitor_staleness(st, ENERGY_CHANNEL_GRID, now);
+    const EnergyStaleness home = (solar > grid) ? solar : grid;
+    if (solar == solarStale && home == homeStale && grid == gridStale) return;
+
+    set_stale_unit(solar_unit, solarStale, solar);
+    set_stale_unit(home_unit, homeStale, home);
+    set_stale_unit(grid_unit, gridStale, grid);
+    solarStale = solar;
+    homeStale = home;
+    gridStale = grid;
+
+    if (alarmState == AlarmState::Off) {
+        applyNormalStyles();
+    } else {
+        applyAlarmStyles();
+    }
+}
+
+void EnergyMonitorScreen::applyBackgroundColor(lv_color_t color) {
+    if (!background) return;
+    if (bgColorValid && appliedBgColor.full == color.full) return;
+    lv_obj_set_style_bg_color(background, color, 0);
+    appliedBgColor = color;
+    bgColorValid = true;
+}
+
+void EnergyMonitorScreen::applyCategoryColor(CategoryRenderCache& cache, lv_color_t color,
+                                             lv_obj_t* icon, lv_obj_t* value, lv_obj_t* unit,
+                                             lv_obj_t* barFill, lv_obj_t* spark, lv_obj_t* arrow) {
+    if (cache.colorValid && cache.color.full == color.full) return;
+
+    if (icon) lv_obj_set_style_img_recolor(icon, color, 0);
+    if (value) lv_obj_set_style_text_color(value, color, 0);
+    if (unit) lv_obj_set_style_text_color(unit, color, 0);
+    if (barFill) lv_obj_set_style_bg_color(barFill, color, 0);
+    if (spark) lv_obj_set_style_text_color(spark, color, 0);
+    if (arrow) lv_obj_set_style_text_color(arrow, color, 0);
+
+    cache.color = color;
+    cache.colorValid = true;
+}
+
+void EnergyMonitorScreen::applyHalo(CategoryRenderCache& cache, lv_obj_t* halo, bool show, lv_color_t color) {
+    if (!halo) return;
+
+    const int8_t want = show ? 1 : 0;
+    if (want != cache.haloState) {
+        if (show) {
+            lv_obj_clear_flag(halo, LV_OBJ_FLAG_HIDDEN);
+        } else {
+            lv_obj_add_flag(halo, LV_OBJ_FLAG_HIDDEN);
+        }
+        cache.haloState = want;
+    }
+
+    if (show && cache.haloColor.full != color.full) {
+        lv_obj_set_style_bg_color(halo, color, 0);
+        cache.haloColor = color;
+    }
+}
+
 void EnergyMonitorScreen::applyNormalStyles() {
     if (!screen || !background) return;
 
     // Normal background
-    lv_obj_set_style_bg_color(background, lv_color_black(), 0);
-
-    // Apply cached intended colors.
-    if (solar_icon) lv_obj_set_style_img_recolor(solar_icon, intendedSolarColor, 0);
-    if (home_icon) lv_obj_set_style_img_recolor(home_icon, intendedHomeColor, 0);
-    if (grid_icon) lv_obj_set_style_img_recolor(grid_icon, intendedGridColor, 0);
-
-    if (solar_value) lv_obj_set_style_text_color(solar_value, intendedSolarColor, 0);
-    if (home_value) lv_obj_set_style_text_color(home_value, intendedHomeColor, 0);
-    if (grid_value) lv_obj_set_style_text_color(grid_value, intendedGridColor, 0);
-    if (solar_unit) lv_obj_set_style_text_color(solar_unit, intendedSolarColor, 0);
-    if (home_unit) lv_obj_set_style_text_color(home_unit, intendedHomeColor, 0);
-    if (grid_unit) lv_obj_set_style_text_color(grid_unit, intendedGridColor, 0);
-
-    if (solar_bar_fill) lv_obj_set_style_bg_color(solar_bar_fill, intendedSolarColor, 0);
-    if (home_bar_fill) lv_obj_set_style_bg_color(home_bar_fill, intendedHomeColor, 0);
-    if (grid_bar_fill) lv_obj_set_style_bg_color(grid_bar_fill, intendedGridColor, 0);
-
-    // Arrows are colored in update() based on direction; keep their current glyph logic,
-    // but ensure their colors follow the same intended palette.
-    if (arrow1) lv_obj_set_style_text_color(arrow1, intendedSolarColor, 0);
-    if (arrow2) lv_obj_set_style_text_color(arrow2, intendedGridColor, 0);
+    applyBackgroundColor(lv_color_black());
+    applyHalo(solarCache, solar_halo, false, lv_color_black());
+    applyHalo(homeCache, home_halo, false, lv_color_black());
+    applyHalo(gridCache, grid_halo, false, lv_color_black());
+
+    // Apply cached intended colors. Arrows follow the palette of the flow they
+    // represent (solar->home, home<->grid); visibility/direction is set in update().
+    applyCategoryColor(solarCache, staleness_color(intendedSolarColor, solarStale),
+                       solar_icon, solar_value, solar_unit, solar_bar_fill, solar_spark, arrow1);
+    applyCategoryColor(homeCache, staleness_color(intendedHomeColor, homeStale),
+                       home_icon, home_value, home_unit, home_bar_fill, home_spark, nullptr);
+    applyCategoryColor(gridCache, staleness_color(intendedGridColor, gridStale),
+                       grid_icon, grid_value, grid_unit, grid_bar_fill, grid_spark, arrow2);
 }
 
 void EnergyMonitorScreen::applyAlarmStyles() {
@@ -329,56 +503,59 @@ void EnergyMonitorScreen::applyAlarmStyles() {
     const uint16_t scaledMix16 = (uint16_t)alarmPhase * (uint16_t)peak_pct / 100u;
     const uint8_t mix = (scaledMix16 > 255u) ? 255u : (uint8_t)scaledMix16;
 
-    // Background: dark -> peak color -> dark.
+    // Background: dark -> peak color -> dark. In halo mode only the columns of the
+    // alarming categories pulse; the screen background stays black.
     const lv_color_t bg = lv_color_mix(alarmPeakColor, lv_color_black(), mix);
-    lv_obj_set_style_bg_color(background, bg, 0);
+    #if ENERGY_ALARM_HALO_MODE
+    // While exiting, keep fading the halos that were lit when the alarm cleared.
+    const bool exiting = (alarmState == AlarmState::Exiting);
+    applyHalo(solarCache, solar_halo, alarmSolar || (exiting && solarCache.haloState == 1), bg);
+    applyHalo(homeCache, home_halo, alarmHome || (exiting && homeCache.haloState == 1), bg);
+    applyHalo(gridCache, grid_halo, alarmGrid || (exiting && gridCache.haloState == 1), bg);
+    #else
+    applyBackgroundColor(bg);
+    #endif
 
     // Remap only the categories that are actually causing the alarm (>= T2).
     // Non-alarm categories keep their intended color even at full-red peak.
-    const lv_color_t solar = alarmSolar ? contrast_remap_for_bg(intendedSolarColor, bg, mix) : intendedSolarColor;
-    const lv_color_t home = alarmHome ? contrast_remap_for_bg(intendedHomeColor, bg, mix) : intendedHomeColor;
-    const lv_color_t grid = alarmGrid ? contrast_remap_for_bg(intendedGridColor, bg, mix) : intendedGridColor;
-
-    if (solar_icon) lv_obj_set_style_img_recolor(solar_icon, solar, 0);
-    if (home_icon) lv_obj_set_style_img_recolor(home_icon, home, 0);
-    if (grid_icon) lv_obj_set_style_img_recolor(grid_icon, grid, 0);
-
-    if (solar_value) lv_obj_set_style_text_color(solar_value, solar, 0);
-    if (home_value) lv_obj_set_style_text_color(home_value, home, 0);
-    if (grid_value) lv_obj_set_style_text_color(grid_value, grid, 0);
-    if (solar_unit) lv_obj_set_style_text_color(solar_unit, solar, 0);
-    if (home_unit) lv_obj_set_style_text_color(home_unit, home, 0);
-    if (grid_unit) lv_obj_set_style_text_color(grid_unit, grid, 0);
-
-    if (solar_bar_fill) lv_obj_set_style_bg_color(solar_bar_fill, solar, 0);
-    if (home_bar_fill) lv_obj_set_style_bg_color(home_bar_fill, home, 0);
-    if (grid_bar_fill) lv_obj_set_style_bg_color(grid_bar_fill, grid, 0);
-
-    if (arrow1) lv_obj_set_style_text_color(arrow1, solar, 0);
-    if (arrow2) lv_obj_set_style_text_color(arrow2, grid, 0);
+    const lv_color_t solar_base = staleness_color(intendedSolarColor, solarStale);
+    const lv_color_t home_base = staleness_color(intendedHomeColor, homeStale);
+    const lv_color_t grid_base = staleness_color(intendedGridColor, gridStale);
+    const lv_color_t solar = alarmSolar ? remappedColor(solarRemap, solar_base, mix) : solar_base;
+    const lv_color_t home = alarmHome ? remappedColor(homeRemap, home_base, mix) : home_base;
+    const lv_color_t grid = alarmGrid ? remappedColor(gridRemap, grid_base, mix) : grid_base;
+
+    applyCategoryColor(solarCache, solar, solar_icon, solar_value, solar_unit, solar_bar_fill, solar_spark, arrow1);
+    applyCategoryColor(homeCache, home, home_icon, home_value, home_unit, home_bar_fill, home_spark, nullptr);
+    applyCategoryColor(gridCache, grid, grid_icon, grid_value, grid_unit, grid_bar_fill, grid_spark, arrow2);
 }
 
-static void set_kw_label(lv_obj_t* label, float kw) {
-    if (!label) return;
+// Returns true when the label text changed (and was pushed to LVGL).
+static bool set_kw_label(lv_obj_t* label, float kw, char* last_text, size_t last_text_len) {
+    if (!label) return false;
 
+    char buf[16];
     if (isnan(kw)) {
-        lv_label_set_text(label, "--");
-        return;
+        strcpy(buf, "--");
+    } else {
+        if (kw > kKwDisplayMax) kw = kKwDisplayMax;
+        if (kw < -kKwDisplayMax) kw = -kKwDisplayMax;
+        snprintf(buf, sizeof(buf), "%.2f", (double)kw);
     }
 
-    char buf[16];
-    snprintf(buf, sizeof(buf), "%.2f", (double)kw);
+    if (strncmp(buf, last_text, last_text_len) == 0) return false;
+
+    #if ENERGY_DIGIT_ATLAS
+    digit_label_set_text(label, buf);  // redraws only the digits that changed
+    #else
     lv_label_set_text(label, buf);
+    #endif
+    strlcpy(last_text, buf, last_text_len);
+    return true;
 }
 
-static void set_kw_bar(lv_obj_t* fill, int32_t bar_width_px, int32_t bar_height_px, float kw, int32_t max_watts) {
-    if (!fill) return;
-
-    if (isnan(kw)) {
-        lv_obj_set_size(fill, bar_width_px, 0);
-        lv_obj_align(fill, LV_ALIGN_BOTTOM_MID, 0, 0);
-        return;
-    }
+static int32_t kw_bar_height_px(int32_t bar_height_px, float kw, int32_t max_watts) {
+    if (isnan(kw)) return 0;
 
     if (max_watts <= 0) max_watts = 3000;
 
@@ -388,35 +565,58 @@ static void set_kw_bar(lv_obj_t* fill, int32_t bar_width_px, int32_t bar_height_
 
     int32_t fill_h = (int32_t)((watts * (int64_t)bar_height_px) / max_watts);
     if (watts > 0 && fill_h == 0) fill_h = 1;
-
-    lv_obj_set_size(fill, bar_width_px, fill_h);
-    lv_obj_align(fill, LV_ALIGN_BOTTOM_MID, 0, 0);
-}
-
-static lv_color_t lv_color_from_rgb_u32(uint32_t rgb) {
-    rgb &= 0xFFFFFFu;
-    return lv_color_make((uint8_t)((rgb >> 16) & 0xFFu), (uint8_t)((rgb >> 8) & 0xFFu), (uint8_t)(rgb & 0xFFu));
+    return fill_h;
 }
 
-static lv_color_t pick_category_color(const EnergyCategoryColorConfig* cfg, float kw, bool use_abs) {
-    if (!cfg) return lv_color_white();
-    if (isnan(kw)) return lv_color_white();
-
-    const float v_kw = use_abs ? fabsf(kw) : kw;
-    const float scaled = v_kw * 1000.0f;
-    int32_t mkw = (int32_t)(scaled >= 0.0f ? (scaled + 0.5f) : (scaled - 0.5f));
+// The fill is anchored bottom-mid in create(): one height change, no realignment.
+static void set_kw_bar(lv_obj_t* fill, int32_t* last_height_px, int32_t bar_height_px, float kw, int32_t max_watts) {
+    if (!fill) return;
 
-    const int32_t t0 = cfg->threshold_mkw[0];
-    const int32_t t1 = cfg->threshold_mkw[1];
-    const int32_t t2 = cfg->threshold_mkw[2];
+    const int32_t fill_h = kw_bar_height_px(bar_height_px, kw, max_watts);
+    if (*last_height_px == fill_h) return;
 
-    uint32_t rgb = cfg->color_ok_rgb;
-    if (mkw < t0) rgb = cfg->color_good_rgb;
-    else if (mkw < t1) rgb = cfg->color_ok_rgb;
-    else if (mkw < t2) rgb = cfg->color_attention_rgb;
-    else rgb = cfg->color_warning_rgb;
+    lv_obj_set_height(fill, fill_h);
+    *last_height_px = fill_h;
+}
 
-    return lv_color_from_rgb_u32(rgb);
+// Turn history samples recorded since the last call into sparkline points: each
+// point is the mean of ENERGY_SPARKLINE_SECONDS_PER_POINT consecutive 1 s samples,
+// aligned on the tier's sample count so a backfill and the live feed agree.
+void EnergyMonitorScreen::updateSparklines() {
+    #if ENERGY_SPARKLINE
+    if (!solar_spark || !layout) return;
+
+    const EnergyHistoryTierInfo info = energy_history_tier_info(EnergyHistoryTier::Fine);
+    if (info.count == 0 || info.total == sparkHistoryTotal) return;
+
+    constexpr uint32_t per = (ENERGY_SPARKLINE_SECONDS_PER_POINT > 0) ? ENERGY_SPARKLINE_SECONDS_PER_POINT : 1;
+    const uint32_t end = info.total - (info.total % per);
+    const uint32_t oldest = info.total - (uint32_t)info.count;
+    uint32_t start = sparkHistoryTotal;
+
+    // Never more points than columns, never samples the ring has already dropped.
+    const uint32_t max_span = (uint32_t)layout->spark_w * per;
+    if (start > end || end - start > max_span) start = (end > max_span) ? end - max_span : 0;
+    if (start < oldest) start = oldest + ((per - (oldest % per)) % per);
+
+    for (uint32_t p = start; p + per <= end; p += per) {
+        int32_t solar_sum = 0, grid_sum = 0, home_sum = 0;
+        uint16_t solar_n = 0, grid_n = 0, home_n = 0;
+        for (uint32_t i = 0; i < per; i++) {
+            EnergyHistorySample s;
+            if (!energy_history_get_sample(EnergyHistoryTier::Fine, (size_t)(p + i - oldest), &s)) continue;
+            const bool solar_ok = (s.solar_dw != kEnergyHistoryNoValue);
+            const bool grid_ok = (s.grid_dw != kEnergyHistoryNoValue);
+            if (solar_ok) { solar_sum += s.solar_dw; solar_n++; }
+            if (grid_ok) { grid_sum += s.grid_dw; grid_n++; }
+            if (solar_ok && grid_ok) { home_sum += s.solar_dw + s.grid_dw; home_n++; }
+        }
+        sparkline_push(solar_spark, solar_n ? (int16_t)(solar_sum / solar_n) : kSparklineNoValue);
+        sparkline_push(home_spark, home_n ? (int16_t)(home_sum / home_n) : kSparklineNoValue);
+        sparkline_push(grid_spark, grid_n ? (int16_t)(grid_sum / grid_n) : kSparklineNoValue);
+    }
+    sparkHistoryTotal = end;
+    #endif
 }
 
 void EnergyMonitorScreen::update() {
@@ -427,8 +627,23 @@ void EnergyMonitorScreen::update() {
     const uint32_t now = millis();
     const uint32_t kFallbackRefreshMs = 500;
 
-    EnergyMonitorState st = energy_monitor_get_state(true /*clear_updates*/);
-    bool shouldRefresh = st.solar_updated || st.grid_updated;
+    #if ENERGY_SPARKLINE
+    updateSparklines();
+    #endif
+
+    EnergyMonitorState st = energy_monitor_get_state();
+    const EnergyRuleSet* rules = energy_thresholds_get();
+    const EnergyAlarmState alarm = energy_alarm_get_state();
+    bool shouldRefresh = (st.generation != lastStateGeneration) || (rules->generation != lastRulesGeneration) ||
+                         (alarm.eval_seq != lastAlarmEvalSeq);
+    #if ENERGY_LATENCY_SUPPORTED
+    if (st.generation != lastStateGeneration) energy_latency_on_pickup();
+    #endif
+    // New values may be fresh again: re-evaluate staleness on this timer pass.
+    if (st.generation != lastStateGeneration && staleTimer) lv_timer_ready(staleTimer);
+    lastStateGeneration = st.generation;
+    lastRulesGeneration = rules->generation;
+    lastAlarmEvalSeq = alarm.eval_seq;
 
     if (!shouldRefresh) {
         if (lastRenderMs != 0 && (uint32_t)(now - lastRenderMs) < kFallbackRefreshMs) {
@@ -438,86 +653,48 @@ void EnergyMonitorScreen::update() {
 
     lastRenderMs = now;
 
-    const float solar_kw = st.solar_value;
-    const float grid_kw = st.grid_value;
+    const float solar_kw = st.value[ENERGY_CHANNEL_SOLAR];
+    const float grid_kw = st.value[ENERGY_CHANNEL_GRID];
     float home_kw = NAN;
     if (!isnan(solar_kw) && !isnan(grid_kw)) {
         home_kw = solar_kw + grid_kw;
     }
 
-    set_kw_label(solar_value, solar_kw);
-    set_kw_label(home_value, home_kw);
-    set_kw_label(grid_value, grid_kw);
+    set_kw_label(solar_value, solar_kw, solarCache.text, sizeof(solarCache.text));
+    set_kw_label(home_value, home_kw, homeCache.text, sizeof(homeCache.text));
+    set_kw_label(grid_value, grid_kw, gridCache.text, sizeof(gridCache.text));
 
-    const lv_color_t solar_color = pick_category_color(config ? &config->energy_solar_colors : nullptr, solar_kw, true /*use_abs*/);
-    const lv_color_t home_color = pick_category_color(config ? &config->energy_home_colors : nullptr, home_kw, true /*use_abs*/);
-    const lv_color_t grid_color = pick_category_color(config ? &config->energy_grid_colors : nullptr, grid_kw, false /*use_abs*/);
+    // Tiers and the gated T2 alarm come from energy_alarm (evaluated when the values
+    // arrived); this only turns them into colors and animation state.
+    const EnergyCategoryRules& solar_rules = rules->category[(size_t)EnergyCategory::Solar];
+    const EnergyCategoryRules& home_rules = rules->category[(size_t)EnergyCategory::Home];
+    const EnergyCategoryRules& grid_rules = rules->category[(size_t)EnergyCategory::Grid];
 
     // Cache intended colors for the timer-driven alarm renderer.
-    intendedSolarColor = solar_color;
-    intendedHomeColor = home_color;
-    intendedGridColor = grid_color;
-
-    const bool prevSolarAlarm = alarmSolar;
-    const bool prevHomeAlarm = alarmHome;
-    const bool prevGridAlarm = alarmGrid;
-
-    int32_t clear_hyst = config ? config->energy_alarm_clear_hysteresis_mkw : 100;
-    if (clear_hyst < 0) clear_hyst = 0;
-
-    // Per-category T2 alarm state with hysteresis (anti-flicker).
-    const EnergyCategoryColorConfig* solar_cfg = config ? &config->energy_solar_colors : nullptr;
-    const EnergyCategoryColorConfig* home_cfg = config ? &config->energy_home_colors : nullptr;
-    const EnergyCategoryColorConfig* grid_cfg = config ? &config->energy_grid_colors : nullptr;
-
-    alarmSolar = prevSolarAlarm
-        ? !is_cleared_t2(solar_cfg, solar_kw, true, clear_hyst)
-        : is_triggered_t2(solar_cfg, solar_kw, true);
-    alarmHome = prevHomeAlarm
-        ? !is_cleared_t2(home_cfg, home_kw, true, clear_hyst)
-        : is_triggered_t2(home_cfg, home_kw, true);
-    alarmGrid = prevGridAlarm
-        ? !is_cleared_t2(grid_cfg, grid_kw, false, clear_hyst)
-        : is_triggered_t2(grid_cfg, grid_kw, false);
-
-    const bool alarmWanted = alarmSolar || alarmHome || alarmGrid;
-
-    if (alarmWanted) {
-        alarmClearStartMs = 0;
+    intendedSolarColor = solar_rules.tier_color[(size_t)alarm.tier[(size_t)EnergyCategory::Solar]];
+    intendedHomeColor = home_rules.tier_color[(size_t)alarm.tier[(size_t)EnergyCategory::Home]];
+    intendedGridColor = grid_rules.tier_color[(size_t)alarm.tier[(size_t)EnergyCategory::Grid]];
+
+    alarmSolar = alarm.category[(size_t)EnergyCategory::Solar];
+    alarmHome = alarm.category[(size_t)EnergyCategory::Home];
+    alarmGrid = alarm.category[(size_t)EnergyCategory::Grid];
+
+    if (alarm.active) {
         if (alarmState == AlarmState::Off || alarmState == AlarmState::Exiting) {
             if (alarmState == AlarmState::Off) {
-                // Latch peak background color: warning color of the first category that triggers.
-                if (alarmSolar && !prevSolarAlarm && solar_cfg) alarmPeakColor = lv_color_from_rgb_u32(solar_cfg->color_warning_rgb);
-                else if (alarmHome && !prevHomeAlarm && home_cfg) alarmPeakColor = lv_color_from_rgb_u32(home_cfg->color_warning_rgb);
-                else if (alarmGrid && !prevGridAlarm && grid_cfg) alarmPeakColor = lv_color_from_rgb_u32(grid_cfg->color_warning_rgb);
-                else if (alarmSolar && solar_cfg) alarmPeakColor = lv_color_from_rgb_u32(solar_cfg->color_warning_rgb);
-                else if (alarmHome && home_cfg) alarmPeakColor = lv_color_from_rgb_u32(home_cfg->color_warning_rgb);
-                else if (alarmGrid && grid_cfg) alarmPeakColor = lv_color_from_rgb_u32(grid_cfg->color_warning_rgb);
+                // Peak background color: warning color of the category that started the episode.
+                const EnergyCategory first = (alarm.first < EnergyCategory::Count) ? alarm.first : EnergyCategory::Solar;
+                alarmPeakColor = rules->category[(size_t)first].tier_color[(size_t)EnergyTier::Warning];
             }
             alarmState = AlarmState::Active;
             alarmDir = 1;
             if (alarmTimer) lv_timer_resume(alarmTimer);
         }
-    } else {
-        if (alarmState == AlarmState::Active) {
-            uint16_t clear_delay = config ? config->energy_alarm_clear_delay_ms : 800;
-            if (clear_delay > 60000) clear_delay = 60000;
-
-            if (clear_delay == 0) {
-                alarmState = AlarmState::Exiting;
-                alarmDir = -1;
-                alarmClearStartMs = 0;
-                if (alarmTimer) lv_timer_resume(alarmTimer);
-            } else {
-                if (alarmClearStartMs == 0) alarmClearStartMs = now;
-                if ((uint32_t)(now - alarmClearStartMs) >= (uint32_t)clear_delay) {
-                    alarmState = AlarmState::Exiting;
-                    alarmDir = -1;
-                    alarmClearStartMs = 0;
-                    if (alarmTimer) lv_timer_resume(alarmTimer);
-                }
-            }
-        }
+    } else if (alarmState == AlarmState::Active) {
+        // The engine already applied the clear delay.
+        alarmState = AlarmState::Exiting;
+        alarmDir = -1;
+        if (alarmTimer) lv_timer_resume(alarmTimer);
     }
 
     // Apply colors. If the alarm is active/exiting, the timer owns the visual styles
@@ -531,25 +708,32 @@ void EnergyMonitorScreen::update() {
     // Arrow visibility/direction
     if (arrow1) {
         // Color will be handled by applyNormalStyles/applyAlarmStyles.
-        if (!isnan(solar_kw) && solar_kw >= 0.01f) {
-            lv_obj_clear_flag(arrow1, LV_OBJ_FLAG_HIDDEN);
-        } else {
-            lv_obj_add_flag(arrow1, LV_OBJ_FLAG_HIDDEN);
+        const int8_t want = (!isnan(solar_kw) && solar_kw >= 0.01f) ? 1 : 0;
+        if (want != arrow1State) {
+            if (want) {
+                lv_obj_clear_flag(arrow1, LV_OBJ_FLAG_HIDDEN);
+            } else {
+                lv_obj_add_flag(arrow1, LV_OBJ_FLAG_HIDDEN);
+            }
+            arrow1State = want;
         }
     }
 
     if (arrow2) {
         // Color will be handled by applyNormalStyles/applyAlarmStyles.
-        if (isnan(grid_kw)) {
-            lv_obj_add_flag(arrow2, LV_OBJ_FLAG_HIDDEN);
-        } else {
-            lv_label_set_text(arrow2, grid_kw > 0.0f ? LV_SYMBOL_LEFT : LV_SYMBOL_RIGHT);
-            lv_obj_clear_flag(arrow2, LV_OBJ_FLAG_HIDDEN);
+        const int8_t want = isnan(grid_kw) ? 0 : (grid_kw > 0.0f ? 1 : 2);
+        if (want != arrow2State) {
+            if (want == 0) {
+                lv_obj_add_flag(arrow2, LV_OBJ_FLAG_HIDDEN);
+            } else {
+                lv_label_set_text(arrow2, want == 1 ? LV_SYMBOL_LEFT : LV_SYMBOL_RIGHT);
+                lv_obj_clear_flag(arrow2, LV_OBJ_FLAG_HIDDEN);
+            }
+            arrow2State = want;
         }
     }
 
-    const int32_t bar_width = 12;
-    const int32_t bar_height = 100;
+    const int32_t bar_height = layout->bar_h;
 
     float solar_max_kw = (config && config->energy_solar_bar_max_kw > 0.0f) ? config->energy_solar_bar_max_kw : 3.0f;
     float home_max_kw = (config && config->energy_home_bar_max_kw > 0.0f) ? config->energy_home_bar_max_kw : 3.0f;
@@ -563,7 +747,7 @@ void EnergyMonitorScreen::update() {
     if (home_max_w <= 0) home_max_w = 3000;
     if (grid_max_w <= 0) grid_max_w = 3000;
 
-    set_kw_bar(solar_bar_fill, bar_width, bar_height, solar_kw, solar_max_w);
-    set_kw_bar(home_bar_fill, bar_width, bar_height, home_kw, home_max_w);
-    set_kw_bar(grid_bar_fill, bar_width, bar_height, grid_kw, grid_max_w);
+    set_kw_bar(solar_bar_fill, &solarCache.barHeightPx, bar_height, solar_kw, solar_max_w);
+    set_kw_bar(home_bar_fill, &homeCache.barHeightPx, bar_height, home_kw, home_max_w);
+    set_kw_bar(grid_bar_fill, &gridCache.barHeightPx, bar_height, grid_kw, grid_max_w);
 }
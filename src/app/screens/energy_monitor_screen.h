@@ -2,7 +2,10 @@
 #define ENERGY_MONITOR_SCREEN_H
 
 #include "screen.h"
+#include "energy_layout.h"
+#include "../board_config.h"
 #include "../config_manager.h"
+#include "../energy_monitor.h"
 #include <lvgl.h>
 
 class DisplayManager;
@@ -12,8 +15,12 @@ private:
     lv_obj_t* screen = nullptr;
     DeviceConfig* config = nullptr;
     DisplayManager* displayMgr = nullptr;
+    const EnergyLayout* layout = &kEnergyLayout;  // chosen in create() for the logical orientation
 
     uint32_t lastRenderMs = 0;
+    uint32_t lastStateGeneration = 0;  // energy_monitor generation last rendered
+    uint32_t lastRulesGeneration = 0;  // energy_thresholds generation last rendered
+    uint32_t lastAlarmEvalSeq = 0;     // energy_alarm evaluation last rendered
 
     lv_obj_t* background = nullptr;
 
@@ -39,6 +46,18 @@ private:
     lv_obj_t* grid_bar_bg = nullptr;
     lv_obj_t* grid_bar_fill = nullptr;
 
+    // ENERGY_SPARKLINE trend strips, fed from the 1 s energy history tier.
+    lv_obj_t* solar_spark = nullptr;
+    lv_obj_t* home_spark = nullptr;
+    lv_obj_t* grid_spark = nullptr;
+    uint32_t sparkHistoryTotal = 0;  // history samples already turned into points
+
+    // Halo behind each category column (ENERGY_ALARM_HALO_MODE): the alarm pulse
+    // animates only these, so each tick invalidates a column, not the panel.
+    lv_obj_t* solar_halo = nullptr;
+    lv_obj_t* home_halo = nullptr;
+    lv_obj_t* grid_halo = nullptr;
+
     // T2 Warning (v1): breathing background + contrast remapping.
     enum class AlarmState : uint8_t {
         Off = 0,
@@ -47,6 +66,11 @@ private:
     };
 
     AlarmState alarmState = AlarmState::Off;
+
+    // Display refresh period while no alarm animation runs (refresh governor).
+    static constexpr uint32_t kIdleRefreshPeriodMs = 500;
+    // Alarm animation step (and refresh period while it runs).
+    static constexpr uint32_t kAlarmStepMs = (ENERGY_ALARM_STEP_MS < LV_DISP_DEF_REFR_PERIOD) ? LV_DISP_DEF_REFR_PERIOD : ENERGY_ALARM_STEP_MS;
     lv_timer_t* alarmTimer = nullptr;
     uint8_t alarmPhase = 0;   // 0..255 (black -> peak)
     int8_t alarmDir = 1;      // +1 to ramp up, -1 to ramp down
@@ -54,10 +78,7 @@ private:
     // Latched background peak color for the current alarm episode.
     lv_color_t alarmPeakColor = lv_color_make(255, 0, 0);
 
-    // Anti-flicker: when alarm clears, require it to stay clear for a bit before exiting.
-    uint32_t alarmClearStartMs = 0;
-
-    // Which categories are currently responsible for the T2 alarm.
+    // Which categories are currently responsible for the T2 alarm (from energy_alarm).
     // Used to avoid animating/remapping non-alarm categories.
     bool alarmSolar = false;
     bool alarmHome = false;
@@ -69,8 +90,61 @@ private:
     lv_color_t intendedHomeColor = lv_color_white();
     lv_color_t intendedGridColor = lv_color_white();
 
+    // Contrast-remapped foreground per background strength above the remap start
+    // (see contrast_remap_for_bg), rebuilt when the intended or peak color changes.
+    static constexpr uint8_t kRemapTableLen = 95;  // strengths 161..255
+    struct RemapTable {
+        lv_color_t intended;
+        lv_color_t peak;
+        bool valid = false;
+        lv_color_t color[kRemapTableLen];
+    };
+
+    RemapTable solarRemap;
+    RemapTable homeRemap;
+    RemapTable gridRemap;
+
+    // Staleness tiers on screen (energy_monitor_staleness): aging columns are dimmed,
+    // stale ones dimmed further with a warning mark after the unit. One timer
+    // re-evaluates them; update() only makes it run early when new values arrive.
+    static constexpr uint32_t kStaleCheckMs = 1000;
+    lv_timer_t* staleTimer = nullptr;
+    EnergyStaleness solarStale = EnergyStaleness::Fresh;
+    EnergyStaleness homeStale = EnergyStaleness::Fresh;   // worst of solar and grid
+    EnergyStaleness gridStale = EnergyStaleness::Fresh;
+
+    // What is currently on screen per category, so update() and the alarm renderer
+    // only touch widgets whose text/size/color actually changed (every LVGL setter
+    // invalidates its area, even when the value is identical).
+    struct CategoryRenderCache {
+        char text[16];
+        int32_t barHeightPx;   // -1 = unknown
+        lv_color_t color;
+        bool colorValid;
+        lv_color_t haloColor;
+        int8_t haloState;      // -1 unknown, 0 hidden, 1 shown
+    };
+
+    CategoryRenderCache solarCache;
+    CategoryRenderCache homeCache;
+    CategoryRenderCache gridCache;
+    lv_color_t appliedBgColor = lv_color_black();
+    bool bgColorValid = false;
+    int8_t arrow1State = -1;  // -1 unknown, 0 hidden, 1 shown
+    int8_t arrow2State = -1;  // -1 unknown, 0 hidden, 1 left, 2 right
+
     static void alarmTimerCb(lv_timer_t* t);
     void alarmTick();
+    static void staleTimerCb(lv_timer_t* t);
+    void staleTick();
+    void resetRenderCache();
+    void applyBackgroundColor(lv_color_t color);
+    void applyCategoryColor(CategoryRenderCache& cache, lv_color_t color,
+                            lv_obj_t* icon, lv_obj_t* value, lv_obj_t* unit,
+                            lv_obj_t* barFill, lv_obj_t* spark, lv_obj_t* arrow);
+    void updateSparklines();
+    void applyHalo(CategoryRenderCache& cache, lv_obj_t* halo, bool show, lv_color_t color);
+    lv_color_t remappedColor(RemapTable& table, lv_color_t intended, uint8_t mix);
     void applyNormalStyles();
     void applyAlarmStyles();
 
@@ -83,6 +157,11 @@ public:
     void show() override;
     void hide() override;
     void update() override;
+
+    // ~2 Hz for value updates; alarm step rate only while the alarm animation runs.
+    uint32_t refreshPeriodMs() const override {
+        return (alarmState == AlarmState::Off) ? kIdleRefreshPeriodMs : kAlarmStepMs;
+    }
 };
 
 #endif // ENERGY_MONITOR_SCREEN_H
@@ -6,10 +6,11 @@
 #include "../display_manager.h"
 #include <WiFi.h>
 #include <esp_chip_info.h>
+#include <string.h>
 
 InfoScreen::InfoScreen(DeviceConfig* deviceConfig, DisplayManager* manager) 
     : screen(nullptr), config(deviceConfig), displayMgr(manager),
-    lastUpdateMs(0),
+    identityValid(false), infoGeneration(0), lastIdentityMs(0), lastTickSec(UINT32_MAX),
     deviceNameLabel(nullptr), mdnsLabel(nullptr), ssidLabel(nullptr), ipLabel(nullptr),
     versionLabel(nullptr), uptimeLabel(nullptr), heapLabel(nullptr), chipLabel(nullptr) {}
 
@@ -117,6 +118,9 @@ void InfoScreen::destroy() {
         separatorTop = nullptr;
         separatorBottom = nullptr;
     }
+    // Repopulate right after a re-create.
+    identityValid = false;
+    lastTickSec = UINT32_MAX;
 }
 
 void InfoScreen::show() {
@@ -129,75 +133,84 @@ void InfoScreen::hide() {
     // Nothing to do - LVGL handles screen switching
 }
 
+// lv_label_set_text() invalidates the label even for identical text.
+static void set_label_text(lv_obj_t* label, const char* text) {
+    if (!label) return;
+    const char* current = lv_label_get_text(label);
+    if (current && strcmp(current, text) == 0) return;
+    lv_label_set_text(label, text);
+}
+
 void InfoScreen::update() {
     if (!screen) return;
 
-    // This method is called from the LVGL task loop, potentially every 1-10ms.
-    // Avoid constant label rewrites/invalidation: update at a modest cadence.
+    // Called from the LVGL task loop on every wakeup. Only labels whose text
+    // actually changes are written, so an idle info screen produces no flushes.
     const uint32_t now = millis();
-    const uint32_t kUpdateIntervalMs = 500;
-    if (lastUpdateMs != 0 && (uint32_t)(now - lastUpdateMs) < kUpdateIntervalMs) {
-        return;
-    }
-    lastUpdateMs = now;
-    
-    // Update device name (from config)
-    if (deviceNameLabel) {
-        if (strlen(config->device_name) > 0) {
-            lv_label_set_text(deviceNameLabel, config->device_name);
-        } else {
-            lv_label_set_text(deviceNameLabel, "ESP32 Device");
-        }
+
+    // Device name / mDNS / IP: on config save and WiFi/AP events. The slow recheck
+    // catches changes nobody announced (e.g. DHCP renewal); it writes nothing if equal.
+    const uint32_t kIdentityRecheckMs = 30000;
+    const uint32_t generation = display_manager_info_generation();
+    if (!identityValid || generation != infoGeneration || (uint32_t)(now - lastIdentityMs) >= kIdentityRecheckMs) {
+        identityValid = true;
+        infoGeneration = generation;
+        lastIdentityMs = now;
+        updateIdentity();
     }
-    
-    // Update uptime (formatted)
-    if (uptimeLabel) {
-        unsigned long uptime_sec = millis() / 1000;
-        char uptime_text[32];
-        if (uptime_sec < 60) {
-            snprintf(uptime_text, sizeof(uptime_text), "%lus", uptime_sec);
-        } else if (uptime_sec < 3600) {
-            snprintf(uptime_text, sizeof(uptime_text), "%lum %lus", uptime_sec / 60, uptime_sec % 60);
-        } else {
-            unsigned long hours = uptime_sec / 3600;
-            unsigned long mins = (uptime_sec % 3600) / 60;
-            snprintf(uptime_text, sizeof(uptime_text), "%luh %lum", hours, mins);
-        }
-        lv_label_set_text(uptimeLabel, uptime_text);
+
+    const uint32_t uptimeSec = now / 1000;
+    if (uptimeSec != lastTickSec) {
+        lastTickSec = uptimeSec;
+        updateTick(uptimeSec);
     }
-    
-    // Update free heap with CPU usage
-    if (heapLabel) {
-        char heap_text[64];
-        unsigned long heap_kb = ESP.getFreeHeap() / 1024;
-        const int cpu_usage = device_telemetry_get_cpu_usage();
-        if (cpu_usage >= 0) {
-            snprintf(heap_text, sizeof(heap_text), "%lu KB free / %d%% CPU", heap_kb, cpu_usage);
-        } else {
-            snprintf(heap_text, sizeof(heap_text), "%lu KB free / --%% CPU", heap_kb);
-        }
-        lv_label_set_text(heapLabel, heap_text);
+}
+
+void InfoScreen::updateIdentity() {
+    // Device name (from config)
+    set_label_text(deviceNameLabel, strlen(config->device_name) > 0 ? config->device_name : "ESP32 Device");
+
+    // IP address
+    if (WiFi.status() == WL_CONNECTED) {
+        set_label_text(ipLabel, WiFi.localIP().toString().c_str());
+    } else if (WiFi.getMode() == WIFI_AP) {
+        set_label_text(ipLabel, WiFi.softAPIP().toString().c_str());
+    } else {
+        set_label_text(ipLabel, "No IP");
     }
-    
-    // Update IP address
-    if (ipLabel) {
-        if (WiFi.status() == WL_CONNECTED) {
-            lv_label_set_text(ipLabel, WiFi.localIP().toString().c_str());
-        } else if (WiFi.getMode() == WIFI_AP) {
-            lv_label_set_text(ipLabel, WiFi.softAPIP().toString().c_str());
-        } else {
-            lv_label_set_text(ipLabel, "No IP");
-        }
+
+    // mDNS hostname
+    char sanitized[CONFIG_DEVICE_NAME_MAX_LEN];
+    config_manager_sanitize_device_name(config->device_name, sanitized, sizeof(sanitized));
+    char mdns_text[CONFIG_DEVICE_NAME_MAX_LEN + 10];
+    snprintf(mdns_text, sizeof(mdns_text), "%s.local", sanitized);
+    set_label_text(mdnsLabel, mdns_text);
+}
+
+void InfoScreen::updateTick(uint32_t uptimeSec) {
+    // Uptime (formatted; past one hour the text only changes once a minute)
+    char uptime_text[32];
+    if (uptimeSec < 60) {
+        snprintf(uptime_text, sizeof(uptime_text), "%lus", (unsigned long)uptimeSec);
+    } else if (uptimeSec < 3600) {
+        snprintf(uptime_text, sizeof(uptime_text), "%lum %lus", (unsigned long)(uptimeSec / 60), (unsigned long)(uptimeSec % 60));
+    } else {
+        const unsigned long hours = uptimeSec / 3600;
+        const unsigned long mins = (uptimeSec % 3600) / 60;
+        snprintf(uptime_text, sizeof(uptime_text), "%luh %lum", hours, mins);
     }
-    
-    // Update mDNS hostname
-    if (mdnsLabel) {
-        char sanitized[CONFIG_DEVICE_NAME_MAX_LEN];
-        config_manager_sanitize_device_name(config->device_name, sanitized, sizeof(sanitized));
-        char mdns_text[CONFIG_DEVICE_NAME_MAX_LEN + 10];
-        snprintf(mdns_text, sizeof(mdns_text), "%s.local", sanitized);
-        lv_label_set_text(mdnsLabel, mdns_text);
+    set_label_text(uptimeLabel, uptime_text);
+
+    // Free heap with CPU usage
+    char heap_text[64];
+    const unsigned long heap_kb = ESP.getFreeHeap() / 1024;
+    const int cpu_usage = device_telemetry_get_cpu_usage();
+    if (cpu_usage >= 0) {
+        snprintf(heap_text, sizeof(heap_text), "%lu KB free / %d%% CPU", heap_kb, cpu_usage);
+    } else {
+        snprintf(heap_text, sizeof(heap_text), "%lu KB free / --%% CPU", heap_kb);
     }
+    set_label_text(heapLabel, heap_text);
 }
 
 // Touch event callback - navigate to TestScreen
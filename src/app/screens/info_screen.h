@@ -2,6 +2,7 @@
 #define INFO_SCREEN_H
 
 #include "screen.h"
+#include "../board_config.h"
 #include "../config_manager.h"
 #include <lvgl.h>
 
@@ -20,9 +21,14 @@ private:
     DeviceConfig* config;
     DisplayManager* displayMgr;
 
-    uint32_t lastUpdateMs;
+    // Identity/network labels are rewritten only when the info generation moved
+    // (display_manager_notify_info_changed); uptime/heap once per second.
+    bool identityValid;
+    uint32_t infoGeneration;
+    uint32_t lastIdentityMs;
+    uint32_t lastTickSec;
     
-    // Labels (updated in real-time)
+    // Labels
     lv_obj_t* deviceNameLabel;
     lv_obj_t* mdnsLabel;
     lv_obj_t* ssidLabel;
@@ -38,6 +44,9 @@ private:
     
     // Touch event handler (static callback)
     static void touchEventCallback(lv_event_t* e);
+
+    void updateIdentity();
+    void updateTick(uint32_t uptimeSec);
     
 public:
     InfoScreen(DeviceConfig* deviceConfig, DisplayManager* manager);
@@ -48,6 +57,14 @@ public:
     void show() override;
     void hide() override;
     void update() override;
+
+    // Refresh every 250 ms: labels change at most once per second, so a new value
+    // shows within a quarter second. Unchanged text is never rewritten.
+    uint32_t refreshPeriodMs() const override { return 250; }
+    // Rarely visited: give the LVGL memory back while hidden.
+    ScreenRetention retention() const override {
+        return SCREEN_RECLAIM_EPHEMERAL ? ScreenRetention::Ephemeral : ScreenRetention::KeepWarm;
+    }
 };
 
 #endif // INFO_SCREEN_H
@@ -4,6 +4,8 @@
 
 #include "lvgl_image_screen.h"
 #include "log_manager.h"
+#include "../image_arena.h"
+#include "../lvgl_image_cache.h"
 
 #if LV_USE_IMG
 
@@ -28,7 +30,7 @@ void LvglImageScreen::create() {
     // Fixed display box so the image always occupies 200x200 on screen.
     // The decoded image may be smaller due to heap fragmentation; we zoom it to fit.
     box = lv_obj_create(scr);
-    lv_obj_set_size(box, 200, 200);
+    lv_obj_set_size(box, kImageBoxPx, kImageBoxPx);
     // Move the image down slightly so it doesn't overlap the title label.
     lv_obj_align(box, LV_ALIGN_CENTER, 0, 16);
     lv_obj_clear_flag(box, LV_OBJ_FLAG_SCROLLABLE);
@@ -80,10 +82,18 @@ void LvglImageScreen::update() {
 
 void LvglImageScreen::freePixelBuf() {
     if (pixel_buf) {
-        heap_caps_free(pixel_buf);
+        #if LVGL_IMAGE_CACHE_SUPPORTED
+        if (pixel_buf_cached) {
+            lvgl_image_cache_release(pixel_buf);
+        } else
+        #endif
+        {
+            image_arena_free(pixel_buf);
+        }
         pixel_buf = nullptr;
         pixel_buf_bytes = 0;
     }
+    pixel_buf_cached = false;
     memset(&img_dsc, 0, sizeof(img_dsc));
 }
 
@@ -102,6 +112,15 @@ void LvglImageScreen::clearImage() {
 }
 
 bool LvglImageScreen::setImageRgb565(uint16_t* pixels, int w, int h) {
+    return applyImage(pixels, w, h, false);
+}
+
+bool LvglImageScreen::setImageCachedRgb565(const uint16_t* pixels, int w, int h) {
+    // LVGL only reads the buffer; the cache keeps it alive while pinned.
+    return applyImage(const_cast<uint16_t*>(pixels), w, h, true);
+}
+
+bool LvglImageScreen::applyImage(uint16_t* pixels, int w, int h, bool cached) {
     if (!pixels || w <= 0 || h <= 0) {
         return false;
     }
@@ -116,6 +135,7 @@ bool LvglImageScreen::setImageRgb565(uint16_t* pixels, int w, int h) {
 
     pixel_buf = pixels;
     pixel_buf_bytes = (size_t)w * (size_t)h * 2;
+    pixel_buf_cached = cached;
 
     img_dsc.header.always_zero = 0;
     img_dsc.header.w = (uint32_t)w;
@@ -132,12 +152,13 @@ bool LvglImageScreen::setImageRgb565(uint16_t* pixels, int w, int h) {
     #if LV_USE_IMG_TRANSFORM
     // Scale to fit within 200x200. For square album art this becomes exactly 200x200.
     // LVGL zoom: 256 = 1x.
-    const uint32_t target = 200U;
+    const uint32_t target = (uint32_t)kImageBoxPx;
     const uint32_t zoom_x = target * 256U / (uint32_t)w;
     const uint32_t zoom_y = target * 256U / (uint32_t)h;
     uint32_t zoom = (zoom_x < zoom_y) ? zoom_x : zoom_y; // contain
 
-    // Reasonable clamp: allow up to 16x for tiny decode outputs.
+    // Reasonable clamp (1/16x..16x). The decoder already picks a JPEG scale close
+    // to the box, so zoom normally stays between ~0.5x and 1x.
     if (zoom < 16) zoom = 16;
     if (zoom > 4096) zoom = 4096;
     lv_img_set_zoom(img, (uint16_t)zoom);
@@ -23,10 +23,20 @@ public:
     void hide() override;
     void update() override;
 
+    // Static image; keep transitions reasonably snappy.
+    uint32_t refreshPeriodMs() const override { return 100; }
+
+    // Fixed on-screen image box (px); decoders should target this size.
+    static constexpr int kImageBoxPx = 200;
+
     // Takes ownership of `pixels` (allocated with heap_caps_malloc/malloc).
     // Pixels are expected to be RGB565, w*h.
     bool setImageRgb565(uint16_t* pixels, int w, int h);
 
+    // Show a pinned lvgl_image_cache buffer (not owned); it is released, not freed,
+    // when the image is replaced or cleared.
+    bool setImageCachedRgb565(const uint16_t* pixels, int w, int h);
+
     void clearImage();
 
 private:
@@ -39,8 +49,10 @@ private:
     lv_img_dsc_t img_dsc{};
     uint16_t* pixel_buf = nullptr;
     size_t pixel_buf_bytes = 0;
+    bool pixel_buf_cached = false;  // pixel_buf belongs to lvgl_image_cache
 
     void freePixelBuf();
+    bool applyImage(uint16_t* pixels, int w, int h, bool cached);
 };
 
 #endif // LV_USE_IMG
@@ -1,6 +1,9 @@
 #ifndef SCREEN_H
 #define SCREEN_H
 
+#include <lvgl.h>
+#include <stdint.h>
+
 // ============================================================================
 // Screen Base Class
 // ============================================================================
@@ -13,6 +16,17 @@
 // 3. update()  - Refresh data (called every loop while active)
 // 4. hide()    - Hide screen (optional cleanup)
 // 5. destroy() - Clean up widgets (called before deletion)
+//
+// DisplayManager creates screens on first show and may destroy a hidden screen's
+// widget tree again (see retention()); create() after destroy() must rebuild a
+// fully working screen.
+
+// What DisplayManager may do with a screen's LVGL tree while it is hidden.
+enum class ScreenRetention : uint8_t {
+    KeepWarm,   // keep it; evicted least-recently-shown first past SCREEN_LVGL_BUDGET_BYTES
+    Ephemeral,  // destroy as soon as another screen is shown
+    Pinned,     // never destroy (state outlives visibility, e.g. direct-image sessions)
+};
 
 class Screen {
 public:
@@ -33,6 +47,15 @@ public:
     // Update screen data (called every loop while active)
     // Read from stored pointers (thread-safe: main loop only)
     virtual void update() = 0;
+
+    // Target LVGL display refresh period while this screen is active (ms).
+    // DisplayManager re-checks it every frame, so screens may change it at runtime
+    // (e.g. full rate only while an animation runs).
+    // Default: LV_DISP_DEF_REFR_PERIOD (lv_conf.h).
+    virtual uint32_t refreshPeriodMs() const { return LV_DISP_DEF_REFR_PERIOD; }
+
+    // Retention policy while hidden. Default: keep warm.
+    virtual ScreenRetention retention() const { return ScreenRetention::KeepWarm; }
 };
 
 #endif // SCREEN_H
@@ -0,0 +1,232 @@
+#include "sparkline.h"
+
+#include "log_manager.h"
+
+#include <string.h>
+
+namespace {
+
+// Blank columns ahead of the write cursor (the sweep's "now" marker).
+static constexpr uint16_t kGapColumns = 3;
+
+// Slots of the window in push order whose values are monotonic (front = extreme).
+struct MonoQueue {
+    uint16_t* slot;
+    uint16_t head;
+    uint16_t len;
+};
+
+struct SparklineState {
+    uint16_t n;          // columns == points
+    uint16_t cursor;     // next slot to write
+    uint16_t count;      // slots written (<= n)
+    int16_t min_span;
+    int16_t scale_lo;    // range currently on screen
+    int16_t scale_hi;
+    bool scale_valid;
+    int16_t* values;     // n
+    MonoQueue max_q;
+    MonoQueue min_q;
+};
+
+static uint16_t q_front(const MonoQueue& q) {
+    return q.slot[q.head];
+}
+
+static uint16_t q_back(const SparklineState* s, const MonoQueue& q) {
+    return q.slot[(uint16_t)((q.head + q.len - 1) % s->n)];
+}
+
+static void q_push_back(const SparklineState* s, MonoQueue& q, uint16_t slot) {
+    q.slot[(uint16_t)((q.head + q.len) % s->n)] = slot;
+    q.len++;
+}
+
+static void q_pop_front(const SparklineState* s, MonoQueue& q) {
+    q.head = (uint16_t)((q.head + 1) % s->n);
+    q.len--;
+}
+
+static bool in_gap(const SparklineState* s, uint16_t col) {
+    if (s->count < s->n) return false;  // columns past `count` are empty anyway
+    const uint16_t ahead = (uint16_t)((col + s->n - s->cursor) % s->n);
+    return ahead < kGapColumns;
+}
+
+static bool drawable(const SparklineState* s, uint16_t col) {
+    if (col >= s->n) return false;
+    if (s->count < s->n && col >= s->count) return false;
+    if (in_gap(s, col)) return false;
+    return s->values[col] != kSparklineNoValue;
+}
+
+static lv_coord_t value_y(const lv_obj_t* obj, const SparklineState* s, int16_t v) {
+    const int32_t h = lv_area_get_height(&obj->coords);
+    const int32_t span = (int32_t)s->scale_hi - s->scale_lo;
+    int32_t off = (span > 0) ? (((int32_t)v - s->scale_lo) * (h - 1)) / span : (h - 1) / 2;
+    if (off < 0) off = 0;
+    if (off > h - 1) off = h - 1;
+    return (lv_coord_t)(obj->coords.y2 - off);
+}
+
+// Recompute the drawn range from the queue fronts; true when it changed.
+static bool update_scale(SparklineState* s) {
+    if (s->max_q.len == 0) return false;  // nothing to scale (keep the old range)
+
+    int32_t lo = s->values[q_front(s->min_q)];
+    int32_t hi = s->values[q_front(s->max_q)];
+    if (hi - lo < s->min_span) {
+        const int32_t mid = (lo + hi) / 2;
+        lo = mid - s->min_span / 2;
+        hi = lo + s->min_span;
+    }
+
+    if (s->scale_valid) {
+        const int32_t cur_span = (int32_t)s->scale_hi - s->scale_lo;
+        const bool fits = (lo >= s->scale_lo) && (hi <= s->scale_hi);
+        if (fits && (hi - lo) * 2 > cur_span) return false;
+    }
+
+    if (lo < -32767) lo = -32767;
+    if (hi > 32767) hi = 32767;
+    s->scale_lo = (int16_t)lo;
+    s->scale_hi = (int16_t)hi;
+    s->scale_valid = true;
+    return true;
+}
+
+// Invalidate `len` columns starting at `first` (wrapping at the right edge).
+static void invalidate_columns(lv_obj_t* obj, const SparklineState* s, uint16_t first, uint16_t len) {
+    if (len > s->n) len = s->n;
+    while (len > 0) {
+        const uint16_t run = (uint16_t)((first + len > s->n) ? s->n - first : len);
+        lv_area_t area;
+        area.x1 = (lv_coord_t)(obj->coords.x1 + first);
+        area.x2 = (lv_coord_t)(area.x1 + run - 1);
+        area.y1 = obj->coords.y1;
+        area.y2 = obj->coords.y2;
+        lv_obj_invalidate_area(obj, &area);
+        len = (uint16_t)(len - run);
+        first = 0;
+    }
+}
+
+static void draw_cb(lv_event_t* e) {
+    lv_obj_t* obj = lv_event_get_target(e);
+    SparklineState* s = (SparklineState*)lv_obj_get_user_data(obj);
+    if (!s || s->count == 0 || !s->scale_valid) return;
+    lv_draw_ctx_t* draw_ctx = lv_event_get_draw_ctx(e);
+
+    lv_draw_rect_dsc_t dsc;
+    lv_draw_rect_dsc_init(&dsc);
+    dsc.bg_color = lv_obj_get_style_text_color(obj, LV_PART_MAIN);
+    dsc.bg_opa = lv_obj_get_style_text_opa(obj, LV_PART_MAIN);
+
+    // Only the columns inside the area being redrawn.
+    int32_t c1 = (int32_t)draw_ctx->clip_area->x1 - obj->coords.x1;
+    int32_t c2 = (int32_t)draw_ctx->clip_area->x2 - obj->coords.x1;
+    if (c1 < 0) c1 = 0;
+    if (c2 > (int32_t)s->n - 1) c2 = (int32_t)s->n - 1;
+
+    for (int32_t c = c1; c <= c2; c++) {
+        if (!drawable(s, (uint16_t)c)) continue;
+
+        // A vertical run joining the previous point (when it sits in the column to
+        // the left and is drawn) to this one; a single pixel otherwise.
+        lv_coord_t y_cur = value_y(obj, s, s->values[c]);
+        lv_coord_t y_prev = y_cur;
+        if (c > 0 && drawable(s, (uint16_t)(c - 1))) {
+            y_prev = value_y(obj, s, s->values[c - 1]);
+        }
+
+        lv_area_t area;
+        area.x1 = (lv_coord_t)(obj->coords.x1 + c);
+        area.x2 = area.x1;
+        area.y1 = (y_prev < y_cur) ? y_prev : y_cur;
+        area.y2 = (y_prev < y_cur) ? y_cur : y_prev;
+        lv_draw_rect(draw_ctx, &dsc, &area);
+    }
+}
+
+static void delete_cb(lv_event_t* e) {
+    lv_obj_t* obj = lv_event_get_target(e);
+    void* s = lv_obj_get_user_data(obj);
+    lv_obj_set_user_data(obj, nullptr);
+    if (s) lv_mem_free(s);
+}
+
+} // namespace
+
+lv_obj_t* sparkline_create(lv_obj_t* parent, lv_coord_t w, lv_coord_t h, int16_t min_span) {
+    lv_obj_t* obj = lv_obj_create(parent);
+    lv_obj_remove_style_all(obj);
+    lv_obj_clear_flag(obj, (lv_obj_flag_t)(LV_OBJ_FLAG_SCROLLABLE | LV_OBJ_FLAG_CLICKABLE));
+    lv_obj_set_size(obj, w, h);
+
+    SparklineState* s = nullptr;
+    if (w > 0 && h > 0) {
+        // State, values and both queues in one block.
+        const size_t n = (size_t)w;
+        const size_t bytes = sizeof(SparklineState) + n * sizeof(int16_t) + 2 * n * sizeof(uint16_t);
+        s = (SparklineState*)lv_mem_alloc(bytes);
+        if (s) {
+            memset(s, 0, bytes);
+            s->n = (uint16_t)n;
+            s->min_span = (min_span > 0) ? min_span : 1;
+            s->values = (int16_t*)(s + 1);
+            s->max_q.slot = (uint16_t*)(s->values + n);
+            s->min_q.slot = s->max_q.slot + n;
+        } else {
+            LOGE("Spark", "Alloc failed (%u bytes)", (unsigned)bytes);
+        }
+    }
+    lv_obj_set_user_data(obj, s);
+
+    lv_obj_add_event_cb(obj, draw_cb, LV_EVENT_DRAW_MAIN, nullptr);
+    lv_obj_add_event_cb(obj, delete_cb, LV_EVENT_DELETE, nullptr);
+    return obj;
+}
+
+void sparkline_push(lv_obj_t* obj, int16_t value) {
+    if (!obj) return;
+    SparklineState* s = (SparklineState*)lv_obj_get_user_data(obj);
+    if (!s) return;
+
+    const uint16_t slot = s->cursor;
+    if (s->count == s->n) {
+        // The slot being overwritten is the oldest point; when in a queue it is the front.
+        if (s->max_q.len && q_front(s->max_q) == slot) q_pop_front(s, s->max_q);
+        if (s->min_q.len && q_front(s->min_q) == slot) q_pop_front(s, s->min_q);
+    } else {
+        s->count++;
+    }
+
+    s->values[slot] = value;
+    if (value != kSparklineNoValue) {
+        while (s->max_q.len && s->values[q_back(s, s->max_q)] <= value) s->max_q.len--;
+        q_push_back(s, s->max_q, slot);
+        while (s->min_q.len && s->values[q_back(s, s->min_q)] >= value) s->min_q.len--;
+        q_push_back(s, s->min_q, slot);
+    }
+    s->cursor = (uint16_t)((slot + 1) % s->n);
+
+    if (update_scale(s)) {
+        lv_obj_invalidate(obj);
+        return;
+    }
+    // New point, the column that just joined the gap, and the one after it (it
+    // lost its left neighbour).
+    invalidate_columns(obj, s, slot, (uint16_t)(kGapColumns + 2));
+}
+
+void sparkline_clear(lv_obj_t* obj) {
+    if (!obj) return;
+    SparklineState* s = (SparklineState*)lv_obj_get_user_data(obj);
+    if (!s) return;
+    s->cursor = 0;
+    s->count = 0;
+    s->max_q.head = s->max_q.len = 0;
+    s->min_q.head = s->min_q.len = 0;
+    s->scale_valid = false;
+    lv_obj_invalidate(obj);
+}
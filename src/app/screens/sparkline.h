@@ -0,0 +1,35 @@
+#ifndef SPARKLINE_H
+#define SPARKLINE_H
+
+#include <lvgl.h>
+#include <stdint.h>
+
+// ============================================================================
+// Sparkline
+// ============================================================================
+// Compact trend line for a value history (the energy screen's per-category
+// history strip, ENERGY_SPARKLINE).
+//
+// One point per pixel column, drawn as a sweep: a new point overwrites the oldest
+// column at a moving cursor, with a short blank gap ahead of it marking "now".
+// Nothing scrolls, so a push invalidates only the new column, the gap and the
+// column after it (a few pixels wide); the whole widget is redrawn only when the
+// autoscale range changes. Min/max over the window are kept with monotonic
+// queues (O(1) amortized per push, no rescan of the window), and the range only
+// shrinks once the data uses less than half of it. DRAW_MAIN walks just the
+// columns inside the clip area. The line uses the object's text color.
+//
+// LVGL task only (like every LVGL call).
+
+static constexpr int16_t kSparklineNoValue = INT16_MIN;
+
+// `min_span` is the smallest value range mapped to the full height (keeps noise flat).
+lv_obj_t* sparkline_create(lv_obj_t* parent, lv_coord_t w, lv_coord_t h, int16_t min_span);
+
+// Append a point (kSparklineNoValue leaves a hole).
+void sparkline_push(lv_obj_t* obj, int16_t value);
+
+// Drop all points.
+void sparkline_clear(lv_obj_t* obj);
+
+#endif // SPARKLINE_H
@@ -109,7 +109,6 @@ void SplashScreen::setStatus(const char* text) {
 
         // Re-layout in case the text height changed (wrapping, font changes, etc.)
         layoutSplashBlock(screen, logoImg, statusLabel, spinner);
-    } else {
-        LOGE("Splash", "statusLabel is NULL");
     }
+    // Destroyed after boot (ScreenRetention::Ephemeral): late status text has nowhere to go.
 }
@@ -2,6 +2,7 @@
 #define SPLASH_SCREEN_H
 
 #include "screen.h"
+#include "../board_config.h"
 #include <lvgl.h>
 
 // ============================================================================
@@ -26,6 +27,13 @@ public:
     void show() override;
     void hide() override;
     void update() override;
+
+    // Spinner only: ~20 fps is plenty.
+    uint32_t refreshPeriodMs() const override { return 50; }
+    // Boot-only / rarely visited: give the LVGL memory back while hidden.
+    ScreenRetention retention() const override {
+        return SCREEN_RECLAIM_EPHEMERAL ? ScreenRetention::Ephemeral : ScreenRetention::KeepWarm;
+    }
     
     // Update status text (e.g., "Initializing WiFi...")
     void setStatus(const char* text);
@@ -0,0 +1,104 @@
+#include "status_panel_screen.h"
+
+#include "../energy_monitor.h"
+#include "../energy_thresholds.h"
+#include "../energy_alarm.h"
+
+#include <math.h>
+#include <string.h>
+
+static const char* const kStatusRowNames[3] = {"SOLAR", "HOME", "GRID"};
+
+void StatusPanelScreen::create() {
+    if (screen) return;
+
+    // Created while the secondary display is LVGL's default (see DisplayManager).
+    screen = lv_obj_create(NULL);
+    lv_obj_set_style_bg_color(screen, lv_color_black(), 0);
+    lv_obj_clear_flag(screen, LV_OBJ_FLAG_SCROLLABLE);
+
+    const lv_coord_t row_h = lv_disp_get_ver_res(lv_obj_get_disp(screen)) / 3;
+    for (size_t i = 0; i < 3; i++) {
+        Row& row = rows[i];
+        const lv_coord_t mid = (lv_coord_t)(row_h * (lv_coord_t)i + row_h / 2);
+
+        row.name = lv_label_create(screen);
+        lv_label_set_text(row.name, kStatusRowNames[i]);
+        lv_obj_set_style_text_font(row.name, &lv_font_montserrat_14, 0);
+        lv_obj_set_style_text_color(row.name, lv_color_make(0x99, 0x99, 0x99), 0);
+        lv_obj_align(row.name, LV_ALIGN_TOP_MID, 0, mid - 24);
+
+        row.value = lv_label_create(screen);
+        lv_label_set_text(row.value, "-- kW");
+        lv_obj_set_style_text_font(row.value, &lv_font_montserrat_24, 0);
+        lv_obj_set_style_text_color(row.value, lv_color_white(), 0);
+        lv_obj_align(row.value, LV_ALIGN_TOP_MID, 0, mid - 6);
+
+        strcpy(row.text, "--");
+        row.color = lv_color_white();
+        row.colorValid = true;
+    }
+    rendered = false;
+}
+
+void StatusPanelScreen::destroy() {
+    if (!screen) return;
+    lv_obj_del(screen);
+    screen = nullptr;
+    for (Row& row : rows) {
+        row = {};
+    }
+    rendered = false;
+}
+
+void StatusPanelScreen::show() {
+    if (screen) lv_scr_load(screen);  // loads on the screen's own display
+}
+
+void StatusPanelScreen::hide() {
+}
+
+void StatusPanelScreen::setRow(Row& row, float kw, lv_color_t color) {
+    char buf[16];
+    if (isnan(kw)) {
+        strcpy(buf, "--");
+    } else {
+        snprintf(buf, sizeof(buf), "%.2f", (double)kw);
+    }
+    if (strcmp(buf, row.text) != 0) {
+        lv_label_set_text_fmt(row.value, "%s kW", buf);
+        strlcpy(row.text, buf, sizeof(row.text));
+    }
+    if (!row.colorValid || row.color.full != color.full) {
+        lv_obj_set_style_text_color(row.value, color, 0);
+        row.color = color;
+        row.colorValid = true;
+    }
+}
+
+void StatusPanelScreen::update() {
+    if (!screen) return;
+
+    const EnergyMonitorState st = energy_monitor_get_state();
+    const EnergyRuleSet* rules = energy_thresholds_get();
+    const EnergyAlarmState alarm = energy_alarm_get_state();
+    if (rendered && st.generation == lastStateGeneration && rules->generation == lastRulesGeneration &&
+        alarm.eval_seq == lastAlarmEvalSeq) {
+        return;
+    }
+    lastStateGeneration = st.generation;
+    lastRulesGeneration = rules->generation;
+    lastAlarmEvalSeq = alarm.eval_seq;
+    rendered = true;
+
+    const float solar_kw = st.value[ENERGY_CHANNEL_SOLAR];
+    const float grid_kw = st.value[ENERGY_CHANNEL_GRID];
+    const float home_kw = (!isnan(solar_kw) && !isnan(grid_kw)) ? solar_kw + grid_kw : NAN;
+    const float kw[3] = {solar_kw, home_kw, grid_kw};
+    const EnergyCategory cat[3] = {EnergyCategory::Solar, EnergyCategory::Home, EnergyCategory::Grid};
+
+    for (size_t i = 0; i < 3; i++) {
+        const EnergyCategoryRules& r = rules->category[(size_t)cat[i]];
+        setRow(rows[i], kw[i], r.tier_color[(size_t)alarm.tier[(size_t)cat[i]]]);
+    }
+}
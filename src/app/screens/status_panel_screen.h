@@ -0,0 +1,51 @@
+#ifndef STATUS_PANEL_SCREEN_H
+#define STATUS_PANEL_SCREEN_H
+
+#include "screen.h"
+#include "../board_config.h"
+#include <lvgl.h>
+
+// ============================================================================
+// Status Panel Screen
+// ============================================================================
+// Compact solar / home / grid readout for the optional secondary panel
+// (SECONDARY_DISPLAY_DRIVER). DisplayManager creates it on that panel's LVGL
+// display and updates it from the shared render task; it is never part of the
+// main panel's navigation. Labels are only touched when their text or tier
+// color changes, so an idle panel flushes nothing.
+
+class StatusPanelScreen : public Screen {
+private:
+    lv_obj_t* screen = nullptr;
+
+    struct Row {
+        lv_obj_t* name;
+        lv_obj_t* value;
+        char text[16];
+        lv_color_t color;
+        bool colorValid;
+    };
+    Row rows[3] = {};
+
+    uint32_t lastStateGeneration = 0;
+    uint32_t lastRulesGeneration = 0;
+    uint32_t lastAlarmEvalSeq = 0;
+    bool rendered = false;
+
+    void setRow(Row& row, float kw, lv_color_t color);
+
+public:
+    StatusPanelScreen() = default;
+    ~StatusPanelScreen() { destroy(); }
+
+    void create() override;
+    void destroy() override;
+    void show() override;
+    void hide() override;
+    void update() override;
+
+    uint32_t refreshPeriodMs() const override { return SECONDARY_DISPLAY_REFRESH_MS; }
+    ScreenRetention retention() const override { return ScreenRetention::Pinned; }
+};
+
+#endif // STATUS_PANEL_SCREEN_H
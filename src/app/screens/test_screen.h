@@ -2,6 +2,7 @@
 #define TEST_SCREEN_H
 
 #include "screen.h"
+#include "../board_config.h"
 #include <lvgl.h>
 
 // Forward declaration
@@ -41,6 +42,13 @@ public:
     void show() override;
     void hide() override;
     void update() override;
+
+    // Static test patterns.
+    uint32_t refreshPeriodMs() const override { return 100; }
+    // Rarely visited: give the LVGL memory back while hidden.
+    ScreenRetention retention() const override {
+        return SCREEN_RECLAIM_EPHEMERAL ? ScreenRetention::Ephemeral : ScreenRetention::KeepWarm;
+    }
 };
 
 #endif // TEST_SCREEN_H
@@ -0,0 +1,297 @@
+#include "screenshot.h"
+
+#if SCREENSHOT_SUPPORTED
+
+#include "app_alloc.h"
+#include "display_manager.h"
+#include "log_manager.h"
+#include "web_portal_json.h"
+
+#include <Arduino.h>
+#include <ESPAsyncWebServer.h>
+#include <lvgl.h>
+#include <memory>
+#include <new>
+#include <string.h>
+
+static_assert(SCREENSHOT_BAND_ROWS >= 1 && SCREENSHOT_BAND_ROWS <= 128, "SCREENSHOT_BAND_ROWS must be 1..128");
+
+namespace {
+
+enum BandState : uint8_t {
+    kBandIdle = 0,
+    kBandRequested = 1,  // filler -> LVGL task
+    kBandReady = 2,      // LVGL task -> filler
+};
+
+// 14-byte file header + 40-byte BITMAPINFOHEADER + 3 BI_BITFIELDS masks (RGB565).
+static constexpr size_t kBmpHeaderBytes = 14 + 40 + 12;
+static constexpr unsigned long kBandTimeoutMs = 2000;  // give up when the LVGL task stops servicing
+
+struct ScreenshotSession {
+    uint16_t width = 0;
+    uint16_t height = 0;
+    uint32_t row_bytes = 0;  // width * 2 padded to 4
+    lv_color_t* band = nullptr;
+
+    // Band handshake (atomic): the filler writes band_y0/band_rows and then raises
+    // kBandRequested; the LVGL task renders and publishes kBandReady.
+    uint8_t state = kBandIdle;
+    uint16_t band_y0 = 0;
+    uint16_t band_rows = 0;
+    bool band_failed = false;
+
+    // Filler cursor.
+    uint8_t header[kBmpHeaderBytes];
+    size_t header_sent = 0;
+    uint32_t row = 0;         // next row to emit
+    uint32_t row_offset = 0;  // bytes of that row already emitted
+    unsigned long wait_start_ms = 0;
+
+    ~ScreenshotSession() {
+        if (band) app_free(AllocTag::Other, band);
+    }
+};
+
+// The response owns the session; this is only a weak handle for the LVGL task and
+// the busy check. Whichever side drops the last strong reference frees the band.
+static std::weak_ptr<ScreenshotSession> g_active;
+static portMUX_TYPE g_mux = portMUX_INITIALIZER_UNLOCKED;
+static uint8_t g_band_pending = 0;  // fast path for screenshot_service() (atomic)
+
+static bool (*g_auth_gate)(AsyncWebServerRequest* request) = nullptr;
+
+static void put_le16(uint8_t* p, uint16_t v) {
+    p[0] = (uint8_t)(v & 0xFF);
+    p[1] = (uint8_t)(v >> 8);
+}
+
+static void put_le32(uint8_t* p, uint32_t v) {
+    p[0] = (uint8_t)(v & 0xFF);
+    p[1] = (uint8_t)((v >> 8) & 0xFF);
+    p[2] = (uint8_t)((v >> 16) & 0xFF);
+    p[3] = (uint8_t)(v >> 24);
+}
+
+static void build_header(ScreenshotSession* s) {
+    uint8_t* h = s->header;
+    memset(h, 0, kBmpHeaderBytes);
+    const uint32_t image_bytes = s->row_bytes * s->height;
+
+    h[0] = 'B';
+    h[1] = 'M';
+    put_le32(h + 2, (uint32_t)kBmpHeaderBytes + image_bytes);
+    put_le32(h + 10, (uint32_t)kBmpHeaderBytes);
+
+    put_le32(h + 14, 40);
+    put_le32(h + 18, s->width);
+    put_le32(h + 22, (uint32_t)(-(int32_t)s->height));  // negative: top-down rows
+    put_le16(h + 26, 1);
+    put_le16(h + 28, 16);
+    put_le32(h + 30, 3);  // BI_BITFIELDS
+    put_le32(h + 34, image_bytes);
+    put_le32(h + 38, 2835);  // 72 DPI
+    put_le32(h + 42, 2835);
+
+    put_le32(h + 54, 0xF800);
+    put_le32(h + 58, 0x07E0);
+    put_le32(h + 62, 0x001F);
+}
+
+static inline uint16_t pixel_rgb565(lv_color_t c) {
+#if LV_COLOR_DEPTH == 16 && LV_COLOR_16_SWAP
+    const uint16_t v = c.full;
+    return (uint16_t)((v << 8) | (v >> 8));
+#else
+    return lv_color_to16(c);
+#endif
+}
+
+// Redraw the band area of the active screen into s->band, the same way
+// lv_snapshot does: a throwaway display whose draw context targets the band.
+static bool render_band(ScreenshotSession* s) {
+    lv_disp_t* disp = lv_disp_get_default();
+    if (!disp || !disp->driver || !disp->driver->draw_ctx_init || disp->driver->draw_ctx_size == 0) return false;
+
+    lv_area_t area;
+    area.x1 = 0;
+    area.x2 = (lv_coord_t)(s->width - 1);
+    area.y1 = (lv_coord_t)s->band_y0;
+    area.y2 = (lv_coord_t)(s->band_y0 + s->band_rows - 1);
+
+    lv_draw_ctx_t* draw_ctx = (lv_draw_ctx_t*)lv_mem_alloc(disp->driver->draw_ctx_size);
+    if (!draw_ctx) return false;
+
+    lv_disp_drv_t drv;
+    lv_disp_drv_init(&drv);
+    drv.hor_res = disp->driver->hor_res;
+    drv.ver_res = disp->driver->ver_res;
+
+    lv_disp_t fake_disp;
+    lv_memset_00(&fake_disp, sizeof(fake_disp));
+    fake_disp.driver = &drv;
+
+    disp->driver->draw_ctx_init(&drv, draw_ctx);
+    drv.draw_ctx = draw_ctx;
+    draw_ctx->buf = (void*)s->band;
+    draw_ctx->buf_area = &area;
+    draw_ctx->clip_area = &area;
+
+    // Transparent screens show the display background; render that as black.
+    memset(s->band, 0, (size_t)s->width * s->band_rows * sizeof(lv_color_t));
+
+    lv_disp_t* refr_orig = _lv_refr_get_disp_refreshing();
+    _lv_refr_set_disp_refreshing(&fake_disp);
+    lv_obj_t* scr = lv_disp_get_scr_act(disp);
+    if (scr) lv_obj_redraw(draw_ctx, scr);
+    lv_obj_redraw(draw_ctx, lv_disp_get_layer_top(disp));
+    _lv_refr_set_disp_refreshing(refr_orig);
+
+    if (disp->driver->draw_ctx_deinit) disp->driver->draw_ctx_deinit(&drv, draw_ctx);
+    lv_mem_free(draw_ctx);
+    return true;
+}
+
+static void request_band(ScreenshotSession* s, uint32_t y0) {
+    const uint32_t rows = s->height - y0;
+    s->band_y0 = (uint16_t)y0;
+    s->band_rows = (uint16_t)(rows < SCREENSHOT_BAND_ROWS ? rows : SCREENSHOT_BAND_ROWS);
+    s->wait_start_ms = millis();
+    __atomic_store_n(&s->state, (uint8_t)kBandRequested, __ATOMIC_RELEASE);
+    __atomic_store_n(&g_band_pending, (uint8_t)1, __ATOMIC_RELEASE);
+    display_manager_request_render();
+}
+
+static size_t stream_fill(ScreenshotSession* s, uint8_t* buffer, size_t max_len) {
+    size_t out = 0;
+
+    if (s->header_sent < kBmpHeaderBytes) {
+        size_t n = kBmpHeaderBytes - s->header_sent;
+        if (n > max_len) n = max_len;
+        memcpy(buffer, s->header + s->header_sent, n);
+        s->header_sent += n;
+        out += n;
+    }
+
+    const uint32_t pixel_bytes = (uint32_t)s->width * 2;
+    while (out < max_len && s->row < s->height) {
+        const uint8_t state = __atomic_load_n(&s->state, __ATOMIC_ACQUIRE);
+        if (state == kBandReady && s->band_failed) {
+            if (out == 0) LOGW("Screenshot", "Band render failed at row %u", (unsigned)s->row);
+            return out;  // a later call returns 0 and ends the (truncated) response
+        }
+        const bool in_band = (state == kBandReady) &&
+                             s->row >= s->band_y0 && s->row < (uint32_t)s->band_y0 + s->band_rows;
+        if (!in_band) {
+            if (state != kBandRequested) {
+                request_band(s, s->row);
+            } else if (millis() - s->wait_start_ms > kBandTimeoutMs) {
+                LOGW("Screenshot", "LVGL task did not render row %u, aborting", (unsigned)s->row);
+                return out;
+            }
+            break;
+        }
+
+        const lv_color_t* px = s->band + (size_t)(s->row - s->band_y0) * s->width;
+        while (out < max_len && s->row_offset < s->row_bytes) {
+            const uint32_t b = s->row_offset;
+            uint8_t v = 0;
+            if (b < pixel_bytes) {
+                const uint16_t c = pixel_rgb565(px[b >> 1]);
+                v = (b & 1) ? (uint8_t)(c >> 8) : (uint8_t)(c & 0xFF);
+            }
+            buffer[out++] = v;
+            s->row_offset++;
+        }
+        if (s->row_offset == s->row_bytes) {
+            s->row_offset = 0;
+            s->row++;
+        }
+    }
+
+    if (out == 0 && s->row < s->height) return RESPONSE_TRY_AGAIN;
+    return out;
+}
+
+static void handleScreenshot(AsyncWebServerRequest* request) {
+    if (g_auth_gate && !g_auth_gate(request)) return;
+    if (display_manager_is_render_suspended()) {
+        web_portal_send_json_error(request, 503, "Display rendering is suspended");
+        return;
+    }
+
+    lv_disp_t* disp = lv_disp_get_default();
+    if (!disp) {
+        web_portal_send_json_error(request, 503, "Display not initialized");
+        return;
+    }
+
+    std::shared_ptr<ScreenshotSession> s(new (std::nothrow) ScreenshotSession());
+    if (!s) {
+        web_portal_send_json_error(request, 503, "Out of memory");
+        return;
+    }
+    s->width = (uint16_t)lv_disp_get_hor_res(disp);
+    s->height = (uint16_t)lv_disp_get_ver_res(disp);
+    s->row_bytes = ((uint32_t)s->width * 2 + 3) & ~3u;
+    s->band = (lv_color_t*)app_alloc(AllocTag::Other,
+                                     (size_t)s->width * SCREENSHOT_BAND_ROWS * sizeof(lv_color_t),
+                                     AllocPolicy::PreferPsram);
+    if (!s->band) {
+        web_portal_send_json_error(request, 503, "Out of memory");
+        return;
+    }
+    build_header(s.get());
+
+    // Claim the single slot. The previous (expired) handle is released outside the
+    // critical section since dropping it may free its control block.
+    std::weak_ptr<ScreenshotSession> previous;
+    bool busy;
+    portENTER_CRITICAL(&g_mux);
+    busy = !g_active.expired();
+    if (!busy) {
+        previous.swap(g_active);
+        g_active = s;
+    }
+    portEXIT_CRITICAL(&g_mux);
+    if (busy) {
+        web_portal_send_json_error(request, 409, "Screenshot already in progress");
+        return;
+    }
+
+    AsyncWebServerResponse* response = request->beginChunkedResponse(
+        "image/bmp",
+        [s](uint8_t* buffer, size_t max_len, size_t) -> size_t {
+            return stream_fill(s.get(), buffer, max_len);
+        }
+    );
+    response->addHeader("Cache-Control", "no-store");
+    response->addHeader("Content-Disposition", "inline; filename=\"screenshot.bmp\"");
+    request->send(response);
+}
+
+} // namespace
+
+void screenshot_service() {
+    if (!__atomic_load_n(&g_band_pending, __ATOMIC_ACQUIRE)) return;
+    __atomic_store_n(&g_band_pending, (uint8_t)0, __ATOMIC_RELEASE);
+
+    std::weak_ptr<ScreenshotSession> handle;
+    portENTER_CRITICAL(&g_mux);
+    handle = g_active;
+    portEXIT_CRITICAL(&g_mux);
+
+    std::shared_ptr<ScreenshotSession> s = handle.lock();
+    if (!s || __atomic_load_n(&s->state, __ATOMIC_ACQUIRE) != kBandRequested) return;
+
+    s->band_failed = !render_band(s.get());
+    __atomic_store_n(&s->state, (uint8_t)kBandReady, __ATOMIC_RELEASE);
+}
+
+void screenshot_register_routes(AsyncWebServer* server, bool (*auth_gate)(AsyncWebServerRequest* request)) {
+    if (!server) return;
+    g_auth_gate = auth_gate;
+    server->on("/api/display/screenshot", HTTP_GET, handleScreenshot);
+}
+
+#endif // SCREENSHOT_SUPPORTED
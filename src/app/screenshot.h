@@ -0,0 +1,39 @@
+/*
+ * Display Screenshot (streamed BMP)
+ *
+ * Re-renders the active LVGL screen (plus the top layer) band by band into a
+ * small buffer and streams it as a 16-bit top-down BMP, so memory use is one band
+ * (width x SCREENSHOT_BAND_ROWS pixels) regardless of the panel size and no full
+ * framebuffer copy is ever made. Bands are rendered by the LVGL task (under the
+ * display lock, between frames) when the AsyncTCP filler asks for the next one;
+ * the panel itself is not touched.
+ *
+ * Endpoints:
+ *   GET /api/display/screenshot   - image/bmp of the current screen (one client at a time)
+ *
+ * Content pushed around LVGL (DirectImageScreen strips) is not part of the widget
+ * tree and shows up black.
+ */
+
+#pragma once
+
+#include "board_config.h"
+
+#if HAS_DISPLAY && SCREENSHOT_ENABLED
+
+#define SCREENSHOT_SUPPORTED 1
+
+class AsyncWebServer;
+class AsyncWebServerRequest;
+
+// Render a pending band, if any (LVGL task only, display lock held).
+void screenshot_service();
+
+// auth_gate: same contract as image_api_register_routes().
+void screenshot_register_routes(AsyncWebServer* server, bool (*auth_gate)(AsyncWebServerRequest* request) = nullptr);
+
+#else
+
+#define SCREENSHOT_SUPPORTED 0
+
+#endif
@@ -2,7 +2,7 @@
  * Strip Decoder Implementation
  * 
  * Decodes JPEG strips using TJpgDec and writes directly to LCD via DisplayDriver.
- * Performs RGB→BGR color swap during pixel write.
+ * Pixel conversion is specialized per panel format (see DisplayDriver::colorOrder()).
  */
 #include "board_config.h"
 
@@ -11,9 +11,22 @@
 #include "strip_decoder.h"
 #include "display_driver.h"
 #include "log_manager.h"
+#include "rgb565_convert.h"
+#include "jpeg_hw_decoder.h"
+#include "trace_ring.h"
+#include "decode_slice.h"
 
 #include <esp_heap_caps.h>
 
+// Pair decode needs a second core; a hardware codec already outruns two TJpgDec cores.
+#if IMAGE_STRIP_PARALLEL_DECODE && !CONFIG_FREERTOS_UNICORE && !JPEG_HW_DECODER_SUPPORTED
+    #define STRIP_PARALLEL_SUPPORTED 1
+    #include "task_placement.h"
+    #include <freertos/semphr.h>
+#else
+    #define STRIP_PARALLEL_SUPPORTED 0
+#endif
+
 // Use the ESP-ROM TJpgDec types/signatures. This matches the ROM-provided jd_prepare/jd_decomp
 // symbols used by the ESP32 Arduino core.
 //
@@ -79,31 +92,90 @@
 #endif
 
 
-// Input buffer context for TJpgDec
+// Input context for TJpgDec: either an in-memory JPEG or a pull reader.
 struct JpegInputContext {
     const uint8_t* data;
     size_t size;
     size_t pos;
+
+    StripDecoderReadFn read;  // non-null = streaming source (data/size unused)
+    void* read_ctx;
 };
 
 // Output context for TJpgDec
 struct JpegOutputContext {
     StripDecoder* decoder;
     DisplayDriver* driver;
+    int strip_x_offset;
     int strip_y_offset;
     uint16_t* line_buffer;  // Buffer for one line of pixels
     int buffer_width;
     int lcd_width;
     int lcd_height;
-    bool output_bgr565;     // true=BGR565, false=RGB565
+
+    // RGB888 -> RGB565/BGR565 kernel specialized for the panel's pixel format,
+    // selected once per strip so the per-pixel loop has no branches.
+    void (*convert)(const uint8_t* src, uint16_t* dst, int count);
+    bool swap_on_push;      // false when convert() already packs wire-order pixels
 
     // Optional batch buffer to reduce LCD transactions.
     // Holds a small rectangle (typically 8-16 rows) of converted RGB565 pixels.
     uint16_t* batch_buffer;
     int batch_capacity_pixels;
     int batch_max_rows;
+
+    // Ping-pong mode: rects alternate between batch_buffer and batch_buffer_alt and
+    // go out via pushColorsAsync(), so TJpgDec decodes the next MCU row while the
+    // previous one is still on the bus. async_open tracks an unfinished transfer.
+    uint16_t* batch_buffer_alt;
+    bool use_alt;
+    bool async_open;
+
+    DecodeSlicer* slicer;   // yields to other tasks once per time slice
+
+    // Per-decode path counters, folded into the StripDecoder session afterwards.
+    uint32_t async_rects;
+    uint32_t batch_rects;
+    uint32_t line_rows;
+    uint32_t push_us;
 };
 
+// Finish any in-flight ping-pong transfer before a blocking write or the end of decode.
+static void finish_async_push(JpegOutputContext* ctx) {
+    if (ctx->async_open) {
+        const int64_t t0 = esp_timer_get_time();
+        ctx->driver->endAsyncFlush();
+        ctx->push_us += (uint32_t)(esp_timer_get_time() - t0);
+        ctx->async_open = false;
+    }
+}
+
+static StripDecodeStats s_decode_stats = {};
+static portMUX_TYPE s_decode_stats_mux = portMUX_INITIALIZER_UNLOCKED;
+
+static void add_session(StripDecodeSession& sum, const StripDecodeSession& s) {
+    sum.strips += s.strips;
+    sum.failed += s.failed;
+    sum.bytes_in += s.bytes_in;
+    sum.pixels_out += s.pixels_out;
+    sum.decode_us += s.decode_us;
+    sum.push_us += s.push_us;
+    sum.yields += s.yields;
+    sum.async_rects += s.async_rects;
+    sum.batch_rects += s.batch_rects;
+    sum.line_rows += s.line_rows;
+    sum.hw_strips += s.hw_strips;
+    sum.batch_rows = s.batch_rows;
+    sum.pingpong = s.pingpong;
+}
+
+void strip_decoder_get_stats(StripDecodeStats* out) {
+    if (!out) return;
+    portENTER_CRITICAL(&s_decode_stats_mux);
+    *out = s_decode_stats;
+    portEXIT_CRITICAL(&s_decode_stats_mux);
+}
+
 // TJpgDec uses a single opaque device pointer for the entire decode session.
 // Both the input function and output function must be able to access their
 // respective state through the same pointer.
@@ -119,6 +191,11 @@ static UINT jpeg_input_func(JDEC* jd, BYTE* buff, UINT nbyte) {
     if (!session) return 0;
 
     JpegInputContext* ctx = &session->input;
+    if (ctx->read) {
+        const size_t n = ctx->read(ctx->read_ctx, buff, (size_t)nbyte);
+        ctx->pos += n;
+        return (UINT)n;
+    }
     if (!ctx->data) return 0;
     if (ctx->pos >= ctx->size) return 0;
 
@@ -155,7 +232,7 @@ static UINT jpeg_output_func(JDEC* jd, void* bitmap, JRECT* rect) {
     }
 
     // Target LCD coordinates for the whole rect
-    const int lcd_x = rect->left;
+    const int lcd_x = ctx->strip_x_offset + rect->left;
     const int lcd_y = ctx->strip_y_offset + rect->top;
     if (lcd_x < 0 || lcd_y < 0 || lcd_x + rect_w > ctx->lcd_width || lcd_y + rect_h > ctx->lcd_height) {
         LOGE("STRIPDEC", "Invalid LCD rect: x=%d y=%d w=%d h=%d (LCD: %dx%d)",
@@ -169,61 +246,58 @@ static UINT jpeg_output_func(JDEC* jd, void* bitmap, JRECT* rect) {
                            (rect_h <= ctx->batch_max_rows) &&
                            (rect_pixels <= ctx->batch_capacity_pixels);
 
+    if (can_batch && ctx->batch_buffer_alt) {
+        // Convert into the idle buffer; pushColorsAsync() waits for the transfer still
+        // reading the other one, so at most one rect is in flight at a time.
+        uint16_t* dst = ctx->use_alt ? ctx->batch_buffer_alt : ctx->batch_buffer;
+        ctx->use_alt = !ctx->use_alt;
+        ctx->convert(src, dst, rect_pixels);
+        const int64_t t0 = esp_timer_get_time();
+        ctx->driver->pushColorsAsync(lcd_x, lcd_y, rect_w, rect_h, dst, ctx->swap_on_push);
+        ctx->push_us += (uint32_t)(esp_timer_get_time() - t0);
+        ctx->async_open = true;
+        ctx->async_rects++;
+        ctx->slicer->checkpoint((uint32_t)rect_h);
+
+        return 1;
+    }
+
+    // Blocking writes below must not overlap a queued DMA transfer.
+    finish_async_push(ctx);
+
     if (can_batch) {
-        // Convert entire rect into contiguous RGB565 pixels
+        // Convert entire rect into contiguous 16-bit pixels (rect rows are contiguous in src)
         uint16_t* dst = ctx->batch_buffer;
-        for (int row = 0; row < rect_h; row++) {
-            for (int col = 0; col < rect_w; col++) {
-                uint8_t r = *src++;
-                uint8_t g = *src++;
-                uint8_t b = *src++;
-
-                if (ctx->output_bgr565) {
-                    dst[row * rect_w + col] = ((b & 0xF8) << 8) | ((g & 0xFC) << 3) | (r >> 3);
-                } else {
-                    dst[row * rect_w + col] = ((r & 0xF8) << 8) | ((g & 0xFC) << 3) | (b >> 3);
-                }
-            }
-        }
+        ctx->convert(src, dst, rect_pixels);
 
         // Single LCD transaction for the whole rect
+        const int64_t t0 = esp_timer_get_time();
         ctx->driver->startWrite();
         ctx->driver->setAddrWindow(lcd_x, lcd_y, rect_w, rect_h);
-        ctx->driver->pushColors(dst, rect_pixels, true);
+        ctx->driver->pushColors(dst, rect_pixels, ctx->swap_on_push);
         ctx->driver->endWrite();
-
-        // Yield periodically to prevent watchdog timeouts.
-        if ((lcd_y & 0x03) == 0) {
-            taskYIELD();
-        }
+        ctx->push_us += (uint32_t)(esp_timer_get_time() - t0);
+        ctx->batch_rects++;
+        ctx->slicer->checkpoint((uint32_t)rect_h);
 
         return 1;
     }
 
     // Fallback: process each line (higher overhead but lower RAM).
     for (int y = rect->top; y <= rect->bottom; y++) {
-        // Convert RGB888 to BGR565 or RGB565 for this line
-        for (int x = 0; x < rect_w; x++) {
-            uint8_t r = *src++;
-            uint8_t g = *src++;
-            uint8_t b = *src++;
-
-            if (ctx->output_bgr565) {
-                ctx->line_buffer[x] = ((b & 0xF8) << 8) | ((g & 0xFC) << 3) | (r >> 3);
-            } else {
-                ctx->line_buffer[x] = ((r & 0xF8) << 8) | ((g & 0xFC) << 3) | (b >> 3);
-            }
-        }
+        // Convert RGB888 to the panel's 16-bit format for this line
+        ctx->convert(src, ctx->line_buffer, rect_w);
+        src += rect_w * 3;
 
         const int line_lcd_y = ctx->strip_y_offset + y;
+        const int64_t t0 = esp_timer_get_time();
         ctx->driver->startWrite();
         ctx->driver->setAddrWindow(lcd_x, line_lcd_y, rect_w, 1);
-        ctx->driver->pushColors(ctx->line_buffer, rect_w, true);
+        ctx->driver->pushColors(ctx->line_buffer, rect_w, ctx->swap_on_push);
         ctx->driver->endWrite();
-
-        if ((line_lcd_y & 0x03) == 0) {
-            taskYIELD();
-        }
+        ctx->push_us += (uint32_t)(esp_timer_get_time() - t0);
+        ctx->line_rows++;
+        ctx->slicer->checkpoint(1);
     }
     
     return 1;  // Continue decoding
@@ -232,6 +306,103 @@ static UINT jpeg_output_func(JDEC* jd, void* bitmap, JRECT* rect) {
 // TJpgDec work buffer size (recommended minimum)
 static const size_t TJPGD_WORK_BUFFER_SIZE = 4096;
 
+#if STRIP_PARALLEL_SUPPORTED
+// Helper-core target: TJpgDec output lands in a RAM band instead of on the panel.
+struct JpegBandContext {
+    JpegSessionContext session;  // first member: jpeg_input_func() reads session.input
+    uint16_t* band;
+    int band_width;
+    int band_rows;
+    void (*convert)(const uint8_t* src, uint16_t* dst, int count);
+};
+
+static UINT jpeg_band_output_func(JDEC* jd, void* bitmap, JRECT* rect) {
+    JpegBandContext* ctx = (JpegBandContext*)jd->device;
+    if (!ctx || rect->right >= ctx->band_width || rect->bottom >= ctx->band_rows) {
+        return 0;
+    }
+    const int rect_w = rect->right - rect->left + 1;
+    const uint8_t* src = (const uint8_t*)bitmap;
+    for (int y = rect->top; y <= rect->bottom; y++) {
+        ctx->convert(src, ctx->band + (size_t)y * ctx->band_width + rect->left, rect_w);
+        src += rect_w * 3;
+    }
+    return 1;
+}
+
+// One job at a time: the loop task posts `next`, decodes `first` itself, then waits.
+struct StripParallelJob {
+    const uint8_t* data;
+    size_t size;
+    uint16_t* band;
+    int band_width;
+    int band_rows;
+    void (*convert)(const uint8_t* src, uint16_t* dst, int count);
+    bool ok;      // results, valid once done_sem is given
+    int width;
+    int height;
+};
+
+static TaskHandle_t s_parallel_task = nullptr;
+static SemaphoreHandle_t s_parallel_job_sem = nullptr;
+static SemaphoreHandle_t s_parallel_done_sem = nullptr;
+static StripParallelJob s_parallel_job = {};
+static void* s_parallel_work = nullptr;  // helper's own TJpgDec work area
+static bool s_parallel_failed = false;   // setup failed once: stay sequential
+
+static void strip_parallel_task(void*) {
+    for (;;) {
+        xSemaphoreTake(s_parallel_job_sem, portMAX_DELAY);
+        StripParallelJob& job = s_parallel_job;
+
+        JpegBandContext ctx;
+        memset(&ctx, 0, sizeof(ctx));
+        ctx.session.input.data = job.data;
+        ctx.session.input.size = job.size;
+        ctx.band = job.band;
+        ctx.band_width = job.band_width;
+        ctx.band_rows = job.band_rows;
+        ctx.convert = job.convert;
+
+        JDEC jdec;
+        job.ok = false;
+        if (jd_prepare(&jdec, jpeg_input_func, s_parallel_work, (UINT)TJPGD_WORK_BUFFER_SIZE, &ctx) == JDR_OK &&
+            (int)jdec.width <= job.band_width && (int)jdec.height <= job.band_rows) {
+            job.width = (int)jdec.width;
+            job.height = (int)jdec.height;
+            job.ok = jd_decomp(&jdec, jpeg_band_output_func, 0) == JDR_OK;
+        }
+        xSemaphoreGive(s_parallel_done_sem);
+    }
+}
+
+// The helper task and its work area are created on first use and kept for the uptime.
+static bool strip_parallel_start() {
+    if (s_parallel_task) return true;
+    if (s_parallel_failed) return false;
+
+    s_parallel_work = heap_caps_malloc(TJPGD_WORK_BUFFER_SIZE, MALLOC_CAP_INTERNAL | MALLOC_CAP_8BIT);
+    s_parallel_job_sem = xSemaphoreCreateBinary();
+    s_parallel_done_sem = xSemaphoreCreateBinary();
+    if (s_parallel_work && s_parallel_job_sem && s_parallel_done_sem &&
+        task_placement_create(AppTask::StripDecode, strip_parallel_task, nullptr, &s_parallel_task, nullptr)) {
+        LOGI("STRIPDEC", "Parallel strip decode on core %d", (int)task_placement_get(AppTask::StripDecode)->core);
+        return true;
+    }
+
+    LOGW("STRIPDEC", "Parallel strip decode unavailable; decoding strips sequentially");
+    if (s_parallel_work) heap_caps_free(s_parallel_work);
+    if (s_parallel_job_sem) vSemaphoreDelete(s_parallel_job_sem);
+    if (s_parallel_done_sem) vSemaphoreDelete(s_parallel_done_sem);
+    s_parallel_work = nullptr;
+    s_parallel_job_sem = nullptr;
+    s_parallel_done_sem = nullptr;
+    s_parallel_task = nullptr;
+    s_parallel_failed = true;
+    return false;
+}
+#endif // STRIP_PARALLEL_SUPPORTED
+
 StripDecoder::StripDecoder() : driver(nullptr), width(0), height(0), lcd_width(0), lcd_height(0), current_y(0) {
 }
 
@@ -244,6 +415,21 @@ void StripDecoder::setDisplayDriver(DisplayDriver* drv) {
 }
 
 void StripDecoder::free_buffers() {
+    if (band_buffer) {
+        heap_caps_free(band_buffer);
+        band_buffer = nullptr;
+    }
+    band_width = 0;
+
+    if (batch_buffer_alt) {
+        #if defined(ARDUINO_ARCH_ESP32) || defined(ESP32)
+            heap_caps_free(batch_buffer_alt);
+        #else
+            free(batch_buffer_alt);
+        #endif
+        batch_buffer_alt = nullptr;
+    }
+
     if (batch_buffer) {
         #if defined(ARDUINO_ARCH_ESP32) || defined(ESP32)
                 heap_caps_free(batch_buffer);
@@ -264,6 +450,7 @@ void StripDecoder::free_buffers() {
         line_buffer = nullptr;
     }
     line_buffer_width = 0;
+    pingpong_unavailable = false;
 
     if (work_buffer) {
         #if defined(ARDUINO_ARCH_ESP32) || defined(ESP32)
@@ -321,6 +508,14 @@ bool StripDecoder::ensure_buffers() {
     const int desired_rows = (int)IMAGE_STRIP_BATCH_MAX_ROWS;
     if (desired_rows <= 1) {
         // Batching disabled
+        if (batch_buffer_alt) {
+            #if defined(ARDUINO_ARCH_ESP32) || defined(ESP32)
+                heap_caps_free(batch_buffer_alt);
+            #else
+                free(batch_buffer_alt);
+            #endif
+            batch_buffer_alt = nullptr;
+        }
         if (batch_buffer) {
             #if defined(ARDUINO_ARCH_ESP32) || defined(ESP32)
                 heap_caps_free(batch_buffer);
@@ -335,8 +530,20 @@ bool StripDecoder::ensure_buffers() {
     }
 
     const size_t batch_bytes = (size_t)width * (size_t)desired_rows * sizeof(uint16_t);
-    const bool needs_new_batch = (!batch_buffer) || (batch_max_rows != desired_rows) || (batch_capacity_pixels != (width * desired_rows));
+    const bool want_pingpong = IMAGE_STRIP_DMA_PINGPONG && driver && driver->supportsAsyncFlush() &&
+                               !pingpong_unavailable;
+    const bool needs_new_batch = (!batch_buffer) || (batch_max_rows != desired_rows) ||
+                                 (batch_capacity_pixels != (width * desired_rows)) ||
+                                 (want_pingpong != (batch_buffer_alt != nullptr));
     if (needs_new_batch) {
+        if (batch_buffer_alt) {
+            #if defined(ARDUINO_ARCH_ESP32) || defined(ESP32)
+                heap_caps_free(batch_buffer_alt);
+            #else
+                free(batch_buffer_alt);
+            #endif
+            batch_buffer_alt = nullptr;
+        }
         if (batch_buffer) {
             #if defined(ARDUINO_ARCH_ESP32) || defined(ESP32)
                 heap_caps_free(batch_buffer);
@@ -347,8 +554,23 @@ bool StripDecoder::ensure_buffers() {
         }
 
         #if defined(ARDUINO_ARCH_ESP32) || defined(ESP32)
-            // Prefer PSRAM when available to avoid pressuring internal RAM.
-            batch_buffer = (uint16_t*)heap_caps_malloc(batch_bytes, MALLOC_CAP_SPIRAM);
+            if (want_pingpong) {
+                // Both halves are DMA sources, so they must live in DMA-capable internal RAM.
+                batch_buffer = (uint16_t*)heap_caps_malloc(batch_bytes, MALLOC_CAP_DMA | MALLOC_CAP_INTERNAL);
+                batch_buffer_alt = batch_buffer
+                    ? (uint16_t*)heap_caps_malloc(batch_bytes, MALLOC_CAP_DMA | MALLOC_CAP_INTERNAL)
+                    : nullptr;
+                if (!batch_buffer_alt) {
+                    LOGW("STRIPDEC", "Ping-pong DMA buffers unavailable; using blocking batch writes");
+                    pingpong_unavailable = true;  // don't retry every strip this session
+                    heap_caps_free(batch_buffer);
+                    batch_buffer = nullptr;
+                }
+            }
+            if (!batch_buffer) {
+                // Prefer PSRAM when available to avoid pressuring internal RAM.
+                batch_buffer = (uint16_t*)heap_caps_malloc(batch_bytes, MALLOC_CAP_SPIRAM);
+            }
             if (!batch_buffer) {
                 batch_buffer = (uint16_t*)heap_caps_malloc(batch_bytes, MALLOC_CAP_INTERNAL | MALLOC_CAP_8BIT);
             }
@@ -369,21 +591,228 @@ bool StripDecoder::ensure_buffers() {
     return true;
 }
 
-void StripDecoder::begin(int image_width, int image_height, int lcd_w, int lcd_h) {
+bool StripDecoder::ensure_band() {
+    if (band_buffer && band_width == width) {
+        return true;
+    }
+    if (band_buffer) {
+        heap_caps_free(band_buffer);
+        band_buffer = nullptr;
+        band_width = 0;
+    }
+
+    // CPU-only target (no DMA): prefer PSRAM like the blocking batch buffer.
+    const size_t bytes = (size_t)width * (size_t)IMAGE_STRIP_PARALLEL_MAX_ROWS * sizeof(uint16_t);
+    band_buffer = (uint16_t*)heap_caps_malloc(bytes, MALLOC_CAP_SPIRAM);
+    if (!band_buffer) {
+        band_buffer = (uint16_t*)heap_caps_malloc(bytes, MALLOC_CAP_INTERNAL | MALLOC_CAP_8BIT);
+    }
+    if (!band_buffer) {
+        LOGD("STRIPDEC", "No memory for %u-byte decode band", (unsigned)bytes);
+        return false;
+    }
+    band_width = width;
+    return true;
+}
+
+void StripDecoder::begin(int image_width, int image_height, int lcd_w, int lcd_h, int x, int y) {
     width = image_width;
     height = image_height;
     lcd_width = lcd_w;
     lcd_height = lcd_h;
-    current_y = 0;
+    origin_x = x;
+    current_y = y;
     
-    LOGI("STRIPDEC", "Begin decode: %dx%d image on %dx%d LCD", width, height, lcd_width, lcd_height);
+    // Debug level: MJPEG streams begin a session per frame.
+    LOGD("STRIPDEC", "Begin decode: %dx%d image at (%d,%d) on %dx%d LCD", width, height, origin_x, current_y, lcd_width, lcd_height);
 
     // Allocate per-session buffers once and reuse across strips.
     // If allocation fails, decoding will fail early in decode_strip().
     (void)ensure_buffers();
+
+    session = {};
+    session_open = true;
+    session.batch_rows = (uint16_t)batch_max_rows;
+    session.pingpong = batch_buffer_alt != nullptr;
+    portENTER_CRITICAL(&s_decode_stats_mux);
+    s_decode_stats.active = true;
+    s_decode_stats.current = session;
+    portEXIT_CRITICAL(&s_decode_stats_mux);
+}
+
+void StripDecoder::publish_session(int64_t start_us) {
+    session.decode_us += (uint32_t)(esp_timer_get_time() - start_us);
+    // ensure_buffers() may have (re)allocated the batch buffers during the call.
+    session.batch_rows = (uint16_t)batch_max_rows;
+    session.pingpong = batch_buffer_alt != nullptr;
+    portENTER_CRITICAL(&s_decode_stats_mux);
+    s_decode_stats.current = session;
+    portEXIT_CRITICAL(&s_decode_stats_mux);
 }
 
 bool StripDecoder::decode_strip(const uint8_t* jpeg_data, size_t jpeg_size, int strip_index, bool output_bgr565) {
+    (void)strip_index;
+    const int64_t start_us = esp_timer_get_time();
+    const bool ok = decode_common(nullptr, nullptr, jpeg_data, jpeg_size, output_bgr565);
+    publish_session(start_us);
+    return ok;
+}
+
+bool StripDecoder::decode_strip_pair(const uint8_t* first, size_t first_size,
+                                     const uint8_t* next, size_t next_size, bool output_bgr565) {
+    const int64_t start_us = esp_timer_get_time();
+    bool ok = false;
+#if STRIP_PARALLEL_SUPPORTED
+    if (driver && ensure_buffers() && ensure_band() && strip_parallel_start()) {
+        const bool bgr = output_bgr565 || (driver->colorOrder() == DisplayDriver::ColorOrder::BGR);
+        const bool wire_order = driver->acceptsWireOrderPixels();
+
+        StripParallelJob& job = s_parallel_job;
+        job.data = next;
+        job.size = next_size;
+        job.band = band_buffer;
+        job.band_width = band_width;
+        job.band_rows = IMAGE_STRIP_PARALLEL_MAX_ROWS;
+        job.convert = rgb565_select_convert(bgr, wire_order);
+        xSemaphoreGive(s_parallel_job_sem);
+
+        const bool first_ok = decode_common(nullptr, nullptr, first, first_size, output_bgr565);
+        // The band must not be touched (or freed) while the helper still writes it.
+        xSemaphoreTake(s_parallel_done_sem, portMAX_DELAY);
+        if (!first_ok) {
+            ok = false;
+        } else if (job.ok && origin_x + job.width <= lcd_width && current_y + job.height <= lcd_height) {
+            push_rows(band_buffer, job.width, job.height, band_width, !wire_order);
+            current_y += job.height;
+            session.strips++;
+            session.bytes_in += (uint32_t)next_size;
+            ok = true;
+        } else {
+            // Taller than the band or damaged: the regular path decodes it (or reports why).
+            ok = decode_common(nullptr, nullptr, next, next_size, output_bgr565);
+        }
+        publish_session(start_us);
+        return ok;
+    }
+#endif
+    ok = decode_common(nullptr, nullptr, first, first_size, output_bgr565) &&
+         decode_common(nullptr, nullptr, next, next_size, output_bgr565);
+    publish_session(start_us);
+    return ok;
+}
+
+bool StripDecoder::decode_stream(StripDecoderReadFn read, void* read_ctx, bool output_bgr565) {
+    if (!read) return false;
+    const int64_t start_us = esp_timer_get_time();
+    const bool ok = decode_common(read, read_ctx, nullptr, 0, output_bgr565);
+    publish_session(start_us);
+    return ok;
+}
+
+bool StripDecoder::push_rgb565(uint16_t* pixels, int rows, bool output_bgr565) {
+    if (!driver) {
+        LOGE("STRIPDEC", "No display driver set");
+        return false;
+    }
+    const int64_t start_us = esp_timer_get_time();
+    if (!pixels || rows <= 0 || width <= 0 || origin_x + width > lcd_width || current_y + rows > lcd_height) {
+        LOGE("Strip", "RGB565 strip %dx%d does not fit %dx%d at y=%d",
+             width, rows, lcd_width, lcd_height, current_y);
+        session.failed++;
+        publish_session(start_us);
+        return false;
+    }
+
+    const bool bgr = output_bgr565 || (driver->colorOrder() == DisplayDriver::ColorOrder::BGR);
+    const bool wire_order = driver->acceptsWireOrderPixels();
+    const int count = width * rows;
+
+    if (bgr) {
+        // Wire -> CPU order, swap the 5-bit channels, back to what the driver consumes.
+        for (int i = 0; i < count; i++) {
+            uint16_t v = (uint16_t)((pixels[i] << 8) | (pixels[i] >> 8));
+            v = (uint16_t)((v >> 11) | (v & 0x07E0) | (v << 11));
+            pixels[i] = wire_order ? (uint16_t)((v << 8) | (v >> 8)) : v;
+        }
+    } else if (!wire_order) {
+        for (int i = 0; i < count; i++) {
+            pixels[i] = (uint16_t)((pixels[i] << 8) | (pixels[i] >> 8));
+        }
+    }
+
+    push_rows(pixels, width, rows, width, !wire_order);
+    current_y += rows;
+    session.strips++;
+    session.bytes_in += (uint32_t)count * sizeof(uint16_t);
+    publish_session(start_us);
+    return true;
+}
+
+void StripDecoder::push_rows(uint16_t* pixels, int w, int rows, int stride, bool swap_bytes) {
+    // Chunk so the loop task can yield between LCD transactions on tall strips.
+    DecodeSlicer slicer;
+    const int chunk_rows = batch_max_rows > 1 ? batch_max_rows : 16;
+    for (int y = 0; y < rows; y += chunk_rows) {
+        const int n = (rows - y < chunk_rows) ? (rows - y) : chunk_rows;
+        const int64_t t0 = esp_timer_get_time();
+        driver->startWrite();
+        if (stride == w) {
+            driver->setAddrWindow(origin_x, current_y + y, w, n);
+            driver->pushColors(pixels + (size_t)y * stride, (uint32_t)w * n, swap_bytes);
+        } else {
+            for (int r = 0; r < n; r++) {
+                driver->setAddrWindow(origin_x, current_y + y + r, w, 1);
+                driver->pushColors(pixels + (size_t)(y + r) * stride, (uint32_t)w, swap_bytes);
+            }
+        }
+        driver->endWrite();
+        session.push_us += (uint32_t)(esp_timer_get_time() - t0);
+        slicer.checkpoint((uint32_t)n);
+    }
+
+    if (driver->renderMode() == DisplayDriver::RenderMode::Buffered) {
+        driver->present();
+    }
+    session.pixels_out += (uint32_t)w * (uint32_t)rows;
+    session.yields += slicer.sliceCount();
+}
+
+bool StripDecoder::decode_hw(const uint8_t* jpeg_data, size_t jpeg_size, bool bgr) {
+#if JPEG_HW_DECODER_SUPPORTED
+    JpegHwImage img;
+    char err[96];
+    const int max_w = (width < lcd_width - origin_x) ? width : (lcd_width - origin_x);
+    if (!jpeg_hw_decode_rgb565(jpeg_data, jpeg_size, bgr, max_w, lcd_height - current_y, &img, err, sizeof(err))) {
+        LOGD("Strip", "%s; falling back to TJpgDec", err);
+        return false;
+    }
+
+    // The engine emits CPU-order words; wire-order drivers want them byte-swapped once.
+    const bool wire_order = driver->acceptsWireOrderPixels();
+    if (wire_order) {
+        const size_t count = (size_t)img.stride * img.height;
+        for (size_t i = 0; i < count; i++) {
+            img.pixels[i] = (uint16_t)((img.pixels[i] << 8) | (img.pixels[i] >> 8));
+        }
+    }
+    push_rows(img.pixels, img.width, img.height, img.stride, !wire_order);
+    current_y += img.height;
+    jpeg_hw_image_free(&img);
+    session.strips++;
+    session.hw_strips++;
+    session.bytes_in += (uint32_t)jpeg_size;
+    return true;
+#else
+    (void)jpeg_data;
+    (void)jpeg_size;
+    (void)bgr;
+    return false;
+#endif
+}
+
+bool StripDecoder::decode_common(StripDecoderReadFn read, void* read_ctx,
+                                 const uint8_t* jpeg_data, size_t jpeg_size, bool output_bgr565) {
+    TRACE_SCOPE(TraceEvent::StripDecode);
     if (!driver) {
         LOGE("STRIPDEC", "No display driver set");
         return false;
@@ -391,10 +820,17 @@ bool StripDecoder::decode_strip(const uint8_t* jpeg_data, size_t jpeg_size, int
 
     if (!ensure_buffers()) {
         LOGE("STRIPDEC", "Decoder buffers not available");
+        session.failed++;
         return false;
     }
 
-    LOGI("Strip", "Decode start");
+    LOGD("Strip", "Decode start");
+
+    // In-memory strips go to the hardware codec first when the target has one.
+    if (jpeg_data && decode_hw(jpeg_data, jpeg_size,
+                               output_bgr565 || (driver->colorOrder() == DisplayDriver::ColorOrder::BGR))) {
+        return true;
+    }
     
     // Buffers are allocated once per session (begin/end) to reduce heap churn.
     const int kBatchMaxRows = batch_max_rows;
@@ -407,32 +843,69 @@ bool StripDecoder::decode_strip(const uint8_t* jpeg_data, size_t jpeg_size, int
     session_ctx.input.data = jpeg_data;
     session_ctx.input.size = jpeg_size;
     session_ctx.input.pos = 0;
+    session_ctx.input.read = read;
+    session_ctx.input.read_ctx = read_ctx;
 
     session_ctx.output.decoder = this;
     session_ctx.output.driver = driver;
+    session_ctx.output.strip_x_offset = origin_x;
     session_ctx.output.strip_y_offset = current_y;
     session_ctx.output.line_buffer = line_buffer;
     session_ctx.output.buffer_width = width;
     session_ctx.output.lcd_width = lcd_width;
     session_ctx.output.lcd_height = lcd_height;
-    session_ctx.output.output_bgr565 = output_bgr565;
+    const bool bgr = output_bgr565 || (driver->colorOrder() == DisplayDriver::ColorOrder::BGR);
+    const bool wire_order = driver->acceptsWireOrderPixels();
+    session_ctx.output.convert = rgb565_select_convert(bgr, wire_order);
+    session_ctx.output.swap_on_push = !wire_order;
     session_ctx.output.batch_buffer = batch_buffer;
     session_ctx.output.batch_capacity_pixels = batch_buffer ? (width * kBatchMaxRows) : 0;
     session_ctx.output.batch_max_rows = batch_buffer ? kBatchMaxRows : 0;
+    session_ctx.output.batch_buffer_alt = batch_buffer ? batch_buffer_alt : nullptr;
+    session_ctx.output.use_alt = false;
+    session_ctx.output.async_open = false;
+    session_ctx.output.async_rects = 0;
+    session_ctx.output.batch_rects = 0;
+    session_ctx.output.line_rows = 0;
+    session_ctx.output.push_us = 0;
+    DecodeSlicer slicer;
+    session_ctx.output.slicer = &slicer;
     
     // Prepare decoder
     res = jd_prepare(&jdec, jpeg_input_func, work_buffer, (UINT)work_buffer_size, &session_ctx);
     
     if (res != JDR_OK) {
         LOGE("Strip", "jd_prepare failed: %d", res);
+        session.failed++;
+        return false;
+    }
+
+    // Streamed input cannot be re-read: reject oversize frames before any pixel
+    // reaches the panel instead of failing half-way through jpeg_output_func().
+    if (read && ((int)jdec.width > width || origin_x + (int)jdec.width > lcd_width ||
+                 current_y + (int)jdec.height > lcd_height)) {
+        LOGE("Strip", "Streamed JPEG %ux%u does not fit %dx%d at y=%d",
+             (unsigned)jdec.width, (unsigned)jdec.height, lcd_width, lcd_height, current_y);
+        session.failed++;
         return false;
     }
     
     // Decompress and output to LCD
     res = jd_decomp(&jdec, jpeg_output_func, 0);  // 0 = 1:1 scale
+
+    // Drain the last ping-pong transfer so callers may reuse the bus immediately.
+    finish_async_push(&session_ctx.output);
+
+    session.bytes_in += (uint32_t)(jpeg_data ? jpeg_size : session_ctx.input.pos);
+    session.push_us += session_ctx.output.push_us;
+    session.yields += slicer.sliceCount();
+    session.async_rects += session_ctx.output.async_rects;
+    session.batch_rects += session_ctx.output.batch_rects;
+    session.line_rows += session_ctx.output.line_rows;
     
     if (res != JDR_OK) {
         LOGE("Strip", "jd_decomp failed: %d", res);
+        session.failed++;
         return false;
     }
 
@@ -444,6 +917,8 @@ bool StripDecoder::decode_strip(const uint8_t* jpeg_data, size_t jpeg_size, int
     
     // Move Y position for next strip
     current_y += jdec.height;
+    session.strips++;
+    session.pixels_out += (uint32_t)jdec.width * (uint32_t)jdec.height;
     
     return true;
 }
@@ -451,10 +926,22 @@ bool StripDecoder::decode_strip(const uint8_t* jpeg_data, size_t jpeg_size, int
 void StripDecoder::end() {
     LOGI("STRIPDEC", "Complete at Y=%d", current_y);
 
+    if (session_open) {
+        session_open = false;
+        portENTER_CRITICAL(&s_decode_stats_mux);
+        s_decode_stats.sessions++;
+        if (session.line_rows > 0) s_decode_stats.line_fallback_sessions++;
+        s_decode_stats.active = false;
+        s_decode_stats.current = session;
+        add_session(s_decode_stats.total, session);
+        portEXIT_CRITICAL(&s_decode_stats_mux);
+    }
+
     // Free session buffers so the heap can recover between image sessions.
     free_buffers();
 
     current_y = 0;
+    origin_x = 0;
     width = 0;
     height = 0;
     lcd_width = 0;
@@ -21,6 +21,42 @@
 // Forward declaration
 class DisplayDriver;
 
+// Pull-style JPEG source for decode_stream(): copy up to `len` bytes into `dst`
+// (or skip `len` bytes when dst is nullptr). Returns bytes delivered; 0 = EOF/error.
+typedef size_t (*StripDecoderReadFn)(void* ctx, uint8_t* dst, size_t len);
+
+// Counters of one decode session (begin() .. end()). `decode_us` is wall time inside
+// the decode/push calls, so it includes `push_us` and the DecodeSlicer yields.
+// TJpgDec output goes out as ping-pong DMA rects, blocking batch rects, or line by
+// line when the batch buffer is missing (IMAGE_STRIP_BATCH_MAX_ROWS <= 1, no memory)
+// or smaller than an MCU row.
+struct StripDecodeSession {
+    uint32_t strips;          // strips (JPEG or raw RGB565) that reached the panel
+    uint32_t failed;          // strips that did not
+    uint32_t bytes_in;        // compressed / raw input bytes
+    uint32_t pixels_out;      // pixels written to the panel
+    uint32_t decode_us;
+    uint32_t push_us;         // blocking panel writes and waits for DMA
+    uint32_t yields;          // DecodeSlicer slices ended
+    uint32_t async_rects;     // ping-pong DMA rects
+    uint32_t batch_rects;     // one blocking transaction per rect
+    uint32_t line_rows;       // line-by-line fallback rows
+    uint32_t hw_strips;       // decoded by the hardware JPEG codec
+    uint16_t batch_rows;      // batch buffer height (0 = no batch buffer)
+    bool pingpong;            // both DMA batch buffers allocated
+};
+
+// Rolling summary of every StripDecoder, safe to read from any task.
+struct StripDecodeStats {
+    uint32_t sessions;              // sessions ended since boot
+    uint32_t line_fallback_sessions; // ended sessions that pushed any row line by line
+    bool active;                    // `current` is still decoding
+    StripDecodeSession current;     // session in progress, else the newest ended one
+    StripDecodeSession total;       // sum of the ended sessions
+};
+
+void strip_decoder_get_stats(StripDecodeStats* out);
+
 class StripDecoder {
 public:
     StripDecoder();
@@ -34,16 +70,34 @@ public:
     // image_height: total image height in pixels
     // lcd_width: LCD panel width (for bounds checking)
     // lcd_height: LCD panel height (for bounds checking)
-    void begin(int image_width, int image_height, int lcd_width, int lcd_height);
+    // origin_x/origin_y: panel position of the image's top-left pixel (sub-rect updates)
+    void begin(int image_width, int image_height, int lcd_width, int lcd_height, int origin_x = 0, int origin_y = 0);
     
     // Decode and display a single JPEG strip
     // jpeg_data: pointer to JPEG data for this strip
     // jpeg_size: size of JPEG data in bytes
     // strip_index: index of this strip (0-based)
-    // output_bgr565: true to pack pixels as BGR565 (legacy strip behavior),
-    //               false to pack pixels as RGB565 (useful when LCD is in RGB mode)
+    // output_bgr565: true to force BGR565 packing (legacy strip behavior),
+    //               false to use the driver's native colorOrder()
     // Returns: true on success, false on failure
     bool decode_strip(const uint8_t* jpeg_data, size_t jpeg_size, int strip_index, bool output_bgr565 = true);
+
+    // Decode two consecutive JPEG strips at once: `next` on a helper task pinned to the
+    // other core (into a RAM band), `first` here straight to the panel. The band is
+    // pushed after `first`, so panel writes stay in strip order and on this task.
+    // Without a second core (or helper/band memory) both strips decode sequentially.
+    bool decode_strip_pair(const uint8_t* first, size_t first_size,
+                           const uint8_t* next, size_t next_size, bool output_bgr565 = true);
+
+    // Decode one JPEG pulled incrementally from `read` (e.g. straight off an HTTP
+    // socket), so the compressed image never has to be buffered in full.
+    // Fails before touching the panel if the image does not fit below current Y.
+    bool decode_stream(StripDecoderReadFn read, void* read_ctx, bool output_bgr565 = true);
+
+    // Push `rows` full-width rows of pre-rendered RGB565 (MSB-first / wire order) at the
+    // current Y. No decode: wire-order RGB panels stream the buffer untouched; other
+    // panels get an in-place byte and/or R<->B swap. `pixels` is modified.
+    bool push_rgb565(uint16_t* pixels, int rows, bool output_bgr565 = true);
     
     // Complete image session and cleanup
     void end();
@@ -54,6 +108,14 @@ public:
 private:
     void free_buffers();
     bool ensure_buffers();
+    // Push `rows` rows of `w` driver-ready pixels (`stride` apart) at (origin_x, current_y).
+    void push_rows(uint16_t* pixels, int w, int rows, int stride, bool swap_bytes);
+    bool decode_hw(const uint8_t* jpeg_data, size_t jpeg_size, bool bgr);
+    bool ensure_band();
+    bool decode_common(StripDecoderReadFn read, void* read_ctx,
+                       const uint8_t* jpeg_data, size_t jpeg_size, bool output_bgr565);
+    // Account a finished public call that began at `start_us` and publish `session`.
+    void publish_session(int64_t start_us);
 
     DisplayDriver* driver;  // Display driver for LCD writes
     int width;              // Image width
@@ -61,6 +123,9 @@ private:
     int lcd_width;          // LCD panel width
     int lcd_height;         // LCD panel height
     int current_y;          // Current Y position in image
+    int origin_x = 0;       // Panel X of image column 0
+    bool session_open = false;
+    StripDecodeSession session = {};
 
     // Per-session reusable buffers (allocated in begin(), freed in end()).
     void* work_buffer = nullptr;
@@ -70,8 +135,14 @@ private:
     int line_buffer_width = 0;
 
     uint16_t* batch_buffer = nullptr;
+    uint16_t* batch_buffer_alt = nullptr;  // second DMA buffer (async drivers only)
+    bool pingpong_unavailable = false;     // DMA alloc failed this session
     int batch_max_rows = 0;
     int batch_capacity_pixels = 0;
+
+    // Helper-core target for decode_strip_pair() (width x IMAGE_STRIP_PARALLEL_MAX_ROWS).
+    uint16_t* band_buffer = nullptr;
+    int band_width = 0;
     
     // Note: Strip height is auto-detected from JPEG during decode (not hardcoded)
     // Typical values: 8, 16, 32, or 64 pixels (configurable in encoder)
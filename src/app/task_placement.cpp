@@ -0,0 +1,191 @@
+#include "task_placement.h"
+
+#include "app_alloc.h"
+#include "board_config.h"
+#include "board_profile.h"
+#include "log_manager.h"
+
+#include <Arduino.h>
+#include "soc/soc_caps.h"
+#include <esp_heap_caps.h>
+#include <freertos/portmacro.h>
+#include <string.h>
+
+static constexpr BaseType_t placement_core(int core) {
+#if CONFIG_FREERTOS_UNICORE
+    return (void)core, (BaseType_t)tskNO_AFFINITY;
+#else
+    return (core < 0 || core >= portNUM_PROCESSORS) ? tskNO_AFFINITY : (BaseType_t)core;
+#endif
+}
+
+// fw_update writes flash: its stack must stay in internal RAM (the cache is
+// disabled during flash writes, which makes PSRAM inaccessible).
+// mqtt gets fw_update-sized stack when TLS is built in (mbedTLS handshake).
+// log_drain formats deferred (LOG_BINARY_ENABLED) lines, including floats.
+// p1_meter polls a local meter over plain HTTP (no TLS, small fixed body buffer).
+// cpu_monitor also builds the cached /api/health snapshot when HEALTH_SNAPSHOT_ENABLED.
+// ota_writer lives for one /api/update upload; like fw_update it writes flash (internal stack).
+// image_stream lives for one streamed image upload (TJpgDec + panel writes, internal stack).
+// boot_wifi only lives during setup(): scan + connect + mDNS, in parallel with display init.
+// strip_decode is the second JPEG decoder for strip pairs; it sits on the render
+// core because LVGL is gated while the decoder owns the panel.
+static const TaskPlacement kTaskPlacements[(size_t)AppTask::Count] = {
+    {"LVGL",        placement_core(TASK_RENDER_CORE),     TASK_RENDER_PRIORITY,     8192,  false, true},
+    {"cpu_monitor", placement_core(TASK_BACKGROUND_CORE), TASK_BACKGROUND_PRIORITY, HEALTH_SNAPSHOT_ENABLED ? 6144 : 2048, true, true},
+    {"fw_update",   placement_core(TASK_NETWORK_CORE),    TASK_NETWORK_PRIORITY,    12288, false, false},
+    {"mqtt",        placement_core(TASK_NETWORK_CORE),    TASK_NETWORK_PRIORITY,    MQTT_TLS_ENABLED ? 12288 : 8192, true, true},
+    {"strip_decode", placement_core(TASK_RENDER_CORE),    TASK_NETWORK_PRIORITY,    4096,  false, true},
+    {"log_drain",   placement_core(TASK_BACKGROUND_CORE), TASK_BACKGROUND_PRIORITY, LOG_BINARY_ENABLED ? 3584 : 2560, true, true},
+    {"p1_meter",    placement_core(TASK_NETWORK_CORE),    TASK_NETWORK_PRIORITY,    4096,  true,  true},
+    {"boot_wifi",   placement_core(TASK_NETWORK_CORE),    TASK_NETWORK_PRIORITY,    6144,  false, false},
+    {"ota_writer",  placement_core(TASK_NETWORK_CORE),    TASK_NETWORK_PRIORITY,    4096,  false, false},
+    {"image_stream", placement_core(TASK_NETWORK_CORE),   TASK_NETWORK_PRIORITY,    6144,  false, false},
+};
+
+// Static storage of long-lived tasks, reserved on first create and never freed.
+struct TaskSlot {
+    StackType_t* stack;
+    StaticTask_t* tcb;
+    TaskHandle_t handle;
+    bool in_psram;
+};
+
+static portMUX_TYPE s_slot_mux = portMUX_INITIALIZER_UNLOCKED;
+static TaskSlot s_slots[(size_t)AppTask::Count] = {};
+
+static bool reserve_slot(const TaskPlacement& p, TaskSlot& slot) {
+    if (!slot.tcb) {
+        slot.tcb = (StaticTask_t*)app_alloc(AllocTag::Stack, sizeof(StaticTask_t), AllocPolicy::Internal);
+        if (!slot.tcb) return false;
+    }
+    if (slot.stack) return true;
+
+    const size_t bytes = (size_t)p.stack_depth * sizeof(StackType_t);
+    if (p.psram_stack && board_psram_available()) {
+        slot.stack = (StackType_t*)app_alloc(AllocTag::Stack, bytes, AllocPolicy::PsramOnly);
+        slot.in_psram = (slot.stack != nullptr);
+        if (!slot.stack) LOGW("Tasks", "%s: PSRAM stack failed, using internal RAM", p.name);
+    }
+    if (!slot.stack) {
+        slot.stack = (StackType_t*)app_alloc(AllocTag::Stack, bytes, AllocPolicy::Internal);
+        slot.in_psram = false;
+    }
+    return slot.stack != nullptr;
+}
+
+const TaskPlacement* task_placement_get(AppTask task) {
+    const size_t idx = (size_t)task;
+    if (idx >= (size_t)AppTask::Count) return nullptr;
+    return &kTaskPlacements[idx];
+}
+
+bool task_placement_create(AppTask task, TaskFunction_t fn, void* param,
+                           TaskHandle_t* outHandle, RtosTaskPsramAlloc* outAlloc) {
+    const TaskPlacement* p = task_placement_get(task);
+    if (!p || !fn || !outHandle) return false;
+
+    if (p->long_lived) {
+        TaskSlot& slot = s_slots[(size_t)task];
+        if (slot.handle) {
+            LOGW("Tasks", "%s: already running", p->name);
+            return false;
+        }
+        if (!reserve_slot(*p, slot)) {
+            LOGE("Tasks", "%s: no memory for a %u byte stack", p->name, (unsigned)p->stack_depth);
+            return false;
+        }
+
+        TaskHandle_t handle = rtos_create_task_static_pinned(
+            fn, p->name, p->stack_depth, param, p->priority, slot.stack, slot.tcb, p->core);
+        if (!handle) return false;
+
+        portENTER_CRITICAL(&s_slot_mux);
+        slot.handle = handle;
+        portEXIT_CRITICAL(&s_slot_mux);
+        if (outAlloc) {
+            outAlloc->tcb = slot.tcb;
+            outAlloc->stack = slot.stack;
+            outAlloc->stackDepthWords = p->stack_depth;
+        }
+        *outHandle = handle;
+        return true;
+    }
+
+#if SOC_SPIRAM_SUPPORTED
+    if (p->psram_stack && outAlloc && board_psram_available()) {
+        if (rtos_create_task_psram_stack_pinned(fn, p->name, p->stack_depth, param, p->priority, outHandle, outAlloc, p->core)) {
+            return true;
+        }
+        LOGW("Tasks", "%s: PSRAM stack failed, using internal RAM", p->name);
+    }
+#else
+    (void)outAlloc;
+#endif
+
+#if CONFIG_FREERTOS_UNICORE
+    return xTaskCreate(fn, p->name, p->stack_depth, param, p->priority, outHandle) == pdPASS;
+#else
+    return xTaskCreatePinnedToCore(fn, p->name, p->stack_depth, param, p->priority, outHandle, p->core) == pdPASS;
+#endif
+}
+
+void task_placement_forget(AppTask task) {
+    const size_t idx = (size_t)task;
+    if (idx >= (size_t)AppTask::Count) return;
+    portENTER_CRITICAL(&s_slot_mux);
+    s_slots[idx].handle = nullptr;
+    portEXIT_CRITICAL(&s_slot_mux);
+}
+
+uint32_t task_placement_stack_budget(const char* name, bool* out_psram) {
+    if (out_psram) *out_psram = false;
+    if (!name) return 0;
+
+    for (size_t i = 0; i < (size_t)AppTask::Count; i++) {
+        const TaskPlacement& p = kTaskPlacements[i];
+        if (strcmp(p.name, name) != 0) continue;
+        if (out_psram) {
+            portENTER_CRITICAL(&s_slot_mux);
+            *out_psram = p.long_lived && s_slots[i].in_psram;
+            portEXIT_CRITICAL(&s_slot_mux);
+        }
+        return p.stack_depth * (uint32_t)sizeof(StackType_t);
+    }
+
+    #ifdef CONFIG_ASYNC_TCP_STACK_SIZE
+    if (strcmp(name, "async_tcp") == 0) return (uint32_t)CONFIG_ASYNC_TCP_STACK_SIZE;
+    #endif
+    return 0;
+}
+
+static void log_core(const char* name, int core, unsigned priority) {
+    if (core < 0 || core == tskNO_AFFINITY) {
+        LOGI("Tasks", "%-12s core=any prio=%u", name, priority);
+    } else {
+        LOGI("Tasks", "%-12s core=%d prio=%u", name, core, priority);
+    }
+}
+
+void task_placement_log() {
+    for (size_t i = 0; i < (size_t)AppTask::Count; i++) {
+        const TaskPlacement& p = kTaskPlacements[i];
+        log_core(p.name, (int)p.core, (unsigned)p.priority);
+        LOGI("Tasks", "%-12s stack=%u %s%s", p.name, (unsigned)(p.stack_depth * sizeof(StackType_t)),
+             p.long_lived ? "static" : "dynamic", p.psram_stack ? " (psram ok)" : "");
+    }
+
+    log_core("loop", (int)xPortGetCoreID(), (unsigned)uxTaskPriorityGet(nullptr));
+    #ifdef CONFIG_ASYNC_TCP_RUNNING_CORE
+    LOGI("Tasks", "%-12s core=%d (CONFIG_ASYNC_TCP_RUNNING_CORE)", "async_tcp", (int)CONFIG_ASYNC_TCP_RUNNING_CORE);
+    #endif
+
+    #if !CONFIG_FREERTOS_UNICORE
+    if (TASK_NETWORK_CORE >= 0 && (int)xPortGetCoreID() != TASK_NETWORK_CORE) {
+        LOGW("Tasks", "loop() runs on core %d, TASK_NETWORK_CORE=%d", (int)xPortGetCoreID(), TASK_NETWORK_CORE);
+    }
+    if (TASK_RENDER_CORE >= 0 && TASK_RENDER_CORE == TASK_NETWORK_CORE) {
+        LOGW("Tasks", "Render and network share core %d", TASK_RENDER_CORE);
+    }
+    #endif
+}
@@ -0,0 +1,67 @@
+#pragma once
+
+#include "rtos_task_utils.h"
+
+#include <freertos/FreeRTOS.h>
+#include <freertos/task.h>
+
+// ============================================================================
+// Task Placement
+// ============================================================================
+// Central table of the app's long-lived FreeRTOS tasks: core affinity, priority,
+// stack size and whether the stack may live in PSRAM. Cores/priorities come from
+// TASK_* defines in board_config.h (override per board in board_overrides.h).
+//
+// Rendering is pinned to TASK_RENDER_CORE; network work and JPEG decode (loop(),
+// AsyncTCP, fw_update) belong on TASK_NETWORK_CORE. loop() itself is created by
+// the Arduino core on ARDUINO_RUNNING_CORE; task_placement_log() warns when that
+// does not match the table.
+//
+// Long-lived tasks are created with xTaskCreateStatic on storage the registry
+// reserves once (stack in PSRAM when allowed, TCB and other stacks in internal
+// RAM, all accounted as AllocTag::Stack) and keeps for reuse, so they never
+// churn the heap. Short-lived tasks delete themselves and keep dynamic stacks.
+// /api/health/tasks reports each stack's high-water mark next to its budget.
+
+enum class AppTask : uint8_t {
+    Lvgl = 0,
+    CpuMonitor,
+    FirmwareUpdate,
+    Mqtt,
+    StripDecode,
+    LogDrain,
+    P1Meter,        // local P1 meter polling (p1_meter.h)
+    BootWifi,       // short-lived: WiFi connect during setup() (BOOT_PARALLEL_WIFI)
+    OtaWriter,      // short-lived: flash writes for /api/update (ota_stream.h)
+    ImageStream,    // short-lived: decodes a POST /api/display/image body as it arrives
+    Count
+};
+
+struct TaskPlacement {
+    const char* name;
+    BaseType_t core;          // tskNO_AFFINITY = any core
+    UBaseType_t priority;
+    uint32_t stack_depth;     // FreeRTOS stack depth (bytes on ESP-IDF)
+    bool psram_stack;         // Allowed to use a PSRAM-backed stack
+    bool long_lived;          // Runs until reboot: static storage owned by the registry
+};
+
+const TaskPlacement* task_placement_get(AppTask task);
+
+// Create a task from its table entry. Uses a PSRAM stack when allowed and
+// available, otherwise an internal-RAM stack. outAlloc (optional) receives the
+// static storage of long-lived tasks. Fails while a long-lived task from the same
+// entry is still registered.
+bool task_placement_create(AppTask task, TaskFunction_t fn, void* param,
+                           TaskHandle_t* outHandle, RtosTaskPsramAlloc* outAlloc);
+
+// Drop a long-lived task's registration after vTaskDelete() (the storage is kept
+// and reused by the next task_placement_create()).
+void task_placement_forget(AppTask task);
+
+// Stack budget in bytes of the task called `name` (registry entries plus AsyncTCP),
+// 0 when unknown. `out_psram` (optional) tells whether that stack sits in PSRAM.
+uint32_t task_placement_stack_budget(const char* name, bool* out_psram);
+
+// Log the placement table (plus loop()/AsyncTCP cores) once at boot.
+void task_placement_log();
@@ -0,0 +1,109 @@
+#pragma once
+
+#include <Arduino.h>
+
+#include <freertos/FreeRTOS.h>
+
+#include <stddef.h>
+#include <stdint.h>
+#include <string.h>
+
+#include "app_alloc.h"
+
+// Fixed-capacity ring of time-series samples (oldest sample overwritten first).
+//
+// Shared by device-side histories (health_history, energy_history). Storage is
+// allocated once (PSRAM preferred) and guarded by a short critical section, so
+// a FreeRTOS timer can push while web handlers read.
+template <typename T>
+class TimeSeriesRing {
+public:
+    TimeSeriesRing() = default;
+    TimeSeriesRing(const TimeSeriesRing&) = delete;
+    TimeSeriesRing& operator=(const TimeSeriesRing&) = delete;
+
+    // Allocate storage for `capacity` samples. When allow_internal is false the
+    // ring is only allocated from PSRAM (returns false on boards without it).
+    bool allocate(size_t capacity, bool allow_internal = true) {
+        release();
+        if (capacity == 0) return false;
+
+        const size_t bytes = capacity * sizeof(T);
+        T* p = (T*)alloc_bytes(bytes, allow_internal);
+        if (!p) return false;
+        memset(p, 0, bytes);
+
+        portENTER_CRITICAL(&mux);
+        samples = p;
+        cap = capacity;
+        head = 0;
+        n = 0;
+        portEXIT_CRITICAL(&mux);
+        return true;
+    }
+
+    void release() {
+        portENTER_CRITICAL(&mux);
+        T* p = samples;
+        samples = nullptr;
+        cap = 0;
+        head = 0;
+        n = 0;
+        portEXIT_CRITICAL(&mux);
+        free_bytes(p);
+    }
+
+    bool ready() const { return samples != nullptr && cap > 0; }
+
+    size_t capacity() const { return cap; }
+
+    size_t count() const {
+        portENTER_CRITICAL(&mux);
+        const size_t c = n;
+        portEXIT_CRITICAL(&mux);
+        return c;
+    }
+
+    size_t bytes() const { return cap * sizeof(T); }
+
+    void push(const T& s) {
+        portENTER_CRITICAL(&mux);
+        if (samples && cap > 0) {
+            samples[head] = s;
+            head = (head + 1) % cap;
+            if (n < cap) n++;
+        }
+        portEXIT_CRITICAL(&mux);
+    }
+
+    // Copy the i-th oldest sample (0..count-1). Returns false if out of range.
+    bool get(size_t index, T* out) const {
+        if (!out) return false;
+
+        portENTER_CRITICAL(&mux);
+        if (!samples || index >= n || cap == 0) {
+            portEXIT_CRITICAL(&mux);
+            return false;
+        }
+        const size_t oldest = (head + cap - n) % cap;
+        *out = samples[(oldest + index) % cap];
+        portEXIT_CRITICAL(&mux);
+        return true;
+    }
+
+private:
+    static void* alloc_bytes(size_t bytes, bool allow_internal) {
+        return app_alloc(AllocTag::History, bytes,
+                         allow_internal ? AllocPolicy::Any8bit : AllocPolicy::PsramOnly);
+    }
+
+    static void free_bytes(void* p) {
+        app_free(AllocTag::History, p);
+    }
+
+    mutable portMUX_TYPE mux = portMUX_INITIALIZER_UNLOCKED;
+    T* samples = nullptr;
+    size_t cap = 0;
+    size_t head = 0;  // next write index
+    size_t n = 0;
+};
@@ -0,0 +1,95 @@
+#include "touch_filter.h"
+
+#if HAS_TOUCH
+
+#include <stdlib.h>
+
+static inline uint16_t median3(uint16_t a, uint16_t b, uint16_t c) {
+    if (a > b) { const uint16_t t = a; a = b; b = t; }
+    if (b > c) b = c;
+    return (a > b) ? a : b;
+}
+
+void TouchFilter::reset() {
+    count = 0;
+    idx = 0;
+}
+
+bool TouchFilter::acceptPressure(uint16_t pressure) const {
+    return pressure == 0 || pressure >= TOUCH_FILTER_MIN_PRESSURE;
+}
+
+void TouchFilter::apply(uint16_t raw_x, uint16_t raw_y, uint16_t* x, uint16_t* y) {
+    if (count == 0) {
+        // First sample of a stroke: seed everything so the point does not glide in from the last stroke.
+        for (uint8_t i = 0; i < 3; i++) {
+            hx[i] = raw_x;
+            hy[i] = raw_y;
+        }
+        fx_q4 = (int32_t)raw_x << 4;
+        fy_q4 = (int32_t)raw_y << 4;
+        out_x = raw_x;
+        out_y = raw_y;
+        count = 1;
+        *x = out_x;
+        *y = out_y;
+        return;
+    }
+
+    hx[idx] = raw_x;
+    hy[idx] = raw_y;
+    idx = (uint8_t)((idx + 1) % 3);
+
+    const int32_t mx = (int32_t)median3(hx[0], hx[1], hx[2]) << 4;
+    const int32_t my = (int32_t)median3(hy[0], hy[1], hy[2]) << 4;
+    fx_q4 += ((mx - fx_q4) * TOUCH_FILTER_IIR_ALPHA_Q8) / 256;
+    fy_q4 += ((my - fy_q4) * TOUCH_FILTER_IIR_ALPHA_Q8) / 256;
+
+    const uint16_t nx = (uint16_t)((fx_q4 + 8) >> 4);
+    const uint16_t ny = (uint16_t)((fy_q4 + 8) >> 4);
+    if (abs((int)nx - (int)out_x) > TOUCH_FILTER_DEADBAND_PX || abs((int)ny - (int)out_y) > TOUCH_FILTER_DEADBAND_PX) {
+        out_x = nx;
+        out_y = ny;
+    }
+    *x = out_x;
+    *y = out_y;
+}
+
+TouchGesture TouchGestureRecognizer::onPressed(uint16_t x, uint16_t y, uint32_t now_ms) {
+    if (!active) {
+        active = true;
+        fired = false;
+        start_x = x;
+        start_y = y;
+        start_ms = now_ms;
+        max_travel = 0;
+        return TouchGesture::None;
+    }
+    if (fired) return TouchGesture::None;
+
+    const int dx = (int)x - (int)start_x;
+    const int dy = (int)y - (int)start_y;
+    const uint16_t travel = (uint16_t)(abs(dx) > abs(dy) ? abs(dx) : abs(dy));
+    if (travel > max_travel) max_travel = travel;
+    const uint32_t held_ms = now_ms - start_ms;
+
+    // Mostly-horizontal, quick stroke.
+    if (abs(dx) >= TOUCH_GESTURE_SWIPE_MIN_PX && abs(dx) > 2 * abs(dy) && held_ms <= TOUCH_GESTURE_SWIPE_MAX_MS) {
+        fired = true;
+        return (dx < 0) ? TouchGesture::SwipeLeft : TouchGesture::SwipeRight;
+    }
+
+    // Held in place (never wandered toward a swipe).
+    if (held_ms >= TOUCH_GESTURE_LONG_PRESS_MS && max_travel < TOUCH_GESTURE_SWIPE_MIN_PX / 3) {
+        fired = true;
+        return TouchGesture::LongPress;
+    }
+    return TouchGesture::None;
+}
+
+void TouchGestureRecognizer::onReleased() {
+    active = false;
+    fired = false;
+}
+
+#endif // HAS_TOUCH
@@ -0,0 +1,72 @@
+/*
+ * Touch Filter + Gestures
+ *
+ * Fixed-point conditioning between the touch driver and LVGL:
+ * - median-of-3 rejects single-sample spikes (resistive panels)
+ * - IIR low-pass (TOUCH_FILTER_IIR_ALPHA_Q8) smooths the remaining noise
+ * - dead-band (TOUCH_FILTER_DEADBAND_PX) keeps a resting finger from nudging
+ *   the point, so LVGL does not re-invalidate pressed widgets every read
+ * - pressure threshold (TOUCH_FILTER_MIN_PRESSURE) when the driver reports Z
+ *
+ * TouchGestureRecognizer turns the filtered stroke into swipe left/right and
+ * long-press events (TouchManager maps them to screen navigation).
+ *
+ * Pure logic, no LVGL/hardware access; runs in the LVGL indev read callback.
+ */
+
+#ifndef TOUCH_FILTER_H
+#define TOUCH_FILTER_H
+
+#include "board_config.h"
+
+#if HAS_TOUCH
+
+#include <stdint.h>
+
+class TouchFilter {
+public:
+    // Start a new stroke (call on release).
+    void reset();
+
+    // Raw pressure below the threshold counts as released. `pressure` 0 = not reported.
+    bool acceptPressure(uint16_t pressure) const;
+
+    // Feed one sample (screen px) and get the filtered point.
+    void apply(uint16_t raw_x, uint16_t raw_y, uint16_t* x, uint16_t* y);
+
+private:
+    uint16_t hx[3] = {};
+    uint16_t hy[3] = {};
+    uint8_t count = 0;
+    uint8_t idx = 0;
+    int32_t fx_q4 = 0; // IIR state, 1/16 px
+    int32_t fy_q4 = 0;
+    uint16_t out_x = 0;
+    uint16_t out_y = 0;
+};
+
+enum class TouchGesture : uint8_t {
+    None,
+    SwipeLeft,
+    SwipeRight,
+    LongPress,
+};
+
+class TouchGestureRecognizer {
+public:
+    // Call for every pressed sample; returns a gesture at most once per stroke.
+    TouchGesture onPressed(uint16_t x, uint16_t y, uint32_t now_ms);
+    void onReleased();
+
+private:
+    bool active = false;
+    bool fired = false;
+    uint16_t start_x = 0;
+    uint16_t start_y = 0;
+    uint32_t start_ms = 0;
+    uint16_t max_travel = 0;
+};
+
+#endif // HAS_TOUCH
+
+#endif // TOUCH_FILTER_H
@@ -4,6 +4,7 @@
 
 #include "touch_manager.h"
 #include "log_manager.h"
+#include "touch_filter.h"
 
 // Touch init may run while the LVGL rendering task is active.
 // LVGL is not thread-safe, so guard LVGL API calls with the DisplayManager mutex when available.
@@ -30,6 +31,49 @@ static uint32_t g_lvgl_suppress_until_ms = 0;
 static bool g_lvgl_force_released = false;
 static bool g_prev_lvgl_pressed = false;
 
+// Poll slower while untouched so an idle screen does not wake the LVGL task every
+// LV_INDEV_DEF_READ_PERIOD ms; switch back to the default period on the first press.
+static uint32_t g_last_pressed_ms = 0;
+static bool g_idle_read_period = false;
+static constexpr uint32_t kTouchIdleAfterMs = 1000;
+
+static TouchFilter g_touch_filter;
+static TouchGestureRecognizer g_touch_gestures;
+
+// Swipe = next/previous screen, long-press = back to the first (home) screen.
+// The stroke then belongs to the gesture: LVGL ignores it until release, so
+// the finger lifting does not also click whatever is under it.
+static void touch_handle_gesture(lv_indev_t* indev, TouchGesture gesture) {
+    if (gesture == TouchGesture::None) return;
+    #if HAS_DISPLAY
+    bool switched = false;
+    if (gesture == TouchGesture::SwipeLeft) {
+        switched = display_manager_show_adjacent_screen(+1);
+    } else if (gesture == TouchGesture::SwipeRight) {
+        switched = display_manager_show_adjacent_screen(-1);
+    } else if (gesture == TouchGesture::LongPress) {
+        size_t count = 0;
+        const ScreenInfo* screens = display_manager_get_available_screens(&count);
+        const char* current = display_manager_get_current_screen_id();
+        if (screens && count > 0 && current && strcmp(current, screens[0].id) != 0) {
+            display_manager_show_screen(screens[0].id, &switched);
+        }
+    }
+    if (switched && indev) {
+        lv_indev_wait_release(indev);
+    }
+    #else
+    (void)indev;
+    #endif
+}
+
+static void touch_set_idle_read_period(lv_indev_drv_t* drv, bool idle) {
+    if (g_idle_read_period == idle) return;
+    if (!drv || !drv->read_timer) return;
+    g_idle_read_period = idle;
+    lv_timer_set_period(drv->read_timer, idle ? TOUCH_IDLE_READ_PERIOD_MS : LV_INDEV_DEF_READ_PERIOD);
+}
+
 TouchManager::TouchManager() 
     : driver(nullptr), indev(nullptr), lvglRegisterPending(false) {
     // Driver will be instantiated in init() after display is ready
@@ -50,14 +94,26 @@ void TouchManager::readCallback(lv_indev_drv_t* drv, lv_indev_data_t* data) {
     if (g_lvgl_force_released || ((int32_t)(g_lvgl_suppress_until_ms - now) > 0)) {
         data->state = LV_INDEV_STATE_RELEASED;
         g_prev_lvgl_pressed = false;
+        g_touch_filter.reset();
+        g_touch_gestures.onReleased();
         return;
     }
     
     uint16_t x, y;
-    if (manager->driver->getTouch(&x, &y)) {
+    uint16_t pressure = 0;
+    bool pressed = manager->driver->getTouch(&x, &y, &pressure);
+    #if TOUCH_FILTER_ENABLED
+    pressed = pressed && g_touch_filter.acceptPressure(pressure);
+    if (pressed) {
+        g_touch_filter.apply(x, y, &x, &y);
+    }
+    #endif
+    if (pressed) {
         data->state = LV_INDEV_STATE_PRESSED;
         data->point.x = x;
         data->point.y = y;
+        g_last_pressed_ms = now;
+        touch_set_idle_read_period(drv, false);
 
         // Any real user press counts as activity; this keeps the idle timer from
         // expiring while the user is actively navigating the UI.
@@ -68,9 +124,18 @@ void TouchManager::readCallback(lv_indev_drv_t* drv, lv_indev_data_t* data) {
             screen_saver_manager_notify_activity(false);
             #endif
         }
+
+        #if TOUCH_GESTURES_ENABLED
+        touch_handle_gesture(manager->indev, g_touch_gestures.onPressed(x, y, now));
+        #endif
     } else {
         data->state = LV_INDEV_STATE_RELEASED;
         g_prev_lvgl_pressed = false;
+        g_touch_filter.reset();
+        g_touch_gestures.onReleased();
+        if ((uint32_t)(now - g_last_pressed_ms) >= kTouchIdleAfterMs) {
+            touch_set_idle_read_period(drv, true);
+        }
     }
 }
 
@@ -122,7 +187,7 @@ bool TouchManager::tryRegisterWithLVGL() {
 
     bool locked = true;
     #if HAS_DISPLAY
-    locked = display_manager_try_lock(50);
+    locked = display_manager_try_lock(50, LvglLockSite::Touch);
     #endif
 
     if (!locked) {
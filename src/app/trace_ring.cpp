@@ -0,0 +1,304 @@
+#include "trace_ring.h"
+
+#if TRACE_RING_SUPPORTED
+
+#include "board_profile.h"
+#include "log_manager.h"
+#include "web_portal_json.h"
+
+#include <Arduino.h>
+#include <ESPAsyncWebServer.h>
+#include <esp_heap_caps.h>
+#include <esp_timer.h>
+#include <freertos/FreeRTOS.h>
+#include <freertos/portmacro.h>
+#include <freertos/task.h>
+#include <memory>
+#include <string.h>
+
+static_assert((TRACE_RING_EVENTS & (TRACE_RING_EVENTS - 1)) == 0, "TRACE_RING_EVENTS must be a power of two");
+static_assert((TRACE_RING_EVENTS_INTERNAL & (TRACE_RING_EVENTS_INTERNAL - 1)) == 0, "TRACE_RING_EVENTS_INTERNAL must be a power of two");
+
+namespace {
+
+// seq == ring index + 1 once the slot is written (0 = never written). Readers copy
+// the slot between two seq loads and drop it when a writer lapped them.
+struct TraceSlot {
+    uint32_t seq;
+    uint32_t ts_us;
+    uint8_t ev;
+    uint8_t phase;   // 'B' / 'E'
+    uint8_t core;
+    uint8_t task;    // index into s_tasks (kUnknownTask when the registry is full)
+};
+
+static constexpr uint8_t kMaxTasks = 32;
+static constexpr uint8_t kUnknownTask = 0xFF;
+
+struct TraceTask {
+    TaskHandle_t handle;
+    char name[16];
+};
+
+static const char* const kEventNames[(size_t)TraceEvent::Count] = {
+    "lv_timer",
+    "lv_flush",
+    "present",
+    "lvgl_lock_wait",
+    "lvgl_lock",
+    "strip_decode",
+    "mqtt_message",
+    "http_handler",
+    "nvs_write",
+};
+
+static TraceSlot* s_ring = nullptr;
+static uint32_t s_mask = 0;
+static uint32_t s_head = 0;   // next ring index (atomic)
+
+static portMUX_TYPE s_task_mux = portMUX_INITIALIZER_UNLOCKED;
+static TraceTask s_tasks[kMaxTasks] = {};
+static uint8_t s_task_count = 0;  // published with release after the entry is filled
+
+static bool (*g_auth_gate)(AsyncWebServerRequest* request) = nullptr;
+
+static uint8_t task_index(TaskHandle_t h) {
+    const uint8_t n = __atomic_load_n(&s_task_count, __ATOMIC_ACQUIRE);
+    for (uint8_t i = 0; i < n; i++) {
+        if (s_tasks[i].handle == h) return i;
+    }
+
+    // First event from this task: register it (rare; names are captured now so the
+    // export never dereferences a handle of a task that has since been deleted).
+    uint8_t idx = kUnknownTask;
+    portENTER_CRITICAL(&s_task_mux);
+    const uint8_t count = s_task_count;
+    for (uint8_t i = n; i < count; i++) {
+        if (s_tasks[i].handle == h) idx = i;
+    }
+    if (idx == kUnknownTask && count < kMaxTasks) {
+        s_tasks[count].handle = h;
+        strlcpy(s_tasks[count].name, pcTaskGetName(h), sizeof(s_tasks[count].name));
+        idx = count;
+        __atomic_store_n(&s_task_count, (uint8_t)(count + 1), __ATOMIC_RELEASE);
+    }
+    portEXIT_CRITICAL(&s_task_mux);
+    return idx;
+}
+
+static void record(TraceEvent ev, uint8_t phase) {
+    if (!s_ring || xPortInIsrContext()) return;
+
+    const uint32_t ts = (uint32_t)esp_timer_get_time();
+    const uint8_t task = task_index(xTaskGetCurrentTaskHandle());
+    const uint32_t idx = __atomic_fetch_add(&s_head, 1, __ATOMIC_RELAXED);
+    TraceSlot* slot = &s_ring[idx & s_mask];
+
+    __atomic_store_n(&slot->seq, 0, __ATOMIC_RELAXED);
+    __atomic_thread_fence(__ATOMIC_RELEASE);
+    slot->ts_us = ts;
+    slot->ev = (uint8_t)ev;
+    slot->phase = phase;
+    slot->core = (uint8_t)xPortGetCoreID();
+    slot->task = task;
+    __atomic_store_n(&slot->seq, idx + 1, __ATOMIC_RELEASE);
+}
+
+static bool read_slot(uint32_t idx, TraceSlot* out) {
+    const TraceSlot* slot = &s_ring[idx & s_mask];
+    const uint32_t before = __atomic_load_n(&slot->seq, __ATOMIC_ACQUIRE);
+    if (before != idx + 1) return false;
+    *out = *slot;
+    __atomic_thread_fence(__ATOMIC_ACQUIRE);
+    return __atomic_load_n(&slot->seq, __ATOMIC_RELAXED) == before;
+}
+
+// Streaming state for GET /api/trace.
+struct TraceExport {
+    uint32_t next;       // next ring index to emit
+    uint32_t end;        // head when the request arrived
+    uint32_t base_ts;    // timestamp of the first event (Chrome ts are relative)
+    bool have_base;
+    uint8_t tasks;       // registry entries to emit as thread_name metadata
+    uint8_t task_next;
+    bool header_done;
+    bool footer_done;
+    bool first_item;
+    char pending[200];
+    size_t pending_len;
+    size_t pending_pos;
+};
+
+static void append(TraceExport* st, const char* s, size_t n) {
+    memcpy(st->pending + st->pending_len, s, n);
+    st->pending_len += n;
+}
+
+static bool export_refill(TraceExport* st) {
+    st->pending_len = 0;
+    st->pending_pos = 0;
+    char* p = st->pending;
+    const size_t cap = sizeof(st->pending);
+
+    if (!st->header_done) {
+        st->header_done = true;
+        const char* h = "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[";
+        append(st, h, strlen(h));
+        return true;
+    }
+
+    if (st->task_next < st->tasks) {
+        const uint8_t i = st->task_next++;
+        st->pending_len = (size_t)snprintf(p, cap,
+            "%s{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":%u,\"args\":{\"name\":\"%s\"}}",
+            st->first_item ? "" : ",", (unsigned)(i + 1), s_tasks[i].name);
+        st->first_item = false;
+        if (st->pending_len >= cap) st->pending_len = cap - 1;
+        return true;
+    }
+
+    while (st->next != st->end) {
+        TraceSlot s;
+        const uint32_t idx = st->next++;
+        if (!read_slot(idx, &s) || s.ev >= (uint8_t)TraceEvent::Count) continue;  // overwritten meanwhile
+        if (!st->have_base) {
+            st->base_ts = s.ts_us;
+            st->have_base = true;
+        }
+        const unsigned tid = (s.task == kUnknownTask) ? 0u : (unsigned)(s.task + 1);
+        st->pending_len = (size_t)snprintf(p, cap,
+            "%s{\"name\":\"%s\",\"ph\":\"%c\",\"ts\":%lu,\"pid\":1,\"tid\":%u,\"args\":{\"core\":%u}}",
+            st->first_item ? "" : ",", kEventNames[s.ev], (char)s.phase,
+            (unsigned long)(uint32_t)(s.ts_us - st->base_ts), tid, (unsigned)s.core);
+        st->first_item = false;
+        if (st->pending_len >= cap) st->pending_len = cap - 1;
+        return true;
+    }
+
+    if (st->footer_done) return false;
+    st->footer_done = true;
+    append(st, "]}", 2);
+    return true;
+}
+
+static void handleTraceGet(AsyncWebServerRequest* request) {
+    if (g_auth_gate && !g_auth_gate(request)) return;
+    if (!s_ring) {
+        web_portal_send_json_error(request, 503, "Trace ring not allocated");
+        return;
+    }
+
+    auto st = std::make_shared<TraceExport>();
+    const uint32_t head = __atomic_load_n(&s_head, __ATOMIC_ACQUIRE);
+    const uint32_t capacity = s_mask + 1;
+    st->end = head;
+    st->next = head > capacity ? head - capacity : 0;
+    st->base_ts = 0;
+    st->have_base = false;
+    st->tasks = __atomic_load_n(&s_task_count, __ATOMIC_ACQUIRE);
+    st->task_next = 0;
+    st->header_done = false;
+    st->footer_done = false;
+    st->first_item = true;
+    st->pending_len = 0;
+    st->pending_pos = 0;
+
+    AsyncWebServerResponse* response = request->beginChunkedResponse(
+        "application/json",
+        [st](uint8_t* buffer, size_t max_len, size_t) -> size_t {
+            size_t written = 0;
+            while (written < max_len) {
+                if (st->pending_pos < st->pending_len) {
+                    const size_t n = min(st->pending_len - st->pending_pos, max_len - written);
+                    memcpy(buffer + written, st->pending + st->pending_pos, n);
+                    st->pending_pos += n;
+                    written += n;
+                    continue;
+                }
+                if (!export_refill(st.get())) break;
+            }
+            return written;
+        }
+    );
+    response->addHeader("Cache-Control", "no-store");
+    response->addHeader("Content-Disposition", "attachment; filename=\"trace.json\"");
+    request->send(response);
+}
+
+static void handleTraceDelete(AsyncWebServerRequest* request) {
+    if (g_auth_gate && !g_auth_gate(request)) return;
+    if (s_ring) {
+        // Invalidate every slot; writers racing this simply land in the fresh ring.
+        for (uint32_t i = 0; i <= s_mask; i++) {
+            __atomic_store_n(&s_ring[i].seq, 0, __ATOMIC_RELAXED);
+        }
+    }
+    request->send(200, "application/json", "{\"success\":true}");
+}
+
+} // namespace
+
+void trace_ring_init() {
+    if (s_ring) return;
+
+    uint32_t events = 0;
+    TraceSlot* ring = nullptr;
+    if (board_psram_available()) {
+        ring = (TraceSlot*)heap_caps_calloc(TRACE_RING_EVENTS, sizeof(TraceSlot), MALLOC_CAP_SPIRAM | MALLOC_CAP_8BIT);
+        events = TRACE_RING_EVENTS;
+    }
+    if (!ring && TRACE_RING_EVENTS_INTERNAL > 0) {
+        ring = (TraceSlot*)heap_caps_calloc(TRACE_RING_EVENTS_INTERNAL, sizeof(TraceSlot), MALLOC_CAP_INTERNAL | MALLOC_CAP_8BIT);
+        events = TRACE_RING_EVENTS_INTERNAL;
+    }
+    if (!ring) {
+        LOGW("Trace", "Trace ring not allocated");
+        return;
+    }
+    s_mask = events - 1;
+    __atomic_store_n(&s_ring, ring, __ATOMIC_RELEASE);
+    LOGI("Trace", "Trace ring: %lu events (%lu bytes)", (unsigned long)events, (unsigned long)(events * sizeof(TraceSlot)));
+}
+
+size_t trace_ring_copy_recent(TraceRecentEvent* out, size_t max) {
+    if (!s_ring || !out || max == 0) return 0;
+
+    const uint32_t head = __atomic_load_n(&s_head, __ATOMIC_ACQUIRE);
+    const uint32_t capacity = s_mask + 1;
+    const uint32_t window = (uint32_t)(max < capacity ? max : capacity);
+    uint32_t idx = head > window ? head - window : 0;
+
+    size_t n = 0;
+    for (; idx != head && n < max; idx++) {
+        TraceSlot s;
+        if (!read_slot(idx, &s) || s.ev >= (uint8_t)TraceEvent::Count) continue;
+        TraceRecentEvent* e = &out[n++];
+        e->ts_us = s.ts_us;
+        e->ev = s.ev;
+        e->phase = s.phase;
+        e->core = s.core;
+        if (s.task == kUnknownTask) strlcpy(e->task, "?", sizeof(e->task));
+        else strlcpy(e->task, s_tasks[s.task].name, sizeof(e->task));
+    }
+    return n;
+}
+
+const char* trace_event_name(uint8_t ev) {
+    return ev < (uint8_t)TraceEvent::Count ? kEventNames[ev] : "?";
+}
+
+void trace_begin(TraceEvent ev) {
+    record(ev, 'B');
+}
+
+void trace_end(TraceEvent ev) {
+    record(ev, 'E');
+}
+
+void trace_ring_register_routes(AsyncWebServer* server, bool (*auth_gate)(AsyncWebServerRequest* request)) {
+    g_auth_gate = auth_gate;
+    server->on("/api/trace", HTTP_GET, handleTraceGet);
+    server->on("/api/trace", HTTP_DELETE, handleTraceDelete);
+}
+
+#endif // TRACE_RING_SUPPORTED
@@ -0,0 +1,92 @@
+/*
+ * Event Trace Ring (Chrome trace export)
+ *
+ * Fixed-size ring of begin/end events (timestamp, event id, task, core) for a
+ * cross-task timeline: LVGL timer/flush/present, LVGL mutex wait/hold, strip
+ * decodes, MQTT callbacks, HTTP handlers and NVS writes. Recording is lock-free
+ * (one atomic increment plus a slot write), allocation-free, and safe from any task;
+ * events from ISRs are ignored. The ring lives in PSRAM when available.
+ *
+ * Endpoints:
+ *   GET    /api/trace   - Download the ring as Chrome trace_event JSON
+ *                         (chrome://tracing, https://ui.perfetto.dev)
+ *   DELETE /api/trace   - Clear the ring
+ */
+
+#pragma once
+
+#include "board_config.h"
+
+#include <stddef.h>
+#include <stdint.h>
+
+// One event as exported for crash records (task name captured, not the handle).
+struct TraceRecentEvent {
+    uint32_t ts_us;
+    uint8_t ev;      // TraceEvent
+    uint8_t phase;   // 'B' / 'E'
+    uint8_t core;
+    char task[13];
+};
+
+#if TRACE_RING_ENABLED
+
+#define TRACE_RING_SUPPORTED 1
+
+class AsyncWebServer;
+class AsyncWebServerRequest;
+
+enum class TraceEvent : uint8_t {
+    LvTimer = 0,    // lv_timer_handler()
+    LvFlush,        // LVGL flush callback
+    Present,        // DisplayDriver::present()
+    LvglLockWait,   // waiting for the LVGL mutex
+    LvglLock,       // holding the LVGL mutex
+    StripDecode,    // StripDecoder JPEG decode
+    MqttMessage,    // MQTT subscription callback
+    HttpHandler,    // portal request handler
+    NvsWrite,       // config/NVS write
+    Count,
+};
+
+void trace_ring_init();
+
+// Copy the newest `max` events into `out` (oldest first); returns the count (any task).
+size_t trace_ring_copy_recent(TraceRecentEvent* out, size_t max);
+
+// Short name of an event ("strip_decode"), "?" when out of range.
+const char* trace_event_name(uint8_t ev);
+
+void trace_begin(TraceEvent ev);
+void trace_end(TraceEvent ev);
+
+// Scoped begin/end pair.
+class TraceScope {
+public:
+    explicit TraceScope(TraceEvent ev) : ev_(ev) { trace_begin(ev_); }
+    ~TraceScope() { trace_end(ev_); }
+    TraceScope(const TraceScope&) = delete;
+    TraceScope& operator=(const TraceScope&) = delete;
+
+private:
+    TraceEvent ev_;
+};
+
+// auth_gate: same contract as image_api_register_routes().
+void trace_ring_register_routes(AsyncWebServer* server, bool (*auth_gate)(AsyncWebServerRequest* request) = nullptr);
+
+#define TRACE_CONCAT_INNER(a, b) a##b
+#define TRACE_CONCAT(a, b) TRACE_CONCAT_INNER(a, b)
+#define TRACE_SCOPE(ev) TraceScope TRACE_CONCAT(trace_scope_, __LINE__)(ev)
+#define TRACE_BEGIN(ev) trace_begin(ev)
+#define TRACE_END(ev) trace_end(ev)
+
+#else
+
+#define TRACE_RING_SUPPORTED 0
+
+#define TRACE_SCOPE(ev) do {} while (0)
+#define TRACE_BEGIN(ev) do {} while (0)
+#define TRACE_END(ev) do {} while (0)
+
+#endif
@@ -658,6 +658,9 @@ async function loadConfig() {
         // MQTT settings
         setValueIfExists('mqtt_host', config.mqtt_host);
         setValueIfExists('mqtt_port', config.mqtt_port);
+        setCheckedIfExists('mqtt_tls', config.mqtt_tls);
+        const tlsGroup = document.getElementById('mqtt-tls-group');
+        if (tlsGroup && config.mqtt_tls_supported === false) tlsGroup.style.display = 'none';
         setValueIfExists('mqtt_username', config.mqtt_username);
         setValueIfExists('mqtt_interval_seconds', config.mqtt_interval_seconds);
 
@@ -710,6 +713,7 @@ async function loadConfig() {
         setValueIfExists('energy_grid_threshold_2_kw', config.energy_grid_threshold_2_kw);
 
         initEnergyMonitorThresholdMaps();
+        renderEnergyAuxChannels(config);
 
         // Basic Auth settings
         setCheckedIfExists('basic_auth_enabled', config.basic_auth_enabled);
@@ -733,6 +737,19 @@ async function loadConfig() {
         setValueIfExists('screen_saver_fade_out_ms', config.screen_saver_fade_out_ms);
         setValueIfExists('screen_saver_fade_in_ms', config.screen_saver_fade_in_ms);
         setCheckedIfExists('screen_saver_wake_on_touch', config.screen_saver_wake_on_touch);
+
+        // Scheduled image refresh (absent on builds without the image API)
+        const refreshGroup = document.getElementById('image-refresh-group');
+        if (refreshGroup) refreshGroup.style.display = (config.image_refresh_url !== undefined) ? '' : 'none';
+        setValueIfExists('image_refresh_url', config.image_refresh_url);
+        setValueIfExists('image_refresh_interval_seconds', config.image_refresh_interval_seconds);
+
+        // Local P1 meter source (absent on builds without P1_METER_ENABLED)
+        const p1Group = document.getElementById('p1-meter-group');
+        if (p1Group) p1Group.style.display = (config.p1_meter_url !== undefined) ? '' : 'none';
+        setValueIfExists('p1_meter_url', config.p1_meter_url);
+        setValueIfExists('p1_meter_grid_path', config.p1_meter_grid_path);
+        setValueIfExists('p1_meter_solar_path', config.p1_meter_solar_path);
         
         // Hide loading overlay (silent load)
         const overlay = document.getElementById('form-loading-overlay');
@@ -746,6 +763,59 @@ async function loadConfig() {
     }
 }
 
+/**
+ * Render name/topic/value-path rows for the extra energy channels
+ * (count comes from the firmware build: energy_aux_channel_count)
+ * @param {Object} config - Configuration from /api/config
+ */
+function renderEnergyAuxChannels(config) {
+    const container = document.getElementById('energy-aux-channels');
+    if (!container) return;
+
+    const count = Number(config.energy_aux_channel_count || 0);
+    container.innerHTML = '';
+    if (count <= 0) return;
+
+    const heading = document.createElement('h3');
+    heading.style.cssText = 'margin: 18px 0 12px 0; font-size: 16px; color: #1d1d1f;';
+    heading.textContent = 'Additional Channels';
+    container.appendChild(heading);
+
+    const addField = (parent, name, label, maxlength, placeholder, value) => {
+        const group = document.createElement('div');
+        group.className = 'form-group';
+        const l = document.createElement('label');
+        l.htmlFor = name;
+        l.textContent = label;
+        const input = document.createElement('input');
+        input.type = 'text';
+        input.id = name;
+        input.name = name;
+        input.maxLength = maxlength;
+        input.placeholder = placeholder;
+        input.value = value || '';
+        input.dataset.energyAux = '1';
+        group.appendChild(l);
+        group.appendChild(input);
+        parent.appendChild(group);
+    };
+
+    for (let i = 0; i < count; i++) {
+        const block = document.createElement('div');
+        block.className = 'energy-category';
+        const title = document.createElement('h4');
+        title.style.cssText = 'margin: 0 0 10px 0; font-size: 14px; color: #1d1d1f;';
+        title.textContent = `Channel ${i + 1}`;
+        block.appendChild(title);
+
+        const prefix = `energy_aux_${i}_`;
+        addField(block, prefix + 'name', 'Name', 15, 'e.g. battery, ev, heat_pump', config[prefix + 'name']);
+        addField(block, prefix + 'topic', 'Power Topic', 127, 'e.g. home/battery/power', config[prefix + 'topic']);
+        addField(block, prefix + 'value_path', 'Value Path', 31, 'e.g. . or value', config[prefix + 'value_path']);
+        container.appendChild(block);
+    }
+}
+
 /**
  * Extract form fields that exist on the current page
  * @param {FormData} formData - Form data to extract from
@@ -771,7 +841,7 @@ function extractFormFields(formData) {
     const config = {};
     const fields = ['wifi_ssid', 'wifi_password', 'device_name', 'fixed_ip', 
                     'subnet_mask', 'gateway', 'dns1', 'dns2', 'dummy_setting',
-                    'mqtt_host', 'mqtt_port', 'mqtt_username', 'mqtt_password', 'mqtt_interval_seconds',
+                    'mqtt_host', 'mqtt_port', 'mqtt_tls', 'mqtt_username', 'mqtt_password', 'mqtt_interval_seconds',
                     'mqtt_topic_solar', 'mqtt_topic_grid', 'mqtt_solar_value_path', 'mqtt_grid_value_path',
                     'energy_solar_bar_max_kw', 'energy_home_bar_max_kw', 'energy_grid_bar_max_kw',
                     'energy_alarm_pulse_cycle_ms', 'energy_alarm_pulse_peak_pct', 'energy_alarm_clear_delay_ms', 'energy_alarm_clear_hysteresis_mkw',
@@ -783,13 +853,21 @@ function extractFormFields(formData) {
                     'energy_grid_threshold_0_kw', 'energy_grid_threshold_1_kw', 'energy_grid_threshold_2_kw',
                     'basic_auth_enabled', 'basic_auth_username', 'basic_auth_password',
                     'backlight_brightness',
-                    'screen_saver_enabled', 'screen_saver_timeout_seconds', 'screen_saver_fade_out_ms', 'screen_saver_fade_in_ms', 'screen_saver_wake_on_touch'];
+                    'screen_saver_enabled', 'screen_saver_timeout_seconds', 'screen_saver_fade_out_ms', 'screen_saver_fade_in_ms', 'screen_saver_wake_on_touch',
+                    'image_refresh_url', 'image_refresh_interval_seconds',
+                    'p1_meter_url', 'p1_meter_grid_path', 'p1_meter_solar_path'];
     
     fields.forEach(field => {
         const element = document.querySelector(`[name="${field}"]`);
         const value = (element && element.type === 'checkbox') ? getCheckboxValue(field) : getFieldValue(field);
         if (value !== null) config[field] = value;
     });
+
+    // Extra energy channel rows are generated at runtime (see renderEnergyAuxChannels)
+    document.querySelectorAll('[data-energy-aux]').forEach(element => {
+        const value = getFieldValue(element.name);
+        if (value !== null) config[element.name] = value;
+    });
     
     return config;
 }
@@ -1344,9 +1422,11 @@ document.addEventListener('DOMContentLoaded', () => {
 
 const API_HEALTH = '/api/health';
 const API_HEALTH_HISTORY = '/api/health/history';
+const API_EVENTS = '/api/events';
 
 let healthExpanded = false;
 let healthPollTimer = null;
+let healthEventSource = null;
 
 const HEALTH_POLL_INTERVAL_DEFAULT_MS = 5000;
 const HEALTH_HISTORY_DEFAULT_SECONDS = 300;
@@ -1356,6 +1436,8 @@ let healthHistoryMaxSamples = 60;
 let healthDeviceHistoryAvailable = false;
 let healthDeviceHistoryPeriodMs = HEALTH_POLL_INTERVAL_DEFAULT_MS;
 let healthLastHistoryFetchMs = 0;
+// Device uptime of the newest sample we hold (next ?since= cursor), or null for a full fetch.
+let healthHistoryNextSince = null;
 
 const healthHistory = {
     cpu: [],
@@ -1483,6 +1565,17 @@ function healthReplaceArray(dst, src) {
     }
 }
 
+// Incremental responses append and keep the newest `capacity` entries.
+function healthMergeArray(dst, src, incremental, capacity) {
+    if (!incremental) {
+        healthReplaceArray(dst, src);
+        return;
+    }
+    if (!Array.isArray(dst) || !Array.isArray(src)) return;
+    for (let i = 0; i < src.length; i++) dst.push(src[i]);
+    if (capacity > 0 && dst.length > capacity) dst.splice(0, dst.length - capacity);
+}
+
 async function updateHealthHistory({ hasPsram = null } = {}) {
     if (!healthDeviceHistoryAvailable) return;
     if (!healthExpanded) return;
@@ -1493,31 +1586,33 @@ async function updateHealthHistory({ hasPsram = null } = {}) {
     healthLastHistoryFetchMs = now;
 
     try {
-        const resp = await fetch(API_HEALTH_HISTORY);
+        const url = (healthHistoryNextSince === null) ? API_HEALTH_HISTORY : `${API_HEALTH_HISTORY}?since=${healthHistoryNextSince}`;
+        const resp = await fetch(url);
         if (!resp.ok) return;
         const hist = await resp.json();
         if (!hist || hist.available !== true) return;
 
         const periodMs = (typeof hist.period_ms === 'number' && isFinite(hist.period_ms) && hist.period_ms > 0) ? Math.trunc(hist.period_ms) : healthDeviceHistoryPeriodMs;
-        const ts = healthMakeSyntheticTs(Array.isArray(hist.cpu_usage) ? hist.cpu_usage.length : 0, periodMs);
-
-        healthReplaceArray(healthHistory.cpu, hist.cpu_usage);
+        const incremental = hist.incremental === true;
+        const capacity = (typeof hist.capacity === 'number' && isFinite(hist.capacity)) ? Math.trunc(hist.capacity) : 0;
+        healthHistoryNextSince = (typeof hist.next_since === 'number' && isFinite(hist.next_since)) ? hist.next_since : null;
+
+        healthMergeArray(healthHistory.cpu, hist.cpu_usage, incremental, capacity);
+        healthMergeArray(healthHistory.heapInternalFree, hist.heap_internal_free, incremental, capacity);
+        healthMergeArray(healthHistory.heapInternalFreeMin, hist.heap_internal_free_min_window, incremental, capacity);
+        healthMergeArray(healthHistory.heapInternalFreeMax, hist.heap_internal_free_max_window, incremental, capacity);
+        healthMergeArray(healthHistory.psramFree, hist.psram_free, incremental, capacity);
+        healthMergeArray(healthHistory.psramFreeMin, hist.psram_free_min_window, incremental, capacity);
+        healthMergeArray(healthHistory.psramFreeMax, hist.psram_free_max_window, incremental, capacity);
+        healthMergeArray(healthHistory.heapInternalLargest, hist.heap_internal_largest, incremental, capacity);
+        healthMergeArray(healthHistory.heapInternalLargestMin, hist.heap_internal_largest_min_window, incremental, capacity);
+        healthMergeArray(healthHistory.heapInternalLargestMax, hist.heap_internal_largest_max_window, incremental, capacity);
+
+        const ts = healthMakeSyntheticTs(healthHistory.cpu.length, periodMs);
         healthReplaceArray(healthHistory.cpuTs, ts);
-
-        healthReplaceArray(healthHistory.heapInternalFree, hist.heap_internal_free);
         healthReplaceArray(healthHistory.heapInternalFreeTs, ts);
-        healthReplaceArray(healthHistory.heapInternalFreeMin, hist.heap_internal_free_min_window);
-        healthReplaceArray(healthHistory.heapInternalFreeMax, hist.heap_internal_free_max_window);
-
-        healthReplaceArray(healthHistory.psramFree, hist.psram_free);
         healthReplaceArray(healthHistory.psramFreeTs, ts);
-        healthReplaceArray(healthHistory.psramFreeMin, hist.psram_free_min_window);
-        healthReplaceArray(healthHistory.psramFreeMax, hist.psram_free_max_window);
-
-        healthReplaceArray(healthHistory.heapInternalLargest, hist.heap_internal_largest);
         healthReplaceArray(healthHistory.heapInternalLargestTs, ts);
-        healthReplaceArray(healthHistory.heapInternalLargestMin, hist.heap_internal_largest_min_window);
-        healthReplaceArray(healthHistory.heapInternalLargestMax, hist.heap_internal_largest_max_window);
 
         healthUpdateSeriesStats({ hasPsram });
         healthDrawSparklinesOnly({ hasPsram });
@@ -2243,7 +2338,15 @@ function renderHealth(health) {
             if (health.display_fps === null || health.display_fps === undefined) {
                 displayEl.textContent = 'N/A';
             } else if (typeof health.display_lv_timer_us === 'number' && typeof health.display_present_us === 'number') {
-                displayEl.textContent = `${health.display_fps} fps, ${(health.display_lv_timer_us / 1000).toFixed(1)}ms / ${(health.display_present_us / 1000).toFixed(1)}ms`;
+                let text = `${health.display_fps} fps, ${(health.display_lv_timer_us / 1000).toFixed(1)}ms / ${(health.display_present_us / 1000).toFixed(1)}ms`;
+                if (typeof health.display_lv_timer_p95_us === 'number') {
+                    text += ` (p95 ${(health.display_lv_timer_p95_us / 1000).toFixed(1)}ms`;
+                    if (typeof health.display_bus_bytes_per_s === 'number') {
+                        text += `, ${(health.display_bus_bytes_per_s / 1024).toFixed(0)} KB/s`;
+                    }
+                    text += ')';
+                }
+                displayEl.textContent = text;
             } else {
                 displayEl.textContent = `${health.display_fps} fps`;
             }
@@ -2256,8 +2359,14 @@ async function updateHealth() {
         const response = await fetch(API_HEALTH);
         if (!response.ok) return;
 
-        const health = await response.json();
+        await applyHealth(await response.json());
+    } catch (error) {
+        console.error('Failed to fetch health stats:', error);
+    }
+}
 
+async function applyHealth(health) {
+    try {
         const cpuUsage = (typeof health.cpu_usage === 'number' && isFinite(health.cpu_usage)) ? Math.floor(health.cpu_usage) : null;
         const hasPsram = (
             (deviceInfoCache && typeof deviceInfoCache.psram_size === 'number' && deviceInfoCache.psram_size > 0) ||
@@ -2296,10 +2405,33 @@ async function updateHealth() {
             await updateHealthHistory({ hasPsram });
         }
     } catch (error) {
-        console.error('Failed to fetch health stats:', error);
+        console.error('Failed to render health stats:', error);
     }
 }
 
+// Health arrives over /api/events when the firmware has it; polling is the fallback
+// (older firmware, EventSource unsupported, or the device's client limit reached).
+function healthStartEventStream(onUnavailable) {
+    if (typeof EventSource === 'undefined') return false;
+
+    const source = new EventSource(API_EVENTS);
+    healthEventSource = source;
+    source.addEventListener('health', (ev) => {
+        try {
+            applyHealth(JSON.parse(ev.data));
+        } catch (error) {
+            console.error('Bad health event:', error);
+        }
+    });
+    source.onerror = () => {
+        // CLOSED means the server refused the stream (404/429/...); otherwise the browser retries.
+        if (source.readyState !== EventSource.CLOSED) return;
+        if (healthEventSource === source) healthEventSource = null;
+        onUnavailable();
+    };
+    return true;
+}
+
 function toggleHealthWidget() {
     healthExpanded = !healthExpanded;
     const expandedEl = document.getElementById('health-expanded');
@@ -2347,10 +2479,21 @@ function initHealthWidget() {
         healthPollTimer = setInterval(updateHealth, healthPollIntervalMs);
     };
 
-    // Initial
-    updateHealth();
-    startPolling();
+    const startPollingFallback = () => {
+        updateHealth();
+        startPolling();
 
-    // Re-tune polling once deviceInfoCache becomes available.
-    setTimeout(startPolling, 1500);
+        // Re-tune polling once deviceInfoCache becomes available.
+        setTimeout(startPolling, 1500);
+    };
+
+    // Prefer the push stream; the first health event arrives immediately.
+    if (healthStartEventStream(startPollingFallback)) {
+        setTimeout(() => {
+            healthConfigureFromDeviceInfo(deviceInfoCache);
+            healthConfigureHistoryFromDeviceInfo(deviceInfoCache);
+        }, 1500);
+    } else {
+        startPollingFallback();
+    }
 }
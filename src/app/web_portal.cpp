@@ -26,6 +26,12 @@
 #include "web_portal_state.h"
 #include "web_portal_firmware.h"
 #include "web_portal_ap.h"
+#include "device_bench.h"
+#include "trace_ring.h"
+#include "crash_record.h"
+#include "log_stream.h"
+#include "screenshot.h"
+#include "portal_events.h"
 
 #if HAS_MQTT
 #include "mqtt_manager.h"
@@ -38,6 +44,9 @@
 
 #if HAS_IMAGE_API
 #include "image_api.h"
+#include "image_slideshow.h"
+#include "image_mjpeg.h"
+#include "image_refresh.h"
 #endif
 
 #include <ESPAsyncWebServer.h>
@@ -124,13 +133,37 @@ void web_portal_init(DeviceConfig *config) {
 
     // Routes (factored out for maintainability)
     web_portal_register_routes(server);
+
+    #if DEVICE_BENCH_SUPPORTED
+    device_bench_register_routes(server, portal_auth_gate);
+    #endif
+
+    #if TRACE_RING_SUPPORTED
+    trace_ring_register_routes(server, portal_auth_gate);
+    #endif
+
+    #if CRASH_RECORD_SUPPORTED
+    crash_record_register_routes(server, portal_auth_gate);
+    #endif
+
+    #if LOG_STREAM_SUPPORTED
+    log_stream_register_routes(server, portal_auth_gate);
+    #endif
+
+    #if SCREENSHOT_SUPPORTED
+    screenshot_register_routes(server, portal_auth_gate);
+    #endif
+
+    #if PORTAL_EVENTS_SUPPORTED
+    portal_events_register_routes(server, portal_auth_gate);
+    #endif
     
     // Image API integration (if enabled)
     #if HAS_IMAGE_API && HAS_DISPLAY
     LOGI("Portal", "Initializing image API");
     
     // Setup backend adapter
-    ImageApiBackend backend;
+    ImageApiBackend backend = {};
     backend.hide_current_image = []() {
         #if HAS_DISPLAY
         // Called from AsyncTCP task and sometimes from the main loop.
@@ -150,7 +183,10 @@ void web_portal_init(DeviceConfig *config) {
         
         // Now called from main loop with proper task context
         // Show the DirectImageScreen first
-        display_manager_show_direct_image();
+        if (!display_manager_show_direct_image()) {
+            LOGE("IMG", "Display command queue full");
+            return false;
+        }
 
         // Screen-affecting action counts as explicit activity and should wake.
         screen_saver_manager_notify_activity(true);
@@ -178,6 +214,63 @@ void web_portal_init(DeviceConfig *config) {
         return false;
         #endif
     };
+
+    backend.decode_strip_pair = [](const uint8_t* first, size_t first_size, const uint8_t* next, size_t next_size, bool output_bgr565) -> bool {
+        #if HAS_DISPLAY
+        DirectImageScreen* screen = display_manager_get_direct_image_screen();
+        if (!screen) {
+            LOGE("IMG", "No direct image screen");
+            return false;
+        }
+
+        return screen->decode_strip_pair(first, first_size, next, next_size, output_bgr565);
+        #else
+        return false;
+        #endif
+    };
+
+    backend.push_rgb565_strip = [](uint16_t* pixels, int rows, bool output_bgr565) -> bool {
+        #if HAS_DISPLAY
+        DirectImageScreen* screen = display_manager_get_direct_image_screen();
+        if (!screen) {
+            LOGE("IMG", "No direct image screen");
+            return false;
+        }
+
+        return screen->push_rgb565_strip(pixels, rows, output_bgr565);
+        #else
+        return false;
+        #endif
+    };
+
+    backend.begin_region = [](int x, int y, int w, int h) -> bool {
+        #if HAS_DISPLAY
+        DirectImageScreen* screen = display_manager_get_direct_image_screen();
+        if (!screen) {
+            LOGE("IMG", "No direct image screen");
+            return false;
+        }
+
+        return screen->begin_region(x, y, w, h);
+        #else
+        return false;
+        #endif
+    };
+
+    backend.decode_stream = [](ImageApiReadFn read, void* read_ctx, bool output_bgr565) -> bool {
+        #if HAS_DISPLAY
+        DirectImageScreen* screen = display_manager_get_direct_image_screen();
+        if (!screen) {
+            LOGE("IMG", "No direct image screen");
+            return false;
+        }
+
+        // Main loop; the reader pulls from the HTTP client as TJpgDec consumes input.
+        return screen->decode_stream(read, read_ctx, output_bgr565);
+        #else
+        return false;
+        #endif
+    };
     
     // Setup configuration
     ImageApiConfig image_cfg;
@@ -204,6 +297,15 @@ void web_portal_init(DeviceConfig *config) {
     image_api_init(image_cfg, backend);
     LOGI("Portal", "Calling image_api_register_routes...");
     image_api_register_routes(server, portal_auth_gate);
+    #if IMAGE_SLIDESHOW_SUPPORTED
+    image_slideshow_register_routes(server, portal_auth_gate);
+    #endif
+    #if IMAGE_MJPEG_SUPPORTED
+    image_mjpeg_register_routes(server, portal_auth_gate);
+    #endif
+    #if IMAGE_REFRESH_SUPPORTED
+    image_refresh_init(current_config);
+    #endif
     LOGI("Portal", "Image API initialized");
     #endif // HAS_IMAGE_API && HAS_DISPLAY
     
@@ -225,6 +327,10 @@ void web_portal_handle() {
 
     web_portal_config_loop();
 
+    #if DEVICE_BENCH_SUPPORTED
+    device_bench_loop(ota_in_progress);
+    #endif
+
     #if HAS_MQTT
     if (web_portal_config_take_mqtt_reconnect_request()) {
         mqtt_manager_request_reconnect();
@@ -251,5 +357,17 @@ void web_portal_process_pending_images() {
     #endif
 
     image_api_process_pending(ota_in_progress);
+
+    #if IMAGE_SLIDESHOW_SUPPORTED
+    image_slideshow_loop(ota_in_progress);
+    #endif
+
+    #if IMAGE_MJPEG_SUPPORTED
+    image_mjpeg_loop(ota_in_progress);
+    #endif
+
+    #if IMAGE_REFRESH_SUPPORTED
+    image_refresh_loop(ota_in_progress);
+    #endif
 }
 #endif
@@ -0,0 +1,101 @@
+#include "web_portal_admission.h"
+
+#include "log_manager.h"
+
+#include <Arduino.h>
+#include <esp_heap_caps.h>
+#include <freertos/FreeRTOS.h>
+#include <stdio.h>
+
+namespace {
+
+struct ClassLimits {
+    uint8_t max_in_flight;
+    size_t min_heap;
+};
+
+static const ClassLimits kLimits[(size_t)PortalRouteClass::Count] = {
+    {WEB_PORTAL_ADMIT_STATUS_MAX, WEB_PORTAL_ADMIT_STATUS_MIN_HEAP},
+    {WEB_PORTAL_ADMIT_HEAVY_MAX, WEB_PORTAL_ADMIT_HEAVY_MIN_HEAP},
+};
+
+// Counters are only changed on the async_tcp task; the mux keeps readers
+// (the health snapshot builder) from seeing torn updates.
+static portMUX_TYPE g_admission_mux = portMUX_INITIALIZER_UNLOCKED;
+static PortalAdmissionStats g_stats = {};
+
+static void release(PortalRouteClass cls) {
+    portENTER_CRITICAL(&g_admission_mux);
+    PortalAdmissionClassStats& s = g_stats.cls[(size_t)cls];
+    if (s.in_flight > 0) s.in_flight--;
+    portEXIT_CRITICAL(&g_admission_mux);
+}
+
+static void send_rejection(AsyncWebServerRequest* request, const char* message) {
+    char body[96];
+    snprintf(body, sizeof(body), "{\"success\":false,\"message\":\"%s\"}", message);
+    AsyncWebServerResponse* response = request->beginResponse(503, "application/json", body);
+    response->addHeader("Retry-After", String((unsigned)WEB_PORTAL_ADMIT_RETRY_AFTER_S));
+    response->addHeader("Cache-Control", "no-store");
+    request->send(response);
+}
+
+} // namespace
+
+bool web_portal_admit(AsyncWebServerRequest* request, PortalRouteClass cls) {
+    #if WEB_PORTAL_ADMISSION_ENABLED
+    const ClassLimits& limits = kLimits[(size_t)cls];
+    const size_t free_heap = heap_caps_get_free_size(MALLOC_CAP_INTERNAL | MALLOC_CAP_8BIT);
+
+    bool busy = false;
+    bool low_heap = false;
+    uint32_t rejected = 0;
+    portENTER_CRITICAL(&g_admission_mux);
+    PortalAdmissionClassStats& s = g_stats.cls[(size_t)cls];
+    if (s.in_flight >= limits.max_in_flight) {
+        busy = true;
+        rejected = ++s.rejected_busy;
+    } else if (free_heap < limits.min_heap) {
+        low_heap = true;
+        rejected = ++s.rejected_heap;
+    } else {
+        s.in_flight++;
+        if (s.in_flight > s.peak) s.peak = s.in_flight;
+        s.admitted++;
+    }
+    portEXIT_CRITICAL(&g_admission_mux);
+
+    if (busy || low_heap) {
+        // First rejection and then every 32nd, so a stress run does not flood the log.
+        if ((rejected & 31u) == 1u) {
+            LOGW("Portal", "Rejected %s %s (%s, heap=%u, n=%lu)",
+                web_portal_route_class_name(cls), request->url().c_str(),
+                busy ? "busy" : "low heap", (unsigned)free_heap, (unsigned long)rejected);
+        }
+        send_rejection(request, busy ? "Busy, retry later" : "Low memory, retry later");
+        return false;
+    }
+
+    // Runs when the connection closes, i.e. after the last chunk was sent.
+    request->onDisconnect([cls]() { release(cls); });
+    #else
+    (void)request;
+    (void)cls;
+    #endif
+    return true;
+}
+
+void web_portal_admission_get_stats(PortalAdmissionStats* out) {
+    if (!out) return;
+    portENTER_CRITICAL(&g_admission_mux);
+    *out = g_stats;
+    portEXIT_CRITICAL(&g_admission_mux);
+}
+
+const char* web_portal_route_class_name(PortalRouteClass cls) {
+    switch (cls) {
+        case PortalRouteClass::Status: return "status";
+        case PortalRouteClass::Heavy: return "heavy";
+        default: return "?";
+    }
+}
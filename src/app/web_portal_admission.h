@@ -0,0 +1,38 @@
+#pragma once
+
+#include "board_config.h"
+
+#include <ESPAsyncWebServer.h>
+#include <stdint.h>
+
+// Request admission for /api routes.
+//
+// Every admitted request holds a slot of its route class until the connection
+// closes (i.e. until a chunked response has been fully sent), so the number of
+// JSON documents alive at once is bounded. Over-limit or low-heap requests are
+// answered right away with 503 + Retry-After instead of being queued.
+
+enum class PortalRouteClass : uint8_t {
+    Status = 0,  // small, frequently polled documents
+    Heavy,       // large documents (config, history)
+    Count,
+};
+
+struct PortalAdmissionClassStats {
+    uint8_t in_flight;
+    uint8_t peak;
+    uint32_t admitted;
+    uint32_t rejected_busy;
+    uint32_t rejected_heap;
+};
+
+struct PortalAdmissionStats {
+    PortalAdmissionClassStats cls[(size_t)PortalRouteClass::Count];
+};
+
+// Admit the request or send the 503 (returns false; the handler must return).
+bool web_portal_admit(AsyncWebServerRequest* request, PortalRouteClass cls);
+
+void web_portal_admission_get_stats(PortalAdmissionStats* out);
+
+const char* web_portal_route_class_name(PortalRouteClass cls);
@@ -1,8 +1,13 @@
 #include "web_portal_ap.h"
 
+#include "board_config.h"
 #include "log_manager.h"
 #include "project_branding.h"
 
+#if HAS_DISPLAY
+#include "display_manager.h"
+#endif
+
 #include <Arduino.h>
 #include <DNSServer.h>
 #include <WiFi.h>
@@ -56,6 +61,9 @@ void web_portal_start_ap() {
     dnsServer.start(DNS_PORT, "*", CAPTIVE_PORTAL_IP);
 
     WiFi.softAPsetHostname(apName.c_str());
+    #if HAS_DISPLAY
+    display_manager_notify_info_changed();
+    #endif
 
     // Mark AP mode active so watchdog/DNS handling knows we're in captive portal
     ap_mode_active = true;
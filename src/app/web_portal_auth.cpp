@@ -3,6 +3,113 @@
 #include "web_portal_state.h"
 #include "config_manager.h"
 #include "project_branding.h"
+#include "board_config.h"
+
+#if WEB_PORTAL_AUTH_SESSION
+#include <esp_random.h>
+#include <mbedtls/md.h>
+#include <string.h>
+
+static constexpr const char *kSessionCookieName = "portal_session";
+static constexpr size_t kTokenBytes = 16;                 // truncated HMAC-SHA256
+static constexpr size_t kTokenHexLen = kTokenBytes * 2;
+
+static uint8_t g_session_key[32];
+static bool g_session_key_ready = false;
+static uint32_t g_token_creds_hash = 0;                     // credentials the token was derived from
+static bool g_token_valid = false;
+static char g_token[kTokenHexLen + 1];
+static char g_cookie[96];
+
+// FNV-1a over "user\npass": tells when the credentials changed without keeping a copy.
+static uint32_t creds_hash(const char *user, const char *pass) {
+    uint32_t h = 2166136261u;
+    for (const char *p = user; *p; p++) h = (h ^ (uint8_t)*p) * 16777619u;
+    h = (h ^ (uint8_t)'\n') * 16777619u;
+    for (const char *p = pass; *p; p++) h = (h ^ (uint8_t)*p) * 16777619u;
+    return h;
+}
+
+// Token for the current credentials (derived again only after they changed).
+static const char *session_token(const DeviceConfig *config) {
+    const uint32_t h = creds_hash(config->basic_auth_username, config->basic_auth_password);
+    if (g_token_valid && h == g_token_creds_hash) return g_token;
+
+    if (!g_session_key_ready) {
+        esp_fill_random(g_session_key, sizeof(g_session_key));
+        g_session_key_ready = true;
+    }
+
+    uint8_t mac[32];
+    mbedtls_md_context_t ctx;
+    mbedtls_md_init(&ctx);
+    int rc = mbedtls_md_setup(&ctx, mbedtls_md_info_from_type(MBEDTLS_MD_SHA256), 1);
+    if (rc == 0) rc = mbedtls_md_hmac_starts(&ctx, g_session_key, sizeof(g_session_key));
+    if (rc == 0) rc = mbedtls_md_hmac_update(&ctx, (const unsigned char *)config->basic_auth_username, strlen(config->basic_auth_username));
+    if (rc == 0) rc = mbedtls_md_hmac_update(&ctx, (const unsigned char *)"\n", 1);
+    if (rc == 0) rc = mbedtls_md_hmac_update(&ctx, (const unsigned char *)config->basic_auth_password, strlen(config->basic_auth_password));
+    if (rc == 0) rc = mbedtls_md_hmac_finish(&ctx, mac);
+    mbedtls_md_free(&ctx);
+    if (rc != 0) {
+        g_token_valid = false;
+        return nullptr;
+    }
+
+    static const char kHex[] = "0123456789abcdef";
+    for (size_t i = 0; i < kTokenBytes; i++) {
+        g_token[2 * i] = kHex[mac[i] >> 4];
+        g_token[2 * i + 1] = kHex[mac[i] & 0x0F];
+    }
+    g_token[kTokenHexLen] = '\0';
+    snprintf(g_cookie, sizeof(g_cookie), "%s=%s; Path=/; HttpOnly; SameSite=Strict", kSessionCookieName, g_token);
+    g_token_creds_hash = h;
+    g_token_valid = true;
+    return g_token;
+}
+
+// Constant-time: the time taken does not depend on where the first mismatch is.
+static bool token_equals(const char *candidate, size_t len, const char *token) {
+    if (len != kTokenHexLen) return false;
+    uint8_t diff = 0;
+    for (size_t i = 0; i < kTokenHexLen; i++) diff |= (uint8_t)(candidate[i] ^ token[i]);
+    return diff == 0;
+}
+
+// Value of `portal_session` in a Cookie header (nullptr when absent).
+static const char *find_session_cookie(const char *v, size_t *len_out) {
+    const size_t name_len = strlen(kSessionCookieName);
+    while (*v) {
+        while (*v == ' ' || *v == ';') v++;
+        const char *end = v;
+        while (*end && *end != ';') end++;
+        if ((size_t)(end - v) > name_len && memcmp(v, kSessionCookieName, name_len) == 0 && v[name_len] == '=') {
+            *len_out = (size_t)(end - v) - name_len - 1;
+            return v + name_len + 1;
+        }
+        v = end;
+    }
+    return nullptr;
+}
+
+static bool request_has_session(AsyncWebServerRequest *request, const char *token) {
+    const AsyncWebHeader *cookie = request->getHeader("Cookie");
+    if (cookie) {
+        size_t len = 0;
+        const char *v = find_session_cookie(cookie->value().c_str(), &len);
+        if (v && token_equals(v, len, token)) return true;
+    }
+
+    const AsyncWebHeader *authz = request->getHeader("Authorization");
+    if (authz) {
+        const char *v = authz->value().c_str();
+        if (strncmp(v, "Bearer ", 7) == 0) {
+            v += 7;
+            return token_equals(v, strlen(v), token);
+        }
+    }
+    return false;
+}
+#endif // WEB_PORTAL_AUTH_SESSION
 
 static bool portal_auth_required() {
     if (web_portal_is_ap_mode_active()) return false;
@@ -19,6 +126,13 @@ bool portal_auth_gate(AsyncWebServerRequest *request) {
     DeviceConfig *config = web_portal_get_current_config();
     if (!config) return true;
 
+    #if WEB_PORTAL_AUTH_SESSION
+    const char *token = session_token(config);
+    if (token && request_has_session(request, token)) {
+        return true;
+    }
+    #endif
+
     const char *user = config->basic_auth_username;
     const char *pass = config->basic_auth_password;
 
@@ -29,3 +143,48 @@ bool portal_auth_gate(AsyncWebServerRequest *request) {
     request->requestAuthentication(PROJECT_DISPLAY_NAME);
     return false;
 }
+
+const char *portal_auth_session_cookie(AsyncWebServerRequest *request) {
+    #if WEB_PORTAL_AUTH_SESSION
+    if (!portal_auth_required()) return nullptr;
+    DeviceConfig *config = web_portal_get_current_config();
+    if (!config) return nullptr;
+
+    const char *token = session_token(config);
+    if (!token) return nullptr;
+
+    const AsyncWebHeader *cookie = request->getHeader("Cookie");
+    if (cookie) {
+        size_t len = 0;
+        const char *v = find_session_cookie(cookie->value().c_str(), &len);
+        if (v && token_equals(v, len, token)) return nullptr;
+    }
+    return g_cookie;
+    #else
+    (void)request;
+    return nullptr;
+    #endif
+}
+
+void handleGetAuthToken(AsyncWebServerRequest *request) {
+    if (!portal_auth_gate(request)) return;
+
+    #if WEB_PORTAL_AUTH_SESSION
+    DeviceConfig *config = web_portal_get_current_config();
+    const char *token = (portal_auth_required() && config) ? session_token(config) : nullptr;
+    if (!token) {
+        request->send(404, "application/json", "{\"success\":false,\"message\":\"Authentication is disabled\"}");
+        return;
+    }
+
+    char body[96];
+    snprintf(body, sizeof(body), "{\"success\":true,\"token\":\"%s\",\"cookie\":\"%s\"}", token, kSessionCookieName);
+    AsyncWebServerResponse *response = request->beginResponse(200, "application/json", body);
+    response->addHeader("Cache-Control", "no-store");
+    const char *set_cookie = portal_auth_session_cookie(request);
+    if (set_cookie) response->addHeader("Set-Cookie", set_cookie);
+    request->send(response);
+    #else
+    request->send(404, "application/json", "{\"success\":false,\"message\":\"Session tokens are disabled\"}");
+    #endif
+}
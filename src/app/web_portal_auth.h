@@ -5,6 +5,22 @@
 
 // Basic auth gate (optional; STA/full mode only).
 // Returns true if request is authorized (or auth disabled); otherwise sends auth challenge and returns false.
+//
+// With WEB_PORTAL_AUTH_SESSION, a request carrying the session token (the
+// `portal_session` cookie, or `Authorization: Bearer <token>` for machine
+// clients) is accepted with one constant-time compare, before any Basic header
+// is parsed. The token is an HMAC-SHA256 of the credentials under a key drawn
+// at boot: it changes with the username/password and on every reboot, and is
+// never stored. Called from the async_tcp task only.
 bool portal_auth_gate(AsyncWebServerRequest *request);
 
+// Set-Cookie value issuing the session to an authorized request that does not
+// carry it yet; nullptr when auth is off or the cookie is already current.
+// Added to the HTML page responses, so the browser switches to the cookie
+// after the first page load.
+const char *portal_auth_session_cookie(AsyncWebServerRequest *request);
+
+// GET /api/auth/token - Current session token for machine clients (behind the gate).
+void handleGetAuthToken(AsyncWebServerRequest *request);
+
 #endif // WEB_PORTAL_AUTH_H
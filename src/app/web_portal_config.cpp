@@ -4,8 +4,10 @@
 #include "web_portal_state.h"
 
 #include "board_config.h"
+#include "board_profile.h"
 #include "config_manager.h"
 #include "device_telemetry.h"
+#include "energy_thresholds.h"
 #include "log_manager.h"
 #include "psram_json_allocator.h"
 #include "web_portal_json.h"
@@ -15,25 +17,290 @@
 #include "screen_saver_manager.h"
 #endif
 
+#if HAS_MQTT
+#include "mqtt_manager.h"
+#endif
+
 #include <ArduinoJson.h>
 #include <WiFi.h>
 
 #include <math.h>
+#include <memory>
+#include <new>
 #include <stdlib.h>
+#include <string.h>
 
 #include <esp_heap_caps.h>
 
 #include <freertos/FreeRTOS.h>
 #include <freertos/task.h>
 
-// /api/config body accumulator (chunk-safe)
+// ===== POST /api/config (incremental parse) =====
+// The body is a flat object of key -> scalar. Bytes are parsed as they arrive and
+// each finished pair is stored in `doc`, so the raw body is never buffered and
+// the doc only holds the fields that were actually sent. Nested values are
+// skipped (no config field uses them).
+struct ConfigPostParser {
+    enum State : uint8_t {
+        ExpectObject,
+        ExpectKey,
+        InKey,
+        ExpectColon,
+        ExpectValue,
+        InString,
+        InLiteral,
+        SkipNested,
+        AfterValue,
+        Done,
+        Error,
+    };
+
+    PooledJsonDocument doc;
+    State state;
+    bool first_key;
+    bool escape;
+    uint8_t unicode_left;   // hex digits still expected after \u
+    uint16_t unicode;
+    uint16_t skip_depth;
+    bool skip_in_string;
+    bool skip_escape;
+    const char *error;      // set with state == Error
+    int error_code;
+    size_t key_len;
+    size_t val_len;
+    char key[48];
+    char val[CONFIG_IMAGE_REFRESH_URL_MAX_LEN + 8];  // longest string field; longer values are truncated
+
+    ConfigPostParser() : doc(1024), state(ExpectObject), first_key(true), escape(false), unicode_left(0), unicode(0),
+        skip_depth(0), skip_in_string(false), skip_escape(false), error(nullptr), error_code(0), key_len(0), val_len(0) {}
+
+    void fail(int code, const char *message) {
+        state = Error;
+        error_code = code;
+        error = message;
+    }
+
+    // Appends to the key or value buffer (silently truncating, like strlcpy on apply).
+    void put(char c) {
+        if (state == InKey) {
+            if (key_len + 1 < sizeof(key)) key[key_len++] = c;
+        } else if (val_len + 1 < sizeof(val)) {
+            val[val_len++] = c;
+        }
+    }
+
+    void put_utf8(uint16_t cp) {
+        if (cp < 0x80) {
+            put((char)cp);
+        } else if (cp < 0x800) {
+            put((char)(0xC0 | (cp >> 6)));
+            put((char)(0x80 | (cp & 0x3F)));
+        } else {
+            put((char)(0xE0 | (cp >> 12)));
+            put((char)(0x80 | ((cp >> 6) & 0x3F)));
+            put((char)(0x80 | (cp & 0x3F)));
+        }
+    }
+
+    void store_string() {
+        key[key_len] = '\0';
+        val[val_len] = '\0';
+        doc[(char *)key] = (char *)val;
+    }
+
+    bool store_literal() {
+        key[key_len] = '\0';
+        val[val_len] = '\0';
+        if (strcmp(val, "true") == 0) {
+            doc[(char *)key] = true;
+        } else if (strcmp(val, "false") == 0) {
+            doc[(char *)key] = false;
+        } else if (strcmp(val, "null") == 0) {
+            doc[(char *)key] = nullptr;
+        } else {
+            char *end = nullptr;
+            if (strpbrk(val, ".eE")) {
+                const double d = strtod(val, &end);
+                if (!end || *end) return false;
+                doc[(char *)key] = d;
+            } else {
+                const long v = strtol(val, &end, 10);
+                if (!end || *end || end == val) return false;
+                doc[(char *)key] = v;
+            }
+        }
+        return true;
+    }
+
+    // String body (key or value): handles escapes; returns true on the closing quote.
+    bool string_char(char c) {
+        if (unicode_left) {
+            uint8_t nib;
+            if (c >= '0' && c <= '9') nib = (uint8_t)(c - '0');
+            else if (c >= 'a' && c <= 'f') nib = (uint8_t)(c - 'a' + 10);
+            else if (c >= 'A' && c <= 'F') nib = (uint8_t)(c - 'A' + 10);
+            else {
+                fail(400, "Invalid JSON");
+                return false;
+            }
+            unicode = (uint16_t)((unicode << 4) | nib);
+            if (--unicode_left == 0) {
+                // Surrogate pairs are not needed for config values; keep a placeholder.
+                put_utf8((unicode >= 0xD800 && unicode <= 0xDFFF) ? (uint16_t)'?' : unicode);
+            }
+            return false;
+        }
+        if (escape) {
+            escape = false;
+            switch (c) {
+                case 'n': put('\n'); break;
+                case 't': put('\t'); break;
+                case 'r': put('\r'); break;
+                case 'b': put('\b'); break;
+                case 'f': put('\f'); break;
+                case 'u': unicode_left = 4; unicode = 0; break;
+                default: put(c); break;  // \" \\ \/
+            }
+            return false;
+        }
+        if (c == '\\') {
+            escape = true;
+            return false;
+        }
+        if (c == '"') return true;
+        if ((unsigned char)c < 0x20) {
+            fail(400, "Invalid JSON");
+            return false;
+        }
+        put(c);
+        return false;
+    }
+
+    void feed(const uint8_t *data, size_t len) {
+        for (size_t i = 0; i < len && state != Error; i++) {
+            const char c = (char)data[i];
+            const bool ws = (c == ' ' || c == '\t' || c == '\r' || c == '\n');
+
+            switch (state) {
+                case ExpectObject:
+                    if (ws) break;
+                    if (c == '{') state = ExpectKey;
+                    else fail(400, "Invalid JSON");
+                    break;
+
+                case ExpectKey:
+                    if (ws) break;
+                    if (c == '"') {
+                        state = InKey;
+                        key_len = 0;
+                    } else if (c == '}' && first_key) {
+                        state = Done;
+                    } else {
+                        fail(400, "Invalid JSON");
+                    }
+                    break;
+
+                case InKey:
+                    if (string_char(c)) state = ExpectColon;
+                    break;
+
+                case ExpectColon:
+                    if (ws) break;
+                    if (c == ':') state = ExpectValue;
+                    else fail(400, "Invalid JSON");
+                    break;
+
+                case ExpectValue:
+                    if (ws) break;
+                    val_len = 0;
+                    if (c == '"') {
+                        state = InString;
+                    } else if (c == '{' || c == '[') {
+                        state = SkipNested;
+                        skip_depth = 1;
+                        skip_in_string = false;
+                        skip_escape = false;
+                    } else if (c == '-' || (c >= '0' && c <= '9') || c == 't' || c == 'f' || c == 'n') {
+                        state = InLiteral;
+                        put(c);
+                    } else {
+                        fail(400, "Invalid JSON");
+                    }
+                    break;
+
+                case InString:
+                    if (string_char(c)) {
+                        store_string();
+                        state = AfterValue;
+                    }
+                    break;
+
+                case InLiteral:
+                    if ((c >= '0' && c <= '9') || (c >= 'a' && c <= 'z') || c == '-' || c == '+' || c == '.' || c == 'E') {
+                        if (val_len + 1 >= sizeof(val)) {
+                            fail(400, "Invalid JSON");
+                            break;
+                        }
+                        put(c);
+                        break;
+                    }
+                    if (!store_literal()) {
+                        fail(400, "Invalid JSON");
+                        break;
+                    }
+                    state = AfterValue;
+                    i--;  // re-read the delimiter
+                    break;
+
+                case SkipNested:
+                    if (skip_in_string) {
+                        if (skip_escape) skip_escape = false;
+                        else if (c == '\\') skip_escape = true;
+                        else if (c == '"') skip_in_string = false;
+                    } else if (c == '"') {
+                        skip_in_string = true;
+                    } else if (c == '{' || c == '[') {
+                        skip_depth++;
+                    } else if ((c == '}' || c == ']') && --skip_depth == 0) {
+                        state = AfterValue;
+                    }
+                    break;
+
+                case AfterValue:
+                    if (ws) break;
+                    if (c == ',') {
+                        state = ExpectKey;
+                        first_key = false;
+                    } else if (c == '}') {
+                        state = Done;
+                    } else {
+                        fail(400, "Invalid JSON");
+                    }
+                    break;
+
+                case Done:
+                    if (!ws) fail(400, "Invalid JSON");
+                    break;
+
+                case Error:
+                    break;
+            }
+        }
+
+        if (state != Error && doc.overflowed()) {
+            fail(413, "JSON body too large");
+        }
+    }
+};
+
+// /api/config body parser state (chunk-safe)
 static portMUX_TYPE g_config_post_mux = portMUX_INITIALIZER_UNLOCKED;
 static struct {
     bool in_progress;
     uint32_t started_ms;
     size_t total;
     size_t received;
-    uint8_t* buf;
+    ConfigPostParser* parser;
 } g_config_post = {false, 0, 0, 0, nullptr};
 
 #if HAS_MQTT
@@ -42,9 +309,9 @@ static volatile bool g_pending_mqtt_reconnect_request = false;
 #endif
 
 static void config_post_reset() {
-    if (g_config_post.buf) {
-        heap_caps_free(g_config_post.buf);
-        g_config_post.buf = nullptr;
+    if (g_config_post.parser) {
+        delete g_config_post.parser;
+        g_config_post.parser = nullptr;
     }
     g_config_post.in_progress = false;
     g_config_post.total = 0;
@@ -116,126 +383,249 @@ static int32_t kw_to_mkw(float kw) {
     return (int32_t)lroundf(kw * 1000.0f);
 }
 
-void handleGetConfig(AsyncWebServerRequest *request) {
-    if (!portal_auth_gate(request)) return;
+// ===== GET /api/config (streamed) =====
+// The JSON is written field by field straight from a DeviceConfig copy; every
+// chunk re-renders it through ChunkPrint, which keeps only the requested window.
+// Memory stays constant however many fields the config grows.
+class ConfigJsonWriter {
+public:
+    explicit ConfigJsonWriter(Print &out) : out_(out), first_(true) {}
 
-    DeviceConfig *current_config = web_portal_get_current_config();
-    if (!current_config) {
-        request->send(500, "application/json", "{\"error\":\"Config not initialized\"}");
-        return;
+    void begin() { out_.write('{'); }
+    void end() { out_.write('}'); }
+
+    void str(const char *k, const char *v) {
+        key(k);
+        quoted(v ? v : "");
     }
 
-    // Create JSON response (don't include passwords)
-    std::shared_ptr<BasicJsonDocument<PsramJsonAllocator>> doc = make_psram_json_doc(4096);
-    if (doc && doc->capacity() > 0) {
-        (*doc)["wifi_ssid"] = current_config->wifi_ssid;
-        (*doc)["wifi_password"] = ""; // Don't send password
-        (*doc)["device_name"] = current_config->device_name;
-
-        // Sanitized name for display
-        char sanitized[CONFIG_DEVICE_NAME_MAX_LEN];
-        config_manager_sanitize_device_name(current_config->device_name, sanitized, CONFIG_DEVICE_NAME_MAX_LEN);
-        (*doc)["device_name_sanitized"] = sanitized;
-
-        // Fixed IP settings
-        (*doc)["fixed_ip"] = current_config->fixed_ip;
-        (*doc)["subnet_mask"] = current_config->subnet_mask;
-        (*doc)["gateway"] = current_config->gateway;
-        (*doc)["dns1"] = current_config->dns1;
-        (*doc)["dns2"] = current_config->dns2;
-
-        // Dummy setting
-        (*doc)["dummy_setting"] = current_config->dummy_setting;
-
-        // MQTT settings (password not returned)
-        (*doc)["mqtt_host"] = current_config->mqtt_host;
-        (*doc)["mqtt_port"] = current_config->mqtt_port;
-        (*doc)["mqtt_username"] = current_config->mqtt_username;
-        (*doc)["mqtt_password"] = "";
-        (*doc)["mqtt_interval_seconds"] = current_config->mqtt_interval_seconds;
-
-        // Energy Monitor MQTT subscription settings
-        (*doc)["mqtt_topic_solar"] = current_config->mqtt_topic_solar;
-        (*doc)["mqtt_topic_grid"] = current_config->mqtt_topic_grid;
-        (*doc)["mqtt_solar_value_path"] = current_config->mqtt_solar_value_path;
-        (*doc)["mqtt_grid_value_path"] = current_config->mqtt_grid_value_path;
-
-        // Energy Monitor UI scaling (kW)
-        (*doc)["energy_solar_bar_max_kw"] = current_config->energy_solar_bar_max_kw;
-        (*doc)["energy_home_bar_max_kw"] = current_config->energy_home_bar_max_kw;
-        (*doc)["energy_grid_bar_max_kw"] = current_config->energy_grid_bar_max_kw;
-
-        // Energy Monitor warning behavior
-        (*doc)["energy_alarm_pulse_cycle_ms"] = current_config->energy_alarm_pulse_cycle_ms;
-        (*doc)["energy_alarm_pulse_peak_pct"] = current_config->energy_alarm_pulse_peak_pct;
-        (*doc)["energy_alarm_clear_delay_ms"] = current_config->energy_alarm_clear_delay_ms;
-        (*doc)["energy_alarm_clear_hysteresis_mkw"] = current_config->energy_alarm_clear_hysteresis_mkw;
-
-        // Energy Monitor per-category colors + thresholds
-        {
-            char c[8];
-
-            format_color_hex_rgb(current_config->energy_solar_colors.color_good_rgb, c);
-            (*doc)["energy_solar_color_good"] = c;
-            format_color_hex_rgb(current_config->energy_solar_colors.color_ok_rgb, c);
-            (*doc)["energy_solar_color_ok"] = c;
-            format_color_hex_rgb(current_config->energy_solar_colors.color_attention_rgb, c);
-            (*doc)["energy_solar_color_attention"] = c;
-            format_color_hex_rgb(current_config->energy_solar_colors.color_warning_rgb, c);
-            (*doc)["energy_solar_color_warning"] = c;
-            (*doc)["energy_solar_threshold_0_kw"] = mkw_to_kw(current_config->energy_solar_colors.threshold_mkw[0]);
-            (*doc)["energy_solar_threshold_1_kw"] = mkw_to_kw(current_config->energy_solar_colors.threshold_mkw[1]);
-            (*doc)["energy_solar_threshold_2_kw"] = mkw_to_kw(current_config->energy_solar_colors.threshold_mkw[2]);
-
-            format_color_hex_rgb(current_config->energy_home_colors.color_good_rgb, c);
-            (*doc)["energy_home_color_good"] = c;
-            format_color_hex_rgb(current_config->energy_home_colors.color_ok_rgb, c);
-            (*doc)["energy_home_color_ok"] = c;
-            format_color_hex_rgb(current_config->energy_home_colors.color_attention_rgb, c);
-            (*doc)["energy_home_color_attention"] = c;
-            format_color_hex_rgb(current_config->energy_home_colors.color_warning_rgb, c);
-            (*doc)["energy_home_color_warning"] = c;
-            (*doc)["energy_home_threshold_0_kw"] = mkw_to_kw(current_config->energy_home_colors.threshold_mkw[0]);
-            (*doc)["energy_home_threshold_1_kw"] = mkw_to_kw(current_config->energy_home_colors.threshold_mkw[1]);
-            (*doc)["energy_home_threshold_2_kw"] = mkw_to_kw(current_config->energy_home_colors.threshold_mkw[2]);
-
-            format_color_hex_rgb(current_config->energy_grid_colors.color_good_rgb, c);
-            (*doc)["energy_grid_color_good"] = c;
-            format_color_hex_rgb(current_config->energy_grid_colors.color_ok_rgb, c);
-            (*doc)["energy_grid_color_ok"] = c;
-            format_color_hex_rgb(current_config->energy_grid_colors.color_attention_rgb, c);
-            (*doc)["energy_grid_color_attention"] = c;
-            format_color_hex_rgb(current_config->energy_grid_colors.color_warning_rgb, c);
-            (*doc)["energy_grid_color_warning"] = c;
-            (*doc)["energy_grid_threshold_0_kw"] = mkw_to_kw(current_config->energy_grid_colors.threshold_mkw[0]);
-            (*doc)["energy_grid_threshold_1_kw"] = mkw_to_kw(current_config->energy_grid_colors.threshold_mkw[1]);
-            (*doc)["energy_grid_threshold_2_kw"] = mkw_to_kw(current_config->energy_grid_colors.threshold_mkw[2]);
-        }
-
-        // Web portal Basic Auth (password not returned)
-        (*doc)["basic_auth_enabled"] = current_config->basic_auth_enabled;
-        (*doc)["basic_auth_username"] = current_config->basic_auth_username;
-        (*doc)["basic_auth_password"] = "";
-        (*doc)["basic_auth_password_set"] = (strlen(current_config->basic_auth_password) > 0);
-
-        // Display settings
-        (*doc)["backlight_brightness"] = current_config->backlight_brightness;
+    void i32(const char *k, long v) {
+        key(k);
+        out_.print(v);
+    }
 
-        #if HAS_DISPLAY
-        // Screen saver settings
-        (*doc)["screen_saver_enabled"] = current_config->screen_saver_enabled;
-        (*doc)["screen_saver_timeout_seconds"] = current_config->screen_saver_timeout_seconds;
-        (*doc)["screen_saver_fade_out_ms"] = current_config->screen_saver_fade_out_ms;
-        (*doc)["screen_saver_fade_in_ms"] = current_config->screen_saver_fade_in_ms;
-        (*doc)["screen_saver_wake_on_touch"] = current_config->screen_saver_wake_on_touch;
-        #endif
+    void u32(const char *k, unsigned long v) {
+        key(k);
+        out_.print(v);
+    }
 
-        if (doc->overflowed()) {
-            LOGE("Portal", "/api/config JSON overflow");
+    void f32(const char *k, float v) {
+        key(k);
+        if (!isfinite(v)) {
+            out_.print("null");
+            return;
         }
+        char buf[24];
+        snprintf(buf, sizeof(buf), "%.6g", (double)v);
+        out_.print(buf);
+    }
+
+    void boolean(const char *k, bool v) {
+        key(k);
+        out_.print(v ? "true" : "false");
+    }
+
+private:
+    void key(const char *k) {
+        if (!first_) out_.write(',');
+        first_ = false;
+        quoted(k);
+        out_.write(':');
+    }
+
+    void quoted(const char *s) {
+        out_.write('"');
+        for (; *s; s++) {
+            const unsigned char c = (unsigned char)*s;
+            if (c == '"' || c == '\\') {
+                out_.write('\\');
+                out_.write(c);
+            } else if (c < 0x20) {
+                char esc[8];
+                snprintf(esc, sizeof(esc), "\\u%04x", (unsigned)c);
+                out_.print(esc);
+            } else {
+                out_.write(c);
+            }
+        }
+        out_.write('"');
+    }
+
+    Print &out_;
+    bool first_;
+};
+
+class CountingPrint : public Print {
+public:
+    size_t write(uint8_t) override { n++; return 1; }
+    size_t write(const uint8_t *, size_t len) override { n += len; return len; }
+    size_t n = 0;
+};
+
+static void write_color_category(ConfigJsonWriter &w, const char *prefix, const EnergyCategoryColorConfig &cfg) {
+    char key[48];
+    char c[8];
+
+    format_color_hex_rgb(cfg.color_good_rgb, c);
+    snprintf(key, sizeof(key), "%s_color_good", prefix);
+    w.str(key, c);
+    format_color_hex_rgb(cfg.color_ok_rgb, c);
+    snprintf(key, sizeof(key), "%s_color_ok", prefix);
+    w.str(key, c);
+    format_color_hex_rgb(cfg.color_attention_rgb, c);
+    snprintf(key, sizeof(key), "%s_color_attention", prefix);
+    w.str(key, c);
+    format_color_hex_rgb(cfg.color_warning_rgb, c);
+    snprintf(key, sizeof(key), "%s_color_warning", prefix);
+    w.str(key, c);
+    for (unsigned t = 0; t < 3; t++) {
+        snprintf(key, sizeof(key), "%s_threshold_%u_kw", prefix, t);
+        w.f32(key, mkw_to_kw(cfg.threshold_mkw[t]));
+    }
+}
+
+// Passwords are never returned (always "").
+static void write_config_json(Print &out, const DeviceConfig *config) {
+    ConfigJsonWriter w(out);
+    w.begin();
+
+    w.str("wifi_ssid", config->wifi_ssid);
+    w.str("wifi_password", "");
+    w.str("device_name", config->device_name);
+
+    // Sanitized name for display
+    char sanitized[CONFIG_DEVICE_NAME_MAX_LEN];
+    config_manager_sanitize_device_name(config->device_name, sanitized, CONFIG_DEVICE_NAME_MAX_LEN);
+    w.str("device_name_sanitized", sanitized);
+
+    // Fixed IP settings
+    w.str("fixed_ip", config->fixed_ip);
+    w.str("subnet_mask", config->subnet_mask);
+    w.str("gateway", config->gateway);
+    w.str("dns1", config->dns1);
+    w.str("dns2", config->dns2);
+
+    // Dummy setting
+    w.str("dummy_setting", config->dummy_setting);
+
+    // MQTT settings (password not returned)
+    w.str("mqtt_host", config->mqtt_host);
+    w.u32("mqtt_port", config->mqtt_port);
+    w.boolean("mqtt_tls", config->mqtt_tls);
+    w.boolean("mqtt_tls_supported", MQTT_TLS_ENABLED ? true : false);
+    w.str("mqtt_username", config->mqtt_username);
+    w.str("mqtt_password", "");
+    w.u32("mqtt_interval_seconds", config->mqtt_interval_seconds);
+
+    // Energy Monitor MQTT subscription settings
+    w.str("mqtt_topic_solar", config->mqtt_topic_solar);
+    w.str("mqtt_topic_grid", config->mqtt_topic_grid);
+    w.str("mqtt_solar_value_path", config->mqtt_solar_value_path);
+    w.str("mqtt_grid_value_path", config->mqtt_grid_value_path);
+
+    // Extra energy channels (flat keys: energy_aux_<i>_name/_topic/_value_path)
+    w.u32("energy_aux_channel_count", ENERGY_AUX_CHANNEL_COUNT);
+    #if ENERGY_AUX_CHANNEL_COUNT > 0
+    for (unsigned i = 0; i < ENERGY_AUX_CHANNEL_COUNT; i++) {
+        const EnergyChannelConfig *ch = &config->energy_aux_channels[i];
+        char key[32];
+        snprintf(key, sizeof(key), "energy_aux_%u_name", i);
+        w.str(key, ch->name);
+        snprintf(key, sizeof(key), "energy_aux_%u_topic", i);
+        w.str(key, ch->topic);
+        snprintf(key, sizeof(key), "energy_aux_%u_value_path", i);
+        w.str(key, ch->value_path);
+    }
+    #endif
+
+    // Energy Monitor UI scaling (kW)
+    w.f32("energy_solar_bar_max_kw", config->energy_solar_bar_max_kw);
+    w.f32("energy_home_bar_max_kw", config->energy_home_bar_max_kw);
+    w.f32("energy_grid_bar_max_kw", config->energy_grid_bar_max_kw);
+
+    // Energy Monitor warning behavior
+    w.u32("energy_alarm_pulse_cycle_ms", config->energy_alarm_pulse_cycle_ms);
+    w.u32("energy_alarm_pulse_peak_pct", config->energy_alarm_pulse_peak_pct);
+    w.u32("energy_alarm_clear_delay_ms", config->energy_alarm_clear_delay_ms);
+    w.i32("energy_alarm_clear_hysteresis_mkw", config->energy_alarm_clear_hysteresis_mkw);
+
+    // Energy Monitor per-category colors + thresholds
+    write_color_category(w, "energy_solar", config->energy_solar_colors);
+    write_color_category(w, "energy_home", config->energy_home_colors);
+    write_color_category(w, "energy_grid", config->energy_grid_colors);
+
+    // Web portal Basic Auth (password not returned)
+    w.boolean("basic_auth_enabled", config->basic_auth_enabled);
+    w.str("basic_auth_username", config->basic_auth_username);
+    w.str("basic_auth_password", "");
+    w.boolean("basic_auth_password_set", strlen(config->basic_auth_password) > 0);
+
+    // Display settings
+    w.u32("backlight_brightness", config->backlight_brightness);
+
+    #if HAS_DISPLAY
+    // Screen saver settings
+    w.boolean("screen_saver_enabled", config->screen_saver_enabled);
+    w.u32("screen_saver_timeout_seconds", config->screen_saver_timeout_seconds);
+    w.u32("screen_saver_fade_out_ms", config->screen_saver_fade_out_ms);
+    w.u32("screen_saver_fade_in_ms", config->screen_saver_fade_in_ms);
+    w.boolean("screen_saver_wake_on_touch", config->screen_saver_wake_on_touch);
+    #endif
+
+    #if HAS_IMAGE_API
+    // Scheduled image refresh
+    w.str("image_refresh_url", config->image_refresh_url);
+    w.u32("image_refresh_interval_seconds", config->image_refresh_interval_seconds);
+    #endif
+
+    #if P1_METER_ENABLED
+    // Local P1 meter energy source
+    w.str("p1_meter_url", config->p1_meter_url);
+    w.str("p1_meter_grid_path", config->p1_meter_grid_path);
+    w.str("p1_meter_solar_path", config->p1_meter_solar_path);
+    #endif
+
+    w.end();
+}
+
+static void config_copy_free(DeviceConfig *p) {
+    heap_caps_free(p);
+}
+
+void handleGetConfig(AsyncWebServerRequest *request) {
+    DeviceConfig *current_config = web_portal_get_current_config();
+    if (!current_config) {
+        request->send(500, "application/json", "{\"error\":\"Config not initialized\"}");
+        return;
     }
 
-    web_portal_send_json_chunked(request, doc);
+    // Private copy: a POST between two chunks must not change the body mid-response.
+    void *mem = board_psram_available() ? heap_caps_malloc(sizeof(DeviceConfig), MALLOC_CAP_SPIRAM | MALLOC_CAP_8BIT) : nullptr;
+    if (!mem) mem = heap_caps_malloc(sizeof(DeviceConfig), MALLOC_CAP_INTERNAL | MALLOC_CAP_8BIT);
+    if (!mem) {
+        web_portal_send_json_error(request, 503, "Out of memory");
+        return;
+    }
+    memcpy(mem, current_config, sizeof(DeviceConfig));
+    std::shared_ptr<const DeviceConfig> snapshot((DeviceConfig *)mem, config_copy_free);
+
+    CountingPrint counter;
+    write_config_json(counter, snapshot.get());
+    const size_t total_len = counter.n;
+
+    AsyncWebServerResponse *response = request->beginResponse(
+        "application/json",
+        total_len,
+        [snapshot, total_len](uint8_t *buffer, size_t max_len, size_t index) -> size_t {
+            if (index >= total_len) return 0;
+            const size_t remaining = total_len - index;
+            const size_t to_write = remaining < max_len ? remaining : max_len;
+            ChunkPrint cp(buffer, index, to_write);
+            write_config_json(cp, snapshot.get());
+            return to_write;
+        }
+    );
+    request->send(response);
 }
 
 void handlePostConfig(AsyncWebServerRequest *request, uint8_t *data, size_t len, size_t index, size_t total) {
@@ -251,18 +641,16 @@ void handlePostConfig(AsyncWebServerRequest *request, uint8_t *data, size_t len,
     char prev_mqtt_host[CONFIG_MQTT_HOST_MAX_LEN] = {0};
     char prev_mqtt_username[CONFIG_MQTT_USERNAME_MAX_LEN] = {0};
     char prev_mqtt_password[CONFIG_MQTT_PASSWORD_MAX_LEN] = {0};
-    char prev_mqtt_topic_solar[CONFIG_MQTT_TOPIC_MAX_LEN] = {0};
-    char prev_mqtt_topic_grid[CONFIG_MQTT_TOPIC_MAX_LEN] = {0};
     uint16_t prev_mqtt_port = current_config->mqtt_port;
+    bool prev_mqtt_tls = current_config->mqtt_tls;
 
     strlcpy(prev_mqtt_host, current_config->mqtt_host, sizeof(prev_mqtt_host));
     strlcpy(prev_mqtt_username, current_config->mqtt_username, sizeof(prev_mqtt_username));
     strlcpy(prev_mqtt_password, current_config->mqtt_password, sizeof(prev_mqtt_password));
-    strlcpy(prev_mqtt_topic_solar, current_config->mqtt_topic_solar, sizeof(prev_mqtt_topic_solar));
-    strlcpy(prev_mqtt_topic_grid, current_config->mqtt_topic_grid, sizeof(prev_mqtt_topic_grid));
+    const uint32_t prev_energy_topics_fp = mqtt_energy_topics_fingerprint(current_config);
     #endif
 
-    // Accumulate the full body (chunk-safe) then parse once.
+    // Parse the body incrementally as chunks arrive (chunk-safe).
     if (index == 0) {
         // If a previous upload got stuck, reset it.
         const uint32_t now = millis();
@@ -286,7 +674,7 @@ void handlePostConfig(AsyncWebServerRequest *request, uint8_t *data, size_t len,
         g_config_post.started_ms = now;
         g_config_post.total = total;
         g_config_post.received = 0;
-        g_config_post.buf = nullptr;
+        g_config_post.parser = nullptr;
         portEXIT_CRITICAL(&g_config_post_mux);
 
         if (total == 0 || total > WEB_PORTAL_CONFIG_MAX_JSON_BYTES) {
@@ -297,14 +685,8 @@ void handlePostConfig(AsyncWebServerRequest *request, uint8_t *data, size_t len,
             return;
         }
 
-        uint8_t* buf = nullptr;
-        if (psramFound()) {
-            buf = (uint8_t*)heap_caps_malloc(total + 1, MALLOC_CAP_SPIRAM | MALLOC_CAP_8BIT);
-        }
-        if (!buf) {
-            buf = (uint8_t*)heap_caps_malloc(total + 1, MALLOC_CAP_INTERNAL | MALLOC_CAP_8BIT);
-        }
-        if (!buf) {
+        ConfigPostParser* parser = new (std::nothrow) ConfigPostParser();
+        if (!parser) {
             portENTER_CRITICAL(&g_config_post_mux);
             config_post_reset();
             portEXIT_CRITICAL(&g_config_post_mux);
@@ -313,14 +695,15 @@ void handlePostConfig(AsyncWebServerRequest *request, uint8_t *data, size_t len,
         }
 
         portENTER_CRITICAL(&g_config_post_mux);
-        g_config_post.buf = buf;
+        g_config_post.parser = parser;
         portEXIT_CRITICAL(&g_config_post_mux);
     }
 
-    // Copy this chunk.
+    // Chunks arrive in order; parse this one.
     portENTER_CRITICAL(&g_config_post_mux);
-    const bool ok = g_config_post.in_progress && g_config_post.buf && g_config_post.total == total && (index + len) <= total;
-    uint8_t* dst = g_config_post.buf;
+    const bool ok = g_config_post.in_progress && g_config_post.parser && g_config_post.total == total &&
+                    index == g_config_post.received && (index + len) <= total;
+    ConfigPostParser* parser = g_config_post.parser;
     portEXIT_CRITICAL(&g_config_post_mux);
 
     if (!ok) {
@@ -331,49 +714,31 @@ void handlePostConfig(AsyncWebServerRequest *request, uint8_t *data, size_t len,
         return;
     }
 
-    memcpy(dst + index, data, len);
+    parser->feed(data, len);
 
     portENTER_CRITICAL(&g_config_post_mux);
-    const size_t new_received = index + len;
-    if (new_received > g_config_post.received) {
-        g_config_post.received = new_received;
-    }
+    g_config_post.received = index + len;
     const bool done = (g_config_post.received >= g_config_post.total);
     portEXIT_CRITICAL(&g_config_post_mux);
 
-    if (!done) {
-        // More chunks to come.
-        return;
-    }
-
-    // Finalize buffer and parse.
-    uint8_t* body = nullptr;
-    size_t body_len = 0;
-    portENTER_CRITICAL(&g_config_post_mux);
-    body = g_config_post.buf;
-    body_len = g_config_post.total;
-    if (body) body[body_len] = 0;
-    portEXIT_CRITICAL(&g_config_post_mux);
-
-    BasicJsonDocument<PsramJsonAllocator> doc(4096);
-    DeserializationError error = deserializeJson(doc, body, body_len);
-
-    if (error) {
-        LOGE("Portal", "JSON parse error: %s", error.c_str());
-        if (error == DeserializationError::NoMemory) {
-            request->send(413, "application/json", "{\"success\":false,\"message\":\"JSON body too large\"}");
-            portENTER_CRITICAL(&g_config_post_mux);
-            config_post_reset();
-            portEXIT_CRITICAL(&g_config_post_mux);
-            return;
-        }
-        request->send(400, "application/json", "{\"success\":false,\"message\":\"Invalid JSON\"}");
+    if (parser->state == ConfigPostParser::Error || (done && parser->state != ConfigPostParser::Done)) {
+        const int code = (parser->state == ConfigPostParser::Error) ? parser->error_code : 400;
+        const char* message = (parser->state == ConfigPostParser::Error) ? parser->error : "Invalid JSON";
+        LOGE("Portal", "JSON parse error: %s", message);
+        web_portal_send_json_error(request, code, message);
         portENTER_CRITICAL(&g_config_post_mux);
         config_post_reset();
         portEXIT_CRITICAL(&g_config_post_mux);
         return;
     }
 
+    if (!done) {
+        // More chunks to come.
+        return;
+    }
+
+    PooledJsonDocument& doc = parser->doc;
+
     // Partial update: only update fields that are present in the request
     // This allows different pages to update only their relevant fields
 
@@ -387,6 +752,10 @@ void handlePostConfig(AsyncWebServerRequest *request, uint8_t *data, size_t len,
         return;
     }
 
+    // Fields change in place from here on; a write-behind save must not copy
+    // the config halfway through.
+    ConfigEditLock edit_lock;
+
     // WiFi SSID - only update if field exists in JSON
     if (doc.containsKey("wifi_ssid")) {
         strlcpy(current_config->wifi_ssid, doc["wifi_ssid"] | "", CONFIG_SSID_MAX_LEN);
@@ -459,6 +828,15 @@ void handlePostConfig(AsyncWebServerRequest *request, uint8_t *data, size_t len,
     }
 
     // MQTT interval seconds
+    if (doc.containsKey("mqtt_tls")) {
+        if (doc["mqtt_tls"].is<const char*>()) {
+            const char* v = doc["mqtt_tls"];
+            current_config->mqtt_tls = (v && (strcmp(v, "1") == 0 || strcasecmp(v, "true") == 0 || strcasecmp(v, "on") == 0));
+        } else {
+            current_config->mqtt_tls = (bool)(doc["mqtt_tls"] | false);
+        }
+    }
+
     if (doc.containsKey("mqtt_interval_seconds")) {
         if (doc["mqtt_interval_seconds"].is<const char*>()) {
             const char* int_str = doc["mqtt_interval_seconds"];
@@ -488,6 +866,28 @@ void handlePostConfig(AsyncWebServerRequest *request, uint8_t *data, size_t len,
         strlcpy(current_config->mqtt_grid_value_path, ".", CONFIG_MQTT_VALUE_PATH_MAX_LEN);
     }
 
+    #if ENERGY_AUX_CHANNEL_COUNT > 0
+    for (unsigned i = 0; i < ENERGY_AUX_CHANNEL_COUNT; i++) {
+        EnergyChannelConfig* ch = &current_config->energy_aux_channels[i];
+        char key[32];
+        snprintf(key, sizeof(key), "energy_aux_%u_name", i);
+        if (doc.containsKey(key)) {
+            strlcpy(ch->name, doc[key] | "", CONFIG_ENERGY_CHANNEL_NAME_MAX_LEN);
+        }
+        snprintf(key, sizeof(key), "energy_aux_%u_topic", i);
+        if (doc.containsKey(key)) {
+            strlcpy(ch->topic, doc[key] | "", CONFIG_MQTT_TOPIC_MAX_LEN);
+        }
+        snprintf(key, sizeof(key), "energy_aux_%u_value_path", i);
+        if (doc.containsKey(key)) {
+            strlcpy(ch->value_path, doc[key] | ".", CONFIG_MQTT_VALUE_PATH_MAX_LEN);
+        }
+        if (strlen(ch->value_path) == 0) {
+            strlcpy(ch->value_path, ".", CONFIG_MQTT_VALUE_PATH_MAX_LEN);
+        }
+    }
+    #endif
+
     // Energy Monitor UI scaling (kW)
     auto read_kw = [&](const char* key, float* out_kw) {
         if (!doc.containsKey(key) || !out_kw) return;
@@ -734,13 +1134,45 @@ void handlePostConfig(AsyncWebServerRequest *request, uint8_t *data, size_t len,
     }
     #endif
 
+    #if HAS_IMAGE_API
+    // Scheduled image refresh settings
+    if (doc.containsKey("image_refresh_url")) {
+        strlcpy(current_config->image_refresh_url, doc["image_refresh_url"] | "", CONFIG_IMAGE_REFRESH_URL_MAX_LEN);
+    }
+
+    if (doc.containsKey("image_refresh_interval_seconds")) {
+        if (doc["image_refresh_interval_seconds"].is<const char*>()) {
+            const char* v = doc["image_refresh_interval_seconds"];
+            current_config->image_refresh_interval_seconds = (uint16_t)atoi(v ? v : "0");
+        } else {
+            current_config->image_refresh_interval_seconds = (uint16_t)(doc["image_refresh_interval_seconds"] | 0);
+        }
+    }
+    #endif
+
+    #if P1_METER_ENABLED
+    // Local P1 meter settings (picked up live by the polling task)
+    if (doc.containsKey("p1_meter_url")) {
+        strlcpy(current_config->p1_meter_url, doc["p1_meter_url"] | "", CONFIG_P1_METER_URL_MAX_LEN);
+    }
+    if (doc.containsKey("p1_meter_grid_path")) {
+        strlcpy(current_config->p1_meter_grid_path, doc["p1_meter_grid_path"] | "", CONFIG_MQTT_VALUE_PATH_MAX_LEN);
+    }
+    if (strlen(current_config->p1_meter_grid_path) == 0) {
+        strlcpy(current_config->p1_meter_grid_path, "active_power_w", CONFIG_MQTT_VALUE_PATH_MAX_LEN);
+    }
+    if (doc.containsKey("p1_meter_solar_path")) {
+        strlcpy(current_config->p1_meter_solar_path, doc["p1_meter_solar_path"] | "", CONFIG_MQTT_VALUE_PATH_MAX_LEN);
+    }
+    #endif
+
     #if HAS_MQTT
     const bool mqtt_changed = (prev_mqtt_port != current_config->mqtt_port) ||
+                              (prev_mqtt_tls != current_config->mqtt_tls) ||
                               (strcmp(prev_mqtt_host, current_config->mqtt_host) != 0) ||
                               (strcmp(prev_mqtt_username, current_config->mqtt_username) != 0) ||
                               (strcmp(prev_mqtt_password, current_config->mqtt_password) != 0) ||
-                              (strcmp(prev_mqtt_topic_solar, current_config->mqtt_topic_solar) != 0) ||
-                              (strcmp(prev_mqtt_topic_grid, current_config->mqtt_topic_grid) != 0);
+                              (prev_energy_topics_fp != mqtt_energy_topics_fingerprint(current_config));
     #endif
 
     current_config->magic = CONFIG_MAGIC;
@@ -754,28 +1186,45 @@ void handlePostConfig(AsyncWebServerRequest *request, uint8_t *data, size_t len,
         return;
     }
 
+    if (request->hasParam("no_reboot")) {
+        // Live tuning: the changes are already in effect; NVS is written once the
+        // edits settle (CONFIG_PERSIST_DEBOUNCE_MS), so repeated POSTs coalesce.
+        energy_thresholds_compile(current_config);
+        config_manager_save_deferred(current_config);
+        #if HAS_DISPLAY
+        display_manager_notify_info_changed();  // device name may have changed
+        #endif
+        request->send(200, "application/json", "{\"success\":true,\"message\":\"Configuration applied, save pending\",\"persist_pending\":true}");
+
+        portENTER_CRITICAL(&g_config_post_mux);
+        config_post_reset();
+        portEXIT_CRITICAL(&g_config_post_mux);
+
+        #if HAS_MQTT
+        if (mqtt_changed) {
+            g_pending_mqtt_reconnect_request = true;
+        }
+        #endif
+        return;
+    }
+
     // Save to NVS
     if (config_manager_save(current_config)) {
         LOGI("Portal", "Config saved");
-        request->send(200, "application/json", "{\"success\":true,\"message\":\"Configuration saved\"}");
+        energy_thresholds_compile(current_config);
+        char body[80];
+        snprintf(body, sizeof(body), "{\"success\":true,\"message\":\"Configuration saved\",\"keys_written\":%u}",
+            (unsigned)config_manager_last_save_key_count());
+        request->send(200, "application/json", body);
 
         portENTER_CRITICAL(&g_config_post_mux);
         config_post_reset();
         portEXIT_CRITICAL(&g_config_post_mux);
 
-        // Check for no_reboot parameter
-        if (!request->hasParam("no_reboot")) {
-            LOGI("Portal", "Rebooting device");
-            // Schedule reboot after response is sent
-            delay(100);
-            ESP.restart();
-        } else {
-            #if HAS_MQTT
-            if (mqtt_changed) {
-                g_pending_mqtt_reconnect_request = true;
-            }
-            #endif
-        }
+        LOGI("Portal", "Rebooting device");
+        // Schedule reboot after response is sent
+        delay(100);
+        ESP.restart();
     } else {
         LOGE("Portal", "Config save failed");
         request->send(500, "application/json", "{\"success\":false,\"message\":\"Failed to save\"}");
@@ -3,7 +3,7 @@
 
 #include <ESPAsyncWebServer.h>
 
-void handleGetConfig(AsyncWebServerRequest *request);
+void handleGetConfig(AsyncWebServerRequest *request);  // behind ADMIT(): auth-gated by the wrapper
 void handlePostConfig(AsyncWebServerRequest *request, uint8_t *data, size_t len, size_t index, size_t total);
 void handleDeleteConfig(AsyncWebServerRequest *request);
 
@@ -7,12 +7,17 @@
 #include "device_telemetry.h"
 #include "repo_slug_config.h"
 #include "log_manager.h"
+#include "loop_scheduler.h"
 #include "psram_json_allocator.h"
 #include "project_branding.h"
 #include "web_portal_json.h"
 #if HEALTH_HISTORY_ENABLED
 #include "health_history.h"
 #endif
+#include "energy_history.h"
+#include "energy_monitor.h"
+#include "energy_totals.h"
+#include "boot_timeline.h"
 #include "../version.h"
 
 #include <ArduinoJson.h>
@@ -24,8 +29,6 @@
 
 // GET /api/mode - Return portal mode (core vs full)
 void handleGetMode(AsyncWebServerRequest *request) {
-    if (!portal_auth_gate(request)) return;
-
     AsyncResponseStream *response = request->beginResponseStream("application/json");
     response->print("{\"mode\":\"");
     response->print(web_portal_is_ap_mode_active() ? "core" : "full");
@@ -37,8 +40,6 @@ void handleGetMode(AsyncWebServerRequest *request) {
 
 // GET /api/info - Get device information
 void handleGetVersion(AsyncWebServerRequest *request) {
-    if (!portal_auth_gate(request)) return;
-
     AsyncResponseStream *response = request->beginResponseStream("application/json");
     response->print("{\"version\":\"");
     response->print(FIRMWARE_VERSION);
@@ -104,10 +105,18 @@ void handleGetVersion(AsyncWebServerRequest *request) {
         response->print((unsigned long)hist_params.period_ms);
         response->print(",\"health_history_samples\":");
         response->print((unsigned long)hist_params.samples);
+        response->print(",\"health_history_previous_samples\":");
+        response->print((unsigned long)health_history_previous_count());
     #else
         response->print(",\"health_history_available\":false");
         response->print(",\"health_history_period_ms\":0");
         response->print(",\"health_history_samples\":0");
+        response->print(",\"health_history_previous_samples\":0");
+    #endif
+
+    #if BOOT_TIMELINE_SUPPORTED
+        response->print(",\"boot_timeline\":");
+        boot_timeline_write_json(*response);
     #endif
 
     response->print(",\"github_owner\":\"");
@@ -172,9 +181,30 @@ void handleGetVersion(AsyncWebServerRequest *request) {
 
 // GET /api/health - Get device health statistics
 void handleGetHealth(AsyncWebServerRequest *request) {
-    if (!portal_auth_gate(request)) return;
+    #if HEALTH_SNAPSHOT_ENABLED
+    // Serve the pre-serialized snapshot; the response holds a reference until sent.
+    std::shared_ptr<const DeviceHealthSnapshot> snap = device_telemetry_get_health_snapshot();
+    if (snap) {
+        const size_t total_len = snap->api_len;
+        AsyncWebServerResponse *response = request->beginResponse(
+            "application/json",
+            total_len,
+            [snap, total_len](uint8_t *buffer, size_t max_len, size_t index) -> size_t {
+                if (index >= total_len) return 0;
+                const size_t n = min(total_len - index, max_len);
+                memcpy(buffer, snap->api_json + index, n);
+                return n;
+            }
+        );
+        char age[12];
+        snprintf(age, sizeof(age), "%lu", (unsigned long)(millis() - snap->built_ms));
+        response->addHeader("X-Health-Age-Ms", age);
+        request->send(response);
+        return;
+    }
+    #endif
 
-    std::shared_ptr<BasicJsonDocument<PsramJsonAllocator>> doc = make_psram_json_doc(2048);
+    std::shared_ptr<PooledJsonDocument> doc = make_pooled_json_doc(kDeviceTelemetryApiDocCapacity);
     if (doc && doc->capacity() > 0) {
         device_telemetry_fill_api(*doc);
         if (doc->overflowed()) {
@@ -185,94 +215,548 @@ void handleGetHealth(AsyncWebServerRequest *request) {
     web_portal_send_json_chunked(request, doc);
 }
 
-// GET /api/health/history - Get device-side health history for sparklines
-void handleGetHealthHistory(AsyncWebServerRequest *request) {
-    if (!portal_auth_gate(request)) return;
+// GET /api/health/tasks - Per-task CPU share, per-core utilization and stack high-water marks
+void handleGetHealthTasks(AsyncWebServerRequest *request) {
+    std::shared_ptr<PooledJsonDocument> doc = make_pooled_json_doc(6656);
+    if (doc && doc->capacity() > 0) {
+        device_telemetry_fill_tasks(*doc, kDeviceTelemetryMaxTasks);
+
+        // Cooperative jobs multiplexed on the loop task (see loop_scheduler.h).
+        JsonArray jobs = doc->createNestedArray("loop_jobs");
+        const size_t job_count = loop_scheduler_job_count();
+        for (size_t i = 0; i < job_count; i++) {
+            LoopJobStats st;
+            if (!loop_scheduler_get_stats(i, &st)) break;
+            JsonObject j = jobs.createNestedObject();
+            j["name"] = st.name;
+            j["period_ms"] = st.period_ms;
+            j["budget_us"] = st.budget_us;
+            j["runs"] = st.runs;
+            j["overruns"] = st.overruns;
+            j["late"] = st.late;
+            j["avg_us"] = st.avg_us;
+            j["max_us"] = st.max_us;
+        }
+        if (doc->overflowed()) {
+            LOGE("Portal", "/api/health/tasks JSON overflow");
+        }
+    }
+
+    web_portal_send_json_chunked(request, doc);
+}
+
+#if HEALTH_HISTORY_ENABLED
+enum class HealthHistoryFormat : uint8_t {
+    Json = 0,
+    Cbor,
+    Binary,
+};
+
+// Columns of the json/cbor bodies, in output order.
+static const char* const kHealthHistoryFields[] = {
+    "cpu_usage",
+    "uptime_ms",
+    "heap_internal_free",
+    "heap_internal_free_min_window",
+    "heap_internal_free_max_window",
+    "psram_free",
+    "psram_free_min_window",
+    "psram_free_max_window",
+    "heap_internal_largest",
+    "heap_internal_largest_min_window",
+    "heap_internal_largest_max_window",
+};
+static constexpr size_t kHealthHistoryFieldCount = sizeof(kHealthHistoryFields) / sizeof(kHealthHistoryFields[0]);
+
+// Binary body: 16-byte header, then one little-endian record per sample.
+static constexpr uint16_t kHealthHistoryBinaryRecord = 44;
+
+// false => null (cpu_usage unknown)
+static bool health_history_field(const HealthHistorySample& s, size_t field, uint32_t* out) {
+    switch (field) {
+        case 0:
+            if (s.cpu_usage < 0) return false;
+            *out = (uint32_t)s.cpu_usage;
+            return true;
+        case 1: *out = s.uptime_ms; return true;
+        case 2: *out = s.heap_internal_free; return true;
+        case 3: *out = s.heap_internal_free_min_window; return true;
+        case 4: *out = s.heap_internal_free_max_window; return true;
+        case 5: *out = s.psram_free; return true;
+        case 6: *out = s.psram_free_min_window; return true;
+        case 7: *out = s.psram_free_max_window; return true;
+        case 8: *out = s.heap_internal_largest; return true;
+        case 9: *out = s.heap_internal_largest_min_window; return true;
+        default: *out = s.heap_internal_largest_max_window; return true;
+    }
+}
+
+// previous: the samples restored from RTC memory (?boot=previous) instead of the live ring.
+static size_t health_history_source_count(bool previous) {
+    return previous ? health_history_previous_count() : health_history_count();
+}
+
+static bool health_history_source_get(bool previous, size_t index, HealthHistorySample* out) {
+    return previous ? health_history_get_previous_sample(index, out) : health_history_get_sample(index, out);
+}
+
+// Index of the first sample with uptime_ms >= t (millis()-wrap safe; uptimes are
+// increasing within the ring). Returns count when none.
+static size_t health_history_lower_bound(bool previous, uint32_t t) {
+    size_t lo = 0;
+    size_t hi = health_history_source_count(previous);
+    while (lo < hi) {
+        const size_t mid = lo + (hi - lo) / 2;
+        HealthHistorySample s = {};
+        if (!health_history_source_get(previous, mid, &s)) {
+            hi = mid;
+            break;
+        }
+        if ((int32_t)(s.uptime_ms - t) < 0) lo = mid + 1;
+        else hi = mid;
+    }
+    return lo;
+}
+
+// Streaming state for /api/health/history. The ring may advance while the body is
+// sent, so every column re-locates its first sample by uptime instead of by index.
+struct HealthHistoryStream {
+    HealthHistoryFormat format;
+    bool previous;          // previous boot (RTC restore) instead of the live ring
+    size_t count;           // samples in this response
+    uint32_t first_uptime;  // uptime_ms of the first sample
+    size_t field;           // column being sent (json/cbor)
+    size_t base;            // ring index of first_uptime for the current column
+    size_t row;
+    bool footer_done;
+    uint8_t pending[224];
+    size_t pending_len;
+    size_t pending_pos;
+};
+
+static size_t cbor_head(uint8_t* p, uint8_t major, uint32_t v) {
+    const uint8_t mt = (uint8_t)(major << 5);
+    if (v < 24) { p[0] = (uint8_t)(mt | v); return 1; }
+    if (v <= 0xFF) { p[0] = (uint8_t)(mt | 24); p[1] = (uint8_t)v; return 2; }
+    if (v <= 0xFFFF) { p[0] = (uint8_t)(mt | 25); p[1] = (uint8_t)(v >> 8); p[2] = (uint8_t)v; return 3; }
+    p[0] = (uint8_t)(mt | 26);
+    p[1] = (uint8_t)(v >> 24); p[2] = (uint8_t)(v >> 16); p[3] = (uint8_t)(v >> 8); p[4] = (uint8_t)v;
+    return 5;
+}
+
+static size_t cbor_text(uint8_t* p, const char* s) {
+    const size_t n = strlen(s);
+    const size_t h = cbor_head(p, 3, (uint32_t)n);
+    memcpy(p + h, s, n);
+    return h + n;
+}
+
+static size_t put_le32(uint8_t* p, uint32_t v) {
+    p[0] = (uint8_t)v; p[1] = (uint8_t)(v >> 8); p[2] = (uint8_t)(v >> 16); p[3] = (uint8_t)(v >> 24);
+    return 4;
+}
+
+static size_t put_le16(uint8_t* p, uint16_t v) {
+    p[0] = (uint8_t)v; p[1] = (uint8_t)(v >> 8);
+    return 2;
+}
+
+static void health_history_header(HealthHistoryStream* st, bool incremental, uint32_t next_since) {
+    const HealthHistoryParams params = health_history_params();
+    const size_t capacity = st->previous ? health_history_previous_count() : health_history_capacity();
+    uint8_t* p = st->pending;
+    size_t len = 0;
+
+    if (st->format == HealthHistoryFormat::Json) {
+        len = (size_t)snprintf((char*)p, sizeof(st->pending),
+            "{\"available\":true,\"period_ms\":%lu,\"seconds\":%lu,\"samples\":%lu,\"count\":%u,\"capacity\":%u,"
+            "\"incremental\":%s,\"next_since\":%lu,\"boot\":\"%s\"",
+            (unsigned long)params.period_ms, (unsigned long)params.seconds, (unsigned long)params.samples,
+            (unsigned)st->count, (unsigned)capacity, incremental ? "true" : "false", (unsigned long)next_since,
+            st->previous ? "previous" : "current");
+        if (len >= sizeof(st->pending)) len = sizeof(st->pending) - 1;
+    } else if (st->format == HealthHistoryFormat::Cbor) {
+        len += cbor_head(p + len, 5, (uint32_t)(9 + kHealthHistoryFieldCount));
+        len += cbor_text(p + len, "available");
+        p[len++] = 0xF5;  // true
+        len += cbor_text(p + len, "period_ms");
+        len += cbor_head(p + len, 0, params.period_ms);
+        len += cbor_text(p + len, "seconds");
+        len += cbor_head(p + len, 0, params.seconds);
+        len += cbor_text(p + len, "samples");
+        len += cbor_head(p + len, 0, params.samples);
+        len += cbor_text(p + len, "count");
+        len += cbor_head(p + len, 0, (uint32_t)st->count);
+        len += cbor_text(p + len, "capacity");
+        len += cbor_head(p + len, 0, (uint32_t)capacity);
+        len += cbor_text(p + len, "incremental");
+        p[len++] = incremental ? 0xF5 : 0xF4;
+        len += cbor_text(p + len, "next_since");
+        len += cbor_head(p + len, 0, next_since);
+        len += cbor_text(p + len, "boot");
+        len += cbor_text(p + len, st->previous ? "previous" : "current");
+    } else {
+        // "HH", version, flags, record size, count, period, next_since
+        p[len++] = 'H';
+        p[len++] = 'H';
+        p[len++] = 1;
+        p[len++] = (uint8_t)((incremental ? 1 : 0) | (st->previous ? 2 : 0));
+        len += put_le16(p + len, kHealthHistoryBinaryRecord);
+        len += put_le16(p + len, (uint16_t)st->count);
+        len += put_le32(p + len, params.period_ms);
+        len += put_le32(p + len, next_since);
+    }
+    st->pending_len = len;
+}
+
+// Refill `pending` with the next piece of the body; false when the body is complete.
+static bool health_history_refill(HealthHistoryStream* st) {
+    uint8_t* p = st->pending;
+    size_t len = 0;
+    const size_t cap = sizeof(st->pending);
+    st->pending_pos = 0;
+    st->pending_len = 0;
+
+    if (st->format == HealthHistoryFormat::Binary) {
+        if (st->row >= st->count) return false;
+        if (st->row == 0) st->base = health_history_lower_bound(st->previous, st->first_uptime);
+        // Whole records only (44 bytes each).
+        while (st->row < st->count && len + kHealthHistoryBinaryRecord <= cap) {
+            HealthHistorySample s = {};
+            (void)health_history_source_get(st->previous, st->base + st->row, &s);
+            len += put_le32(p + len, s.uptime_ms);
+            len += put_le16(p + len, (uint16_t)s.cpu_usage);
+            len += put_le16(p + len, 0);
+            for (size_t f = 2; f < kHealthHistoryFieldCount; f++) {
+                uint32_t v = 0;
+                (void)health_history_field(s, f, &v);
+                len += put_le32(p + len, v);
+            }
+            st->row++;
+        }
+        st->pending_len = len;
+        return true;
+    }
+
+    const bool json = st->format == HealthHistoryFormat::Json;
+    if (st->field >= kHealthHistoryFieldCount) {
+        if (st->footer_done) return false;
+        st->footer_done = true;
+        if (!json) return false;  // definite-length CBOR map: nothing to close
+        p[0] = '}';
+        st->pending_len = 1;
+        return true;
+    }
+
+    const char* name = kHealthHistoryFields[st->field];
+    if (st->row == 0) {
+        st->base = health_history_lower_bound(st->previous, st->first_uptime);
+        if (json) {
+            len += (size_t)snprintf((char*)p + len, cap - len, ",\"%s\":[", name);
+        } else {
+            len += cbor_text(p + len, name);
+            len += cbor_head(p + len, 4, (uint32_t)st->count);
+        }
+    }
+
+    // A handful of values per refill (each at most 11 bytes).
+    while (st->row < st->count && len + 16 <= cap) {
+        HealthHistorySample s = {};
+        uint32_t v = 0;
+        const bool have = health_history_source_get(st->previous, st->base + st->row, &s) && health_history_field(s, st->field, &v);
+        if (json) {
+            if (st->row > 0) p[len++] = ',';
+            len += have ? (size_t)snprintf((char*)p + len, cap - len, "%lu", (unsigned long)v)
+                        : (size_t)snprintf((char*)p + len, cap - len, "null");
+        } else if (have) {
+            len += cbor_head(p + len, 0, v);
+        } else {
+            p[len++] = 0xF6;  // null
+        }
+        st->row++;
+    }
+
+    if (st->row >= st->count) {
+        if (json && len < cap) p[len++] = ']';
+        st->field++;
+        st->row = 0;
+    }
+    st->pending_len = len;
+    return true;
+}
+#endif // HEALTH_HISTORY_ENABLED
 
+// GET /api/health/history[?format=json|cbor|binary][&since=<uptime_ms>][&boot=previous]
+// Device-side health history for sparklines, streamed straight from the ring.
+// boot=previous serves the samples restored from RTC memory after a reset.
+void handleGetHealthHistory(AsyncWebServerRequest *request) {
     #if !HEALTH_HISTORY_ENABLED
         request->send(404, "application/json", "{\"available\":false}");
         return;
+    #else
+
+    bool previous = false;
+    if (request->hasParam("boot")) {
+        const String b = request->getParam("boot")->value();
+        if (b == "previous") previous = true;
+        else if (b != "current") {
+            web_portal_send_json_error(request, 400, "boot must be current or previous");
+            return;
+        }
+    }
+
+    if (!health_history_available() || (previous && health_history_previous_count() == 0)) {
+        request->send(404, "application/json", "{\"available\":false}");
+        return;
+    }
+
+    HealthHistoryFormat format = HealthHistoryFormat::Json;
+    if (request->hasParam("format")) {
+        const String f = request->getParam("format")->value();
+        if (f == "cbor") format = HealthHistoryFormat::Cbor;
+        else if (f == "binary") format = HealthHistoryFormat::Binary;
+        else if (f != "json") {
+            web_portal_send_json_error(request, 400, "format must be json, cbor or binary");
+            return;
+        }
+    }
+
+    const size_t total = health_history_source_count(previous);
+    HealthHistorySample newest = {};
+    const bool have_newest = total > 0 && health_history_source_get(previous, total - 1, &newest);
+
+    // since=<uptime_ms>: only samples taken after it. next_since is the newest
+    // sample's stored (whole-second) uptime, the same value its row reports on every
+    // read, so passing it back never repeats that sample. A cursor ahead of the
+    // newest sample (device rebooted) falls back to the full history.
+    size_t start = 0;
+    bool incremental = false;
+    if (request->hasParam("since") && have_newest) {
+        const uint32_t since = (uint32_t)strtoul(request->getParam("since")->value().c_str(), nullptr, 10);
+        if ((int32_t)(newest.uptime_ms - since) >= 0) {
+            start = health_history_lower_bound(previous, since + 1);
+            incremental = true;
+        }
+    }
+
+    auto st = std::make_shared<HealthHistoryStream>();
+    st->format = format;
+    st->previous = previous;
+    st->count = total > start ? total - start : 0;
+    st->first_uptime = 0;
+    if (st->count > 0) {
+        HealthHistorySample first = {};
+        (void)health_history_source_get(previous, start, &first);
+        st->first_uptime = first.uptime_ms;
+    }
+    st->field = 0;
+    st->base = start;
+    st->row = 0;
+    st->footer_done = false;
+    st->pending_pos = 0;
+    health_history_header(st.get(), incremental, have_newest ? newest.uptime_ms : 0);
+
+    static const char* const kContentTypes[] = {"application/json", "application/cbor", "application/octet-stream"};
+    AsyncWebServerResponse *response = request->beginChunkedResponse(
+        kContentTypes[(size_t)format],
+        [st](uint8_t *buffer, size_t max_len, size_t) -> size_t {
+            size_t written = 0;
+            while (written < max_len) {
+                if (st->pending_pos < st->pending_len) {
+                    const size_t n = min(st->pending_len - st->pending_pos, max_len - written);
+                    memcpy(buffer + written, st->pending + st->pending_pos, n);
+                    st->pending_pos += n;
+                    written += n;
+                    continue;
+                }
+                if (!health_history_refill(st.get())) break;
+            }
+            return written;
+        }
+    );
+    response->addHeader("Cache-Control", "no-store");
+    request->send(response);
     #endif
+}
 
-    if (!health_history_available()) {
+// Streaming state for /api/energy/history (rows can exceed a single TCP window,
+// so the body is generated per chunk instead of buffered).
+struct EnergyHistoryStream {
+    EnergyHistoryTier tier;
+    size_t count;
+    size_t next_row;
+    bool footer_done;
+    char pending[96];
+    size_t pending_len;
+    size_t pending_pos;
+};
+
+static size_t energy_history_format_kw(char* out, size_t out_len, int16_t dw) {
+    if (dw == kEnergyHistoryNoValue) return (size_t)snprintf(out, out_len, "null");
+    const int v = (int)dw;
+    const int a = v < 0 ? -v : v;
+    return (size_t)snprintf(out, out_len, "%s%d.%02d", v < 0 ? "-" : "", a / 100, a % 100);
+}
+
+// GET /api/energy/history?tier=1s|1m|15m - Device-side solar/grid history
+void handleGetEnergyHistory(AsyncWebServerRequest *request) {
+    if (!energy_history_available()) {
         request->send(404, "application/json", "{\"available\":false}");
         return;
     }
 
-    const HealthHistoryParams params = health_history_params();
-    const size_t count = health_history_count();
-    const size_t capacity = health_history_capacity();
+    EnergyHistoryTier tier = EnergyHistoryTier::Fine;
+    if (request->hasParam("tier")) {
+        const String t = request->getParam("tier")->value();
+        if (t == "1m" || t == "1") tier = EnergyHistoryTier::Minute;
+        else if (t == "15m" || t == "2") tier = EnergyHistoryTier::Quarter;
+        else if (t != "1s" && t != "0") {
+            web_portal_send_json_error(request, 400, "tier must be 1s, 1m or 15m");
+            return;
+        }
+    }
 
-    AsyncResponseStream *response = request->beginResponseStream("application/json");
+    static const char* const kTierNames[] = {"1s", "1m", "15m"};
+    const EnergyHistoryTierInfo info = energy_history_tier_info(tier);
+
+    auto st = std::make_shared<EnergyHistoryStream>();
+    st->tier = tier;
+    st->count = info.count;
+    st->next_row = 0;
+    st->footer_done = false;
+    st->pending_pos = 0;
+    st->pending_len = (size_t)snprintf(
+        st->pending, sizeof(st->pending),
+        "{\"available\":true,\"tier\":\"%s\",\"period_ms\":%lu,\"capacity\":%u,\"count\":%u,\"last_sample_ms\":%lu,\"now_ms\":%lu,\"rows\":[",
+        kTierNames[(size_t)tier],
+        (unsigned long)info.period_ms,
+        (unsigned)info.capacity,
+        (unsigned)info.count,
+        (unsigned long)info.last_sample_ms,
+        (unsigned long)millis()
+    );
+    if (st->pending_len >= sizeof(st->pending)) st->pending_len = sizeof(st->pending) - 1;
+
+    AsyncWebServerResponse *response = request->beginChunkedResponse(
+        "application/json",
+        [st](uint8_t *buffer, size_t max_len, size_t) -> size_t {
+            size_t written = 0;
+            while (written < max_len) {
+                if (st->pending_pos < st->pending_len) {
+                    const size_t n = min(st->pending_len - st->pending_pos, max_len - written);
+                    memcpy(buffer + written, st->pending + st->pending_pos, n);
+                    st->pending_pos += n;
+                    written += n;
+                    continue;
+                }
+
+                // Refill pending with the next row (or the footer).
+                st->pending_pos = 0;
+                st->pending_len = 0;
+                if (st->next_row < st->count) {
+                    EnergyHistorySample s = {kEnergyHistoryNoValue, kEnergyHistoryNoValue};
+                    (void)energy_history_get_sample(st->tier, st->next_row, &s);
+                    const int16_t home = (s.solar_dw == kEnergyHistoryNoValue || s.grid_dw == kEnergyHistoryNoValue)
+                        ? kEnergyHistoryNoValue
+                        : (int16_t)constrain((int)s.solar_dw + (int)s.grid_dw, -32767, 32767);
+
+                    char* p = st->pending;
+                    const size_t cap = sizeof(st->pending);
+                    size_t len = 0;
+                    len += (size_t)snprintf(p + len, cap - len, "%s[", st->next_row ? "," : "");
+                    len += energy_history_format_kw(p + len, cap - len, s.solar_dw);
+                    len += (size_t)snprintf(p + len, cap - len, ",");
+                    len += energy_history_format_kw(p + len, cap - len, s.grid_dw);
+                    len += (size_t)snprintf(p + len, cap - len, ",");
+                    len += energy_history_format_kw(p + len, cap - len, home);
+                    len += (size_t)snprintf(p + len, cap - len, "]");
+                    st->pending_len = len < cap ? len : cap - 1;
+                    st->next_row++;
+                } else if (!st->footer_done) {
+                    st->pending_len = (size_t)snprintf(st->pending, sizeof(st->pending), "]}");
+                    st->footer_done = true;
+                } else {
+                    break;
+                }
+            }
+            return written;
+        }
+    );
     response->addHeader("Cache-Control", "no-store");
+    request->send(response);
+}
 
-    response->print("{\"available\":true");
-    response->print(",\"period_ms\":");
-    response->print((unsigned long)params.period_ms);
-    response->print(",\"seconds\":");
-    response->print((unsigned long)params.seconds);
-    response->print(",\"samples\":");
-    response->print((unsigned long)params.samples);
-    response->print(",\"count\":");
-    response->print((unsigned long)count);
-    response->print(",\"capacity\":");
-    response->print((unsigned long)capacity);
-
-    // Helper macro to print a uint32 array field with minimal overhead.
-#define PRINT_U32_ARRAY_FIELD(field_name, expr_u32) \
-    do { \
-        response->print(",\""); \
-        response->print(field_name); \
-        response->print("\":["); \
-        for (size_t i = 0; i < count; i++) { \
-            if (i > 0) response->print(","); \
-            HealthHistorySample s = {}; \
-            if (health_history_get_sample(i, &s)) { \
-                response->print((unsigned long)(expr_u32)); \
-            } else { \
-                response->print("0"); \
-            } \
-        } \
-        response->print("]"); \
-    } while (0)
-
-    // cpu_usage is int16 and may be -1 (unknown).
-    response->print(",\"cpu_usage\":[");
-    for (size_t i = 0; i < count; i++) {
-        if (i > 0) response->print(",");
-        HealthHistorySample s = {};
-        if (health_history_get_sample(i, &s)) {
-            if (s.cpu_usage < 0) {
-                response->print("null");
+// GET /api/energy/state - Latest value of every energy channel
+void handleGetEnergyState(AsyncWebServerRequest *request) {
+    const EnergyMonitorState st = energy_monitor_get_state();
+    const DeviceConfig *config = web_portal_get_current_config();
+    const uint32_t now = millis();
+
+    std::shared_ptr<PooledJsonDocument> doc = make_pooled_json_doc(1024);
+    if (doc && doc->capacity() > 0) {
+        (*doc)["now_ms"] = now;
+        JsonArray channels = (*doc)["channels"].to<JsonArray>();
+        for (uint8_t i = 0; i < kEnergyChannelCount; i++) {
+            char name_buf[CONFIG_ENERGY_CHANNEL_NAME_MAX_LEN];
+            char name[CONFIG_ENERGY_CHANNEL_NAME_MAX_LEN];
+            strlcpy(name, energy_monitor_channel_name(config, i, name_buf, sizeof(name_buf)), sizeof(name));
+            JsonObject ch = channels.add<JsonObject>();
+            ch["id"] = i;
+            ch["name"] = name;
+            if (isnan(st.value[i])) {
+                ch["kw"] = nullptr;
             } else {
-                response->print((int)s.cpu_usage);
+                ch["kw"] = st.value[i];
+            }
+            if (st.update_ms[i] == 0) {
+                ch["age_ms"] = nullptr;
+            } else {
+                ch["age_ms"] = (uint32_t)(now - st.update_ms[i]);
+            }
+            if (st.restored_mask & (1u << i)) {
+                ch["restored"] = true;
             }
-        } else {
-            response->print("null");
         }
     }
-    response->print("]");
-
-    PRINT_U32_ARRAY_FIELD("uptime_ms", s.uptime_ms);
 
-    PRINT_U32_ARRAY_FIELD("heap_internal_free", s.heap_internal_free);
-    PRINT_U32_ARRAY_FIELD("heap_internal_free_min_window", s.heap_internal_free_min_window);
-    PRINT_U32_ARRAY_FIELD("heap_internal_free_max_window", s.heap_internal_free_max_window);
-
-    PRINT_U32_ARRAY_FIELD("psram_free", s.psram_free);
-    PRINT_U32_ARRAY_FIELD("psram_free_min_window", s.psram_free_min_window);
-    PRINT_U32_ARRAY_FIELD("psram_free_max_window", s.psram_free_max_window);
+    web_portal_send_json_chunked(request, doc);
+}
 
-    PRINT_U32_ARRAY_FIELD("heap_internal_largest", s.heap_internal_largest);
-    PRINT_U32_ARRAY_FIELD("heap_internal_largest_min_window", s.heap_internal_largest_min_window);
-    PRINT_U32_ARRAY_FIELD("heap_internal_largest_max_window", s.heap_internal_largest_max_window);
+static void energy_totals_print_set(AsyncResponseStream *response, const char *name, const EnergyTotalsKwh &k) {
+    response->printf(
+        ",\"%s\":{\"import_kwh\":%.3f,\"export_kwh\":%.3f,\"production_kwh\":%.3f,\"self_consumption_kwh\":%.3f}",
+        name, k.import_kwh, k.export_kwh, k.production_kwh, k.self_consumption_kwh
+    );
+}
 
-#undef PRINT_U32_ARRAY_FIELD
+// GET /api/energy/totals - On-device kWh counters (lifetime + resettable period)
+void handleGetEnergyTotals(AsyncWebServerRequest *request) {
+    const EnergyTotalsSnapshot t = energy_totals_get();
 
+    AsyncResponseStream *response = request->beginResponseStream("application/json");
+    response->addHeader("Cache-Control", "no-store");
+    response->print("{\"available\":true");
+    energy_totals_print_set(response, "lifetime", t.lifetime);
+    energy_totals_print_set(response, "period", t.period);
+    response->printf(",\"period_age_s\":%lu", (unsigned long)t.period_age_s);
+    if (t.last_persist_age_s == UINT32_MAX) {
+        response->print(",\"last_persist_age_s\":null");
+    } else {
+        response->printf(",\"last_persist_age_s\":%lu", (unsigned long)t.last_persist_age_s);
+    }
     response->print("}");
     request->send(response);
 }
 
+// POST /api/energy/totals/reset - Reset the period counters (lifetime is kept)
+void handlePostEnergyTotalsReset(AsyncWebServerRequest *request) {
+    if (!portal_auth_gate(request)) return;
+
+    energy_totals_reset_period();
+    LOGI("API", "POST /api/energy/totals/reset");
+    request->send(200, "application/json", "{\"success\":true}");
+}
+
 // POST /api/reboot - Reboot device without saving
 void handleReboot(AsyncWebServerRequest *request) {
     if (!portal_auth_gate(request)) return;
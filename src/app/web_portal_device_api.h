@@ -3,10 +3,17 @@
 
 #include <ESPAsyncWebServer.h>
 
+// The GET handlers up to handleGetEnergyTotals are registered through ADMIT()
+// (web_portal_routes.cpp), which runs the auth gate before them.
 void handleGetMode(AsyncWebServerRequest *request);
 void handleGetVersion(AsyncWebServerRequest *request);
 void handleGetHealth(AsyncWebServerRequest *request);
 void handleGetHealthHistory(AsyncWebServerRequest *request);
+void handleGetHealthTasks(AsyncWebServerRequest *request);
+void handleGetEnergyHistory(AsyncWebServerRequest *request);
+void handleGetEnergyState(AsyncWebServerRequest *request);
+void handleGetEnergyTotals(AsyncWebServerRequest *request);
+void handlePostEnergyTotalsReset(AsyncWebServerRequest *request);
 void handleReboot(AsyncWebServerRequest *request);
 
 #endif // WEB_PORTAL_DEVICE_API_H
@@ -7,12 +7,42 @@
 
 #include "log_manager.h"
 #include "board_config.h"
+#include "config_manager.h"
 
 #include "display_manager.h"
 #include "screen_saver_manager.h"
+#include "ambient_light.h"
+#include "image_api.h"
+#include "web_portal_json.h"
 
 #include <ArduinoJson.h>
 
+static void apply_brightness(int brightness, bool persist) {
+    // Update the in-RAM target brightness.
+    // This keeps the screen saver target consistent with what the user sees.
+    // With "persist": true it is also saved, coalesced with other changes
+    // (a dragged slider ends up as one NVS write).
+    DeviceConfig *config = web_portal_get_current_config();
+    if (config) {
+        ConfigEditLock edit_lock;
+        config->backlight_brightness = brightness;
+        if (persist) {
+            config_manager_save_deferred(config);
+        }
+    }
+
+    // Edge case: if the screen saver is dimming/asleep/fading, directly setting the
+    // backlight would show the UI again without updating the screen saver state.
+    // Easiest fix: when not Awake, route through the screen saver wake path.
+    const ScreenSaverState state = screen_saver_manager_get_status().state;
+    if (state != ScreenSaverState::Awake) {
+        screen_saver_manager_wake();
+    } else {
+        display_manager_set_backlight_brightness(brightness);
+        screen_saver_manager_notify_activity(false);
+    }
+}
+
 void handleSetDisplayBrightness(AsyncWebServerRequest *request, uint8_t *data, size_t len, size_t index, size_t total) {
     if (!portal_auth_gate(request)) return;
 
@@ -29,6 +59,24 @@ void handleSetDisplayBrightness(AsyncWebServerRequest *request, uint8_t *data, s
         return;
     }
 
+    #if AMBIENT_LIGHT_SUPPORTED
+    // Auto-brightness: {"auto": true, "auto_min": 10, "auto_max": 100}. A plain
+    // brightness value is a manual override and switches auto mode off.
+    if (doc.containsKey("auto") || doc.containsKey("brightness")) {
+        const AmbientLightStatus ambient = ambient_light_get_status();
+        const bool want_auto = doc["auto"] | (doc.containsKey("brightness") ? false : ambient.enabled);
+        const int auto_min = doc["auto_min"] | (int)ambient.min_pct;
+        const int auto_max = doc["auto_max"] | (int)ambient.max_pct;
+        if (want_auto != ambient.enabled || auto_min != ambient.min_pct || auto_max != ambient.max_pct) {
+            ambient_light_configure(want_auto, (uint8_t)constrain(auto_min, 0, 100), (uint8_t)constrain(auto_max, 0, 100));
+        }
+        if (want_auto && !doc.containsKey("brightness")) {
+            request->send(200, "application/json", "{\"success\":true,\"auto\":true}");
+            return;
+        }
+    }
+    #endif
+
     if (!doc.containsKey("brightness")) {
         request->send(400, "application/json", "{\"success\":false,\"message\":\"Missing brightness\"}");
         return;
@@ -41,26 +89,12 @@ void handleSetDisplayBrightness(AsyncWebServerRequest *request, uint8_t *data, s
 
     LOGI("API", "PUT /api/display/brightness: %d%%", brightness);
 
-    // Update the in-RAM target brightness (does not persist to NVS).
-    // This keeps the screen saver target consistent with what the user sees.
-    DeviceConfig *config = web_portal_get_current_config();
-    if (config) {
-        config->backlight_brightness = brightness;
-    }
+    const bool persist = doc["persist"] | false;
+    apply_brightness(brightness, persist);
 
-    // Edge case: if the screen saver is dimming/asleep/fading, directly setting the
-    // backlight would show the UI again without updating the screen saver state.
-    // Easiest fix: when not Awake, route through the screen saver wake path.
-    const ScreenSaverState state = screen_saver_manager_get_status().state;
-    if (state != ScreenSaverState::Awake) {
-        screen_saver_manager_wake();
-    } else {
-        display_manager_set_backlight_brightness(brightness);
-        screen_saver_manager_notify_activity(false);
-    }
-
-    char response[64];
-    snprintf(response, sizeof(response), "{\"success\":true,\"brightness\":%d}", brightness);
+    char response[80];
+    snprintf(response, sizeof(response), "{\"success\":true,\"brightness\":%d%s}", brightness,
+             persist ? ",\"persist_pending\":true" : "");
     request->send(200, "application/json", response);
 }
 
@@ -69,12 +103,24 @@ void handleGetDisplaySleep(AsyncWebServerRequest *request) {
 
     ScreenSaverStatus status = screen_saver_manager_get_status();
 
-    StaticJsonDocument<256> doc;
+    StaticJsonDocument<384> doc;
     doc["enabled"] = status.enabled;
     doc["state"] = (uint8_t)status.state;
     doc["current_brightness"] = status.current_brightness;
     doc["target_brightness"] = status.target_brightness;
     doc["seconds_until_sleep"] = status.seconds_until_sleep;
+    doc["render_suspended"] = status.render_suspended;
+    #if AMBIENT_LIGHT_SUPPORTED
+    const AmbientLightStatus ambient = ambient_light_get_status();
+    JsonObject auto_obj = doc.createNestedObject("auto_brightness");
+    auto_obj["enabled"] = ambient.enabled;
+    auto_obj["min"] = ambient.min_pct;
+    auto_obj["max"] = ambient.max_pct;
+    auto_obj["level"] = ambient.level_pct;
+    auto_obj["target"] = ambient.target_pct;
+    auto_obj["raw"] = ambient.raw;
+    auto_obj["changes"] = ambient.changes;
+    #endif
 
     AsyncResponseStream *response = request->beginResponseStream("application/json");
     serializeJson(doc, *response);
@@ -156,4 +202,188 @@ void handleSetDisplayScreen(AsyncWebServerRequest *request, uint8_t *data, size_
     }
 }
 
+// One operation of a /api/display/batch body, validated before anything is applied.
+struct DisplayBatchOp {
+    enum Kind : uint8_t { Brightness, Screen, Activity, Wake, Sleep, ImageUrl } kind;
+    int brightness;
+    bool flag;              // brightness: persist, activity: wake, image_url: cache
+    long timeout_s;         // image_url (-1 = default)
+    const char *text;       // screen id / image url (points into the document)
+};
+
+static bool screen_registered(const char *screen_id) {
+    size_t count = 0;
+    const ScreenInfo *screens = display_manager_get_available_screens(&count);
+    for (size_t i = 0; screens && i < count; i++) {
+        if (strcmp(screens[i].id, screen_id) == 0) return true;
+    }
+    return false;
+}
+
+static bool parse_batch_op(JsonObjectConst o, DisplayBatchOp *out, const char **error) {
+    const char *op = o["op"] | "";
+    *out = DisplayBatchOp{};
+    out->timeout_s = -1;
+
+    if (strcmp(op, "brightness") == 0) {
+        if (!o.containsKey("value")) { *error = "Missing brightness value"; return false; }
+        out->kind = DisplayBatchOp::Brightness;
+        out->brightness = constrain((int)(o["value"] | 0), 0, 100);
+        out->flag = o["persist"] | false;
+        return true;
+    }
+    if (strcmp(op, "screen") == 0) {
+        const char *id = o["id"] | "";
+        if (!id[0] || !screen_registered(id)) { *error = "Screen not found"; return false; }
+        out->kind = DisplayBatchOp::Screen;
+        out->text = id;
+        return true;
+    }
+    if (strcmp(op, "activity") == 0) {
+        out->kind = DisplayBatchOp::Activity;
+        out->flag = o["wake"] | false;
+        return true;
+    }
+    if (strcmp(op, "wake") == 0) {
+        out->kind = DisplayBatchOp::Wake;
+        return true;
+    }
+    if (strcmp(op, "sleep") == 0) {
+        out->kind = DisplayBatchOp::Sleep;
+        return true;
+    }
+    #if HAS_IMAGE_API
+    if (strcmp(op, "image_url") == 0) {
+        const char *url = o["url"] | "";
+        if (!url[0]) { *error = "Missing url"; return false; }
+        out->kind = DisplayBatchOp::ImageUrl;
+        out->text = url;
+        out->flag = o["cache"] | true;
+        out->timeout_s = o["timeout"] | -1L;
+        return true;
+    }
+    #endif
+    *error = "Unknown op";
+    return false;
+}
+
+// POST /api/display/batch - Ordered display operations applied together
+// Body: {"ops":[{"op":"brightness","value":60},{"op":"screen","id":"info"},{"op":"activity","wake":true}]}
+void handlePostDisplayBatch(AsyncWebServerRequest *request, uint8_t *data, size_t len, size_t index, size_t total) {
+    if (!portal_auth_gate(request)) return;
+
+    // Only handle the complete request (index == 0 && index + len == total)
+    if (index != 0 || index + len != total) {
+        if (index == 0) {
+            request->send(413, "application/json", "{\"success\":false,\"message\":\"Body too large\"}");
+        }
+        return;
+    }
+
+    PooledJsonDocument doc(WEB_PORTAL_DISPLAY_BATCH_DOC_BYTES);
+    const DeserializationError error = deserializeJson(doc, data, len);
+    if (error) {
+        request->send(400, "application/json", "{\"success\":false,\"message\":\"Invalid JSON\"}");
+        return;
+    }
+
+    JsonArrayConst list = doc["ops"];
+    if (list.isNull() || list.size() == 0) {
+        request->send(400, "application/json", "{\"success\":false,\"message\":\"Missing ops\"}");
+        return;
+    }
+    if (list.size() > WEB_PORTAL_DISPLAY_BATCH_MAX_OPS) {
+        request->send(400, "application/json", "{\"success\":false,\"message\":\"Too many ops\"}");
+        return;
+    }
+
+    // Validate everything first: a bad op rejects the whole batch, nothing half-applied.
+    DisplayBatchOp ops[WEB_PORTAL_DISPLAY_BATCH_MAX_OPS];
+    size_t count = 0;
+    const char *screen_id = nullptr;
+    bool has_image_url = false;
+    for (JsonObjectConst o : list) {
+        const char *reason = "Invalid op";
+        if (!parse_batch_op(o, &ops[count], &reason)) {
+            char response[128];
+            snprintf(response, sizeof(response), "{\"success\":false,\"message\":\"%s\",\"index\":%u}", reason, (unsigned)count);
+            request->send(400, "application/json", response);
+            return;
+        }
+        if (ops[count].kind == DisplayBatchOp::Screen) screen_id = ops[count].text;
+        if (ops[count].kind == DisplayBatchOp::ImageUrl) {
+            if (has_image_url) {
+                request->send(400, "application/json", "{\"success\":false,\"message\":\"Only one image_url per batch\"}");
+                return;
+            }
+            has_image_url = true;
+        }
+        count++;
+    }
+
+    #if HAS_IMAGE_API
+    // The only op that can still fail: queue it before touching anything else.
+    for (size_t i = 0; i < count; i++) {
+        if (ops[i].kind != DisplayBatchOp::ImageUrl) continue;
+        if (!image_api_queue_url(ops[i].text, ops[i].timeout_s, ops[i].flag)) {
+            request->send(409, "application/json", "{\"success\":false,\"message\":\"Image busy\"}");
+            return;
+        }
+    }
+    #endif
+
+    // Nothing here waits on rendering: a screen switch is one command on the
+    // display queue, applied by the render task at its next frame start together
+    // with anything else queued by then (one switch, one redraw). Only the last
+    // screen op counts, and posting it can fail, so it goes before the rest.
+    if (screen_id) {
+        bool queued = false;
+        display_manager_show_screen(screen_id, &queued);
+        if (!queued) {
+            request->send(503, "application/json", "{\"success\":false,\"message\":\"Display command queue full\"}");
+            return;
+        }
+    }
+
+    for (size_t i = 0; i < count; i++) {
+        const DisplayBatchOp &op = ops[i];
+        switch (op.kind) {
+            case DisplayBatchOp::Brightness:
+                #if AMBIENT_LIGHT_SUPPORTED
+                {
+                    // Manual value: same override as PUT /api/display/brightness.
+                    const AmbientLightStatus ambient = ambient_light_get_status();
+                    if (ambient.enabled) ambient_light_configure(false, ambient.min_pct, ambient.max_pct);
+                }
+                #endif
+                apply_brightness(op.brightness, op.flag);
+                break;
+            case DisplayBatchOp::Screen:
+                screen_saver_manager_notify_activity(true);  // switch queued above
+                break;
+            case DisplayBatchOp::Activity:
+                screen_saver_manager_notify_activity(op.flag);
+                break;
+            case DisplayBatchOp::Wake:
+                screen_saver_manager_wake();
+                break;
+            case DisplayBatchOp::Sleep:
+                screen_saver_manager_sleep_now();
+                break;
+            case DisplayBatchOp::ImageUrl:
+                break;  // queued above
+        }
+    }
+
+    LOGI("API", "POST /api/display/batch: %u ops", (unsigned)count);
+
+    char response[128];
+    if (screen_id) {
+        snprintf(response, sizeof(response), "{\"success\":true,\"applied\":%u,\"screen\":\"%s\"}", (unsigned)count, screen_id);
+    } else {
+        snprintf(response, sizeof(response), "{\"success\":true,\"applied\":%u}", (unsigned)count);
+    }
+    request->send(200, "application/json", response);
+}
+
 #endif // HAS_DISPLAY
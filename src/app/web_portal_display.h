@@ -13,6 +13,7 @@ void handlePostDisplaySleep(AsyncWebServerRequest *request);
 void handlePostDisplayWake(AsyncWebServerRequest *request);
 void handlePostDisplayActivity(AsyncWebServerRequest *request);
 void handleSetDisplayScreen(AsyncWebServerRequest *request, uint8_t *data, size_t len, size_t index, size_t total);
+void handlePostDisplayBatch(AsyncWebServerRequest *request, uint8_t *data, size_t len, size_t index, size_t total);
 
 #endif // HAS_DISPLAY
 
@@ -3,35 +3,43 @@
 #include "web_portal_auth.h"
 #include "web_portal_state.h"
 
+#include "config_manager.h"
 #include "device_telemetry.h"
 #include "log_manager.h"
+#include "ota_stream.h"
 #include "psram_json_allocator.h"
+#include "task_placement.h"
 #include "web_portal_json.h"
 
 #include <ArduinoJson.h>
 #include <HTTPClient.h>
-#include <Update.h>
 #include <WiFi.h>
 #include <WiFiClient.h>
 #include <WiFiClientSecure.h>
 
 #include <esp_heap_caps.h>
+#include <esp_rom_crc.h>
 
 #include <freertos/FreeRTOS.h>
 #include <freertos/task.h>
 
 // ===== GitHub Pages firmware update (app-only) =====
+// Pull-based: the device downloads the image itself and streams it through
+// ota_stream. Interrupted downloads continue with ranged requests.
 static TaskHandle_t firmware_update_task_handle = nullptr;
 static volatile bool firmware_update_in_progress = false;
 static volatile size_t firmware_update_progress = 0;
 static volatile size_t firmware_update_total = 0;
 static volatile uint32_t firmware_update_last_progress_ms = 0;
 
-static char firmware_update_state[16] = "idle"; // idle|downloading|writing|rebooting|error
+static char firmware_update_state[16] = "idle"; // idle|downloading|writing|resuming|rebooting|error
 static char firmware_update_error[192] = "";
 static char firmware_update_target_version[24] = "";
 static char firmware_update_download_url[512] = "";
 static size_t firmware_update_expected_size = 0;
+static char firmware_update_expected_sha256[65] = "";
+static char firmware_update_signature[352] = ""; // base64, see OTA_SIGNING_PUBLIC_KEY_PEM
+static volatile uint16_t firmware_update_resumes = 0;
 
 static portMUX_TYPE g_fw_progress_mux = portMUX_INITIALIZER_UNLOCKED;
 
@@ -61,7 +69,7 @@ static struct {
     uint8_t* buf;
 } g_fw_post = {false, 0, 0, 0, nullptr};
 
-static constexpr size_t WEB_PORTAL_FIRMWARE_MAX_JSON_BYTES = 1024;
+static constexpr size_t WEB_PORTAL_FIRMWARE_MAX_JSON_BYTES = 1536;
 static constexpr uint32_t WEB_PORTAL_FIRMWARE_BODY_TIMEOUT_MS = 8000;
 
 static void firmware_post_reset() {
@@ -86,156 +94,284 @@ static bool starts_with(const char* s, const char* prefix) {
 }
 
 
+// Resume checkpoint (device_cfg NVS): bytes of `url` already in the OTA partition.
+// Lets a re-issued update for the same URL continue after a reboot / power loss.
+struct FirmwareResumeCheckpoint {
+    uint32_t magic;
+    uint32_t url_crc;
+    uint32_t total;
+    uint32_t offset; // sector-aligned, already written to flash
+    char etag[48];   // validator sent as If-Range
+};
+
+static constexpr uint32_t FIRMWARE_RESUME_MAGIC = 0x46575253; // "FWRS"
+static const char* FIRMWARE_RESUME_KEY = "fw_resume";
+
+static void firmware_resume_clear() {
+    FirmwareResumeCheckpoint cp = {};
+    config_manager_put_blob(FIRMWARE_RESUME_KEY, &cp, sizeof(cp));
+}
+
+static inline void firmware_update_fail(const char* error) {
+    strlcpy(firmware_update_state, "error", sizeof(firmware_update_state));
+    if (error != firmware_update_error) {
+        strlcpy(firmware_update_error, error, sizeof(firmware_update_error));
+    }
+    LOGE("OTA", "Update failed: %s", firmware_update_error);
+}
+
+// Parses "bytes START-END/TOTAL"; false when START differs from `offset`.
+static bool parse_content_range(const String& header, size_t offset, size_t* total) {
+    unsigned long start = 0, end = 0, full = 0;
+    if (sscanf(header.c_str(), "bytes %lu-%lu/%lu", &start, &end, &full) != 3) return false;
+    if (start != offset) return false;
+    *total = (size_t)full;
+    return true;
+}
+
 static void firmware_update_task(void *pv) {
     (void)pv;
 
     firmware_update_set_progress(0, firmware_update_total);
     strlcpy(firmware_update_state, "downloading", sizeof(firmware_update_state));
     firmware_update_error[0] = '\0';
+    firmware_update_resumes = 0;
 
     const char *url = firmware_update_download_url;
+    const uint32_t url_crc = esp_rom_crc32_le(0, (const uint8_t*)url, strlen(url));
 
     web_portal_set_ota_in_progress(true);
 
     const bool is_https = starts_with(url, "https://");
 
-    HTTPClient http;
-    http.setTimeout(30000);
+    // Bytes of the image received so far; the next request asks for the rest.
+    size_t offset = 0;
+    size_t total = firmware_update_expected_size;
+    char etag[48] = "";
+
+    FirmwareResumeCheckpoint cp = {};
+    if (config_manager_get_blob(FIRMWARE_RESUME_KEY, &cp, sizeof(cp)) && cp.magic == FIRMWARE_RESUME_MAGIC &&
+        cp.url_crc == url_crc && cp.offset > 0 && (total == 0 || cp.total == total)) {
+        offset = cp.offset;
+        total = cp.total;
+        strlcpy(etag, cp.etag, sizeof(etag));
+        LOGI("OTA", "Resuming interrupted download at %u/%u", (unsigned)offset, (unsigned)total);
+    }
+    size_t last_checkpoint = offset;
 
-    WiFiClientSecure tls_client;
-    WiFiClient plain_client;
+    bool stream_open = false;
+    bool done = false;
+    const char* fatal = nullptr;
+    uint8_t failures = 0; // consecutive attempts that made no progress
 
-    if (is_https) {
-        tls_client.setInsecure();
-        tls_client.setTimeout(30000);
-    } else {
-        plain_client.setTimeout(30000);
-    }
+    while (!done && !fatal) {
+        if (failures > FIRMWARE_PULL_MAX_RETRIES) {
+            fatal = "Download interrupted";
+            break;
+        }
+        if (failures > 0) {
+            const uint32_t backoff_ms = (failures * 1000UL < FIRMWARE_PULL_MAX_BACKOFF_MS) ? failures * 1000UL : FIRMWARE_PULL_MAX_BACKOFF_MS;
+            delay(backoff_ms);
+        }
 
-    int http_code = 0;
-    constexpr int kMaxAttempts = 3;
-    for (int attempt = 1; attempt <= kMaxAttempts; ++attempt) {
-        http.end();
+        // A WiFi drop is the common case: wait for the station to rejoin rather than burn retries.
+        if (WiFi.status() != WL_CONNECTED) {
+            strlcpy(firmware_update_state, "resuming", sizeof(firmware_update_state));
+            const uint32_t wait_start = millis();
+            while (WiFi.status() != WL_CONNECTED && millis() - wait_start < FIRMWARE_PULL_WIFI_WAIT_MS) {
+                delay(250);
+            }
+            if (WiFi.status() != WL_CONNECTED) {
+                failures++;
+                continue;
+            }
+        }
+
+        HTTPClient http;
+        http.setTimeout(30000);
         http.setReuse(false);
         http.setFollowRedirects(HTTPC_STRICT_FOLLOW_REDIRECTS);
+        static const char* kCollect[] = {"Content-Range", "ETag"};
+        http.collectHeaders(kCollect, 2);
+
+        WiFiClientSecure tls_client;
+        WiFiClient plain_client;
+        if (is_https) {
+            tls_client.setInsecure();
+            tls_client.setTimeout(30000);
+        } else {
+            plain_client.setTimeout(30000);
+        }
 
         const bool began = is_https ? http.begin(tls_client, url) : http.begin(plain_client, url);
         if (!began) {
-            LOGE("OTA", "Download start failed attempt %d/%d", attempt, kMaxAttempts);
-            LOGE("OTA", "WiFi status=%d RSSI=%d", (int)WiFi.status(), (int)WiFi.RSSI());
-            if (attempt < kMaxAttempts) {
-                delay(250 * attempt);
-            }
+            LOGE("OTA", "Download start failed (WiFi status=%d RSSI=%d)", (int)WiFi.status(), (int)WiFi.RSSI());
+            failures++;
             continue;
         }
-
-        http_code = http.GET();
-        if (http_code == 200) {
-            break;
+        if (offset > 0) {
+            char range[32];
+            snprintf(range, sizeof(range), "bytes=%u-", (unsigned)offset);
+            http.addHeader("Range", range);
+            if (etag[0]) http.addHeader("If-Range", etag);
         }
 
-        const String error_str = http.errorToString(http_code);
-        LOGE("OTA", "Download HTTP %d (%s) attempt %d/%d", http_code, error_str.c_str(), attempt, kMaxAttempts);
-        LOGE("OTA", "WiFi status=%d RSSI=%d", (int)WiFi.status(), (int)WiFi.RSSI());
-
-        if (attempt < kMaxAttempts) {
-            delay(250 * attempt);
+        const int http_code = http.GET();
+        int http_len = http.getSize();
+        if (http_code == 206 && offset > 0) {
+            size_t range_total = 0;
+            if (!parse_content_range(http.header("Content-Range"), offset, &range_total)) {
+                LOGW("OTA", "Unexpected Content-Range '%s'", http.header("Content-Range").c_str());
+                http.end();
+                failures++;
+                continue;
+            }
+            total = range_total;
+            firmware_update_resumes++;
+            LOGI("OTA", "Resumed at %u/%u", (unsigned)offset, (unsigned)total);
+        } else if (http_code == 200) {
+            if (offset > 0) {
+                // Range ignored or the file changed (If-Range mismatch): start over.
+                LOGW("OTA", "Server sent the full image; restarting from 0");
+                if (stream_open) ota_stream_abort();
+                stream_open = false;
+                offset = 0;
+                last_checkpoint = 0;
+            }
+            if (http_len > 0) total = (size_t)http_len;
+        } else if (http_code == 416) {
+            // Checkpoint points past the end (file shrank): start over.
+            LOGW("OTA", "Range not satisfiable; restarting from 0");
+            http.end();
+            if (stream_open) ota_stream_abort();
+            stream_open = false;
+            offset = 0;
+            last_checkpoint = 0;
+            etag[0] = '\0';
+            firmware_resume_clear();
+            failures++;
+            continue;
+        } else {
+            const String error_str = http.errorToString(http_code);
+            LOGE("OTA", "Download HTTP %d (%s) attempt %u", http_code, error_str.c_str(), (unsigned)(failures + 1));
+            http.end();
+            if (http_code >= 400 && http_code < 500 && http_code != 408 && http_code != 429) {
+                snprintf(firmware_update_error, sizeof(firmware_update_error), "Download HTTP %d", http_code);
+                fatal = firmware_update_error;
+                break;
+            }
+            failures++;
+            continue;
+        }
+        strlcpy(etag, http.header("ETag").c_str(), sizeof(etag));
+        firmware_update_set_progress(offset, total);
+
+        if (!stream_open) {
+            const size_t freeSpace = device_telemetry_free_sketch_space();
+            if (total > 0 && total > freeSpace) {
+                LOGE("OTA", "Firmware too large total=%u free=%u", (unsigned)total, (unsigned)freeSpace);
+                snprintf(firmware_update_error, sizeof(firmware_update_error), "Firmware too large (%u > %u)", (unsigned)total, (unsigned)freeSpace);
+                fatal = firmware_update_error;
+                http.end();
+                break;
+            }
+            if (!ota_stream_begin(total, offset)) {
+                // A stale checkpoint (e.g. partition since reused) must not wedge later attempts.
+                if (offset > 0) {
+                    firmware_resume_clear();
+                    offset = 0;
+                    last_checkpoint = 0;
+                    etag[0] = '\0';
+                    http.end();
+                    failures++;
+                    continue;
+                }
+                fatal = ota_stream_last_error();
+                http.end();
+                break;
+            }
+            stream_open = true;
+            LOGI("OTA", "Download started total=%u", (unsigned)total);
         }
-    }
-
-    if (http_code != 200) {
-        strlcpy(firmware_update_state, "error", sizeof(firmware_update_state));
-        snprintf(firmware_update_error, sizeof(firmware_update_error), "Download HTTP %d", http_code);
-        http.end();
-        firmware_update_in_progress = false;
-        web_portal_set_ota_in_progress(false);
-        vTaskDelete(nullptr);
-        return;
-    }
-
-    int http_len = http.getSize();
-    size_t total = firmware_update_expected_size;
-    if (total == 0 && http_len > 0) {
-        total = (size_t)http_len;
-    }
-    if (http_len <= 0 && total > 0) {
-        http_len = (int)total;
-    }
-    firmware_update_total = total;
-    firmware_update_set_progress(firmware_update_progress, firmware_update_total);
 
-    LOGI("OTA", "Download started total=%u", (unsigned)total);
+        strlcpy(firmware_update_state, "writing", sizeof(firmware_update_state));
 
-    const size_t freeSpace = device_telemetry_free_sketch_space();
-    if (total > 0 && total > freeSpace) {
-        strlcpy(firmware_update_state, "error", sizeof(firmware_update_state));
-        snprintf(firmware_update_error, sizeof(firmware_update_error), "Firmware too large (%u > %u)", (unsigned)total, (unsigned)freeSpace);
-        LOGE("OTA", "Firmware too large total=%u free=%u", (unsigned)total, (unsigned)freeSpace);
-        http.end();
-        firmware_update_in_progress = false;
-        web_portal_set_ota_in_progress(false);
-        vTaskDelete(nullptr);
-        return;
-    }
+        WiFiClient *stream = http.getStreamPtr();
+        uint8_t buf[2048];
+        size_t remaining = (total > 0) ? total - offset : 0;
+        bool progressed = false;
+        uint32_t last_data_ms = millis();
 
-    if (!Update.begin((total > 0) ? total : UPDATE_SIZE_UNKNOWN, U_FLASH)) {
-        strlcpy(firmware_update_state, "error", sizeof(firmware_update_state));
-        strlcpy(firmware_update_error, "OTA begin failed", sizeof(firmware_update_error));
-        LOGE("OTA", "OTA begin failed");
-        http.end();
-        firmware_update_in_progress = false;
-        web_portal_set_ota_in_progress(false);
-        vTaskDelete(nullptr);
-        return;
-    }
+        while (total == 0 || remaining > 0) {
+            const size_t available = stream->available();
+            if (!available) {
+                if (!http.connected() || millis() - last_data_ms > FIRMWARE_PULL_IDLE_TIMEOUT_MS) break;
+                delay(1);
+                continue;
+            }
 
-    strlcpy(firmware_update_state, "writing", sizeof(firmware_update_state));
+            size_t to_read = (available > sizeof(buf)) ? sizeof(buf) : available;
+            if (total > 0 && to_read > remaining) to_read = remaining;
+            const int read_bytes = stream->readBytes(buf, to_read);
+            if (read_bytes <= 0) {
+                break;
+            }
 
-    WiFiClient *stream = http.getStreamPtr();
-    uint8_t buf[2048];
+            if (!ota_stream_write(buf, (size_t)read_bytes)) {
+                fatal = ota_stream_last_error();
+                break;
+            }
+            offset += (size_t)read_bytes;
+            if (total > 0) remaining -= (size_t)read_bytes;
+            last_data_ms = millis();
+            progressed = true;
+            firmware_update_set_progress(offset, total);
+
+            // Checkpoint what is durably in flash, on a sector boundary.
+            const size_t committed = ota_stream_committed_bytes() & ~(size_t)0xFFF;
+            if (total > 0 && committed >= last_checkpoint + FIRMWARE_PULL_CHECKPOINT_BYTES) {
+                FirmwareResumeCheckpoint next = {FIRMWARE_RESUME_MAGIC, url_crc, (uint32_t)total, (uint32_t)committed, {}};
+                strlcpy(next.etag, etag, sizeof(next.etag));
+                config_manager_put_blob(FIRMWARE_RESUME_KEY, &next, sizeof(next));
+                last_checkpoint = committed;
+            }
 
-    while (http.connected() && (http_len > 0 || http_len == -1)) {
-        const size_t available = stream->available();
-        if (!available) {
+            // Yield to keep the AsyncTCP task responsive for status polling.
             delay(1);
-            continue;
-        }
-
-        const size_t to_read = (available > sizeof(buf)) ? sizeof(buf) : available;
-        const int read_bytes = stream->readBytes(buf, to_read);
-        if (read_bytes <= 0) {
-            break;
         }
 
-        const size_t written = Update.write(buf, (size_t)read_bytes);
-        if (written != (size_t)read_bytes) {
-            strlcpy(firmware_update_state, "error", sizeof(firmware_update_state));
-            strlcpy(firmware_update_error, "Flash write failed", sizeof(firmware_update_error));
-            LOGE("OTA", "Flash write failed");
-            Update.abort();
-            http.end();
-            firmware_update_in_progress = false;
-            web_portal_set_ota_in_progress(false);
-            vTaskDelete(nullptr);
-            return;
-        }
+        const bool server_closed = !http.connected();
+        http.end();
+        if (fatal) break;
 
-        const size_t new_progress = firmware_update_progress + written;
-        firmware_update_set_progress(new_progress, firmware_update_total);
-        if (http_len > 0) {
-            http_len -= (int)read_bytes;
+        // Unknown length: a clean close is the end (the image check in finish catches truncation).
+        if ((total > 0 && offset >= total) || (total == 0 && server_closed && progressed)) {
+            done = true;
+            break;
         }
 
-        // Yield to keep the AsyncTCP task responsive for status polling.
-        delay(1);
+        LOGW("OTA", "Download interrupted at %u/%u; resuming", (unsigned)offset, (unsigned)total);
+        strlcpy(firmware_update_state, "resuming", sizeof(firmware_update_state));
+        failures = progressed ? 1 : (uint8_t)(failures + 1);
     }
 
-    http.end();
+    if (!done) {
+        if (stream_open) ota_stream_abort();
+        // Network errors keep the checkpoint so re-issuing the update continues from it.
+        if (fatal && strcmp(fatal, "Download interrupted") != 0) firmware_resume_clear();
+        firmware_update_fail(fatal ? fatal : "Download failed");
+        firmware_update_in_progress = false;
+        web_portal_set_ota_in_progress(false);
+        vTaskDelete(nullptr);
+        return;
+    }
 
-    if (!Update.end(true)) {
-        strlcpy(firmware_update_state, "error", sizeof(firmware_update_state));
-        strlcpy(firmware_update_error, "OTA finalize failed", sizeof(firmware_update_error));
-        LOGE("OTA", "OTA finalize failed");
+    OtaStreamResult result;
+    ota_stream_finish(firmware_update_expected_sha256[0] ? firmware_update_expected_sha256 : nullptr, &result,
+        firmware_update_signature[0] ? firmware_update_signature : nullptr);
+    firmware_resume_clear();
+    if (!result.ok) {
+        firmware_update_fail(result.error ? result.error : "OTA finalize failed");
         firmware_update_in_progress = false;
         web_portal_set_ota_in_progress(false);
         vTaskDelete(nullptr);
@@ -244,7 +380,8 @@ static void firmware_update_task(void *pv) {
 
     strlcpy(firmware_update_state, "rebooting", sizeof(firmware_update_state));
 
-    LOGI("OTA", "Update complete, rebooting");
+    LOGI("OTA", "Update complete (%u bytes, %u resumes, sha256=%s), rebooting",
+        (unsigned)result.bytes, (unsigned)firmware_update_resumes, result.sha256_hex);
 
     // Give the HTTP response/polling a moment to observe completion.
     delay(300);
@@ -343,7 +480,7 @@ void handlePostFirmwareUpdate(AsyncWebServerRequest *request, uint8_t *data, siz
     if (body) body[body_len] = 0;
     portEXIT_CRITICAL(&g_fw_post_mux);
 
-    BasicJsonDocument<PsramJsonAllocator> doc(768);
+    PooledJsonDocument doc(1280);
     DeserializationError error = deserializeJson(doc, body, body_len);
 
     if (error) {
@@ -358,6 +495,8 @@ void handlePostFirmwareUpdate(AsyncWebServerRequest *request, uint8_t *data, siz
     const char *url = doc["url"] | "";
     const char *version = doc["version"] | "";
     const size_t size = (size_t)(doc["size"] | 0);
+    const char *sha256 = doc["sha256"] | "";
+    const char *signature = doc["signature"] | "";
 
     if (!url || strlen(url) == 0) {
         request->send(400, "application/json", "{\"success\":false,\"message\":\"Missing firmware URL\"}");
@@ -375,6 +514,14 @@ void handlePostFirmwareUpdate(AsyncWebServerRequest *request, uint8_t *data, siz
         return;
     }
 
+    if ((*sha256 && strlen(sha256) != 64) || strlen(signature) >= sizeof(firmware_update_signature)) {
+        request->send(400, "application/json", "{\"success\":false,\"message\":\"Invalid sha256 or signature\"}");
+        portENTER_CRITICAL(&g_fw_post_mux);
+        firmware_post_reset();
+        portEXIT_CRITICAL(&g_fw_post_mux);
+        return;
+    }
+
     if (web_portal_ota_in_progress() || firmware_update_in_progress) {
         request->send(409, "application/json", "{\"success\":false,\"message\":\"Update already in progress\"}");
         portENTER_CRITICAL(&g_fw_post_mux);
@@ -400,22 +547,24 @@ void handlePostFirmwareUpdate(AsyncWebServerRequest *request, uint8_t *data, siz
     firmware_update_expected_size = size;
     strlcpy(firmware_update_target_version, version, sizeof(firmware_update_target_version));
     strlcpy(firmware_update_download_url, url, sizeof(firmware_update_download_url));
+    strlcpy(firmware_update_expected_sha256, sha256, sizeof(firmware_update_expected_sha256));
+    strlcpy(firmware_update_signature, signature, sizeof(firmware_update_signature));
     firmware_update_error[0] = '\0';
     strlcpy(firmware_update_state, "downloading", sizeof(firmware_update_state));
 
     LOGI("OTA", "Update requested url=%s size=%u", url, (unsigned)size);
 
     // Spawn background task to avoid blocking AsyncTCP.
-    const BaseType_t task_ok = xTaskCreate(
+    // Internal-RAM stack (writes flash), pinned to the network core.
+    const bool task_ok = task_placement_create(
+        AppTask::FirmwareUpdate,
         firmware_update_task,
-        "fw_update",
-        12288,
         nullptr,
-        1,
-        &firmware_update_task_handle
+        &firmware_update_task_handle,
+        nullptr
     );
 
-    if (task_ok != pdPASS) {
+    if (!task_ok) {
         firmware_update_in_progress = false;
         strlcpy(firmware_update_state, "error", sizeof(firmware_update_state));
         strlcpy(firmware_update_error, "Failed to start update task", sizeof(firmware_update_error));
@@ -427,7 +576,7 @@ void handlePostFirmwareUpdate(AsyncWebServerRequest *request, uint8_t *data, siz
         return;
     }
 
-    std::shared_ptr<BasicJsonDocument<PsramJsonAllocator>> resp = make_psram_json_doc(384);
+    std::shared_ptr<PooledJsonDocument> resp = make_pooled_json_doc(384);
     if (resp && resp->capacity() > 0) {
         (*resp)["success"] = true;
         (*resp)["update_started"] = true;
@@ -445,7 +594,7 @@ void handlePostFirmwareUpdate(AsyncWebServerRequest *request, uint8_t *data, siz
 void handleGetFirmwareUpdateStatus(AsyncWebServerRequest *request) {
     if (!portal_auth_gate(request)) return;
 
-    std::shared_ptr<BasicJsonDocument<PsramJsonAllocator>> doc = make_psram_json_doc(640);
+    std::shared_ptr<PooledJsonDocument> doc = make_pooled_json_doc(640);
     if (doc && doc->capacity() > 0) {
         size_t progress = 0;
         size_t total = 0;
@@ -458,6 +607,7 @@ void handleGetFirmwareUpdateStatus(AsyncWebServerRequest *request) {
         (*doc)["version"] = firmware_update_target_version;
         (*doc)["error"] = firmware_update_error;
         (*doc)["last_progress_ms"] = last_ms;
+        (*doc)["resumes"] = firmware_update_resumes;
     }
 
     web_portal_send_json_chunked(request, doc);
@@ -1,5 +1,6 @@
 #pragma once
 
+#include "json_arena.h"
 #include "psram_json_allocator.h"
 
 #include <ArduinoJson.h>
@@ -24,6 +25,15 @@ static inline std::shared_ptr<BasicJsonDocument<PsramJsonAllocator>> make_psram_
     return std::make_shared<BasicJsonDocument<PsramJsonAllocator>>(capacity);
 }
 
+// Request-scoped documents for the API handlers: the pool comes from a reusable
+// arena slot (json_arena.h) and goes back when the last reference is dropped,
+// i.e. after the chunked response has been sent.
+using PooledJsonDocument = BasicJsonDocument<JsonArenaAllocator>;
+
+static inline std::shared_ptr<PooledJsonDocument> make_pooled_json_doc(size_t capacity) {
+    return std::make_shared<PooledJsonDocument>(capacity);
+}
+
 template <typename TDoc>
 static inline void web_portal_send_json_chunked(
     AsyncWebServerRequest *request,
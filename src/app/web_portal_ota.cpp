@@ -7,7 +7,7 @@
 #include "device_telemetry.h"
 #include "log_manager.h"
 
-#include <Update.h>
+#include "ota_stream.h"
 
 #include <freertos/FreeRTOS.h>
 #include <freertos/portmacro.h>
@@ -18,6 +18,14 @@ static uint8_t g_ota_last_percent = 0;
 
 static size_t ota_progress = 0;
 static size_t ota_total = 0;
+// Upload that owns the OTA stream; chunks of rejected or failed uploads are ignored.
+static AsyncWebServerRequest *g_ota_request = nullptr;
+
+static void send_ota_error(AsyncWebServerRequest *request, int code, const char *message) {
+    char body[128];
+    snprintf(body, sizeof(body), "{\"success\":false,\"message\":\"%s\"}", message ? message : "Update failed");
+    request->send(code, "application/json", body);
+}
 
 // POST /api/update - Handle OTA firmware upload
 void handleOTAUpload(AsyncWebServerRequest *request, String filename, size_t index, uint8_t *data, size_t len, bool final) {
@@ -73,25 +81,39 @@ void handleOTAUpload(AsyncWebServerRequest *request, String filename, size_t ind
             return;
         }
 
-        // Begin OTA update
-        if (!Update.begin(updateSize, U_FLASH)) {
+        // Begin OTA stream (hashing + sector-sized writes on the ota_writer task)
+        if (!ota_stream_begin(ota_total)) {
                 LOGE("OTA", "Begin failed");
-            Update.printError(Serial);
             request->send(500, "application/json", "{\"success\":false,\"message\":\"OTA begin failed\"}");
             portENTER_CRITICAL(&g_ota_upload_mux);
             web_portal_set_ota_in_progress(false);
             portEXIT_CRITICAL(&g_ota_upload_mux);
             return;
         }
+        g_ota_request = request;
+
+        // Client went away mid-upload: free the buffers/writer and allow a new upload.
+        request->onDisconnect([request]() {
+            if (g_ota_request != request) return;
+            LOGW("OTA", "Upload aborted (client disconnected)");
+            ota_stream_abort();
+            g_ota_request = nullptr;
+            portENTER_CRITICAL(&g_ota_upload_mux);
+            web_portal_set_ota_in_progress(false);
+            portEXIT_CRITICAL(&g_ota_upload_mux);
+        });
     }
 
-    // Write chunk to flash
+    // Remaining chunks of an upload that was rejected or already failed.
+    if (request != g_ota_request) return;
+
+    // Queue chunk for flash (copied + hashed here; written by the writer task)
     if (len) {
-        if (Update.write(data, len) != len) {
+        if (!ota_stream_write(data, len)) {
                 LOGE("OTA", "Write failed");
-            Update.printError(Serial);
-            Update.abort();
-            request->send(500, "application/json", "{\"success\":false,\"message\":\"Write failed\"}");
+            ota_stream_abort();
+            g_ota_request = nullptr;
+            send_ota_error(request, 500, ota_stream_last_error());
             portENTER_CRITICAL(&g_ota_upload_mux);
             web_portal_set_ota_in_progress(false);
             portEXIT_CRITICAL(&g_ota_upload_mux);
@@ -112,18 +134,37 @@ void handleOTAUpload(AsyncWebServerRequest *request, String filename, size_t ind
 
     // Final chunk - complete OTA
     if (final) {
-        if (Update.end(true)) {
+        // Optional end-to-end check: X-Firmware-SHA256 header or ?sha256= (hex).
+        String expected;
+        if (request->hasHeader("X-Firmware-SHA256")) {
+            expected = request->header("X-Firmware-SHA256");
+        } else if (request->hasParam("sha256")) {
+            expected = request->getParam("sha256")->value();
+        }
+        expected.trim();
+        // Required by builds with OTA_SIGNING_PUBLIC_KEY_PEM (base64 signature of the digest).
+        const String signature = request->hasHeader("X-Firmware-Signature") ? request->header("X-Firmware-Signature") : String();
+
+        OtaStreamResult result;
+        ota_stream_finish(expected.c_str(), &result, signature.c_str());
+        g_ota_request = nullptr;
+
+        if (result.ok) {
                 LOGI("OTA", "Written: %d bytes", ota_progress);
                 LOGI("OTA", "Success - rebooting");
 
-            request->send(200, "application/json", "{\"success\":true,\"message\":\"Update successful! Rebooting...\"}");
+            char body[192];
+            snprintf(body, sizeof(body),
+                "{\"success\":true,\"message\":\"Update successful! Rebooting...\",\"sha256\":\"%s\",\"elapsed_ms\":%lu}",
+                result.sha256_hex, (unsigned long)result.elapsed_ms);
+            request->send(200, "application/json", body);
 
             delay(500);
             ESP.restart();
         } else {
                 LOGE("OTA", "Update failed");
-            Update.printError(Serial);
-            request->send(500, "application/json", "{\"success\":false,\"message\":\"Update failed\"}");
+            send_ota_error(request, result.error && strcmp(result.error, "SHA-256 mismatch") == 0 ? 400 : 500,
+                result.error ? result.error : "Update failed");
         }
 
         portENTER_CRITICAL(&g_ota_upload_mux);
@@ -5,13 +5,57 @@
 
 #include "web_assets.h"
 
+// True when If-None-Match lists `etag` (or "*"). Weak validators match too:
+// the gzipped body is the only representation we serve.
+static bool if_none_match_hit(AsyncWebServerRequest *request, const char *etag) {
+    const AsyncWebHeader *h = request->getHeader("If-None-Match");
+    if (!h) return false;
+    const char *v = h->value().c_str();
+    const size_t etag_len = strlen(etag);
+
+    while (*v) {
+        while (*v == ' ' || *v == ',') v++;
+        if (*v == '*') return true;
+        if (v[0] == 'W' && v[1] == '/') v += 2;
+        const char *end = v;
+        while (*end && *end != ',') end++;
+        size_t len = (size_t)(end - v);
+        while (len > 0 && v[len - 1] == ' ') len--;
+        if (len == etag_len && memcmp(v, etag, len) == 0) return true;
+        v = end;
+    }
+    return false;
+}
+
+// Only for responses that passed portal_auth_gate(): hand the browser its session
+// cookie so the API calls that follow skip Basic Auth parsing. Never on the
+// ungated static assets, or any client could fetch a session from them.
+static void add_session_cookie(AsyncWebServerRequest *request, AsyncWebServerResponse *response) {
+    const char *cookie = portal_auth_session_cookie(request);
+    if (cookie) response->addHeader("Set-Cookie", cookie);
+}
+
 static AsyncWebServerResponse *begin_gzipped_asset_response(
     AsyncWebServerRequest *request,
     const char *content_type,
     const uint8_t *content_gz,
     size_t content_gz_len,
-    const char *cache_control
+    const char *etag,
+    const char *cache_control,
+    bool authenticated
 ) {
+    if (if_none_match_hit(request, etag)) {
+        // Cached copy is current: headers only, no flash read or body send.
+        AsyncWebServerResponse *response = request->beginResponse(304);
+        if (authenticated) add_session_cookie(request, response);
+        response->addHeader("ETag", etag);
+        response->addHeader("Vary", "Accept-Encoding");
+        if (cache_control && strlen(cache_control) > 0) {
+            response->addHeader("Cache-Control", cache_control);
+        }
+        return response;
+    }
+
     // Prefer the PROGMEM-aware response helper to avoid accidental heap copies.
     // All generated assets live in flash as `const uint8_t[] PROGMEM`.
     AsyncWebServerResponse *response = request->beginResponse_P(
@@ -21,7 +65,9 @@ static AsyncWebServerResponse *begin_gzipped_asset_response(
         content_gz_len
     );
 
+    if (authenticated) add_session_cookie(request, response);
     response->addHeader("Content-Encoding", "gzip");
+    response->addHeader("ETag", etag);
     response->addHeader("Vary", "Accept-Encoding");
     if (cache_control && strlen(cache_control) > 0) {
         response->addHeader("Cache-Control", cache_control);
@@ -44,7 +90,9 @@ void handleRoot(AsyncWebServerRequest *request) {
         "text/html",
         home_html_gz,
         home_html_gz_len,
-        "no-store"
+        home_html_gz_etag,
+        "no-cache",
+        true
     );
     request->send(response);
 }
@@ -63,7 +111,9 @@ void handleHome(AsyncWebServerRequest *request) {
         "text/html",
         home_html_gz,
         home_html_gz_len,
-        "no-store"
+        home_html_gz_etag,
+        "no-cache",
+        true
     );
     request->send(response);
 }
@@ -76,7 +126,9 @@ void handleNetwork(AsyncWebServerRequest *request) {
         "text/html",
         network_html_gz,
         network_html_gz_len,
-        "no-store"
+        network_html_gz_etag,
+        "no-cache",
+        true
     );
     request->send(response);
 }
@@ -95,7 +147,9 @@ void handleFirmware(AsyncWebServerRequest *request) {
         "text/html",
         firmware_html_gz,
         firmware_html_gz_len,
-        "no-store"
+        firmware_html_gz_etag,
+        "no-cache",
+        true
     );
     request->send(response);
 }
@@ -106,7 +160,9 @@ void handleCSS(AsyncWebServerRequest *request) {
         "text/css",
         portal_css_gz,
         portal_css_gz_len,
-        "public, max-age=600"
+        portal_css_gz_etag,
+        "public, max-age=600",
+        false
     );
     request->send(response);
 }
@@ -117,7 +173,9 @@ void handleJS(AsyncWebServerRequest *request) {
         "application/javascript",
         portal_js_gz,
         portal_js_gz_len,
-        "public, max-age=600"
+        portal_js_gz_etag,
+        "public, max-age=600",
+        false
     );
     request->send(response);
 }
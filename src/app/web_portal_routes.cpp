@@ -7,9 +7,35 @@
 #include "web_portal_firmware.h"
 #include "web_portal_ota.h"
 #include "web_portal_pages.h"
+#include "web_portal_admission.h"
+#include "trace_ring.h"
 
 #include "board_config.h"
 
+#if TRACE_RING_SUPPORTED
+// Wrap a plain handler so its run shows up as an http_handler span in /api/trace.
+template <void (*Handler)(AsyncWebServerRequest*)>
+static void traced_handler(AsyncWebServerRequest* request) {
+    TRACE_SCOPE(TraceEvent::HttpHandler);
+    Handler(request);
+}
+#define TRACED(handler) traced_handler<handler>
+#else
+#define TRACED(handler) handler
+#endif
+
+// Auth gate, then the admission gate (see web_portal_admission.h), in front of a
+// plain handler. Auth goes first so unauthenticated requests can neither take an
+// admission slot nor learn from its 503s; the handlers behind ADMIT() leave the
+// auth gate to this wrapper.
+template <PortalRouteClass Cls, void (*Handler)(AsyncWebServerRequest*)>
+static void admitted_handler(AsyncWebServerRequest* request) {
+    if (!portal_auth_gate(request)) return;
+    if (!web_portal_admit(request, Cls)) return;
+    Handler(request);
+}
+#define ADMIT(cls, handler) admitted_handler<PortalRouteClass::cls, handler>
+
 void web_portal_register_routes(AsyncWebServer* server) {
     auto handleCorsPreflight = [](AsyncWebServerRequest *request) {
         web_portal_send_cors_preflight(request);
@@ -33,10 +59,13 @@ void web_portal_register_routes(AsyncWebServer* server) {
     // NOTE: Keep more specific routes registered before more general/prefix routes.
     // Some AsyncWebServer matchers can behave like prefix matches depending on configuration.
     registerOptions("/api/mode");
-    server->on("/api/mode", HTTP_GET, handleGetMode);
+    server->on("/api/mode", HTTP_GET, ADMIT(Status, TRACED(handleGetMode)));
+
+    registerOptions("/api/auth/token");
+    server->on("/api/auth/token", HTTP_GET, TRACED(handleGetAuthToken));
 
     registerOptions("/api/config");
-    server->on("/api/config", HTTP_GET, handleGetConfig);
+    server->on("/api/config", HTTP_GET, ADMIT(Heavy, TRACED(handleGetConfig)));
 
     server->on(
         "/api/config",
@@ -48,18 +77,30 @@ void web_portal_register_routes(AsyncWebServer* server) {
         handlePostConfig
     );
 
-    server->on("/api/config", HTTP_DELETE, handleDeleteConfig);
+    server->on("/api/config", HTTP_DELETE, TRACED(handleDeleteConfig));
 
     registerOptions("/api/info");
-    server->on("/api/info", HTTP_GET, handleGetVersion);
+    server->on("/api/info", HTTP_GET, ADMIT(Status, TRACED(handleGetVersion)));
     #if HEALTH_HISTORY_ENABLED
-    server->on("/api/health/history", HTTP_GET, handleGetHealthHistory);
+    server->on("/api/health/history", HTTP_GET, ADMIT(Heavy, TRACED(handleGetHealthHistory)));
     #endif
     #if HEALTH_HISTORY_ENABLED
     registerOptions("/api/health/history");
     #endif
+    registerOptions("/api/health/tasks");
+    server->on("/api/health/tasks", HTTP_GET, ADMIT(Status, TRACED(handleGetHealthTasks)));
     registerOptions("/api/health");
-    server->on("/api/health", HTTP_GET, handleGetHealth);
+    server->on("/api/health", HTTP_GET, ADMIT(Status, TRACED(handleGetHealth)));
+    registerOptions("/api/energy/state");
+    server->on("/api/energy/state", HTTP_GET, ADMIT(Status, TRACED(handleGetEnergyState)));
+    registerOptions("/api/energy/totals");
+    server->on("/api/energy/totals", HTTP_GET, ADMIT(Status, TRACED(handleGetEnergyTotals)));
+    registerOptions("/api/energy/totals/reset");
+    server->on("/api/energy/totals/reset", HTTP_POST, TRACED(handlePostEnergyTotalsReset));
+    #if ENERGY_HISTORY_ENABLED
+    registerOptions("/api/energy/history");
+    server->on("/api/energy/history", HTTP_GET, ADMIT(Heavy, TRACED(handleGetEnergyHistory)));
+    #endif
 
     registerOptions("/api/reboot");
     server->on("/api/reboot", HTTP_POST, handleReboot);
@@ -113,6 +154,18 @@ void web_portal_register_routes(AsyncWebServer* server) {
         handleSetDisplayScreen
     );
     registerOptions("/api/display/screen");
+
+    // Ordered brightness/screen/activity/image operations in one request
+    server->on(
+        "/api/display/batch",
+        HTTP_POST,
+        [](AsyncWebServerRequest *request) {
+            if (!portal_auth_gate(request)) return;
+        },
+        NULL,
+        handlePostDisplayBatch
+    );
+    registerOptions("/api/display/batch");
 #endif
 
     // OTA upload endpoint
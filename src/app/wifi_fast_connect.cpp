@@ -0,0 +1,111 @@
+#include "wifi_fast_connect.h"
+
+#include "config_manager.h"
+#include "log_manager.h"
+
+#include <esp_attr.h>
+#include <esp_rom_crc.h>
+#include <freertos/FreeRTOS.h>
+#include <string.h>
+
+namespace {
+
+static portMUX_TYPE g_stats_mux = portMUX_INITIALIZER_UNLOCKED;
+static WifiFastConnectStats g_stats = {};
+
+#if WIFI_FAST_CONNECT_ENABLED
+
+static const char* kCacheKey = "wifi_fc";
+static const uint32_t kCacheMagic = 0x57464331; // "WFC1"
+
+struct CacheRecord {
+    uint32_t magic;
+    uint32_t ssid_crc;
+    WifiFastConnectEntry entry;
+    uint32_t crc;  // over everything above
+};
+
+// Survives esp_restart() and watchdog resets (not power loss; NVS covers that).
+RTC_NOINIT_ATTR static CacheRecord s_rtc_record;
+
+static uint32_t ssid_crc(const char* ssid) {
+    return esp_rom_crc32_le(0, (const uint8_t*)ssid, strlen(ssid));
+}
+
+static uint32_t record_crc(const CacheRecord& r) {
+    return esp_rom_crc32_le(0, (const uint8_t*)&r, offsetof(CacheRecord, crc));
+}
+
+static bool record_valid(const CacheRecord& r, uint32_t want_ssid_crc) {
+    return r.magic == kCacheMagic && r.ssid_crc == want_ssid_crc && r.crc == record_crc(r) &&
+           r.entry.channel > 0;
+}
+
+#endif
+
+} // namespace
+
+#if WIFI_FAST_CONNECT_ENABLED
+
+bool wifi_fast_connect_load(const char* ssid, WifiFastConnectEntry* out) {
+    if (!ssid || !*ssid || !out) return false;
+    const uint32_t want = ssid_crc(ssid);
+
+    if (record_valid(s_rtc_record, want)) {
+        *out = s_rtc_record.entry;
+        return true;
+    }
+
+    CacheRecord rec;
+    if (config_manager_get_blob(kCacheKey, &rec, sizeof(rec)) && record_valid(rec, want)) {
+        s_rtc_record = rec;
+        *out = rec.entry;
+        return true;
+    }
+    return false;
+}
+
+void wifi_fast_connect_store(const char* ssid, const WifiFastConnectEntry& entry) {
+    if (!ssid || !*ssid || entry.channel == 0) return;
+
+    CacheRecord rec = {};
+    rec.magic = kCacheMagic;
+    rec.ssid_crc = ssid_crc(ssid);
+    rec.entry = entry;
+    rec.crc = record_crc(rec);
+
+    // Same AP + lease as last time (the common reconnect): no flash write.
+    // The RTC copy only ever holds what was loaded from or written to NVS.
+    if (memcmp(&rec, &s_rtc_record, sizeof(rec)) == 0) return;
+    s_rtc_record = rec;
+    if (!config_manager_put_blob(kCacheKey, &rec, sizeof(rec))) {
+        LOGW("WiFi", "Fast-connect cache write failed");
+    }
+}
+
+void wifi_fast_connect_invalidate() {
+    s_rtc_record.magic = 0;
+    CacheRecord rec = {};
+    config_manager_put_blob(kCacheKey, &rec, sizeof(rec));
+}
+
+#endif
+
+void wifi_fast_connect_record(const WifiConnectTiming& timing) {
+    portENTER_CRITICAL(&g_stats_mux);
+    g_stats.last = timing;
+    if (timing.fast) {
+        g_stats.fast_ok++;
+    } else {
+        if (timing.fast_tried) g_stats.fast_failed++;
+        if (timing.ok) g_stats.scan_connects++;
+    }
+    portEXIT_CRITICAL(&g_stats_mux);
+}
+
+void wifi_fast_connect_get_stats(WifiFastConnectStats* out) {
+    if (!out) return;
+    portENTER_CRITICAL(&g_stats_mux);
+    *out = g_stats;
+    portEXIT_CRITICAL(&g_stats_mux);
+}
@@ -0,0 +1,61 @@
+/*
+ * WiFi Fast Connect
+ *
+ * Remembers the last good AP (BSSID + channel) and DHCP lease, in RTC memory
+ * (survives soft resets) and NVS (survives power cuts). connect_wifi() tries a
+ * direct association with them first and only falls back to the scan for the
+ * strongest AP when that fails. The cache is keyed on the SSID, so changing the
+ * network config invalidates it.
+ *
+ * Also keeps per-phase timings of the last connect (/api/health "wifi_connect_*").
+ */
+
+#pragma once
+
+#include "board_config.h"
+
+#include <stdint.h>
+
+struct WifiFastConnectEntry {
+    uint8_t bssid[6];
+    uint8_t channel;
+    // Last DHCP lease (network byte order, as IPAddress stores it); 0 = none.
+    uint32_t ip;
+    uint32_t gateway;
+    uint32_t subnet;
+    uint32_t dns1;
+    uint32_t dns2;
+};
+
+struct WifiConnectTiming {
+    uint32_t total_ms;   // connect_wifi() start to got-IP (or failure)
+    uint32_t reset_ms;   // radio reset + hostname/IP config
+    uint32_t scan_ms;    // strongest-AP scan (0 on the fast path)
+    uint32_t assoc_ms;   // WiFi.begin() to got-IP (association + DHCP)
+    bool fast_tried;     // a cached entry was tried first
+    bool fast;           // connected via the cached BSSID/channel
+    bool ok;
+};
+
+struct WifiFastConnectStats {
+    WifiConnectTiming last;
+    uint32_t fast_ok;
+    uint32_t fast_failed;
+    uint32_t scan_connects;
+};
+
+#if WIFI_FAST_CONNECT_ENABLED
+
+// RTC copy first, then NVS. False when nothing valid is cached for `ssid`.
+bool wifi_fast_connect_load(const char* ssid, WifiFastConnectEntry* out);
+
+// Called after a successful connect; NVS is only written when the entry changed.
+void wifi_fast_connect_store(const char* ssid, const WifiFastConnectEntry& entry);
+
+// Drop the cache after a failed direct connect (the AP moved or went away).
+void wifi_fast_connect_invalidate();
+
+#endif
+
+void wifi_fast_connect_record(const WifiConnectTiming& timing);
+void wifi_fast_connect_get_stats(WifiFastConnectStats* out);
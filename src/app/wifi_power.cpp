@@ -0,0 +1,144 @@
+#include "wifi_power.h"
+
+#include "log_manager.h"
+
+#if HAS_DISPLAY
+#include "screen_saver_manager.h"
+#endif
+
+#include <Arduino.h>
+#include <WiFi.h>
+#include <esp_wifi.h>
+
+static_assert(WIFI_POWER_AWAKE_PROFILE >= 0 && WIFI_POWER_AWAKE_PROFILE < (int)WifiPowerProfile::Count, "WIFI_POWER_AWAKE_PROFILE must be 0..2");
+static_assert(WIFI_POWER_ASLEEP_PROFILE >= 0 && WIFI_POWER_ASLEEP_PROFILE < (int)WifiPowerProfile::Count, "WIFI_POWER_ASLEEP_PROFILE must be 0..2");
+
+static constexpr uint32_t kRssiSampleMs = 10000;
+
+static portMUX_TYPE s_mux = portMUX_INITIALIZER_UNLOCKED;
+static WifiPowerProfile s_current = (WifiPowerProfile)WIFI_POWER_AWAKE_PROFILE;
+static WifiPowerProfileStats s_stats[(size_t)WifiPowerProfile::Count] = {};
+static int64_t s_rssi_sum[(size_t)WifiPowerProfile::Count] = {};
+static uint64_t s_rtt_sum[(size_t)WifiPowerProfile::Count] = {};
+static uint32_t s_since_ms = 0;        // start of the current active_ms slice
+static uint32_t s_last_rssi_ms = 0;
+static bool s_begun = false;
+
+const char* wifi_power_profile_name(WifiPowerProfile profile) {
+    switch (profile) {
+        case WifiPowerProfile::Performance: return "performance";
+        case WifiPowerProfile::Balanced: return "balanced";
+        case WifiPowerProfile::LowPower: return "low_power";
+        default: return "unknown";
+    }
+}
+
+static wifi_ps_type_t ps_type(WifiPowerProfile profile) {
+    switch (profile) {
+        case WifiPowerProfile::Balanced: return WIFI_PS_MIN_MODEM;
+        case WifiPowerProfile::LowPower: return WIFI_PS_MAX_MODEM;
+        default: return WIFI_PS_NONE;
+    }
+}
+
+static void apply(WifiPowerProfile profile) {
+    if (profile == WifiPowerProfile::LowPower) {
+        // MAX_MODEM wakes every listen_interval beacons; the AP buffers frames for
+        // that long, so the value is announced at (re)association.
+        wifi_config_t cfg;
+        if (esp_wifi_get_config(WIFI_IF_STA, &cfg) == ESP_OK && cfg.sta.listen_interval != WIFI_POWER_LISTEN_INTERVAL) {
+            cfg.sta.listen_interval = WIFI_POWER_LISTEN_INTERVAL;
+            esp_wifi_set_config(WIFI_IF_STA, &cfg);
+        }
+    }
+    const esp_err_t err = esp_wifi_set_ps(ps_type(profile));
+    if (err != ESP_OK) {
+        LOGW("WiFi", "Power save %s failed (%d)", wifi_power_profile_name(profile), (int)err);
+    }
+}
+
+// Close the active_ms slice of the current profile (s_mux held).
+static void account_time_locked(uint32_t now_ms) {
+    s_stats[(size_t)s_current].active_ms += (uint32_t)(now_ms - s_since_ms);
+    s_since_ms = now_ms;
+}
+
+void wifi_power_begin() {
+    // Re-applied on every connect_wifi(): WiFi.mode() resets the policy.
+    if (!s_begun) {
+        s_begun = true;
+        s_since_ms = millis();
+    }
+    apply(s_current);
+    LOGI("WiFi", "Power save: %s", wifi_power_profile_name(s_current));
+}
+
+static WifiPowerProfile wanted_profile() {
+    #if HAS_DISPLAY
+    const ScreenSaverStatus ss = screen_saver_manager_get_status();
+    if (ss.enabled && ss.state == ScreenSaverState::Asleep) {
+        return (WifiPowerProfile)WIFI_POWER_ASLEEP_PROFILE;
+    }
+    #endif
+    return (WifiPowerProfile)WIFI_POWER_AWAKE_PROFILE;
+}
+
+void wifi_power_loop() {
+    if (!s_begun) return;
+    const uint32_t now = millis();
+
+    const WifiPowerProfile want = wanted_profile();
+    if (want != s_current) {
+        portENTER_CRITICAL(&s_mux);
+        account_time_locked(now);
+        s_current = want;
+        portEXIT_CRITICAL(&s_mux);
+        apply(want);
+        LOGI("WiFi", "Power save -> %s", wifi_power_profile_name(want));
+    }
+
+    if ((uint32_t)(now - s_last_rssi_ms) >= kRssiSampleMs) {
+        s_last_rssi_ms = now;
+        if (WiFi.status() == WL_CONNECTED) {
+            const int32_t rssi = WiFi.RSSI();
+            portENTER_CRITICAL(&s_mux);
+            const size_t i = (size_t)s_current;
+            s_rssi_sum[i] += rssi;
+            s_stats[i].rssi_samples++;
+            s_stats[i].rssi_avg_dbm = (int32_t)(s_rssi_sum[i] / (int64_t)s_stats[i].rssi_samples);
+            portEXIT_CRITICAL(&s_mux);
+        }
+    }
+}
+
+void wifi_power_note_disconnect() {
+    portENTER_CRITICAL(&s_mux);
+    s_stats[(size_t)s_current].disconnects++;
+    portEXIT_CRITICAL(&s_mux);
+}
+
+void wifi_power_record_rtt(uint32_t rtt_ms) {
+    portENTER_CRITICAL(&s_mux);
+    WifiPowerProfileStats& st = s_stats[(size_t)s_current];
+    s_rtt_sum[(size_t)s_current] += rtt_ms;
+    st.rtt_samples++;
+    st.rtt_avg_ms = (uint32_t)(s_rtt_sum[(size_t)s_current] / st.rtt_samples);
+    if (rtt_ms > st.rtt_max_ms) st.rtt_max_ms = rtt_ms;
+    portEXIT_CRITICAL(&s_mux);
+}
+
+void wifi_power_record_rtt_lost() {
+    portENTER_CRITICAL(&s_mux);
+    s_stats[(size_t)s_current].rtt_lost++;
+    portEXIT_CRITICAL(&s_mux);
+}
+
+void wifi_power_get_stats(WifiPowerStats* out) {
+    if (!out) return;
+    const uint32_t now = millis();
+    portENTER_CRITICAL(&s_mux);
+    if (s_begun) account_time_locked(now);
+    out->current = s_current;
+    for (size_t i = 0; i < (size_t)WifiPowerProfile::Count; i++) out->profile[i] = s_stats[i];
+    portEXIT_CRITICAL(&s_mux);
+}
@@ -0,0 +1,60 @@
+/*
+ * WiFi Power-Save Profiles
+ *
+ * Selects the modem-sleep policy of the station interface:
+ *   Performance  WIFI_PS_NONE       radio always on, lowest latency
+ *   Balanced     WIFI_PS_MIN_MODEM  sleeps between DTIM beacons
+ *   LowPower     WIFI_PS_MAX_MODEM  sleeps for WIFI_POWER_LISTEN_INTERVAL beacons
+ *
+ * The profile follows the screen saver: WIFI_POWER_AWAKE_PROFILE while the display
+ * is on, WIFI_POWER_ASLEEP_PROFILE while it is asleep. For each profile the module
+ * accumulates time spent, RSSI, WiFi disconnects and the MQTT round-trip time
+ * measured by MqttManager's probe (publish to an own topic, time the echo), so the
+ * latency/power tradeoff can be compared with data from /api/health.
+ */
+
+#pragma once
+
+#include "board_config.h"
+
+#include <stdint.h>
+
+enum class WifiPowerProfile : uint8_t {
+    Performance = 0,
+    Balanced = 1,
+    LowPower = 2,
+    Count
+};
+
+struct WifiPowerProfileStats {
+    uint32_t active_ms;      // time spent in the profile (connected or not)
+    int32_t rssi_avg_dbm;    // mean of 10 s RSSI samples while connected (0 = none)
+    uint32_t rssi_samples;
+    uint32_t disconnects;    // STA disconnect events while the profile was active
+    uint32_t rtt_samples;    // MQTT probes echoed back
+    uint32_t rtt_lost;       // probes that timed out
+    uint32_t rtt_avg_ms;
+    uint32_t rtt_max_ms;
+};
+
+struct WifiPowerStats {
+    WifiPowerProfile current;
+    WifiPowerProfileStats profile[(size_t)WifiPowerProfile::Count];
+};
+
+const char* wifi_power_profile_name(WifiPowerProfile profile);
+
+// Apply the awake profile (call from connect_wifi after WiFi.mode(WIFI_STA)).
+void wifi_power_begin();
+
+// Follow the screen saver and sample RSSI (call from main loop).
+void wifi_power_loop();
+
+// STA disconnect event (WiFi event callback).
+void wifi_power_note_disconnect();
+
+// MQTT probe results (MQTT task).
+void wifi_power_record_rtt(uint32_t rtt_ms);
+void wifi_power_record_rtt_lost();
+
+void wifi_power_get_stats(WifiPowerStats* out);
@@ -18,6 +18,9 @@
 // Enable display support on this board.
 #define HAS_DISPLAY true
 
+// ESP32-2432S028R has no PSRAM: compile the PSRAM allocation paths out.
+#define BOARD_PSRAM 0
+
 // ============================================================================
 // Driver Selection (HAL)
 // ============================================================================
@@ -87,6 +90,11 @@
 // TFT_eSPI: SPI touch frequency (Hz).
 #define SPI_TOUCH_FREQUENCY 2500000
 
+// LVGL double buffering with DMA flush (render next band while SPI transfers the current one).
+#define LVGL_DOUBLE_BUFFER true
+// Grow the DMA draw buffers from spare internal RAM at boot (fewer flushes per frame).
+#define LVGL_BUFFER_ADAPTIVE true
+
 // Color Order
 // Panel uses BGR byte order.
 #define DISPLAY_COLOR_ORDER_BGR true  // BGR color order (not RGB)
@@ -156,9 +164,15 @@
 // #define SD_MOSI 23
 // #define SD_SCLK 18
 
-// Light Sensor
-// #define HAS_LDR true
-// #define LDR_PIN 34
+// Light Sensor (auto-brightness, see ambient_light.h)
+// Enable the LDR light sensor.
+#define HAS_LDR true
+// LDR ADC pin.
+#define LDR_PIN 34
+// Averaged LDR reading when dark (the CYD divider reads low in bright light).
+#define AUTO_BRIGHTNESS_ADC_DARK 1200
+// Averaged LDR reading in bright light.
+#define AUTO_BRIGHTNESS_ADC_BRIGHT 0
 
 // ============================================================================
 // Image API Configuration
@@ -171,4 +185,15 @@
 // Additional RAM required for decoding.
 #define IMAGE_API_DECODE_HEADROOM_BYTES (50 * 1024)  // 50KB headroom for decoding
 
+// ============================================================================
+// Task Placement
+// ============================================================================
+// LVGL renders on core 0; loop() (MQTT, JPEG decode) and AsyncTCP on core 1.
+// LVGL render task core.
+#define TASK_RENDER_CORE 0
+// Network/decode core (matches ARDUINO_RUNNING_CORE).
+#define TASK_NETWORK_CORE 1
+// AsyncTCP task core (exported to the library by build.sh).
+#define CONFIG_ASYNC_TCP_RUNNING_CORE 1
+
 #endif // BOARD_OVERRIDES_CYD2USB_V2_H
@@ -43,6 +43,16 @@
 // This buffer is allocated from PSRAM in DisplayManager.
 // LVGL draw buffer size in pixels.
 #define LVGL_BUFFER_SIZE (DISPLAY_WIDTH * 80)
+// Dedicated LVGL TLSF pool in PSRAM, so screen churn stays off the shared heap.
+#define LVGL_MEM_POOL_BYTES (256 * 1024)
+
+// Full-screen alarm pulses saturate the QSPI bus at 320x480; animate per-category halos instead.
+// Pulse a halo behind the alarming categories.
+#define ENERGY_ALARM_HALO_MODE true
+// Alarm animation step period in ms.
+#define ENERGY_ALARM_STEP_MS 60
+// Sparkline under each energy bar (the tall panel has room, history lives in PSRAM).
+#define ENERGY_SPARKLINE true
 
 // QSPI pins (from sample/esp_bsp.h)
 // QSPI host peripheral.
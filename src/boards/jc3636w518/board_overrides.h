@@ -46,12 +46,20 @@
 #define DISPLAY_HEIGHT 360
 // UI rotation (LVGL).
 #define DISPLAY_ROTATION 0
+// Circular 1.8" panel.
+#define DISPLAY_ROUND true
 
 // Match the sample: prefer PSRAM for LVGL draw buffer (fallback handled in DisplayManager).
 // Prefer internal RAM over PSRAM for LVGL draw buffer allocation.
 #define LVGL_BUFFER_PREFER_INTERNAL false
 // LVGL draw buffer size in pixels.
 #define LVGL_BUFFER_SIZE (DISPLAY_WIDTH * 16)  // 16 rows (matches sample default)
+// Dedicated LVGL TLSF pool in PSRAM, so screen churn stays off the shared heap.
+#define LVGL_MEM_POOL_BYTES (256 * 1024)
+// Render byte-swapped so flushes pass LVGL's buffer straight to the QSPI transfer.
+#define LVGL_COLOR_16_SWAP true
+// Sparkline under each energy bar (history lives in PSRAM).
+#define ENERGY_SPARKLINE true
 
 // ---------------------------------------------------------------------------
 // Backlight (LEDC)
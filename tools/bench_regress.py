@@ -0,0 +1,260 @@
+#!/usr/bin/env python3
+"""Run the on-device benchmark suite and check it against per-board baselines.
+
+Goal: catch performance regressions per commit on real hardware, without serial
+logs or a host toolchain. The device runs the kernels itself (POST /api/bench);
+this script only starts runs, aggregates them and compares the numbers.
+Host-side kernel timings are a separate tool (tools/host_bench, Google Benchmark).
+
+This script is intentionally dependency-free (stdlib only).
+
+Typical usage:
+  # Record the current firmware as the baseline for this board
+  python3 tools/bench_regress.py --host 192.168.1.111 --update-baseline
+
+  # After flashing a new build: compare, append to the history CSV, exit 1 on regression
+  python3 tools/bench_regress.py --host 192.168.1.111 --history bench-history.csv
+
+Notes:
+- Baselines are keyed by the board_name reported by /api/bench, so one file
+  can hold all boards (default: tools/bench_baselines.json).
+- Each metric uses the median of --runs runs to damp WiFi/loop jitter.
+- *_us / *_ns are lower-is-better; *_mb_s / *_kpx_s are higher-is-better.
+  Other fields (json_bytes, display size) are reported but never fail.
+"""
+
+from __future__ import annotations
+
+import argparse
+import csv
+import json
+import os
+import statistics
+import subprocess
+import sys
+import time
+from datetime import datetime, timezone
+from typing import Any, Dict, List, Optional, Tuple
+
+from urllib.error import HTTPError, URLError
+from urllib.request import Request, urlopen
+
+
+DEFAULT_TIMEOUT_S = 5.0
+DEFAULT_RUN_TIMEOUT_S = 60.0
+DEFAULT_TOLERANCE_PCT = 10.0
+
+LOWER_IS_BETTER = ("_us", "_ns")
+HIGHER_IS_BETTER = ("_mb_s", "_kpx_s")
+
+
+def _repo_root() -> str:
+    # tools/bench_regress.py -> repo root
+    return os.path.abspath(os.path.join(os.path.dirname(__file__), ".."))
+
+
+def _now_iso() -> str:
+    return datetime.now(timezone.utc).isoformat(timespec="seconds")
+
+
+def _normalize_base_url(host: str) -> str:
+    host = host.strip()
+    if host.startswith("http://") or host.startswith("https://"):
+        return host.rstrip("/")
+    return f"http://{host.rstrip('/')}"
+
+
+def _git_commit() -> str:
+    try:
+        out = subprocess.run(
+            ["git", "rev-parse", "--short", "HEAD"],
+            cwd=_repo_root(),
+            capture_output=True,
+            text=True,
+            check=True,
+        )
+        return out.stdout.strip()
+    except Exception:
+        return "unknown"
+
+
+def _http(base_url: str, method: str, path: str, timeout_s: float) -> Tuple[int, bytes]:
+    url = f"{base_url}{path}"
+    headers = {"User-Agent": "esp32-template-bench-regress/1.0", "Accept": "application/json"}
+    req = Request(url=url, data=b"" if method == "POST" else None, headers=headers, method=method)
+    try:
+        with urlopen(req, timeout=timeout_s) as resp:
+            return resp.getcode(), resp.read()
+    except HTTPError as e:
+        try:
+            data = e.read()
+        except Exception:
+            data = b""
+        return e.code, data
+    except (URLError, TimeoutError) as e:
+        raise RuntimeError(f"Request failed: {url} ({e})")
+
+
+def _get_bench(base_url: str, timeout_s: float) -> Dict[str, Any]:
+    status, data = _http(base_url, "GET", "/api/bench", timeout_s)
+    if status != 200:
+        raise RuntimeError(f"GET /api/bench failed: HTTP {status} body={data[:200]!r}")
+    return json.loads(data.decode("utf-8", errors="replace"))
+
+
+def run_once(base_url: str, timeout_s: float, run_timeout_s: float) -> Dict[str, Any]:
+    before = _get_bench(base_url, timeout_s).get("runs", 0)
+    status, data = _http(base_url, "POST", "/api/bench", timeout_s)
+    if status not in (200, 202):
+        raise RuntimeError(f"POST /api/bench failed: HTTP {status} body={data[:200]!r}")
+
+    deadline = time.monotonic() + run_timeout_s
+    while time.monotonic() < deadline:
+        time.sleep(0.5)
+        doc = _get_bench(base_url, timeout_s)
+        if doc.get("status") == "done" and doc.get("runs", 0) > before:
+            return doc
+    raise RuntimeError(f"Benchmark did not finish within {run_timeout_s:.0f}s")
+
+
+def _direction(key: str) -> int:
+    """+1 higher is better, -1 lower is better, 0 informational."""
+    if key.endswith(HIGHER_IS_BETTER):
+        return 1
+    if key.endswith(LOWER_IS_BETTER):
+        return -1
+    return 0
+
+
+def aggregate(docs: List[Dict[str, Any]]) -> Dict[str, float]:
+    metrics: Dict[str, float] = {}
+    for key in docs[0].keys():
+        if key in ("duration_ms", "finished_uptime_ms", "runs", "cpu_freq"):
+            continue
+        values = [d.get(key) for d in docs]
+        nums = [v for v in values if isinstance(v, (int, float)) and not isinstance(v, bool)]
+        if len(nums) == len(docs):
+            metrics[key] = float(statistics.median(nums))
+    return metrics
+
+
+def compare(
+    metrics: Dict[str, float], baseline: Dict[str, float], tolerance_pct: float
+) -> List[Tuple[str, float, float, float, bool]]:
+    """Rows of (key, baseline, current, change_pct, regressed)."""
+    rows = []
+    for key in sorted(set(metrics) | set(baseline)):
+        if key not in metrics or key not in baseline or baseline[key] == 0:
+            continue
+        base = baseline[key]
+        cur = metrics[key]
+        change = (cur - base) * 100.0 / base
+        d = _direction(key)
+        regressed = (d > 0 and change < -tolerance_pct) or (d < 0 and change > tolerance_pct)
+        rows.append((key, base, cur, change, regressed))
+    return rows
+
+
+def _load_json(path: str) -> Dict[str, Any]:
+    if not os.path.exists(path):
+        return {}
+    with open(path, "r", encoding="utf-8") as f:
+        return json.load(f)
+
+
+def _append_history(path: str, commit: str, board: str, version: str, metrics: Dict[str, float]) -> None:
+    # One row per run and metric keeps the file stable when metrics are added.
+    new_file = not os.path.exists(path)
+    with open(path, "a", newline="", encoding="utf-8") as f:
+        w = csv.writer(f)
+        if new_file:
+            w.writerow(["time", "commit", "board_name", "version", "metric", "value"])
+        ts = _now_iso()
+        for key in sorted(metrics):
+            w.writerow([ts, commit, board, version, key, metrics[key]])
+
+
+def main(argv: list[str]) -> int:
+    p = argparse.ArgumentParser(description="ESP32 on-device benchmark regression check (/api/bench)")
+    p.add_argument("--host", required=True, help="Device IP address (or full URL). Example: 192.168.1.111")
+    p.add_argument("--runs", type=int, default=3, help="Benchmark runs to take the median of (default: 3)")
+    p.add_argument(
+        "--baseline",
+        default=os.path.join(_repo_root(), "tools", "bench_baselines.json"),
+        help="Baseline JSON (default: tools/bench_baselines.json)",
+    )
+    p.add_argument(
+        "--tolerance",
+        type=float,
+        default=DEFAULT_TOLERANCE_PCT,
+        help="Allowed change in percent before a metric counts as a regression (default: 10)",
+    )
+    p.add_argument("--update-baseline", action="store_true", help="Write the measured medians as this board's baseline")
+    p.add_argument("--history", default=None, help="Optional CSV to append the measured medians to (with git commit)")
+    p.add_argument("--timeout", type=float, default=DEFAULT_TIMEOUT_S, help="HTTP timeout seconds (default: 5)")
+    p.add_argument(
+        "--run-timeout",
+        type=float,
+        default=DEFAULT_RUN_TIMEOUT_S,
+        help="Seconds to wait for one benchmark run (default: 60)",
+    )
+    args = p.parse_args(argv)
+
+    if args.runs < 1:
+        print("ERROR: --runs must be >= 1", file=sys.stderr)
+        return 2
+
+    base_url = _normalize_base_url(args.host)
+    commit = _git_commit()
+
+    try:
+        docs = []
+        for i in range(args.runs):
+            doc = run_once(base_url, args.timeout, args.run_timeout)
+            print(f"Run {i + 1}/{args.runs}: {doc.get('duration_ms')} ms")
+            docs.append(doc)
+    except RuntimeError as e:
+        print(f"ERROR: {e}", file=sys.stderr)
+        return 2
+
+    board = str(docs[-1].get("board_name", "unknown"))
+    version = str(docs[-1].get("version", ""))
+    metrics = aggregate(docs)
+    print(f"Board: {board}  firmware: {version}  commit: {commit}")
+
+    if args.history:
+        _append_history(args.history, commit, board, version, metrics)
+
+    baselines = _load_json(args.baseline)
+    if args.update_baseline:
+        baselines[board] = {"commit": commit, "version": version, "recorded": _now_iso(), "metrics": metrics}
+        with open(args.baseline, "w", encoding="utf-8") as f:
+            json.dump(baselines, f, indent=2, sort_keys=True)
+            f.write("\n")
+        print(f"Baseline for {board} written to {args.baseline}")
+        return 0
+
+    entry: Optional[Dict[str, Any]] = baselines.get(board)
+    if not entry:
+        for key in sorted(metrics):
+            print(f"  {key:32s} {metrics[key]:>12.2f}")
+        print(f"No baseline for {board} in {args.baseline} (run with --update-baseline)")
+        return 0
+
+    rows = compare(metrics, entry.get("metrics", {}), args.tolerance)
+    regressions = 0
+    print(f"Baseline: commit {entry.get('commit')} ({entry.get('version')}), tolerance {args.tolerance:.0f}%")
+    for key, base, cur, change, regressed in rows:
+        mark = "REGRESSION" if regressed else ""
+        print(f"  {key:32s} {base:>12.2f} -> {cur:>12.2f}  {change:+7.1f}%  {mark}")
+        regressions += 1 if regressed else 0
+
+    if regressions:
+        print(f"FAIL: {regressions} metric(s) regressed beyond {args.tolerance:.0f}%")
+        return 1
+    print("OK: no regressions")
+    return 0
+
+
+if __name__ == "__main__":
+    raise SystemExit(main(sys.argv[1:]))
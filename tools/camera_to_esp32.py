@@ -29,6 +29,7 @@ Installation (Home Assistant OS / AppDaemon add-on):
        # default_esp32_ip: "192.168.1.111"
        # jpeg_quality: 80
        # rotate_degrees: null|0|90|180|270
+       # log_timing: false          # log upload + device decode time per snapshot
 
 Usage (automation action):
   - event: camera_to_esp32
@@ -39,6 +40,7 @@ Usage (automation action):
       rotate_degrees: null        # optional: null=auto, 0=no rotate, 90/180/270
       jpeg_quality: 80            # optional
       dismiss: false              # optional: if true, only dismisses current image
+      log_timing: false           # optional: log upload/decode timing (GET /api/display/image/timing)
 
 Requirements:
   - Pillow (add to AppDaemon python_packages)
@@ -48,6 +50,7 @@ from __future__ import annotations
 
 import io
 import os
+import time
 from typing import Any, Dict, Optional, Tuple
 
 import appdaemon.plugins.hass.hassapi as hass
@@ -79,6 +82,10 @@ class CameraToESP32(hass.Hass):
         raw_rotate_degrees = self.args.get("rotate_degrees", None)
         self.default_rotate_degrees: Optional[int] = None if raw_rotate_degrees is None else int(raw_rotate_degrees)
 
+        # Log upload time and the device's receive/decode timing after each upload
+        self.default_log_timing = bool(self.args.get("log_timing", False))
+        self.last_image_seq: Optional[int] = None
+
         # Legacy boolean rotate flag support (kept for compatibility with older configs)
         raw_rotate = self.args.get("rotate", None)
         if raw_rotate is not None and raw_rotate_degrees is None:
@@ -96,6 +103,7 @@ class CameraToESP32(hass.Hass):
         dismiss = bool(data.get("dismiss", False))
         timeout = int(data.get("timeout", 10))
         jpeg_quality = int(data.get("jpeg_quality", self.default_jpeg_quality))
+        log_timing = bool(data.get("log_timing", self.default_log_timing))
 
         rotate_degrees = data.get("rotate_degrees", self.default_rotate_degrees)
         if "rotate_degrees" not in data and "rotate" in data:
@@ -145,6 +153,7 @@ class CameraToESP32(hass.Hass):
             timeout=timeout,
             rotate_degrees=rotate_degrees,
             jpeg_quality=jpeg_quality,
+            log_timing=log_timing,
         )
 
     def process_camera_snapshot(
@@ -154,6 +163,7 @@ class CameraToESP32(hass.Hass):
         timeout: int = 10,
         rotate_degrees: Optional[int] = None,
         jpeg_quality: int = 80,
+        log_timing: bool = False,
     ):
         try:
             self.log(f"Fetching snapshot from {camera_entity}")
@@ -182,9 +192,13 @@ class CameraToESP32(hass.Hass):
             out_jpeg = self.encode_baseline_jpeg(img, quality=jpeg_quality)
             self.log(f"Uploading to {esp32_ip} (timeout={timeout}s, bytes={len(out_jpeg)})")
 
+            upload_start = time.perf_counter()
             ok = self.upload_single(out_jpeg, esp32_ip, timeout)
+            upload_ms = (time.perf_counter() - upload_start) * 1000.0
             if ok:
                 self.log("[OK] Upload successful")
+                if log_timing:
+                    self.log_upload_timing(esp32_ip, upload_start, upload_ms)
             else:
                 self.error("Upload failed")
 
@@ -310,9 +324,10 @@ class CameraToESP32(hass.Hass):
             if response.status_code != 200:
                 return False
 
-            # Firmware responds with JSON {success: true, ...}
+            # Firmware responds with JSON {success: true, image_seq: N, ...}
             try:
                 payload = response.json()
+                self.last_image_seq = payload.get("image_seq")
                 return bool(payload.get("success", False))
             except Exception:
                 # Fallback: accept HTTP 200 if JSON parsing fails
@@ -322,6 +337,32 @@ class CameraToESP32(hass.Hass):
             self.error(f"Upload error: {e}")
             return False
 
+    def log_upload_timing(self, esp32_ip: str, upload_start: float, upload_ms: float) -> None:
+        """Wait for the device to finish decoding the last upload and log its timing."""
+        if self.last_image_seq is None:
+            self.log("Timing: firmware does not report image_seq")
+            return
+        url = f"http://{esp32_ip}/api/display/image/timing"
+        deadline = time.monotonic() + 10.0
+        try:
+            while time.monotonic() < deadline:
+                timing = requests.get(url, timeout=5).json()
+                if timing.get("seq") != self.last_image_seq:
+                    self.log("Timing: superseded by a newer upload")
+                    return
+                if timing.get("complete"):
+                    e2e_ms = (time.perf_counter() - upload_start) * 1000.0
+                    self.log(
+                        f"Timing: upload {upload_ms:.0f} ms, device receive {timing.get('receive_us', 0) / 1000:.0f} ms, "
+                        f"decode {timing.get('decode_us', 0) / 1000:.0f} ms, end-to-end {e2e_ms:.0f} ms "
+                        f"({1000.0 / e2e_ms:.2f} fps){'' if timing.get('ok') else ' [decode failed]'}"
+                    )
+                    return
+                time.sleep(0.02)
+            self.log("Timing: decode did not finish within 10s")
+        except Exception as e:
+            self.log(f"Timing: {e}")
+
     def dismiss_image(self, esp32_ip: str) -> bool:
         """DELETE /api/display/image"""
         try:
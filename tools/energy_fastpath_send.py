@@ -0,0 +1,100 @@
+#!/usr/bin/env python3
+"""
+Send Energy Fast Path Frames (UDP multicast)
+
+Publishes solar/grid values as binary energy frames to the multicast group the
+firmware listens on (ENERGY_FASTPATH_UDP_GROUP / ENERGY_FASTPATH_UDP_PORT), see
+docs/web-portal.md "Energy fast path".
+
+Usage:
+    # One frame: solar 1.25 kW, grid -0.4 kW
+    ./energy_fastpath_send.py --solar 1.25 --grid -0.4
+
+    # Every 500 ms with random values, 60 frames
+    ./energy_fastpath_send.py --random --interval 0.5 --count 60
+
+    # Extra channel 2 (first aux channel) and a custom group
+    ./energy_fastpath_send.py --channel 2=0.8 --group 239.255.42.42 --port 42420
+
+Dependencies:
+    none (standard library only)
+"""
+
+import argparse
+import random
+import socket
+import struct
+import sys
+import time
+
+MAGIC = b"EF"
+VERSION = 1
+MAX_ENTRIES = 8
+
+
+def build_frame(seq: int, entries) -> bytes:
+    """entries: list of (channel, kw) with kw None for unknown."""
+    if not 1 <= len(entries) <= MAX_ENTRIES:
+        raise ValueError(f"1..{MAX_ENTRIES} entries per frame")
+    out = bytearray(MAGIC)
+    out += struct.pack("<BBI", VERSION, len(entries), seq & 0xFFFFFFFF)
+    for channel, kw in entries:
+        mkw = -(2 ** 31) if kw is None else int(round(kw * 1000.0))
+        out += struct.pack("<BBi", channel, 0, mkw)
+    return bytes(out)
+
+
+def parse_channel(spec: str):
+    try:
+        ch, value = spec.split("=", 1)
+        return int(ch), (None if value.lower() in ("nan", "none", "") else float(value))
+    except ValueError:
+        raise argparse.ArgumentTypeError(f"expected <channel>=<kW>, got '{spec}'")
+
+
+def main() -> int:
+    parser = argparse.ArgumentParser(description="Send energy fast path frames over UDP multicast")
+    parser.add_argument("--group", default="239.255.42.42", help="multicast group (default: 239.255.42.42)")
+    parser.add_argument("--port", type=int, default=42420, help="UDP port (default: 42420)")
+    parser.add_argument("--solar", type=float, help="solar kW (channel 0)")
+    parser.add_argument("--grid", type=float, help="grid kW (channel 1)")
+    parser.add_argument("--channel", type=parse_channel, action="append", default=[],
+                        help="extra entry <channel>=<kW> (repeatable; 'nan' = unknown)")
+    parser.add_argument("--random", action="store_true", help="random solar/grid values per frame")
+    parser.add_argument("--count", type=int, default=1, help="frames to send (default: 1)")
+    parser.add_argument("--interval", type=float, default=1.0, help="seconds between frames (default: 1.0)")
+    parser.add_argument("--seq", type=int, default=None, help="first sequence number (default: time-based)")
+    parser.add_argument("--ttl", type=int, default=1, help="multicast TTL (default: 1, local segment)")
+    args = parser.parse_args()
+
+    sock = socket.socket(socket.AF_INET, socket.SOCK_DGRAM, socket.IPPROTO_UDP)
+    sock.setsockopt(socket.IPPROTO_IP, socket.IP_MULTICAST_TTL, args.ttl)
+
+    # Time-based default keeps seq increasing across script runs.
+    seq = args.seq if args.seq is not None else int(time.time() * 10)
+    for i in range(args.count):
+        entries = []
+        if args.random:
+            entries.append((0, round(random.uniform(0.0, 4.0), 3)))
+            entries.append((1, round(random.uniform(-3.0, 3.0), 3)))
+        else:
+            if args.solar is not None:
+                entries.append((0, args.solar))
+            if args.grid is not None:
+                entries.append((1, args.grid))
+        entries.extend(args.channel)
+        if not entries:
+            parser.error("nothing to send (use --solar/--grid/--channel/--random)")
+
+        frame = build_frame(seq, entries)
+        sock.sendto(frame, (args.group, args.port))
+        values = ", ".join(f"{ch}={'nan' if kw is None else kw}" for ch, kw in entries)
+        print(f"seq={seq} {values} ({len(frame)} bytes)")
+        seq += 1
+        if i + 1 < args.count:
+            time.sleep(args.interval)
+    return 0
+
+
+if __name__ == "__main__":
+    sys.exit(main())
@@ -0,0 +1,142 @@
+// Host microbenchmarks for the firmware's I/O-free hot paths (Google Benchmark).
+//
+// These run the same sources as the firmware, built natively, so a change to a
+// kernel can be compared before/after on a workstation in seconds. Absolute
+// numbers are the host CPU's; on-device timings come from /api/bench
+// (tools/bench_regress.py).
+
+#include "config_manager.h"
+#include "device_bench_jpeg.h"
+#include "energy_thresholds.h"
+#include "health_window.h"
+#include "jpeg_preflight.h"
+#include "json_path_extract.h"
+#include "rgb565_convert.h"
+
+#include <benchmark/benchmark.h>
+
+#include <vector>
+
+// Same payload as the device suite's kernels step: the value sits near the end of the path.
+static const char kPayload[] =
+    "{\"device\":\"inverter\",\"ts\":1718000000,\"data\":{\"power\":"
+    "[{\"id\":\"solar\",\"value\":2.345,\"unit\":\"kW\"},{\"id\":\"grid\",\"value\":-0.812,\"unit\":\"kW\"}]}}";
+
+static void BM_JsonPathExtract(benchmark::State& state, const char* path) {
+    double v = 0.0;
+    for (auto _ : state) {
+        const bool ok = json_path_extract_number(kPayload, sizeof(kPayload) - 1, path, &v);
+        benchmark::DoNotOptimize(ok);
+        benchmark::DoNotOptimize(v);
+    }
+    state.SetBytesProcessed((int64_t)state.iterations() * (int64_t)(sizeof(kPayload) - 1));
+}
+BENCHMARK_CAPTURE(BM_JsonPathExtract, nested, "data.power[1].value");
+BENCHMARK_CAPTURE(BM_JsonPathExtract, first_key, "device");
+BENCHMARK_CAPTURE(BM_JsonPathExtract, missing, "data.power[5].value");
+
+static void BM_JpegPreflight(benchmark::State& state) {
+    char err[96];
+    if (!jpeg_preflight_tjpgd_supported(kDeviceBenchJpeg, sizeof(kDeviceBenchJpeg),
+                                        kDeviceBenchJpegWidth, kDeviceBenchJpegHeight, err, sizeof(err))) {
+        state.SkipWithError(err);
+        return;
+    }
+    for (auto _ : state) {
+        const bool ok = jpeg_preflight_tjpgd_supported(kDeviceBenchJpeg, sizeof(kDeviceBenchJpeg),
+                                                       kDeviceBenchJpegWidth, kDeviceBenchJpegHeight,
+                                                       err, sizeof(err));
+        benchmark::DoNotOptimize(ok);
+    }
+}
+BENCHMARK(BM_JpegPreflight);
+
+// One 320x16 MCU band, as in rgb565_convert_benchmark_log().
+static constexpr int kRgb565Pixels = 320 * 16;
+
+// Byte-at-a-time reference (the pre-word-path loop).
+static void rgb565_convert_bytewise(const uint8_t* src, uint16_t* dst, int count) {
+    for (int i = 0; i < count; i++) {
+        dst[i] = rgb565_pack<false, true>(src[0], src[1], src[2]);
+        src += 3;
+    }
+}
+
+static void BM_Rgb565(benchmark::State& state, Rgb565ConvertFn fn, size_t misalign) {
+    // uint32_t storage keeps both buffers 4-byte aligned; misalign forces the byte path.
+    std::vector<uint32_t> src_words((kRgb565Pixels * 3 + 8) / 4);
+    std::vector<uint32_t> dst_words(kRgb565Pixels / 2 + 1);
+    uint8_t* src = (uint8_t*)src_words.data() + misalign;
+    uint16_t* dst = (uint16_t*)dst_words.data();
+    for (int i = 0; i < kRgb565Pixels * 3; i++) src[i] = (uint8_t)(i * 37);
+
+    for (auto _ : state) {
+        fn(src, dst, kRgb565Pixels);
+        benchmark::ClobberMemory();
+    }
+    state.SetItemsProcessed((int64_t)state.iterations() * kRgb565Pixels);
+}
+BENCHMARK_CAPTURE(BM_Rgb565, bytewise, rgb565_convert_bytewise, 0);
+BENCHMARK_CAPTURE(BM_Rgb565, rgb, (rgb565_convert_rgb888<false, false>), 0);
+BENCHMARK_CAPTURE(BM_Rgb565, rgb_wire, (rgb565_convert_rgb888<false, true>), 0);
+BENCHMARK_CAPTURE(BM_Rgb565, bgr, (rgb565_convert_rgb888<true, false>), 0);
+BENCHMARK_CAPTURE(BM_Rgb565, bgr_wire, (rgb565_convert_rgb888<true, true>), 0);
+BENCHMARK_CAPTURE(BM_Rgb565, rgb_wire_unaligned, (rgb565_convert_rgb888<false, true>), 1);
+
+static void compile_test_thresholds() {
+    static DeviceConfig config = {};
+    EnergyCategoryColorConfig* cats[] = {&config.energy_solar_colors, &config.energy_home_colors,
+                                         &config.energy_grid_colors};
+    for (EnergyCategoryColorConfig* c : cats) {
+        c->threshold_mkw[0] = 500;
+        c->threshold_mkw[1] = 1500;
+        c->threshold_mkw[2] = 3000;
+    }
+    config.energy_alarm_clear_hysteresis_mkw = 200;
+    energy_thresholds_compile(&config);
+}
+
+// Sweep -5..+5 kW through every category so all tiers and the hysteresis path run.
+static void BM_ThresholdsClassify(benchmark::State& state) {
+    compile_test_thresholds();
+    const EnergyRuleSet* rules = energy_thresholds_get();
+    bool alarm = false;
+    int r = 0;
+    for (auto _ : state) {
+        const float kw = (float)((r++ % 101) - 50) * 0.1f;
+        for (size_t c = 0; c < (size_t)EnergyCategory::Count; c++) {
+            alarm = energy_thresholds_classify(rules->category[c], kw, alarm).alarm;
+        }
+        benchmark::DoNotOptimize(alarm);
+    }
+    state.SetItemsProcessed((int64_t)state.iterations() * (int64_t)EnergyCategory::Count);
+}
+BENCHMARK(BM_ThresholdsClassify);
+
+// One sampler tick: fold a sample and merge the bands, rolling over every 50 ticks.
+static void BM_HealthWindowSample(benchmark::State& state) {
+    HealthWindowState window = {};
+    health_window_state_reset(&window, 1);
+    uint32_t now_ms = 1;
+    size_t free_bytes = 180000;
+    for (auto _ : state) {
+        now_ms += 100;
+        free_bytes = (free_bytes * 1103515245u + 12345u) % 200000u;
+        const HealthWindowComputed bands = health_window_apply_sample(&window, now_ms, 5000,
+                                                                      free_bytes, free_bytes / 2,
+                                                                      4000000 - free_bytes, 2000000);
+        benchmark::DoNotOptimize(bands);
+    }
+}
+BENCHMARK(BM_HealthWindowSample);
+
+static void BM_HealthFragmentation(benchmark::State& state) {
+    size_t free_bytes = 180000;
+    for (auto _ : state) {
+        free_bytes = (free_bytes * 1103515245u + 12345u) % 200000u;
+        benchmark::DoNotOptimize(health_window_fragmentation_percent(free_bytes, free_bytes / 3));
+    }
+}
+BENCHMARK(BM_HealthFragmentation);
+
+BENCHMARK_MAIN();
@@ -0,0 +1,14 @@
+// Link stubs for the host benchmark: logging is compiled in but never emitted.
+
+#include "log_manager.h"
+
+#include <chrono>
+
+uint8_t g_log_runtime_level = 0;  // below LOG_LEVEL_ERROR: nothing passes
+
+void log_write(LogLevel, const char*, const char*, ...) {}
+
+unsigned long millis() {
+    using namespace std::chrono;
+    return (unsigned long)duration_cast<milliseconds>(steady_clock::now().time_since_epoch()).count();
+}
@@ -0,0 +1,16 @@
+#pragma once
+
+// Host stand-in for the few Arduino core declarations the benchmarked modules
+// pull in through their headers. Nothing here is called on a hot path.
+
+#include <math.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <string.h>
+
+class String {
+public:
+    String(const char* = "") {}
+};
+
+unsigned long millis();
@@ -165,6 +165,7 @@ declare -A JS_GZIP_CONTENTS
 declare -A ORIGINAL_SIZES
 declare -A PROCESSED_SIZES
 declare -A GZIPPED_SIZES
+declare -A ETAGS
 
 # Helper function to gzip content and generate C byte array
 gzip_to_c_array() {
@@ -172,9 +173,9 @@ gzip_to_c_array() {
     local temp_file=$(mktemp)
     local temp_gz=$(mktemp)
     
-    # Write content to temp file and gzip it
+    # Write content to temp file and gzip it (-n: no name/mtime, so output and ETag are reproducible)
     echo -n "$content" > "$temp_file"
-    gzip -9 -c "$temp_file" > "$temp_gz"
+    gzip -9 -n -c "$temp_file" > "$temp_gz"
     
     # Convert to C byte array format
     xxd -i < "$temp_gz" | grep -v "unsigned" | sed 's/^  //'
@@ -183,6 +184,12 @@ gzip_to_c_array() {
     rm -f "$temp_file" "$temp_gz"
 }
 
+# Strong ETag for the served (gzipped) representation: truncated SHA-256 of its bytes
+gzip_etag() {
+    local content="$1"
+    echo -n "$content" | gzip -9 -n -c | sha256sum | cut -c1-16
+}
+
 # Process HTML files (template substitution + minification)
 for html_file in "${HTML_FILES[@]}"; do
     filename=$(basename "$html_file" .html)
@@ -234,6 +241,7 @@ with open('$html_file', 'r') as f:
     ORIGINAL_SIZES["html_$filename"]=$original_size
     PROCESSED_SIZES["html_$filename"]=$minified_size
     GZIPPED_SIZES["html_$filename"]=$gzipped_size
+    ETAGS["html_$filename"]=$(gzip_etag "$minified")
 done
 
 # Process CSS files (minify)
@@ -262,6 +270,7 @@ with open('$css_file', 'r') as f:
     ORIGINAL_SIZES["css_$filename"]=$original_size
     PROCESSED_SIZES["css_$filename"]=$minified_size
     GZIPPED_SIZES["css_$filename"]=$gzipped_size
+    ETAGS["css_$filename"]=$(gzip_etag "$minified")
 done
 
 # Process JS files (minify)
@@ -290,6 +299,7 @@ with open('$js_file', 'r') as f:
     ORIGINAL_SIZES["js_$filename"]=$original_size
     PROCESSED_SIZES["js_$filename"]=$minified_size
     GZIPPED_SIZES["js_$filename"]=$gzipped_size
+    ETAGS["js_$filename"]=$(gzip_etag "$minified")
 done
 
 echo
@@ -449,6 +459,24 @@ for filename in "${!JS_CONTENTS[@]}"; do
     echo "const size_t ${filename}_js_gz_len = sizeof(${filename}_js_gz);" >> "$OUTPUT_FILE"
 done
 
+# Add content-hash ETags (quoted, ready for the ETag header)
+cat >> "$OUTPUT_FILE" << 'ETAG_CONSTANTS'
+
+// Strong ETags (SHA-256 prefix of the gzipped bytes; change whenever the asset does)
+ETAG_CONSTANTS
+
+for filename in "${!HTML_CONTENTS[@]}"; do
+    echo "const char ${filename}_html_gz_etag[] = \"\\\"${ETAGS[html_$filename]}\\\"\";" >> "$OUTPUT_FILE"
+done
+
+for filename in "${!CSS_CONTENTS[@]}"; do
+    echo "const char ${filename}_css_gz_etag[] = \"\\\"${ETAGS[css_$filename]}\\\"\";" >> "$OUTPUT_FILE"
+done
+
+for filename in "${!JS_CONTENTS[@]}"; do
+    echo "const char ${filename}_js_gz_etag[] = \"\\\"${ETAGS[js_$filename]}\\\"\";" >> "$OUTPUT_FILE"
+done
+
 # Close header file
 cat >> "$OUTPUT_FILE" << 'HEADER_END'
 
@@ -14,6 +14,13 @@ Scenarios:
 - portal: fetches HTML/CSS/JS pages in addition to API calls (portal load)
  - https_image: queues an HTTP/HTTPS JPEG download via /api/display/image_url
 
+Load mode (--workers N): N concurrent clients loop over read-only endpoints for
+--duration seconds (several phones on the portal). Reports per-endpoint
+p50/p95/p99 latency, error and 503 rates, and samples /api/health +
+/api/health/tasks once per --sample-interval so latency can be correlated with
+heap, fps and task CPU. --out then writes one CSV row per sample interval:
+  python3 tools/portal_stress_test.py --host 192.168.1.111 --no-reboot --workers 4 --duration 60 --scenario portal --out load.csv
+
 Notes:
 - Requires --no-reboot and always uses ?no_reboot=1 when saving config.
 - Uses /api/health as the single source of metrics.
@@ -27,10 +34,11 @@ import json
 import os
 import subprocess
 import sys
+import threading
 import time
 from dataclasses import dataclass
 from datetime import datetime, timezone
-from typing import Any, Dict, Optional, Tuple
+from typing import Any, Dict, List, Optional, Tuple
 
 from urllib.error import HTTPError, URLError
 from urllib.request import Request, urlopen
@@ -477,6 +485,222 @@ def write_csv(path: str, samples: list[HealthSample]) -> None:
             )
 
 
+# ---------------------------------------------------------------------------
+# Load mode
+# ---------------------------------------------------------------------------
+
+API_LOAD_ENDPOINTS = ("/api/health", "/api/info", "/api/health/tasks", "/api/config")
+PORTAL_LOAD_ENDPOINTS = ("/home.html", "/portal.css", "/portal.js")
+
+# Device-side fields sampled per interval (from /api/health unless noted).
+DEVICE_FIELDS = (
+    "heap_internal_free",
+    "heap_internal_min",
+    "heap_largest",
+    "psram_free",
+    "display_fps",
+    "cpu_usage",
+    "async_tcp_cpu",   # /api/health/tasks
+    "loop_task_cpu",   # /api/health/tasks
+)
+
+
+@dataclass
+class RequestResult:
+    t_s: float          # start, seconds since the load started
+    endpoint: str
+    status: int         # 0 = connection error / timeout
+    latency_ms: float
+
+
+def _timed_get(base_url: str, path: str, timeout_s: float) -> Tuple[int, float]:
+    # No retries: a retry would hide exactly the failures load mode is measuring.
+    req = Request(url=f"{base_url}{path}", headers={"User-Agent": "esp32-template-portal-stress-test/1.0"}, method="GET")
+    t0 = time.perf_counter()
+    try:
+        with urlopen(req, timeout=timeout_s) as resp:
+            resp.read()
+            status = resp.getcode()
+    except HTTPError as e:
+        try:
+            e.read()
+        except Exception:
+            pass
+        status = e.code
+    except (URLError, TimeoutError, ConnectionError, OSError):
+        status = 0
+    return status, (time.perf_counter() - t0) * 1000.0
+
+
+def _percentile(values: List[float], pct: float) -> Optional[float]:
+    # Nearest-rank; matches how the firmware reports its own p95/p99.
+    if not values:
+        return None
+    s = sorted(values)
+    k = max(0, min(len(s) - 1, int(round(pct / 100.0 * len(s) + 0.5)) - 1))
+    return s[k]
+
+
+def _pearson(xs: List[float], ys: List[float]) -> Optional[float]:
+    n = len(xs)
+    if n < 3:
+        return None
+    mx = sum(xs) / n
+    my = sum(ys) / n
+    sxx = sum((x - mx) ** 2 for x in xs)
+    syy = sum((y - my) ** 2 for y in ys)
+    if sxx == 0 or syy == 0:
+        return None
+    sxy = sum((x - mx) * (y - my) for x, y in zip(xs, ys))
+    return sxy / (sxx * syy) ** 0.5
+
+
+def _device_sample(base_url: str, timeout_s: float) -> Dict[str, Optional[float]]:
+    out: Dict[str, Optional[float]] = {k: None for k in DEVICE_FIELDS}
+    try:
+        status, data = _http(base_url, "GET", "/api/health", timeout_s=timeout_s, retries=1)
+        if status == 200:
+            h = json.loads(data.decode("utf-8", errors="replace"))
+            for k in DEVICE_FIELDS:
+                v = h.get(k)
+                if isinstance(v, (int, float)) and not isinstance(v, bool):
+                    out[k] = float(v)
+        status, data = _http(base_url, "GET", "/api/health/tasks", timeout_s=timeout_s, retries=1)
+        if status == 200:
+            t = json.loads(data.decode("utf-8", errors="replace"))
+            for task in t.get("tasks", []) or []:
+                if task.get("name") == "async_tcp":
+                    out["async_tcp_cpu"] = task.get("cpu")
+                elif task.get("name") == "loopTask":
+                    out["loop_task_cpu"] = task.get("cpu")
+    except (RuntimeError, ValueError):
+        pass
+    return out
+
+
+def run_load(
+    base_url: str,
+    endpoints: List[str],
+    workers: int,
+    duration_s: float,
+    sample_interval_s: float,
+    timeout_s: float,
+) -> Tuple[List[RequestResult], List[Tuple[float, Dict[str, Optional[float]]]]]:
+    results: List[List[RequestResult]] = [[] for _ in range(workers)]
+    samples: List[Tuple[float, Dict[str, Optional[float]]]] = []
+    start = time.perf_counter()
+    stop = threading.Event()
+
+    def worker(idx: int) -> None:
+        # Stagger the start endpoint so workers do not move in lockstep.
+        i = idx
+        while not stop.is_set():
+            path = endpoints[i % len(endpoints)]
+            i += 1
+            t = time.perf_counter() - start
+            status, ms = _timed_get(base_url, path, timeout_s)
+            results[idx].append(RequestResult(t_s=t, endpoint=path, status=status, latency_ms=ms))
+
+    def sampler() -> None:
+        while not stop.is_set():
+            t = time.perf_counter() - start
+            samples.append((t, _device_sample(base_url, timeout_s)))
+            stop.wait(sample_interval_s)
+
+    threads = [threading.Thread(target=worker, args=(i,), daemon=True) for i in range(workers)]
+    threads.append(threading.Thread(target=sampler, daemon=True))
+    for th in threads:
+        th.start()
+    try:
+        while time.perf_counter() - start < duration_s:
+            time.sleep(0.2)
+            done = sum(len(r) for r in results)
+            print(f"\r  {time.perf_counter() - start:5.1f}s  {done} requests", end="", flush=True)
+    finally:
+        stop.set()
+        for th in threads:
+            th.join(timeout=timeout_s + 1.0)
+        print()
+
+    merged = [r for rs in results for r in rs]
+    merged.sort(key=lambda r: r.t_s)
+    return merged, samples
+
+
+def summarize_load(results: List[RequestResult], duration_s: float) -> None:
+    print("\nPer-endpoint latency (ms) and error rates:")
+    print(f"  {'endpoint':22s} {'n':>6s} {'p50':>8s} {'p95':>8s} {'p99':>8s} {'max':>8s} {'err%':>6s} {'503%':>6s}")
+    by_ep: Dict[str, List[RequestResult]] = {}
+    for r in results:
+        by_ep.setdefault(r.endpoint, []).append(r)
+    for ep in sorted(by_ep) + ["(all)"]:
+        rs = results if ep == "(all)" else by_ep[ep]
+        ok = [r.latency_ms for r in rs if 200 <= r.status < 400]
+        n = len(rs)
+        errors = sum(1 for r in rs if r.status == 0 or (r.status >= 400 and r.status != 503))
+        busy = sum(1 for r in rs if r.status == 503)
+
+        def _fmt(v: Optional[float]) -> str:
+            return f"{v:8.1f}" if v is not None else f"{'n/a':>8s}"
+
+        print(
+            f"  {ep:22s} {n:6d} {_fmt(_percentile(ok, 50))} {_fmt(_percentile(ok, 95))} {_fmt(_percentile(ok, 99))}"
+            f" {_fmt(max(ok) if ok else None)} {100.0 * errors / n if n else 0:6.1f} {100.0 * busy / n if n else 0:6.1f}"
+        )
+    print(f"  throughput: {len(results) / duration_s:.1f} req/s")
+
+
+def _interval_rows(
+    results: List[RequestResult], samples: List[Tuple[float, Dict[str, Optional[float]]]]
+) -> List[Dict[str, Any]]:
+    # Each device sample owns the requests started since the previous one.
+    rows: List[Dict[str, Any]] = []
+    j = 0
+    prev_t = 0.0
+    for t, dev in samples[1:] if len(samples) > 1 else samples:
+        window: List[RequestResult] = []
+        while j < len(results) and results[j].t_s < t:
+            window.append(results[j])
+            j += 1
+        ok = [r.latency_ms for r in window if 200 <= r.status < 400]
+
+        def _ms(pct: float) -> Optional[float]:
+            v = _percentile(ok, pct)
+            return round(v, 2) if v is not None else None
+
+        row: Dict[str, Any] = {
+            "t_s": round(t, 2),
+            "requests": len(window),
+            "req_per_s": round(len(window) / (t - prev_t), 2) if t > prev_t else None,
+            "errors": sum(1 for r in window if r.status == 0 or (r.status >= 400 and r.status != 503)),
+            "http_503": sum(1 for r in window if r.status == 503),
+            "p50_ms": _ms(50),
+            "p95_ms": _ms(95),
+            "p99_ms": _ms(99),
+        }
+        row.update(dev)
+        rows.append(row)
+        prev_t = t
+    return rows
+
+
+def summarize_correlation(rows: List[Dict[str, Any]]) -> None:
+    print("\nCorrelation of interval p95 latency with device metrics (Pearson r):")
+    for field in DEVICE_FIELDS:
+        pairs = [(r["p95_ms"], r[field]) for r in rows if r.get("p95_ms") is not None and r.get(field) is not None]
+        r = _pearson([float(a) for a, _ in pairs], [float(b) for _, b in pairs])
+        print(f"  {field:18s} {('%+.2f' % r) if r is not None else 'n/a':>6s}  ({len(pairs)} intervals)")
+
+
+def write_load_csv(path: str, rows: List[Dict[str, Any]]) -> None:
+    cols = ["t_s", "requests", "req_per_s", "errors", "http_503", "p50_ms", "p95_ms", "p99_ms"] + list(DEVICE_FIELDS)
+    with open(path, "w", newline="") as f:
+        w = csv.writer(f)
+        w.writerow(cols)
+        for row in rows:
+            w.writerow([row.get(c) for c in cols])
+
+
 def main(argv: list[str]) -> int:
     p = argparse.ArgumentParser(description="ESP32 portal/API stress test (health API driven)")
     p.add_argument("--host", required=True, help="Device IP address (or full URL). Example: 192.168.1.111")
@@ -531,7 +755,25 @@ def main(argv: list[str]) -> int:
     p.add_argument(
         "--out",
         default=None,
-        help="Optional CSV output path (writes all samples).",
+        help="Optional CSV output path (writes all samples; per-interval rows in load mode).",
+    )
+    p.add_argument(
+        "--workers",
+        type=int,
+        default=0,
+        help="Load mode: number of concurrent clients (default: 0 = sequential cycles).",
+    )
+    p.add_argument("--duration", type=float, default=60.0, help="Load mode: run time in seconds (default: 60)")
+    p.add_argument(
+        "--sample-interval",
+        type=float,
+        default=1.0,
+        help="Load mode: seconds between /api/health + /api/health/tasks samples (default: 1)",
+    )
+    p.add_argument(
+        "--endpoints",
+        default=None,
+        help="Load mode: comma-separated GET paths (default: API endpoints, plus pages for --scenario portal/both).",
     )
 
     args = p.parse_args(argv)
@@ -546,6 +788,34 @@ def main(argv: list[str]) -> int:
 
     base_url = _normalize_base_url(args.host)
 
+    if args.workers > 0:
+        if args.endpoints:
+            endpoints = [e.strip() for e in args.endpoints.split(",") if e.strip()]
+        else:
+            endpoints = list(API_LOAD_ENDPOINTS)
+            if args.scenario in ("portal", "both"):
+                endpoints += list(PORTAL_LOAD_ENDPOINTS)
+        print(f"Target: {base_url}")
+        print(f"Load: {args.workers} workers for {args.duration:.0f}s over {', '.join(endpoints)}")
+        results, dev_samples = run_load(
+            base_url,
+            endpoints,
+            workers=args.workers,
+            duration_s=args.duration,
+            sample_interval_s=args.sample_interval,
+            timeout_s=args.timeout,
+        )
+        if not results:
+            print("ERROR: no requests completed", file=sys.stderr)
+            return 1
+        summarize_load(results, args.duration)
+        rows = _interval_rows(results, dev_samples)
+        summarize_correlation(rows)
+        if args.out:
+            write_load_csv(args.out, rows)
+            print(f"\nWrote CSV: {args.out}")
+        return 0
+
     print(f"Target: {base_url}")
     print(f"Scenario: {args.scenario}")
     print(f"Cycles: {args.cycles}")
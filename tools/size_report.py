@@ -0,0 +1,397 @@
+#!/usr/bin/env python3
+"""Per-subsystem flash/IRAM/DRAM size report from the linker map.
+
+Goal: make static memory growth visible per commit. Internal RAM left after the
+static image decides whether JPEG decode and TLS succeed on boards without PSRAM
+(CYD), and a few KB of new .bss is invisible in the .bin size.
+
+This script is intentionally dependency-free (stdlib only). build.sh runs it
+after every successful compile.
+
+Typical usage:
+  # Report + compare with the release baseline, exit 1 on budget overrun
+  python3 tools/size_report.py --board cyd-v2 --map build/cyd-v2/app.ino.map
+
+  # At release time: record the current build as the baseline for this board
+  python3 tools/size_report.py --board cyd-v2 --map build/cyd-v2/app.ino.map --update-baseline
+
+Notes:
+- Sizes are summed from the input sections in the "Linker script and memory map"
+  part of the GNU ld map. IRAM = .iram0.*, DRAM = .dram0.* / .noinit (data + bss),
+  flash = .flash.* (code + rodata executed/read from flash), RTC = .rtc.*,
+  PSRAM = .ext_ram.*. Initialized DRAM/IRAM also occupies flash in the image.
+- Subsystems are assigned from the object path (sketch file, Arduino library,
+  core, ESP-IDF archive). Gzipped web pages are counted by symbol name.
+- Free internal RAM is the memory region length from the map minus what the
+  linker placed there (the runtime heap starts from that remainder).
+- Budgets (tools/size_budgets.json): "default" applies to every board, entries in
+  "boards" are merged over it. Keys are a region ("dram") or "subsystem.region"
+  ("lvgl.dram"):
+    max_growth_bytes  allowed growth vs the baseline
+    max_bytes         absolute cap
+    min_free_bytes    required headroom (regions "dram" / "iram" only)
+"""
+
+from __future__ import annotations
+
+import argparse
+import json
+import os
+import re
+import subprocess
+import sys
+from datetime import datetime, timezone
+from typing import Any, Dict, List, Optional, Tuple
+
+
+REGIONS = ("flash", "iram", "dram", "rtc", "psram")
+
+# Output section prefix -> region. First match wins.
+SECTION_REGIONS = (
+    (".iram0.", "iram"),
+    (".dram0.", "dram"),
+    (".noinit", "dram"),
+    (".flash.", "flash"),
+    (".rtc", "rtc"),
+    (".ext_ram", "psram"),
+)
+
+# Memory region name (Memory Configuration) -> reported headroom key.
+HEADROOM_SEGMENTS = (("dram0_0_seg", "dram"), ("iram0_0_seg", "iram"))
+
+# Sketch object basename prefix -> subsystem. First match wins.
+SKETCH_SUBSYSTEMS = (
+    (("image_", "jpeg_", "strip_decoder", "lvgl_jpeg_decoder", "lvgl_image_cache", "rgb565_"), "image"),
+    (("mqtt_", "ha_discovery"), "mqtt"),
+    (("web_portal", "portal_events"), "web"),
+    (("display_drivers", "touch_drivers", "display_manager", "touch_"), "drivers"),
+    (("screens", "lvgl_", "png_assets", "screen_saver"), "ui"),
+)
+
+# Library directory name (lowercase, under .../libraries/<name>/) -> subsystem.
+LIBRARY_SUBSYSTEMS = (
+    (("lvgl",), "lvgl"),
+    (("pubsubclient",), "mqtt"),
+    (("espasyncwebserver", "esp_async_webserver", "async_tcp", "asynctcp"), "web"),
+    (("tft_espi", "gfx_library_for_arduino", "esp32_display_panel", "esp32_io_expander", "xpt2046"), "drivers"),
+    (("arduinojson",), "app"),
+)
+
+RE_WEB_ASSET = re.compile(r"_(html|css|js)_gz\b")
+RE_HEX = r"0x[0-9a-fA-F]+"
+RE_OUTPUT_SECTION = re.compile(rf"^(\.\S+)(?:\s+({RE_HEX})\s+({RE_HEX}))?\s*$")
+RE_INPUT_FULL = re.compile(rf"^ (\S+)\s+({RE_HEX})\s+({RE_HEX})\s+(\S.*)$")
+RE_INPUT_NAME = re.compile(r"^ (\S+)\s*$")
+RE_INPUT_CONT = re.compile(rf"^\s+({RE_HEX})\s+({RE_HEX})\s+(\S.*)$")
+RE_MEMORY = re.compile(rf"^(\S+)\s+({RE_HEX})\s+({RE_HEX})")
+
+
+def _repo_root() -> str:
+    # tools/size_report.py -> repo root
+    return os.path.abspath(os.path.join(os.path.dirname(__file__), ".."))
+
+
+def _now_iso() -> str:
+    return datetime.now(timezone.utc).isoformat(timespec="seconds")
+
+
+def _git_commit() -> str:
+    try:
+        out = subprocess.run(
+            ["git", "rev-parse", "--short", "HEAD"],
+            cwd=_repo_root(),
+            capture_output=True,
+            text=True,
+            check=True,
+        )
+        return out.stdout.strip()
+    except Exception:
+        return "unknown"
+
+
+def _firmware_version() -> str:
+    path = os.path.join(_repo_root(), "src", "version.h")
+    parts = {}
+    try:
+        with open(path, "r", encoding="utf-8") as f:
+            for line in f:
+                m = re.match(r"\s*#define\s+VERSION_(MAJOR|MINOR|PATCH)\s+(\d+)", line)
+                if m:
+                    parts[m.group(1)] = m.group(2)
+    except OSError:
+        return ""
+    return ".".join(parts.get(k, "0") for k in ("MAJOR", "MINOR", "PATCH"))
+
+
+def region_for_section(name: str) -> Optional[str]:
+    for prefix, region in SECTION_REGIONS:
+        if name.startswith(prefix):
+            return region
+    return None
+
+
+def subsystem_for(obj: str, section: str) -> str:
+    if RE_WEB_ASSET.search(section):
+        return "web_assets"
+    path = obj.replace("\\", "/")
+    low = path.lower()
+
+    if "/sketch/" in low:
+        base = os.path.basename(low)
+        for prefixes, subsystem in SKETCH_SUBSYSTEMS:
+            if base.startswith(prefixes):
+                return subsystem
+        return "app"
+
+    m = re.search(r"/libraries/([^/]+)/", low)
+    if m:
+        lib = m.group(1).replace(" ", "_").replace("-", "_")
+        for names, subsystem in LIBRARY_SUBSYSTEMS:
+            if lib.startswith(names):
+                return subsystem
+        return "arduino"
+
+    if "/core/" in low or "core.a" in low:
+        return "arduino"
+    if ".a(" in low or low.endswith(".a"):
+        return "esp-idf"
+    return "other"
+
+
+def parse_map(path: str) -> Dict[str, Any]:
+    """Return {"regions", "subsystems", "free"} byte counts from a GNU ld map."""
+    regions = {r: 0 for r in REGIONS}
+    subsystems: Dict[str, Dict[str, int]] = {}
+    segments: Dict[str, Tuple[int, int]] = {}
+    segment_used: Dict[str, int] = {}
+
+    def add(section: str, addr: int, size: int, obj: str, region: Optional[str]) -> None:
+        if region is None or size == 0 or addr == 0:
+            return
+        regions[region] += size
+        sub = subsystems.setdefault(subsystem_for(obj, section), {r: 0 for r in REGIONS})
+        sub[region] += size
+        for seg, (origin, length) in segments.items():
+            if origin <= addr < origin + length:
+                segment_used[seg] = segment_used.get(seg, 0) + size
+                break
+
+    with open(path, "r", encoding="utf-8", errors="replace") as f:
+        lines = f.read().splitlines()
+
+    i = 0
+    # Memory Configuration: region origins/lengths.
+    while i < len(lines) and not lines[i].startswith("Memory Configuration"):
+        i += 1
+    while i < len(lines) and not lines[i].startswith("Linker script and memory map"):
+        m = RE_MEMORY.match(lines[i])
+        if m and m.group(1) != "*default*":
+            segments[m.group(1)] = (int(m.group(2), 16), int(m.group(3), 16))
+        i += 1
+
+    region: Optional[str] = None
+    pending: Optional[str] = None
+    while i < len(lines):
+        line = lines[i]
+        i += 1
+        if not line:
+            continue
+        if not line[0].isspace():
+            m = RE_OUTPUT_SECTION.match(line)
+            region = region_for_section(m.group(1)) if m else None
+            pending = None
+            continue
+        if region is None:
+            continue
+        if pending is not None:
+            m = RE_INPUT_CONT.match(line)
+            if m:
+                add(pending, int(m.group(1), 16), int(m.group(2), 16), m.group(3), region)
+            pending = None
+            continue
+        m = RE_INPUT_FULL.match(line)
+        if m:
+            add(m.group(1), int(m.group(2), 16), int(m.group(3), 16), m.group(4), region)
+            continue
+        m = RE_INPUT_NAME.match(line)
+        if m and not m.group(1).startswith("*("):
+            pending = m.group(1)
+
+    free = {}
+    for seg, key in HEADROOM_SEGMENTS:
+        if seg in segments:
+            free[key] = segments[seg][1] - segment_used.get(seg, 0)
+    return {"regions": regions, "subsystems": subsystems, "free": free}
+
+
+def _load_json(path: str) -> Dict[str, Any]:
+    if not os.path.exists(path):
+        return {}
+    with open(path, "r", encoding="utf-8") as f:
+        return json.load(f)
+
+
+def _lookup(report: Dict[str, Any], key: str) -> Optional[int]:
+    """"dram" -> regions.dram, "lvgl.dram" -> subsystems.lvgl.dram."""
+    if "." in key:
+        sub, region = key.split(".", 1)
+        return report.get("subsystems", {}).get(sub, {}).get(region)
+    return report.get("regions", {}).get(key)
+
+
+def board_budget(budgets: Dict[str, Any], board: str) -> Dict[str, Dict[str, int]]:
+    merged: Dict[str, Dict[str, int]] = {}
+    for entry in (budgets.get("default", {}), budgets.get("boards", {}).get(board, {})):
+        for kind, limits in entry.items():
+            merged.setdefault(kind, {}).update(limits)
+    return merged
+
+
+def check_budget(report: Dict[str, Any], baseline: Optional[Dict[str, Any]], budget: Dict[str, Dict[str, int]]) -> List[str]:
+    failures = []
+    for key, limit in sorted(budget.get("max_bytes", {}).items()):
+        cur = _lookup(report, key)
+        if cur is not None and cur > limit:
+            failures.append(f"{key}: {cur} bytes > max {limit}")
+    for key, limit in sorted(budget.get("min_free_bytes", {}).items()):
+        cur = report.get("free", {}).get(key)
+        if cur is not None and cur < limit:
+            failures.append(f"{key} free: {cur} bytes < min {limit}")
+    if baseline:
+        for key, limit in sorted(budget.get("max_growth_bytes", {}).items()):
+            cur = _lookup(report, key)
+            base = _lookup(baseline, key)
+            if cur is not None and base is not None and cur - base > limit:
+                failures.append(f"{key}: grew {cur - base:+d} bytes vs baseline (max {limit:+d})")
+    return failures
+
+
+def _fmt_delta(cur: int, base: Optional[int]) -> str:
+    if base is None:
+        return ""
+    d = cur - base
+    return f"{d:+d}" if d else "="
+
+
+def render_text(report: Dict[str, Any], baseline: Optional[Dict[str, Any]]) -> str:
+    shown = ("flash", "iram", "dram")
+    out = []
+    header = f"  {'subsystem':12s}" + "".join(f" {r:>10s}" for r in shown)
+    if baseline:
+        header += "".join(f" {'d' + r:>9s}" for r in shown)
+    out.append(header)
+    rows = sorted(report["subsystems"].items(), key=lambda kv: -sum(kv[1][r] for r in shown))
+    for name, sizes in rows + [("TOTAL", report["regions"])]:
+        line = f"  {name:12s}" + "".join(f" {sizes[r]:>10d}" for r in shown)
+        if baseline:
+            base = baseline["regions"] if name == "TOTAL" else baseline.get("subsystems", {}).get(name, {})
+            line += "".join(f" {_fmt_delta(sizes[r], base.get(r)):>9s}" for r in shown)
+        out.append(line)
+    free = report.get("free", {})
+    if free:
+        parts = []
+        for key in ("dram", "iram"):
+            if key in free:
+                part = f"{key} {free[key]} bytes"
+                if baseline and key in baseline.get("free", {}):
+                    part += f" ({_fmt_delta(free[key], baseline['free'][key])})"
+                parts.append(part)
+        out.append("  free: " + ", ".join(parts))
+    return "\n".join(out)
+
+
+def render_markdown(board: str, report: Dict[str, Any], baseline: Optional[Dict[str, Any]], failures: List[str]) -> str:
+    shown = ("flash", "iram", "dram")
+    out = [f"### Size report - {board}", ""]
+    if baseline:
+        out.append(f"Baseline: {baseline.get('version', '?')} ({baseline.get('commit', '?')})")
+        out.append("")
+    out.append("| Subsystem | Flash | IRAM | DRAM |")
+    out.append("|---|---:|---:|---:|")
+    rows = sorted(report["subsystems"].items(), key=lambda kv: -sum(kv[1][r] for r in shown))
+    for name, sizes in rows + [("**total**", report["regions"])]:
+        base = None
+        if baseline:
+            base = baseline["regions"] if name == "**total**" else baseline.get("subsystems", {}).get(name, {})
+        cells = []
+        for r in shown:
+            delta = _fmt_delta(sizes[r], base.get(r)) if base is not None else ""
+            cells.append(f"{sizes[r]}" + (f" ({delta})" if delta and delta != "=" else ""))
+        out.append(f"| {name} | " + " | ".join(cells) + " |")
+    free = report.get("free", {})
+    if free:
+        out.append("")
+        out.append("Free internal RAM after static allocation: " + ", ".join(f"{k} {v} bytes" for k, v in sorted(free.items())))
+    if failures:
+        out.append("")
+        out.append("**Budget overruns:**")
+        out.extend(f"- {f}" for f in failures)
+    return "\n".join(out) + "\n"
+
+
+def main(argv: List[str]) -> int:
+    p = argparse.ArgumentParser(description="Per-subsystem flash/IRAM/DRAM report from the linker map")
+    p.add_argument("--board", required=True, help="Board name (key for baselines and budgets)")
+    p.add_argument("--map", required=True, help="Linker map file (build/<board>/app.ino.map)")
+    p.add_argument("--out", default=None, help="Write the report as JSON")
+    p.add_argument("--markdown", default=None, help="Append a markdown table (e.g. $GITHUB_STEP_SUMMARY)")
+    p.add_argument(
+        "--baseline",
+        default=os.path.join(_repo_root(), "tools", "size_baselines.json"),
+        help="Baseline JSON keyed by board (default: tools/size_baselines.json)",
+    )
+    p.add_argument(
+        "--budgets",
+        default=os.path.join(_repo_root(), "tools", "size_budgets.json"),
+        help="Budget JSON (default: tools/size_budgets.json)",
+    )
+    p.add_argument("--update-baseline", action="store_true", help="Record this build as the board's baseline")
+    p.add_argument("--no-fail", action="store_true", help="Report budget overruns but exit 0")
+    args = p.parse_args(argv)
+
+    if not os.path.exists(args.map):
+        print(f"ERROR: map file not found: {args.map}", file=sys.stderr)
+        return 2
+
+    report = parse_map(args.map)
+    report.update({"board": args.board, "version": _firmware_version(), "commit": _git_commit()})
+
+    if args.out:
+        with open(args.out, "w", encoding="utf-8") as f:
+            json.dump(report, f, indent=2, sort_keys=True)
+            f.write("\n")
+
+    baselines = _load_json(args.baseline)
+    if args.update_baseline:
+        report["recorded"] = _now_iso()
+        baselines[args.board] = report
+        with open(args.baseline, "w", encoding="utf-8") as f:
+            json.dump(baselines, f, indent=2, sort_keys=True)
+            f.write("\n")
+        print(render_text(report, None))
+        print(f"Size baseline for {args.board} written to {args.baseline}")
+        return 0
+
+    baseline = baselines.get(args.board)
+    failures = check_budget(report, baseline, board_budget(_load_json(args.budgets), args.board))
+
+    if baseline:
+        print(f"Size report for {args.board} (vs {baseline.get('version')} / {baseline.get('commit')}):")
+    else:
+        print(f"Size report for {args.board} (no baseline in {args.baseline}):")
+    print(render_text(report, baseline))
+
+    if args.markdown:
+        with open(args.markdown, "a", encoding="utf-8") as f:
+            f.write(render_markdown(args.board, report, baseline, failures))
+
+    if failures:
+        print(f"Size budget exceeded for {args.board}:")
+        for failure in failures:
+            print(f"  - {failure}")
+        return 0 if args.no_fail else 1
+    return 0
+
+
+if __name__ == "__main__":
+    raise SystemExit(main(sys.argv[1:]))
@@ -12,6 +12,9 @@ Usage:
     
     # Upload in strip mode (memory efficient)
     ./upload_image.py 192.168.1.100 --image photo.jpg --mode strip
+
+    # Strip mode with native RGB565 pixels (no JPEG decode on the device)
+    ./upload_image.py 192.168.1.100 --generate --mode strip --format rgb565_lz4
     
     # Generate and upload test image
     ./upload_image.py 192.168.1.100 --generate 320x240
@@ -19,15 +22,21 @@ Usage:
     # Use mDNS hostname
     ./upload_image.py esp32-device.local --image photo.jpg --timeout 30
 
+    # Throughput benchmark: sweep JPEG quality x (full + strip heights), write a CSV
+    ./upload_image.py 192.168.1.100 --generate --bench --bench-csv bench.csv
+
 Dependencies:
     pip install requests pillow
 """
 
 import argparse
+import csv
 import sys
 import os
 import io
 import random
+import statistics
+import time
 import requests
 from PIL import Image, ImageDraw, ImageFont
 from pathlib import Path
@@ -280,24 +289,143 @@ def split_jpeg_into_strips(jpeg_data: bytes, strip_height: int, quality: int = 8
     return strips, width, height
 
 
-def upload_strip_mode(host: str, jpeg_data: bytes, strip_height: int, timeout: int, quality: int = 85, verbose: bool = False) -> bool:
+def rgb565_be_bytes(img: Image.Image) -> bytes:
+    """Pack a PIL image as big-endian (wire order) RGB565."""
+    rgb = img.convert('RGB').tobytes()
+    out = bytearray(len(rgb) // 3 * 2)
+    o = 0
+    for i in range(0, len(rgb), 3):
+        v = ((rgb[i] & 0xF8) << 8) | ((rgb[i + 1] & 0xFC) << 3) | (rgb[i + 2] >> 3)
+        out[o] = v >> 8
+        out[o + 1] = v & 0xFF
+        o += 2
+    return bytes(out)
+
+
+def rle_compress_rgb565(data: bytes) -> bytes:
+    """PackBits over 16-bit pixels (format=rgb565_rle, see src/app/rgb565_codec.h)."""
+    px = [data[i:i + 2] for i in range(0, len(data), 2)]
+    out = bytearray()
+    i = 0
+    while i < len(px):
+        run = 1
+        while i + run < len(px) and run < 128 and px[i + run] == px[i]:
+            run += 1
+        if run >= 2:
+            out.append(0x80 | (run - 1))
+            out += px[i]
+            i += run
+            continue
+        start = i
+        while i < len(px) and i - start < 128 and not (i + 1 < len(px) and px[i + 1] == px[i]):
+            i += 1
+        if i == start:
+            i += 1
+        out.append(i - start - 1)
+        for p in px[start:i]:
+            out += p
+    return bytes(out)
+
+
+def lz4_block_compress(data: bytes) -> bytes:
+    """Single LZ4 block without size prefix (format=rgb565_lz4)."""
+    try:
+        import lz4.block  # type: ignore
+        return lz4.block.compress(data, store_size=False)
+    except ImportError:
+        pass
+
+    # Greedy pure-Python fallback (slower, slightly worse ratio, same format).
+    def put_len(out: bytearray, n: int):
+        while n >= 255:
+            out.append(255)
+            n -= 255
+        out.append(n)
+
+    out = bytearray()
+    table = {}
+    anchor = 0
+    i = 0
+    end = len(data)
+    match_limit = end - 12  # LZ4 spec: last 5 bytes literal, last match starts >= 12 from end
+    while i < match_limit:
+        key = data[i:i + 4]
+        cand = table.get(key)
+        table[key] = i
+        if cand is None or i - cand > 0xFFFF:
+            i += 1
+            continue
+        mlen = 4
+        while i + mlen < end - 5 and data[cand + mlen] == data[i + mlen]:
+            mlen += 1
+        lit = i - anchor
+        out.append((min(lit, 15) << 4) | min(mlen - 4, 15))
+        if lit >= 15:
+            put_len(out, lit - 15)
+        out += data[anchor:i]
+        off = i - cand
+        out += bytes((off & 0xFF, off >> 8))
+        if mlen - 4 >= 15:
+            put_len(out, mlen - 4 - 15)
+        i += mlen
+        anchor = i
+    lit = end - anchor
+    out.append(min(lit, 15) << 4)
+    if lit >= 15:
+        put_len(out, lit - 15)
+    out += data[anchor:]
+    return bytes(out)
+
+
+def split_rgb565_into_strips(jpeg_data: bytes, strip_height: int, fmt: str) -> list:
+    """
+    Split image into horizontal RGB565 strips.
+    Returns list of (strip_index, strip_bytes, rows).
+    """
+    img = Image.open(io.BytesIO(jpeg_data))
+    width, height = img.size
+    num_strips = (height + strip_height - 1) // strip_height
+
+    strips = []
+    for i in range(num_strips):
+        y_start = i * strip_height
+        y_end = min(y_start + strip_height, height)
+        raw = rgb565_be_bytes(img.crop((0, y_start, width, y_end)))
+        if fmt == 'rgb565_rle':
+            raw = rle_compress_rgb565(raw)
+        elif fmt == 'rgb565_lz4':
+            raw = lz4_block_compress(raw)
+        strips.append((i, raw, y_end - y_start))
+
+    return strips, width, height
+
+
+def upload_strip_mode(host: str, jpeg_data: bytes, strip_height: int, timeout: int, quality: int = 85, verbose: bool = False,
+                      fmt: str = 'jpeg') -> bool:
     """Upload image in strip mode (synchronous decode, memory efficient)."""
-    print_info(f"Splitting image into {strip_height}px strips (quality {quality}%)...")
-    
-    strips, width, height = split_jpeg_into_strips(jpeg_data, strip_height, quality)
+    if fmt == 'jpeg':
+        print_info(f"Splitting image into {strip_height}px strips (quality {quality}%)...")
+        strips, width, height = split_jpeg_into_strips(jpeg_data, strip_height, quality)
+        strips = [(i, data, 0) for i, data in strips]
+    else:
+        print_info(f"Splitting image into {strip_height}px {fmt} strips...")
+        strips, width, height = split_rgb565_into_strips(jpeg_data, strip_height, fmt)
     num_strips = len(strips)
     
     print_info(f"Image: {width}x{height}, {num_strips} strips")
     
     url = f"http://{host}/api/display/image/strips"
     
-    for strip_index, strip_data in strips:
+    for strip_index, strip_data, rows in strips:
         params = {
             'strip_index': strip_index,
             'strip_count': num_strips,
             'width': width,
             'height': height,
         }
+        if fmt != 'jpeg':
+            params['format'] = fmt
+            params['rows'] = rows
         
         # Only add timeout on first strip
         if strip_index == 0 and timeout > 0:
@@ -307,7 +435,7 @@ def upload_strip_mode(host: str, jpeg_data: bytes, strip_height: int, timeout: i
         
         try:
             # Send as raw POST body data
-            headers = {'Content-Type': 'image/jpeg'}
+            headers = {'Content-Type': 'image/jpeg' if fmt == 'jpeg' else 'application/octet-stream'}
             response = requests.post(url, params=params, data=strip_data, headers=headers, timeout=30)
             
             if verbose:
@@ -333,6 +461,135 @@ def upload_strip_mode(host: str, jpeg_data: bytes, strip_height: int, timeout: i
     return True
 
 
+def fetch_upload_timing(host: str, seq: int, wait_s: float = 10.0) -> Optional[dict]:
+    """Poll /api/display/image/timing until upload `seq` has been decoded (None on timeout)."""
+    deadline = time.monotonic() + wait_s
+    while time.monotonic() < deadline:
+        response = requests.get(f"http://{host}/api/display/image/timing", timeout=5)
+        if response.status_code != 200:
+            return None
+        timing = response.json()
+        if timing.get('seq') != seq:
+            return None  # superseded by another upload
+        if timing.get('complete'):
+            return timing
+        time.sleep(0.02)
+    return None
+
+
+def bench_upload_once(host: str, jpeg_data: bytes, strip_height: int, quality: int) -> dict:
+    """
+    Upload one image (strip_height 0 = full mode) and return host + device timing.
+    Strips are encoded before the clock starts, so upload_ms is HTTP transfer only.
+    """
+    if strip_height > 0:
+        strips, width, height = split_jpeg_into_strips(jpeg_data, strip_height, quality)
+        payloads = [data for _, data in strips]
+    else:
+        img = Image.open(io.BytesIO(jpeg_data))
+        buffer = io.BytesIO()
+        img.save(buffer, format='JPEG', quality=quality, optimize=True)
+        payloads = [buffer.getvalue()]
+
+    seq = None
+    start = time.perf_counter()
+    if strip_height > 0:
+        url = f"http://{host}/api/display/image/strips"
+        for index, data in enumerate(payloads):
+            params = {'strip_index': index, 'strip_count': len(payloads), 'width': width, 'height': height}
+            response = requests.post(url, params=params, data=data,
+                                     headers={'Content-Type': 'image/jpeg'}, timeout=30)
+            if response.status_code != 200:
+                raise RuntimeError(f"strip {index}: HTTP {response.status_code} {response.text[:120]}")
+            seq = response.json().get('image_seq')
+    else:
+        files = {'file': ('image.jpg', payloads[0], 'image/jpeg')}
+        response = requests.post(f"http://{host}/api/display/image", files=files, timeout=30)
+        if response.status_code != 200:
+            raise RuntimeError(f"HTTP {response.status_code} {response.text[:120]}")
+        seq = response.json().get('image_seq')
+    upload_ms = (time.perf_counter() - start) * 1000.0
+
+    if seq is None:
+        raise RuntimeError("firmware does not report image_seq (no /api/display/image/timing)")
+    timing = fetch_upload_timing(host, seq)
+    e2e_ms = (time.perf_counter() - start) * 1000.0
+    if timing is None:
+        raise RuntimeError(f"no timing for upload {seq}")
+    if not timing.get('ok'):
+        raise RuntimeError(f"device failed to decode upload {seq}")
+
+    return {
+        'bytes': sum(len(p) for p in payloads),
+        'strips': len(payloads),
+        'upload_ms': upload_ms,
+        'device_receive_ms': timing.get('receive_us', 0) / 1000.0,
+        'device_decode_ms': timing.get('decode_us', 0) / 1000.0,
+        'device_decode_max_ms': timing.get('decode_max_us', 0) / 1000.0,
+        'device_total_ms': timing.get('total_us', 0) / 1000.0,
+        'e2e_ms': e2e_ms,
+    }
+
+
+def run_benchmark(host: str, jpeg_data: bytes, qualities: list, strip_heights: list, reps: int,
+                  csv_path: Optional[str] = None) -> bool:
+    """Sweep quality x (full + strip heights); print medians and the fastest configuration."""
+    configs = [(q, h) for q in qualities for h in [0] + strip_heights]
+    fields = ['bytes', 'strips', 'upload_ms', 'device_receive_ms', 'device_decode_ms',
+              'device_decode_max_ms', 'device_total_ms', 'e2e_ms']
+    rows = []
+
+    print(f"{'mode':>10} {'q':>3} {'bytes':>8} {'upload':>9} {'dev rx':>9} {'decode':>9} "
+          f"{'dec max':>9} {'dev total':>9} {'e2e':>9} {'fps':>6}")
+    for quality, strip_height in configs:
+        mode = f"strip {strip_height}" if strip_height else "full"
+        samples = []
+        for _ in range(reps):
+            try:
+                samples.append(bench_upload_once(host, jpeg_data, strip_height, quality))
+            except (RuntimeError, requests.exceptions.RequestException) as e:
+                print_error(f"{mode} q{quality}: {e}")
+                break
+            time.sleep(0.2)  # let the loop settle between frames
+        if len(samples) < reps:
+            continue
+
+        row = {'mode': mode, 'strip_height': strip_height, 'quality': quality}
+        for key in fields:
+            row[key] = statistics.median(s[key] for s in samples)
+        row['fps'] = 1000.0 / row['e2e_ms'] if row['e2e_ms'] > 0 else 0.0
+        rows.append(row)
+        print(f"{mode:>10} {quality:>3} {int(row['bytes']):>8} {row['upload_ms']:>7.1f}ms "
+              f"{row['device_receive_ms']:>7.1f}ms {row['device_decode_ms']:>7.1f}ms "
+              f"{row['device_decode_max_ms']:>7.1f}ms {row['device_total_ms']:>7.1f}ms "
+              f"{row['e2e_ms']:>7.1f}ms {row['fps']:>6.2f}")
+
+    if not rows:
+        print_error("No configuration completed")
+        return False
+
+    if csv_path:
+        with open(csv_path, 'w', newline='', encoding='utf-8') as f:
+            writer = csv.DictWriter(f, fieldnames=['mode', 'strip_height', 'quality'] + fields + ['fps'])
+            writer.writeheader()
+            writer.writerows(rows)
+        print_info(f"Wrote {len(rows)} rows to {csv_path}")
+
+    best = max(rows, key=lambda r: r['fps'])
+    print_success(f"Fastest: {best['mode']} at quality {best['quality']} "
+                  f"({best['fps']:.2f} fps, {best['e2e_ms']:.1f} ms end-to-end)")
+    for quality in qualities:
+        strip_rows = [r for r in rows if r['quality'] == quality and r['strip_height']]
+        if strip_rows:
+            b = max(strip_rows, key=lambda r: r['fps'])
+            print_info(f"Best strip height at quality {quality}: {b['strip_height']}px ({b['fps']:.2f} fps)")
+    return True
+
+
+def parse_int_list(value: str) -> list:
+    return [int(v) for v in value.split(',') if v.strip()]
+
+
 def dismiss_image(host: str, verbose: bool = False) -> bool:
     """Dismiss currently displayed image."""
     url = f"http://{host}/api/display/image"
@@ -414,6 +671,7 @@ Examples:
     %(prog)s 192.168.1.100 --generate --timeout 30   # auto-detect from /api/info
   %(prog)s esp32-cyd.local --generate 240x240
   %(prog)s 192.168.1.100 --dismiss
+  %(prog)s 192.168.1.100 --generate --bench --bench-qualities 70,85 --bench-strip-heights 16,32
         """
     )
     
@@ -436,6 +694,8 @@ Examples:
                        help='Upload mode: full (default, deferred decode) or strip (memory efficient)')
     parser.add_argument('--strip-height', type=int, default=16, metavar='N',
                        help='Strip height in pixels for strip mode (default: 16, min: 1, max: 240)')
+    parser.add_argument('--format', choices=['jpeg', 'rgb565', 'rgb565_rle', 'rgb565_lz4'], default='jpeg',
+                       help='Strip mode payload: jpeg (default) or native RGB565, optionally RLE/LZ4 compressed')
     parser.add_argument('--quality', type=int, default=85, metavar='N',
                        help='JPEG quality 1-100 for generated/re-encoded images (default: 85)')
     parser.add_argument(
@@ -455,6 +715,17 @@ Examples:
     parser.add_argument('--timeout', type=int, default=10, metavar='SECONDS',
                        help='Display timeout in seconds (default: 10, 0=forever)')
     parser.add_argument('--verbose', '-v', action='store_true', help='Show detailed HTTP responses')
+
+    # Benchmark options
+    parser.add_argument('--bench', action='store_true',
+                       help='Benchmark throughput: sweep quality x (full + strip heights) and report timing/fps')
+    parser.add_argument('--bench-qualities', type=parse_int_list, default=[60, 75, 85, 95], metavar='LIST',
+                       help='JPEG qualities to sweep (default: 60,75,85,95)')
+    parser.add_argument('--bench-strip-heights', type=parse_int_list, default=[8, 16, 32, 64], metavar='LIST',
+                       help='Strip heights to sweep in addition to full mode (default: 8,16,32,64)')
+    parser.add_argument('--bench-reps', type=int, default=3, metavar='N',
+                       help='Uploads per configuration; medians are reported (default: 3)')
+    parser.add_argument('--bench-csv', metavar='PATH', help='Write the benchmark table to a CSV file')
     
     args = parser.parse_args()
 
@@ -529,11 +800,21 @@ Examples:
         jpeg_image.save(save_path, format='JPEG', quality=args.quality, optimize=True)
         print_success(f"Saved processed image to: {save_path}")
     
+    if args.bench:
+        print_header("Throughput Benchmark")
+        if args.bench_reps < 1:
+            print_error("--bench-reps must be >= 1")
+            sys.exit(1)
+        success = run_benchmark(args.host, jpeg_data, args.bench_qualities, args.bench_strip_heights,
+                                args.bench_reps, args.bench_csv)
+        sys.exit(0 if success else 1)
+
     # Upload image
     if args.mode == 'full':
         success = upload_full_image(args.host, jpeg_data, args.timeout, args.verbose)
     else:  # strip mode
-        success = upload_strip_mode(args.host, jpeg_data, args.strip_height, args.timeout, args.quality, args.verbose)
+        success = upload_strip_mode(args.host, jpeg_data, args.strip_height, args.timeout, args.quality, args.verbose,
+                                    args.format)
     
     if success:
         print_header("Complete")